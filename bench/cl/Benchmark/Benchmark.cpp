@@ -40,9 +40,14 @@
 #include "bolt/cl/scan_by_key.h"
 #include "bolt/cl/gather.h"
 #include "bolt/cl/scatter.h"
+#include "bolt/cl/copy_if.h"
+#include "bolt/cl/remove.h"
+#include "bolt/cl/unique.h"
+#include "bolt/cl/partition.h"
 
 #include <fstream>
 #include <vector>
+#include <utility>
 #include <bolt/unicode.h>
 #include <algorithm>
 #include <iomanip> 
@@ -85,7 +90,7 @@ unsigned int RandomNumber()
  *  Functions Enumerated
  *****************************************************************************/
 
-static const size_t FList = 23;
+static const size_t FList = 31;
 
 enum functionType {
     f_binarytransform,
@@ -110,7 +115,15 @@ enum functionType {
     f_transformscan,
     f_unarytransform,
     f_gather,
-    f_scatter
+    f_scatter,
+    f_copyif,
+    f_removeif,
+    f_unique,
+    f_uniquebykey,
+    f_partition,
+    f_stablepartition,
+    f_dispatch,
+    f_move
 
 };
 static char *functionNames[] = {
@@ -136,7 +149,15 @@ static char *functionNames[] = {
 "transformscan",
 "unarytransform",
 "gather",
-"scatter"
+"scatter",
+"copyif",
+"removeif",
+"unique",
+"uniquebykey",
+"partition",
+"stablepartition",
+"dispatch",
+"move"
 
 };
 
@@ -459,6 +480,50 @@ struct vec8less
 }; 
 );
 
+/******************************************************************************
+ *  User Defined Unary Predicates odd
+ *****************************************************************************/
+
+BOLT_FUNCTOR(intodd,
+struct intodd
+{
+    bool operator()(const DATA_TYPE &rhs) const
+    {
+        return (rhs & 1) != 0;
+    };
+}; 
+);
+
+BOLT_FUNCTOR(vec2odd,
+struct vec2odd
+{
+    bool operator()(const vec2 &rhs) const
+    {
+        return (rhs.a & 1) != 0;
+    };
+}; 
+);
+
+BOLT_FUNCTOR(vec4odd,
+struct vec4odd
+{
+    bool operator()(const vec4 &rhs) const
+    {
+        return (rhs.a & 1) != 0;
+    };
+}; 
+);
+
+BOLT_FUNCTOR(vec8odd,
+struct vec8odd
+{
+    bool operator()(const vec8 &rhs) const
+    {
+        return (rhs.a & 1) != 0;
+    };
+}; 
+);
+
 /******************************************************************************
  *  User Defined Binary Predicates vec2,4,8square
  *****************************************************************************/
@@ -535,6 +600,24 @@ functionType get_functionindex(std::string &fun)
 }
 
 
+/******************************************************************************
+ *
+ *  Storage identity; a hand-off that keeps it did not copy the elements
+ *
+ *****************************************************************************/
+template< typename T >
+const void* storageOf( const bolt::cl::device_vector< T >& vec )
+{
+    return vec.getBuffer( )( );
+}
+
+template< typename T >
+const void* storageOf( const std::vector< T >& vec )
+{
+    return vec.empty( ) ? NULL : &vec.front( );
+}
+
+
 /******************************************************************************
  *
  *  Execute Function Type
@@ -546,7 +629,8 @@ template<
     typename UnaryFunction,
     typename BinaryFunction,
     typename BinaryPredEq,
-    typename BinaryPredLt >
+    typename BinaryPredLt,
+    typename UnaryPredicate >
 void executeFunctionType(
     bolt::cl::control& ctrl,
     VectorType &input1,
@@ -559,6 +643,7 @@ void executeFunctionType(
     BinaryFunction binaryFunct,
     BinaryPredEq binaryPredEq,
     BinaryPredLt binaryPredLt,
+    UnaryPredicate unaryPred,
     size_t function,
     size_t iterations,
     size_t siz
@@ -568,6 +653,7 @@ void executeFunctionType(
     bolt::statTimer& myTimer = bolt::statTimer::getInstance( );
     myTimer.Reserve( 1, iterations );
     size_t testId	= myTimer.getUniqueID( _T( "test" ), 0 );
+    size_t moveCopies = 0;
     
 switch(function)
 {
@@ -912,6 +998,109 @@ switch(function)
                     myTimer.Stop( testId );
                 }
             break;
+
+        case f_copyif: // copy_if
+            std::cout <<  functionNames[f_copyif] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    myTimer.Start( testId );
+                    bolt::cl::copy_if( ctrl, input1.begin(), input1.end(), output.begin(), unaryPred );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_removeif: // remove_if, partition and the unique family work in place; input1 is restored untimed
+            std::cout <<  functionNames[f_removeif] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    bolt::cl::copy( ctrl, input3.begin(), input3.end(), input1.begin() );
+                    myTimer.Start( testId );
+                    bolt::cl::remove_if( ctrl, input1.begin(), input1.end(), unaryPred );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_unique: // unique
+            std::cout <<  functionNames[f_unique] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    bolt::cl::copy( ctrl, input3.begin(), input3.end(), input1.begin() );
+                    myTimer.Start( testId );
+                    bolt::cl::unique( ctrl, input1.begin(), input1.end(), binaryPredEq );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_uniquebykey: // unique_by_key
+            std::cout <<  functionNames[f_uniquebykey] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    bolt::cl::copy( ctrl, input3.begin(), input3.end(), input1.begin() );
+                    myTimer.Start( testId );
+                    bolt::cl::unique_by_key( ctrl, input1.begin(), input1.end(), input2.begin(), binaryPredEq );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_partition: // partition
+            std::cout <<  functionNames[f_partition] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    bolt::cl::copy( ctrl, input3.begin(), input3.end(), input1.begin() );
+                    myTimer.Start( testId );
+                    bolt::cl::partition( ctrl, input1.begin(), input1.end(), unaryPred );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_stablepartition: // stable_partition
+            std::cout <<  functionNames[f_stablepartition] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    bolt::cl::copy( ctrl, input3.begin(), input3.end(), input1.begin() );
+                    myTimer.Start( testId );
+                    bolt::cl::stable_partition( ctrl, input1.begin(), input1.end(), unaryPred );
+                    myTimer.Stop( testId );
+                }
+            break;
+
+        case f_dispatch: // per-call overhead; a unary transform over at most 64 elements is dominated by the host side
+            {
+            std::cout <<  functionNames[f_dispatch] << std::endl;
+            size_t dispatchLength = std::min< size_t >( input1.size( ), 64 );
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    myTimer.Start( testId );
+                    bolt::cl::transform(ctrl, input1.begin(), input1.begin() + dispatchLength, output.begin(), unaryFunct );
+                    myTimer.Stop( testId );
+                }
+            }
+            break;
+
+        case f_move: // move-heavy pipeline; two transform stages that hand one vector on, counting hand-offs that copied
+            std::cout <<  functionNames[f_move] << std::endl;
+
+                for (size_t iter = 0; iter < iterations+1; iter++)
+                {
+                    const void* storage = storageOf( output );
+                    myTimer.Start( testId );
+                    VectorType stage( std::move( output ) );
+                    bolt::cl::transform(ctrl, input1.begin(), input1.end(), stage.begin(), unaryFunct );
+                    VectorType next( std::move( stage ) );
+                    bolt::cl::transform(ctrl, next.begin(), next.end(), next.begin(), unaryFunct );
+                    output = std::move( next );
+                    myTimer.Stop( testId );
+                    if( storageOf( output ) != storage )
+                        ++moveCopies;
+                }
+            break;
         
         default:
             //std::cout << "Unsupported function=" << function << std::endl;
@@ -933,6 +1122,10 @@ switch(function)
     bolt::tout << std::setw( colWidth ) << _T( "    Time (s): " ) << sortTime << std::endl;
     bolt::tout << std::setw( colWidth ) << _T( "    Speed (GB/s): " ) << testGB / sortTime << std::endl;
     bolt::tout << std::setw( colWidth ) << _T( "    Speed (MKeys/s): " ) << MKeys / sortTime << std::endl;
+    if( function == f_dispatch )
+        bolt::tout << std::setw( colWidth ) << _T( "    Dispatch (us/call): " ) << sortTime * 1000000.0 << std::endl;
+    if( function == f_move )
+        bolt::tout << std::setw( colWidth ) << _T( "    Copying hand-offs: " ) << moveCopies << std::endl;
     bolt::tout << std::endl;
 
 
@@ -961,6 +1154,7 @@ void executeFunction(
         bolt::cl::plus<DATA_TYPE>     binaryFunct;
         bolt::cl::equal_to<DATA_TYPE> binaryPredEq;
         bolt::cl::less<DATA_TYPE>     binaryPredLt;
+        intodd                        unaryPred;
         siz = sizeof(DATA_TYPE);
 
         std::vector<DATA_TYPE> input1(length);
@@ -978,7 +1172,7 @@ void executeFunction(
         if (hostMemory) {
 
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge, 
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
         else
         {
@@ -988,7 +1182,7 @@ void executeFunction(
             bolt::cl::device_vector<DATA_TYPE> boutput(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl); 
             bolt::cl::device_vector<DATA_TYPE> boutput_merge(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);    
             executeFunctionType( ctrl, binput1, binput2, binput3, boutput, boutput_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
     }
     else if (vecType == t_vec2)
@@ -998,6 +1192,7 @@ void executeFunction(
         vec2plus    binaryFunct;
         vec2equal   binaryPredEq;
         vec2less    binaryPredLt;
+        vec2odd     unaryPred;
         siz = sizeof(vec2);
         
         BOLT_ADD_DEPENDENCY(vec2, Bolt_DATA_TYPE);
@@ -1019,7 +1214,7 @@ void executeFunction(
         if (hostMemory) {
 
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
         else
         {
@@ -1029,7 +1224,7 @@ void executeFunction(
             bolt::cl::device_vector<vec2> boutput(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);
             bolt::cl::device_vector<vec2> boutput_merge(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl); 
             executeFunctionType( ctrl, binput1, binput2,binput3, boutput, boutput_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
     }
     else if (vecType == t_vec4)
@@ -1040,6 +1235,7 @@ void executeFunction(
         vec4plus    binaryFunct;
         vec4equal   binaryPredEq;
         vec4less    binaryPredLt;
+        vec4odd     unaryPred;
 
         std::vector<vec4> input1(length, v4init);
         std::vector<vec4> input2(length, v4init);
@@ -1056,7 +1252,7 @@ void executeFunction(
         if (hostMemory) {
 
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
         else
         {
@@ -1066,7 +1262,7 @@ void executeFunction(
             bolt::cl::device_vector<vec4> boutput(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);
             bolt::cl::device_vector<vec4> boutput_merge(output_merge.begin(), output_merge.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
     }
     else if (vecType == t_vec8)
@@ -1076,6 +1272,7 @@ void executeFunction(
         vec8plus    binaryFunct;
         vec8equal   binaryPredEq;
         vec8less    binaryPredLt;
+        vec8odd     unaryPred;
        siz = sizeof(vec8);
 
         std::vector<vec8> input1(length, v8init);
@@ -1093,7 +1290,7 @@ void executeFunction(
         if (hostMemory) {
 
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
         else
         {
@@ -1103,7 +1300,7 @@ void executeFunction(
             bolt::cl::device_vector<vec8> boutput(output.begin(), output.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);
             bolt::cl::device_vector<vec8> boutput_merge(output_merge.begin(), output_merge.end(), BOLT_BENCH_DEVICE_VECTOR_FLAGS,  ctrl);
             executeFunctionType( ctrl, input1, input2, input3, output, output_merge,
-                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, routine, iterations,siz);
+                generator, unaryFunct, binaryFunct, binaryPredEq, binaryPredLt, unaryPred, routine, iterations,siz);
         }
     }
     else
@@ -0,0 +1,351 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Pre-tune the launch shapes of the Bolt algorithms for one device, and write
+ *  the winners to a tuning file that later runs read through
+ *  control::setTuningFile or the BOLT_TUNING_FILE environment variable.
+ *****************************************************************************/
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bolt/cl/functional.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/reduce.h"
+#include "bolt/cl/transform.h"
+#include "bolt/cl/transform_reduce.h"
+#include "bolt/cl/inner_product.h"
+#include "bolt/cl/count.h"
+#include "bolt/cl/min_element.h"
+#include "bolt/unicode.h"
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+template< typename T >
+class ReduceRun: public bolt::cl::tuningRun
+{
+public:
+    ReduceRun( bolt::cl::device_vector< T >& input ): m_input( input ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        m_result = bolt::cl::reduce( ctl, m_input.begin( ), m_input.end( ), T( 0 ), bolt::cl::plus< T >( ) );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    T m_result;
+};
+
+template< typename T >
+class TransformReduceRun: public bolt::cl::tuningRun
+{
+public:
+    TransformReduceRun( bolt::cl::device_vector< T >& input ): m_input( input ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        m_result = bolt::cl::transform_reduce( ctl, m_input.begin( ), m_input.end( ), bolt::cl::negate< T >( ),
+            T( 0 ), bolt::cl::plus< T >( ) );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    T m_result;
+};
+
+template< typename T >
+class InnerProductRun: public bolt::cl::tuningRun
+{
+public:
+    InnerProductRun( bolt::cl::device_vector< T >& input ): m_input( input ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        m_result = bolt::cl::inner_product( ctl, m_input.begin( ), m_input.end( ), m_input.begin( ), T( 0 ),
+            bolt::cl::plus< T >( ), bolt::cl::multiplies< T >( ) );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    T m_result;
+};
+
+template< typename T >
+class CountRun: public bolt::cl::tuningRun
+{
+public:
+    CountRun( bolt::cl::device_vector< T >& input ): m_input( input ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        m_result = bolt::cl::count( ctl, m_input.begin( ), m_input.end( ), T( 1 ) );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    typename bolt::cl::device_vector< T >::difference_type m_result;
+};
+
+template< typename T >
+class MinElementRun: public bolt::cl::tuningRun
+{
+public:
+    MinElementRun( bolt::cl::device_vector< T >& input, bool max ): m_input( input ), m_max( max ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        if( m_max )
+            m_result = bolt::cl::max_element( ctl, m_input.begin( ), m_input.end( ) );
+        else
+            m_result = bolt::cl::min_element( ctl, m_input.begin( ), m_input.end( ) );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    bool m_max;
+    typename bolt::cl::device_vector< T >::iterator m_result;
+};
+
+template< typename T >
+class TransformRun: public bolt::cl::tuningRun
+{
+public:
+    TransformRun( bolt::cl::device_vector< T >& input, bolt::cl::device_vector< T >& output ):
+        m_input( input ), m_output( output ) { }
+
+    void operator( )( bolt::cl::control &ctl )
+    {
+        bolt::cl::transform( ctl, m_input.begin( ), m_input.end( ), m_output.begin( ), bolt::cl::negate< T >( ) );
+        ctl.getCommandQueue( ).finish( );
+    }
+
+private:
+    bolt::cl::device_vector< T >& m_input;
+    bolt::cl::device_vector< T >& m_output;
+};
+
+//  The parameters each algorithm reads from its tuning entry
+const unsigned reduceSpace = bolt::cl::TuneWgSize | bolt::cl::TuneWgPerComputeUnit | bolt::cl::TuneItemsPerWorkItem |
+    bolt::cl::TuneUnroll;
+const unsigned transformSpace = bolt::cl::TuneWgSize;
+const unsigned reductionSpace = bolt::cl::TuneWgSize | bolt::cl::TuneWgPerComputeUnit | bolt::cl::TuneItemsPerWorkItem;
+
+template< typename T >
+void tuneType( bolt::cl::control& ctl, const std::vector< std::string >& algorithms, size_t minLog2, size_t maxLog2,
+               int repetitions )
+{
+    const std::string typeName = TypeName< T >::get( );
+
+    for( size_t log2 = minLog2; log2 <= maxLog2; ++log2 )
+    {
+        const size_t length = size_t( 1 ) << log2;
+        bolt::cl::device_vector< T > input( length, T( 1 ), CL_MEM_READ_WRITE, true, ctl );
+
+        for( size_t a = 0; a < algorithms.size( ); ++a )
+        {
+            bolt::cl::tuningParams best;
+            if( algorithms[ a ] == "reduce" )
+            {
+                const bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+                ReduceRun< T > run( input );
+                best = bolt::cl::sweepTuning( ctl, "reduce", typeName, length, run, defaults, reduceSpace,
+                    repetitions );
+            }
+            else if( algorithms[ a ] == "transform_reduce" )
+            {
+                const bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+                TransformReduceRun< T > run( input );
+                best = bolt::cl::sweepTuning( ctl, "transform_reduce", typeName, length, run, defaults,
+                    reductionSpace, repetitions );
+            }
+            else if( algorithms[ a ] == "inner_product" )
+            {
+                const bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+                InnerProductRun< T > run( input );
+                best = bolt::cl::sweepTuning( ctl, "inner_product", typeName, length, run, defaults,
+                    reductionSpace, repetitions );
+            }
+            else if( algorithms[ a ] == "count" )
+            {
+                const bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+                CountRun< T > run( input );
+                best = bolt::cl::sweepTuning( ctl, "count", typeName, length, run, defaults, reductionSpace,
+                    repetitions );
+            }
+            else if( algorithms[ a ] == "min_element" || algorithms[ a ] == "max_element" )
+            {
+                const bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+                MinElementRun< T > run( input, algorithms[ a ] == "max_element" );
+                best = bolt::cl::sweepTuning( ctl, algorithms[ a ].c_str( ), typeName, length, run, defaults,
+                    reductionSpace, repetitions );
+            }
+            else if( algorithms[ a ] == "transform" )
+            {
+                const bolt::cl::tuningParams defaults = { 64, 64, 1, 1 };
+                bolt::cl::device_vector< T > output( length, T( 0 ), CL_MEM_READ_WRITE, false, ctl );
+                TransformRun< T > run( input, output );
+                best = bolt::cl::sweepTuning( ctl, "transform", typeName, length, run, defaults, transformSpace,
+                    repetitions );
+            }
+            else
+            {
+                std::cout << "Skipping unknown algorithm " << algorithms[ a ] << std::endl;
+                continue;
+            }
+
+            std::cout << algorithms[ a ] << " < " << typeName << " > 2^" << log2 << ": wgSize " << best.wgSize
+                << ", wgPerComputeUnit " << best.wgPerComputeUnit << ", itemsPerWorkItem " << best.itemsPerWorkItem
+                << ", unroll " << best.unroll << std::endl;
+        }
+    }
+}
+
+std::vector< std::string > splitList( const std::string& list )
+{
+    std::vector< std::string > items;
+    std::istringstream stream( list );
+    std::string item;
+    while( std::getline( stream, item, ',' ) )
+        if( !item.empty( ) )
+            items.push_back( item );
+    return items;
+}
+
+int _tmain( int argc, _TCHAR* argv[ ] )
+{
+    cl_uint userDevice      = 0;
+    size_t minLog2          = 12;
+    size_t maxLog2          = 24;
+    int repetitions         = 5;
+    std::string algorithms  = "reduce,transform_reduce,inner_product,count,min_element,max_element,transform";
+    std::string types       = "int,uint,float,double";
+    std::string filename    = bolt::cl::control::getDefault( ).getTuningFile( );
+    bool verbose            = false;
+
+    /******************************************************************************
+     * Parse Command-line Parameters
+     ******************************************************************************/
+    try
+    {
+        po::options_description desc( "Bolt OpenCL tuning command line options" );
+        desc.add_options()
+            ( "help,h",         "produces this help message" )
+            ( "queryOpenCL,q",  "Print queryable platform and device info and return" )
+            ( "verbose,V",      "Print the time of every launch shape tried" )
+            ( "device,d",       po::value< cl_uint >( &userDevice )->default_value( userDevice ),
+                "Specify the device to tune using the index reported by the -q flag" )
+            ( "file,f",         po::value< std::string >( &filename )->default_value( filename ),
+                "Tuning file the winners are appended to; defaults to BOLT_TUNING_FILE" )
+            ( "algorithms,A",   po::value< std::string >( &algorithms )->default_value( algorithms ),
+                "Comma separated algorithms to tune: reduce, transform_reduce, inner_product, count, min_element, "
+                "max_element, transform" )
+            ( "types,t",        po::value< std::string >( &types )->default_value( types ),
+                "Comma separated value types to tune: int, uint, float, double" )
+            ( "min-log2",       po::value< size_t >( &minLog2 )->default_value( minLog2 ),
+                "Smallest input length to tune, as a power of two" )
+            ( "max-log2",       po::value< size_t >( &maxLog2 )->default_value( maxLog2 ),
+                "Largest input length to tune, as a power of two" )
+            ( "repetitions,i",  po::value< int >( &repetitions )->default_value( repetitions ),
+                "Timed runs of every launch shape" )
+            ;
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, desc ), vm );
+        po::notify( vm );
+
+        if( vm.count( "help" ) )
+        {
+            //  This needs to be 'cout' as program-options does not support wcout yet
+            std::cout << desc << std::endl;
+            return 0;
+        }
+
+        if( vm.count( "queryOpenCL" ) )
+        {
+            bolt::cl::control::printPlatforms( true, CL_DEVICE_TYPE_ALL );
+            return 0;
+        }
+
+        if( vm.count( "verbose" ) )
+        {
+            verbose = true;
+        }
+    }
+    catch( std::exception& e )
+    {
+        std::cout << _T( "Tune error condition reported:" ) << std::endl << e.what( ) << std::endl;
+        return 1;
+    }
+
+    if( filename.empty( ) )
+    {
+        std::cout << "No tuning file: pass --file or set BOLT_TUNING_FILE" << std::endl;
+        return 1;
+    }
+
+    /******************************************************************************
+     * Initialize the device and tune
+     ******************************************************************************/
+    try
+    {
+        bolt::cl::control ctrl = bolt::cl::control::getDefault( );
+
+        ::cl::Context myContext = ctrl.getContext( );
+        std::vector< ::cl::Device > devices = myContext.getInfo< CL_CONTEXT_DEVICES >( );
+        ::cl::CommandQueue myQueue( myContext, devices.at( userDevice ) );
+
+        ctrl.setCommandQueue( myQueue );
+        ctrl.setForceRunMode( bolt::cl::control::OpenCL );
+        ctrl.setTuningFile( filename );
+        if( verbose )
+            ctrl.setDebugMode( bolt::cl::control::debug::AutoTune );
+
+        std::cout << "Device: " << ctrl.getDevice( ).getInfo< CL_DEVICE_NAME >( ) << std::endl;
+
+        std::vector< std::string > algorithmList = splitList( algorithms );
+        std::vector< std::string > typeList = splitList( types );
+        for( size_t t = 0; t < typeList.size( ); ++t )
+        {
+            if( typeList[ t ] == "int" )
+                tuneType< int >( ctrl, algorithmList, minLog2, maxLog2, repetitions );
+            else if( typeList[ t ] == "uint" )
+                tuneType< unsigned int >( ctrl, algorithmList, minLog2, maxLog2, repetitions );
+            else if( typeList[ t ] == "float" )
+                tuneType< float >( ctrl, algorithmList, minLog2, maxLog2, repetitions );
+            else if( typeList[ t ] == "double" )
+                tuneType< double >( ctrl, algorithmList, minLog2, maxLog2, repetitions );
+            else
+                std::cout << "Skipping unknown type " << typeList[ t ] << std::endl;
+        }
+    }
+    catch( ::cl::Error& e )
+    {
+        std::cout << "Tune OpenCL error: " << e.what( ) << " ( " << e.err( ) << " )" << std::endl;
+        return 1;
+    }
+    catch( std::exception& e )
+    {
+        std::cout << "Tune error: " << e.what( ) << std::endl;
+        return 1;
+    }
+
+    std::cout << "Tuning written to " << filename << std::endl;
+    return 0;
+}
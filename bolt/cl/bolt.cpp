@@ -17,15 +17,29 @@
 
 
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <sstream>
 #include <streambuf>
+#include <cstdio>
 #if defined( _WIN32 )
 #include <direct.h>  //windows CWD for error message
+#include <process.h>
+#else
+#include <unistd.h>
 #endif
 #include <bolt/unicode.h>
 #include <algorithm>
 #include <vector>
 #include <set>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "bolt/cl/bolt.h"
 #include "bolt/unicode.h"
@@ -33,18 +47,24 @@
 //  Include all kernel string objects
 
 #include "bolt/binary_search_kernels.hpp"
+#include "bolt/compaction_kernels.hpp"
 #include "bolt/copy_kernels.hpp"
 #include "bolt/count_kernels.hpp"
 #include "bolt/fill_kernels.hpp"
 #include "bolt/gather_kernels.hpp"
 #include "bolt/generate_kernels.hpp"
+#include "bolt/histogram_kernels.hpp"
+#include "bolt/inner_product_kernels.hpp"
 #include "bolt/merge_kernels.hpp"
+#include "bolt/radix_sort_kernels.hpp"
 #include "bolt/min_element_kernels.hpp"
 #include "bolt/reduce_kernels.hpp"
 #include "bolt/reduce_by_key_kernels.hpp"
 #include "bolt/scan_kernels.hpp"
 #include "bolt/scan_by_key_kernels.hpp"
+#include "bolt/scan_lookback_kernels.hpp"
 #include "bolt/scatter_kernels.hpp"
+#include "bolt/segmented_sort_kernels.hpp"
 #include "bolt/sort_kernels.hpp"
 #include "bolt/sort_uint_kernels.hpp"
 #include "bolt/sort_int_kernels.hpp"
@@ -386,7 +406,8 @@ namespace bolt {
         const ::cl::Context& context,
         const ::cl::Device&  device,
         const ::std::string& compileOptions,
-        const ::std::string& completeKernelSource
+        const ::std::string& completeKernelSource,
+        const ::std::string& kernelCacheDir
         );
 
     /**********************************************************************
@@ -403,8 +424,224 @@ namespace bolt {
         const ::std::string& completeKernelSource,
         cl_int * err = NULL);
 
+    /**********************************************************************
+        * createKernels
+        * returns the kernels named by kts, created from a built program.
+        * Called from getKernels.
+        **********************************************************************/
+    ::std::vector< ::cl::Kernel > createKernels(
+        const KernelTemplateSpecializer * const kts,
+        const ::cl::Program& program );
+
+    /**********************************************************************
+        * loadProgramBinary / storeProgramBinary
+        * Persistent on-disk cache of compiled program binaries, keyed by a
+        * hash of the kernel source, compile options, device and driver.
+        * Called from acquireProgram when the in-memory ProgramMap misses.
+        **********************************************************************/
+    bool loadProgramBinary(
+        const ::cl::Context& context,
+        const ::cl::Device&  device,
+        const ::std::string& compileOptions,
+        const ::std::string& fileName,
+        ::cl::Program& program );
+
+    void storeProgramBinary(
+        const ::cl::Program& program,
+        const ::cl::Device&  device,
+        const ::std::string& fileName );
+
+
+    /**************************************************************************
+     * BalancedWait - spin for a window learned per kernel name, then block
+     *************************************************************************/
+    //  Exponentially weighted mean of how long waits on one kernel name took, measured from entry to wait( )
+    struct kernelWaitProfile
+    {
+        double meanSeconds;
+        cl_uint samples;
+    };
+
+    static const double defaultSpinSeconds = 50e-6;  // before a kernel name has any history
+    static const double minSpinSeconds = 10e-6;
+    static const double maxSpinSeconds = 1e-3;      // longer waits amortize the wake-up latency of blocking
+
+    static boost::mutex waitProfileGuard;
+    static std::map< std::string, kernelWaitProfile > waitProfiles;
+    static waitStatistics waitTotals = { 0, 0, 0.0, 0.0 };
+
+    static double balancedSpinWindow( const std::string& kernelName )
+    {
+        boost::lock_guard< boost::mutex > lock( waitProfileGuard );
+
+        std::map< std::string, kernelWaitProfile >::const_iterator it = waitProfiles.find( kernelName );
+        if( it == waitProfiles.end( ) )
+            return defaultSpinSeconds;
+
+        //  Spin somewhat past the expected completion; waits that are long anyway only get a short spin to catch
+        //  an early finish before blocking
+        if( it->second.meanSeconds > maxSpinSeconds )
+            return minSpinSeconds;
+        return std::min( std::max( 2.0 * it->second.meanSeconds, minSpinSeconds ), maxSpinSeconds );
+    }
+
+    static void recordBalancedWait( const std::string& kernelName, double spinSeconds, double blockSeconds )
+    {
+        boost::lock_guard< boost::mutex > lock( waitProfileGuard );
+
+        const double elapsed = spinSeconds + blockSeconds;
+        kernelWaitProfile& profile = waitProfiles[ kernelName ];
+        if( profile.samples == 0 )
+            profile.meanSeconds = elapsed;
+        else
+            profile.meanSeconds += ( elapsed - profile.meanSeconds ) / 4.0;
+        ++profile.samples;
+
+        if( blockSeconds > 0.0 )
+            ++waitTotals.blockWaits;
+        else
+            ++waitTotals.spinWaits;
+        waitTotals.spinSeconds += spinSeconds;
+        waitTotals.blockSeconds += blockSeconds;
+    }
+
+    struct completionSignal
+    {
+        boost::mutex guard;
+        boost::condition_variable done;
+        bool complete;
+    };
+
+    //  The callback owns a reference to the signal, so it stays valid until the notification has been delivered
+    static void CL_CALLBACK signalCompletion( cl_event, cl_int, void* userData )
+    {
+        boost::shared_ptr< completionSignal >* signal = static_cast< boost::shared_ptr< completionSignal >* >( userData );
+        {
+            boost::lock_guard< boost::mutex > lock( ( *signal )->guard );
+            ( *signal )->complete = true;
+        }
+        ( *signal )->done.notify_all( );
+        delete signal;
+    }
+
+    //  Puts the calling thread to sleep until e completes
+    static void blockOnEvent( ::cl::Event &e )
+    {
+        boost::shared_ptr< completionSignal > signal( new completionSignal );
+        signal->complete = false;
+
+        boost::shared_ptr< completionSignal >* callbackRef = new boost::shared_ptr< completionSignal >( signal );
+        if( e.setCallback( CL_COMPLETE, signalCompletion, callbackRef ) != CL_SUCCESS )
+        {
+            //  No event callbacks (OpenCL 1.0); let the runtime block instead
+            delete callbackRef;
+            V_OPENCL( e.wait( ), "wait call failed" );
+            return;
+        }
+
+        boost::unique_lock< boost::mutex > lock( signal->guard );
+        while( !signal->complete )
+            signal->done.wait( lock );
+    }
+
+    static void balancedWait( const bolt::cl::control &ctl, ::cl::Event &e, const char* kernelName )
+    {
+        typedef boost::chrono::high_resolution_clock clock;
+
+        const std::string key = ( kernelName != NULL ) ? kernelName : "";
+        const double window = balancedSpinWindow( key );
+
+        V_OPENCL( ctl.getCommandQueue( ).flush( ), "flush call failed" );
+
+        const clock::time_point start = clock::now( );
+        clock::time_point now = start;
+        cl_int status = e.getInfo< CL_EVENT_COMMAND_EXECUTION_STATUS >( );
+        while( status > CL_COMPLETE && boost::chrono::duration< double >( now - start ).count( ) < window )
+        {
+            status = e.getInfo< CL_EVENT_COMMAND_EXECUTION_STATUS >( );
+            now = clock::now( );
+        }
+        const double spinSeconds = boost::chrono::duration< double >( now - start ).count( );
+
+        double blockSeconds = 0.0;
+        if( status > CL_COMPLETE )
+        {
+            blockOnEvent( e );
+            blockSeconds = boost::chrono::duration< double >( clock::now( ) - now ).count( );
+            status = e.getInfo< CL_EVENT_COMMAND_EXECUTION_STATUS >( );
+        }
+
+        recordBalancedWait( key, spinSeconds, blockSeconds );
+
+        //  A negative execution status is the error that terminated the command
+        V_OPENCL( status, "command terminated abnormally" );
+    }
+
+    waitStatistics getWaitStatistics( )
+    {
+        boost::lock_guard< boost::mutex > lock( waitProfileGuard );
+        return waitTotals;
+    }
+
+    void resetWaitStatistics( )
+    {
+        boost::lock_guard< boost::mutex > lock( waitProfileGuard );
+        waitStatistics zero = { 0, 0, 0.0, 0.0 };
+        waitTotals = zero;
+    }
+
+    static boost::mutex hostPtrGuard;
+    static std::map< cl_device_id, bool > unifiedMemoryDevices;
+    static hostPtrStatistics hostPtrTotals = { 0, 0, 0 };
+
+    bool recordHostPtrWrap( const bolt::cl::control &ctl, const void* hostPtr, size_t bytes )
+    {
+        ::cl::Device device = ctl.getDevice( );
+
+        boost::lock_guard< boost::mutex > lock( hostPtrGuard );
+
+        std::map< cl_device_id, bool >::iterator it = unifiedMemoryDevices.find( device( ) );
+        if( it == unifiedMemoryDevices.end( ) )
+        {
+            cl_int l_Error = CL_SUCCESS;
+            cl_bool unified = device.getInfo< CL_DEVICE_HOST_UNIFIED_MEMORY >( &l_Error );
+            V_OPENCL( l_Error, "Device::getInfo< CL_DEVICE_HOST_UNIFIED_MEMORY > failed" );
+            it = unifiedMemoryDevices.insert( std::make_pair( device( ), unified == CL_TRUE ) ).first;
+        }
+
+        const bool zeroCopy = it->second && ( reinterpret_cast< size_t >( hostPtr ) % zeroCopyAlignment ) == 0;
+        if( zeroCopy )
+        {
+            ++hostPtrTotals.zeroCopies;
+            return true;
+        }
+
+        ++hostPtrTotals.implicitCopies;
+        hostPtrTotals.implicitCopyBytes += bytes;
+
+        if( ctl.getDebugMode( ) & control::debug::HostCopies )
+        {
+            std::cout << "Bolt: implicit copy of " << bytes << " bytes of host memory at " << hostPtr << "; "
+                << ( it->second ? "the range is not aligned to a page, see bolt::cl::aligned_allocator"
+                                : "the device does not share memory with the host" ) << std::endl;
+        }
+        return false;
+    }
 
-    void wait(const bolt::cl::control &ctl, ::cl::Event &e)
+    hostPtrStatistics getHostPtrStatistics( )
+    {
+        boost::lock_guard< boost::mutex > lock( hostPtrGuard );
+        return hostPtrTotals;
+    }
+
+    void resetHostPtrStatistics( )
+    {
+        boost::lock_guard< boost::mutex > lock( hostPtrGuard );
+        hostPtrStatistics zero = { 0, 0, 0 };
+        hostPtrTotals = zero;
+    }
+
+    void wait(const bolt::cl::control &ctl, ::cl::Event &e, const char* kernelName)
     {
         const bolt::cl::control::e_WaitMode waitMode = ctl.getWaitMode();
         if (waitMode == bolt::cl::control::BusyWait) {
@@ -413,7 +650,10 @@ namespace bolt {
             while (e.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) {
                 // spin here for fast completion detection...
             };
-        } else if ((waitMode == bolt::cl::control::NiceWait) || (waitMode == bolt::cl::control::BalancedWait)) {
+        } else if (waitMode == bolt::cl::control::BalancedWait) {
+            balancedWait( ctl, e, kernelName );
+        } else if ((waitMode == bolt::cl::control::NiceWait) || (waitMode == bolt::cl::control::NoWait)) {
+            // NoWait only defers the end of a call (see deferredWait); host reads of mapped results still block
             cl_int l_Error = e.wait();
             V_OPENCL( l_Error, "wait call failed" );
         } else if (waitMode == bolt::cl::control::ClFinish) {
@@ -423,6 +663,539 @@ namespace bolt {
         }
     };
 
+    void deferredWait(const bolt::cl::control &ctl, ::cl::Event &e, const char* kernelName)
+    {
+        if (ctl.getWaitMode() == bolt::cl::control::NoWait) {
+            cl_int l_Error = ctl.getCommandQueue().flush();
+            V_OPENCL( l_Error, "flush call failed" );
+        } else {
+            wait( ctl, e, kernelName );
+        }
+    };
+
+    size_t reduceWorkGroups( const bolt::cl::control &ctl, size_t length, size_t wgSize )
+    {
+        //  Each work-item should reduce a few elements serially before the tree reduction in local memory; beyond
+        //  wgPerComputeUnit groups per compute unit the device is saturated and more groups only add partials
+        tuningParams shape = { wgSize, 64, 8, 1 };
+        return reduceWorkGroups( ctl, length, shape );
+    }
+
+    size_t reduceWorkGroups( const bolt::cl::control &ctl, size_t length, const tuningParams& shape )
+    {
+        const size_t perGroup = shape.wgSize * std::max< size_t >( shape.itemsPerWorkItem, 1 );
+
+        cl_uint computeUnits = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
+        size_t maxWG = computeUnits * std::max< size_t >( shape.wgPerComputeUnit, 1 );
+        size_t sizedWG = ( length + perGroup - 1 ) / perGroup;
+
+        return std::max< size_t >( 1, std::min( sizedWG, maxWG ) );
+    }
+
+    bool singlePassScanSupported( const bolt::cl::control &ctl )
+    {
+        //  The scans launch one work-item groups on CPU devices, where the look-back would degrade to a serial
+        //  chain through every element; GPUs are the devices whose fences order writes between running groups
+        cl_device_type type = ctl.getDevice( ).getInfo< CL_DEVICE_TYPE >( );
+        return ( type & CL_DEVICE_TYPE_GPU ) != 0;
+    }
+
+    int radixSortBits( const bolt::cl::control &ctl )
+    {
+        //  The 8 bit permute keeps about 8KB of histograms, offsets and staged keys in local memory; emulated
+        //  local memory on CPUs turns the 256 entry histograms into cache traffic for no gain
+        ::cl::Device device = ctl.getDevice( );
+        bool gpu = ( device.getInfo< CL_DEVICE_TYPE >( ) & CL_DEVICE_TYPE_GPU ) != 0;
+        bool dedicatedLocal = device.getInfo< CL_DEVICE_LOCAL_MEM_TYPE >( ) == CL_LOCAL;
+        cl_ulong localSize = device.getInfo< CL_DEVICE_LOCAL_MEM_SIZE >( );
+
+        return ( gpu && dedicatedLocal && localSize >= 16 * 1024 ) ? 8 : 4;
+    }
+
+    /**************************************************************************
+     * Run mode thresholds - crossover sizes of control::Automatic, per device
+     *************************************************************************/
+    static const size_t maxRunModeThreshold = 64 * 1024 * 1024;
+
+    static boost::mutex runModeGuard;
+    static std::map< cl_device_id, runModeThresholds > runModeCalibrations;
+
+    static size_t runModeCrossover( double bytes )
+    {
+        return ( bytes < static_cast< double >( maxRunModeThreshold ) ) ? static_cast< size_t >( bytes ) :
+            maxRunModeThreshold;
+    }
+
+    //  Seconds per byte of a serial pass over an array that stays in cache
+    static double hostSecondsPerByte( )
+    {
+        typedef boost::chrono::high_resolution_clock clock;
+
+        std::vector< int > data( 64 * 1024 );
+        for( size_t i = 0; i < data.size( ); ++i )
+            data[ i ] = static_cast< int >( i );
+
+        double best = std::numeric_limits< double >::max( );
+        volatile int sink = 0;
+        for( int r = 0; r < 5; ++r )
+        {
+            clock::time_point start = clock::now( );
+            int sum = 0;
+            for( size_t i = 0; i < data.size( ); ++i )
+                sum += data[ i ];
+            sink = sum;
+            best = std::min( best, boost::chrono::duration< double >( clock::now( ) - start ).count( ) );
+        }
+        return best / ( data.size( ) * sizeof( int ) );
+    }
+
+    //  A parallel call has to wake sleeping worker threads before they share any of its work
+    static double threadWakeSeconds( )
+    {
+        typedef boost::chrono::high_resolution_clock clock;
+
+        boost::mutex guard;
+        boost::condition_variable turnChanged;
+        int turn = 0;
+        bool done = false;
+
+        boost::thread worker( [ & ]( )
+        {
+            boost::unique_lock< boost::mutex > lock( guard );
+            for( ;; )
+            {
+                while( turn != 1 && !done )
+                    turnChanged.wait( lock );
+                if( done )
+                    return;
+                turn = 0;
+                turnChanged.notify_all( );
+            }
+        } );
+
+        double best = std::numeric_limits< double >::max( );
+        for( int r = 0; r < 9; ++r )
+        {
+            boost::unique_lock< boost::mutex > lock( guard );
+            clock::time_point start = clock::now( );
+            turn = 1;
+            turnChanged.notify_all( );
+            while( turn != 0 )
+                turnChanged.wait( lock );
+            best = std::min( best, boost::chrono::duration< double >( clock::now( ) - start ).count( ) );
+        }
+
+        {
+            boost::lock_guard< boost::mutex > lock( guard );
+            done = true;
+            turnChanged.notify_all( );
+        }
+        worker.join( );
+        return best;
+    }
+
+    //  The least any device call costs: a command reaches the device and the host learns that it completed
+    static double deviceRoundTripSeconds( const bolt::cl::control &ctl )
+    {
+        typedef boost::chrono::high_resolution_clock clock;
+
+        ::cl::CommandQueue queue = ctl.getCommandQueue( );
+        ::cl::Buffer buffer( ctl.getContext( ), CL_MEM_READ_WRITE, sizeof( cl_int ) );
+        cl_int written = 0;
+        cl_int read = 0;
+
+        //  The first round trip also allocates the buffer on the device
+        double best = std::numeric_limits< double >::max( );
+        for( int r = 0; r < 9; ++r )
+        {
+            clock::time_point start = clock::now( );
+            V_OPENCL( queue.enqueueWriteBuffer( buffer, CL_FALSE, 0, sizeof( cl_int ), &written ),
+                "Error writing the run mode calibration buffer" );
+            V_OPENCL( queue.enqueueReadBuffer( buffer, CL_TRUE, 0, sizeof( cl_int ), &read ),
+                "Error reading the run mode calibration buffer" );
+            if( r > 0 )
+                best = std::min( best, boost::chrono::duration< double >( clock::now( ) - start ).count( ) );
+        }
+        return best;
+    }
+
+    runModeThresholds getRunModeThresholds( const bolt::cl::control &ctl )
+    {
+        runModeThresholds thresholds = { ctl.getMultiCoreCpuThreshold( ), ctl.getOpenCLThreshold( ) };
+        if( thresholds.multiCoreCpuBytes != 0 && thresholds.openclBytes != 0 )
+            return thresholds;
+
+        const bool hasDevice = ctl.getCommandQueue( )( ) != NULL;
+        cl_device_id device = hasDevice ? ctl.getDevice( )( ) : NULL;
+
+        //  Calibration holds the guard, so concurrent first calls measure once and do not disturb each other
+        boost::lock_guard< boost::mutex > lock( runModeGuard );
+
+        std::map< cl_device_id, runModeThresholds >::iterator it = runModeCalibrations.find( device );
+        if( it == runModeCalibrations.end( ) )
+        {
+            const double perByte = std::max( hostSecondsPerByte( ), 1e-13 );
+            const unsigned cores = boost::thread::hardware_concurrency( );
+
+            runModeThresholds calibrated;
+            calibrated.multiCoreCpuBytes = ( cores > 1 ) ?
+                runModeCrossover( threadWakeSeconds( ) / ( perByte * ( 1.0 - 1.0 / cores ) ) ) : maxRunModeThreshold;
+            calibrated.openclBytes = hasDevice ?
+                runModeCrossover( deviceRoundTripSeconds( ctl ) / perByte ) : maxRunModeThreshold;
+
+            it = runModeCalibrations.insert( std::make_pair( device, calibrated ) ).first;
+        }
+
+        if( thresholds.multiCoreCpuBytes == 0 )
+            thresholds.multiCoreCpuBytes = it->second.multiCoreCpuBytes;
+        if( thresholds.openclBytes == 0 )
+            thresholds.openclBytes = it->second.openclBytes;
+        return thresholds;
+    }
+
+    /**************************************************************************
+     * Host split - share of a call that runs on the host, learned per algorithm
+     *************************************************************************/
+    struct hostSplitProfile
+    {
+        double share;       // exponentially weighted mean of the balanced host share of recent splits
+        cl_uint samples;
+        cl_uint skipped;    // calls kept on the device since the last probe of a slow host
+    };
+
+    static const size_t hostSplitMinimum = 1 << 20;     // below this the task and launch overheads dominate
+    static const double initialHostShare = 0.2;         // before an algorithm has any history
+    static const double minHostShare = 1.0 / 64;
+    static const double maxHostShare = 0.9;
+    static const cl_uint hostSplitProbeInterval = 32;
+
+    static boost::mutex hostSplitGuard;
+    static std::map< std::string, hostSplitProfile > hostSplitProfiles;
+
+    size_t hostSplitLength( const bolt::cl::control &ctl, const char* algorithm, size_t length )
+    {
+        if( ctl.getHostSplit( ) != bolt::cl::control::HostSplit || length < hostSplitMinimum )
+            return 0;
+
+        //  A forced run mode names the one place the call runs
+        if( ctl.getForceRunMode( ) != bolt::cl::control::Automatic )
+            return 0;
+
+        //  A CPU device already runs on the cores the host part would use
+        if( ctl.getDevice( ).getInfo< CL_DEVICE_TYPE >( ) & CL_DEVICE_TYPE_CPU )
+            return 0;
+
+        double share = initialHostShare;
+        {
+            boost::lock_guard< boost::mutex > lock( hostSplitGuard );
+
+            std::map< std::string, hostSplitProfile >::iterator it = hostSplitProfiles.find( algorithm );
+            if( it != hostSplitProfiles.end( ) )
+            {
+                share = it->second.share;
+                if( share < minHostShare )
+                {
+                    if( ++it->second.skipped < hostSplitProbeInterval )
+                        return 0;
+                    it->second.skipped = 0;
+                    share = minHostShare;
+                }
+            }
+        }
+
+        return static_cast< size_t >( share * length );
+    }
+
+    void recordHostSplit( const char* algorithm, size_t hostLength, double hostSeconds, size_t deviceLength,
+                          double deviceSeconds )
+    {
+        if( hostLength == 0 || deviceLength == 0 )
+            return;
+
+        //  Both sides finish together when each gets elements in proportion to the rate it reached
+        const double hostRate = hostLength / std::max( hostSeconds, 1e-9 );
+        const double deviceRate = deviceLength / std::max( deviceSeconds, 1e-9 );
+        const double balanced = std::min( hostRate / ( hostRate + deviceRate ), maxHostShare );
+
+        boost::lock_guard< boost::mutex > lock( hostSplitGuard );
+
+        hostSplitProfile& profile = hostSplitProfiles[ algorithm ];
+        if( profile.samples == 0 )
+            profile.share = balanced;
+        else
+            profile.share += ( balanced - profile.share ) / 4.0;
+        ++profile.samples;
+    }
+
+    double getHostSplitShare( const char* algorithm )
+    {
+        boost::lock_guard< boost::mutex > lock( hostSplitGuard );
+
+        std::map< std::string, hostSplitProfile >::const_iterator it = hostSplitProfiles.find( algorithm );
+        return ( it != hostSplitProfiles.end( ) ) ? it->second.share : initialHostShare;
+    }
+
+    void resetHostSplitProfiles( )
+    {
+        boost::lock_guard< boost::mutex > lock( hostSplitGuard );
+        hostSplitProfiles.clear( );
+    }
+
+    /**************************************************************************
+     * Tuning database - launch shapes per device, algorithm, type and size
+     *************************************************************************/
+    //  Tuned sizes of one device, algorithm and value type, by the power of two at or below the length
+    typedef std::map< int, tuningParams > tuningBuckets;
+
+    static boost::mutex tuningGuard;
+    static std::map< std::string, tuningBuckets > tuningEntries;
+    static std::set< std::string > tuningFilesRead;
+    static std::map< cl_device_id, std::string > tuningDeviceNames;
+
+    static int tuningBucket( size_t length )
+    {
+        int bucket = 0;
+        while( length > 1 )
+        {
+            length >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    //  Fields of the tuning file are separated by tabs, which appear in none of the names
+    static std::string tuningKey( const std::string& device, const std::string& algorithm, const std::string& typeName )
+    {
+        return device + '\t' + algorithm + '\t' + typeName;
+    }
+
+    //  A driver update can change the best shape as much as a new device, so the key names both
+    static std::string tuningDevice( const bolt::cl::control &ctl )
+    {
+        ::cl::Device device = ctl.getDevice( );
+
+        boost::lock_guard< boost::mutex > lock( tuningGuard );
+        std::map< cl_device_id, std::string >::iterator it = tuningDeviceNames.find( device( ) );
+        if( it == tuningDeviceNames.end( ) )
+        {
+            std::string name = device.getInfo< CL_DEVICE_NAME >( ).c_str( );
+            std::string driver = device.getInfo< CL_DRIVER_VERSION >( ).c_str( );
+            it = tuningDeviceNames.insert( std::make_pair( device( ), name + " / " + driver ) ).first;
+        }
+        return it->second;
+    }
+
+    //  Called with tuningGuard held
+    static void readTuningFile( const std::string& path )
+    {
+        if( path.empty( ) || !tuningFilesRead.insert( path ).second )
+            return;
+
+        std::ifstream file( path.c_str( ) );
+        std::string line;
+        while( std::getline( file, line ) )
+        {
+            if( line.empty( ) || line[ 0 ] == '#' )
+                continue;
+
+            std::vector< std::string > fields;
+            std::istringstream fieldStream( line );
+            std::string field;
+            while( std::getline( fieldStream, field, '\t' ) )
+                fields.push_back( field );
+            if( fields.size( ) != 8 )
+                continue;
+
+            std::istringstream values( fields[ 3 ] + ' ' + fields[ 4 ] + ' ' + fields[ 5 ] + ' ' + fields[ 6 ] + ' ' +
+                fields[ 7 ] );
+            int bucket;
+            tuningParams params;
+            if( !( values >> bucket >> params.wgSize >> params.wgPerComputeUnit >> params.itemsPerWorkItem >>
+                params.unroll ) || params.wgSize == 0 )
+                continue;
+
+            tuningEntries[ tuningKey( fields[ 0 ], fields[ 1 ], fields[ 2 ] ) ][ bucket ] = params;
+        }
+    }
+
+    tuningParams findTuning( const bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                             size_t length, const tuningParams& defaults )
+    {
+        if( !( ctl.getAutoTune( ) & bolt::cl::control::AutoTuneWorkShape ) )
+            return defaults;
+
+        const std::string key = tuningKey( tuningDevice( ctl ), algorithm, typeName );
+        const int bucket = tuningBucket( length );
+
+        boost::lock_guard< boost::mutex > lock( tuningGuard );
+        readTuningFile( ctl.getTuningFile( ) );
+
+        std::map< std::string, tuningBuckets >::const_iterator entry = tuningEntries.find( key );
+        if( entry == tuningEntries.end( ) || entry->second.empty( ) )
+            return defaults;
+
+        //  The nearest tuned size, the smaller one on a tie
+        const tuningBuckets& buckets = entry->second;
+        tuningBuckets::const_iterator above = buckets.lower_bound( bucket );
+        if( above == buckets.end( ) )
+            return ( --above )->second;
+        if( above == buckets.begin( ) || above->first == bucket )
+            return above->second;
+
+        tuningBuckets::const_iterator below = above;
+        --below;
+        return ( bucket - below->first <= above->first - bucket ) ? below->second : above->second;
+    }
+
+    tuningParams findReduceTuning( const bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                                   size_t length, const tuningParams& defaults )
+    {
+        tuningParams shape = findTuning( ctl, algorithm, typeName, length, defaults );
+        if( shape.wgSize != 64 && shape.wgSize != 128 && shape.wgSize != 256 )
+            shape.wgSize = defaults.wgSize;
+        return shape;
+    }
+
+    void storeTuning( const bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                      size_t length, const tuningParams& params )
+    {
+        const std::string device = tuningDevice( ctl );
+        const int bucket = tuningBucket( length );
+        const std::string path = ctl.getTuningFile( );
+
+        boost::lock_guard< boost::mutex > lock( tuningGuard );
+
+        //  Read the file first, or its older entries would override this one on the first lookup
+        readTuningFile( path );
+        tuningEntries[ tuningKey( device, algorithm, typeName ) ][ bucket ] = params;
+
+        if( path.empty( ) )
+            return;
+
+        std::ofstream file( path.c_str( ), std::ios::out | std::ios::app );
+        if( !file )
+            throw std::runtime_error( "Bolt could not open the tuning file " + path );
+        file << device << '\t' << algorithm << '\t' << typeName << '\t' << bucket << '\t' << params.wgSize << '\t'
+            << params.wgPerComputeUnit << '\t' << params.itemsPerWorkItem << '\t' << params.unroll << '\n';
+    }
+
+    tuningParams sweepTuning( bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                              size_t length, tuningRun& run, const tuningParams& defaults, unsigned space,
+                              int repetitions )
+    {
+        typedef boost::chrono::high_resolution_clock clock;
+
+        //  Candidates are installed in memory only, and looked up by the runs through a control that reads them
+        bolt::cl::control tuneCtl( ctl );
+        tuneCtl.setAutoTune( bolt::cl::control::AutoTuneAll );
+        tuneCtl.setTuningFile( "" );
+
+        const std::string key = tuningKey( tuningDevice( ctl ), algorithm, typeName );
+        const int bucket = tuningBucket( length );
+        const size_t maxWgSize = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_WORK_GROUP_SIZE >( );
+
+        static const size_t wgSizes[ ] = { 64, 128, 256 };
+        static const size_t wgPerComputeUnits[ ] = { 4, 8, 16, 32, 64 };
+        static const size_t itemsPerWorkItems[ ] = { 1, 2, 4, 8, 16, 32 };
+        static const int unrolls[ ] = { 1, 2, 4, 8 };
+
+        //  Restored if no candidate runs
+        tuningBuckets previous;
+        {
+            boost::lock_guard< boost::mutex > lock( tuningGuard );
+            readTuningFile( ctl.getTuningFile( ) );
+            previous = tuningEntries[ key ];
+        }
+
+        tuningParams best = defaults;
+        double bestSeconds = std::numeric_limits< double >::max( );
+        ::cl::Error lastError( CL_SUCCESS );
+
+        for( int param = 0; param < 4; ++param )
+        {
+            if( !( space & ( 1u << param ) ) )
+                continue;
+
+            size_t numCandidates = ( param == 0 ) ? 3 : ( param == 1 ) ? 5 : ( param == 2 ) ? 6 : 4;
+            for( size_t c = 0; c < numCandidates; ++c )
+            {
+                tuningParams candidate = best;
+                switch( param )
+                {
+                case 0:
+                    candidate.wgSize = wgSizes[ c ];
+                    break;
+                case 1:
+                    candidate.wgPerComputeUnit = wgPerComputeUnits[ c ];
+                    break;
+                case 2:
+                    candidate.itemsPerWorkItem = itemsPerWorkItems[ c ];
+                    break;
+                default:
+                    candidate.unroll = unrolls[ c ];
+                    break;
+                }
+                if( candidate.wgSize > maxWgSize )
+                    continue;
+
+                {
+                    boost::lock_guard< boost::mutex > lock( tuningGuard );
+                    tuningEntries[ key ][ bucket ] = candidate;
+                }
+
+                double seconds = std::numeric_limits< double >::max( );
+                try
+                {
+                    run( tuneCtl );
+                    for( int r = 0; r < repetitions; ++r )
+                    {
+                        clock::time_point start = clock::now( );
+                        run( tuneCtl );
+                        seconds = std::min( seconds, boost::chrono::duration< double >( clock::now( ) - start ).count( ) );
+                    }
+                }
+                catch( const ::cl::Error& e )
+                {
+                    //  Typically a work-group that needs more local memory or registers than the device has
+                    lastError = e;
+                    continue;
+                }
+
+                if( tuneCtl.getDebugMode( ) & bolt::cl::control::debug::AutoTune )
+                    std::cout << "Bolt tuning " << algorithm << " < " << typeName << " > length " << length
+                        << ": wgSize " << candidate.wgSize << ", wgPerComputeUnit " << candidate.wgPerComputeUnit
+                        << ", itemsPerWorkItem " << candidate.itemsPerWorkItem << ", unroll " << candidate.unroll
+                        << ": " << seconds * 1e6 << " us" << std::endl;
+
+                if( seconds < bestSeconds )
+                {
+                    bestSeconds = seconds;
+                    best = candidate;
+                }
+            }
+        }
+
+        if( bestSeconds == std::numeric_limits< double >::max( ) )
+        {
+            //  Nothing ran, so there is no winner to store
+            boost::lock_guard< boost::mutex > lock( tuningGuard );
+            tuningEntries[ key ] = previous;
+            if( lastError.err( ) != CL_SUCCESS )
+                throw lastError;
+            return defaults;
+        }
+
+        storeTuning( ctl, algorithm, typeName, length, best );
+        return best;
+    }
+
+    void resetTuning( )
+    {
+        boost::lock_guard< boost::mutex > lock( tuningGuard );
+        tuningEntries.clear( );
+        tuningFilesRead.clear( );
+    }
+
     /**************************************************************************
      * Compile Kernel from primitive information
      *************************************************************************/
@@ -448,9 +1221,135 @@ namespace bolt {
         std::cout << hr << std::endl;
     }
 
+    /**************************************************************************
+     * Program cache digests
+     * - lane lo is 64-bit FNV-1a; stable across runs and platforms, unlike std::hash
+     * - lane hi is an independent multiply-xorshift hash over the same bytes
+     *************************************************************************/
+    static cl_ulong hashString( const ::std::string& str, cl_ulong hash = 0xcbf29ce484222325ULL )
+    {
+        for( ::std::string::const_iterator it = str.begin( ); it != str.end( ); ++it )
+        {
+            hash ^= static_cast< unsigned char >( *it );
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    static ProgramDigest digestInit( )
+    {
+        ProgramDigest digest = { 0xcbf29ce484222325ULL, 0x9e3779b97f4a7c15ULL };
+        return digest;
+    }
+
+    static void digestAppend( ProgramDigest& digest, const char* data, size_t size )
+    {
+        cl_ulong lo = digest.lo;
+        cl_ulong hi = digest.hi;
+        for( size_t i = 0; i < size; ++i )
+        {
+            const unsigned char c = static_cast< unsigned char >( data[ i ] );
+            lo ^= c;
+            lo *= 0x100000001b3ULL;
+            hi = ( hi + c ) * 0xff51afd7ed558ccdULL;
+            hi ^= hi >> 29;
+        }
+        digest.lo = lo;
+        digest.hi = hi;
+    }
+
+    //  Strings are prefixed with their length so that ("ab","c") and ("a","bc") digest differently
+    static void digestAppend( ProgramDigest& digest, const ::std::string& str )
+    {
+        const cl_ulong size = str.size( );
+        digestAppend( digest, reinterpret_cast< const char* >( &size ), sizeof( size ) );
+        digestAppend( digest, str.data( ), str.size( ) );
+    }
+
+    /**************************************************************************
+     * Program cache storage
+     * - the ProgramMap is split into shards selected by digest, so threads
+     *   requesting different programs do not serialize on one mutex
+     * - ProgramCacheSlot objects live at the call sites; they are guarded by a
+     *   small set of mutexes striped by slot address
+     *************************************************************************/
+    static const size_t programMapShardCount = 16;
+    static const size_t programSlotGuardCount = 16;
+
+    struct ProgramMapShard
+    {
+        boost::mutex guard;
+        ProgramMap programs;
+    };
+
+    static ProgramMapShard programMapShards[ programMapShardCount ];
+    static boost::mutex programSlotGuards[ programSlotGuardCount ];
+
+    //  Slot entries from an older generation are ignored; bumped by clearProgramCache with every slot guard held.
+    //  Starts at 1 so that zero-initialized entries never match.
+    static cl_uint programCacheGeneration = 1;
+
+    static boost::mutex& programSlotGuard( const ProgramCacheSlot* slot )
+    {
+        return programSlotGuards[ ( reinterpret_cast< size_t >( slot ) / sizeof( ProgramCacheSlot ) ) % programSlotGuardCount ];
+    }
+
+    static bool lookupProgramSlot( ProgramCacheSlot* slot, const ProgramMapKey& key, ::cl::Program& program )
+    {
+        boost::lock_guard< boost::mutex > lock( programSlotGuard( slot ) );
+        for( int i = 0; i < ProgramCacheSlot::capacity; ++i )
+        {
+            const ProgramCacheSlot::Entry& entry = slot->entries[ i ];
+            if( entry.program != NULL && entry.generation == programCacheGeneration &&
+                entry.context == key.context && entry.device == key.device &&
+                entry.digest.lo == key.digest.lo && entry.digest.hi == key.digest.hi )
+            {
+                //  ::cl::Program takes ownership of the handle it wraps; the slot keeps its own reference
+                V_OPENCL( ::clRetainProgram( entry.program ), "clRetainProgram() failed" );
+                program = ::cl::Program( entry.program );
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void storeProgramSlot( ProgramCacheSlot* slot, const ProgramMapKey& key, const ::cl::Program& program )
+    {
+        boost::lock_guard< boost::mutex > lock( programSlotGuard( slot ) );
+        ProgramCacheSlot::Entry& entry = slot->entries[ slot->next % ProgramCacheSlot::capacity ];
+        slot->next = ( slot->next + 1 ) % ProgramCacheSlot::capacity;
+
+        V_OPENCL( ::clRetainProgram( program( ) ), "clRetainProgram() failed" );
+        if( entry.program != NULL )
+        {
+            ::clReleaseProgram( entry.program );
+        }
+        entry.context = key.context;
+        entry.device = key.device;
+        entry.digest = key.digest;
+        entry.generation = programCacheGeneration;
+        entry.program = program( );
+    }
+
+    void clearProgramCache( )
+    {
+        for( size_t i = 0; i < programSlotGuardCount; ++i )
+            programSlotGuards[ i ].lock( );
+        ++programCacheGeneration;
+        for( size_t i = 0; i < programSlotGuardCount; ++i )
+            programSlotGuards[ i ].unlock( );
+
+        for( size_t i = 0; i < programMapShardCount; ++i )
+        {
+            boost::lock_guard< boost::mutex > lock( programMapShards[ i ].guard );
+            programMapShards[ i ].programs.clear( );
+        }
+    }
+
     /**************************************************************************
     * getKernels
-    * - concatenates input strings into complete kernel string to be compiled
+    * - looks up the program in the call site's ProgramCacheSlot, if given
+    * - otherwise concatenates input strings into complete kernel string to be compiled
     * - takes into account control
     * - requests program/kernel from ProgramMap
     **************************************************************************/
@@ -460,8 +1359,37 @@ namespace bolt {
         const KernelTemplateSpecializer * const kts,
         const std::vector<std::string>& typeDefs,
         const std::string&  kernelString,
-        const std::string&  options )
+        const std::string&  options,
+        ProgramCacheSlot*   slot )
     {
+        // compile options
+        std::string compileOptions = options;
+        compileOptions += ctl.getCompileOptions( );
+        compileOptions += " -x clc++ ";
+        if (ctl.getDebugMode() & control::debug::SaveCompilerTemps) {
+            compileOptions += " -save-temps=BOLT ";
+        }
+
+        ::cl::Context context = ctl.getContext( );
+        ::cl::Device device = ctl.getDevice( );
+
+        // The base kernel string is fixed per call site, so the slot key only digests what can vary between calls
+        // of one call site; a slot is bypassed when the complete kernel string has to be printed
+        const bool useSlot = ( slot != NULL ) && !( ctl.getDebugMode() & control::debug::Compile );
+        ProgramMapKey slotKey = { context( ), device( ), digestInit( ) };
+        ::cl::Program program;
+
+        if( useSlot )
+        {
+            for (size_t i = 0; i < typeNames.size(); i++)
+                digestAppend( slotKey.digest, typeNames[i] );
+            for (size_t i = 0; i < typeDefs.size(); i++)
+                digestAppend( slotKey.digest, typeDefs[i] );
+            digestAppend( slotKey.digest, compileOptions );
+            if( lookupProgramSlot( slot, slotKey, program ) )
+                return createKernels( kts, program );
+        }
+
         std::string completeKernelString;
         /* In device vector.h functional.h and bolt.h the defintions of cl_* are given. These cl_* are typedef'd
          * to there corresponding types in cl_platforms.h. To the kernel Actually the cl_* are passed, But the OpenCL
@@ -476,52 +1404,74 @@ namespace bolt {
         "#define cl_float  float\n"
         "#define cl_double double\n"
         "#define cl_char   char\n"
-        "#define cl_uchar  unsigned char\n" ;
+        "#define cl_uchar  unsigned char\n"
+        // The index type of kernels whose call site does not choose one with kernelIndex
+        "#ifndef BOLT_INDEX_T\n"
+        "#define BOLT_INDEX_T uint\n"
+        "#endif\n"
+        // The buffers an iterator argument reads besides its pointer argument, see detail::setIteratorLeaves
+        "#define BOLT_LEAF_PARAMS global void* leaf1, global void* leaf2, global void* leaf3\n"
+        "#define BOLT_INIT_LEAVES( iter, ptr ) \\\n"
+        "    { global void* leaves[ 4 ] = { ptr, leaf1, leaf2, leaf3 }; iter.initLeaves( leaves, 0 ); }\n" ;
 
         completeKernelString = PreprocessorDefinitions;
 
         // (1) raw kernel
         completeKernelString += "\n// Raw Kernel\n\n" + kernelString;
 
-        // (2) type definitions
+        // (2) type definitions; composite definitions are split into their parts and every part is emitted once
         completeKernelString += "\n// Type Definitions\n";
+        const std::string partDelimiter = BOLT_CLCODE_PART_DELIMITER;
+        std::vector< std::string > emittedParts;
         for (size_t i = 0; i < typeDefs.size(); i++)
         {
-            completeKernelString += "\n" + typeDefs[i] + "\n";
-        }
-        //for ( std::set<std::string>::iterator iter = typeDefs.begin(); iter != typeDefs.end(); iter++ )
-        //{
-        //    std::cout << "concat " << *iter << std::endl;
-        //    completeKernelString += "\n" + *iter + "\n";
-        //}
+            std::string::size_type begin = 0;
+            while( begin <= typeDefs[i].size( ) )
+            {
+                std::string::size_type end = typeDefs[i].find( partDelimiter, begin );
+                if( end == std::string::npos )
+                    end = typeDefs[i].size( );
 
-        //std::for_each( typeDefs.begin( ), typeDefs.end( ), [&]( const std::string &typeDef )
-        //{
-        //    completeKernelString += "\n" + typeDef+ "\n";
-        //});
+                std::string part = typeDefs[i].substr( begin, end - begin );
+                if( !part.empty( ) && std::find( emittedParts.begin( ), emittedParts.end( ), part ) == emittedParts.end( ) )
+                {
+                    completeKernelString += "\n" + part + "\n";
+                    emittedParts.push_back( part );
+                }
+                begin = end + partDelimiter.size( );
+            }
+        }
 
         // (3) template specialization
         std::string templateSpecialization = (*kts)(typeNames);
         completeKernelString += "\n// Kernel Template Specialization\n" + templateSpecialization;
 
-        // compile options
-        std::string compileOptions = options;
-        compileOptions += ctl.getCompileOptions( );
-        compileOptions += " -x clc++ ";
-        if (ctl.getDebugMode() & control::debug::SaveCompilerTemps) {
-            compileOptions += " -save-temps=BOLT ";
-        }
         if (ctl.getDebugMode() & control::debug::Compile) {
             printKernels(kts->getKernelNames(), completeKernelString, compileOptions);
         }
 
         // request program from program cache (ProgramMap)
-        ::cl::Program program = acquireProgram(
-            ctl.getContext(),
-            ctl.getDevice(),
+        program = acquireProgram(
+            context,
+            device,
             compileOptions,
-            completeKernelString);
+            completeKernelString,
+            ctl.getKernelCacheDir( ) );
+
+        if( useSlot )
+            storeProgramSlot( slot, slotKey, program );
 
+        return createKernels( kts, program );
+    }
+
+    /**************************************************************************
+    * createKernels
+    * - instantiates the kernels named by the specializer from a built program
+    **************************************************************************/
+    ::std::vector< ::cl::Kernel > createKernels(
+        const KernelTemplateSpecializer * const kts,
+        const ::cl::Program& program )
+    {
         // retrieve kernels from program
         //std::cout << "Getting " << kts->numKernels() << " from program." << std::endl;
         ::std::vector< ::cl::Kernel > kernels;
@@ -553,36 +1503,194 @@ namespace bolt {
         return kernels;
     }
 
+    /**************************************************************************
+     * Program binary cache helpers
+     *************************************************************************/
+    static const char programBinaryMagic[ 8 ] = { 'B', 'O', 'L', 'T', 'B', 'I', 'N', '1' };
+
+    static ::std::string programBinaryFileName(
+        const ::std::string& kernelCacheDir,
+        const ::cl::Device&  device,
+        const ProgramDigest& digest )
+    {
+        ::std::string deviceStr = device.getInfo< CL_DEVICE_NAME >( );
+        deviceStr += "; " + device.getInfo< CL_DEVICE_VENDOR >( );
+        deviceStr += "; " + device.getInfo< CL_DEVICE_VERSION >( );
+        deviceStr += "; " + device.getInfo< CL_DRIVER_VERSION >( );
+
+        // The digest already covers the compile options and the complete kernel source
+        cl_ulong hash = hashString( deviceStr );
+        hash = ( hash ^ digest.lo ) * 0x100000001b3ULL;
+        hash = ( hash ^ digest.hi ) * 0x100000001b3ULL;
+
+        std::ostringstream fileName;
+        fileName << kernelCacheDir;
+        if( !kernelCacheDir.empty( ) && kernelCacheDir[ kernelCacheDir.size( ) - 1 ] != '/'
+            && kernelCacheDir[ kernelCacheDir.size( ) - 1 ] != '\\' )
+        {
+            fileName << "/";
+        }
+        fileName << "bolt_" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash << ".bin";
+        return fileName.str( );
+    }
+
+    bool loadProgramBinary(
+        const ::cl::Context& context,
+        const ::cl::Device&  device,
+        const ::std::string& options,
+        const ::std::string& fileName,
+        ::cl::Program& program )
+    {
+        std::ifstream infile( fileName.c_str( ), std::ios::in | std::ios::binary );
+        if( infile.fail( ) )
+            return false;
+
+        char magic[ sizeof( programBinaryMagic ) ];
+        cl_ulong binarySize = 0;
+        infile.read( magic, sizeof( magic ) );
+        infile.read( reinterpret_cast< char* >( &binarySize ), sizeof( binarySize ) );
+        if( infile.fail( ) || !std::equal( magic, magic + sizeof( magic ), programBinaryMagic ) || binarySize == 0 )
+            return false;
+
+        std::vector< unsigned char > binary( static_cast< size_t >( binarySize ) );
+        infile.read( reinterpret_cast< char* >( &binary[ 0 ] ), binary.size( ) );
+        if( infile.fail( ) )
+            return false;
+
+        try
+        {
+            std::vector< ::cl::Device > devices;
+            devices.push_back( device );
+            ::cl::Program::Binaries binaries( 1, std::make_pair( &binary[ 0 ], binary.size( ) ) );
+            std::vector< cl_int > binaryStatus;
+            cl_int l_err;
+
+            ::cl::Program binaryProgram( context, devices, binaries, &binaryStatus, &l_err );
+            V_OPENCL( l_err, "Program::constructor() from binary failed" );
+            l_err = binaryProgram.build( devices, options.c_str( ) );
+            V_OPENCL( l_err, "Program::build() from binary failed" );
+            program = binaryProgram;
+        }
+        catch( const ::cl::Error& )
+        {
+            //  A stale or corrupt binary (e.g. after a driver upgrade with an unchanged version string) is not an
+            //  error; the caller recompiles from source and overwrites the cache entry
+            return false;
+        }
+        return true;
+    }
+
+    void storeProgramBinary(
+        const ::cl::Program& program,
+        const ::cl::Device&  device,
+        const ::std::string& fileName )
+    {
+        //  The program may be associated with every device in the context; pick out the binary for ours
+        std::vector< ::cl::Device > devices = program.getInfo< CL_PROGRAM_DEVICES >( );
+        std::vector< size_t > binarySizes = program.getInfo< CL_PROGRAM_BINARY_SIZES >( );
+
+        size_t devIndex = devices.size( );
+        for( size_t i = 0; i < devices.size( ); ++i )
+        {
+            if( devices[ i ]( ) == device( ) )
+            {
+                devIndex = i;
+                break;
+            }
+        }
+        if( devIndex == devices.size( ) || binarySizes[ devIndex ] == 0 )
+            return;
+
+        std::vector< std::vector< unsigned char > > binaryStorage( devices.size( ) );
+        std::vector< unsigned char* > binaryPtrs( devices.size( ), static_cast< unsigned char* >( NULL ) );
+        for( size_t i = 0; i < devices.size( ); ++i )
+        {
+            if( binarySizes[ i ] == 0 )
+                continue;
+            binaryStorage[ i ].resize( binarySizes[ i ] );
+            binaryPtrs[ i ] = &binaryStorage[ i ][ 0 ];
+        }
+
+        cl_int l_err = ::clGetProgramInfo( program( ), CL_PROGRAM_BINARIES, binaryPtrs.size( ) * sizeof( unsigned char* ),
+            &binaryPtrs[ 0 ], NULL );
+        if( l_err != CL_SUCCESS )
+            return;
+
+        //  Write to a temporary file first and rename, so a concurrent process never reads a partial binary.  The
+        //  process and thread ids keep writers sharing the cache directory off each other's temporary file
+#if defined( _WIN32 )
+        int processId = ::_getpid( );
+#else
+        int processId = static_cast< int >( ::getpid( ) );
+#endif
+        std::ostringstream tmpName;
+        tmpName << fileName << "." << processId << "." << boost::this_thread::get_id( ) << ".tmp";
+
+        std::ofstream outfile( tmpName.str( ).c_str( ), std::ios::out | std::ios::binary | std::ios::trunc );
+        if( outfile.fail( ) )
+            return;
+
+        cl_ulong binarySize = binarySizes[ devIndex ];
+        outfile.write( programBinaryMagic, sizeof( programBinaryMagic ) );
+        outfile.write( reinterpret_cast< const char* >( &binarySize ), sizeof( binarySize ) );
+        outfile.write( reinterpret_cast< const char* >( &binaryStorage[ devIndex ][ 0 ] ), binarySizes[ devIndex ] );
+        outfile.close( );
+
+        if( outfile.fail( ) || std::rename( tmpName.str( ).c_str( ), fileName.c_str( ) ) != 0 )
+        {
+            std::remove( tmpName.str( ).c_str( ) );
+        }
+    }
+
     /**************************************************************************
      * aquireKernels
      * - returns kernels from ProgramMap if exist
-     * - otherwise compiles program/kernels, adds to map, then returns
+     * - otherwise loads the program binary from the on-disk cache if enabled
+     * - otherwise compiles program/kernels, adds to map (and disk cache), then returns
      *************************************************************************/
     ::cl::Program acquireProgram(
         const ::cl::Context& context,
         const ::cl::Device&  device,
         const ::std::string& options,
-        const ::std::string& source)
+        const ::std::string& source,
+        const ::std::string& kernelCacheDir )
     {
-        // only one threads get to seach and retrieve-or-compile at a time
-        boost::lock_guard< boost::mutex > lock( ::bolt::cl::programMapMutex ); // unlocks upon return
         cl_int l_err;
 
+        ProgramMapKey key = { context( ), device( ), digestInit( ) };
+        digestAppend( key.digest, options );
+        digestAppend( key.digest, source );
+
+        // only one thread per shard gets to search and retrieve-or-compile at a time
+        ProgramMapShard& shard = programMapShards[ key.digest.lo % programMapShardCount ];
+        boost::lock_guard< boost::mutex > lock( shard.guard ); // unlocks upon return
+
         // Does Program already exist?
-        std::string deviceStr = device.getInfo< CL_DEVICE_NAME >( );
-        deviceStr += "; " + device.getInfo< CL_DEVICE_VERSION >( );
-        deviceStr += "; " + device.getInfo< CL_DEVICE_VENDOR >( );
-        ProgramMapKey key = {context, deviceStr, options, source};
-        ProgramMap::iterator iter = programMap.find( key );
+        ProgramMap::iterator iter = shard.programs.find( key );
         ::cl::Program program;
 
         // map does not yet contain desired program
-        if( iter == programMap.end( ) )
+        if( iter == shard.programs.end( ) )
         {
-            program = ::bolt::cl::compileProgram(context, device, options, source, &l_err);
-            V_OPENCL( l_err, "bolt::cl::compileProgram() failed" );
+            std::string binaryFileName;
+            bool loaded = false;
+            if( !kernelCacheDir.empty( ) )
+            {
+                binaryFileName = programBinaryFileName( kernelCacheDir, device, key.digest );
+                loaded = loadProgramBinary( context, device, options, binaryFileName, program );
+            }
+
+            if( !loaded )
+            {
+                program = ::bolt::cl::compileProgram(context, device, options, source, &l_err);
+                V_OPENCL( l_err, "bolt::cl::compileProgram() failed" );
+                if( !binaryFileName.empty( ) )
+                {
+                    storeProgramBinary( program, device, binaryFileName );
+                }
+            }
             ProgramMapValue value = { program };
-            programMap.insert( std::make_pair( key, value ) );
+            shard.programs.insert( std::make_pair( key, value ) );
         }
         else // map already contains desired kernel
         {
@@ -639,10 +1747,5 @@ namespace bolt {
     } // compileProgram
 
 
-        // externed in bolt.h
-        boost::mutex programMapMutex;
-        ProgramMap programMap;
-
-
     }; //namespace bolt::cl
 }; // namespace bolt
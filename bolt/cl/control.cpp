@@ -19,6 +19,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <set>
+#include <vector>
 // #include <atomic>
 
 #include "bolt/cl/bolt.h"
@@ -442,16 +444,50 @@ namespace cl
 
     }
 
+    //  Smallest size class handed out by the buffer pool
+    static const size_t minBufferSizeClass = 64;
+
+    //  Size classes up to this size are carved out of a slab holding subBuffersPerSlab buffers of the class
+    static const size_t maxSubBufferSize = 64 * 1024;
+    static const size_t subBuffersPerSlab = 16;
+
+    static size_t bufferSizeClass( size_t reqSize )
+    {
+        size_t sizeClass = minBufferSizeClass;
+        while( sizeClass < reqSize && ( sizeClass << 1 ) > sizeClass )
+        {
+            sizeClass <<= 1;
+        }
+        return ( sizeClass < reqSize ) ? reqSize : sizeClass;
+    }
+
+    //  A standalone buffer, or a slab together with all of its sub-buffers; the unit in which memory is released
+    struct bufferAllocation
+    {
+        size_t bytes;
+        size_t lastUse;
+        bool idle;
+    };
+
     size_t control::totalBufferSize( )
     {
-        size_t totalSize = 0;
+        boost::lock_guard< boost::mutex > lock( mapGuard );
+
+        return m_bufferBytesResident;
+    };
+
+    control::bufferPoolStats control::getBufferPoolStats( )
+    {
+        boost::lock_guard< boost::mutex > lock( mapGuard );
 
+        bufferPoolStats stats = { m_bufferHits, m_bufferMisses, m_bufferBytesResident, 0 };
         for( mapBufferType::iterator it = mapBuffer.begin( ); it != mapBuffer.end( ); ++it )
         {
-            totalSize += it->second.buffSize;
+            if( it->second.inUse )
+                stats.bytesWasted += it->first.buffSize - it->second.reqSize;
         }
 
-        return totalSize;
+        return stats;
     };
 
     control::buffPointer control::acquireBuffer( size_t reqSize, cl_mem_flags flags, const void* host_ptr )
@@ -460,54 +496,169 @@ namespace cl
 
         ::cl::Context myContext = m_commandQueue.getInfo< CL_QUEUE_CONTEXT >( );
 
-        descBufferKey myDesc = { myContext, flags , host_ptr };
-        mapBufferType::iterator itLowerBound = mapBuffer.find( myDesc );
-        if( itLowerBound == mapBuffer.end( ) )
+        //  Under NoWait a call returns before the device has read the host memory, and functors passed this way live
+        //  on the caller's stack; snapshot them into a private buffer that is released with its last reference
+        if( m_waitMode == NoWait && ( flags & CL_MEM_USE_HOST_PTR ) && host_ptr != NULL )
         {
-            ::cl::Buffer tmp( myContext, flags, reqSize, const_cast< void*>( host_ptr ) );
-            descBufferValue myValue = { reqSize, true, tmp };
-            mapBufferType::iterator itInserted = mapBuffer.insert( std::make_pair( myDesc, myValue ) );
-
-            buffPointer buffPtr( &(itInserted->second.buffBuff), UnlockBuffer( *this, itInserted ) );
-            return buffPtr;
+            ++m_bufferMisses;
+            cl_mem_flags copyFlags = ( flags & ~CL_MEM_USE_HOST_PTR ) | CL_MEM_COPY_HOST_PTR;
+            return buffPointer( new ::cl::Buffer( myContext, copyFlags, reqSize, const_cast< void* >( host_ptr ) ) );
         }
 
-        for( ; itLowerBound != mapBuffer.upper_bound( myDesc ); ++itLowerBound )
+        //  A buffer wrapping host memory cannot be larger than the host allocation, so only buffers without a host
+        //  pointer are rounded up to a size class and shared between requests of similar sizes
+        size_t buffSize = ( host_ptr == NULL ) ? bufferSizeClass( reqSize ) : reqSize;
+
+        descBufferKey myDesc = { myContext, flags, host_ptr, buffSize };
+        std::pair< mapBufferType::iterator, mapBufferType::iterator > range = mapBuffer.equal_range( myDesc );
+        for( mapBufferType::iterator it = range.first; it != range.second; ++it )
         {
             //  If the current buffer is already being used, keep searching
-            if( itLowerBound->second.inUse == true )
+            if( it->second.inUse == true )
                 continue;
 
-            if( itLowerBound->second.buffSize >= reqSize )
+            ++m_bufferHits;
+            return lendBuffer( it, reqSize );
+        }
+
+        //  If here, all buffers of this class are currently in use; create a new one and add it to the map
+        ++m_bufferMisses;
+        mapBufferType::iterator itInserted;
+        try
+        {
+            itInserted = createBuffers( myDesc );
+        }
+        catch( const ::cl::Error& )
+        {
+            //  Rounding a large request up to the next power of two can exceed CL_DEVICE_MAX_MEM_ALLOC_SIZE, or what is
+            //  left of device memory; release idle buffers and fall back to the exact size before giving up
+            if( myDesc.buffSize == reqSize )
+                throw;
+
+            trimBuffers( 0 );
+
+            myDesc.buffSize = reqSize;
+            itInserted = createBuffers( myDesc );
+        }
+
+        buffPointer buffPtr = lendBuffer( itInserted, reqSize );
+        if( m_bufferPoolHighWater != 0 )
+            trimBuffers( m_bufferPoolHighWater );
+        return buffPtr;
+    };
+
+    control::mapBufferType::iterator control::createBuffers( const descBufferKey& desc )
+    {
+        if( desc.host_ptr == NULL && desc.buffSize <= maxSubBufferSize )
+        {
+            //  clCreateSubBuffer requires the origin of every sub-buffer to be aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN
+            //  (reported in bits); size classes are powers of two, so the class size being a multiple suffices
+            ::cl::Device myDevice = m_commandQueue.getInfo< CL_QUEUE_DEVICE >( );
+            size_t baseAlign = myDevice.getInfo< CL_DEVICE_MEM_BASE_ADDR_ALIGN >( ) / 8;
+
+            if( baseAlign != 0 && desc.buffSize % baseAlign == 0 )
             {
-                itLowerBound->second.inUse = true;
-                buffPointer buffPtr( &(itLowerBound->second.buffBuff), UnlockBuffer( *this, itLowerBound ) );
-                return buffPtr;
-            }
+                try
+                {
+                    size_t slabSize = desc.buffSize * subBuffersPerSlab;
+                    ::cl::Buffer slab( desc.buffContext, desc.memFlags, slabSize );
+
+                    //  Host pointer flags are not allowed on sub-buffers; they inherit them from the slab
+                    cl_mem_flags subFlags = desc.memFlags & ( CL_MEM_READ_WRITE | CL_MEM_READ_ONLY | CL_MEM_WRITE_ONLY );
 
-            //  If here, we found a buffer with the appropriate flags, but not big enough.  Delete the old 
-            //  buffer and then create a bigger one to take it's place.
+                    std::vector< ::cl::Buffer > subBuffers;
+                    for( size_t i = 0; i < subBuffersPerSlab; ++i )
+                    {
+                        cl_buffer_region region = { i * desc.buffSize, desc.buffSize };
+                        cl_int l_Error = CL_SUCCESS;
+                        subBuffers.push_back( slab.createSubBuffer( subFlags, CL_BUFFER_CREATE_TYPE_REGION, &region, &l_Error ) );
+                        V_OPENCL( l_Error, "Buffer::createSubBuffer() failed" );
+                    }
 
-            mapBuffer.erase( itLowerBound );
-            break;
+                    mapBufferType::iterator itFirst = mapBuffer.end( );
+                    for( size_t i = 0; i < subBuffersPerSlab; ++i )
+                    {
+                        descBufferValue myValue = { 0, false, subBuffers[ i ], slab, m_bufferClock };
+                        mapBufferType::iterator itInserted = mapBuffer.insert( std::make_pair( desc, myValue ) );
+                        if( itFirst == mapBuffer.end( ) )
+                            itFirst = itInserted;
+                    }
+                    m_bufferBytesResident += slabSize;
+                    return itFirst;
+                }
+                catch( const ::cl::Error& )
+                {
+                    //  Devices without OpenCL 1.1 sub-buffer support; fall through to a standalone buffer
+                }
+            }
         }
 
-        //  If here, either all available buffers are currently in use, or we need to replace an existing buffer
-        // create a new buffer and add it to the map
-        ::cl::Buffer tmp( myContext, flags, reqSize, const_cast< void* >( host_ptr ) );
-        descBufferValue myValue = { reqSize, true, tmp };
+        ::cl::Buffer tmp( desc.buffContext, desc.memFlags, desc.buffSize, const_cast< void* >( desc.host_ptr ) );
+        descBufferValue myValue = { 0, false, tmp, ::cl::Buffer( ), m_bufferClock };
+        m_bufferBytesResident += desc.buffSize;
+        return mapBuffer.insert( std::make_pair( desc, myValue ) );
+    };
+
+    control::buffPointer control::lendBuffer( mapBufferType::iterator it, size_t reqSize )
+    {
+        it->second.inUse = true;
+        it->second.reqSize = reqSize;
 
-        mapBufferType::iterator itInserted = mapBuffer.insert( std::make_pair( myDesc, myValue ) );
-        buffPointer buffPtr( &(itInserted->second.buffBuff), UnlockBuffer( *this, itInserted ) );
+        buffPointer buffPtr( &(it->second.buffBuff), UnlockBuffer( *this, it ) );
         return buffPtr;
     };
 
+    void control::trimBuffers( size_t targetSize )
+    {
+        if( m_bufferBytesResident <= targetSize )
+            return;
+
+        //  A slab can only be released once none of its sub-buffers is in use; group the entries by allocation
+        std::map< cl_mem, bufferAllocation > allocations;
+        for( mapBufferType::iterator it = mapBuffer.begin( ); it != mapBuffer.end( ); ++it )
+        {
+            cl_mem unit = ( it->second.buffParent( ) != NULL ) ? it->second.buffParent( ) : it->second.buffBuff( );
+            bufferAllocation initial = { 0, 0, true };
+            bufferAllocation& alloc = allocations.insert( std::make_pair( unit, initial ) ).first->second;
+
+            alloc.bytes += it->first.buffSize;
+            alloc.lastUse = std::max( alloc.lastUse, it->second.lastUse );
+            alloc.idle = alloc.idle && !it->second.inUse;
+        }
+
+        //  Release idle allocations, least recently used first, until the pool is back under the target size
+        std::vector< std::pair< size_t, cl_mem > > lruOrder;
+        for( std::map< cl_mem, bufferAllocation >::iterator it = allocations.begin( ); it != allocations.end( ); ++it )
+        {
+            if( it->second.idle )
+                lruOrder.push_back( std::make_pair( it->second.lastUse, it->first ) );
+        }
+        std::sort( lruOrder.begin( ), lruOrder.end( ) );
+
+        std::set< cl_mem > released;
+        for( size_t i = 0; i < lruOrder.size( ) && m_bufferBytesResident > targetSize; ++i )
+        {
+            released.insert( lruOrder[ i ].second );
+            m_bufferBytesResident -= allocations[ lruOrder[ i ].second ].bytes;
+        }
+
+        for( mapBufferType::iterator it = mapBuffer.begin( ); it != mapBuffer.end( ); )
+        {
+            cl_mem unit = ( it->second.buffParent( ) != NULL ) ? it->second.buffParent( ) : it->second.buffBuff( );
+            if( released.count( unit ) )
+                mapBuffer.erase( it++ );
+            else
+                ++it;
+        }
+    };
+
     void control::freeBuffers( )
     {
         //  std::multimap is not thread-safe; lock the map when clearing it out
         boost::lock_guard< boost::mutex > lock( mapGuard );
 
         mapBuffer.clear( );
+        m_bufferBytesResident = 0;
     };
 
 }
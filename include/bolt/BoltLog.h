@@ -30,6 +30,7 @@ namespace BOLTLOG{
         BOLT_OPENCL_GPU,
         BOLT_OPENCL_CPU,
         BOLT_SERIAL_CPU,
+        BOLT_HOST_SPLIT,
     };
 
     typedef enum FUNCTION_EXE
@@ -55,7 +56,10 @@ namespace BOLTLOG{
         BOLT_STABLESORTBYKEY,
         BOLT_TRANSFORMREDUCE,
         BOLT_TRANSFORMSCAN,
-        BOLT_TRANSFORM
+        BOLT_TRANSFORM,
+        BOLT_COMPACTION,
+        BOLT_HISTOGRAM,
+        BOLT_SEGMENTEDSORT
     };
 
     class FunPaths
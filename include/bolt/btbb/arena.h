@@ -0,0 +1,306 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_BTBB_ARENA_H )
+#define BOLT_BTBB_ARENA_H
+#pragma once
+
+/*! \file bolt/btbb/arena.h
+    \brief The long-lived TBB task arena that the MultiCoreCpu algorithms run in.
+*/
+
+#include "tbb/task_arena.h"
+
+//  Pinning the worker threads of an arena to cores is opt-in: it observes the threads of one arena, which the older
+//  TBB releases only declare under TBB_PREVIEW_LOCAL_OBSERVER.  That macro only takes effect before the first TBB
+//  header of a translation unit, so it has to come from the build together with BOLT_BTBB_PIN_ARENAS
+#if defined( BOLT_BTBB_PIN_ARENAS )
+    #if !defined( TBB_PREVIEW_LOCAL_OBSERVER )
+        #error "BOLT_BTBB_PIN_ARENAS needs TBB_PREVIEW_LOCAL_OBSERVER defined for every translation unit"
+    #endif
+    #include "tbb/task_scheduler_observer.h"
+#endif
+
+#include <boost/scoped_ptr.hpp>
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+#if defined( _WIN32 )
+    #if !defined( WIN32_LEAN_AND_MEAN )
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #if !defined( NOMINMAX )
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined( __linux__ )
+    #include <sched.h>
+#endif
+
+#if defined( _MSC_VER )
+    #define BOLT_BTBB_THREAD_LOCAL __declspec( thread )
+#else
+    #define BOLT_BTBB_THREAD_LOCAL __thread
+#endif
+
+namespace bolt {
+    namespace btbb {
+
+#if defined( BOLT_BTBB_PIN_ARENAS )
+        namespace detail {
+
+            /*! \brief Restricts the worker threads of an arena to a set of cores as they join it.
+            *   \details The threads that call into the arena are not pinned; they belong to the application.
+            */
+            class arenaPinning: public tbb::task_scheduler_observer
+            {
+            public:
+                arenaPinning( tbb::task_arena& arena, const std::vector< int >& cores ):
+                    tbb::task_scheduler_observer( arena ), m_cores( cores )
+                {
+                    observe( true );
+                }
+
+                ~arenaPinning( )
+                {
+                    observe( false );
+                }
+
+                void on_scheduler_entry( bool isWorker )
+                {
+                    if( !isWorker )
+                        return;
+#if defined( _WIN32 )
+                    DWORD_PTR mask = 0;
+                    for( size_t c = 0; c < m_cores.size( ); ++c )
+                        if( m_cores[ c ] >= 0 && m_cores[ c ] < static_cast< int >( 8 * sizeof( DWORD_PTR ) ) )
+                            mask |= DWORD_PTR( 1 ) << m_cores[ c ];
+                    if( mask != 0 )
+                        ::SetThreadAffinityMask( ::GetCurrentThread( ), mask );
+#elif defined( __linux__ )
+                    cpu_set_t mask;
+                    CPU_ZERO( &mask );
+                    for( size_t c = 0; c < m_cores.size( ); ++c )
+                        if( m_cores[ c ] >= 0 && m_cores[ c ] < CPU_SETSIZE )
+                            CPU_SET( m_cores[ c ], &mask );
+                    if( CPU_COUNT( &mask ) != 0 )
+                        ::sched_setaffinity( 0, sizeof( mask ), &mask );
+#endif
+                }
+
+            private:
+                std::vector< int > m_cores;
+            };
+
+        }
+#endif
+
+        class arena;
+
+        namespace detail {
+
+            inline arena*& scopedArena( )
+            {
+                static BOLT_BTBB_THREAD_LOCAL arena* current = NULL;
+                return current;
+            }
+
+        }
+
+        /*! \brief Makes \p scoped the arena of the MultiCoreCpu algorithms the calling thread runs until the
+        *   scope ends.  NULL keeps the arena of the enclosing scope.
+        */
+        class arenaScope
+        {
+        public:
+            explicit arenaScope( arena* scoped ): m_previous( detail::scopedArena( ) )
+            {
+                if( scoped != NULL )
+                    detail::scopedArena( ) = scoped;
+            }
+
+            ~arenaScope( )
+            {
+                detail::scopedArena( ) = m_previous;
+            }
+
+        private:
+            arenaScope( const arenaScope& );
+            arenaScope& operator=( const arenaScope& );
+
+            arena* m_previous;
+        };
+
+        namespace detail {
+
+            template< typename Function >
+            struct scopedFunction
+            {
+                arena* scoped;
+                const Function& f;
+
+                void operator( )( ) const
+                {
+                    arenaScope scope( scoped );
+                    f( );
+                }
+            };
+
+        }
+
+        /*! \brief A TBB task arena that the MultiCoreCpu algorithms run in, together with the grain size of the
+        *   ranges they split.
+        *   \details The arena and its worker threads live as long as this object, so a call pays no scheduler
+        *   setup.  An arena either owns a tbb::task_arena of a given concurrency, optionally pinned to a set of
+        *   cores, or runs in a tbb::task_arena owned by the application.  Hand one to
+        *   bolt::cl::control::setTbbArena to use it for the calls of that control; calls without one share
+        *   defaultArena( ).
+        */
+        class arena
+        {
+        public:
+            /*! \brief An arena of at most \p concurrency threads, the calling thread included.
+            *   \param concurrency tbb::task_arena::automatic uses every core.
+            *   \param cores The cores its worker threads may run on; empty leaves them to the OS.  See
+            *   numaNodeCores.  Only honoured in builds that define BOLT_BTBB_PIN_ARENAS; otherwise the OS places
+            *   the threads.
+            *   \param grainSize The fewest elements a task processes; 1 leaves it to tbb::auto_partitioner.
+            */
+            explicit arena( int concurrency = tbb::task_arena::automatic,
+                            const std::vector< int >& cores = std::vector< int >( ),
+                            size_t grainSize = 1 ):
+                m_owned( concurrency ), m_arena( &m_owned ), m_grainSize( grainSize ? grainSize : 1 )
+            {
+#if defined( BOLT_BTBB_PIN_ARENAS )
+                if( !cores.empty( ) )
+                    m_pinning.reset( new detail::arenaPinning( m_owned, cores ) );
+#else
+                (void)cores;
+#endif
+            }
+
+            /*! \brief Runs in \p external, an arena the application owns and keeps alive as long as this object.
+            */
+            explicit arena( tbb::task_arena& external, size_t grainSize = 1 ):
+                m_arena( &external ), m_grainSize( grainSize ? grainSize : 1 )
+            {
+            }
+
+            /*! \brief Runs \p f inside the arena, where the parallel algorithms it starts find the worker threads
+            *   of the arena.  \p f sees this arena as currentArena( ) even when a worker thread runs it.
+            */
+            template< typename Function >
+            void execute( const Function& f )
+            {
+                detail::scopedFunction< Function > scoped = { this, f };
+                m_arena->execute( scoped );
+            }
+
+            size_t grainSize( ) const
+            {
+                return m_grainSize;
+            }
+
+            void setGrainSize( size_t grainSize )
+            {
+                m_grainSize = grainSize ? grainSize : 1;
+            }
+
+        private:
+            arena( const arena& );
+            arena& operator=( const arena& );
+
+            tbb::task_arena m_owned;
+            tbb::task_arena* m_arena;
+            size_t m_grainSize;
+#if defined( BOLT_BTBB_PIN_ARENAS )
+            boost::scoped_ptr< detail::arenaPinning > m_pinning;
+#endif
+        };
+
+        /*! \brief The cores of NUMA node \p node, to pin an arena to; empty where the OS does not tell.
+        */
+        inline std::vector< int > numaNodeCores( int node )
+        {
+            std::vector< int > cores;
+#if defined( _WIN32 )
+            ULONGLONG mask = 0;
+            if( node >= 0 && ::GetNumaNodeProcessorMask( static_cast< UCHAR >( node ), &mask ) )
+                for( int c = 0; c < 64; ++c )
+                    if( mask & ( ULONGLONG( 1 ) << c ) )
+                        cores.push_back( c );
+#elif defined( __linux__ )
+            //  The kernel lists the cores of a node as ranges, such as 0-7,16-23
+            char path[ 64 ];
+            std::sprintf( path, "/sys/devices/system/node/node%d/cpulist", node );
+            FILE* list = std::fopen( path, "r" );
+            if( list != NULL )
+            {
+                int first = 0, last = 0;
+                while( std::fscanf( list, "%d", &first ) == 1 )
+                {
+                    last = first;
+                    int separator = std::fgetc( list );
+                    if( separator == '-' && std::fscanf( list, "%d", &last ) == 1 )
+                        separator = std::fgetc( list );
+                    for( int c = first; c <= last; ++c )
+                        cores.push_back( c );
+                    if( separator != ',' )
+                        break;
+                }
+                std::fclose( list );
+            }
+#endif
+            return cores;
+        }
+
+        /*! \brief The arena of the calls that were not given one, using every core.
+        */
+        inline arena& defaultArena( )
+        {
+            static arena shared;
+            return shared;
+        }
+
+        /*! \brief The arena of the innermost arenaScope of the calling thread, or defaultArena( ).
+        */
+        inline arena& currentArena( )
+        {
+            arena* scoped = detail::scopedArena( );
+            return scoped ? *scoped : defaultArena( );
+        }
+
+        /*! \brief Runs \p f in currentArena( ).
+        */
+        template< typename Function >
+        void execute( const Function& f )
+        {
+            currentArena( ).execute( f );
+        }
+
+        /*! \brief The grain size of the ranges the algorithms split in currentArena( ).
+        */
+        inline size_t grainSize( )
+        {
+            return currentArena( ).grainSize( );
+        }
+
+    }
+}
+
+#endif
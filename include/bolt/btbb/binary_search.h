@@ -32,6 +32,19 @@ namespace bolt {
        
        template<typename ForwardIterator, typename T, typename StrictWeakOrdering>
        bool binary_search( ForwardIterator first, ForwardIterator last, const T & value, StrictWeakOrdering comp);
+
+       //  Vectorized forms: one result per value of [values_first, values_last), the queries are split among threads
+       template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+       OutputIterator lower_bound( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                   InputIterator values_last, OutputIterator result, StrictWeakOrdering comp);
+
+       template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+       OutputIterator upper_bound( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                   InputIterator values_last, OutputIterator result, StrictWeakOrdering comp);
+
+       template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+       OutputIterator binary_search( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                     InputIterator values_last, OutputIterator result, StrictWeakOrdering comp);
        
     };
 };
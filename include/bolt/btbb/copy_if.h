@@ -0,0 +1,40 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_BTBB_COPY_IF_H )
+#define BOLT_BTBB_COPY_IF_H
+
+#include <utility>
+
+/*! \file bolt/btbb/copy_if.h
+    \brief copies the elements of a range that satisfy a predicate
+*/
+
+
+namespace bolt {
+    namespace btbb {
+
+       template<typename InputIterator, typename OutputIterator, typename Predicate>
+       OutputIterator copy_if(InputIterator first, InputIterator last, OutputIterator result, Predicate pred);
+
+    };
+};
+
+
+#include <bolt/btbb/detail/compaction.inl>
+
+#endif
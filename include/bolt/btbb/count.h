@@ -24,7 +24,7 @@
 
 #include "tbb/parallel_reduce.h"
 #include "tbb/blocked_range.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 
 /*! \file bolt/tbb/count.h
     \brief Counts the number of elements in the specified range.
@@ -19,10 +19,11 @@
 #define BOLT_BTBB_BINARY_SEARCH_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 #include <iterator>
+#include <algorithm>
 
 namespace bolt{
     namespace btbb {
@@ -37,7 +38,7 @@ namespace bolt{
 				void operator()( ForwardIterator first, int n, const T & val)
                 {
 
-                    tbb::parallel_for(  tbb::blocked_range<int>(0, (int) n) ,
+                    tbb::parallel_for(  tbb::blocked_range<int>(0, (int) n, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                         {
 
@@ -80,7 +81,7 @@ namespace bolt{
 				void operator()( ForwardIterator first, int n, const T & val, StrictWeakOrdering comp)
                 {
 
-                    tbb::parallel_for(  tbb::blocked_range<int>(0, (int) n) ,
+                    tbb::parallel_for(  tbb::blocked_range<int>(0, (int) n, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                         {
 
@@ -117,13 +118,13 @@ namespace bolt{
             bool binary_search( ForwardIterator first, ForwardIterator last, const T & value, StrictWeakOrdering comp)
             {
 
-               //This allows TBB to choose the number of threads to spawn.
-               tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
                int n = (int)std::distance(first, last);
 
                BS_comp <ForwardIterator, T, StrictWeakOrdering> bs_op;
-               bs_op(first, n, value, comp);
+               bolt::btbb::execute( [&]( )
+               {
+                   bs_op(first, n, value, comp);
+               } );
 
                return bs_op.result;
             }
@@ -132,17 +133,104 @@ namespace bolt{
             bool binary_search( ForwardIterator first, ForwardIterator last, const T & value)
             {
 
-               //This allows TBB to choose the number of threads to spawn.
-               tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
                int n = (int)std::distance(first, last);
 
                BS <ForwardIterator, T> bs_op;
-               bs_op(first, n, value);
+               bolt::btbb::execute( [&]( )
+               {
+                   bs_op(first, n, value);
+               } );
 
                return bs_op.result;
             }
 
+            //  Every query is independent, so the queries are simply split among the threads
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename Search>
+            OutputIterator vectorized_search( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                              InputIterator values_last, OutputIterator result, Search search )
+            {
+               typedef typename std::iterator_traits< OutputIterator >::value_type oType;
+
+               int n = (int)std::distance(values_first, values_last);
+
+               bolt::btbb::execute( [&]( )
+               {
+                   tbb::parallel_for(  tbb::blocked_range<int>(0, n, bolt::btbb::grainSize( )) ,
+                       [&] (const tbb::blocked_range<int> &r) -> void
+                       {
+                           for( int i = r.begin( ); i < r.end( ); ++i )
+                               result[ i ] = static_cast< oType >( search( first, last, values_first[ i ] ) );
+                       });
+               } );
+
+               return result + n;
+            }
+
+            template<typename StrictWeakOrdering>
+            struct LowerBoundSearch
+            {
+                StrictWeakOrdering comp;
+                LowerBoundSearch( StrictWeakOrdering c ): comp( c ) {}
+
+                template<typename ForwardIterator, typename T>
+                typename std::iterator_traits< ForwardIterator >::difference_type
+                operator()( ForwardIterator first, ForwardIterator last, const T& value ) const
+                {
+                    return std::lower_bound( first, last, value, comp ) - first;
+                }
+            };
+
+            template<typename StrictWeakOrdering>
+            struct UpperBoundSearch
+            {
+                StrictWeakOrdering comp;
+                UpperBoundSearch( StrictWeakOrdering c ): comp( c ) {}
+
+                template<typename ForwardIterator, typename T>
+                typename std::iterator_traits< ForwardIterator >::difference_type
+                operator()( ForwardIterator first, ForwardIterator last, const T& value ) const
+                {
+                    return std::upper_bound( first, last, value, comp ) - first;
+                }
+            };
+
+            template<typename StrictWeakOrdering>
+            struct BinarySearchSearch
+            {
+                StrictWeakOrdering comp;
+                BinarySearchSearch( StrictWeakOrdering c ): comp( c ) {}
+
+                template<typename ForwardIterator, typename T>
+                int operator()( ForwardIterator first, ForwardIterator last, const T& value ) const
+                {
+                    return std::binary_search( first, last, value, comp ) ? 1 : 0;
+                }
+            };
+
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+            OutputIterator lower_bound( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                        InputIterator values_last, OutputIterator result, StrictWeakOrdering comp)
+            {
+               return vectorized_search( first, last, values_first, values_last, result,
+                                         LowerBoundSearch< StrictWeakOrdering >( comp ) );
+            }
+
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+            OutputIterator upper_bound( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                        InputIterator values_last, OutputIterator result, StrictWeakOrdering comp)
+            {
+               return vectorized_search( first, last, values_first, values_last, result,
+                                         UpperBoundSearch< StrictWeakOrdering >( comp ) );
+            }
+
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+            OutputIterator binary_search( ForwardIterator first, ForwardIterator last, InputIterator values_first,
+                                          InputIterator values_last, OutputIterator result, StrictWeakOrdering comp)
+            {
+               return vectorized_search( first, last, values_first, values_last, result,
+                                         BinarySearchSearch< StrictWeakOrdering >( comp ) );
+            }
+
 
     } //tbb
 } // bolt
@@ -0,0 +1,229 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_BTBB_COMPACTION_INL )
+#define BOLT_BTBB_COMPACTION_INL
+#pragma once
+
+#include "bolt/btbb/arena.h"
+#include "tbb/parallel_scan.h"
+#include "tbb/blocked_range.h"
+#include <iterator>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+namespace bolt {
+namespace btbb {
+namespace detail {
+
+    /*  Flags for the compaction engine.  A flag is called as flag( first, i ) and returns true when
+     *  element i of the range starting at first is kept.  */
+    template< typename Predicate >
+    struct CompactionKeepIf
+    {
+        Predicate pred;
+        CompactionKeepIf( const Predicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const { return pred( first[ i ] ) ? true : false; }
+    };
+
+    template< typename Predicate >
+    struct CompactionRemoveIf
+    {
+        Predicate pred;
+        CompactionRemoveIf( const Predicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const { return pred( first[ i ] ) ? false : true; }
+    };
+
+    template< typename BinaryPredicate >
+    struct CompactionUniqueHeads
+    {
+        BinaryPredicate pred;
+        CompactionUniqueHeads( const BinaryPredicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const
+        {
+            return ( i == 0 || !pred( first[ i - 1 ], first[ i ] ) );
+        }
+    };
+
+    template< typename Flag >
+    struct CompactionRejected
+    {
+        Flag flag;
+        CompactionRejected( const Flag& _flag ) : flag( _flag ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const { return !flag( first, i ); }
+    };
+
+    /*  parallel_scan body; the pre-scan counts the kept elements of a range, the final scan also
+     *  writes them at their running offset.  */
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename Flag >
+    struct Compaction_tbb
+    {
+        size_t sum;
+        InputIterator first;
+        ValuesIterator values_first;
+        OutputIterator result;
+        ValuesOutputIterator values_result;
+        Flag flag;
+        bool hasValues;
+
+        Compaction_tbb( const InputIterator& _first, const ValuesIterator& _values_first,
+                        const OutputIterator& _result, const ValuesOutputIterator& _values_result,
+                        const Flag& _flag, bool _hasValues ) :
+            sum( 0 ), first( _first ), values_first( _values_first ), result( _result ),
+            values_result( _values_result ), flag( _flag ), hasValues( _hasValues ) { }
+
+        Compaction_tbb( Compaction_tbb& b, tbb::split ) :
+            sum( 0 ), first( b.first ), values_first( b.values_first ), result( b.result ),
+            values_result( b.values_result ), flag( b.flag ), hasValues( b.hasValues ) { }
+
+        template< typename Tag >
+        void operator()( const tbb::blocked_range< int >& r, Tag )
+        {
+            size_t temp = sum;
+            for( int i = r.begin( ); i < r.end( ); ++i )
+            {
+                if( !flag( first, i ) )
+                    continue;
+                if( Tag::is_final_scan( ) )
+                {
+                    result[ temp ] = first[ i ];
+                    if( hasValues )
+                        values_result[ temp ] = values_first[ i ];
+                }
+                ++temp;
+            }
+            sum = temp;
+        }
+
+        void reverse_join( Compaction_tbb& a ) { sum = a.sum + sum; }
+        void assign( Compaction_tbb& b ) { sum = b.sum; }
+    };
+
+    /*! \brief Copies the elements of [first, last) that flag keeps to result, in order, and the matching
+     *  values from values_first to values_result when hasValues is set.  With writeRejected the elements
+     *  that are not kept follow the kept ones, also in order.  The output must not overlap the input.
+     *  \return The number of elements kept.
+     */
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename Flag >
+    size_t compaction( InputIterator first, InputIterator last, ValuesIterator values_first,
+                       OutputIterator result, ValuesOutputIterator values_result, const Flag& flag,
+                       bool hasValues, bool writeRejected )
+    {
+        int numElements = static_cast< int >( std::distance( first, last ) );
+        if( numElements == 0 )
+            return 0;
+
+        Compaction_tbb< InputIterator, ValuesIterator, OutputIterator, ValuesOutputIterator, Flag >
+            kept( first, values_first, result, values_result, flag, hasValues );
+        bolt::btbb::execute( [&]( )
+        {
+            tbb::parallel_scan( tbb::blocked_range< int >( 0, numElements, bolt::btbb::grainSize( ) ), kept, tbb::auto_partitioner( ) );
+        } );
+
+        if( writeRejected )
+        {
+            Compaction_tbb< InputIterator, ValuesIterator, OutputIterator, ValuesOutputIterator,
+                            CompactionRejected< Flag > >
+                rejected( first, values_first, result + kept.sum, values_result + kept.sum,
+                          CompactionRejected< Flag >( flag ), hasValues );
+            bolt::btbb::execute( [&]( )
+            {
+                tbb::parallel_scan( tbb::blocked_range< int >( 0, numElements, bolt::btbb::grainSize( ) ), rejected, tbb::auto_partitioner( ) );
+            } );
+        }
+
+        return kept.sum;
+    }
+
+    /*  In place form; the input is staged through host temporaries.  */
+    template< typename ForwardIterator, typename ValuesIterator, typename Flag >
+    size_t compaction_inplace( ForwardIterator first, ForwardIterator last, ValuesIterator values_first,
+                               const Flag& flag, bool hasValues, bool writeRejected )
+    {
+        typedef typename std::iterator_traits< ForwardIterator >::value_type kType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+
+        std::vector< kType > keys( first, last );
+        if( !hasValues )
+            return compaction( keys.begin( ), keys.end( ), keys.begin( ), first, first, flag, false, writeRejected );
+
+        std::vector< vType > values( values_first, values_first + keys.size( ) );
+        return compaction( keys.begin( ), keys.end( ), values.begin( ), first, values_first, flag, true,
+                           writeRejected );
+    }
+
+} // detail
+
+    template< typename InputIterator, typename OutputIterator, typename Predicate >
+    OutputIterator copy_if( InputIterator first, InputIterator last, OutputIterator result, Predicate pred )
+    {
+        return result + detail::compaction( first, last, first, result, result,
+                                            detail::CompactionKeepIf< Predicate >( pred ), false, false );
+    }
+
+    template< typename ForwardIterator, typename Predicate >
+    ForwardIterator remove_if( ForwardIterator first, ForwardIterator last, Predicate pred )
+    {
+        return first + detail::compaction_inplace( first, last, first,
+                                                   detail::CompactionRemoveIf< Predicate >( pred ), false, false );
+    }
+
+    template< typename ForwardIterator, typename BinaryPredicate >
+    ForwardIterator unique( ForwardIterator first, ForwardIterator last, BinaryPredicate binary_pred )
+    {
+        return first + detail::compaction_inplace( first, last, first,
+                                                   detail::CompactionUniqueHeads< BinaryPredicate >( binary_pred ),
+                                                   false, false );
+    }
+
+    template< typename ForwardIterator1, typename ForwardIterator2, typename BinaryPredicate >
+    std::pair< ForwardIterator1, ForwardIterator2 > unique_by_key( ForwardIterator1 keys_first,
+        ForwardIterator1 keys_last, ForwardIterator2 values_first, BinaryPredicate binary_pred )
+    {
+        size_t numKept = detail::compaction_inplace( keys_first, keys_last, values_first,
+            detail::CompactionUniqueHeads< BinaryPredicate >( binary_pred ), true, false );
+        return std::make_pair( keys_first + numKept, values_first + numKept );
+    }
+
+    template< typename ForwardIterator, typename Predicate >
+    ForwardIterator stable_partition( ForwardIterator first, ForwardIterator last, Predicate pred )
+    {
+        return first + detail::compaction_inplace( first, last, first,
+                                                   detail::CompactionKeepIf< Predicate >( pred ), false, true );
+    }
+
+    template< typename ForwardIterator, typename Predicate >
+    ForwardIterator partition( ForwardIterator first, ForwardIterator last, Predicate pred )
+    {
+        return bolt::btbb::stable_partition( first, last, pred );
+    }
+
+} // btbb
+} // bolt
+
+#endif // BOLT_BTBB_COMPACTION_INL
@@ -21,7 +21,7 @@
 
 #include "tbb/parallel_reduce.h"
 #include "tbb/blocked_range.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 
 namespace bolt{
     namespace btbb {
@@ -87,9 +87,11 @@ namespace bolt{
 
            			typedef typename std::iterator_traits<InputIterator>::difference_type iType;
 
-                    tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
                     Count<iType,InputIterator,Predicate> count_op(predicate);
-                    tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last), count_op );
+                    bolt::btbb::execute( [&]( )
+                    {
+                        tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last, bolt::btbb::grainSize( )), count_op );
+                    } );
                     return count_op.value;
 
 			}
@@ -22,7 +22,7 @@
 #if !defined( BOLT_BTBB_GATHER_INL )
 #define BOLT_BTBB_GATHER_INL
 #pragma once
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 
@@ -42,13 +42,14 @@ void gather(InputIterator1 mapfirst,
              { 
                 // std::cout<<"TBB code path...\n";
                  size_t numElements = static_cast< unsigned int >( std::distance( mapfirst, maplast ) );
-                //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);       
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
-                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                        *(result + (int)iter) = * (input + mapfirst[(int)iter]); 
-                  });
+                 bolt::btbb::execute( [&]( )
+                 {
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                      {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                            *(result + (int)iter) = * (input + mapfirst[(int)iter]); 
+                      });
+                 } );
              }
 
 template<typename InputIterator1,
@@ -64,16 +65,17 @@ template<typename InputIterator1,
         {
                  //std::cout<<"TBB code path...\n";
                  size_t numElements = static_cast< unsigned int >( std::distance( mapfirst, maplast ) );
-                 //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
+                 bolt::btbb::execute( [&]( )
                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                    {
-                         if(stencil[(int)iter]== 1)	   
-                                 result[(int)iter] = input[mapfirst[(int)iter]];       
-                    }					
-                });
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                     {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                        {
+                             if(stencil[(int)iter]== 1)	   
+                                     result[(int)iter] = input[mapfirst[(int)iter]];       
+                        }					
+                    });
+                 } );
         }
 
 
@@ -92,16 +94,17 @@ template<typename InputIterator1,
         {
                  //std::cout<<"TBB code path...\n";
                  size_t numElements = static_cast< unsigned int >( std::distance( mapfirst, maplast) );
-                 //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
+                 bolt::btbb::execute( [&]( )
                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                    {
-                         if(pred(stencil[(int)iter]))   
-                                  result[(int)iter] = input[mapfirst[(int)iter]]; 						            
-                    }					
-                });
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                     {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                        {
+                             if(pred(stencil[(int)iter]))   
+                                      result[(int)iter] = input[mapfirst[(int)iter]]; 						            
+                        }					
+                    });
+                 } );
         }
 
     }
@@ -19,7 +19,7 @@
 #define BOLT_BTBB_GENERATE_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 
@@ -38,7 +38,7 @@ namespace bolt{
                 {
                     typedef typename std::iterator_traits<ForwardIterator>::value_type iType;
 
-                    tbb::parallel_for(  tbb::blocked_range<ForwardIterator>(first, last) ,
+                    tbb::parallel_for(  tbb::blocked_range<ForwardIterator>(first, last, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<ForwardIterator> &r) -> void
                         {
                               for(ForwardIterator a = r.begin(); a!=r.end(); a++)
@@ -51,10 +51,11 @@ namespace bolt{
             template<typename ForwardIterator, typename Generator>
             void generate( ForwardIterator first, ForwardIterator last, Generator gen)
             {
-               //This allows TBB to choose the number of threads to spawn.
-               tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
                Generate <ForwardIterator, Generator> generate_obj(gen);
-               generate_obj(first, last, gen);
+               bolt::btbb::execute( [&]( )
+               {
+                   generate_obj(first, last, gen);
+               } );
             }       
     } //tbb
 } // bolt
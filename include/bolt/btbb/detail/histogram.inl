@@ -0,0 +1,158 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_BTBB_HISTOGRAM_INL )
+#define BOLT_BTBB_HISTOGRAM_INL
+#pragma once
+
+#include "bolt/btbb/arena.h"
+#include "tbb/parallel_reduce.h"
+#include "tbb/blocked_range.h"
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace bolt {
+namespace btbb {
+namespace detail {
+
+    /*  Binners for the histogram.  A binner is called as binner( x ) and returns the bin of x, or numBins
+     *  when x is not counted.  */
+    template< typename T >
+    struct HistogramEvenBins
+    {
+        T lower;
+        T upper;
+        T scale;
+        size_t numBins;
+
+        HistogramEvenBins( const T& _lower, const T& _upper, size_t _numBins ) : lower( _lower ), upper( _upper ),
+            scale( std::is_integral< T >::value ? T( 0 ) : static_cast< T >( _numBins ) / ( _upper - _lower ) ),
+            numBins( _numBins ) { }
+
+        size_t operator()( const T& x ) const
+        {
+            if( !( x >= lower ) || !( x < upper ) )
+                return numBins;
+            unsigned long long bin = binOf( x, typename std::is_integral< T >::type( ) );
+            return static_cast< size_t >( ( std::min )( bin, static_cast< unsigned long long >( numBins - 1 ) ) );
+        }
+
+    private:
+        unsigned long long binOf( const T& x, std::true_type ) const
+        {
+            return ( ( static_cast< unsigned long long >( x ) - static_cast< unsigned long long >( lower ) ) *
+                numBins ) / ( static_cast< unsigned long long >( upper ) - static_cast< unsigned long long >( lower ) );
+        }
+
+        unsigned long long binOf( const T& x, std::false_type ) const
+        {
+            return static_cast< unsigned long long >( ( x - lower ) * scale );
+        }
+    };
+
+    template< typename T >
+    struct HistogramBincount
+    {
+        size_t numBins;
+
+        HistogramBincount( size_t _numBins ) : numBins( _numBins ) { }
+
+        size_t operator()( const T& x ) const
+        {
+            return ( static_cast< unsigned long long >( x ) < numBins ) ? static_cast< size_t >( x ) : numBins;
+        }
+    };
+
+    /*  parallel_reduce body; every task counts into its own bins, which are added up on join.  The last
+     *  entry collects the elements outside the bins.  */
+    template< typename InputIterator, typename Binner >
+    struct HistogramBody
+    {
+        InputIterator first;
+        const Binner& binner;
+        std::vector< size_t > counts;
+
+        HistogramBody( const InputIterator& _first, const Binner& _binner ) : first( _first ), binner( _binner ),
+            counts( _binner.numBins + 1, 0 ) { }
+
+        HistogramBody( HistogramBody& s, tbb::split ) : first( s.first ), binner( s.binner ),
+            counts( s.binner.numBins + 1, 0 ) { }
+
+        void operator()( const tbb::blocked_range< size_t >& r )
+        {
+            for( size_t i = r.begin( ); i != r.end( ); ++i )
+                ++counts[ binner( *( first + i ) ) ];
+        }
+
+        void join( const HistogramBody& rhs )
+        {
+            for( size_t b = 0; b < counts.size( ); ++b )
+                counts[ b ] += rhs.counts[ b ];
+        }
+    };
+
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram( InputIterator first, InputIterator last, OutputIterator bins_first,
+                              const Binner& binner )
+    {
+        typedef typename std::iterator_traits< OutputIterator >::value_type oType;
+
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+
+        //  A task bins at least as many elements as it has bins to clear and join
+        size_t grainSize = ( std::max )( ( std::max )( static_cast< size_t >( 1024 ), binner.numBins ),
+                                         bolt::btbb::grainSize( ) );
+
+        HistogramBody< InputIterator, Binner > body( first, binner );
+        bolt::btbb::execute( [&]( )
+        {
+            tbb::parallel_reduce( tbb::blocked_range< size_t >( 0, numElements, grainSize ), body );
+        } );
+
+        for( size_t b = 0; b < binner.numBins; ++b, ++bins_first )
+            *bins_first = static_cast< oType >( body.counts[ b ] );
+        return bins_first;
+    }
+
+}//end of namespace detail
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator histogram( InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins,
+                              typename std::iterator_traits< InputIterator >::value_type lower,
+                              typename std::iterator_traits< InputIterator >::value_type upper )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+        if( num_bins == 0 )
+            return bins_first;
+        return detail::histogram( first, last, bins_first, detail::HistogramEvenBins< iType >( lower, upper, num_bins ) );
+    }
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator bincount( InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+        if( num_bins == 0 )
+            return bins_first;
+        return detail::histogram( first, last, bins_first, detail::HistogramBincount< iType >( num_bins ) );
+    }
+
+}//end of namespace btbb
+}//end of namespace bolt
+
+#endif
@@ -19,7 +19,7 @@
 #define BOLT_BTBB_INNER_PRODUCT_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 //#include <thread>
@@ -49,7 +49,7 @@ namespace bolt{
                       std::vector<OutputType> res_vector(n);
                       typename std::vector<OutputType>::iterator res = res_vector.begin();
 
-                      tbb::parallel_for(  tbb::blocked_range<int>(0, n) ,
+                      tbb::parallel_for(  tbb::blocked_range<int>(0, n, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                         {
                               for(int i = r.begin(); i!=r.end(); ++i)
@@ -73,17 +73,11 @@ namespace bolt{
             OutputType inner_product( InputIterator first1, InputIterator last1, InputIterator first2, OutputType init,
             BinaryFunction1 f1, BinaryFunction2 f2 )
             {
-              //Gets the number of concurrent threads supported by the underlying platform
-              //unsigned int concurentThreadsSupported = std::thread::hardware_concurrency();
-
-              //This allows TBB to choose the number of threads to spawn.
-              tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
-              //Explicitly setting the number of threads to spawn
-              //tbb::task_scheduler_init((int) concurentThreadsSupported);
-
               Inner_Product_Op <InputIterator, OutputType,BinaryFunction1, BinaryFunction2 > inner_prod_op;
-              inner_prod_op(first1, last1, first2, init, f1, f2);
+              bolt::btbb::execute( [&]( )
+              {
+                  inner_prod_op(first1, last1, first2, init, f1, f2);
+              } );
 
               return inner_prod_op.result;
            }
@@ -67,9 +67,11 @@ namespace bolt{
             BinaryFunction binary_op)
         {
             typedef typename std::iterator_traits<InputIterator>::value_type iType;
-            tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
             Reduce<T,InputIterator, BinaryFunction> reduce_op(binary_op, init);
-            tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last), reduce_op );
+            bolt::btbb::execute( [&]( )
+            {
+                tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last, bolt::btbb::grainSize( )), reduce_op );
+            } );
             return reduce_op.value;
         }
 
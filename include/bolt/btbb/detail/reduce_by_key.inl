@@ -21,7 +21,7 @@
 
 #include "bolt/cl/scan.h"
 #include "bolt/cl/scan_by_key.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include <iterator>
 #include "tbb/blocked_range.h"
 #include "tbb/parallel_for.h"
@@ -51,29 +51,29 @@ namespace bolt
                             BinaryFunction binary_op )
              { 
                 unsigned int numElements = static_cast< int >( std::distance( keys_first, keys_last ));
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
                 typedef typename std::iterator_traits< OutputIterator2 >::value_type voType;   
               
                 int *temKeyOutput = (int*)calloc(sizeof(int), numElements);  
                 voType *temValueOutput = (voType*)calloc(sizeof(voType), numElements); 
 
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
-                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                        {   if(iter == 0)
-                            {  
-                                temKeyOutput[iter] = 0;
-
+                 bolt::btbb::execute( [&]( )
+                 {
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                      {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                            {   if(iter == 0)
+                                {  
+                                    temKeyOutput[iter] = 0;
+
+                                }
+                                else if(binary_pred( keys_first[iter], keys_first[iter-1]))
+                                
+                                    temKeyOutput[iter] = 0;
+                                else 
+                                    temKeyOutput[iter] = 1;
                             }
-                            else if(binary_pred( keys_first[iter], keys_first[iter-1]))
-                            
-                                temKeyOutput[iter] = 0;
-                            else 
-                                temKeyOutput[iter] = 1;
-                        }
-                  }); 
+                      }); 
+                 } );
        
                    bolt::cl::control ctl = bolt::cl::control::getDefault( );
                    ctl.setForceRunMode(bolt::cl::control::MultiCoreCpu); 
@@ -84,16 +84,19 @@ namespace bolt
                    bolt::cl::inclusive_scan_by_key(ctl, temKeyOutput, temKeyOutput  + numElements,
 					          values_first, temValueOutput, bolt::cl::equal_to<int>(), binary_op);
 
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& s)
-                  {
-                    for(size_t iter = s.begin(); iter!=s.end(); iter++)
-                    {
-                        if(temKeyOutput[iter] != temKeyOutput[iter+1])
-                             values_output[temKeyOutput[iter]] = temValueOutput[iter];
+                 bolt::btbb::execute( [&]( )
+                 {
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& s)
+                      {
+                        for(size_t iter = s.begin(); iter!=s.end(); iter++)
+                        {
+                            if(temKeyOutput[iter] != temKeyOutput[iter+1])
+                                 values_output[temKeyOutput[iter]] = temValueOutput[iter];
 
-                        keys_output[temKeyOutput[iter]] = keys_first[iter];
-                    }
-                    }); 
+                            keys_output[temKeyOutput[iter]] = keys_first[iter];
+                        }
+                        }); 
+                 } );
 
                    int count = temKeyOutput[numElements-1] + 1;
 
@@ -103,10 +103,12 @@ inclusive_scan(
     {
                 unsigned int numElements = static_cast< unsigned int >( std::distance( first, last ) );
                typedef typename std::iterator_traits< InputIterator >::value_type iType;
-               tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
                Scan_tbb<InputIterator, OutputIterator, BinaryFunction, iType> tbb_scan((InputIterator &)first,(OutputIterator &)
                                                                          result,binary_op,true,iType());
-               tbb::parallel_scan( tbb::blocked_range<int>(  0, static_cast< int >( std::distance( first, last ))), tbb_scan, tbb::auto_partitioner());
+               bolt::btbb::execute( [&]( )
+               {
+                   tbb::parallel_scan( tbb::blocked_range<int>(  0, static_cast< int >( std::distance( first, last )), bolt::btbb::grainSize( )), tbb_scan, tbb::auto_partitioner());
+               } );
                return result + numElements;
     }
 
@@ -129,10 +131,12 @@ OutputIterator
 
                unsigned int numElements = static_cast< unsigned int >( std::distance( first, last ) );
                typedef typename std::iterator_traits< InputIterator >::value_type iType;
-               tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
                Scan_tbb<InputIterator, OutputIterator, BinaryFunction, iType> tbb_scan((InputIterator &)first,(OutputIterator &)
                                                                          result,binary_op,false,init);
-               tbb::parallel_scan( tbb::blocked_range<int>(  0, static_cast< int >( std::distance( first, last ))), tbb_scan, tbb::auto_partitioner());
+               bolt::btbb::execute( [&]( )
+               {
+                   tbb::parallel_scan( tbb::blocked_range<int>(  0, static_cast< int >( std::distance( first, last )), bolt::btbb::grainSize( )), tbb_scan, tbb::auto_partitioner());
+               } );
                return result + numElements;
     }
 
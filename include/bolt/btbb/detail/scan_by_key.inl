@@ -155,10 +155,12 @@ inclusive_scan_by_key(
 		unsigned int numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
 		typedef typename std::iterator_traits< InputIterator2 >::value_type vType;
 
-		tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
 		ScanKey_tbb<InputIterator1, InputIterator2, OutputIterator, BinaryFunction, BinaryPredicate,vType> tbbkey_scan((InputIterator1 &)first1,
 			(InputIterator2&) first2,(OutputIterator &)result, numElements, binary_funct, binary_pred, true, vType());
-		tbb::parallel_scan( tbb::blocked_range<unsigned int>(  0, static_cast< unsigned int >( std::distance( first1, last1 ))), tbbkey_scan, tbb::auto_partitioner());
+		bolt::btbb::execute( [&]( )
+		{
+		    tbb::parallel_scan( tbb::blocked_range<unsigned int>(  0, static_cast< unsigned int >( std::distance( first1, last1 )), bolt::btbb::grainSize( )), tbbkey_scan, tbb::auto_partitioner());
+		} );
 		return result + numElements;
 
 	}
@@ -219,10 +221,12 @@ exclusive_scan_by_key(
 	{
 		unsigned int numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
 
-		tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
 		ScanKey_tbb<InputIterator1, InputIterator2, OutputIterator, BinaryFunction, BinaryPredicate,T> tbbkey_scan((InputIterator1 &)first1,
 			(InputIterator2&) first2,(OutputIterator &)result, numElements, binary_funct, binary_pred, false, init);
-		tbb::parallel_scan( tbb::blocked_range<unsigned int>(  0, static_cast< unsigned int >( std::distance( first1, last1 ))), tbbkey_scan, tbb::auto_partitioner());
+		bolt::btbb::execute( [&]( )
+		{
+		    tbb::parallel_scan( tbb::blocked_range<unsigned int>(  0, static_cast< unsigned int >( std::distance( first1, last1 )), bolt::btbb::grainSize( )), tbbkey_scan, tbb::auto_partitioner());
+		} );
 		return result + numElements;
 
 	}
@@ -23,7 +23,7 @@
 #define BOLT_BTBB_SCATTER_INL
 
 #pragma once
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 namespace bolt 
@@ -41,13 +41,14 @@ void scatter(InputIterator1 first1,
              OutputIterator result)
              { 
                  size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
-                 //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);  
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
+                 bolt::btbb::execute( [&]( )
                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                             result[*(map+(int)iter)] = first1[(int)iter];
-                 });
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                     {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                                 result[*(map+(int)iter)] = first1[(int)iter];
+                     });
+                 } );
              }
 
 template<typename InputIterator1,
@@ -62,16 +63,17 @@ template<typename InputIterator1,
                   OutputIterator result)
             {
                  size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
-                //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);  
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
+                 bolt::btbb::execute( [&]( )
                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                    {
-                        if(stencil[iter] == 1)
-                            result[*(map+(int)iter)] = first1[(int)iter];
-                    }                            
-                 });
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                     {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                        {
+                            if(stencil[iter] == 1)
+                                result[*(map+(int)iter)] = first1[(int)iter];
+                        }                            
+                     });
+                 } );
            }
 
 
@@ -89,16 +91,17 @@ template<typename InputIterator1,
                   BinaryPredicate pred)
            {
 			     size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
-                //This allows TBB to choose the number of threads to spawn.               
-                 tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);  
-                 tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements),[&](const tbb::blocked_range<size_t>& r)
+                 bolt::btbb::execute( [&]( )
                  {
-                    for(size_t iter = r.begin(); iter!=r.end(); iter++)
-                    {
-                       if(pred(stencil[(int)iter]))
-                            result[*(map+((int)iter))] = first1[(int)iter];
-                    }                            
-                 });
+                     tbb::parallel_for (tbb::blocked_range<size_t>(0,numElements, bolt::btbb::grainSize( )),[&](const tbb::blocked_range<size_t>& r)
+                     {
+                        for(size_t iter = r.begin(); iter!=r.end(); iter++)
+                        {
+                           if(pred(stencil[(int)iter]))
+                                result[*(map+((int)iter))] = first1[(int)iter];
+                        }                            
+                     });
+                 } );
             }
 
     }
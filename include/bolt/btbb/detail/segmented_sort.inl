@@ -0,0 +1,144 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_BTBB_SEGMENTED_SORT_INL )
+#define BOLT_BTBB_SEGMENTED_SORT_INL
+#pragma once
+
+#include "bolt/btbb/arena.h"
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace bolt {
+namespace btbb {
+namespace detail {
+
+    template< typename KeysIterator, typename StrictWeakOrdering >
+    struct SegmentedSortPositionLess
+    {
+        KeysIterator keys;
+        StrictWeakOrdering comp;
+        SegmentedSortPositionLess( const KeysIterator& _keys, const StrictWeakOrdering& _comp ) :
+            keys( _keys ), comp( _comp ) { }
+
+        bool operator()( size_t a, size_t b ) const { return comp( keys[ a ], keys[ b ] ); }
+    };
+
+    /*  Sorts the segments of one sub-range of the offsets; every segment is sorted by one task  */
+    template< typename KeysIterator, typename ValuesIterator, typename OffsetIterator, typename StrictWeakOrdering >
+    struct SegmentedSortBody
+    {
+        typedef typename std::iterator_traits< KeysIterator >::value_type kType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+
+        KeysIterator keys;
+        ValuesIterator values;
+        OffsetIterator offsets;
+        size_t numSegments;
+        size_t numElements;
+        StrictWeakOrdering comp;
+        bool hasValues;
+
+        SegmentedSortBody( const KeysIterator& _keys, const ValuesIterator& _values, const OffsetIterator& _offsets,
+                           size_t _numSegments, size_t _numElements, const StrictWeakOrdering& _comp,
+                           bool _hasValues ) :
+            keys( _keys ), values( _values ), offsets( _offsets ), numSegments( _numSegments ),
+            numElements( _numElements ), comp( _comp ), hasValues( _hasValues ) { }
+
+        void operator()( const tbb::blocked_range< size_t >& r ) const
+        {
+            for( size_t s = r.begin( ); s != r.end( ); ++s )
+            {
+                size_t begin = static_cast< size_t >( offsets[ s ] );
+                size_t end = ( s + 1 < numSegments ) ? static_cast< size_t >( offsets[ s + 1 ] ) : numElements;
+                if( end > begin + 1 )
+                    sortSegment( begin, end - begin );
+            }
+        }
+
+    private:
+        void sortSegment( size_t begin, size_t count ) const
+        {
+            if( !hasValues )
+            {
+                std::sort( keys + begin, keys + begin + count, comp );
+                return;
+            }
+
+            std::vector< size_t > order( count );
+            for( size_t i = 0; i < count; ++i )
+                order[ i ] = i;
+            std::sort( order.begin( ), order.end( ),
+                       SegmentedSortPositionLess< KeysIterator, StrictWeakOrdering >( keys + begin, comp ) );
+
+            std::vector< kType > sortedKeys( count );
+            std::vector< vType > sortedValues( count );
+            for( size_t i = 0; i < count; ++i )
+            {
+                sortedKeys[ i ] = keys[ begin + order[ i ] ];
+                sortedValues[ i ] = values[ begin + order[ i ] ];
+            }
+            std::copy( sortedKeys.begin( ), sortedKeys.end( ), keys + begin );
+            std::copy( sortedValues.begin( ), sortedValues.end( ), values + begin );
+        }
+    };
+
+    template< typename KeysIterator, typename ValuesIterator, typename OffsetIterator, typename StrictWeakOrdering >
+    void segmented_sort( KeysIterator keys_first, KeysIterator keys_last, ValuesIterator values_first,
+                         OffsetIterator offsets_first, OffsetIterator offsets_last, StrictWeakOrdering comp,
+                         bool hasValues )
+    {
+        size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+        size_t numSegments = static_cast< size_t >( std::distance( offsets_first, offsets_last ) );
+        if( numElements < 2 || numSegments == 0 )
+            return;
+
+        //  The segments are independent; tbb splits them between the threads, a long segment stays on one
+        bolt::btbb::execute( [&]( )
+        {
+            tbb::parallel_for( tbb::blocked_range< size_t >( 0, numSegments ),
+                               SegmentedSortBody< KeysIterator, ValuesIterator, OffsetIterator, StrictWeakOrdering >(
+                                   keys_first, values_first, offsets_first, numSegments, numElements, comp,
+                                   hasValues ) );
+        } );
+    }
+
+} //end of namespace detail
+
+    template<typename RandomAccessIterator, typename OffsetIterator, typename StrictWeakOrdering>
+    void segmented_sort(RandomAccessIterator first, RandomAccessIterator last, OffsetIterator offsets_first,
+                        OffsetIterator offsets_last, StrictWeakOrdering comp)
+    {
+        detail::segmented_sort( first, last, first, offsets_first, offsets_last, comp, false );
+    }
+
+    template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+             typename StrictWeakOrdering>
+    void segmented_sort_by_key(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last,
+                               RandomAccessIterator2 values_first, OffsetIterator offsets_first,
+                               OffsetIterator offsets_last, StrictWeakOrdering comp)
+    {
+        detail::segmented_sort( keys_first, keys_last, values_first, offsets_first, offsets_last, comp, true );
+    }
+
+} //end of namespace btbb
+} //end of namespace bolt
+
+#endif
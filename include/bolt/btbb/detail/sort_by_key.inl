@@ -19,7 +19,7 @@
 #define BOLT_BTBB_SORT_BY_KEY_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 //#include <thread>
 #include <iterator>
 
@@ -64,7 +64,7 @@ namespace bolt{
                      std::vector<KeyValuePair> KeyValuePairVector(vecSize);
 
                      //Zip the key and values iterators into a tbb_sort vector.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -81,7 +81,7 @@ namespace bolt{
                      bolt::btbb::sort(KeyValuePairVector.begin(), KeyValuePairVector.end());
 
                      //Extract the keys and values from the KeyValuePair and fill the respective iterators. 
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -109,7 +109,7 @@ namespace bolt{
                      KeyValuePairFunctor functor(comp);
 
                      //Zip the key and values iterators into a tbb_sort vector.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -126,7 +126,7 @@ namespace bolt{
                      bolt::btbb::sort(KeyValuePairVector.begin(), KeyValuePairVector.end(), functor);
 
                      //Extract the keys and values from the KeyValuePair and fill the respective iterators.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -182,34 +182,22 @@ namespace bolt{
            void sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, 
            RandomAccessIterator2 values_first)
            {
-                //Gets the number of concurrent threads supported by the underlying platform
-                //unsigned int concurentThreadsSupported = std::thread::hardware_concurrency();
-
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
-                //Explicitly setting the number of threads to spawn
-                //tbb::task_scheduler_init((int) concurentThreadsSupported);
-
                 SortByKey <RandomAccessIterator1, RandomAccessIterator2 > sort_by_key_op;
-                sort_by_key_op(keys_first, keys_last, values_first);
+                bolt::btbb::execute( [&]( )
+                {
+                    sort_by_key_op(keys_first, keys_last, values_first);
+                } );
            }
 
            template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering> 
            void sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, 
            StrictWeakOrdering comp)
            {
-                //Gets the number of concurrent threads supported by the underlying platform
-                //unsigned int concurentThreadsSupported = std::thread::hardware_concurrency();
-
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
-                //Explicitly setting the number of threads to spawn
-                //tbb::task_scheduler_init((int) concurentThreadsSupported);
-
                 SortByKey_comp <RandomAccessIterator1, RandomAccessIterator2, StrictWeakOrdering >sort_by_key_op;
-                sort_by_key_op(keys_first, keys_last, values_first, comp);
+                bolt::btbb::execute( [&]( )
+                {
+                    sort_by_key_op(keys_first, keys_last, values_first, comp);
+                } );
           }
        
     } //tbb
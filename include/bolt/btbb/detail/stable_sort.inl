@@ -19,7 +19,7 @@
 #define BOLT_BTBB_STABLE_SORT_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_invoke.h"
 #include <iterator>
 
@@ -105,19 +105,21 @@ namespace bolt{
            template<typename RandomAccessIterator>
            void stable_sort(RandomAccessIterator first, RandomAccessIterator last)
            {
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
                 StableSort <RandomAccessIterator > stable_sort_op;
-                stable_sort_op(first, last);
+                bolt::btbb::execute( [&]( )
+                {
+                    stable_sort_op(first, last);
+                } );
            }
 
            template<typename RandomAccessIterator, typename StrictWeakOrdering>
            void stable_sort(RandomAccessIterator first, RandomAccessIterator last, StrictWeakOrdering comp)
            {
-               //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic); 			   
                 StableSort_comp <RandomAccessIterator, StrictWeakOrdering > stable_sort_op;
-                stable_sort_op(first, last, comp);
+                bolt::btbb::execute( [&]( )
+                {
+                    stable_sort_op(first, last, comp);
+                } );
            }
        
     } //tbb
@@ -19,7 +19,7 @@
 #define BOLT_BTBB_STABLE_SORT_BY_KEY_INL
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/parallel_invoke.h"
 //#include <thread>
 #include <iterator>
@@ -65,7 +65,7 @@ namespace bolt{
                      std::vector<KeyValuePair> KeyValuePairVector(vecSize);
 
                      //Zip the key and values iterators into a tbb_stable_sort vector.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -82,7 +82,7 @@ namespace bolt{
                      bolt::btbb::stable_sort(KeyValuePairVector.begin(), KeyValuePairVector.end());
 
                      //Extract the keys and values from the KeyValuePair and fill the respective iterators. 
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -110,7 +110,7 @@ namespace bolt{
                      KeyValuePairFunctor functor(comp);
 
                      //Zip the key and values iterators into a tbb_stable_sort vector.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -127,7 +127,7 @@ namespace bolt{
                      bolt::btbb::stable_sort(KeyValuePairVector.begin(), KeyValuePairVector.end(), functor);
 
                      //Extract the keys and values from the KeyValuePair and fill the respective iterators.
-                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize) ,
+                     tbb::parallel_for(  tbb::blocked_range<int>(0, (int) vecSize, bolt::btbb::grainSize( )) ,
                         [&] (const tbb::blocked_range<int> &r) -> void
                      {
                               
@@ -185,34 +185,22 @@ namespace bolt{
            void stable_sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, 
            RandomAccessIterator2 values_first)
            {
-                //Gets the number of concurrent threads supported by the underlying platform
-                //unsigned int concurentThreadsSupported = std::thread::hardware_concurrency();
-
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
-                //Explicitly setting the number of threads to spawn
-                //tbb::task_scheduler_init((int) concurentThreadsSupported);
-
                 StableSortByKey <RandomAccessIterator1, RandomAccessIterator2 > stable_sort_by_key_op;
-                stable_sort_by_key_op(keys_first, keys_last, values_first);
+                bolt::btbb::execute( [&]( )
+                {
+                    stable_sort_by_key_op(keys_first, keys_last, values_first);
+                } );
            }
 
            template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename StrictWeakOrdering> 
            void stable_sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first, 
            StrictWeakOrdering comp)
            {
-                //Gets the number of concurrent threads supported by the underlying platform
-                //unsigned int concurentThreadsSupported = std::thread::hardware_concurrency();
-
-                //This allows TBB to choose the number of threads to spawn.
-                tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
-
-                //Explicitly setting the number of threads to spawn
-                //tbb::task_scheduler_init((int) concurentThreadsSupported);
-
                 StableSortByKey_comp <RandomAccessIterator1, RandomAccessIterator2, StrictWeakOrdering > stable_sort_by_key_op;
-                stable_sort_by_key_op(keys_first, keys_last, values_first, comp);
+                bolt::btbb::execute( [&]( )
+                {
+                    stable_sort_by_key_op(keys_first, keys_last, values_first, comp);
+                } );
           }
        
     } //tbb
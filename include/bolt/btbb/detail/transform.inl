@@ -139,10 +139,13 @@ namespace bolt
 					   UnaryFunction op)
 		{
 
-			tbb::parallel_for(
-				transformUnaryRange< InputIterator, OutputIterator, UnaryFunction >( first, last, result, op ),
-				transformUnaryRangeBody< InputIterator, OutputIterator, UnaryFunction >( ),
-				tbb::simple_partitioner( ) );
+			bolt::btbb::execute( [&]( )
+			{
+			    tbb::parallel_for(
+			    	transformUnaryRange< InputIterator, OutputIterator, UnaryFunction >( first, last, result, op ),
+			    	transformUnaryRangeBody< InputIterator, OutputIterator, UnaryFunction >( ),
+			    	tbb::simple_partitioner( ) );
+			} );
 
 		}
 
@@ -153,11 +156,14 @@ namespace bolt
 					   OutputIterator result,
 					   BinaryFunction op)
 		{
-				tbb::parallel_for(
-					transformBinaryRange< InputIterator1, InputIterator2, OutputIterator, BinaryFunction >(
-						first1, last1, first2, result, op ),
-					transformBinaryRangeBody< InputIterator1, InputIterator2, OutputIterator, BinaryFunction >( ),
-					tbb::simple_partitioner( ) );
+				bolt::btbb::execute( [&]( )
+				{
+				    tbb::parallel_for(
+				    	transformBinaryRange< InputIterator1, InputIterator2, OutputIterator, BinaryFunction >(
+				    		first1, last1, first2, result, op ),
+				    	transformBinaryRangeBody< InputIterator1, InputIterator2, OutputIterator, BinaryFunction >( ),
+				    	tbb::simple_partitioner( ) );
+				} );
 
 		}
 
@@ -76,9 +76,11 @@ namespace bolt {
 		{
 
 				  typedef typename std::iterator_traits< InputIterator >::value_type iType;
-					tbb::task_scheduler_init initialize(tbb::task_scheduler_init::automatic);
 					Transform_Reduce<InputIterator, UnaryFunction, BinaryFunction,T> transform_reduce_op(transform_op, reduce_op, init);
-					tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last), transform_reduce_op );
+					bolt::btbb::execute( [&]( )
+					{
+					    tbb::parallel_reduce( tbb::blocked_range<InputIterator>( first, last, bolt::btbb::grainSize( )), transform_reduce_op );
+					} );
 					return transform_reduce_op.value;
 
 		}
@@ -0,0 +1,45 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_BTBB_HISTOGRAM_H )
+#define BOLT_BTBB_HISTOGRAM_H
+
+#include <iterator>
+
+/*! \file bolt/btbb/histogram.h
+    \brief counts how many elements of a range fall into each of a number of bins
+*/
+
+
+namespace bolt {
+    namespace btbb {
+
+       template<typename InputIterator, typename OutputIterator>
+       OutputIterator histogram(InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins,
+                                typename std::iterator_traits<InputIterator>::value_type lower,
+                                typename std::iterator_traits<InputIterator>::value_type upper);
+
+       template<typename InputIterator, typename OutputIterator>
+       OutputIterator bincount(InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins);
+
+    };
+};
+
+
+#include <bolt/btbb/detail/histogram.inl>
+
+#endif
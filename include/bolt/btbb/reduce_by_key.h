@@ -21,7 +21,7 @@
 
 #include "tbb/parallel_scan.h"
 #include "tbb/blocked_range.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 
 
 
@@ -20,7 +20,7 @@
 #define BOLT_BTBB_SCATTER_H
 
 #include "tbb/blocked_range.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 #include "tbb/tbb.h"
 #include "tbb/parallel_for.h"
 
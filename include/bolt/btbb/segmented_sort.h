@@ -0,0 +1,45 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_BTBB_SEGMENTED_SORT_H )
+#define BOLT_BTBB_SEGMENTED_SORT_H
+
+/*! \file bolt/btbb/segmented_sort.h
+    \brief sorts every segment of a range independently
+*/
+
+
+namespace bolt {
+    namespace btbb {
+
+       template<typename RandomAccessIterator, typename OffsetIterator, typename StrictWeakOrdering>
+       void segmented_sort(RandomAccessIterator first, RandomAccessIterator last, OffsetIterator offsets_first,
+                           OffsetIterator offsets_last, StrictWeakOrdering comp);
+
+       template<typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+                typename StrictWeakOrdering>
+       void segmented_sort_by_key(RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last,
+                                  RandomAccessIterator2 values_first, OffsetIterator offsets_first,
+                                  OffsetIterator offsets_last, StrictWeakOrdering comp);
+
+    };
+};
+
+
+#include <bolt/btbb/detail/segmented_sort.inl>
+
+#endif
@@ -20,7 +20,7 @@
 #pragma once
 
 #include "tbb/parallel_sort.h"
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 
 
 
@@ -19,7 +19,7 @@
 #define BOLT_BTBB_STABLE_SORT_BY_KEY_H
 #pragma once
 
-#include "tbb/task_scheduler_init.h"
+#include "bolt/btbb/arena.h"
 
 
 /*! \file bolt/btbb/stable_sort_by_key.h
@@ -25,6 +25,7 @@
 
 #include "tbb/parallel_for_each.h"
 #include "tbb/parallel_for.h"
+#include "bolt/btbb/arena.h"
 
 /*! \file transform.h
 */
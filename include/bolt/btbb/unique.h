@@ -0,0 +1,44 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_BTBB_UNIQUE_H )
+#define BOLT_BTBB_UNIQUE_H
+
+#include <utility>
+
+/*! \file bolt/btbb/unique.h
+    \brief removes all but the first element of every run of equivalent elements
+*/
+
+
+namespace bolt {
+    namespace btbb {
+
+       template<typename ForwardIterator, typename BinaryPredicate>
+       ForwardIterator unique(ForwardIterator first, ForwardIterator last, BinaryPredicate binary_pred);
+
+       template<typename ForwardIterator1, typename ForwardIterator2, typename BinaryPredicate>
+       std::pair<ForwardIterator1, ForwardIterator2> unique_by_key(ForwardIterator1 keys_first,
+           ForwardIterator1 keys_last, ForwardIterator2 values_first, BinaryPredicate binary_pred);
+
+    };
+};
+
+
+#include <bolt/btbb/detail/compaction.inl>
+
+#endif
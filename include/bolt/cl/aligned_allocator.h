@@ -0,0 +1,145 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_ALIGNED_ALLOCATOR_H )
+#define BOLT_CL_ALIGNED_ALLOCATOR_H
+#pragma once
+
+/*! \file bolt/cl/aligned_allocator.h
+    \brief An allocator of host memory that OpenCL devices sharing memory with the host use without copying.
+*/
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <limits>
+#include "bolt/cl/bolt.h"
+
+#if defined( _WIN32 )
+    #include <malloc.h>
+#endif
+
+namespace bolt {
+    namespace cl {
+
+        /*! \brief A standard allocator whose allocations start on an \p Alignment boundary.
+        *   \details The algorithms wrap the host ranges they are given in CL_MEM_USE_HOST_PTR buffers.  On a device
+        *   that shares memory with the host, such as a CPU or an APU, the runtime uses a range in place only when it
+        *   starts on a page boundary, and otherwise copies it in and back out on every call.  Containers using this
+        *   allocator are never copied:
+        *   \code
+        *   std::vector< int, bolt::cl::aligned_allocator< int > > input( length );
+        *   bolt::cl::reduce( input.begin( ), input.end( ) );
+        *   \endcode
+        *   Copies that did happen are counted by getHostPtrStatistics.
+        *   \tparam Alignment A power of two, at least the alignment of T.
+        */
+        template< typename T, size_t Alignment = zeroCopyAlignment >
+        class aligned_allocator
+        {
+        public:
+            typedef T value_type;
+            typedef T* pointer;
+            typedef const T* const_pointer;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+
+            template< typename U >
+            struct rebind
+            {
+                typedef aligned_allocator< U, Alignment > other;
+            };
+
+            aligned_allocator( )
+            {}
+
+            template< typename U >
+            aligned_allocator( const aligned_allocator< U, Alignment >& )
+            {}
+
+            pointer address( reference x ) const
+            {
+                return &x;
+            }
+
+            const_pointer address( const_reference x ) const
+            {
+                return &x;
+            }
+
+            pointer allocate( size_type n, const void* = 0 )
+            {
+                if( n > max_size( ) )
+                    throw std::bad_alloc( );
+                if( n == 0 )
+                    return NULL;
+
+                void* p = NULL;
+#if defined( _WIN32 )
+                p = ::_aligned_malloc( n * sizeof( T ), Alignment );
+#else
+                if( ::posix_memalign( &p, Alignment, n * sizeof( T ) ) != 0 )
+                    p = NULL;
+#endif
+                if( p == NULL )
+                    throw std::bad_alloc( );
+                return static_cast< pointer >( p );
+            }
+
+            void deallocate( pointer p, size_type )
+            {
+#if defined( _WIN32 )
+                ::_aligned_free( p );
+#else
+                std::free( p );
+#endif
+            }
+
+            size_type max_size( ) const
+            {
+                return ( std::numeric_limits< size_type >::max )( ) / sizeof( T );
+            }
+
+            void construct( pointer p, const_reference value )
+            {
+                ::new( static_cast< void* >( p ) ) T( value );
+            }
+
+            void destroy( pointer p )
+            {
+                p->~T( );
+            }
+        };
+
+        template< typename T, typename U, size_t Alignment >
+        bool operator==( const aligned_allocator< T, Alignment >&, const aligned_allocator< U, Alignment >& )
+        {
+            return true;
+        }
+
+        template< typename T, typename U, size_t Alignment >
+        bool operator!=( const aligned_allocator< T, Alignment >&, const aligned_allocator< U, Alignment >& )
+        {
+            return false;
+        }
+
+    }
+}
+
+#endif
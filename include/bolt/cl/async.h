@@ -0,0 +1,510 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_ASYNC_H )
+#define BOLT_CL_ASYNC_H
+#pragma once
+
+#include <bolt/cl/bolt.h>
+#include <bolt/cl/device_vector.h>
+#include <bolt/cl/transform.h>
+#include <bolt/cl/copy.h>
+#include <bolt/cl/fill.h>
+#include <bolt/cl/reduce.h>
+#include <bolt/cl/reduce_by_key.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <string>
+
+/*! \file bolt/cl/async.h
+    \brief Variants of Bolt algorithms that return a future instead of waiting for the device.
+*/
+
+namespace bolt {
+    namespace cl {
+    namespace async {
+
+        /*! \addtogroup CL-async
+        *   \ingroup algorithms
+        *   \p The functions in bolt::cl::async enqueue the same work as their bolt::cl counterparts, but return as
+        *   soon as it is submitted.  The returned future completes when the device has finished.
+        *
+        *   \details Consecutive calls on the same control are ordered by the command queue: Bolt queues are in-order,
+        *   and on an out-of-order queue every async call starts with a barrier.  No host wait happens between them.
+        *   Results are left in device memory, so the asynchrony only pays off for device_vector ranges; calls on
+        *   host iterators complete before they return.  Input and output containers must outlive the future.
+        *
+        *   \details While a call is being enqueued the control is switched to control::NoWait, so a control should
+        *   not be shared with another thread that issues calls at the same time.
+        *   \{
+        */
+
+        namespace detail
+        {
+            template< typename T >
+            struct futureState
+            {
+                ::cl::Event event;
+                boost::function< T ( ) > finish;
+                T value;
+                bool done;
+                boost::mutex guard;
+            };
+
+            /*! \brief Puts a control in NoWait mode for the lifetime of an async call, and produces the event that
+            *   completes with it.
+            */
+            class deferredCall
+            {
+            public:
+                explicit deferredCall( control& ctl ): m_ctl( ctl ), m_waitMode( ctl.getWaitMode( ) )
+                {
+                    m_ctl.setWaitMode( control::NoWait );
+
+                    const ::cl::CommandQueue& queue = m_ctl.getCommandQueue( );
+                    if( queue( ) == NULL )
+                        return;
+
+                    cl_command_queue_properties queueProperties = 0;
+                    V_OPENCL( queue.getInfo( CL_QUEUE_PROPERTIES, &queueProperties ),
+                        "Error querying the command queue properties" );
+                    if( queueProperties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE )
+                        V_OPENCL( queue.enqueueBarrier( ), "Error enqueueing a barrier before an async call" );
+                }
+
+                ~deferredCall( )
+                {
+                    m_ctl.setWaitMode( m_waitMode );
+                }
+
+                //  A marker completes when every command enqueued before it has completed
+                ::cl::Event complete( )
+                {
+                    ::cl::Event marker;
+                    const ::cl::CommandQueue& queue = m_ctl.getCommandQueue( );
+                    if( queue( ) == NULL )
+                        return marker;
+
+                    V_OPENCL( queue.enqueueMarker( &marker ), "Error enqueueing the marker of an async call" );
+                    V_OPENCL( queue.flush( ), "Error flushing the command queue of an async call" );
+                    return marker;
+                }
+
+            private:
+                control& m_ctl;
+                control::e_WaitMode m_waitMode;
+
+                deferredCall( const deferredCall& );
+                deferredCall& operator=( const deferredCall& );
+            };
+        };
+
+        /*! \brief Handle to the result of an async call that produces a value.
+        *   \details get( ) blocks until the device has finished, then runs the host side of the call once and
+        *   returns its value.  Copies of a future share the same result.
+        */
+        template< typename T >
+        class future
+        {
+        public:
+            typedef T value_type;
+
+            future( ) { }
+
+            //  A future that is already complete
+            explicit future( const T& value ): m_state( new detail::futureState< T >( ) )
+            {
+                m_state->value = value;
+                m_state->done = true;
+            }
+
+            //  A future that completes with event, after which finish computes the value on the host
+            future( const ::cl::Event& event, const boost::function< T ( ) >& finish ):
+                m_state( new detail::futureState< T >( ) )
+            {
+                m_state->event = event;
+                m_state->finish = finish;
+                m_state->done = false;
+            }
+
+            bool valid( ) const
+            {
+                return m_state.get( ) != NULL;
+            }
+
+            //  True when get( ) will not have to wait for the device
+            bool ready( ) const
+            {
+                if( m_state->done || m_state->event( ) == NULL )
+                    return true;
+                return m_state->event.getInfo< CL_EVENT_COMMAND_EXECUTION_STATUS >( ) == CL_COMPLETE;
+            }
+
+            void wait( ) const
+            {
+                if( m_state->event( ) != NULL )
+                    V_OPENCL( m_state->event.wait( ), "Error waiting for an async call" );
+            }
+
+            T get( ) const
+            {
+                boost::lock_guard< boost::mutex > lock( m_state->guard );
+                if( !m_state->done )
+                {
+                    wait( );
+                    m_state->value = m_state->finish( );
+                    m_state->finish.clear( );
+                    m_state->done = true;
+                }
+                return m_state->value;
+            }
+
+            const ::cl::Event& getEvent( ) const
+            {
+                return m_state->event;
+            }
+
+        private:
+            boost::shared_ptr< detail::futureState< T > > m_state;
+        };
+
+        /*! \brief Handle to the completion of an async call that leaves its results in device memory.
+        */
+        template< >
+        class future< void >
+        {
+        public:
+            typedef void value_type;
+
+            future( ): m_valid( false ) { }
+
+            explicit future( const ::cl::Event& event ): m_event( event ), m_valid( true ) { }
+
+            bool valid( ) const
+            {
+                return m_valid;
+            }
+
+            bool ready( ) const
+            {
+                if( m_event( ) == NULL )
+                    return true;
+                return m_event.getInfo< CL_EVENT_COMMAND_EXECUTION_STATUS >( ) == CL_COMPLETE;
+            }
+
+            void wait( ) const
+            {
+                if( m_event( ) != NULL )
+                    V_OPENCL( m_event.wait( ), "Error waiting for an async call" );
+            }
+
+            void get( ) const
+            {
+                wait( );
+            }
+
+            const ::cl::Event& getEvent( ) const
+            {
+                return m_event;
+            }
+
+        private:
+            ::cl::Event m_event;
+            bool m_valid;
+        };
+
+        /*! \brief Enqueues bolt::cl::transform of a unary operation.
+        *   \return A future that completes when the output sequence has been written.
+        *   \sa bolt::cl::transform
+        */
+        template< typename InputIterator, typename OutputIterator, typename UnaryFunction >
+        future< void > transform( bolt::cl::control &ctl, InputIterator first, InputIterator last,
+            OutputIterator result, UnaryFunction op, const std::string& user_code="" )
+        {
+            detail::deferredCall call( ctl );
+            bolt::cl::transform( ctl, first, last, result, op, user_code );
+            return future< void >( call.complete( ) );
+        }
+
+        template< typename InputIterator, typename OutputIterator, typename UnaryFunction >
+        future< void > transform( InputIterator first, InputIterator last, OutputIterator result, UnaryFunction op,
+            const std::string& user_code="" )
+        {
+            return async::transform( control::getDefault( ), first, last, result, op, user_code );
+        }
+
+        /*! \brief Enqueues bolt::cl::transform of a binary operation.
+        *   \return A future that completes when the output sequence has been written.
+        *   \sa bolt::cl::transform
+        */
+        template< typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction >
+        future< void > transform( bolt::cl::control &ctl, InputIterator1 first1, InputIterator1 last1,
+            InputIterator2 first2, OutputIterator result, BinaryFunction op, const std::string& user_code="" )
+        {
+            detail::deferredCall call( ctl );
+            bolt::cl::transform( ctl, first1, last1, first2, result, op, user_code );
+            return future< void >( call.complete( ) );
+        }
+
+        template< typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction >
+        future< void > transform( InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+            OutputIterator result, BinaryFunction op, const std::string& user_code="" )
+        {
+            return async::transform( control::getDefault( ), first1, last1, first2, result, op, user_code );
+        }
+
+        /*! \brief Enqueues bolt::cl::copy.
+        *   \return A future that completes when the output sequence has been written.
+        *   \sa bolt::cl::copy
+        */
+        template< typename InputIterator, typename OutputIterator >
+        future< void > copy( bolt::cl::control &ctl, InputIterator first, InputIterator last, OutputIterator result,
+            const std::string& user_code="" )
+        {
+            detail::deferredCall call( ctl );
+            bolt::cl::copy( ctl, first, last, result, user_code );
+            return future< void >( call.complete( ) );
+        }
+
+        template< typename InputIterator, typename OutputIterator >
+        future< void > copy( InputIterator first, InputIterator last, OutputIterator result,
+            const std::string& user_code="" )
+        {
+            return async::copy( control::getDefault( ), first, last, result, user_code );
+        }
+
+        /*! \brief Enqueues bolt::cl::fill.
+        *   \return A future that completes when the range has been written.
+        *   \sa bolt::cl::fill
+        */
+        template< typename ForwardIterator, typename T >
+        future< void > fill( bolt::cl::control &ctl, ForwardIterator first, ForwardIterator last, const T& value,
+            const std::string& cl_code="" )
+        {
+            detail::deferredCall call( ctl );
+            bolt::cl::fill( ctl, first, last, value, cl_code );
+            return future< void >( call.complete( ) );
+        }
+
+        template< typename ForwardIterator, typename T >
+        future< void > fill( ForwardIterator first, ForwardIterator last, const T& value,
+            const std::string& cl_code="" )
+        {
+            return async::fill( control::getDefault( ), first, last, value, cl_code );
+        }
+
+        namespace detail
+        {
+            template< typename T, typename InputIterator, typename BinaryFunction >
+            future< T > reduce_pick_iterator( bolt::cl::control &ctl, const InputIterator& first,
+                const InputIterator& last, const T& init, const BinaryFunction& binary_op,
+                const std::string& cl_code, std::random_access_iterator_tag )
+            {
+                return future< T >( bolt::cl::reduce( ctl, first, last, init, binary_op, cl_code ) );
+            }
+
+            //  Holds the device result until the read of its single value has completed
+            template< typename T >
+            struct deviceValue
+            {
+                control::buffPointer buffer;
+                boost::shared_ptr< T > value;
+
+                T operator( )( ) const
+                {
+                    return *value;
+                }
+            };
+
+            //  Only device side ranges reduce asynchronously; the whole reduction runs on the device and future::get( )
+            //  waits for a non-blocking read of the single result
+            template< typename T, typename DVInputIterator, typename BinaryFunction >
+            future< T > reduce_device( bolt::cl::control &ctl, const DVInputIterator& first,
+                const DVInputIterator& last, const T& init, const BinaryFunction& binary_op,
+                const std::string& cl_code )
+            {
+                if( std::distance( first, last ) == 0 )
+                    return future< T >( init );
+
+                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
+                if( runMode == bolt::cl::control::Automatic )
+                    runMode = ctl.getDefaultPathToRun( );
+                if( runMode != bolt::cl::control::OpenCL )
+                    return future< T >( bolt::cl::reduce( ctl, first, last, init, binary_op, cl_code ) );
+
+                //  NoWait gives the device its own copy of binary_op, so it may go out of scope before the kernels run
+                deferredCall call( ctl );
+                deviceValue< T > result;
+                result.buffer = bolt::cl::detail::reduce_enqueue_device( ctl, first, last, init, binary_op, cl_code );
+                result.value.reset( new T );
+
+                ::cl::Event readEvent;
+                V_OPENCL( ctl.getCommandQueue( ).enqueueReadBuffer( *result.buffer, CL_FALSE, 0, sizeof( T ),
+                    result.value.get( ), NULL, &readEvent ), "Error reading the result of an async reduce" );
+                V_OPENCL( ctl.getCommandQueue( ).flush( ), "Error flushing the command queue of an async call" );
+
+                return future< T >( readEvent, result );
+            }
+
+            template< typename T, typename DVInputIterator, typename BinaryFunction >
+            future< T > reduce_pick_iterator( bolt::cl::control &ctl, const DVInputIterator& first,
+                const DVInputIterator& last, const T& init, const BinaryFunction& binary_op,
+                const std::string& cl_code, bolt::cl::device_vector_tag )
+            {
+                return reduce_device( ctl, first, last, init, binary_op, cl_code );
+            }
+
+            template< typename T, typename DVInputIterator, typename BinaryFunction >
+            future< T > reduce_pick_iterator( bolt::cl::control &ctl, const DVInputIterator& first,
+                const DVInputIterator& last, const T& init, const BinaryFunction& binary_op,
+                const std::string& cl_code, bolt::cl::fancy_iterator_tag )
+            {
+                return reduce_device( ctl, first, last, init, binary_op, cl_code );
+            }
+        };
+
+        /*! \brief Enqueues bolt::cl::reduce.
+        *   \return A future whose get( ) returns the result of the reduction.
+        *   \sa bolt::cl::reduce
+        */
+        template< typename InputIterator, typename T, typename BinaryFunction >
+        future< T > reduce( bolt::cl::control &ctl, InputIterator first, InputIterator last, T init,
+            BinaryFunction binary_op, const std::string& cl_code="" )
+        {
+            return detail::reduce_pick_iterator( ctl, first, last, init, binary_op, cl_code,
+                typename std::iterator_traits< InputIterator >::iterator_category( ) );
+        }
+
+        template< typename InputIterator, typename T, typename BinaryFunction >
+        future< T > reduce( InputIterator first, InputIterator last, T init, BinaryFunction binary_op,
+            const std::string& cl_code="" )
+        {
+            return async::reduce( control::getDefault( ), first, last, init, binary_op, cl_code );
+        }
+
+        template< typename InputIterator, typename T >
+        future< T > reduce( bolt::cl::control &ctl, InputIterator first, InputIterator last, T init )
+        {
+            typedef typename std::iterator_traits< InputIterator >::value_type iType;
+            return async::reduce( ctl, first, last, init, bolt::cl::plus< iType >( ) );
+        }
+
+        template< typename InputIterator, typename T >
+        future< T > reduce( InputIterator first, InputIterator last, T init )
+        {
+            typedef typename std::iterator_traits< InputIterator >::value_type iType;
+            return async::reduce( control::getDefault( ), first, last, init, bolt::cl::plus< iType >( ) );
+        }
+
+        namespace detail
+        {
+            template< typename InputIterator1, typename InputIterator2, typename OutputIterator1,
+                      typename OutputIterator2, typename BinaryPredicate, typename BinaryFunction >
+            future< size_t > reduce_by_key_pick_iterator( bolt::cl::control &ctl, const InputIterator1& keys_first,
+                const InputIterator1& keys_last, const InputIterator2& values_first,
+                const OutputIterator1& keys_output, const OutputIterator2& values_output,
+                const BinaryPredicate& binary_pred, const BinaryFunction& binary_op, const std::string& cl_code,
+                std::random_access_iterator_tag )
+            {
+                bolt::cl::pair< OutputIterator1, OutputIterator2 > end = bolt::cl::reduce_by_key( ctl, keys_first,
+                    keys_last, values_first, keys_output, values_output, binary_pred, binary_op, cl_code );
+                return future< size_t >( static_cast< size_t >( std::distance( keys_output, end.first ) ) );
+            }
+
+            //  The segment count stays in device memory until future::get( ) waits for a non-blocking read of it
+            template< typename DVInputIterator1, typename DVInputIterator2, typename DVOutputIterator1,
+                      typename DVOutputIterator2, typename BinaryPredicate, typename BinaryFunction >
+            future< size_t > reduce_by_key_pick_iterator( bolt::cl::control &ctl, const DVInputIterator1& keys_first,
+                const DVInputIterator1& keys_last, const DVInputIterator2& values_first,
+                const DVOutputIterator1& keys_output, const DVOutputIterator2& values_output,
+                const BinaryPredicate& binary_pred, const BinaryFunction& binary_op, const std::string& cl_code,
+                bolt::cl::device_vector_tag )
+            {
+                size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+                bolt::cl::control::e_RunMode runMode = bolt::cl::selectRunMode( ctl, numElements,
+                    sizeof( typename std::iterator_traits< DVInputIterator1 >::value_type ) +
+                    sizeof( typename std::iterator_traits< DVInputIterator2 >::value_type ), true, true );
+                if( numElements <= 1 || runMode != bolt::cl::control::OpenCL )
+                    return reduce_by_key_pick_iterator( ctl, keys_first, keys_last, values_first, keys_output,
+                        values_output, binary_pred, binary_op, cl_code, std::random_access_iterator_tag( ) );
+
+                //  NoWait gives the device its own copies of the functors, so they may go out of scope before the
+                //  kernels run
+                deferredCall call( ctl );
+                deviceValue< cl_ulong > result;
+                result.buffer = bolt::cl::detail::reduce_by_key_enqueue_device( ctl, keys_first, keys_last,
+                    values_first, keys_output, values_output, binary_pred, binary_op, cl_code );
+                result.value.reset( new cl_ulong );
+
+                ::cl::Event readEvent;
+                V_OPENCL( ctl.getCommandQueue( ).enqueueReadBuffer( *result.buffer, CL_FALSE, 0, sizeof( cl_ulong ),
+                    result.value.get( ), NULL, &readEvent ), "Error reading the segment count of an async call" );
+                V_OPENCL( ctl.getCommandQueue( ).flush( ), "Error flushing the command queue of an async call" );
+
+                return future< size_t >( readEvent, result );
+            }
+        };
+
+        /*! \brief Enqueues bolt::cl::reduce_by_key.
+        *   \details When the keys are in a device_vector, the values and both outputs must be too; the reduced
+        *   segments are then written on the device with no host round trip, and only the segment count is read
+        *   back, when the future is asked for it.
+        *   \return A future whose get( ) returns the number of segments written to \p keys_output and
+        *   \p values_output.
+        *   \sa bolt::cl::reduce_by_key
+        */
+        template< typename InputIterator1, typename InputIterator2, typename OutputIterator1,
+                  typename OutputIterator2, typename BinaryPredicate, typename BinaryFunction >
+        future< size_t > reduce_by_key( bolt::cl::control &ctl, InputIterator1 keys_first, InputIterator1 keys_last,
+            InputIterator2 values_first, OutputIterator1 keys_output, OutputIterator2 values_output,
+            BinaryPredicate binary_pred, BinaryFunction binary_op, const std::string& cl_code="" )
+        {
+            return detail::reduce_by_key_pick_iterator( ctl, keys_first, keys_last, values_first, keys_output,
+                values_output, binary_pred, binary_op, cl_code,
+                typename std::iterator_traits< InputIterator1 >::iterator_category( ) );
+        }
+
+        template< typename InputIterator1, typename InputIterator2, typename OutputIterator1,
+                  typename OutputIterator2 >
+        future< size_t > reduce_by_key( bolt::cl::control &ctl, InputIterator1 keys_first, InputIterator1 keys_last,
+            InputIterator2 values_first, OutputIterator1 keys_output, OutputIterator2 values_output )
+        {
+            typedef typename std::iterator_traits< InputIterator1 >::value_type kType;
+            typedef typename std::iterator_traits< OutputIterator2 >::value_type voType;
+            return async::reduce_by_key( ctl, keys_first, keys_last, values_first, keys_output, values_output,
+                bolt::cl::equal_to< kType >( ), bolt::cl::plus< voType >( ) );
+        }
+
+        template< typename InputIterator1, typename InputIterator2, typename OutputIterator1,
+                  typename OutputIterator2 >
+        future< size_t > reduce_by_key( InputIterator1 keys_first, InputIterator1 keys_last,
+            InputIterator2 values_first, OutputIterator1 keys_output, OutputIterator2 values_output )
+        {
+            return async::reduce_by_key( control::getDefault( ), keys_first, keys_last, values_first, keys_output,
+                values_output );
+        }
+
+        /*!   \}  */
+    };
+    };
+};
+
+#endif
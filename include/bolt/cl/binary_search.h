@@ -140,6 +140,222 @@ namespace bolt {
             StrictWeakOrdering comp,
             const std::string& cl_code="");
 
+        /*! \brief This version of lower_bound searches a whole range of values at once. It writes, for every value in [values_first, values_last), the offset of the first position in the
+        * sorted input range where that value could be inserted without violating the ordering.
+        * The input range must be sorted with respect to the comparison in use.
+        *
+        * \details Every value is searched independently, so the call is equivalent to std::lower_bound applied to
+        * each value in turn, but runs as a single device launch. The values need not be sorted; when they are,
+        * neighbouring searches touch the same part of the input range and the search cost approaches that of a merge.
+        *
+        * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc. See bolt::cl::control.
+        * \param first The first position in the sequence to search.
+        * \param last  The last position in the sequence to search.
+        * \param values_first The first value to search for.
+        * \param values_last  The end of the values to search for.
+        * \param result The beginning of the output range, receiving the offset of the first element that is not less than the value for every search value.
+        * \param comp  \b Optional The comparison operation used to compare two values; defaults to bolt::cl::less.
+        * \param cl_code Optional OpenCL(TM) code to be passed to the OpenCL compiler. The cl_code is inserted first
+        * in the generated code, before the cl_code traits.
+        * \tparam ForwardIterator An iterator that can be dereferenced for an object, and can be incremented to get to the next element in a sequence.
+        * \tparam InputIterator An iterator over the values to search for.
+        * \tparam OutputIterator An iterator whose value type can hold the results.
+        * \return The end of the output range.
+        *
+        * \details The following code example shows the use of \p lower_bound on many values at once.
+        * \code
+        * #include <bolt/cl/binary_search.h>
+        *
+        * int a[8] = {1, 2, 3, 3, 5, 7, 8, 9};
+        * int v[3] = {3, 4, 9};
+        * int r[3];
+        *
+        * bolt::cl::lower_bound( a, a+8, v, v+3, r );
+        *
+        * \endcode
+        * \sa http://www.sgi.com/tech/stl/lower_bound.html
+        */
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator lower_bound(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator lower_bound(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator lower_bound(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator lower_bound(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
+        /*! \brief This version of upper_bound searches a whole range of values at once. It writes, for every value in [values_first, values_last), the offset of the last position in the
+        * sorted input range where that value could be inserted without violating the ordering.
+        * The input range must be sorted with respect to the comparison in use.
+        *
+        * \details Every value is searched independently, so the call is equivalent to std::upper_bound applied to
+        * each value in turn, but runs as a single device launch. The values need not be sorted; when they are,
+        * neighbouring searches touch the same part of the input range and the search cost approaches that of a merge.
+        *
+        * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc. See bolt::cl::control.
+        * \param first The first position in the sequence to search.
+        * \param last  The last position in the sequence to search.
+        * \param values_first The first value to search for.
+        * \param values_last  The end of the values to search for.
+        * \param result The beginning of the output range, receiving the offset of the first element that is greater than the value for every search value.
+        * \param comp  \b Optional The comparison operation used to compare two values; defaults to bolt::cl::less.
+        * \param cl_code Optional OpenCL(TM) code to be passed to the OpenCL compiler. The cl_code is inserted first
+        * in the generated code, before the cl_code traits.
+        * \tparam ForwardIterator An iterator that can be dereferenced for an object, and can be incremented to get to the next element in a sequence.
+        * \tparam InputIterator An iterator over the values to search for.
+        * \tparam OutputIterator An iterator whose value type can hold the results.
+        * \return The end of the output range.
+        *
+        * \details The following code example shows the use of \p upper_bound on many values at once.
+        * \code
+        * #include <bolt/cl/binary_search.h>
+        *
+        * int a[8] = {1, 2, 3, 3, 5, 7, 8, 9};
+        * int v[3] = {3, 4, 9};
+        * int r[3];
+        *
+        * bolt::cl::upper_bound( a, a+8, v, v+3, r );
+        *
+        * \endcode
+        * \sa http://www.sgi.com/tech/stl/upper_bound.html
+        */
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator upper_bound(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator upper_bound(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator upper_bound(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator upper_bound(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
+        /*! \brief This version of binary_search searches a whole range of values at once. It writes, for every value in [values_first, values_last), 1 if the value is present in the
+        * sorted input range and 0 otherwise.
+        * The input range must be sorted with respect to the comparison in use.
+        *
+        * \details Every value is searched independently, so the call is equivalent to std::binary_search applied to
+        * each value in turn, but runs as a single device launch. The values need not be sorted; when they are,
+        * neighbouring searches touch the same part of the input range and the search cost approaches that of a merge.
+        *
+        * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc. See bolt::cl::control.
+        * \param first The first position in the sequence to search.
+        * \param last  The last position in the sequence to search.
+        * \param values_first The first value to search for.
+        * \param values_last  The end of the values to search for.
+        * \param result The beginning of the output range, receiving the 1 or 0 for every search value.
+        * \param comp  \b Optional The comparison operation used to compare two values; defaults to bolt::cl::less.
+        * \param cl_code Optional OpenCL(TM) code to be passed to the OpenCL compiler. The cl_code is inserted first
+        * in the generated code, before the cl_code traits.
+        * \tparam ForwardIterator An iterator that can be dereferenced for an object, and can be incremented to get to the next element in a sequence.
+        * \tparam InputIterator An iterator over the values to search for.
+        * \tparam OutputIterator An iterator whose value type can hold the results.
+        * \return The end of the output range.
+        *
+        * \details The following code example shows the use of \p binary_search on many values at once.
+        * \code
+        * #include <bolt/cl/binary_search.h>
+        *
+        * int a[8] = {1, 2, 3, 3, 5, 7, 8, 9};
+        * int v[3] = {3, 4, 9};
+        * int r[3];
+        *
+        * bolt::cl::binary_search( a, a+8, v, v+3, r );
+        *
+        * \endcode
+        * \sa http://www.sgi.com/tech/stl/binary_search.html
+        */
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator binary_search(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator binary_search(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator binary_search(bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator, typename StrictWeakOrdering>
+        OutputIterator binary_search(ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code="");
+
     }// end of bolt::cl namespace
 }// end of bolt namespace
 
@@ -60,3 +60,136 @@ __kernel void binarysearch_kernel(
     
     result[resultIndex+gloId] = found;
 };
+
+
+/******************************************************************************
+ *  Vectorized search: one query value per work item, written to result as the
+ *  position of its lower bound ( searchMode 0 ), upper bound ( 1 ), or 1 / 0 for
+ *  found / not found ( 2 ).  Each work-group first reduces the minimum and the
+ *  maximum of its queries and bounds them in the whole table once; every query of
+ *  the group then only searches that window.  Queries that arrive sorted therefore
+ *  search a window about as wide as the table slice they cover, close to the cost
+ *  of a merge, while unsorted queries lose no more than two extra searches per group.
+ *****************************************************************************/
+
+template< typename iType, typename iIterType, typename vType, typename StrictWeakOrdering >
+uint searchLowerBound( iIterType input_iter, uint low, uint high, vType value, global StrictWeakOrdering * comp )
+{
+    while( low < high )
+    {
+        uint mid = ( low + high ) / 2;
+        iType midVal = input_iter[ mid ];
+        if( (*comp)( midVal, value ) )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+template< typename iType, typename iIterType, typename vType, typename StrictWeakOrdering >
+uint searchUpperBound( iIterType input_iter, uint low, uint high, vType value, global StrictWeakOrdering * comp )
+{
+    while( low < high )
+    {
+        uint mid = ( low + high ) / 2;
+        iType midVal = input_iter[ mid ];
+        if( !(*comp)( value, midVal ) )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+template< typename iType, typename iIterType, typename vType, typename vIterType, typename oType, typename oIterType,
+    typename StrictWeakOrdering >
+__kernel void vectorizedSearchTemplate(
+ global iType * src,
+ iIterType input_iter,
+ const uint numElements,
+ global vType * values,
+ vIterType values_iter,
+ const uint numValues,
+ global oType * result,
+ oIterType result_iter,
+ global StrictWeakOrdering * comp,
+ const int searchMode,
+ local vType * ldsMin,
+ local vType * ldsMax )
+ {
+    local uint window[ 2 ];
+
+    input_iter.init( src );
+    values_iter.init( values );
+    result_iter.init( result );
+
+    uint gloId = get_global_id( 0 );
+    uint locId = get_local_id( 0 );
+    uint groupStart = get_group_id( 0 ) * get_local_size( 0 );
+    uint groupCount = min( (uint)get_local_size( 0 ), numValues - groupStart );
+
+    //  Work items past the end of the queries stay for the barriers but take no part in the reduction
+    vType value;
+    if( gloId < numValues )
+    {
+        value = values_iter[ gloId ];
+        ldsMin[ locId ] = value;
+        ldsMax[ locId ] = value;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( uint offset = 1; offset < groupCount; offset <<= 1 )
+    {
+        if( ( locId % ( offset << 1 ) ) == 0 && ( locId + offset ) < groupCount )
+        {
+            vType mine  = ldsMin[ locId ];
+            vType other = ldsMin[ locId + offset ];
+            if( (*comp)( other, mine ) )
+                ldsMin[ locId ] = other;
+
+            mine  = ldsMax[ locId ];
+            other = ldsMax[ locId + offset ];
+            if( (*comp)( mine, other ) )
+                ldsMax[ locId ] = other;
+        }
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
+
+    if( locId == 0 )
+    {
+        vType minVal = ldsMin[ 0 ];
+        vType maxVal = ldsMax[ 0 ];
+        window[ 0 ] = searchLowerBound< iType >( input_iter, 0, numElements, minVal, comp );
+        window[ 1 ] = searchUpperBound< iType >( input_iter, window[ 0 ], numElements, maxVal, comp );
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    if( gloId >= numValues )
+        return;
+
+    uint low  = window[ 0 ];
+    uint high = window[ 1 ];
+    if( searchMode == 1 )
+    {
+        result_iter[ gloId ] = (oType)searchUpperBound< iType >( input_iter, low, high, value, comp );
+    }
+    else
+    {
+        uint index = searchLowerBound< iType >( input_iter, low, high, value, comp );
+        if( searchMode == 0 )
+        {
+            result_iter[ gloId ] = (oType)index;
+        }
+        else
+        {
+            int found = 0;
+            if( index < numElements )
+            {
+                iType indexVal = input_iter[ index ];
+                found = !(*comp)( value, indexVal );
+            }
+            result_iter[ gloId ] = (oType)found;
+        }
+    }
+};
@@ -38,6 +38,9 @@
 #include "bolt/BoltVersion.h"
 #include "bolt/cl/control.h"
 #include "bolt/cl/clcode.h"
+#if defined( ENABLE_TBB )
+#include "bolt/btbb/arena.h"
+#endif
 
 #define PUSH_BACK_UNIQUE(CONTAINER, ELEMENT) \
     if (std::find(CONTAINER.begin(), CONTAINER.end(), ELEMENT) == CONTAINER.end()) \
@@ -69,18 +72,24 @@ namespace bolt {
     namespace cl {
 
         extern const std::string binary_search_kernels;
+        extern const std::string compaction_kernels;
         extern const std::string copy_kernels;
         extern const std::string count_kernels;
         extern const std::string fill_kernels;
         extern const std::string gather_kernels;
         extern const std::string generate_kernels;
+        extern const std::string histogram_kernels;
+        extern const std::string inner_product_kernels;
         extern const std::string merge_kernels;
+        extern const std::string radix_sort_kernels;
         extern const std::string min_element_kernels;
         extern const std::string reduce_kernels;
         extern const std::string reduce_by_key_kernels;
         extern const std::string scan_kernels;
         extern const std::string scan_by_key_kernels;
+        extern const std::string scan_lookback_kernels;
         extern const std::string scatter_kernels;
+        extern const std::string segmented_sort_kernels;
         extern const std::string sort_kernels;
         extern const std::string stablesort_kernels;
         extern const std::string stablesort_by_key_kernels;
@@ -125,6 +134,7 @@ namespace bolt {
         };
 
         class control;
+        struct ProgramCacheSlot;
         //class KernelTemplateSpecializer;
 
         extern std::string fileToString(const std::string &fileName);
@@ -134,6 +144,8 @@ namespace bolt {
          * returns vector of cl::Kernel objects either by constructing
          * and compiling the kernels, or by returning the kernels if
          * previously compiled.
+         * slot is an optional per-call-site cache (a function-local static)
+         * that lets a warm call skip building the complete kernel string.
          * see bolt/cl/detail/scan.inl for example usage
          **********************************************************************/
         ::std::vector< ::cl::Kernel > getKernels(
@@ -142,7 +154,8 @@ namespace bolt {
             const KernelTemplateSpecializer * const kts,
             const ::std::vector< ::std::string >& typeDefinitions,
             const std::string&  baseKernelString,
-            const std::string&  compileOptions = ""
+            const std::string&  compileOptions = "",
+            ProgramCacheSlot*   slot = NULL
                  );
 
         /*! \brief Query the Bolt library for version information
@@ -193,19 +206,318 @@ namespace bolt {
         }
         #define V_OPENCL( status, message ) V_OpenCL( status, message, __LINE__ )
 
-        void wait( const bolt::cl::control &ctl, ::cl::Event &e );
+        /*! \brief Wait for e to complete, in the manner selected by ctl.getWaitMode( ).
+        *   \details Under control::BalancedWait the host first spins for a window learned from recent waits on
+        *   kernelName, then blocks on an event callback.  Calls without a name share one history.
+        */
+        void wait( const bolt::cl::control &ctl, ::cl::Event &e, const char* kernelName = NULL );
+
+        /*! \brief Wait at the end of a call whose results stay in device memory.
+        *   \details Behaves as wait( ), except under control::NoWait, where the queue is only flushed.  Later
+        *   commands on the same in-order queue are then ordered after the call by the device, not the host.
+        */
+        void deferredWait( const bolt::cl::control &ctl, ::cl::Event &e, const char* kernelName = NULL );
+
+        /*! \brief Time that BalancedWait waits spent spinning and blocked, summed over all threads.
+        */
+        struct waitStatistics
+        {
+            cl_ulong spinWaits;     // waits that completed within their spin window
+            cl_ulong blockWaits;    // waits that outlasted the spin window and blocked
+            double spinSeconds;     // time spent spinning, including the spin phase of blocked waits
+            double blockSeconds;    // time spent blocked
+        };
+
+        waitStatistics getWaitStatistics( );
+        void resetWaitStatistics( );
+
+        /*! \brief Alignment, in bytes, of host memory that OpenCL runtimes of unified-memory devices wrap with
+        *   CL_MEM_USE_HOST_PTR without copying it; see aligned_allocator.
+        */
+        static const size_t zeroCopyAlignment = 4096;
+
+        /*! \brief Host ranges the algorithms wrapped in CL_MEM_USE_HOST_PTR buffers, summed over all threads.
+        *   \details A wrap counts as an implicit copy when the device does not share memory with the host, or the
+        *   range does not start on a zeroCopyAlignment boundary; the runtime then stages the range through a copy
+        *   of its own and copies it back when the buffer is mapped.
+        */
+        struct hostPtrStatistics
+        {
+            cl_ulong zeroCopies;        // wraps of aligned ranges on unified-memory devices
+            cl_ulong implicitCopies;    // wraps the runtime is expected to copy
+            cl_ulong implicitCopyBytes; // bytes of the implicitly copied ranges
+        };
+
+        hostPtrStatistics getHostPtrStatistics( );
+        void resetHostPtrStatistics( );
+
+        /*! \brief Counts a wrap of [hostPtr, hostPtr + bytes) in a CL_MEM_USE_HOST_PTR buffer for the device of ctl,
+        *   and returns whether it is zero-copy.  Under control::debug::HostCopies an implicit copy is reported on
+        *   std::cout.
+        */
+        bool recordHostPtrWrap( const bolt::cl::control &ctl, const void* hostPtr, size_t bytes );
+
+        /*! \brief Number of work-groups to launch for a reduction whose work-items loop over the input.
+        *   \details Grows with length until every compute unit is occupied, so small inputs do not launch groups that
+        *   have nothing to reduce.  The result never exceeds the number of groups that length elements can fill,
+        *   so every group produces a partial result.
+        */
+        size_t reduceWorkGroups( const bolt::cl::control &ctl, size_t length, size_t wgSize );
+
+        /*! \brief Whether the scans may use the single-pass kernel with decoupled look-back.
+        *   \details That kernel has work-groups spin on status flags published by other work-groups, so it needs
+        *   global memory fences that order writes across work-groups and groups that start in launch order.  Devices
+        *   that do not promise both keep the three-kernel reduce-then-scan path.
+        */
+        bool singlePassScanSupported( const bolt::cl::control &ctl );
+
+        /*! \brief Number of key bits the generic radix sort consumes per pass on the device of \p ctl.
+        *   \details 8 bit digits halve the passes over the keys but need 256 entry histograms in local memory, so
+        *   they are used on GPUs with dedicated local memory; every other device sorts 4 bits per pass.
+        */
+        int radixSortBits( const bolt::cl::control &ctl );
+
+        /*! \brief Sizes, in bytes, below which control::Automatic keeps a call off a path whose fixed cost it
+        *   would not repay.
+        */
+        struct runModeThresholds
+        {
+            size_t multiCoreCpuBytes;   // below this the host runs a call serially rather than on TBB
+            size_t openclBytes;         // below this a call on host memory runs on the host rather than the device
+        };
+
+        /*! \brief The thresholds of control::Automatic for the device of \p ctl.
+        *   \details Thresholds set in \p ctl are returned as they are.  The others are calibrated on the first call
+        *   for each device: the host's serial rate over a cached array, the round trip to wake a sleeping thread
+        *   and the round trip of a small command on the queue of \p ctl.  A parallel call pays off once the
+        *   serial time exceeds the wake-up, and the device once even one core would take longer than the round
+        *   trip.
+        */
+        runModeThresholds getRunModeThresholds( const bolt::cl::control &ctl );
+
+        /*! \brief The longest call whose kernels index with 32-bit integers.
+        *   \details Kept below 2^31 so that a work-item that strides over the input by the global size cannot wrap
+        *   a 32-bit index.  The kernels of sort, sort_by_key, stable_sort, stable_sort_by_key, segmented_sort,
+        *   scan, transform_scan, scan_by_key, merge, binary_search, histogram and the compaction family (copy_if,
+        *   remove_if, unique, unique_by_key, partition, stable_partition) still do; see selectRunMode for what a
+        *   longer call to them does.
+        */
+        const size_t narrowIndexLimit = 0x7FFFFFFF;
+
+        /*! \brief The integer type the kernels of a call on \p length elements count and index with.
+        *   \details Kernels name it BOLT_INDEX_T.  It is uint, so that the common case pays no 64-bit arithmetic,
+        *   and ulong for calls longer than narrowIndexLimit.  compileOptions( ) selects it when the kernels are
+        *   built; the two variants are cached as separate programs.  Iterator payloads always carry 64-bit offsets,
+        *   so only the counts passed with setArg change size.
+        */
+        class kernelIndex
+        {
+        public:
+            explicit kernelIndex( size_t length ): m_wide( length > narrowIndexLimit )
+            {
+            }
+
+            bool wide( ) const
+            {
+                return m_wide;
+            }
+
+            std::string compileOptions( ) const
+            {
+                return m_wide ? " -DBOLT_INDEX_T=ulong" : " -DBOLT_INDEX_T=uint";
+            }
+
+            //  Sets argument arg of kernel to value, as a BOLT_INDEX_T
+            cl_int setArg( ::cl::Kernel& kernel, cl_uint arg, size_t value ) const
+            {
+                if( m_wide )
+                    return kernel.setArg( arg, static_cast< cl_ulong >( value ) );
+                return kernel.setArg( arg, static_cast< cl_uint >( value ) );
+            }
+
+        private:
+            bool m_wide;
+        };
+
+        /*! \brief The path a call on \p length elements of \p valueSize bytes takes.  Only control::Automatic is
+        *   resolved; other run modes of \p ctl are returned as they are.
+        *   \details \p deviceResident tells whether the data is in device memory, where the host paths would have
+        *   to map it; such calls stay on the OpenCL path when that is the default.  Below the thresholds of
+        *   getRunModeThresholds a call moves from the device to the host, and from TBB to a single core.
+        *   \p wideKernels tells whether the kernels of the algorithm index with kernelIndex.  A call longer than
+        *   narrowIndexLimit to an algorithm whose kernels do not runs on the host when the run mode is Automatic,
+        *   and throws ::cl::Error when OpenCL is forced, rather than overriding the forced mode.
+        */
+        inline control::e_RunMode selectRunMode( const bolt::cl::control &ctl, size_t length, size_t valueSize,
+                                                 bool deviceResident, bool wideKernels = false )
+        {
+            control::e_RunMode runMode = ctl.getForceRunMode( );
+            if( length > narrowIndexLimit && !wideKernels )
+            {
+                if( runMode == control::OpenCL )
+                    throw ::cl::Error( CL_INVALID_GLOBAL_WORK_SIZE,
+                        "The OpenCL kernels of this algorithm index with 32 bits and cannot reach every element" );
+                if( runMode == control::Automatic )
+                    runMode = ctl.getDefaultPathToRun( );
+                if( runMode != control::OpenCL )
+                    return runMode;
+#if defined( ENABLE_TBB )
+                return control::MultiCoreCpu;
+#else
+                return control::SerialCpu;
+#endif
+            }
+
+            if( runMode != control::Automatic )
+                return runMode;
+
+            runMode = ctl.getDefaultPathToRun( );
+            if( runMode == control::SerialCpu || ( runMode == control::OpenCL && deviceResident ) )
+                return runMode;
+
+            const runModeThresholds thresholds = getRunModeThresholds( ctl );
+            const size_t bytes = length * valueSize;
+            if( runMode == control::OpenCL )
+            {
+                if( bytes >= thresholds.openclBytes )
+                    return control::OpenCL;
+#if defined( ENABLE_TBB )
+                runMode = control::MultiCoreCpu;
+#else
+                return control::SerialCpu;
+#endif
+            }
+
+            return ( bytes < thresholds.multiCoreCpuBytes ) ? control::SerialCpu : runMode;
+        }
+
+        /*! \brief Runs the MultiCoreCpu paths the calling thread takes in the TBB arena of \p ctl, see
+        *   control::setTbbArena, until the scope ends.  Does nothing without ENABLE_TBB.
+        */
+        class tbbArenaScope
+        {
+        public:
+            explicit tbbArenaScope( const bolt::cl::control &ctl )
+#if defined( ENABLE_TBB )
+                : m_arena( ctl.getTbbArena( ) ), m_scope( m_arena.get( ) )
+#endif
+            {
+            }
+
+#if defined( ENABLE_TBB )
+        private:
+            tbbArenaScope( const tbbArenaScope& );
+            tbbArenaScope& operator=( const tbbArenaScope& );
+
+            boost::shared_ptr< bolt::btbb::arena > m_arena;
+            bolt::btbb::arenaScope m_scope;
+#endif
+        };
+
+        /*! \brief Number of the first elements of a call to \p algorithm that run on the host, while the device runs
+        *   the rest.  0 keeps the whole call on the device.
+        *   \details Only calls of at least a million elements are split, and only under control::HostSplit with
+        *   the run mode left to control::Automatic and a device other than the host CPU.  The host's share follows the throughput of both sides in earlier
+        *   split calls of \p algorithm, so that they finish together; while the host is too slow to help, only an
+        *   occasional call is split to measure it again.
+        */
+        size_t hostSplitLength( const bolt::cl::control &ctl, const char* algorithm, size_t length );
+
+        /*! \brief Reports how long the host and the device took for their parts of a split call of \p algorithm.
+        */
+        void recordHostSplit( const char* algorithm, size_t hostLength, double hostSeconds, size_t deviceLength,
+                              double deviceSeconds );
+
+        /*! \brief The fraction of the elements that the next split call of \p algorithm gives to the host.
+        */
+        double getHostSplitShare( const char* algorithm );
+        void resetHostSplitProfiles( );
+
+        /*! \brief Launch shape of one algorithm, as chosen by the autotuner.
+        */
+        struct tuningParams
+        {
+            size_t wgSize;              // work-items per work-group
+            size_t wgPerComputeUnit;    // most work-groups launched per compute unit
+            size_t itemsPerWorkItem;    // fewest elements each work-item reduces before its work-group does
+            int unroll;                 // elements each work-item reads per iteration of its loop
+        };
+
+        /*! \brief The parameters of a launch shape that sweepTuning varies.
+        */
+        enum tuningSpace { TuneWgSize = 0x1, TuneWgPerComputeUnit = 0x2, TuneItemsPerWorkItem = 0x4, TuneUnroll = 0x8 };
+
+        /*! \brief The launch shape tuned for \p algorithm on the device of \p ctl, for \p length elements of
+        *   \p typeName, or \p defaults if there is none.
+        *   \details Entries are keyed by device name and driver version, algorithm, value type and the power of two
+        *   at or below \p length; a length between tuned sizes takes the entry of the nearest one.  The tuning file
+        *   of \p ctl is read on the first lookup with it.  Without control::AutoTuneWorkShape in ctl.getAutoTune( )
+        *   \p defaults is returned.
+        */
+        tuningParams findTuning( const bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                                 size_t length, const tuningParams& defaults );
+
+        /*! \brief Makes \p params the launch shape of \p algorithm for the key of findTuning, and appends it to the
+        *   tuning file of \p ctl, where later entries override earlier ones.
+        */
+        void storeTuning( const bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                          size_t length, const tuningParams& params );
+
+        /*! \brief One call of the algorithm that sweepTuning times.  It must run on the device of the control it
+        *   is given, and must wait for its results.
+        */
+        class tuningRun
+        {
+        public:
+            virtual ~tuningRun( ) { }
+            virtual void operator( )( bolt::cl::control &ctl ) = 0;
+        };
+
+        /*! \brief Times \p run with candidate launch shapes and stores the fastest with storeTuning.
+        *   \details Starting from \p defaults, each parameter in \p space is swept in turn while the others keep
+        *   the best values found so far.  Work-group sizes the device cannot launch are skipped, as are shapes
+        *   whose launch fails.  A shape is run once to build its kernels, then \p repetitions times; its fastest
+        *   run is its time.
+        */
+        tuningParams sweepTuning( bolt::cl::control &ctl, const char* algorithm, const std::string& typeName,
+                                  size_t length, tuningRun& run, const tuningParams& defaults, unsigned space,
+                                  int repetitions = 5 );
+
+        /*! \brief Forgets all tuning entries, and which tuning files have been read.
+        */
+        void resetTuning( );
+
+        /*! \brief As reduceWorkGroups above, for the work-group size, work-groups per compute unit and elements per
+        *   work-item of \p shape.
+        */
+        size_t reduceWorkGroups( const bolt::cl::control &ctl, size_t length, const tuningParams& shape );
+
+        /*! \brief findTuning for the reductions, whose kernels hold the tree steps for work-groups of 64, 128 or 256
+        *   work-items; a tuned work-group size outside those keeps the one of \p defaults.
+        */
+        tuningParams findReduceTuning( const bolt::cl::control &ctl, const char* algorithm,
+                                       const std::string& typeName, size_t length, const tuningParams& defaults );
 
         /******************************************************************
          * Program Map - so each kernel is only compiled once
          *****************************************************************/
+        /*! \brief 128-bit digest of a program's compile options and complete kernel source.
+        *   \details Keys the program cache so that a warm lookup compares two integers instead of the full
+        *   kernel string.  Two independent 64-bit lanes make an accidental collision practically impossible.
+        */
+        struct ProgramDigest
+        {
+            cl_ulong lo;
+            cl_ulong hi;
+        };
+
         /*! \brief This structure ensures that a kernel is compiled only once for specified devices.
         */
         struct ProgramMapKey
         {
-            ::cl::Context context;
-            ::std::string device;
-            ::std::string compileOptions;
-            ::std::string kernelSource;
+            cl_context context;
+            cl_device_id device;
+            ProgramDigest digest;
         };
 
         struct ProgramMapValue
@@ -217,65 +529,46 @@ namespace bolt {
         {
             bool operator( )( const ProgramMapKey& lhs, const ProgramMapKey& rhs ) const
             {
-                int comparison;
-                // context
                 // Do I really need to compare the context? Yes, required by OpenCL. -DT
-                if( lhs.context() < rhs.context() )
-                    return true;
-                else if( lhs.context() > rhs.context() )
-                    return false;
-                // else equal; compare using next element of key
-
-                // device
-                comparison = lhs.device.compare(rhs.device);
-                //std::cout << "Compare Device: " << comparison << std::endl;
-                if( comparison < 0 )
-                {
-                    return true;
-                }
-                else if( comparison > 0 )
-                {
-                    return false;
-                }
-                // else equal; compare using next element of key
-
-                // compileOptions
-                comparison = lhs.compileOptions.compare(rhs.compileOptions);
-                //std::cout << "Compare Options: " << comparison << std::endl;
-                if( comparison < 0 )
-                {
-                    return true;
-                }
-                else if( comparison > 0 )
-                {
-                    return false;
-                }
-                //else
-                //    std::cout << "<" << lhs.compileOptions << "> == <" << rhs.compileOptions << ">" << std::endl;
-                // else equal; compare using next element of key
-
-                // kernelSource
-                comparison = lhs.kernelSource.compare(rhs.kernelSource);
-                //std::cout << "Compare Source: " << comparison << std::endl;
-                if( comparison < 0 )
-                    return true;
-                else if( comparison > 0 )
-                    return false;
-                //else
-                //    std::cout << "<lhs.kernelSource> == <rhs.kernelSource>" << std::endl;
-                // else equal; compare using next element of key
-
-                // all elements equal
-                return false;
+                if( lhs.context != rhs.context )
+                    return lhs.context < rhs.context;
+                if( lhs.device != rhs.device )
+                    return lhs.device < rhs.device;
+                if( lhs.digest.lo != rhs.digest.lo )
+                    return lhs.digest.lo < rhs.digest.lo;
+                return lhs.digest.hi < rhs.digest.hi;
             }
         };
 
         typedef ::std::map< ProgramMapKey, ProgramMapValue, ProgramMapKeyComp > ProgramMap;
-        //typedef ::std::map< ::std::string, ProgramMapValue> ProgramMap;
 
-        // declared in bolt.cpp
-        extern boost::mutex programMapMutex;
-        extern ProgramMap programMap;
+        /*! \brief Per-call-site cache of compiled programs, consulted by getKernels before the global ProgramMap.
+        *   \details Declared as a function-local static next to each getKernels call, so it is zero-initialized
+        *   before any thread can reach it and needs no constructor.  A hit skips assembling the complete kernel
+        *   string entirely; entries are keyed by context, device and a digest of the type names, type definitions
+        *   and compile options of the call.  Access is serialized inside bolt.cpp.
+        */
+        struct ProgramCacheSlot
+        {
+            enum { capacity = 4 };
+
+            struct Entry
+            {
+                cl_context context;
+                cl_device_id device;
+                ProgramDigest digest;
+                cl_uint generation;
+                cl_program program;     // retained while the entry is live
+            };
+
+            Entry entries[ capacity ];
+            cl_uint next;
+        };
+
+        /*! \brief Drops every program held by the in-memory program caches, forcing the next call of each
+        *   algorithm to fetch its program again from the on-disk cache or the compiler.
+        */
+        void clearProgramCache( );
 
     };
 };
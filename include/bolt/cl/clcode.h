@@ -306,4 +306,11 @@ __attribute__((weak))  std::vector< std::string > ClCode< Type >::dependencies;
  */
 #define BOLT_ADD_DEPENDENCY( Type, DependingType ) ClCode<Type>::addDependency(ClCode<DependingType>::get());
 
+/*!
+ * Separates the parts of a composite ClCode string, such as the one of an iterator adaptor that carries the
+ * definitions of the iterators and functors it is built from.  When the kernel source is assembled every distinct
+ * part is emitted once, so a definition that an algorithm also pushes on its own is not defined twice.
+ */
+#define BOLT_CLCODE_PART_DELIMITER "\n// bolt::cl::clcode part\n"
+
 #endif
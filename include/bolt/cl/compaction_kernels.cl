@@ -0,0 +1,175 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Stream compaction shared by copy_if, remove_if, unique, unique_by_key, partition and
+ *  stable_partition.  Every work-group owns a tile of COMPACTION_WG_SIZE * COMPACTION_VT
+ *  elements, each work item COMPACTION_VT consecutive ones:
+ *      compactionCount   - evaluates the flags and writes the number kept per tile
+ *      compactionScan    - one work-group turns the tile counts into tile offsets and
+ *                          appends the total kept
+ *      compactionScatter - evaluates the flags again, scans them within the tile and writes
+ *                          the kept elements ( and their values ) in order; with writeRejected
+ *                          the others follow the kept ones, also in order
+ *  The flags are recomputed rather than stored, so no temporary of the input size is needed.
+ *  COMPACTION_FLAG_MODE is set by the host: 0 keeps pred( x ), 1 keeps !pred( x ) and 2 keeps
+ *  the first element of every run of neighbours for which the binary pred holds.  The host also
+ *  sets COMPACTION_WG_SIZE and COMPACTION_VT, from the values it launches the kernels with.
+ *****************************************************************************/
+
+#ifndef COMPACTION_FLAG_MODE
+#define COMPACTION_FLAG_MODE    0
+#endif
+#define COMPACTION_TILE         ( COMPACTION_WG_SIZE * COMPACTION_VT )
+
+template< typename iIterType, typename Predicate >
+inline uint compactionFlag( iIterType input_iter, uint i, global Predicate* pred )
+{
+#if COMPACTION_FLAG_MODE == 2
+    return ( i == 0 || !(*pred)( input_iter[ i - 1 ], input_iter[ i ] ) ) ? 1 : 0;
+#elif COMPACTION_FLAG_MODE == 1
+    return (*pred)( input_iter[ i ] ) ? 0 : 1;
+#else
+    return (*pred)( input_iter[ i ] ) ? 1 : 0;
+#endif
+}
+
+/*  Work-group wide exclusive scan of one uint per work item; the group total is returned
+ *  through total.  lds needs COMPACTION_WG_SIZE entries.  */
+inline uint compactionLocalScan( uint val, local uint* lds, uint* total )
+{
+    int lid = get_local_id( 0 );
+    lds[ lid ] = val;
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( int offset = 1; offset < COMPACTION_WG_SIZE; offset <<= 1 )
+    {
+        uint t = ( lid >= offset ) ? lds[ lid - offset ] : 0;
+        barrier( CLK_LOCAL_MEM_FENCE );
+        lds[ lid ] += t;
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
+
+    *total = lds[ COMPACTION_WG_SIZE - 1 ];
+    uint result = lds[ lid ] - val;
+    barrier( CLK_LOCAL_MEM_FENCE );
+    return result;
+}
+
+template< typename iType, typename iIterType, typename Predicate >
+kernel void compactionCount( global iType* input_ptr,
+                             iIterType input_iter,
+                             const uint numElements,
+                             global Predicate* pred,
+                             global uint* tileCounts )
+{
+    local uint lds[ COMPACTION_WG_SIZE ];
+
+    input_iter.init( input_ptr );
+
+    uint first = get_group_id( 0 ) * COMPACTION_TILE + get_local_id( 0 ) * COMPACTION_VT;
+    uint last = min( first + COMPACTION_VT, numElements );
+    uint count = 0;
+    for( uint i = first; i < last; ++i )
+        count += compactionFlag( input_iter, i, pred );
+
+    uint total;
+    compactionLocalScan( count, lds, &total );
+    if( get_local_id( 0 ) == 0 )
+        tileCounts[ get_group_id( 0 ) ] = total;
+}
+
+/*  Launched as a single work-group.  Replaces the numTiles counts by their exclusive scan and
+ *  writes the total to tileCounts[ numTiles ].  */
+kernel __attribute__((reqd_work_group_size(COMPACTION_WG_SIZE,1,1)))
+void compactionScanInstantiated( global uint* tileCounts, const uint numTiles )
+{
+    local uint lds[ COMPACTION_WG_SIZE ];
+
+    uint lid = get_local_id( 0 );
+    uint seed = 0;
+
+    for( uint base = 0; base < numTiles; base += COMPACTION_WG_SIZE )
+    {
+        uint i = base + lid;
+        uint val = ( i < numTiles ) ? tileCounts[ i ] : 0;
+        uint total;
+        uint res = compactionLocalScan( val, lds, &total );
+        if( i < numTiles )
+            tileCounts[ i ] = res + seed;
+        seed += total;
+    }
+
+    if( lid == 0 )
+        tileCounts[ numTiles ] = seed;
+}
+
+template< typename iType, typename iIterType, typename vType, typename vIterType,
+          typename oType, typename oIterType, typename ovType, typename ovIterType, typename Predicate >
+kernel void compactionScatter( global iType* input_ptr,
+                               iIterType input_iter,
+                               global vType* values_ptr,
+                               vIterType values_iter,
+                               const uint numElements,
+                               global Predicate* pred,
+                               global const uint* tileOffsets,
+                               global oType* result_ptr,
+                               oIterType result_iter,
+                               global ovType* values_result_ptr,
+                               ovIterType values_result_iter,
+                               const int hasValues,
+                               const int writeRejected )
+{
+    local uint lds[ COMPACTION_WG_SIZE ];
+
+    input_iter.init( input_ptr );
+    values_iter.init( values_ptr );
+    result_iter.init( result_ptr );
+    values_result_iter.init( values_result_ptr );
+
+    uint first = get_group_id( 0 ) * COMPACTION_TILE + get_local_id( 0 ) * COMPACTION_VT;
+    uint last = min( first + COMPACTION_VT, numElements );
+
+    //  One bit per element of this work item; COMPACTION_VT never exceeds 32
+    uint flags = 0;
+    uint count = 0;
+    for( uint i = first; i < last; ++i )
+    {
+        uint f = compactionFlag( input_iter, i, pred );
+        flags |= f << ( i - first );
+        count += f;
+    }
+
+    uint total;
+    uint kept = compactionLocalScan( count, lds, &total ) + tileOffsets[ get_group_id( 0 ) ];
+    uint numKept = tileOffsets[ get_num_groups( 0 ) ];
+
+    for( uint i = first; i < last; ++i )
+    {
+        uint dst;
+        if( ( flags >> ( i - first ) ) & 1 )
+            dst = kept++;
+        else if( writeRejected )
+            dst = numKept + i - kept;   // kept elements before i are kept, so i - kept rejected ones are
+        else
+            continue;
+
+        result_iter[ dst ] = input_iter[ i ];
+        if( hasValues )
+            values_result_iter[ dst ] = values_iter[ i ];
+    }
+}
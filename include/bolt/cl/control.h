@@ -28,6 +28,7 @@
 #include <bolt/cl/bolt.h>
 #include <string>
 #include <map>
+#include <cstdlib>
 
 #include <boost/thread/mutex.hpp>
 #include <boost/shared_ptr.hpp>
@@ -37,6 +38,10 @@
 
 
 namespace bolt {
+    namespace btbb {
+        class arena;
+    };
+
     namespace cl {
 
         /*! \addtogroup miscellaneous
@@ -101,6 +106,7 @@ namespace bolt {
         class control {
         public:
             enum e_UseHostMode {NoUseHost, UseHost};
+            enum e_HostSplitMode {NoHostSplit, HostSplit};
             enum e_RunMode     {Automatic,
                                 SerialCpu,
                                 MultiCoreCpu,
@@ -109,7 +115,7 @@ namespace bolt {
             enum e_AutoTuneMode{NoAutoTune=0x0,
                                 AutoTuneDevice=0x1,
                                 AutoTuneWorkShape=0x2,
-                                AutoTuneAll=0x3}; // FIXME, experimental
+                                AutoTuneAll=0x3}; // AutoTuneWorkShape: launch shapes come from the tuning database, see bolt::cl::findTuning
             struct debug {
                 static const unsigned None=0;
                 static const unsigned Compile = 0x1;
@@ -117,12 +123,14 @@ namespace bolt {
                 static const unsigned SaveCompilerTemps = 0x4;
                 static const unsigned DebugKernelRun = 0x8;
                 static const unsigned AutoTune = 0x10;
+                static const unsigned HostCopies = 0x20;
             };
 
-            enum e_WaitMode {BalancedWait,	// Balance of Busy and Nice: tries to use Busy for short-running kernels.  \todo: Balanced currently maps to nice.
+            enum e_WaitMode {BalancedWait,	// Balance of Busy and Nice: spins for a window learned from recent waits on the same kernel, then blocks.  See bolt::cl::getWaitStatistics.
                              NiceWait,		// Use an OS semaphore to detect completion status.
                              BusyWait,		// Busy a CPU core continuously monitoring results.  Lowest-latency, but requires a dedicated core.
                              ClFinish,      // Call clFinish on the queue.
+                             NoWait,        // Only flush the queue at the end of a call; completion is observed through a later blocking command on the same in-order queue or a bolt::cl::async future.
             };
 
         public:
@@ -135,6 +143,7 @@ namespace bolt {
                 ) :
             m_commandQueue(commandQueue),
                 m_useHost(useHost),
+                m_hostSplit(getDefault().m_hostSplit),
                 m_forceRunMode(OpenCL),   //Replaced this with automatic because the default is not MultiCoreCPU if no GPU is found
                 m_defaultRunMode(OpenCL),
                 m_debug(debug),
@@ -143,13 +152,24 @@ namespace bolt {
                 m_compileOptions(getDefault().m_compileOptions),
                 m_compileForAllDevices(getDefault().m_compileForAllDevices),
                 m_waitMode(getDefault().m_waitMode),
-                m_unroll(getDefault().m_unroll)
+                m_unroll(getDefault().m_unroll),
+                m_kernelCacheDir(getDefault().m_kernelCacheDir),
+                m_tuningFile(getDefault().m_tuningFile),
+                m_multiCoreCpuThreshold(getDefault().m_multiCoreCpuThreshold),
+                m_openclThreshold(getDefault().m_openclThreshold),
+                m_tbbArena(getDefault().m_tbbArena),
+                m_bufferPoolHighWater(getDefault().m_bufferPoolHighWater),
+                m_bufferClock(0),
+                m_bufferHits(0),
+                m_bufferMisses(0),
+                m_bufferBytesResident(0)
             {};
 
 
             control( const control& ref) :
                 m_commandQueue(ref.m_commandQueue),
                 m_useHost(ref.m_useHost),
+                m_hostSplit(ref.m_hostSplit),
                 m_forceRunMode(ref.m_forceRunMode),
                 m_defaultRunMode(ref.m_defaultRunMode),
                 m_debug(ref.m_debug),
@@ -158,7 +178,17 @@ namespace bolt {
                 m_compileOptions(ref.m_compileOptions),
                 m_compileForAllDevices(ref.m_compileForAllDevices),
                 m_waitMode(ref.m_waitMode),
-                m_unroll(ref.m_unroll)
+                m_unroll(ref.m_unroll),
+                m_kernelCacheDir(ref.m_kernelCacheDir),
+                m_tuningFile(ref.m_tuningFile),
+                m_multiCoreCpuThreshold(ref.m_multiCoreCpuThreshold),
+                m_openclThreshold(ref.m_openclThreshold),
+                m_tbbArena(ref.m_tbbArena),
+                m_bufferPoolHighWater(ref.m_bufferPoolHighWater),
+                m_bufferClock(0),
+                m_bufferHits(0),
+                m_bufferMisses(0),
+                m_bufferBytesResident(0)
             {
                 //printf("control::copy construcor\n");
             };
@@ -175,6 +205,11 @@ namespace bolt {
             //! on a discrete GPU, where the input data is located on the device memory.
             void setUseHost(e_UseHostMode useHost) { m_useHost = useHost; };
 
+            //! With HostSplit, TBB enabled and the run mode left to Automatic, transform, reduce, transform_reduce,
+            //! count and sort split large host memory inputs that would run on the device between TBB and the
+            //! device; see bolt::cl::hostSplitLength.  A forced run mode is never split.  Default is NoHostSplit.
+            void setHostSplit(e_HostSplitMode hostSplit) { m_hostSplit = hostSplit; };
+
 
             //! Force the Bolt command to run on the specifed device.  Default is "Automatic," in which case the Bolt
             //! runtime selects the device.  Forcing the mode to SerialCpu can be useful for debugging the algorithm.
@@ -182,6 +217,9 @@ namespace bolt {
             //! control over the run location (perhaps due to knowledge that the algorithm is best-suited for GPU).
             //! Please note that forcing the run modes will not change the OpenCL device in the control object. This
             //! API is designed to simplify the process of choosing the appropriate path in the Bolt API.
+            //! Forced OpenCL calls longer than bolt::cl::narrowIndexLimit to the algorithms listed there throw
+            //! ::cl::Error instead of running elsewhere, as do forced OpenCL calls on iterator adaptors over more device
+            //! buffers than the kernels of the algorithm bind; see bolt::cl::detail::iteratorRunMode.
             void setForceRunMode(e_RunMode forceRunMode) { m_forceRunMode = forceRunMode; };
 
             /*! Enable debug messages to be printed to stdout as the algorithm is compiled, run, and tuned.  See the #debug
@@ -212,12 +250,52 @@ namespace bolt {
             //! Specify the compile options passed to the OpenCL(TM) compiler.
             void setCompileOptions(std::string &compileOptions) { m_compileOptions = compileOptions; };
 
+            /*! Set the directory used to persist compiled OpenCL program binaries between runs.  Programs are
+                looked up by a hash of the kernel source, compile options, device and driver version; an empty
+                string disables the on-disk cache.  The default is taken from the BOLT_KERNEL_CACHE_DIR
+                environment variable. */
+            void setKernelCacheDir(const std::string &kernelCacheDir) { m_kernelCacheDir = kernelCacheDir; };
+
+            /*! Select what the algorithms take from the tuning database.  With AutoTuneWorkShape set, the algorithms
+                below launch with the shape tuned for the device, algorithm, value type and input size, where an
+                entry exists.  See bolt::cl::findTuning.
+                - reduce: work-group size, work-groups per compute unit, elements per work-item and unroll.
+                - transform_reduce, inner_product, count, min_element and max_element: the same, without unroll.
+                - transform: work-group size.
+                The scans, sorts, reduce_by_key and the other algorithms keep their built-in launch shapes. */
+            void setAutoTune(e_AutoTuneMode autoTune) { m_autoTune = autoTune; };
+
+            /*! Set the file that keeps the tuning database between runs.  It is read on the first lookup made
+                with this path, and bolt::cl::storeTuning appends new winners to it; an empty string keeps tuning
+                results in memory only.  The default is taken from the BOLT_TUNING_FILE environment variable. */
+            void setTuningFile(const std::string &tuningFile) { m_tuningFile = tuningFile; };
+
+            /*! Under Automatic, calls on fewer bytes than this run serially instead of on the multi-core CPU path.
+                Zero uses the threshold calibrated for the machine; see bolt::cl::getRunModeThresholds. */
+            void setMultiCoreCpuThreshold(size_t bytes) { m_multiCoreCpuThreshold = bytes; };
+
+            /*! Under Automatic, calls on fewer bytes than this of host memory run on the host instead of the OpenCL
+                device; data already in a device_vector stays on the device.  Zero uses the threshold calibrated for
+                the device; see bolt::cl::getRunModeThresholds. */
+            void setOpenCLThreshold(size_t bytes) { m_openclThreshold = bytes; };
+
+            /*! Set the TBB arena the MultiCoreCpu path runs in, see bolt::btbb::arena.  The arena is shared by the
+                copies of this control and lives as long as any of them.  An empty pointer runs in the arena of the
+                enclosing call, or in bolt::btbb::defaultArena, which uses every core. */
+            void setTbbArena(const boost::shared_ptr< bolt::btbb::arena > &arena) { m_tbbArena = arena; };
+
+            /*! Set the high-water mark, in bytes, of the scratch buffer pool used by acquireBuffer.  When the pool
+                holds more device memory than this, idle buffers are released in least-recently-used order; buffers
+                in use are never released.  Zero disables trimming. */
+            void setBufferPoolHighWater(size_t highWater) { m_bufferPoolHighWater = highWater; };
+
             // getters:
             ::cl::CommandQueue&         getCommandQueue( ) { return m_commandQueue; };
             const ::cl::CommandQueue&   getCommandQueue( ) const { return m_commandQueue; };
             ::cl::Context               getContext() const { return m_commandQueue.getInfo<CL_QUEUE_CONTEXT>();};
             ::cl::Device                getDevice() const { return m_commandQueue.getInfo<CL_QUEUE_DEVICE>();};
             e_UseHostMode               getUseHost() const { return m_useHost; };
+            e_HostSplitMode             getHostSplit() const { return m_hostSplit; };
             e_RunMode                   getForceRunMode() const { return m_forceRunMode; };
             e_RunMode                   getDefaultPathToRun() const { return m_defaultRunMode; };
             unsigned                    getDebugMode() const { return m_debug;};
@@ -226,6 +304,13 @@ namespace bolt {
             e_WaitMode                  getWaitMode() const { return m_waitMode; };
             int                         getUnroll() const { return m_unroll; };
             bool                        getCompileForAllDevices() const { return m_compileForAllDevices; };
+            const ::std::string         getKernelCacheDir() const { return m_kernelCacheDir; };
+            e_AutoTuneMode              getAutoTune() const { return m_autoTune; };
+            const ::std::string         getTuningFile() const { return m_tuningFile; };
+            size_t                      getMultiCoreCpuThreshold() const { return m_multiCoreCpuThreshold; };
+            size_t                      getOpenCLThreshold() const { return m_openclThreshold; };
+            boost::shared_ptr< bolt::btbb::arena > getTbbArena() const { return m_tbbArena; };
+            size_t                      getBufferPoolHighWater() const { return m_bufferPoolHighWater; };
 
             /*!
               * Return default default \p control structure.  This is used for Bolt API calls when the user
@@ -265,12 +350,25 @@ namespace bolt {
              */
             typedef boost::shared_ptr< ::cl::Buffer > buffPointer;
 
+            /*! \brief Counters describing the buffer pool, returned by getBufferPoolStats
+             */
+            struct bufferPoolStats
+            {
+                size_t hits;            // requests served by an idle pooled buffer
+                size_t misses;          // requests that had to create a buffer, or a slab of sub-buffers
+                size_t bytesResident;   // device memory held by the pool, in use or idle
+                size_t bytesWasted;     // size class rounding of the buffers currently in use
+            };
+
             /*! Return device memory size */
             size_t totalBufferSize( );
-            /*! Return a pointer to memory from per allocated memory pool */
+            /*! Return a pointer to memory from per allocated memory pool.  Requests without a host pointer are
+                rounded up to a power-of-two size class; small classes are sub-allocated from a shared slab. */
             buffPointer acquireBuffer( size_t reqSize, cl_mem_flags flags = CL_MEM_READ_WRITE, const void* host_ptr = NULL );
             /*! Freeing memory*/
             void freeBuffers( );
+            /*! Return the hit/miss counters and memory footprint of the buffer pool */
+            bufferPoolStats getBufferPoolStats( );
 
         private:
 
@@ -278,13 +376,33 @@ namespace bolt {
             control(bool createGlobal) :
                 m_commandQueue( getDefaultCommandQueue( ) ),
                 m_useHost(UseHost),
+                m_hostSplit(NoHostSplit),
                 m_debug(debug::None),
                 m_autoTune(AutoTuneAll),
                 m_wgPerComputeUnit(8),
                 m_compileForAllDevices(true),
-                m_waitMode(BusyWait),
-                m_unroll(1)
+                m_waitMode(BalancedWait),
+                m_unroll(1),
+                m_multiCoreCpuThreshold(0),
+                m_openclThreshold(0),
+                m_bufferPoolHighWater(256 * 1024 * 1024),
+                m_bufferClock(0),
+                m_bufferHits(0),
+                m_bufferMisses(0),
+                m_bufferBytesResident(0)
             {
+                const char* cacheDir = getenv( "BOLT_KERNEL_CACHE_DIR" );
+                if( cacheDir != NULL )
+                {
+                    m_kernelCacheDir = cacheDir;
+                }
+
+                const char* tuningFile = getenv( "BOLT_TUNING_FILE" );
+                if( tuningFile != NULL )
+                {
+                    m_tuningFile = tuningFile;
+                }
+
                 ::cl_device_type dType = CL_DEVICE_TYPE_CPU;
                 if(m_commandQueue() != NULL)
                 {
@@ -313,6 +431,7 @@ namespace bolt {
 
             ::cl::CommandQueue  m_commandQueue;
             e_UseHostMode       m_useHost;
+            e_HostSplitMode     m_hostSplit;
             e_RunMode           m_forceRunMode;
             e_RunMode           m_defaultRunMode;
             e_AutoTuneMode      m_autoTune;  /* auto-tune the choice of device CPU/GPU and  workgroup shape */
@@ -322,19 +441,28 @@ namespace bolt {
             bool                m_compileForAllDevices;  // compile for all devices in the context.  False means to only compile for specified device.
             e_WaitMode          m_waitMode;
             int                 m_unroll;
+            ::std::string       m_kernelCacheDir;  // directory of the persistent program binary cache; empty disables it.
+            ::std::string       m_tuningFile;  // file of the persistent tuning database; empty keeps it in memory.
+            size_t              m_multiCoreCpuThreshold;  // bytes below which Automatic runs serially; 0 is calibrated.
+            size_t              m_openclThreshold;  // bytes of host memory below which Automatic stays on the host; 0 is calibrated.
+            boost::shared_ptr< bolt::btbb::arena > m_tbbArena;  // arena of the MultiCoreCpu path; empty is the default arena.
+            size_t              m_bufferPoolHighWater;  // bytes the buffer pool may hold before idle buffers are released.
 
             struct descBufferKey
             {
                 ::cl::Context buffContext;
                 cl_mem_flags memFlags;
                 const void* host_ptr;
+                size_t buffSize;        // size class; the exact size for buffers that wrap host memory
             };
 
             struct descBufferValue
             {
-                size_t buffSize;
+                size_t reqSize;         // size requested by the current user
                 bool inUse;
                 ::cl::Buffer buffBuff;
+                ::cl::Buffer buffParent;    // slab this buffer is a sub-buffer of; NULL for a standalone buffer
+                size_t lastUse;         // buffer pool clock when last released, for LRU trimming
             };
 
             struct descBufferComp
@@ -357,6 +485,10 @@ namespace bolt {
                             {
                                 return true;
                             }
+                            else if( lhs.host_ptr == rhs.host_ptr )
+                            {
+                                return lhs.buffSize < rhs.buffSize;
+                            }
                             else
                             {
                                 return false;
@@ -400,12 +532,24 @@ namespace bolt {
                     //  inUse flag
                     boost::lock_guard< boost::mutex > lock( m_control.mapGuard );
                     m_iter->second.inUse = false;
+                    m_iter->second.lastUse = ++m_control.m_bufferClock;
+                    if( m_control.m_bufferPoolHighWater != 0 )
+                        m_control.trimBuffers( m_control.m_bufferPoolHighWater );
                 }
             };
 
+            //  Helpers for acquireBuffer; all expect mapGuard to be held
+            mapBufferType::iterator createBuffers( const descBufferKey& desc );
+            buffPointer lendBuffer( mapBufferType::iterator it, size_t reqSize );
+            void trimBuffers( size_t targetSize );
+
             friend class UnlockBuffer;
             mapBufferType mapBuffer;
             boost::mutex mapGuard;
+            size_t m_bufferClock;
+            size_t m_bufferHits;
+            size_t m_bufferMisses;
+            size_t m_bufferBytesResident;
 
         }; // end class control
 
@@ -0,0 +1,117 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_COPY_IF_H )
+#define BOLT_CL_COPY_IF_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+
+#include <string>
+
+/*! \file bolt/cl/copy_if.h
+    \brief Copies the elements of a range that satisfy a predicate.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup copying
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-copy_if
+        *   \ingroup copying
+        *   \{
+        */
+
+       /*! \brief \p copy_if copies every element of [first, last) for which \p pred is \p true to the range
+         * beginning at \p result, keeping their relative order.
+         *
+         * \details Predicate evaluation, the prefix sum of the kept counts and the scatter of the kept elements
+         * run as one compaction: the input is read twice and no temporary of the input size is allocated.
+         * The output range must not overlap the input range.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the input sequence.
+         * \param last The end of the input sequence.
+         * \param result The beginning of the output sequence.
+         * \param pred A predicate deciding which elements are copied.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam InputIterator is a model of InputIterator
+         *  \tparam OutputIterator is a model of OutputIterator
+         *  \tparam Predicate is a model of Predicate
+         *  \return The end of the output sequence.
+         *
+         *  \details The following code snippet demonstrates how to use \p copy_if
+         *
+         *  \code
+         *  #include <bolt/cl/copy_if.h>
+         *
+         *  BOLT_FUNCTOR( is_odd,
+         *    struct is_odd{
+         *        bool operator () (int x) const
+         *        {
+         *            return ( x & 1 ) == 1;
+         *        }
+         *    };
+         *  );
+         *
+         *  ...
+         *
+         *  int input[8] = {5, 7, 2, 3, 12, 6, 9, 8};
+         *  int output[8];
+         *  int* end = bolt::cl::copy_if( input, input + 8, output, is_odd( ) );
+         *
+         *  // output now starts with {5, 7, 3, 9} and end == output + 4
+         *  \endcode
+         *
+         *  \sa http://www.sgi.com/tech/stl/copy_if.html
+         */
+
+        template< typename InputIterator,
+                  typename OutputIterator,
+                  typename Predicate >
+        OutputIterator copy_if( bolt::cl::control &ctl,
+                                InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                Predicate pred,
+                                const std::string& cl_code="" );
+
+        template< typename InputIterator,
+                  typename OutputIterator,
+                  typename Predicate >
+        OutputIterator copy_if( InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                Predicate pred,
+                                const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/copy_if.inl>
+#endif
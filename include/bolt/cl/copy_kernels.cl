@@ -23,12 +23,12 @@ void copy_I(
 	iIterType input_iter,
     global oType * restrict dst,
 	oIterType output_iter,
-    const uint numElements) 
+    const BOLT_INDEX_T numElements) 
 {
     input_iter.init( src );
     output_iter.init( dst );
 
-    size_t gloIdx = get_global_id( 0 );
+    BOLT_INDEX_T gloIdx = get_global_id( 0 );
     if( gloIdx >= numElements) return; // on SI this doesn't mess-up barriers
 
 	output_iter[ gloIdx ] = input_iter[ gloIdx ];
@@ -43,9 +43,9 @@ __kernel
 void copy_II(
     global iType * restrict src,
     global oType * restrict dst,
-    const uint numElements )
+    const BOLT_INDEX_T numElements )
 {
-    int offset = get_global_id(0)*BURST_SIZE;
+    BOLT_INDEX_T offset = get_global_id(0)*BURST_SIZE;
     __global iType *threadSrc = &src[ offset ];
     __global oType *threadDst = &dst[ offset ];
     iType tmp[BURST_SIZE];
@@ -75,10 +75,10 @@ __kernel
 void copy_III(
     global iType * restrict src,
     global oType * restrict dst,
-      const uint numElements )
+      const BOLT_INDEX_T numElements )
 {
     for (
-        unsigned int i = get_global_id(0);
+        BOLT_INDEX_T i = get_global_id(0);
         i < numElements;
         i += get_global_size( 0 ) )
     {
@@ -98,16 +98,16 @@ __kernel
 void copy_IV(
     global iType * restrict src,
     global oType * restrict dst,
-    const uint numElements )
+    const BOLT_INDEX_T numElements )
 {
-    const int numMyElements = numElements / get_global_size(0);
-    const int start = numMyElements * get_global_id(0);
-    const int stop = (numElements < start+numMyElements) ? numElements : start+numMyElements;
+    const BOLT_INDEX_T numMyElements = numElements / get_global_size(0);
+    const BOLT_INDEX_T start = numMyElements * get_global_id(0);
+    const BOLT_INDEX_T stop = (numElements < start+numMyElements) ? numElements : start+numMyElements;
 
     __private iType tmp[BURST_SIZE];
 
     for (
-        int i = start;
+        BOLT_INDEX_T i = start;
         i < stop;
         i += BURST_SIZE )
     {
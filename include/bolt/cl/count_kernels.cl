@@ -17,6 +17,11 @@
 
 //#pragma OPENCL EXTENSION cl_amd_printf : enable
 
+//  REDUCE_WG_SIZE, the work-items of a work-group, is 64, 128 or 256 as set by the host from the tuning database
+#ifndef REDUCE_WG_SIZE
+#define REDUCE_WG_SIZE 256
+#endif
+
 #define _REDUCE_STEP(_LENGTH, _IDX, _W) \
     if ((_IDX < _W) && ((_IDX + _W) < _LENGTH)) {\
       scratch_count[_IDX] =  scratch_count[_IDX] + scratch_count[_IDX + _W];\
@@ -27,20 +32,19 @@ template< typename iTypePtr, typename iTypeIter, typename predicate_function >
 kernel void count_Template(
     global iTypePtr*    input_ptr, 
     iTypeIter input_iter,
-    const int length,
+    const BOLT_INDEX_T length,
     global predicate_function* userFunctor,
-    global int*    result,
-    local int*     scratch_count
+    global BOLT_INDEX_T*    result,
+    local BOLT_INDEX_T*     scratch_count,
+    BOLT_LEAF_PARAMS
 )
 {
-    int gx = get_global_id (0);
+    BOLT_INDEX_T gx = get_global_id (0);
     bool stat;
-    int count=0;
-    //  Abort threads that are passed the end of the input vector
-    if( gx >= length )
-        return;
+    BOLT_INDEX_T count=0;
 
-    input_iter.init( input_ptr );
+    //  Work-items past the end of the input count nothing, but stay in the kernel for the barriers below
+    BOLT_INIT_LEAVES( input_iter, input_ptr );
 
     //  Initialize the accumulator private variable with data from the input array
     //  This essentially unrolls the loop below at least once
@@ -62,12 +66,16 @@ kernel void count_Template(
     barrier(CLK_LOCAL_MEM_FENCE);
 
     //  Tail stops the last workgroup from reading past the end of the input vector
-    uint tail = length - (get_group_id(0) * get_local_size(0));
+    BOLT_INDEX_T tail = length - (get_group_id(0) * get_local_size(0));
 
     // Parallel reduction within a given workgroup using local data store
     // to share values between workitems
+#if REDUCE_WG_SIZE > 128
     _REDUCE_STEP(tail, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
     _REDUCE_STEP(tail, local_index, 64);
+#endif
     _REDUCE_STEP(tail, local_index, 32);
     _REDUCE_STEP(tail, local_index, 16);
     _REDUCE_STEP(tail, local_index,  8);
@@ -81,3 +89,40 @@ kernel void count_Template(
         result[get_group_id(0)] = scratch_count[0];        
     }
 };
+
+//  Second pass: a single workgroup sums the per-workgroup counts of count_Template into result[0], so only one count
+//  has to leave the device
+template< typename T >
+kernel void count_FinalTemplate(
+    global T*    result,
+    const int numPartials,
+    local T*     scratch_count
+)
+{
+    int local_index = get_local_id(0);
+
+    //  Every count is read into registers before the first barrier, so result[0] can be overwritten at the end
+    T count = 0;
+    for(int i = local_index; i < numPartials; i += get_local_size(0))
+        count += result[i];
+    scratch_count[local_index] = count;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP(numPartials, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP(numPartials, local_index, 64);
+#endif
+    _REDUCE_STEP(numPartials, local_index, 32);
+    _REDUCE_STEP(numPartials, local_index, 16);
+    _REDUCE_STEP(numPartials, local_index,  8);
+    _REDUCE_STEP(numPartials, local_index,  4);
+    _REDUCE_STEP(numPartials, local_index,  2);
+    _REDUCE_STEP(numPartials, local_index,  1);
+
+    if (local_index == 0)
+    {
+        result[0] = scratch_count[0];
+    }
+};
@@ -20,11 +20,15 @@
 #define BOLT_CL_BINARY_SEARCH_INL
 #define BINARY_SEARCH_WAVEFRONT_SIZE 64
 //#define BINARY_SEARCH_THRESHOLD 16
+#define VECTORIZED_SEARCH_WGSIZE 256
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 #include <type_traits>
+#include <sstream>
+#include <algorithm>
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/device_vector.h"
 #include "bolt/cl/functional.h"
 //TBB Includes
@@ -138,13 +142,15 @@ namespace bolt {
                 compileOptions = oss.str();
 
                 BinarySearch_KernelTemplateSpecializer c_kts;
+                static ProgramCacheSlot c_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &c_kts,
                     typeDefs,
                     binary_search_kernels,
-                    compileOptions);
+                    compileOptions,
+                    &c_ktsSlot );
                 size_t totalThreads = globalThreads+residueGlobalThreads;
 
                 control::buffPointer result = ctl.acquireBuffer( sizeof( int ) * totalThreads,
@@ -182,7 +188,7 @@ namespace bolt {
                             NULL,
                             &kernelEvent);
                         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel" );
-                        bolt::cl::wait(ctl, kernelEvent);
+                        bolt::cl::wait(ctl, kernelEvent, "binary_search");
                     }
 
 
@@ -208,7 +214,7 @@ namespace bolt {
                             NULL,
                             &residueKernelEvent);
                         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel" );
-                        bolt::cl::wait(ctl, residueKernelEvent);
+                        bolt::cl::wait(ctl, residueKernelEvent, "binary_search");
                     }
                 }
                 catch( const ::cl::Error& e)
@@ -224,7 +230,7 @@ namespace bolt {
                 int *h_result = (int*)ctl.getCommandQueue().enqueueMapBuffer(*result, false, CL_MAP_READ, 0,
                     sizeof(int)* totalThreads, NULL, &l_mapEvent, &l_Error );
                 V_OPENCL( l_Error, "Error calling map on the result buffer" );
-                bolt::cl::wait(ctl, l_mapEvent);
+                bolt::cl::wait(ctl, l_mapEvent, "binary_search");
 
                 bool r = false;
                 for(size_t i=0; i<totalThreads; i++)
@@ -266,11 +272,8 @@ namespace bolt {
                 if (sz < 1)
                      return false;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode(); // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, 1, sizeof( Type ), false );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -319,11 +322,8 @@ namespace bolt {
             {
                 typedef typename std::iterator_traits<DVForwardIterator>::value_type iType;
                 size_t szElements = static_cast<size_t>(std::distance(first, last) );
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode(); // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, 1, sizeof( iType ), true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 				
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -372,11 +372,9 @@ namespace bolt {
                 if (szElements == 0)
                     return false;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode(); // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, 1, sizeof( iType ), false );
+                runMode = detail::iteratorRunMode( ctl, runMode, first );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -437,6 +435,373 @@ namespace bolt {
                 static_assert( std::is_same< ForwardIterator, std::forward_iterator_tag   >::value, "Bolt only supports random access iterator types" );
             }
 
+
+            /*****************************************************************************
+             * Vectorized search ( lower_bound, upper_bound and binary_search over a range of values )
+             ****************************************************************************/
+
+        enum vectorizedSearchMode { search_lowerBound, search_upperBound, search_binarySearch };
+
+        enum vectorizedSearchTypeName { vs_iType, vs_iIterType, vs_vType, vs_vIterType, vs_oType, vs_oIterType,
+            vs_StrictWeakOrdering, vs_end };
+
+        class VectorizedSearch_KernelTemplateSpecializer : public KernelTemplateSpecializer
+        {
+            public:
+
+            VectorizedSearch_KernelTemplateSpecializer() : KernelTemplateSpecializer()
+            {
+                addKernelName( "vectorizedSearch" );
+            }
+
+            const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
+            {
+                const std::string templateSpecializationString =
+                    "// Dynamic specialization of generic template definition, using user supplied types\n"
+                    "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
+                    "__attribute__((reqd_work_group_size(" + vectorizedSearchWgSizeString( ) + ",1,1)))\n"
+                    "__kernel void " + name(0) + "Template(\n"
+                    "global " + typeNames[vs_iType] + " * src,\n"
+                    + typeNames[vs_iIterType] + " input_iter,\n"
+                    "const uint numElements,\n"
+                    "global " + typeNames[vs_vType] + " * values,\n"
+                    + typeNames[vs_vIterType] + " values_iter,\n"
+                    "const uint numValues,\n"
+                    "global " + typeNames[vs_oType] + " * result,\n"
+                    + typeNames[vs_oIterType] + " result_iter,\n"
+                    "global " + typeNames[vs_StrictWeakOrdering] + " * comp,\n"
+                    "const int searchMode,\n"
+                    "local " + typeNames[vs_vType] + " * ldsMin,\n"
+                    "local " + typeNames[vs_vType] + " * ldsMax\n"
+                    ");\n\n";
+
+                return templateSpecializationString;
+            }
+
+            static std::string vectorizedSearchWgSizeString( )
+            {
+                std::ostringstream oss;
+                oss << VECTORIZED_SEARCH_WGSIZE;
+                return oss.str( );
+            }
+        };
+
+            template< typename DVForwardIterator, typename DVInputIterator, typename DVOutputIterator,
+                typename StrictWeakOrdering >
+            DVOutputIterator vectorized_search_enqueue( bolt::cl::control &ctl, const DVForwardIterator &first,
+                const DVForwardIterator &last, const DVInputIterator &values_first, const DVInputIterator &values_last,
+                const DVOutputIterator &result, StrictWeakOrdering comp, const std::string& cl_code,
+                vectorizedSearchMode mode )
+            {
+                typedef typename std::iterator_traits<DVForwardIterator>::value_type iType;
+                typedef typename std::iterator_traits<DVInputIterator>::value_type vType;
+                typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
+
+                cl_uint numElements = static_cast< cl_uint >( std::distance( first, last ) );
+                cl_uint numValues = static_cast< cl_uint >( std::distance( values_first, values_last ) );
+                if( numValues == 0 )
+                    return result;
+
+                /**********************************************************************************
+                 * Type Names - used in KernelTemplateSpecializer
+                 *********************************************************************************/
+                std::vector<std::string> typeNames( vs_end );
+                typeNames[vs_iType] = TypeName< iType >::get( );
+                typeNames[vs_iIterType] = TypeName< DVForwardIterator >::get( );
+                typeNames[vs_vType] = TypeName< vType >::get( );
+                typeNames[vs_vIterType] = TypeName< DVInputIterator >::get( );
+                typeNames[vs_oType] = TypeName< oType >::get( );
+                typeNames[vs_oIterType] = TypeName< DVOutputIterator >::get( );
+                typeNames[vs_StrictWeakOrdering] = TypeName< StrictWeakOrdering >::get( );
+
+                /**********************************************************************************
+                 * Type Definitions - directly concatenated into kernel string (order may matter)
+                 *********************************************************************************/
+                std::vector<std::string> typeDefs;
+                PUSH_BACK_UNIQUE( typeDefs, cl_code )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< iType >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< vType >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< oType >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< DVForwardIterator >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< DVInputIterator >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< DVOutputIterator >::get() )
+                PUSH_BACK_UNIQUE( typeDefs, ClCode< StrictWeakOrdering >::get() )
+
+                //--------------------------------------------------------------------------
+                //Compile the Kernel
+                std::string compileOptions;
+
+                VectorizedSearch_KernelTemplateSpecializer vs_kts;
+                static ProgramCacheSlot vs_ktsSlot;
+                std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+                    ctl,
+                    typeNames,
+                    &vs_kts,
+                    typeDefs,
+                    binary_search_kernels,
+                    compileOptions,
+                    &vs_ktsSlot );
+
+                ALIGNED( 256 ) StrictWeakOrdering aligned_comp( comp );
+                control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( aligned_comp ),
+                                                          CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_comp );
+
+                typename DVForwardIterator::Payload input_payload = first.gpuPayload( );
+                typename DVInputIterator::Payload values_payload = values_first.gpuPayload( );
+                typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
+
+                const size_t wgSize = VECTORIZED_SEARCH_WGSIZE;
+                V_OPENCL( kernels[0].setArg( 0, first.getContainer().getBuffer()), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 1, first.gpuPayloadSize( ), &input_payload ),
+                    "Error setting a kernel argument" );
+                V_OPENCL( kernels[0].setArg( 2, numElements ), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 3, values_first.getContainer().getBuffer()), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 4, values_first.gpuPayloadSize( ), &values_payload ),
+                    "Error setting a kernel argument" );
+                V_OPENCL( kernels[0].setArg( 5, numValues ), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 6, result.getContainer().getBuffer()), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 7, result.gpuPayloadSize( ), &result_payload ),
+                    "Error setting a kernel argument" );
+                V_OPENCL( kernels[0].setArg( 8, *userFunctor ), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 9, static_cast< cl_int >( mode ) ), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 10, wgSize * sizeof( vType ), NULL ), "Error setArg kernels[ 0 ]" );
+                V_OPENCL( kernels[0].setArg( 11, wgSize * sizeof( vType ), NULL ), "Error setArg kernels[ 0 ]" );
+
+                size_t globalThreads = ( ( numValues + wgSize - 1 ) / wgSize ) * wgSize;
+
+                ::cl::Event kernelEvent;
+                cl_int l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
+                    kernels[0],
+                    ::cl::NullRange,
+                    ::cl::NDRange( globalThreads ),
+                    ::cl::NDRange( wgSize ),
+                    NULL,
+                    &kernelEvent );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for vectorizedSearch kernel" );
+                bolt::cl::wait( ctl, kernelEvent, "vectorized_search" );
+
+                return result + numValues;
+            }; // end vectorized_search_enqueue
+
+            //  Host side search of every value; serves SerialCpu and the host pointers of device_vectors
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+                typename StrictWeakOrdering>
+            OutputIterator vectorized_search_serial( ForwardIterator first, ForwardIterator last,
+                InputIterator values_first, InputIterator values_last, OutputIterator result, StrictWeakOrdering comp,
+                vectorizedSearchMode mode )
+            {
+                typedef typename std::iterator_traits<OutputIterator>::value_type oType;
+
+                for( ; values_first != values_last; ++values_first, ++result )
+                {
+                    if( mode == search_lowerBound )
+                        *result = static_cast< oType >( std::lower_bound( first, last, *values_first, comp ) - first );
+                    else if( mode == search_upperBound )
+                        *result = static_cast< oType >( std::upper_bound( first, last, *values_first, comp ) - first );
+                    else
+                        *result = static_cast< oType >( std::binary_search( first, last, *values_first, comp ) ? 1 : 0 );
+                }
+                return result;
+            }
+
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+                typename StrictWeakOrdering>
+            OutputIterator vectorized_search_multicore( ForwardIterator first, ForwardIterator last,
+                InputIterator values_first, InputIterator values_last, OutputIterator result, StrictWeakOrdering comp,
+                vectorizedSearchMode mode )
+            {
+                #ifdef ENABLE_TBB
+                    if( mode == search_lowerBound )
+                        return bolt::btbb::lower_bound( first, last, values_first, values_last, result, comp );
+                    else if( mode == search_upperBound )
+                        return bolt::btbb::upper_bound( first, last, values_first, values_last, result, comp );
+                    else
+                        return bolt::btbb::binary_search( first, last, values_first, values_last, result, comp );
+                #else
+                    throw std::runtime_error("MultiCoreCPU Version of Binary Search not Enabled! \n");
+                #endif
+            }
+
+            // This is called strictly for non-device_vector iterators
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+                typename StrictWeakOrdering>
+            OutputIterator vectorized_search_pick_iterator( bolt::cl::control &ctl, const ForwardIterator &first,
+                const ForwardIterator &last, const InputIterator &values_first, const InputIterator &values_last,
+                const OutputIterator &result, StrictWeakOrdering comp, const std::string &user_code,
+                vectorizedSearchMode mode, std::random_access_iterator_tag )
+            {
+                typedef typename std::iterator_traits<ForwardIterator>::value_type iType;
+                typedef typename std::iterator_traits<InputIterator>::value_type vType;
+                typedef typename std::iterator_traits<OutputIterator>::value_type oType;
+
+                size_t sz = ( last - first );
+                size_t numValues = ( values_last - values_first );
+                if( numValues == 0 )
+                    return result;
+
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numValues, sizeof( vType ), false );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
+
+				#if defined(BOLT_DEBUG_LOG)
+                BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
+                #endif
+
+                if( runMode == bolt::cl::control::SerialCpu || sz == 0 )
+                {
+				     #if defined(BOLT_DEBUG_LOG)
+                     dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_SERIAL_CPU,"::Binary_Search::SERIAL_CPU");
+                     #endif
+                     return vectorized_search_serial( first, last, values_first, values_last, result, comp, mode );
+                }
+                else if(runMode == bolt::cl::control::MultiCoreCpu)
+                {
+                     #if defined(BOLT_DEBUG_LOG)
+                     dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_MULTICORE_CPU,"::Binary_Search::MULTICORE_CPU");
+                     #endif
+                     return vectorized_search_multicore( first, last, values_first, values_last, result, comp, mode );
+                }
+                else
+                {
+				        #if defined(BOLT_DEBUG_LOG)
+                        dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_OPENCL_GPU,"::Binary_Search::OPENCL_GPU");
+                        #endif
+                        // Use host pointers memory since these arrays are only read once - no benefit to copying.
+                        device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+                        device_vector< vType > dvValues( values_first, values_last,
+                                                         CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+                        device_vector< oType > dvResult( result, numValues, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                                         false, ctl );
+
+                        vectorized_search_enqueue( ctl, dvInput.begin( ), dvInput.end( ), dvValues.begin( ),
+                                                   dvValues.end( ), dvResult.begin( ), comp, user_code, mode );
+
+                        // This should immediately map/unmap the buffer
+                        dvResult.data( );
+                        return result + numValues;
+                }
+            }
+
+            // This is called strictly for iterators that are derived from device_vector< T >::iterator
+            template<typename DVForwardIterator, typename DVInputIterator, typename DVOutputIterator,
+                typename StrictWeakOrdering>
+            DVOutputIterator vectorized_search_pick_iterator( bolt::cl::control &ctl, const DVForwardIterator &first,
+                const DVForwardIterator &last, const DVInputIterator &values_first, const DVInputIterator &values_last,
+                const DVOutputIterator &result, StrictWeakOrdering comp, const std::string &user_code,
+                vectorizedSearchMode mode, bolt::cl::device_vector_tag )
+            {
+                typedef typename std::iterator_traits<DVForwardIterator>::value_type iType;
+                typedef typename std::iterator_traits<DVInputIterator>::value_type vType;
+                typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
+
+                size_t numValues = static_cast< size_t >( std::distance( values_first, values_last ) );
+
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numValues, sizeof( vType ), true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
+
+				#if defined(BOLT_DEBUG_LOG)
+                BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
+                #endif
+
+                if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+                {
+                     typename bolt::cl::device_vector< iType >::pointer inputPtr = first.getContainer( ).data( );
+                     typename bolt::cl::device_vector< vType >::pointer valuesPtr = values_first.getContainer( ).data( );
+                     typename bolt::cl::device_vector< oType >::pointer resultPtr = result.getContainer( ).data( );
+
+                     if( runMode == bolt::cl::control::SerialCpu )
+                     {
+				         #if defined(BOLT_DEBUG_LOG)
+                         dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_SERIAL_CPU,"::Binary_Search::SERIAL_CPU");
+                         #endif
+                         vectorized_search_serial( &inputPtr[ first.m_Index ], &inputPtr[ last.m_Index ],
+                             &valuesPtr[ values_first.m_Index ], &valuesPtr[ values_last.m_Index ],
+                             &resultPtr[ result.m_Index ], comp, mode );
+                     }
+                     else
+                     {
+				         #if defined(BOLT_DEBUG_LOG)
+                         dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_MULTICORE_CPU,"::Binary_Search::MULTICORE_CPU");
+                         #endif
+                         vectorized_search_multicore( &inputPtr[ first.m_Index ], &inputPtr[ last.m_Index ],
+                             &valuesPtr[ values_first.m_Index ], &valuesPtr[ values_last.m_Index ],
+                             &resultPtr[ result.m_Index ], comp, mode );
+                     }
+                     return result + numValues;
+                }
+                else
+                {
+				    #if defined(BOLT_DEBUG_LOG)
+                    dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_OPENCL_GPU,"::Binary_Search::OPENCL_GPU");
+                    #endif
+                    return vectorized_search_enqueue( ctl, first, last, values_first, values_last, result, comp,
+                                                      user_code, mode );
+                }
+            }
+
+            // This is called strictly for fancy iterators as the searched range
+            template<typename DVForwardIterator, typename DVInputIterator, typename DVOutputIterator,
+                typename StrictWeakOrdering>
+            DVOutputIterator vectorized_search_pick_iterator( bolt::cl::control &ctl, const DVForwardIterator &first,
+                const DVForwardIterator &last, const DVInputIterator &values_first, const DVInputIterator &values_last,
+                const DVOutputIterator &result, StrictWeakOrdering comp, const std::string &user_code,
+                vectorizedSearchMode mode, bolt::cl::fancy_iterator_tag )
+            {
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( values_first, values_last ) ),
+                    sizeof( typename std::iterator_traits< DVInputIterator >::value_type ), false );
+                runMode = detail::iteratorRunMode( ctl, runMode, first );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
+
+				#if defined(BOLT_DEBUG_LOG)
+                BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
+                #endif
+
+                if( runMode == bolt::cl::control::SerialCpu )
+                {
+				     #if defined(BOLT_DEBUG_LOG)
+                     dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_SERIAL_CPU,"::Binary_Search::SERIAL_CPU");
+                     #endif
+                     return vectorized_search_serial( first, last, values_first, values_last, result, comp, mode );
+                }
+                else if(runMode == bolt::cl::control::MultiCoreCpu)
+                {
+				    #if defined(BOLT_DEBUG_LOG)
+                    dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_MULTICORE_CPU,"::Binary_Search::MULTICORE_CPU");
+                    #endif
+                    return vectorized_search_multicore( first, last, values_first, values_last, result, comp, mode );
+                }
+                else
+                {
+				    #if defined(BOLT_DEBUG_LOG)
+                    dblog->CodePathTaken(BOLTLOG::BOLT_BINARYSEARCH,BOLTLOG::BOLT_OPENCL_GPU,"::Binary_Search::OPENCL_GPU");
+                    #endif
+                    return vectorized_search_enqueue( ctl, first, last, values_first, values_last, result, comp,
+                                                      user_code, mode );
+                }
+            }
+
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+                typename StrictWeakOrdering>
+            OutputIterator vectorized_search_detect_random_access( bolt::cl::control &ctl, ForwardIterator first,
+                ForwardIterator last, InputIterator values_first, InputIterator values_last, OutputIterator result,
+                StrictWeakOrdering comp, const std::string &cl_code, vectorizedSearchMode mode,
+                std::random_access_iterator_tag )
+            {
+                 return vectorized_search_pick_iterator( ctl, first, last, values_first, values_last, result, comp,
+                     cl_code, mode, typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+            }
+
+            // No support for non random access iterators
+            template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+                typename StrictWeakOrdering>
+            OutputIterator vectorized_search_detect_random_access( bolt::cl::control &ctl, ForwardIterator first,
+                ForwardIterator last, InputIterator values_first, InputIterator values_last, OutputIterator result,
+                StrictWeakOrdering comp, const std::string &cl_code, vectorizedSearchMode mode,
+                std::forward_iterator_tag )
+            {
+                static_assert( std::is_same< ForwardIterator, std::forward_iterator_tag   >::value, "Bolt only supports random access iterator types" );
+            }
+
         }//End of detail namespace
 
 
@@ -488,6 +853,199 @@ namespace bolt {
                 typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
         }
 
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator lower_bound( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, bolt::cl::less< iType >( ), cl_code, detail::search_lowerBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator lower_bound( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, bolt::cl::less< iType >( ), cl_code, detail::search_lowerBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator lower_bound( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, comp, cl_code, detail::search_lowerBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator lower_bound( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, comp, cl_code, detail::search_lowerBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator upper_bound( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, bolt::cl::less< iType >( ), cl_code, detail::search_upperBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator upper_bound( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, bolt::cl::less< iType >( ), cl_code, detail::search_upperBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator upper_bound( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, comp, cl_code, detail::search_upperBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator upper_bound( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, comp, cl_code, detail::search_upperBound,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator binary_search( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, bolt::cl::less< iType >( ), cl_code, detail::search_binarySearch,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator>
+        OutputIterator binary_search( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            const std::string& cl_code)
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type iType;
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, bolt::cl::less< iType >( ), cl_code, detail::search_binarySearch,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //Default control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator binary_search( ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( bolt::cl::control::getDefault(), first, last,
+                values_first, values_last, result, comp, cl_code, detail::search_binarySearch,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
+        //User specified control
+        template<typename ForwardIterator, typename InputIterator, typename OutputIterator,
+            typename StrictWeakOrdering>
+        OutputIterator binary_search( bolt::cl::control &ctl,
+            ForwardIterator first,
+            ForwardIterator last,
+            InputIterator values_first,
+            InputIterator values_last,
+            OutputIterator result,
+            StrictWeakOrdering comp,
+            const std::string& cl_code)
+        {
+            return detail::vectorized_search_detect_random_access( ctl, first, last, values_first, values_last,
+                result, comp, cl_code, detail::search_binarySearch,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+        }
+
     }//end of cl namespace
 };//end of bolt namespace
 
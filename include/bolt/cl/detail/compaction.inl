@@ -0,0 +1,701 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Stream compaction engine behind copy_if, remove_if, unique, unique_by_key,
+ *  partition and stable_partition.
+ *
+ *  The algorithms differ only in which elements they keep, which is described by
+ *  a flag: CompactionKeepIf, CompactionRemoveIf or CompactionUniqueHeads.  A flag
+ *  is called as flag( first, i ) on the host and selects COMPACTION_FLAG_MODE on
+ *  the device, where the same decision is made inside the kernels.
+ *****************************************************************************/
+
+#if !defined( BOLT_CL_COMPACTION_INL )
+#define BOLT_CL_COMPACTION_INL
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/functional.h"
+
+#if defined(ENABLE_TBB)
+#include "bolt/btbb/copy_if.h"
+#endif
+
+namespace bolt {
+namespace cl {
+namespace detail {
+
+    //  Work-group size and elements per work item of the compaction kernels; they are built with these values
+    static const cl_uint compactionWgSize = 256;
+    static const cl_uint compactionVT = 8;
+
+    template< typename Predicate >
+    struct CompactionKeepIf
+    {
+        typedef Predicate predicate_type;
+        enum { flagMode = 0 };
+
+        Predicate pred;
+        CompactionKeepIf( const Predicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const { return pred( first[ i ] ) ? true : false; }
+    };
+
+    template< typename Predicate >
+    struct CompactionRemoveIf
+    {
+        typedef Predicate predicate_type;
+        enum { flagMode = 1 };
+
+        Predicate pred;
+        CompactionRemoveIf( const Predicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const { return pred( first[ i ] ) ? false : true; }
+    };
+
+    template< typename BinaryPredicate >
+    struct CompactionUniqueHeads
+    {
+        typedef BinaryPredicate predicate_type;
+        enum { flagMode = 2 };
+
+        BinaryPredicate pred;
+        CompactionUniqueHeads( const BinaryPredicate& _pred ) : pred( _pred ) { }
+
+        template< typename Iterator >
+        bool operator()( const Iterator& first, size_t i ) const
+        {
+            return ( i == 0 || !pred( first[ i - 1 ], first[ i ] ) );
+        }
+    };
+
+    /*! \brief Serial compaction: the elements of [first, last) that flag keeps go to result in order, the matching
+     *  values to values_result when hasValues is set, and with writeRejected the others follow them in order.
+     *  Without writeRejected the output may start at the input, which the in place algorithms rely on; every
+     *  write lands at or before the element being examined and never changes what the flag of a later element
+     *  reads.
+     *  \return The number of elements kept.
+     */
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_serial( InputIterator first, InputIterator last, ValuesIterator values_first,
+                              OutputIterator result, ValuesOutputIterator values_result,
+                              const CompactionFlag& flag, bool hasValues, bool writeRejected )
+    {
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+
+        size_t numKept = 0;
+        if( writeRejected )
+        {
+            for( size_t i = 0; i < numElements; ++i )
+                numKept += flag( first, i ) ? 1 : 0;
+        }
+
+        size_t kept = 0;
+        for( size_t i = 0; i < numElements; ++i )
+        {
+            size_t dst;
+            if( flag( first, i ) )
+                dst = kept++;
+            else if( writeRejected )
+                dst = numKept + i - kept;
+            else
+                continue;
+
+            result[ dst ] = first[ i ];
+            if( hasValues )
+                values_result[ dst ] = values_first[ i ];
+        }
+
+        return kept;
+    }
+
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_cpu( bolt::cl::control::e_RunMode runMode, InputIterator first, InputIterator last,
+                           ValuesIterator values_first, OutputIterator result, ValuesOutputIterator values_result,
+                           const CompactionFlag& flag, bool hasValues, bool writeRejected )
+    {
+        if( runMode == bolt::cl::control::SerialCpu )
+            return compaction_serial( first, last, values_first, result, values_result, flag, hasValues,
+                                      writeRejected );
+
+        #if defined( ENABLE_TBB )
+            return bolt::btbb::detail::compaction( first, last, values_first, result, values_result, flag, hasValues,
+                                                   writeRejected );
+        #else
+            throw std::runtime_error( "The MultiCoreCpu version of compaction is not enabled to be built! \n" );
+        #endif
+    }
+
+    /*  In place form of compaction_cpu.  Only a partition needs a copy of the input, since its rejected
+     *  elements are written behind elements that have not been read yet.  */
+    template< typename ForwardIterator, typename ValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_cpu( bolt::cl::control::e_RunMode runMode, ForwardIterator first,
+                                   ForwardIterator last, ValuesIterator values_first, const CompactionFlag& flag,
+                                   bool hasValues, bool writeRejected )
+    {
+        typedef typename std::iterator_traits< ForwardIterator >::value_type kType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+
+        if( runMode == bolt::cl::control::SerialCpu )
+        {
+            if( !writeRejected )
+                return compaction_serial( first, last, values_first, first, values_first, flag, hasValues, false );
+
+            std::vector< kType > keys( first, last );
+            if( !hasValues )
+                return compaction_serial( keys.begin( ), keys.end( ), keys.begin( ), first, first, flag, false, true );
+
+            std::vector< vType > values( values_first, values_first + keys.size( ) );
+            return compaction_serial( keys.begin( ), keys.end( ), values.begin( ), first, values_first, flag, true,
+                                      true );
+        }
+
+        #if defined( ENABLE_TBB )
+            return bolt::btbb::detail::compaction_inplace( first, last, values_first, flag, hasValues, writeRejected );
+        #else
+            throw std::runtime_error( "The MultiCoreCpu version of compaction is not enabled to be built! \n" );
+        #endif
+    }
+
+    enum compactionTypeName { cp_iType, cp_iIterType, cp_vType, cp_vIterType, cp_oType, cp_oIterType,
+        cp_ovType, cp_ovIterType, cp_Predicate, cp_end };
+
+    class Compaction_KernelTemplateSpecializer : public KernelTemplateSpecializer
+    {
+    public:
+        Compaction_KernelTemplateSpecializer( ) : KernelTemplateSpecializer( )
+        {
+            addKernelName( "compactionCount" );
+            addKernelName( "compactionScan" );
+            addKernelName( "compactionScatter" );
+        }
+
+        const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
+        {
+            const std::string templateSpecializationString =
+                "// Host generates this instantiation string with user-specified value type and functor\n"
+                "template __attribute__((mangled_name(" + name( 0 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(COMPACTION_WG_SIZE,1,1)))\n"
+                "kernel void compactionCount(\n"
+                "global " + typeNames[ cp_iType ] + "* input_ptr,\n"
+                + typeNames[ cp_iIterType ] + " input_iter,\n"
+                "const uint numElements,\n"
+                "global " + typeNames[ cp_Predicate ] + "* pred,\n"
+                "global uint* tileCounts\n"
+                ");\n\n"
+
+                "// Host generates this instantiation string with user-specified value type and functor\n"
+                "template __attribute__((mangled_name(" + name( 2 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(COMPACTION_WG_SIZE,1,1)))\n"
+                "kernel void compactionScatter(\n"
+                "global " + typeNames[ cp_iType ] + "* input_ptr,\n"
+                + typeNames[ cp_iIterType ] + " input_iter,\n"
+                "global " + typeNames[ cp_vType ] + "* values_ptr,\n"
+                + typeNames[ cp_vIterType ] + " values_iter,\n"
+                "const uint numElements,\n"
+                "global " + typeNames[ cp_Predicate ] + "* pred,\n"
+                "global const uint* tileOffsets,\n"
+                "global " + typeNames[ cp_oType ] + "* result_ptr,\n"
+                + typeNames[ cp_oIterType ] + " result_iter,\n"
+                "global " + typeNames[ cp_ovType ] + "* values_result_ptr,\n"
+                + typeNames[ cp_ovIterType ] + " values_result_iter,\n"
+                "const int hasValues,\n"
+                "const int writeRejected\n"
+                ");\n\n";
+
+            return templateSpecializationString;
+        }
+    };
+
+    /*! \brief Device compaction; same contract as compaction_serial except that the output may never overlap the
+     *  input.  Three launches: per tile counts, a single work-group scan of the counts, and the scatter.  The
+     *  number kept is read back with the last entry of the scanned counts.
+     */
+    template< typename DVInputIterator, typename DVValuesIterator, typename DVOutputIterator,
+              typename DVValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_enqueue( bolt::cl::control &ctl, const DVInputIterator& first, const DVInputIterator& last,
+                               const DVValuesIterator& values_first, const DVOutputIterator& result,
+                               const DVValuesOutputIterator& values_result, const CompactionFlag& flag,
+                               bool hasValues, bool writeRejected, const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< DVInputIterator >::value_type iType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+        typedef typename std::iterator_traits< DVOutputIterator >::value_type oType;
+        typedef typename std::iterator_traits< DVValuesOutputIterator >::value_type ovType;
+        typedef typename CompactionFlag::predicate_type Predicate;
+
+        cl_uint numElements = static_cast< cl_uint >( std::distance( first, last ) );
+        if( numElements == 0 )
+            return 0;
+
+        std::vector< std::string > typeNames( cp_end );
+        typeNames[ cp_iType ] = TypeName< iType >::get( );
+        typeNames[ cp_iIterType ] = TypeName< DVInputIterator >::get( );
+        typeNames[ cp_vType ] = TypeName< vType >::get( );
+        typeNames[ cp_vIterType ] = TypeName< DVValuesIterator >::get( );
+        typeNames[ cp_oType ] = TypeName< oType >::get( );
+        typeNames[ cp_oIterType ] = TypeName< DVOutputIterator >::get( );
+        typeNames[ cp_ovType ] = TypeName< ovType >::get( );
+        typeNames[ cp_ovIterType ] = TypeName< DVValuesOutputIterator >::get( );
+        typeNames[ cp_Predicate ] = TypeName< Predicate >::get( );
+
+        std::vector< std::string > typeDefinitions;
+        PUSH_BACK_UNIQUE( typeDefinitions, cl_code )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< iType >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< vType >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< oType >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< ovType >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVInputIterator >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVValuesIterator >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVOutputIterator >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVValuesOutputIterator >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< Predicate >::get( ) )
+
+        std::ostringstream oss;
+        oss << " -DCOMPACTION_FLAG_MODE=" << static_cast< int >( CompactionFlag::flagMode );
+        oss << " -DCOMPACTION_WG_SIZE=" << compactionWgSize << " -DCOMPACTION_VT=" << compactionVT;
+        std::string compileOptions = oss.str( );
+
+        Compaction_KernelTemplateSpecializer compaction_kts;
+        static ProgramCacheSlot compaction_ktsSlot;
+        std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+            ctl,
+            typeNames,
+            &compaction_kts,
+            typeDefinitions,
+            compaction_kernels,
+            compileOptions,
+            &compaction_ktsSlot );
+
+        ::cl::Kernel countKernel   = kernels[ 0 ];
+        ::cl::Kernel scanKernel    = kernels[ 1 ];
+        ::cl::Kernel scatterKernel = kernels[ 2 ];
+
+        const cl_uint tileSize = compactionWgSize * compactionVT;
+        cl_uint numTiles = ( numElements + tileSize - 1 ) / tileSize;
+
+        ALIGNED( 256 ) Predicate aligned_pred( flag.pred );
+        control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( aligned_pred ),
+                                                              CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_pred );
+        control::buffPointer tileCounts = ctl.acquireBuffer( ( numTiles + 1 ) * sizeof( cl_uint ) );
+
+        typename DVInputIterator::Payload input_payload = first.gpuPayload( );
+        typename DVValuesIterator::Payload values_payload = values_first.gpuPayload( );
+        typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
+        typename DVValuesOutputIterator::Payload values_result_payload = values_result.gpuPayload( );
+
+        ::cl::CommandQueue& myCQ = ctl.getCommandQueue( );
+        cl_int l_Error = CL_SUCCESS;
+
+        V_OPENCL( countKernel.setArg( 0, first.getContainer( ).getBuffer( ) ), "Error setting a kernel argument" );
+        V_OPENCL( countKernel.setArg( 1, first.gpuPayloadSize( ), &input_payload ), "Error setting a kernel argument" );
+        V_OPENCL( countKernel.setArg( 2, numElements ), "Error setting a kernel argument" );
+        V_OPENCL( countKernel.setArg( 3, *userFunctor ), "Error setting a kernel argument" );
+        V_OPENCL( countKernel.setArg( 4, *tileCounts ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( countKernel, ::cl::NullRange,
+                                             ::cl::NDRange( numTiles * compactionWgSize ),
+                                             ::cl::NDRange( compactionWgSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for compactionCount kernel" );
+
+        V_OPENCL( scanKernel.setArg( 0, *tileCounts ), "Error setting a kernel argument" );
+        V_OPENCL( scanKernel.setArg( 1, numTiles ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( scanKernel, ::cl::NullRange, ::cl::NDRange( compactionWgSize ),
+                                             ::cl::NDRange( compactionWgSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for compactionScan kernel" );
+
+        V_OPENCL( scatterKernel.setArg( 0, first.getContainer( ).getBuffer( ) ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 1, first.gpuPayloadSize( ), &input_payload ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 2, values_first.getContainer( ).getBuffer( ) ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 3, values_first.gpuPayloadSize( ), &values_payload ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 4, numElements ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 5, *userFunctor ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 6, *tileCounts ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 7, result.getContainer( ).getBuffer( ) ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 8, result.gpuPayloadSize( ), &result_payload ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 9, values_result.getContainer( ).getBuffer( ) ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 10, values_result.gpuPayloadSize( ), &values_result_payload ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 11, static_cast< cl_int >( hasValues ) ), "Error setting a kernel argument" );
+        V_OPENCL( scatterKernel.setArg( 12, static_cast< cl_int >( writeRejected ) ),
+                  "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( scatterKernel, ::cl::NullRange,
+                                             ::cl::NDRange( numTiles * compactionWgSize ),
+                                             ::cl::NDRange( compactionWgSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for compactionScatter kernel" );
+
+        //  The queue is in order, so the blocking read also waits for the scatter
+        cl_uint numKept = 0;
+        l_Error = myCQ.enqueueReadBuffer( *tileCounts, CL_TRUE, numTiles * sizeof( cl_uint ), sizeof( cl_uint ),
+                                          &numKept );
+        V_OPENCL( l_Error, "enqueueReadBuffer() failed for the compaction count" );
+
+        return numKept;
+    }
+
+    /*  Copies count keys ( and values ) of the compacted temporaries back over the input range  */
+    template< typename DVKeysIterator, typename DVValuesIterator, typename kType, typename vType >
+    void compaction_copy_back( bolt::cl::control &ctl, const DVKeysIterator& first,
+                               const DVValuesIterator& values_first,
+                               const device_vector< kType >& keys, const device_vector< vType >& values,
+                               size_t count, bool hasValues )
+    {
+        if( count == 0 )
+            return;
+
+        ::cl::CommandQueue& myCQ = ctl.getCommandQueue( );
+        ::cl::Event copyEvent;
+        cl_int l_Error = myCQ.enqueueCopyBuffer( keys.getBuffer( ), first.getContainer( ).getBuffer( ), 0,
+                                                 first.m_Index * sizeof( kType ), count * sizeof( kType ),
+                                                 NULL, &copyEvent );
+        V_OPENCL( l_Error, "enqueueCopyBuffer() failed for compacted keys" );
+
+        if( hasValues )
+        {
+            l_Error = myCQ.enqueueCopyBuffer( values.getBuffer( ), values_first.getContainer( ).getBuffer( ), 0,
+                                              values_first.m_Index * sizeof( vType ), count * sizeof( vType ),
+                                              NULL, &copyEvent );
+            V_OPENCL( l_Error, "enqueueCopyBuffer() failed for compacted values" );
+        }
+
+        //  The queue is in order, so the last copy completes after the first
+        bolt::cl::wait( ctl, copyEvent, "compaction" );
+    }
+
+    /*  Device in place compaction over device_vector iterators, staged through device temporaries  */
+    template< typename DVForwardIterator, typename DVValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_enqueue( bolt::cl::control &ctl, const DVForwardIterator& first,
+                                       const DVForwardIterator& last, const DVValuesIterator& values_first,
+                                       const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                       const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< DVForwardIterator >::value_type kType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+        if( numElements == 0 )
+            return 0;
+
+        device_vector< kType > keysOut( numElements, kType( ), CL_MEM_READ_WRITE, false, ctl );
+        size_t numKept;
+        if( !hasValues )
+        {
+            numKept = compaction_enqueue( ctl, first, last, first, keysOut.begin( ), keysOut.begin( ), flag, false,
+                                          writeRejected, cl_code );
+            compaction_copy_back( ctl, first, first, keysOut, keysOut, writeRejected ? numElements : numKept, false );
+        }
+        else
+        {
+            device_vector< vType > valuesOut( numElements, vType( ), CL_MEM_READ_WRITE, false, ctl );
+            numKept = compaction_enqueue( ctl, first, last, values_first, keysOut.begin( ), valuesOut.begin( ), flag,
+                                          true, writeRejected, cl_code );
+            compaction_copy_back( ctl, first, values_first, keysOut, valuesOut,
+                                  writeRejected ? numElements : numKept, true );
+        }
+
+        return numKept;
+    }
+
+    /*  Picks the code path for an out of place compaction.  Without values, values_first and values_result are
+     *  expected to repeat first and result.  */
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_pick_iterator( bolt::cl::control &ctl, const InputIterator& first, const InputIterator& last,
+                                     const ValuesIterator& values_first, const OutputIterator& result,
+                                     const ValuesOutputIterator& values_result, const CompactionFlag& flag,
+                                     bool hasValues, bool writeRejected, const std::string& cl_code,
+                                     std::random_access_iterator_tag )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+        typedef typename std::iterator_traits< OutputIterator >::value_type oType;
+        typedef typename std::iterator_traits< ValuesOutputIterator >::value_type ovType;
+
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+        if( numElements == 0 )
+            return 0;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( iType ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_SERIAL_CPU, "::Compaction::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Compaction::MULTICORE_CPU" );
+            #endif
+            return compaction_cpu( runMode, first, last, values_first, result, values_result, flag, hasValues,
+                                   writeRejected );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_OPENCL_GPU, "::Compaction::OPENCL_GPU" );
+        #endif
+
+        //  The input is read once, so it is used in place; the outputs wrap the host ranges without copying them in
+        device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+        device_vector< oType > dvResult( result, numElements, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, false, ctl );
+        size_t numKept;
+        if( !hasValues )
+        {
+            numKept = compaction_enqueue( ctl, dvInput.begin( ), dvInput.end( ), dvInput.begin( ), dvResult.begin( ),
+                                          dvResult.begin( ), flag, false, writeRejected, cl_code );
+        }
+        else
+        {
+            device_vector< vType > dvValues( values_first, numElements, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                             true, ctl );
+            device_vector< ovType > dvValuesResult( values_result, numElements,
+                                                    CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, false, ctl );
+            numKept = compaction_enqueue( ctl, dvInput.begin( ), dvInput.end( ), dvValues.begin( ), dvResult.begin( ),
+                                          dvValuesResult.begin( ), flag, true, writeRejected, cl_code );
+            dvValuesResult.data( );
+        }
+
+        // This should immediately map/unmap the buffer
+        dvResult.data( );
+        return numKept;
+    }
+
+    template< typename DVInputIterator, typename DVValuesIterator, typename DVOutputIterator,
+              typename DVValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_pick_iterator( bolt::cl::control &ctl, const DVInputIterator& first,
+                                     const DVInputIterator& last, const DVValuesIterator& values_first,
+                                     const DVOutputIterator& result, const DVValuesOutputIterator& values_result,
+                                     const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                     const std::string& cl_code, bolt::cl::device_vector_tag )
+    {
+        typedef typename std::iterator_traits< DVInputIterator >::value_type iType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+        typedef typename std::iterator_traits< DVOutputIterator >::value_type oType;
+        typedef typename std::iterator_traits< DVValuesOutputIterator >::value_type ovType;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+            static_cast< size_t >( std::distance( first, last ) ), sizeof( iType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_SERIAL_CPU, "::Compaction::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Compaction::MULTICORE_CPU" );
+            #endif
+            typename bolt::cl::device_vector< iType >::pointer inputPtr = first.getContainer( ).data( );
+            typename bolt::cl::device_vector< oType >::pointer resultPtr = result.getContainer( ).data( );
+            if( !hasValues )
+                return compaction_cpu( runMode, &inputPtr[ first.m_Index ], &inputPtr[ last.m_Index ],
+                                       &inputPtr[ first.m_Index ], &resultPtr[ result.m_Index ],
+                                       &resultPtr[ result.m_Index ], flag, false, writeRejected );
+
+            typename bolt::cl::device_vector< vType >::pointer valuesPtr = values_first.getContainer( ).data( );
+            typename bolt::cl::device_vector< ovType >::pointer valuesResultPtr = values_result.getContainer( ).data( );
+            return compaction_cpu( runMode, &inputPtr[ first.m_Index ], &inputPtr[ last.m_Index ],
+                                   &valuesPtr[ values_first.m_Index ], &resultPtr[ result.m_Index ],
+                                   &valuesResultPtr[ values_result.m_Index ], flag, true, writeRejected );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_OPENCL_GPU, "::Compaction::OPENCL_GPU" );
+        #endif
+        return compaction_enqueue( ctl, first, last, values_first, result, values_result, flag, hasValues,
+                                   writeRejected, cl_code );
+    }
+
+    /*  Picks the code path for an in place compaction.  Without values, values_first is expected to repeat
+     *  first.  */
+    template< typename ForwardIterator, typename ValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_pick_iterator( bolt::cl::control &ctl, const ForwardIterator& first,
+                                             const ForwardIterator& last, const ValuesIterator& values_first,
+                                             const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                             const std::string& cl_code, std::random_access_iterator_tag )
+    {
+        typedef typename std::iterator_traits< ForwardIterator >::value_type kType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+        if( numElements == 0 )
+            return 0;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( kType ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_SERIAL_CPU, "::Compaction::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Compaction::MULTICORE_CPU" );
+            #endif
+            return compaction_inplace_cpu( runMode, first, last, values_first, flag, hasValues, writeRejected );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_OPENCL_GPU, "::Compaction::OPENCL_GPU" );
+        #endif
+
+        device_vector< kType > dvKeys( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, ctl );
+        size_t numKept;
+        if( !hasValues )
+        {
+            numKept = compaction_inplace_enqueue( ctl, dvKeys.begin( ), dvKeys.end( ), dvKeys.begin( ), flag, false,
+                                                  writeRejected, cl_code );
+        }
+        else
+        {
+            device_vector< vType > dvValues( values_first, numElements, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                                             true, ctl );
+            numKept = compaction_inplace_enqueue( ctl, dvKeys.begin( ), dvKeys.end( ), dvValues.begin( ), flag, true,
+                                                  writeRejected, cl_code );
+            dvValues.data( );
+        }
+
+        // This should immediately map/unmap the buffer
+        dvKeys.data( );
+        return numKept;
+    }
+
+    template< typename DVForwardIterator, typename DVValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_pick_iterator( bolt::cl::control &ctl, const DVForwardIterator& first,
+                                             const DVForwardIterator& last, const DVValuesIterator& values_first,
+                                             const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                             const std::string& cl_code, bolt::cl::device_vector_tag )
+    {
+        typedef typename std::iterator_traits< DVForwardIterator >::value_type kType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+            static_cast< size_t >( std::distance( first, last ) ), sizeof( kType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_SERIAL_CPU, "::Compaction::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Compaction::MULTICORE_CPU" );
+            #endif
+            typename bolt::cl::device_vector< kType >::pointer keysPtr = first.getContainer( ).data( );
+            if( !hasValues )
+                return compaction_inplace_cpu( runMode, &keysPtr[ first.m_Index ], &keysPtr[ last.m_Index ],
+                                               &keysPtr[ first.m_Index ], flag, false, writeRejected );
+
+            typename bolt::cl::device_vector< vType >::pointer valuesPtr = values_first.getContainer( ).data( );
+            return compaction_inplace_cpu( runMode, &keysPtr[ first.m_Index ], &keysPtr[ last.m_Index ],
+                                           &valuesPtr[ values_first.m_Index ], flag, true, writeRejected );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_COMPACTION, BOLTLOG::BOLT_OPENCL_GPU, "::Compaction::OPENCL_GPU" );
+        #endif
+        return compaction_inplace_enqueue( ctl, first, last, values_first, flag, hasValues, writeRejected, cl_code );
+    }
+
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_detect_random_access( bolt::cl::control &ctl, const InputIterator& first,
+                                            const InputIterator& last, const ValuesIterator& values_first,
+                                            const OutputIterator& result, const ValuesOutputIterator& values_result,
+                                            const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                            const std::string& cl_code, std::random_access_iterator_tag )
+    {
+        return compaction_pick_iterator( ctl, first, last, values_first, result, values_result, flag, hasValues,
+            writeRejected, cl_code, typename std::iterator_traits< InputIterator >::iterator_category( ) );
+    }
+
+    // No support for non random access iterators
+    template< typename InputIterator, typename ValuesIterator, typename OutputIterator,
+              typename ValuesOutputIterator, typename CompactionFlag >
+    size_t compaction_detect_random_access( bolt::cl::control &ctl, const InputIterator& first,
+                                            const InputIterator& last, const ValuesIterator& values_first,
+                                            const OutputIterator& result, const ValuesOutputIterator& values_result,
+                                            const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                            const std::string& cl_code, std::input_iterator_tag )
+    {
+        static_assert( std::is_same< InputIterator, std::input_iterator_tag >::value,
+            "Bolt only supports random access iterator types" );
+        return 0;
+    }
+
+    template< typename ForwardIterator, typename ValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_detect_random_access( bolt::cl::control &ctl, const ForwardIterator& first,
+                                                    const ForwardIterator& last, const ValuesIterator& values_first,
+                                                    const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                                    const std::string& cl_code, std::random_access_iterator_tag )
+    {
+        return compaction_inplace_pick_iterator( ctl, first, last, values_first, flag, hasValues, writeRejected,
+            cl_code, typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+    }
+
+    // No support for non random access iterators
+    template< typename ForwardIterator, typename ValuesIterator, typename CompactionFlag >
+    size_t compaction_inplace_detect_random_access( bolt::cl::control &ctl, const ForwardIterator& first,
+                                                    const ForwardIterator& last, const ValuesIterator& values_first,
+                                                    const CompactionFlag& flag, bool hasValues, bool writeRejected,
+                                                    const std::string& cl_code, std::forward_iterator_tag )
+    {
+        static_assert( std::is_same< ForwardIterator, std::forward_iterator_tag >::value,
+            "Bolt only supports random access iterator types" );
+        return 0;
+    }
+
+} // detail
+} // cl
+} // bolt
+
+#endif // BOLT_CL_COMPACTION_INL
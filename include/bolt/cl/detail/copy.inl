@@ -28,6 +28,7 @@
 #include <type_traits>
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 
 #ifdef ENABLE_TBB
 //TBB Includes
@@ -111,7 +112,7 @@ class Copy_KernelTemplateSpecializer : public KernelTemplateSpecializer
              + typeNames[copy_DVInputIterator] + " input_iter,\n"
             "global " + typeNames[copy_oType] + " * restrict dst,\n"
              + typeNames[copy_DVOutputIterator] + " output_iter,\n"
-            "const uint numElements"
+            "const BOLT_INDEX_T numElements"
             ");\n\n"
 
             "// Dynamic specialization of generic template definition, using user supplied types\n"
@@ -120,7 +121,7 @@ class Copy_KernelTemplateSpecializer : public KernelTemplateSpecializer
             "__kernel void " + name(1) + "(\n"
             "global " + typeNames[copy_iType] + " * restrict src,\n"
             "global " + typeNames[copy_oType] + " * restrict dst,\n"
-            "const uint numElements\n"
+            "const BOLT_INDEX_T numElements\n"
             ");\n\n"
 
             "// Dynamic specialization of generic template definition, using user supplied types\n"
@@ -129,7 +130,7 @@ class Copy_KernelTemplateSpecializer : public KernelTemplateSpecializer
             "__kernel void " + name(2) + "(\n"
             "global " + typeNames[copy_iType] + " * restrict src,\n"
             "global " + typeNames[copy_oType] + " * restrict dst,\n"
-            "const uint numElements\n"
+            "const BOLT_INDEX_T numElements\n"
             ");\n\n"
 
             "// Dynamic specialization of generic template definition, using user supplied types\n"
@@ -138,7 +139,7 @@ class Copy_KernelTemplateSpecializer : public KernelTemplateSpecializer
             "__kernel void " + name(3) + "(\n"
             "global " + typeNames[copy_iType] + " * restrict src,\n"
             "global " + typeNames[copy_oType] + " * restrict dst,\n"
-            "const uint numElements\n"
+            "const BOLT_INDEX_T numElements\n"
             ");\n\n"
             ;
 
@@ -174,7 +175,7 @@ typename std::enable_if< std::is_same< typename std::iterator_traits<DVInputIter
                         NULL,
                         &copyEvent);
     // wait for results
-    bolt::cl::wait(ctrl, copyEvent);
+    bolt::cl::deferredWait(ctrl, copyEvent, "copy");
 }
 
 
@@ -217,9 +218,8 @@ typename std::enable_if< !(std::is_same< typename std::iterator_traits<DVInputIt
     const size_t numWorkGroupsPerComputeUnit = 10; //ctrl.wgPerComputeUnit( );
     const size_t numWorkGroups = numComputeUnits * numWorkGroupsPerComputeUnit;
 
-    const cl_uint numThreadsIdeal = static_cast<cl_uint>( numWorkGroups * workGroupSize );
-    cl_uint numElementsPerThread = n / numThreadsIdeal;
-    cl_uint numThreadsRUP = n;
+    const size_t numThreadsIdeal = numWorkGroups * workGroupSize;
+    size_t numThreadsRUP = n;
     size_t mod = (n & (workGroupSize-1));
     int doBoundaryCheck = 0;
     if( mod )
@@ -236,19 +236,23 @@ typename std::enable_if< !(std::is_same< typename std::iterator_traits<DVInputIt
     std::ostringstream oss;
     oss << " -DBURST_SIZE=" << BURST_SIZE;
     oss << " -DBOUNDARY_CHECK=" << doBoundaryCheck;
+    const kernelIndex index( n );
+    oss << index.compileOptions( );
     compileOptions = oss.str();
 
     /**********************************************************************************
      * Request Compiled Kernels
      *********************************************************************************/
     Copy_KernelTemplateSpecializer c_kts;
+    static ProgramCacheSlot c_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctrl,
         typeNames,
         &c_kts,
         typeDefs,
         copy_kernels,
-        compileOptions);
+        compileOptions,
+        &c_ktsSlot );
 
     /**********************************************************************************
      *  Kernel
@@ -258,8 +262,8 @@ typename std::enable_if< !(std::is_same< typename std::iterator_traits<DVInputIt
     try
     {
         int whichKernel = 0;
-        cl_uint numThreadsChosen;
-        cl_uint workGroupSizeChosen = workGroupSize;
+        size_t numThreadsChosen;
+        size_t workGroupSizeChosen = workGroupSize;
         switch( whichKernel )
             {
         case 0: // I: 1 thread per element
@@ -288,7 +292,7 @@ typename std::enable_if< !(std::is_same< typename std::iterator_traits<DVInputIt
         V_OPENCL( kernels[whichKernel].setArg( 2, result.getContainer().getBuffer()),"Error setArg kernels[ 0 ]" );
         V_OPENCL( kernels[whichKernel].setArg( 3, result.gpuPayloadSize( ),&result_payload  ), "Error setting a kernel argument" );
         //Buffer Size
-        V_OPENCL( kernels[whichKernel].setArg( 4, static_cast<cl_uint>( n ) ),"Error setArg kernels[0]" );
+        V_OPENCL( index.setArg( kernels[whichKernel], 4, n ),"Error setArg kernels[0]" );
 
 
         l_Error = ctrl.getCommandQueue( ).enqueueNDRangeKernel(
@@ -310,14 +314,14 @@ typename std::enable_if< !(std::is_same< typename std::iterator_traits<DVInputIt
     }
 
     // wait for results
-    bolt::cl::wait(ctrl, kernelEvent);
+    bolt::cl::deferredWait(ctrl, kernelEvent, "copy");
 
 
     // profiling
     cl_command_queue_properties queueProperties;
     l_Error = ctrl.getCommandQueue().getInfo<cl_command_queue_properties>(CL_QUEUE_PROPERTIES, &queueProperties);
     unsigned int profilingEnabled = queueProperties&CL_QUEUE_PROFILING_ENABLE;
-    if ( profilingEnabled ) {
+    if ( profilingEnabled && ctrl.getWaitMode( ) != bolt::cl::control::NoWait ) {
         cl_ulong start_time, stop_time;
 
         V_OPENCL( kernelEvent.getProfilingInfo<cl_ulong>(CL_PROFILING_COMMAND_START, &start_time),
@@ -347,12 +351,8 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const InputIterator& fir
     typedef typename std::iterator_traits<OutputIterator>::value_type oType;
 
 
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-                runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), false, true );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
      #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
      #endif
@@ -407,12 +407,9 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const InputIterator& fir
     typedef typename std::iterator_traits<InputIterator>::value_type iType;
     typedef typename std::iterator_traits<OutputIterator>::value_type oType;
 
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-         runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), false, true );
+     runMode = detail::iteratorRunMode( ctrl, runMode, first );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
      #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
      #endif
@@ -464,12 +461,8 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const DVInputIterator& f
 {
     typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
     typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-               runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), true, true );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
 
 	 #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -524,12 +517,8 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const DVInputIterator& f
 {
     typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
     typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-               runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), true, true );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
 
 	 #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -587,12 +576,8 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const DVInputIterator& f
 {
     typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
     typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-               runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), true, true );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
 
 	 #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -647,12 +632,9 @@ void copy_pick_iterator(const bolt::cl::control &ctrl,  const DVInputIterator& f
 {
      typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
      typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
-     bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-     if( runMode == bolt::cl::control::Automatic )
-     {
-         runMode = ctrl.getDefaultPathToRun( );
-     }
+     bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, n, sizeof( iType ), true, true );
+     runMode = detail::iteratorRunMode( ctrl, runMode, first );
+     bolt::cl::tbbArenaScope tbbScope( ctrl );
      
 	 #if defined(BOLT_DEBUG_LOG)
      BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -765,7 +747,7 @@ template<typename InputIterator, typename OutputIterator>
 OutputIterator copy(const bolt::cl::control &ctrl,  InputIterator first, InputIterator last, OutputIterator result,
             const std::string& user_code)
 {
-    int n = static_cast<int>( std::distance( first, last ) );
+    typename std::iterator_traits< InputIterator >::difference_type n = std::distance( first, last );
     return detail::copy_detect_random_access( ctrl, first, n, result, user_code,
          typename std::iterator_traits< InputIterator >::iterator_category( ) );
 }
@@ -775,7 +757,7 @@ template<typename InputIterator, typename OutputIterator>
 OutputIterator copy( InputIterator first, InputIterator last, OutputIterator result,
             const std::string& user_code)
 {
-    int n = static_cast<int>( std::distance( first, last ) );
+    typename std::iterator_traits< InputIterator >::difference_type n = std::distance( first, last );
             return detail::copy_detect_random_access( control::getDefault(), first, n, result, user_code,
                 typename std::iterator_traits< InputIterator >::iterator_category( ) );
 }
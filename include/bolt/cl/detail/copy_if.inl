@@ -0,0 +1,54 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_COPY_IF_INL )
+#define BOLT_CL_COPY_IF_INL
+#pragma once
+
+#include "bolt/cl/detail/compaction.inl"
+
+namespace bolt {
+    namespace cl {
+
+        template< typename InputIterator, typename OutputIterator, typename Predicate >
+        OutputIterator copy_if( bolt::cl::control &ctl,
+                                InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                Predicate pred,
+                                const std::string& cl_code )
+        {
+            size_t numKept = detail::compaction_detect_random_access( ctl, first, last, first, result, result,
+                detail::CompactionKeepIf< Predicate >( pred ), false, false, cl_code,
+                typename std::iterator_traits< InputIterator >::iterator_category( ) );
+            return result + numKept;
+        }
+
+        template< typename InputIterator, typename OutputIterator, typename Predicate >
+        OutputIterator copy_if( InputIterator first,
+                                InputIterator last,
+                                OutputIterator result,
+                                Predicate pred,
+                                const std::string& cl_code )
+        {
+            return bolt::cl::copy_if( bolt::cl::control::getDefault( ), first, last, result, pred, cl_code );
+        }
+
+    } // cl
+} // bolt
+
+#endif // BOLT_CL_COPY_IF_INL
@@ -20,15 +20,18 @@
 #pragma once
 
 #include <algorithm>
+#include <sstream>
 
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/functional.h"
 #ifdef ENABLE_TBB
 //TBB Includes
 #include "bolt/btbb/count.h"
+#include "bolt/cl/detail/host_split.inl"
 #endif
 
 
@@ -50,6 +53,7 @@ namespace detail {
             Count_KernelTemplateSpecializer() : KernelTemplateSpecializer()
                 {
                     addKernelName( "count_Template" );
+                    addKernelName( "count_FinalTemplate" );
                 }
 
             const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -57,14 +61,24 @@ namespace detail {
                 const std::string templateSpecializationString =
                         "// Host generates this instantiation string with user-specified value type and functor\n"
                         "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
-                        "__attribute__((reqd_work_group_size(256,1,1)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
                         "kernel void " + name(0) + "(\n"
                         "global " + typeNames[count_iValueType] + "* input_ptr,\n"
                          + typeNames[count_iIterType] + " output_iter,\n"
-                        "const int length,\n"
+                        "const BOLT_INDEX_T length,\n"
                         "global " + typeNames[count_predicate] + "* userFunctor,\n"
-                        "global int *result,\n"
-                        "local int *scratch_index\n"
+                        "global BOLT_INDEX_T *result,\n"
+                        "local BOLT_INDEX_T *scratch_index,\n"
+                        "BOLT_LEAF_PARAMS\n"
+                        ");\n\n"
+
+                        "// Host generates this instantiation string with user-specified value type and functor\n"
+                        "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                        "kernel void " + name(1) + "(\n"
+                        "global BOLT_INDEX_T *result,\n"
+                        "const int numPartials,\n"
+                        "local BOLT_INDEX_T *scratch_count\n"
                         ");\n\n";
 
                 return templateSpecializationString;
@@ -97,29 +111,39 @@ namespace detail {
                 //bool cpuDevice = ctl.device().getInfo<CL_DEVICE_TYPE>() == CL_DEVICE_TYPE_CPU;
                 /*\TODO - Do CPU specific kernel work group size selection here*/
                 //const size_t kernel0_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL02WAVES;
-                std::string compileOptions;
                 //std::ostringstream oss;
                 //oss << " -DKERNEL0WORKGROUPSIZE=" << kernel0_WgSize;
 
+                //  The counts are kept in BOLT_INDEX_T as well, so they cannot overflow
+                const size_t szElements = static_cast< size_t >( first.distance_to(last ) );
+                const kernelIndex index( szElements );
+                const size_t countSize = index.wide( ) ? sizeof( cl_ulong ) : sizeof( cl_uint );
+
+                const tuningParams defaultShape = { 256, 64, 8, 1 };
+                const tuningParams shape = findReduceTuning( ctl, "count", typeNames[count_iValueType], szElements,
+                    defaultShape );
+                const size_t wgSize = shape.wgSize;
+
+                std::ostringstream oss;
+                oss << " -DREDUCE_WG_SIZE=" << wgSize << index.compileOptions( );
+                std::string compileOptions = oss.str( );
+
                 Count_KernelTemplateSpecializer ts_kts;
+                static ProgramCacheSlot ts_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &ts_kts,
                     typeDefinitions,
                     count_kernels,
-                    compileOptions);
-
+                    compileOptions,
+                    &ts_ktsSlot );
 
-                // Set up shape of launch grid and buffers:
-                cl_uint computeUnits     = ctl.getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
-                int wgPerComputeUnit =  64; //ctl.getWGPerComputeUnit();
-                size_t numWG = computeUnits * wgPerComputeUnit;
 
                 cl_int l_Error = CL_SUCCESS;
-                const size_t wgSize  = 256; // kernels[0].getWorkGroupInfo< CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE >(
-                    //ctl.getDevice( ), &l_Error );
-                V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
+
+                // Set up shape of launch grid and buffers:
+                size_t numWG = reduceWorkGroups( ctl, szElements, shape );
 
                 // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
                 ALIGNED( 256 ) Predicate aligned_count( predicate );
@@ -133,21 +157,19 @@ namespace detail {
 
                 //::cl::Buffer result(ctl.context(), CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY, sizeof( iType ) * numWG);
 
-                control::buffPointer result = ctl.acquireBuffer( sizeof( int ) * numWG,
-                    CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY );
+                control::buffPointer result = ctl.acquireBuffer( countSize * numWG, CL_MEM_READ_WRITE );
 
-                cl_uint szElements = static_cast< cl_uint >( first.distance_to(last ) );
                  typename DVInputIterator::Payload  first_payload = first.gpuPayload();
-                V_OPENCL( kernels[0].setArg(0, first.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( detail::setIteratorLeaves( kernels[0], 0, 6, first ), "Error setting kernel argument" );
 
                 V_OPENCL( kernels[0].setArg(1, first.gpuPayloadSize( ), &first_payload),                    "Error setting a kernel argument" );
 
-                V_OPENCL( kernels[0].setArg(2, szElements), "Error setting kernel argument" );
+                V_OPENCL( index.setArg( kernels[0], 2, szElements ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(3, *userFunctor), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(4, *result), "Error setting kernel argument" );
 
                 ::cl::LocalSpaceArg loc2;
-                loc2.size_ = wgSize*sizeof(int);;
+                loc2.size_ = wgSize*countSize;
                 V_OPENCL( kernels[0].setArg(5, loc2), "Error setting kernel argument" );
 
 
@@ -158,36 +180,91 @@ namespace detail {
                     ::cl::NDRange(wgSize));
                 V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for count() kernel" );
 
-                ::cl::Event l_mapEvent;
-                int *h_result = (int*)ctl.getCommandQueue().enqueueMapBuffer(*result, false, CL_MAP_READ, 0,
-                    sizeof(int)*numWG, NULL, &l_mapEvent, &l_Error );
-                V_OPENCL( l_Error, "Error calling map on the result buffer" );
+                //  Sum the per-workgroup counts on the device
+                cl_int numPartials = static_cast< cl_int >( numWG );
+                V_OPENCL( kernels[1].setArg(0, *result), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(1, numPartials), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(2, loc2), "Error setting kernel argument" );
 
-                //  Finish the tail end of the reduction on host side; the compute device counts within the workgroups,
-                //  with one result per workgroup
-                size_t ceilNumWG = static_cast< size_t >( std::ceil( static_cast< float >( szElements ) / wgSize) );
-                bolt::cl::minimum<size_t>  count_size_t;
-                size_t numTailReduce = count_size_t( ceilNumWG, numWG );
+                l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                    kernels[1],
+                    ::cl::NullRange,
+                    ::cl::NDRange(wgSize),
+                    ::cl::NDRange(wgSize));
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for count() final kernel" );
 
-                bolt::cl::wait(ctl, l_mapEvent);
+                //  Only the total crosses back to the host
+                cl_uint narrowCount = 0;
+                cl_ulong wideCount = 0;
+                void* h_count = index.wide( ) ? static_cast< void* >( &wideCount ) : &narrowCount;
+                ::cl::Event l_readEvent;
+                V_OPENCL( ctl.getCommandQueue().enqueueReadBuffer(*result, CL_FALSE, 0, countSize, h_count, NULL,
+                    &l_readEvent ), "Error reading the result of count()" );
 
-                rType count =  h_result[0] ;
-                for(unsigned int i = 1; i < numTailReduce; ++i)
-                {
+                bolt::cl::wait(ctl, l_readEvent, "count");
 
-                   count +=  h_result[i];
+                rType count = static_cast< rType >( index.wide( ) ? wideCount : narrowCount );
+                return count;
+            }
 
-                }
+#ifdef ENABLE_TBB
+            template<typename InputIterator, typename Predicate>
+            struct CountHostPart
+            {
+                typedef typename bolt::cl::iterator_traits<InputIterator>::difference_type rType;
 
+                InputIterator first, last;
+                Predicate predicate;
+                rType result;
 
-				::cl::Event unmapEvent;
+                CountHostPart( const InputIterator& _first, const InputIterator& _last, const Predicate& _predicate ) :
+                    first( _first ), last( _last ), predicate( _predicate ), result( 0 ) { }
 
-				V_OPENCL( ctl.getCommandQueue().enqueueUnmapMemObject(*result,  h_result, NULL, &unmapEvent ),
-					"shared_ptr failed to unmap host memory back to device memory" );
-				V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+                void operator( )( ) { result = static_cast< rType >( bolt::btbb::count_if( first, last, predicate ) ); }
+            };
 
-                return count;
+            template<typename InputIterator, typename Predicate>
+            struct CountDevicePart
+            {
+                typedef typename std::iterator_traits<InputIterator>::value_type iType;
+                typedef typename bolt::cl::iterator_traits<InputIterator>::difference_type rType;
+
+                bolt::cl::control& ctl;
+                InputIterator first, last;
+                const Predicate& predicate;
+                const std::string& cl_code;
+                rType result;
+
+                CountDevicePart( bolt::cl::control& _ctl, const InputIterator& _first, const InputIterator& _last,
+                    const Predicate& _predicate, const std::string& _cl_code ) : ctl( _ctl ), first( _first ),
+                    last( _last ), predicate( _predicate ), cl_code( _cl_code ), result( 0 ) { }
+
+                void operator( )( )
+                {
+                    device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+                    result = count_enqueue( ctl, dvInput.begin(), dvInput.end(), predicate, cl_code );
+                }
+            };
+
+            //  Counts in the first hostLength elements with TBB while the device counts in the rest
+            template<typename InputIterator, typename Predicate>
+            typename bolt::cl::iterator_traits<InputIterator>::difference_type
+                count_host_split(bolt::cl::control &ctl,
+                const InputIterator& first,
+                const InputIterator& last,
+                const Predicate& predicate,
+                const std::string& cl_code,
+                size_t hostLength )
+            {
+                CountHostPart< InputIterator, Predicate > hostPart( first, first + hostLength, predicate );
+                CountDevicePart< InputIterator, Predicate > devicePart( ctl, first + hostLength, last, predicate,
+                                                                        cl_code );
+                host_split_run( "count", hostPart, hostLength, devicePart,
+                                static_cast< size_t >( last - first ) - hostLength );
+
+                return hostPart.result + devicePart.result;
             }
+#endif
 
            // This template is called after we detect random access iterators
             // This is called strictly for any non-device_vector iterator
@@ -210,11 +287,8 @@ namespace detail {
                 // What should we do if the run mode is automatic. Currently it goes to the last else statement
                 //How many threads we should spawn?
                 //Need to look at how to control the number of threads spawned.
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -224,6 +298,16 @@ namespace detail {
                 {
                 case bolt::cl::control::OpenCL :
                     {
+                    #ifdef ENABLE_TBB
+                    size_t hostLength = bolt::cl::hostSplitLength( ctl, "count", szElements );
+                    if( hostLength != 0 )
+                    {
+                        #if defined(BOLT_DEBUG_LOG)
+                        dblog->CodePathTaken(BOLTLOG::BOLT_COUNT,BOLTLOG::BOLT_HOST_SPLIT,"::Count::HOST_SPLIT");
+                        #endif
+                        return count_host_split( ctl, first, last, predicate, cl_code, hostLength );
+                    }
+                    #endif
 				    #if defined(BOLT_DEBUG_LOG)
                     dblog->CodePathTaken(BOLTLOG::BOLT_COUNT,BOLTLOG::BOLT_OPENCL_GPU,"::Count::OPENCL_GPU");
                     #endif
@@ -276,11 +360,8 @@ namespace detail {
                 if (szElements == 0)
                     return 0;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -353,11 +434,10 @@ namespace detail {
                 if (szElements == 0)
                     return 0;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements,
+                    sizeof( typename std::iterator_traits< DVInputIterator >::value_type ), false, true );
+                runMode = detail::iteratorRunMode( ctl, runMode, first, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -60,7 +60,7 @@ namespace detail {
                     "const " + typeNames[fill_T] + " src,\n"
                     "global " + typeNames[fill_Type] + " * dst,\n"
                      + typeNames[fill_DVInputIterator] + " input_iter,\n"
-                    "const uint numElements\n"
+                    "const BOLT_INDEX_T numElements\n"
                     ");\n\n";
 
                 return templateSpecializationString;
@@ -76,7 +76,7 @@ namespace detail {
                 const DVForwardIterator &last, const T & val, const std::string& cl_code)
             {
                 // how many elements to fill
-                cl_uint sz = static_cast< cl_uint >( std::distance( first, last ) );
+                size_t sz = static_cast< size_t >( std::distance( first, last ) );
                 if (sz < 1)
                     return;
 
@@ -104,9 +104,7 @@ namespace detail {
                 const size_t numWorkGroupsPerComputeUnit = ctl.getWGPerComputeUnit( );
                 const size_t numWorkGroups = numComputeUnits * numWorkGroupsPerComputeUnit;
 
-                const cl_uint numThreadsIdeal = static_cast<cl_uint>( numWorkGroups * workGroupSize );
-                cl_uint numElementsPerThread = sz/ numThreadsIdeal;
-                cl_uint numThreadsRUP = sz;
+                size_t numThreadsRUP = sz;
                 size_t mod = (sz& (workGroupSize-1));
                 int doBoundaryCheck = 0;
                 if( mod )
@@ -122,19 +120,23 @@ namespace detail {
                 std::string compileOptions;
                 std::ostringstream oss;
                 oss << " -DBOUNDARY_CHECK=" << doBoundaryCheck;
+                const kernelIndex index( sz );
+                oss << index.compileOptions( );
                 compileOptions = oss.str();
 
                 /**********************************************************************************
                  * Request Compiled Kernels
                  *********************************************************************************/
                 Fill_KernelTemplateSpecializer c_kts;
+                static ProgramCacheSlot c_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &c_kts,
                     typeDefs,
                     fill_kernels,
-                    compileOptions);
+                    compileOptions,
+                    &c_ktsSlot );
 
                 /**********************************************************************************
                  *  Kernel
@@ -143,8 +145,8 @@ namespace detail {
                 typename DVForwardIterator::Payload  first_payload = first.gpuPayload( );
                 try
                 {
-                    cl_uint numThreadsChosen;
-                    cl_uint workGroupSizeChosen = workGroupSize;
+                    size_t numThreadsChosen;
+                    size_t workGroupSizeChosen = workGroupSize;
                     numThreadsChosen = numThreadsRUP;
 
                     //std::cout << "NumElem: " << sz<< "; NumThreads: " << numThreadsChosen << ";
@@ -158,7 +160,7 @@ namespace detail {
                     V_OPENCL( kernels[0].setArg( 2, first.gpuPayloadSize( ),&first_payload ),
                         "Error setting a kernel argument" );
                     // Size of buffer
-                    V_OPENCL( kernels[0].setArg( 3, static_cast<cl_uint>( sz) ), "Error setArg kernels[ 0 ]" );
+                    V_OPENCL( index.setArg( kernels[0], 3, sz ), "Error setArg kernels[ 0 ]" );
 
                     l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
                         kernels[0],
@@ -178,7 +180,7 @@ namespace detail {
                 }
 
                 // wait for results
-                bolt::cl::wait(ctl, kernelEvent);
+                bolt::cl::deferredWait(ctl, kernelEvent, "fill");
 
 
                 // profiling
@@ -186,7 +188,7 @@ namespace detail {
                 l_Error = ctl.getCommandQueue().getInfo<cl_command_queue_properties>(CL_QUEUE_PROPERTIES,
                     &queueProperties);
                 unsigned int profilingEnabled = queueProperties&CL_QUEUE_PROFILING_ENABLE;
-                if ( profilingEnabled ) {
+                if ( profilingEnabled && ctl.getWaitMode( ) != bolt::cl::control::NoWait ) {
                     cl_ulong start_time, stop_time;
 
                     V_OPENCL( kernelEvent.getProfilingInfo<cl_ulong>(CL_PROFILING_COMMAND_START, &start_time),
@@ -225,11 +227,8 @@ namespace detail {
                 if (sz < 1)
                     return;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( Type ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
       
 	            #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -279,11 +278,9 @@ namespace detail {
             {
 
                 typedef typename std::iterator_traits<DVForwardIterator>::value_type iType;
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first, last ) ), sizeof( iType ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -384,10 +381,11 @@ namespace detail {
             const T & value,
             const std::string& cl_code )
         {
+            typedef typename std::iterator_traits< OutputIterator >::difference_type difference_type;
             detail::fill_detect_random_access( bolt::cl::control::getDefault(),
-                first, first+static_cast< const int >( n ),
+                first, first+static_cast< difference_type >( n ),
                 value, cl_code, typename std::iterator_traits< OutputIterator >::iterator_category( ) );
-            return first+static_cast< const int >( n );
+            return first+static_cast< difference_type >( n );
         }
 
         // user specified control, start-> +n
@@ -398,9 +396,10 @@ namespace detail {
             const T & value,
             const std::string& cl_code )
         {
-            detail::fill_detect_random_access( ctl, first, first+static_cast< const int >( n ), value, cl_code,
+            typedef typename std::iterator_traits< OutputIterator >::difference_type difference_type;
+            detail::fill_detect_random_access( ctl, first, first+static_cast< difference_type >( n ), value, cl_code,
                 typename std::iterator_traits< OutputIterator >::iterator_category( ) );
-            return (first+static_cast< const int >( n ));
+            return (first+static_cast< difference_type >( n ));
         }
 
     }//end of cl namespace
@@ -27,6 +27,7 @@
 #endif
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/device_vector.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 #include "bolt/cl/functional.h"
@@ -56,8 +57,8 @@ void serial_gather(InputIterator1 mapfirst,
    iType1 temp;
    for(size_t iter = 0; iter < numElements; iter++)
    {
-                   temp = *(mapfirst + (int)iter);
-                  *(result + (int)iter) = *(input + (int)temp);
+                   temp = *(mapfirst + iter);
+                  *(result + iter) = *(input + temp);
    }
 }
 
@@ -77,8 +78,8 @@ void serial_gather_if(InputIterator1 mapfirst,
    size_t numElements = static_cast< size_t >( std::distance( mapfirst, maplast ) );
    for(size_t iter = 0; iter < numElements; iter++)
    {
-       if(stencil[(int)iter]== 1)
-            result[(int)iter] = *(input + mapfirst[(int)iter]);
+       if(stencil[iter]== 1)
+            result[iter] = *(input + mapfirst[iter]);
    }
 }
 
@@ -96,7 +97,7 @@ void serial_gather_if(InputIterator1 mapfirst,
                       BinaryPredicate pred)
 {
    //std::cout<<"Serial code path ... \n";
-   unsigned int numElements = static_cast< unsigned int >( std::distance( mapfirst, maplast ) );
+   size_t numElements = static_cast< size_t >( std::distance( mapfirst, maplast ) );
   // for (InputIterator1 iter = mapfirst; iter != maplast; iter++)
   // {
   //      if(pred(*(stencil + ( iter - mapfirst))))
@@ -105,10 +106,10 @@ void serial_gather_if(InputIterator1 mapfirst,
         //	 *(result + (iter - mapfirst) )= input[*iter];
         //}
   // }
-      for(unsigned int iter = 0; iter < numElements; iter++)
+      for(size_t iter = 0; iter < numElements; iter++)
    {
-        if(pred(*(stencil + (int)iter)))
-             result[(int)iter] = input[mapfirst[(int)iter]];
+        if(pred(*(stencil + iter)))
+             result[iter] = input[mapfirst[iter]];
    }
 }
 
@@ -145,7 +146,7 @@ public:
         + gatherIfKernels[gather_if_DVInputIterator] + " inputIter, \n"
         "global " + gatherIfKernels[gather_if_resultType] + "* result, \n"
         + gatherIfKernels[gather_if_DVResultType] + " resultIter, \n"
-        "const uint length, \n"
+        "const BOLT_INDEX_T length, \n"
         "global " + gatherIfKernels[gather_if_Predicate] + "* functor);\n\n";
 
         return templateSpecializationString;
@@ -181,7 +182,7 @@ public:
         + gatherKernels[gather_DVInputIterator] + " inputIter, \n"
         "global " + gatherKernels[gather_resultType] + "* result, \n"
         + gatherKernels[gather_DVResultType] + " resultIter, \n"
-        "const uint length ); \n";
+        "const BOLT_INDEX_T length ); \n";
 
         return templateSpecializationString;
     }
@@ -211,7 +212,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator3>::value_type iType3;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >(  map_first.distance_to(map_last) );
+        size_t distVec = static_cast< size_t >(  map_first.distance_to(map_last) );
         if( distVec == 0 )
             return;
 
@@ -283,19 +284,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
           * Request Compiled Kernels
           *********************************************************************************/
          GatherIf_KernelTemplateSpecializer s_if_kts;
+         static ProgramCacheSlot s_if_ktsSlot;
          std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
              ctl,
              gatherIfKernels,
              &s_if_kts,
              typeDefinitions,
              gather_kernels,
-             compileOptions);
+             compileOptions,
+             &s_if_ktsSlot );
          // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
         ALIGNED( 256 ) Predicate aligned_binary( pred );
@@ -315,7 +320,7 @@ public:
         kernels[boundsCheck].setArg( 5, input.gpuPayloadSize( ), &input_payload );
         kernels[boundsCheck].setArg( 6, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg( 7, result.gpuPayloadSize( ),&result_payload );
-        kernels[boundsCheck].setArg( 8, distVec );
+        index.setArg( kernels[boundsCheck], 8, distVec );
         kernels[boundsCheck].setArg( 9, *userPredicate );
 
         ::cl::Event gatherIfEvent;
@@ -328,7 +333,7 @@ public:
             &gatherIfEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for gather_if() kernel" );
 
-        ::bolt::cl::wait(ctl, gatherIfEvent);
+        ::bolt::cl::deferredWait(ctl, gatherIfEvent, "gather_if");
 
     };
 
@@ -349,7 +354,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator2>::value_type iType2;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >(  map_first.distance_to(map_last) );
+        size_t distVec = static_cast< size_t >(  map_first.distance_to(map_last) );
         if( distVec == 0 )
             return;
 
@@ -414,19 +419,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
           * Request Compiled Kernels
           *********************************************************************************/
          GatherKernelTemplateSpecializer s_kts;
+         static ProgramCacheSlot s_ktsSlot;
          std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
              ctl,
              gatherKernels,
              &s_kts,
              typeDefinitions,
              gather_kernels,
-             compileOptions);
+             compileOptions,
+             &s_ktsSlot );
          // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
        typename DVInputIterator1::Payload   map_payload = map_first.gpuPayload( );
@@ -439,7 +448,7 @@ public:
         kernels[boundsCheck].setArg( 3, input.gpuPayloadSize( ),&input_payload );
         kernels[boundsCheck].setArg( 4, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg( 5, result.gpuPayloadSize( ), &result_payload );
-        kernels[boundsCheck].setArg( 6, distVec );
+        index.setArg( kernels[boundsCheck], 6, distVec );
 
         ::cl::Event gatherEvent;
         l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
@@ -451,7 +460,7 @@ public:
             &gatherEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for gather_if() kernel" );
 
-        ::bolt::cl::wait(ctl, gatherEvent);
+        ::bolt::cl::deferredWait(ctl, gatherEvent, "gather");
 
     };
 
@@ -497,11 +506,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -581,11 +587,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, stencilFancyIter );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -663,11 +667,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancymapFirst );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -748,11 +750,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -833,11 +832,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -905,11 +901,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, firstFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -979,11 +973,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, inputFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1051,11 +1043,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1123,11 +1112,9 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, firstFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1192,11 +1179,9 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancyInpt );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1264,11 +1249,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1339,11 +1321,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
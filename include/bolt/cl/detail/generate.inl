@@ -59,21 +59,21 @@ class Generate_KernelTemplateSpecializer : public KernelTemplateSpecializer
                 "kernel void "+name(0)+"(\n"
                 "global " + typeNames[gen_oType] + " * restrict dst,\n"
                  + typeNames[generate_DVInputIterator] + " input_iter,\n"
-                "const int numElements,\n"
+                "const BOLT_INDEX_T numElements,\n"
                 "global " + typeNames[gen_genType] + " * restrict genPtr);\n\n"
 
                         "// Host generates this instantiation string with user-specified value type and generator\n"
                 "template __attribute__((mangled_name("+name(1)+"Instantiated)))\n"
                 "kernel void "+name(1)+"(\n"
                 "global " + typeNames[gen_oType] + " * restrict dst,\n"
-                "const int numElements,\n"
+                "const BOLT_INDEX_T numElements,\n"
                 "global " + typeNames[gen_genType] + " * restrict genPtr);\n\n"
 
                         "// Host generates this instantiation string with user-specified value type and generator\n"
                 "template __attribute__((mangled_name("+name(2)+"Instantiated)))\n"
                 "kernel void "+name(2)+"(\n"
                 "global " + typeNames[gen_oType] + " * restrict dst,\n"
-                "const int numElements,\n"
+                "const BOLT_INDEX_T numElements,\n"
                 "global " + typeNames[gen_genType] + " * restrict genPtr);\n\n"
                 ;
 
@@ -122,15 +122,15 @@ aProfiler.set(AsyncProfiler::device, control::SerialCpu);
     /**********************************************************************************
      * Number of Threads
      *********************************************************************************/
-    const cl_uint numElements = static_cast< cl_uint >( std::distance( first, last ) );
+    const size_t numElements = static_cast< size_t >( std::distance( first, last ) );
     if (numElements < 1) return;
     const size_t workGroupSize  = 256;
     const size_t numComputeUnits = ctrl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( ); // = 28
     const size_t numWorkGroupsPerComputeUnit = ctrl.getWGPerComputeUnit( );
     const size_t numWorkGroupsIdeal = numComputeUnits * numWorkGroupsPerComputeUnit;
-    const cl_uint numThreadsIdeal = static_cast<cl_uint>( numWorkGroupsIdeal * workGroupSize );
+    const size_t numThreadsIdeal = numWorkGroupsIdeal * workGroupSize;
     int doBoundaryCheck = 0;
-    cl_uint numThreadsRUP = numElements;
+    size_t numThreadsRUP = numElements;
     size_t mod = (numElements & (workGroupSize-1));
     if( mod )
             {
@@ -146,19 +146,23 @@ aProfiler.set(AsyncProfiler::device, control::SerialCpu);
     std::ostringstream oss;
     oss << " -DBURST=" << BURST;
     oss << " -DBOUNDARY_CHECK=" << doBoundaryCheck;
+    const kernelIndex index( numElements );
+    oss << index.compileOptions( );
     compileOptions = oss.str();
 
     /**********************************************************************************
      * Request Compiled Kernels
      *********************************************************************************/
     Generate_KernelTemplateSpecializer kts;
+    static ProgramCacheSlot ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctrl,
         typeNames,
         &kts,
         typeDefs,
         generate_kernels,
-        compileOptions);
+        compileOptions,
+        &ktsSlot );
 
 #ifdef BOLT_ENABLE_PROFILING
 aProfiler.nextStep();
@@ -182,8 +186,8 @@ aProfiler.set(AsyncProfiler::device, control::SerialCpu);
 #endif
 
     int whichKernel = 0;
-    cl_uint numThreadsChosen;
-    cl_uint workGroupSizeChosen = workGroupSize;
+    size_t numThreadsChosen;
+    size_t workGroupSizeChosen = workGroupSize;
     switch( whichKernel )
     {
     case 0: // I: thread per element
@@ -201,7 +205,7 @@ aProfiler.set(AsyncProfiler::device, control::SerialCpu);
     V_OPENCL( kernels[whichKernel].setArg( 0, first.getContainer().getBuffer()),"Error setArg kernels[0]");//I/P Buffer
     V_OPENCL( kernels[whichKernel].setArg( 1, first.gpuPayloadSize( ),&first_payload),
         "Error setting a kernel argument" );
-    V_OPENCL( kernels[whichKernel].setArg( 2, numElements),         "Error setArg kernels[ 0 ]" ); // Size of buffer
+    V_OPENCL( index.setArg( kernels[whichKernel], 2, numElements ), "Error setArg kernels[ 0 ]" ); // Size of buffer
     V_OPENCL( kernels[whichKernel].setArg( 3, *userGenerator ),     "Error setArg kernels[ 0 ]" ); // Generator
 
 #ifdef BOLT_ENABLE_PROFILING
@@ -228,7 +232,7 @@ aProfiler.set(AsyncProfiler::memory, 1*numElements*sizeof(oType)
                 V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for generate() kernel" );
 
                 // wait to kernel completion
-    bolt::cl::wait(ctrl, generateEvent);
+    bolt::cl::deferredWait(ctrl, generateEvent, "generate");
 #if 0
 #ifdef BOLT_ENABLE_PROFILING
 aProfiler.nextStep();
@@ -288,7 +292,7 @@ aProfiler.stopTrial();
     cl_command_queue_properties queueProperties;
     l_Error = ctrl.getCommandQueue().getInfo<cl_command_queue_properties>(CL_QUEUE_PROPERTIES, &queueProperties);
     unsigned int profilingEnabled = queueProperties&CL_QUEUE_PROFILING_ENABLE;
-    if (1 && profilingEnabled) {
+    if ( profilingEnabled && ctrl.getWaitMode( ) != bolt::cl::control::NoWait ) {
         cl_ulong start_time, stop_time;
         l_Error = generateEvent.getProfilingInfo<cl_ulong>(CL_PROFILING_COMMAND_START, &start_time);
         V_OPENCL( l_Error, "failed on getProfilingInfo<CL_PROFILING_COMMAND_START>()");
@@ -322,11 +326,8 @@ aProfiler.stopTrial();
                 if (sz < 1)
                     return;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( Type ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -376,11 +377,9 @@ aProfiler.stopTrial();
                 const Generator &gen, const std::string& user_code, bolt::cl::device_vector_tag )
             {
                 typedef typename std::iterator_traits<DVForwardIterator>::value_type iType;
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first, last ) ), sizeof( iType ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -476,9 +475,10 @@ void generate( bolt::cl::control &ctl, ForwardIterator first, ForwardIterator la
 template<typename OutputIterator, typename Size, typename Generator>
 OutputIterator generate_n( OutputIterator first, Size n, Generator gen, const std::string& cl_code)
 {
-            detail::generate_detect_random_access( bolt::cl::control::getDefault(), first, first+static_cast< const int >( n ), gen, cl_code,
+            typedef typename std::iterator_traits< OutputIterator >::difference_type difference_type;
+            detail::generate_detect_random_access( bolt::cl::control::getDefault(), first, first+static_cast< difference_type >( n ), gen, cl_code,
             typename std::iterator_traits< OutputIterator >::iterator_category( ) );
-            return (first+static_cast< const int >( n ));
+            return (first+static_cast< difference_type >( n ));
 }
 
 // user specified control, start-> +n
@@ -486,9 +486,10 @@ template<typename OutputIterator, typename Size, typename Generator>
 OutputIterator generate_n( bolt::cl::control &ctl, OutputIterator first, Size n, Generator gen,
                           const std::string& cl_code)
 {
-            detail::generate_detect_random_access( ctl, first, first+static_cast< const int >( n ), gen, cl_code,
+            typedef typename std::iterator_traits< OutputIterator >::difference_type difference_type;
+            detail::generate_detect_random_access( ctl, first, first+static_cast< difference_type >( n ), gen, cl_code,
             typename std::iterator_traits< OutputIterator >::iterator_category( ) );
-            return (first+static_cast< const int >( n ));
+            return (first+static_cast< difference_type >( n ));
 }
 
 }//end of cl namespace
@@ -0,0 +1,543 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  histogram and bincount.
+ *
+ *  Both map every element to a bin with a binner, HistogramEvenBins or
+ *  HistogramBincount, which returns numBins for elements that are not counted.
+ *  The binner is called as binner( x ) on the host and selects HISTOGRAM_MODE on
+ *  the device, where histogramBin makes the same decision.
+ *****************************************************************************/
+
+#if !defined( BOLT_CL_HISTOGRAM_INL )
+#define BOLT_CL_HISTOGRAM_INL
+#pragma once
+
+#define HISTOGRAM_WGSIZE 256
+#define HISTOGRAM_WAVES_PER_CU 8
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/functional.h"
+#include "bolt/cl/copy.h"
+#include "bolt/cl/sort.h"
+#include "bolt/cl/binary_search.h"
+#include "bolt/cl/iterator/counting_iterator.h"
+
+#if defined(ENABLE_TBB)
+#include "bolt/btbb/histogram.h"
+#endif
+
+namespace bolt {
+namespace cl {
+namespace detail {
+
+    /*  floor( d * n / range ) for d < range, also where d * n does not fit in 64 bits; histogramBin in
+     *  histogram_kernels.cl computes the same with mul_hi.  */
+    inline cl_ulong histogramScaledBin( cl_ulong d, cl_ulong n, cl_ulong range )
+    {
+        //  The 128 bit product hi:lo, from 32 bit halves
+        cl_ulong dLo = d & 0xFFFFFFFFull, dHi = d >> 32;
+        cl_ulong nLo = n & 0xFFFFFFFFull, nHi = n >> 32;
+        cl_ulong ll = dLo * nLo, lh = dLo * nHi, hl = dHi * nLo;
+        cl_ulong mid = ( ll >> 32 ) + ( lh & 0xFFFFFFFFull ) + ( hl & 0xFFFFFFFFull );
+        cl_ulong lo = ( mid << 32 ) | ( ll & 0xFFFFFFFFull );
+        cl_ulong hi = dHi * nHi + ( lh >> 32 ) + ( hl >> 32 ) + ( mid >> 32 );
+        if( hi == 0 )
+            return lo / range;
+
+        //  d < range keeps hi below range, so the quotient has 64 bits; long division over the bits of lo
+        cl_ulong rem = hi;
+        cl_ulong bin = 0;
+        for( int b = 63; b >= 0; --b )
+        {
+            cl_ulong carry = rem >> 63;
+            rem = ( rem << 1 ) | ( ( lo >> b ) & 1 );
+            bin <<= 1;
+            if( carry || rem >= range )
+            {
+                rem -= range;
+                bin |= 1;
+            }
+        }
+        return bin;
+    }
+
+    /*  numBins bins of equal width over [lower, upper).  Integral types are binned exactly, with a 128 bit
+     *  product where the range is too wide for 64 bits; floating point types multiply by a scale that is
+     *  computed once, since OpenCL does not round a division as the host does.  */
+    template< typename T >
+    struct HistogramEvenBins
+    {
+        enum { histogramMode = 0 };
+
+        T lower;
+        T upper;
+        T scale;
+        size_t numBins;
+
+        HistogramEvenBins( const T& _lower, const T& _upper, size_t _numBins ) : lower( _lower ), upper( _upper ),
+            scale( std::is_integral< T >::value ? T( 0 ) : static_cast< T >( _numBins ) / ( _upper - _lower ) ),
+            numBins( _numBins ) { }
+
+        size_t operator()( const T& x ) const
+        {
+            if( !( x >= lower ) || !( x < upper ) )
+                return numBins;
+            cl_ulong bin = binOf( x, typename std::is_integral< T >::type( ) );
+            return static_cast< size_t >( ( std::min )( bin, static_cast< cl_ulong >( numBins - 1 ) ) );
+        }
+
+    private:
+        cl_ulong binOf( const T& x, std::true_type ) const
+        {
+            return histogramScaledBin( static_cast< cl_ulong >( x ) - static_cast< cl_ulong >( lower ),
+                static_cast< cl_ulong >( numBins ), static_cast< cl_ulong >( upper ) - static_cast< cl_ulong >( lower ) );
+        }
+
+        cl_ulong binOf( const T& x, std::false_type ) const
+        {
+            return static_cast< cl_ulong >( ( x - lower ) * scale );
+        }
+    };
+
+    /*  The integers 0 ... numBins - 1; lower, upper and scale only keep the kernel signature of
+     *  HistogramEvenBins.  */
+    template< typename T >
+    struct HistogramBincount
+    {
+        enum { histogramMode = 1 };
+
+        T lower;
+        T upper;
+        T scale;
+        size_t numBins;
+
+        HistogramBincount( size_t _numBins ) : lower( 0 ), upper( 0 ), scale( 0 ), numBins( _numBins ) { }
+
+        size_t operator()( const T& x ) const
+        {
+            return ( static_cast< cl_ulong >( x ) < numBins ) ? static_cast< size_t >( x ) : numBins;
+        }
+    };
+
+    /*  Serial histogram; the counts are written to bins_first, which receives binner.numBins entries  */
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_serial( InputIterator first, InputIterator last, OutputIterator bins_first,
+                                     const Binner& binner )
+    {
+        //  The extra entry collects the elements outside the bins
+        std::vector< size_t > counts( binner.numBins + 1, 0 );
+        for( ; first != last; ++first )
+            ++counts[ binner( *first ) ];
+
+        for( size_t b = 0; b < binner.numBins; ++b, ++bins_first )
+            *bins_first = static_cast< typename std::iterator_traits< OutputIterator >::value_type >( counts[ b ] );
+        return bins_first;
+    }
+
+    /*  Host counts for the SerialCpu and MultiCoreCpu paths.  They are collected in a std::vector and written
+     *  out with bolt::cl::copy, which also serves device_vector outputs.  */
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_cpu( bolt::cl::control &ctl, bolt::cl::control::e_RunMode runMode,
+                                  InputIterator first, InputIterator last, OutputIterator bins_first,
+                                  const Binner& binner )
+    {
+        typedef typename std::iterator_traits< OutputIterator >::value_type oType;
+
+        std::vector< oType > counts( binner.numBins );
+        if( runMode == bolt::cl::control::SerialCpu )
+        {
+            histogram_serial( first, last, counts.begin( ), binner );
+        }
+        else
+        {
+            #if defined( ENABLE_TBB )
+                bolt::btbb::detail::histogram( first, last, counts.begin( ), binner );
+            #else
+                throw std::runtime_error( "The MultiCoreCpu version of histogram is not enabled to be built! \n" );
+            #endif
+        }
+
+        return bolt::cl::copy( ctl, counts.begin( ), counts.end( ), bins_first );
+    }
+
+    enum histogramTypeName { hist_iType, hist_iIterType, hist_end };
+
+    class Histogram_KernelTemplateSpecializer : public KernelTemplateSpecializer
+    {
+    public:
+        Histogram_KernelTemplateSpecializer( ) : KernelTemplateSpecializer( )
+        {
+            addKernelName( "histogramLocal" );
+            addKernelName( "histogramBinIndex" );
+            addKernelName( "histogramDiff" );
+        }
+
+        const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
+        {
+            const std::string templateSpecializationString =
+                "// Host generates this instantiation string with user-specified value type\n"
+                "template __attribute__((mangled_name(" + name( 0 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(HISTOGRAM_WG_SIZE,1,1)))\n"
+                "kernel void histogramLocal(\n"
+                "global " + typeNames[ hist_iType ] + "* input_ptr,\n"
+                + typeNames[ hist_iIterType ] + " input_iter,\n"
+                "const uint numElements,\n"
+                "const " + typeNames[ hist_iType ] + " lower,\n"
+                "const " + typeNames[ hist_iType ] + " upper,\n"
+                "const " + typeNames[ hist_iType ] + " scale,\n"
+                "const uint numBins,\n"
+                "global uint* bins,\n"
+                "local uint* localBins\n"
+                ");\n\n"
+
+                "// Host generates this instantiation string with user-specified value type\n"
+                "template __attribute__((mangled_name(" + name( 1 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(HISTOGRAM_WG_SIZE,1,1)))\n"
+                "kernel void histogramBinIndex(\n"
+                "global " + typeNames[ hist_iType ] + "* input_ptr,\n"
+                + typeNames[ hist_iIterType ] + " input_iter,\n"
+                "const uint numElements,\n"
+                "const " + typeNames[ hist_iType ] + " lower,\n"
+                "const " + typeNames[ hist_iType ] + " upper,\n"
+                "const " + typeNames[ hist_iType ] + " scale,\n"
+                "const uint numBins,\n"
+                "global uint* binIndex\n"
+                ");\n\n";
+
+            return templateSpecializationString;
+        }
+    };
+
+    /*! \brief Device histogram; adds the count of every bin of binner to counts, which must hold
+     *  binner.numBins zeroes.
+     *  \details With the bins in local memory a single launch reads the input once.  Otherwise the bin
+     *  indices are written out, sorted and the end of every bin is found by a vectorized upper_bound over
+     *  0 ... numBins - 1; the out of range index numBins sorts behind all bins and drops out.
+     */
+    template< typename DVInputIterator, typename Binner >
+    void histogram_enqueue( bolt::cl::control &ctl, const DVInputIterator& first, const DVInputIterator& last,
+                            const Binner& binner, device_vector< cl_uint >& counts, const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< DVInputIterator >::value_type iType;
+
+        cl_uint numElements = static_cast< cl_uint >( std::distance( first, last ) );
+        cl_uint numBins = static_cast< cl_uint >( binner.numBins );
+        if( numElements == 0 || numBins == 0 )
+            return;
+
+        std::vector< std::string > typeNames( hist_end );
+        typeNames[ hist_iType ] = TypeName< iType >::get( );
+        typeNames[ hist_iIterType ] = TypeName< DVInputIterator >::get( );
+
+        std::vector< std::string > typeDefinitions;
+        PUSH_BACK_UNIQUE( typeDefinitions, cl_code )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< iType >::get( ) )
+        PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVInputIterator >::get( ) )
+
+        std::ostringstream oss;
+        oss << " -DHISTOGRAM_MODE=" << static_cast< int >( Binner::histogramMode )
+            << " -DHISTOGRAM_INTEGRAL=" << ( std::is_integral< iType >::value ? 1 : 0 );
+        std::string compileOptions = oss.str( );
+
+        Histogram_KernelTemplateSpecializer histogram_kts;
+        static ProgramCacheSlot histogram_ktsSlot;
+        std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+            ctl,
+            typeNames,
+            &histogram_kts,
+            typeDefinitions,
+            histogram_kernels,
+            compileOptions,
+            &histogram_ktsSlot );
+
+        ::cl::Kernel localKernel    = kernels[ 0 ];
+        ::cl::Kernel binIndexKernel = kernels[ 1 ];
+        ::cl::Kernel diffKernel     = kernels[ 2 ];
+
+        //  Enough work-groups to fill the device; each loops over the input with the grid as stride, so the
+        //  per work-group cost of clearing and merging the bins is paid a bounded number of times
+        cl_uint computeUnits = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
+        cl_ulong localMemSize = ctl.getDevice( ).getInfo< CL_DEVICE_LOCAL_MEM_SIZE >( );
+        cl_uint numTiles = ( numElements + HISTOGRAM_WGSIZE - 1 ) / HISTOGRAM_WGSIZE;
+        cl_uint numWG = ( std::min )( numTiles, computeUnits * HISTOGRAM_WAVES_PER_CU );
+
+        typename DVInputIterator::Payload input_payload = first.gpuPayload( );
+
+        ::cl::CommandQueue& myCQ = ctl.getCommandQueue( );
+        cl_int l_Error = CL_SUCCESS;
+
+        if( static_cast< cl_ulong >( numBins ) * sizeof( cl_uint ) <= localMemSize )
+        {
+            ::cl::LocalSpaceArg localBins;
+            localBins.size_ = numBins * sizeof( cl_uint );
+
+            V_OPENCL( localKernel.setArg( 0, first.getContainer( ).getBuffer( ) ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 1, first.gpuPayloadSize( ), &input_payload ),
+                      "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 2, numElements ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 3, binner.lower ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 4, binner.upper ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 5, binner.scale ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 6, numBins ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 7, counts.getBuffer( ) ), "Error setting a kernel argument" );
+            V_OPENCL( localKernel.setArg( 8, localBins ), "Error setting a kernel argument" );
+            l_Error = myCQ.enqueueNDRangeKernel( localKernel, ::cl::NullRange,
+                                                 ::cl::NDRange( numWG * HISTOGRAM_WGSIZE ),
+                                                 ::cl::NDRange( HISTOGRAM_WGSIZE ), NULL, NULL );
+            V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for histogramLocal kernel" );
+            return;
+        }
+
+        device_vector< cl_uint > binIndex( numElements, cl_uint( 0 ), CL_MEM_READ_WRITE, false, ctl );
+        V_OPENCL( binIndexKernel.setArg( 0, first.getContainer( ).getBuffer( ) ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 1, first.gpuPayloadSize( ), &input_payload ),
+                  "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 2, numElements ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 3, binner.lower ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 4, binner.upper ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 5, binner.scale ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 6, numBins ), "Error setting a kernel argument" );
+        V_OPENCL( binIndexKernel.setArg( 7, binIndex.getBuffer( ) ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( binIndexKernel, ::cl::NullRange,
+                                             ::cl::NDRange( numWG * HISTOGRAM_WGSIZE ),
+                                             ::cl::NDRange( HISTOGRAM_WGSIZE ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for histogramBinIndex kernel" );
+
+        bolt::cl::sort( ctl, binIndex.begin( ), binIndex.end( ) );
+
+        device_vector< cl_uint > upperBounds( numBins, cl_uint( 0 ), CL_MEM_READ_WRITE, false, ctl );
+        vectorized_search_enqueue( ctl, binIndex.begin( ), binIndex.end( ), bolt::cl::counting_iterator< cl_uint >( 0 ),
+                                   bolt::cl::counting_iterator< cl_uint >( numBins ), upperBounds.begin( ),
+                                   bolt::cl::less< cl_uint >( ), "", search_upperBound );
+
+        cl_uint numBinTiles = ( numBins + HISTOGRAM_WGSIZE - 1 ) / HISTOGRAM_WGSIZE;
+        cl_uint numDiffWG = ( std::min )( numBinTiles, computeUnits * HISTOGRAM_WAVES_PER_CU );
+        V_OPENCL( diffKernel.setArg( 0, upperBounds.getBuffer( ) ), "Error setting a kernel argument" );
+        V_OPENCL( diffKernel.setArg( 1, numBins ), "Error setting a kernel argument" );
+        V_OPENCL( diffKernel.setArg( 2, counts.getBuffer( ) ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( diffKernel, ::cl::NullRange,
+                                             ::cl::NDRange( numDiffWG * HISTOGRAM_WGSIZE ),
+                                             ::cl::NDRange( HISTOGRAM_WGSIZE ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for histogramDiff kernel" );
+    }
+
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_pick_iterator( bolt::cl::control &ctl, const InputIterator& first,
+                                            const InputIterator& last, const OutputIterator& bins_first,
+                                            const Binner& binner, const std::string& cl_code,
+                                            std::random_access_iterator_tag )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+
+        size_t numElements = static_cast< size_t >( std::distance( first, last ) );
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( iType ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_SERIAL_CPU, "::Histogram::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Histogram::MULTICORE_CPU" );
+            #endif
+            return histogram_cpu( ctl, runMode, first, last, bins_first, binner );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_OPENCL_GPU, "::Histogram::OPENCL_GPU" );
+        #endif
+
+        device_vector< cl_uint > counts( binner.numBins, cl_uint( 0 ), CL_MEM_READ_WRITE, true, ctl );
+        if( numElements != 0 )
+        {
+            //  The input is read once, so it is used in place
+            device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+            histogram_enqueue( ctl, dvInput.begin( ), dvInput.end( ), binner, counts, cl_code );
+        }
+
+        return bolt::cl::copy( ctl, counts.begin( ), counts.end( ), bins_first );
+    }
+
+    template< typename DVInputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_pick_iterator( bolt::cl::control &ctl, const DVInputIterator& first,
+                                            const DVInputIterator& last, const OutputIterator& bins_first,
+                                            const Binner& binner, const std::string& cl_code,
+                                            bolt::cl::device_vector_tag )
+    {
+        typedef typename std::iterator_traits< DVInputIterator >::value_type iType;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+            static_cast< size_t >( std::distance( first, last ) ), sizeof( iType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_SERIAL_CPU, "::Histogram::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Histogram::MULTICORE_CPU" );
+            #endif
+            typename bolt::cl::device_vector< iType >::pointer inputPtr = first.getContainer( ).data( );
+            return histogram_cpu( ctl, runMode, &inputPtr[ first.m_Index ], &inputPtr[ last.m_Index ], bins_first,
+                                  binner );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_OPENCL_GPU, "::Histogram::OPENCL_GPU" );
+        #endif
+
+        device_vector< cl_uint > counts( binner.numBins, cl_uint( 0 ), CL_MEM_READ_WRITE, true, ctl );
+        histogram_enqueue( ctl, first, last, binner, counts, cl_code );
+        return bolt::cl::copy( ctl, counts.begin( ), counts.end( ), bins_first );
+    }
+
+    //  Fancy iterators are read in place on the device and through their host interface otherwise
+    template< typename DVInputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_pick_iterator( bolt::cl::control &ctl, const DVInputIterator& first,
+                                            const DVInputIterator& last, const OutputIterator& bins_first,
+                                            const Binner& binner, const std::string& cl_code,
+                                            bolt::cl::fancy_iterator_tag )
+    {
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+            static_cast< size_t >( std::distance( first, last ) ),
+            sizeof( typename std::iterator_traits< DVInputIterator >::value_type ), false );
+        runMode = detail::iteratorRunMode( ctl, runMode, first );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_SERIAL_CPU, "::Histogram::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Histogram::MULTICORE_CPU" );
+            #endif
+            return histogram_cpu( ctl, runMode, first, last, bins_first, binner );
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_HISTOGRAM, BOLTLOG::BOLT_OPENCL_GPU, "::Histogram::OPENCL_GPU" );
+        #endif
+
+        device_vector< cl_uint > counts( binner.numBins, cl_uint( 0 ), CL_MEM_READ_WRITE, true, ctl );
+        histogram_enqueue( ctl, first, last, binner, counts, cl_code );
+        return bolt::cl::copy( ctl, counts.begin( ), counts.end( ), bins_first );
+    }
+
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_detect_random_access( bolt::cl::control &ctl, const InputIterator& first,
+                                                   const InputIterator& last, const OutputIterator& bins_first,
+                                                   const Binner& binner, const std::string& cl_code,
+                                                   std::random_access_iterator_tag )
+    {
+        static_assert( std::is_arithmetic< typename std::iterator_traits< InputIterator >::value_type >::value,
+                       "histogram only supports arithmetic value types" );
+        if( binner.numBins == 0 )
+            return bins_first;
+
+        return histogram_pick_iterator( ctl, first, last, bins_first, binner, cl_code,
+                                        typename std::iterator_traits< InputIterator >::iterator_category( ) );
+    }
+
+    template< typename InputIterator, typename OutputIterator, typename Binner >
+    OutputIterator histogram_detect_random_access( bolt::cl::control &ctl, const InputIterator& first,
+                                                   const InputIterator& last, const OutputIterator& bins_first,
+                                                   const Binner& binner, const std::string& cl_code,
+                                                   std::input_iterator_tag )
+    {
+        //  TODO:  It should be possible to support non-random_access_iterator_tag iterators, if we copied the data
+        //  to a temporary buffer.  Should we?
+        static_assert( std::is_same< InputIterator, std::input_iterator_tag >::value,
+                       "Bolt only supports random access iterator types" );
+    }
+
+}//end of namespace detail
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator histogram( bolt::cl::control &ctl, InputIterator first, InputIterator last,
+                              OutputIterator bins_first, size_t num_bins,
+                              typename std::iterator_traits< InputIterator >::value_type lower,
+                              typename std::iterator_traits< InputIterator >::value_type upper,
+                              const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+        return detail::histogram_detect_random_access( ctl, first, last, bins_first,
+                                                       detail::HistogramEvenBins< iType >( lower, upper, num_bins ),
+                                                       cl_code,
+                                                       typename std::iterator_traits< InputIterator >::iterator_category( ) );
+    }
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator histogram( InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins,
+                              typename std::iterator_traits< InputIterator >::value_type lower,
+                              typename std::iterator_traits< InputIterator >::value_type upper,
+                              const std::string& cl_code )
+    {
+        return bolt::cl::histogram( control::getDefault( ), first, last, bins_first, num_bins, lower, upper, cl_code );
+    }
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator bincount( bolt::cl::control &ctl, InputIterator first, InputIterator last,
+                             OutputIterator bins_first, size_t num_bins, const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< InputIterator >::value_type iType;
+        static_assert( std::is_integral< iType >::value, "bincount only supports integral value types" );
+
+        return detail::histogram_detect_random_access( ctl, first, last, bins_first,
+                                                       detail::HistogramBincount< iType >( num_bins ), cl_code,
+                                                       typename std::iterator_traits< InputIterator >::iterator_category( ) );
+    }
+
+    template< typename InputIterator, typename OutputIterator >
+    OutputIterator bincount( InputIterator first, InputIterator last, OutputIterator bins_first, size_t num_bins,
+                             const std::string& cl_code )
+    {
+        return bolt::cl::bincount( control::getDefault( ), first, last, bins_first, num_bins, cl_code );
+    }
+
+}//end of namespace cl
+}//end of namespace bolt
+
+#endif
@@ -0,0 +1,153 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_HOST_SPLIT_INL )
+#define BOLT_CL_HOST_SPLIT_INL
+#pragma once
+
+/*  Helpers for algorithms that split one call between the host and the device when control::HostSplit is set.
+ *  The host runs the TBB version of the algorithm on the front of the input while the calling thread runs the
+ *  OpenCL version on the rest; bolt::cl::hostSplitLength decides where the input is cut.  */
+
+#if defined( ENABLE_TBB )
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "tbb/task_group.h"
+#include "tbb/tick_count.h"
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+#include "bolt/cl/bolt.h"
+
+namespace bolt {
+namespace cl {
+namespace detail {
+
+    //  task_group copies the functor it runs, so the task only points at the host part.  The task may run on
+    //  a TBB worker, which would not see the arena of the calling thread otherwise.
+    template< typename HostPart >
+    struct HostSplitTask
+    {
+        HostPart* part;
+        double* seconds;
+        bolt::btbb::arena* arena;
+
+        HostSplitTask( HostPart* _part, double* _seconds ) : part( _part ), seconds( _seconds ),
+            arena( &bolt::btbb::currentArena( ) ) { }
+
+        void operator()( ) const
+        {
+            bolt::btbb::arenaScope scope( arena );
+            tbb::tick_count start = tbb::tick_count::now( );
+            ( *part )( );
+            *seconds = ( tbb::tick_count::now( ) - start ).seconds( );
+        }
+    };
+
+    /*! \brief Runs hostPart on a TBB task while the calling thread runs devicePart, and records how fast each
+     *  side went through its elements so that the next split of algorithm balances them.
+     *  \details Each part must have finished with its elements when it returns.  Exceptions of either part are
+     *  rethrown after both have stopped.
+     */
+    template< typename HostPart, typename DevicePart >
+    void host_split_run( const char* algorithm, HostPart& hostPart, size_t hostLength, DevicePart& devicePart,
+                         size_t deviceLength )
+    {
+        double hostSeconds = 0.0;
+        tbb::task_group group;
+        group.run( HostSplitTask< HostPart >( &hostPart, &hostSeconds ) );
+
+        tbb::tick_count start = tbb::tick_count::now( );
+        try
+        {
+            devicePart( );
+        }
+        catch( ... )
+        {
+            group.wait( );
+            throw;
+        }
+        double deviceSeconds = ( tbb::tick_count::now( ) - start ).seconds( );
+
+        group.wait( );
+        bolt::cl::recordHostSplit( algorithm, hostLength, hostSeconds, deviceLength, deviceSeconds );
+    }
+
+    /*  Merges blocks of the first run with the elements of the second run that fall between them.  Elements of
+     *  the second run equal to an element of the first go after it, as with std::merge.  */
+    template< typename RandomAccessIterator, typename OutputIterator, typename StrictWeakOrdering >
+    struct HostSplitMergeBody
+    {
+        RandomAccessIterator first;
+        RandomAccessIterator middle;
+        RandomAccessIterator last;
+        OutputIterator result;
+        StrictWeakOrdering comp;
+        size_t blockSize;
+
+        HostSplitMergeBody( const RandomAccessIterator& _first, const RandomAccessIterator& _middle,
+                            const RandomAccessIterator& _last, const OutputIterator& _result,
+                            const StrictWeakOrdering& _comp, size_t _blockSize ) :
+            first( _first ), middle( _middle ), last( _last ), result( _result ), comp( _comp ),
+            blockSize( _blockSize ) { }
+
+        void operator()( const tbb::blocked_range< size_t >& r ) const
+        {
+            size_t firstLength = static_cast< size_t >( middle - first );
+            for( size_t b = r.begin( ); b != r.end( ); ++b )
+            {
+                RandomAccessIterator a0 = first + b * blockSize;
+                RandomAccessIterator a1 = first + std::min( ( b + 1 ) * blockSize, firstLength );
+                RandomAccessIterator b0 = ( b == 0 ) ? middle : std::lower_bound( middle, last, *a0, comp );
+                RandomAccessIterator b1 = ( a1 == middle ) ? last : std::lower_bound( middle, last, *a1, comp );
+                std::merge( a0, a1, b0, b1, result + ( ( a0 - first ) + ( b0 - middle ) ), comp );
+            }
+        }
+    };
+
+    /*! \brief Merges the sorted runs [first, middle) and [middle, last) in place, in parallel blocks.
+     */
+    template< typename RandomAccessIterator, typename StrictWeakOrdering >
+    void host_split_merge( RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last,
+                           const StrictWeakOrdering& comp )
+    {
+        typedef typename std::iterator_traits< RandomAccessIterator >::value_type T;
+        typedef typename std::vector< T >::iterator tmpIterator;
+
+        size_t firstLength = static_cast< size_t >( middle - first );
+        if( firstLength == 0 || middle == last )
+            return;
+
+        std::vector< T > merged( static_cast< size_t >( last - first ) );
+        const size_t blockSize = 64 * 1024;
+        size_t numBlocks = ( firstLength + blockSize - 1 ) / blockSize;
+        tbb::parallel_for( tbb::blocked_range< size_t >( 0, numBlocks ),
+                           HostSplitMergeBody< RandomAccessIterator, tmpIterator, StrictWeakOrdering >(
+                               first, middle, last, merged.begin( ), comp, blockSize ) );
+        std::copy( merged.begin( ), merged.end( ), first );
+    }
+
+}//end of namespace detail
+}//end of namespace cl
+}//end of namespace bolt
+
+#endif
+
+#endif
@@ -17,22 +17,21 @@
 
 /*
 TODO:
-1. Optimize the Kernel. In this version transform and reduce are called directly which performs better.
-2. Found a caveat in Multi-GPU scenario (Evergreen+Tahiti). Which basically applies to most of the routines.
+1. Found a caveat in Multi-GPU scenario (Evergreen+Tahiti). Which basically applies to most of the routines.
 */
 
 #if !defined( BOLT_CL_INNERPRODUCT_INL )
 #define BOLT_CL_INNERPRODUCT_INL
-#define USE_KERNEL 0
 #pragma once
 
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 #include <type_traits>
-#include <bolt/cl/detail/reduce.inl>
-#include <bolt/cl/detail/transform.inl>
+#include <sstream>
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
+#include "bolt/cl/device_vector.h"
 
 //TBB Includes
 #ifdef ENABLE_TBB
@@ -47,57 +46,175 @@ namespace bolt {
 
 namespace detail {
 
-#if USE_KERNEL
-             struct CallCompiler_InnerProduct {
-                static void constructAndCompile(::cl::Kernel *masterKernel,  std::string cl_code,
-                    std::string valueTypeName, std::string functorTypeName1, std::string functorTypeName2,
-                    const control *ctl) {
-
-                    const std::string instantiationString =
-                        "// Host generates this instantiation string with user-specified value type and functor\n"
-                        "template __attribute__((mangled_name(innerProductInstantiated)))\n"
-                        "__attribute__((reqd_work_group_size(64,1,1)))\n"
-                        "kernel void innerProductTemplate(\n"
-                        "global " + valueTypeName + "* A,\n"
-                        "global " + valueTypeName + "* B,\n"
-                        "const int length,\n"
-                        "global " + functorTypeName1 + "* userFunctor,\n"
-                        "global " + functorTypeName2 + "* userFunctor2,\n"
-                        "global " + valueTypeName + "* result,\n"
-                        "local " + valueTypeName + "* scratch\n"
-                        ");\n\n";
-
-                    std::string functorTypeNames = functorTypeName1 + " , " + functorTypeName2;
-
-                    bolt::cl::constructAndCompileString( masterKernel, "innerProduct", inner_product_kernels,
-                        instantiationString, cl_code, valueTypeName, functorTypeNames, *ctl);
-
-                };
-            };
+        enum innerProductTypes { ip_iType, ip_iIterType, ip_oType, ip_BinaryFunction1, ip_BinaryFunction2, ip_end };
 
+        class InnerProduct_KernelTemplateSpecializer : public KernelTemplateSpecializer
+        {
+        public:
+            InnerProduct_KernelTemplateSpecializer() : KernelTemplateSpecializer()
+            {
+                addKernelName( "innerProduct" );
+                addKernelName( "innerProductFinal" );
+            }
 
-#endif
+            const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
+            {
+                const std::string templateSpecializationString =
+                    "// Host generates this instantiation string with user-specified value type and functor\n"
+                    "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
+                    "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                    "kernel void innerProductTemplate(\n"
+                    "global " + typeNames[ip_iType] + "* input_ptr1,\n"
+                    + typeNames[ip_iIterType] + " iter1,\n"
+                    "global " + typeNames[ip_iType] + "* input_ptr2,\n"
+                    + typeNames[ip_iIterType] + " iter2,\n"
+                    "const BOLT_INDEX_T length,\n"
+                    "global " + typeNames[ip_BinaryFunction2] + "* productFunctor,\n"
+                    "global " + typeNames[ip_BinaryFunction1] + "* reduceFunctor,\n"
+                    "global " + typeNames[ip_oType] + "* result,\n"
+                    "local " + typeNames[ip_oType] + "* scratch\n"
+                    ");\n\n"
+
+                    "// Host generates this instantiation string with user-specified value type and functor\n"
+                    "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                    "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                    "kernel void innerProductFinalTemplate(\n"
+                    "global " + typeNames[ip_oType] + "* partials,\n"
+                    "const int numPartials,\n"
+                    "const " + typeNames[ip_oType] + " init,\n"
+                    "global " + typeNames[ip_BinaryFunction1] + "* reduceFunctor,\n"
+                    "local " + typeNames[ip_oType] + "* scratch\n"
+                    ");\n\n";
+                return templateSpecializationString;
+            }
+        };
 
 
+            //  f2 forms the product of each pair of elements and f1 folds it into the accumulator in the same
+            //  kernel, so the inputs are read once and nothing of their size is allocated
             template< typename DVInputIterator, typename OutputType, typename BinaryFunction1,typename BinaryFunction2>
             OutputType inner_product_enqueue(bolt::cl::control &ctl, const DVInputIterator& first1,
                 const DVInputIterator& last1, const DVInputIterator& first2, const OutputType& init,
                 const BinaryFunction1& f1, const BinaryFunction2& f2, const std::string& cl_code)
             {
-
-                //Should we directly call transform and reduce routines or launch a separate kernel?
                 typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
-                ::cl::Event innerproductEvent;
 
-                cl_uint distVec = static_cast< cl_uint >( std::distance( first1, last1 ) );
+                size_t distVec = static_cast< size_t >( std::distance( first1, last1 ) );
                 if( distVec == 0 )
-                    return -1;
+                    return init;
+
+                /**********************************************************************************
+                 * Type Names - used in KernelTemplateSpecializer
+                 *********************************************************************************/
+                std::vector<std::string> typeNames( ip_end );
+                typeNames[ip_iType] = TypeName< iType >::get( );
+                typeNames[ip_iIterType] = TypeName< DVInputIterator >::get( );
+                typeNames[ip_oType] = TypeName< OutputType >::get( );
+                typeNames[ip_BinaryFunction1] = TypeName< BinaryFunction1 >::get( );
+                typeNames[ip_BinaryFunction2] = TypeName< BinaryFunction2 >::get( );
+
+                /**********************************************************************************
+                 * Type Definitions - directrly concatenated into kernel string
+                 *********************************************************************************/
+                std::vector<std::string> typeDefinitions;
+                PUSH_BACK_UNIQUE( typeDefinitions, cl_code )
+                PUSH_BACK_UNIQUE( typeDefinitions, ClCode< iType >::get() )
+                PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVInputIterator >::get() )
+                PUSH_BACK_UNIQUE( typeDefinitions, ClCode< OutputType >::get() )
+                PUSH_BACK_UNIQUE( typeDefinitions, ClCode< BinaryFunction1 >::get() )
+                PUSH_BACK_UNIQUE( typeDefinitions, ClCode< BinaryFunction2 >::get() )
+
+                /**********************************************************************************
+                 * Calculate Work Size
+                 *********************************************************************************/
+                const tuningParams defaultShape = { 256, 64, 8, 1 };
+                const tuningParams shape = findReduceTuning( ctl, "inner_product", typeNames[ip_iType], distVec,
+                    defaultShape );
+                const size_t wgSize = shape.wgSize;
+                size_t numWG = reduceWorkGroups( ctl, distVec, shape );
+
+                /**********************************************************************************
+                 * Compile Options
+                 *********************************************************************************/
+                const kernelIndex index( distVec );
+                std::ostringstream oss;
+                oss << " -DREDUCE_WG_SIZE=" << wgSize << index.compileOptions( );
+                std::string compileOptions = oss.str( );
+
+                /**********************************************************************************
+                 * Request Compiled Kernels
+                 *********************************************************************************/
+                InnerProduct_KernelTemplateSpecializer ip_kts;
+                static ProgramCacheSlot ip_ktsSlot;
+                std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+                    ctl,
+                    typeNames,
+                    &ip_kts,
+                    typeDefinitions,
+                    inner_product_kernels,
+                    compileOptions,
+                    &ip_ktsSlot );
+                // kernels returned in same order as added in KernelTemplaceSpecializer constructor
+
+                // Create Buffer wrappers so we can access the host functors, for read or writing in the kernel
+                ALIGNED( 256 ) BinaryFunction1 aligned_reduce( f1 );
+                ALIGNED( 256 ) BinaryFunction2 aligned_product( f2 );
+
+                control::buffPointer reduceFunctor = ctl.acquireBuffer( sizeof( aligned_reduce ),
+                                           CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_reduce );
+                control::buffPointer productFunctor = ctl.acquireBuffer( sizeof( aligned_product ),
+                                           CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_product );
+                control::buffPointer result = ctl.acquireBuffer( sizeof( OutputType ) * numWG, CL_MEM_READ_WRITE );
+
+                typename DVInputIterator::Payload first1_payload = first1.gpuPayload( );
+                typename DVInputIterator::Payload first2_payload = first2.gpuPayload( );
+
+                V_OPENCL( kernels[0].setArg( 0, first1.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 1, first1.gpuPayloadSize( ), &first1_payload ),
+                                                                "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 2, first2.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 3, first2.gpuPayloadSize( ), &first2_payload ),
+                                                                "Error setting kernel argument" );
+                V_OPENCL( index.setArg( kernels[0], 4, distVec ), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 5, *productFunctor ), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 6, *reduceFunctor ), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg( 7, *result ), "Error setting kernel argument" );
+
+                ::cl::LocalSpaceArg loc;
+                loc.size_ = wgSize*sizeof(OutputType);
+                V_OPENCL( kernels[0].setArg( 8, loc ), "Error setting kernel argument" );
+
+                cl_int l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                    kernels[0],
+                    ::cl::NullRange,
+                    ::cl::NDRange(numWG * wgSize),
+                    ::cl::NDRange(wgSize) );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for inner_product() kernel" );
+
+                //  Every workgroup holds at least one element, so each wrote a partial; fold them and init on the device
+                cl_int numPartials = static_cast< cl_int >( numWG );
+                V_OPENCL( kernels[1].setArg( 0, *result ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg( 1, numPartials ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg( 2, init ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg( 3, *reduceFunctor ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg( 4, loc ), "Error setting kernel argument" );
+
+                l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                    kernels[1],
+                    ::cl::NullRange,
+                    ::cl::NDRange(wgSize),
+                    ::cl::NDRange(wgSize) );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for inner_product() final kernel" );
+
+                //  Only the final value crosses back to the host
+                OutputType acc;
+                ::cl::Event innerproductEvent;
+                V_OPENCL( ctl.getCommandQueue().enqueueReadBuffer( *result, CL_FALSE, 0, sizeof( OutputType ), &acc,
+                    NULL, &innerproductEvent ), "Error reading the result of inner_product()" );
 
-                device_vector< iType > tempDV( distVec, 0, CL_MEM_READ_WRITE, false, ctl );
-                detail::transform_enqueue( ctl, first1, last1, first2, tempDV.begin() ,f2,cl_code);
-                return detail::reduce_enqueue( ctl, tempDV.begin(), tempDV.end(), init, f1, cl_code);
-                bolt::cl::wait(ctl, innerproductEvent);
+                bolt::cl::wait(ctl, innerproductEvent, "inner_product");
 
+                return acc;
             };
 
 
@@ -119,11 +236,8 @@ namespace detail {
                 if (sz == 0)
                     return -1;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( iType ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -191,11 +305,8 @@ namespace detail {
                 size_t sz = (last1 - first1);
 
                 typedef typename std::iterator_traits< DVInputIterator >::value_type iType1;
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( iType1 ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -256,11 +367,10 @@ namespace detail {
                 typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
                 size_t sz = std::distance( first1, last1 );
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                     runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( iType ), false, true );
+                runMode = detail::iteratorRunMode( ctl, runMode, first1 );
+                runMode = detail::iteratorRunMode( ctl, runMode, first2 );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -21,10 +21,12 @@
 #pragma once
 
 #include <algorithm>
+#include <sstream>
 
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/functional.h"
 #ifdef ENABLE_TBB
 //TBB Includes
@@ -41,6 +43,27 @@ namespace bolt {
 
         enum MergeTypes {merge_iVType1,merge_iVType2, merge_iIterType1,merge_iIterType2, merge_rIterType,merge_resType,merge_StrictWeakCompare, merge_end};
 
+        //  Work-group size of the merge path kernels, here and in the merge passes of stablesort
+        static const int mergePathWgSize = 128;
+
+        //  Elements merged sequentially by every work item: up to 8, as long as a tile of
+        //  mergePathWgSize * vt values takes at most half of the local memory of the device
+        inline int mergePathValuesPerThread( const control& ctl, size_t valueSize )
+        {
+            cl_ulong localMem = ctl.getDevice( ).getInfo< CL_DEVICE_LOCAL_MEM_SIZE >( );
+            int vt = 8;
+            while( vt > 1 && mergePathWgSize * vt * valueSize > localMem / 2 )
+                vt >>= 1;
+            return vt;
+        }
+
+        inline std::string mergePathCompileOptions( int vt )
+        {
+            std::ostringstream oss;
+            oss << " -DMERGE_WG_SIZE=" << mergePathWgSize << " -DMERGE_VT=" << vt;
+            return oss.str( );
+        }
+
         ///////////////////////////////////////////////////////////////////////
         //Kernel Template Specializer
         ///////////////////////////////////////////////////////////////////////
@@ -50,7 +73,8 @@ namespace bolt {
 
             Merge_KernelTemplateSpecializer() : KernelTemplateSpecializer()
                 {
-                    addKernelName( "mergeTemplate" );
+                    addKernelName( "mergePartitions" );
+                    addKernelName( "mergePath" );
                 }
 
             const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -58,16 +82,31 @@ namespace bolt {
                 const std::string templateSpecializationString =
                         "// Host generates this instantiation string with user-specified value type and functor\n"
                         "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
-                        "__attribute__((reqd_work_group_size(64,1,1)))\n"
-                        "__kernel void mergeTemplate(\n"
+                        "__kernel void mergePartitionsTemplate(\n"
+                        "global " + typeNames[merge_iVType1] + "* input_ptr1,\n"
+                         + typeNames[merge_iIterType1] + " iter1,\n"
+                        "const int length1,\n"
+                        "global " + typeNames[merge_iVType1] + "* input_ptr2,\n"
+                         + typeNames[merge_iIterType2] + " iter2,\n"
+                        "const int length2,\n"
+                        "const int numTiles,\n"
+                        "global int* partitions,\n"
+                        "global " + typeNames[merge_StrictWeakCompare] + "* userFunctor\n"
+                        ");\n\n"
+
+                        "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                        "__attribute__((reqd_work_group_size(MERGE_WG_SIZE,1,1)))\n"
+                        "__kernel void mergePathTemplate(\n"
                         "global " + typeNames[merge_iVType1] + "* input_ptr1,\n"
                          + typeNames[merge_iIterType1] + " iter1,\n"
                         "const int length1,\n"
                         "global " + typeNames[merge_iVType1] + "* input_ptr2,\n"
                          + typeNames[merge_iIterType2] + " iter2,\n"
-                       "const int length2,\n"
+                        "const int length2,\n"
                         "global " + typeNames[merge_resType] + "* result,\n"
                          + typeNames[merge_rIterType] + " riter,\n"
+                        "global const int* partitions,\n"
+                        "local " + typeNames[merge_iVType1] + "* lds,\n"
                         "global " + typeNames[merge_StrictWeakCompare] + "* userFunctor\n"
                         ");\n\n";
 
@@ -83,7 +122,7 @@ namespace bolt {
 
 
             //----
-            // This is the base implementation of reduction that is called by all of the convenience wrappers below.
+            // This is the base implementation of merge that is called by all of the convenience wrappers below.
             // first and last must be iterators from a DeviceVector
 
             template<typename DVInputIterator1,typename DVInputIterator2,typename DVOutputIterator, 
@@ -121,80 +160,85 @@ namespace bolt {
                 PUSH_BACK_UNIQUE( typeDefinitions, ClCode< rType  >::get() )
                 PUSH_BACK_UNIQUE( typeDefinitions, ClCode< StrictWeakCompare  >::get() )
 
+                cl_uint szElements1 = static_cast< cl_uint >( first1.distance_to(last1 ) );
+                cl_uint szElements2 = static_cast< cl_uint >( first2.distance_to(last2 ) );
+                cl_uint szElements  = szElements1 + szElements2;
+                if( szElements == 0 )
+                    return result;
 
-
-                //bool cpuDevice = ctl.device().getInfo<CL_DEVICE_TYPE>() == CL_DEVICE_TYPE_CPU;
-                /*\TODO - Do CPU specific kernel work group size selection here*/
-                //const size_t kernel0_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL02WAVES;
-                std::string compileOptions;
-                //std::ostringstream oss;
-                //oss << " -DKERNEL0WORKGROUPSIZE=" << kernel0_WgSize;
+                const int vt = mergePathValuesPerThread( ctl, sizeof( iType1 ) );
+                const int tileSize = mergePathWgSize * vt;
+                std::string compileOptions = mergePathCompileOptions( vt );
 
                 Merge_KernelTemplateSpecializer ts_kts;
+                static ProgramCacheSlot ts_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &ts_kts,
                     typeDefinitions,
                     merge_kernels,
-                    compileOptions);
-
-                // Set up shape of launch grid and buffers:
-                cl_uint computeUnits     = ctl.getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
-                int wgPerComputeUnit =  ctl.getWGPerComputeUnit();
-                size_t numWG = computeUnits * wgPerComputeUnit;
-
-                cl_int l_Error = CL_SUCCESS;
-
-                const size_t wgSize  = kernels[0].getWorkGroupInfo< CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE >(
-                    ctl.getDevice( ), &l_Error );
-
-                V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
+                    compileOptions,
+                    &ts_ktsSlot );
 
                 // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
                 ALIGNED( 256 ) StrictWeakCompare aligned_merge( comp );
-                //::cl::Buffer userFunctor(ctl.context(), CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, sizeof(aligned_merge),
-                //  &aligned_merge );
                 control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( aligned_merge ),
                     CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_merge );
 
+                //  One split of A per tile boundary, the last one is always szElements1
+                cl_uint numTiles = ( szElements + tileSize - 1 ) / tileSize;
+                control::buffPointer partitions = ctl.acquireBuffer( sizeof( cl_int ) * ( numTiles + 1 ) );
 
-//                control::buffPointer result = ctl.acquireBuffer( sizeof( T ) * numWG,
-  //                  CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY );
-
-                cl_uint szElements1 = static_cast< cl_uint >( first1.distance_to(last1 ) );
-                cl_uint szElements2 = static_cast< cl_uint >( first2.distance_to(last2 ) );
                 typename DVInputIterator1::Payload first1_payload = first1.gpuPayload( );
                 typename DVInputIterator2::Payload first2_payload = first2.gpuPayload( );
                 typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
 
-
                 V_OPENCL( kernels[0].setArg(0, first1.getContainer().getBuffer() ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(1, first1.gpuPayloadSize( ),&first1_payload), "Error setting a kernel argument" );
                 V_OPENCL( kernels[0].setArg(2, szElements1), "Error setting kernel argument" );
-
                 V_OPENCL( kernels[0].setArg(3, first2.getContainer().getBuffer() ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(4, first2.gpuPayloadSize( ),&first2_payload ),"Error setting a kernel argument" );
                 V_OPENCL( kernels[0].setArg(5, szElements2), "Error setting kernel argument" );
-
-                V_OPENCL( kernels[0].setArg(6, result.getContainer().getBuffer()), "Error setting kernel argument" );
-                V_OPENCL( kernels[0].setArg(7, result.gpuPayloadSize( ),&result_payload ),"Error setting a kernel argument" );
+                V_OPENCL( kernels[0].setArg(6, numTiles), "Error setting kernel argument" );
+                V_OPENCL( kernels[0].setArg(7, *partitions), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(8, *userFunctor), "Error setting kernel argument" );
-                
-        //        ::cl::LocalSpaceArg loc;
-         //       loc.size_ = wgSize*sizeof(T);
-         //       V_OPENCL( kernels[0].setArg(5, loc), "Error setting kernel argument" );
-                
-                int leng = szElements1 > szElements2 ? szElements1 : szElements2;
-                leng = leng + 64 - (leng % wgSize);
 
-                l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                V_OPENCL( kernels[1].setArg(0, first1.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(1, first1.gpuPayloadSize( ),&first1_payload), "Error setting a kernel argument" );
+                V_OPENCL( kernels[1].setArg(2, szElements1), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(3, first2.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(4, first2.gpuPayloadSize( ),&first2_payload ),"Error setting a kernel argument" );
+                V_OPENCL( kernels[1].setArg(5, szElements2), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(6, result.getContainer().getBuffer()), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(7, result.gpuPayloadSize( ),&result_payload ),"Error setting a kernel argument" );
+                V_OPENCL( kernels[1].setArg(8, *partitions), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(9, tileSize * sizeof( iType1 ), NULL), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(10, *userFunctor), "Error setting kernel argument" );
+
+                ::cl::CommandQueue& queue = ctl.getCommandQueue( );
+                const size_t partitionWgSize = 64;
+                size_t partitionThreads = ( ( numTiles + 1 + partitionWgSize - 1 ) / partitionWgSize ) * partitionWgSize;
+
+                cl_int l_Error = queue.enqueueNDRangeKernel(
                     kernels[0],
                     ::cl::NullRange,
-                    ::cl::NDRange(leng),
-                    ::cl::NDRange(wgSize));
+                    ::cl::NDRange( partitionThreads ),
+                    ::cl::NDRange( partitionWgSize ) );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergePartitions() kernel" );
 
-                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for merge() kernel" );
+                ::cl::Event mergeEvent;
+                l_Error = queue.enqueueNDRangeKernel(
+                    kernels[1],
+                    ::cl::NullRange,
+                    ::cl::NDRange( numTiles * mergePathWgSize ),
+                    ::cl::NDRange( mergePathWgSize ),
+                    NULL,
+                    &mergeEvent );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergePath() kernel" );
+
+                //  The partitions buffer goes back to the pool on return
+                bolt::cl::wait( ctl, mergeEvent );
 
                 return (result + szElements1 + szElements2);
             }
@@ -221,12 +265,10 @@ namespace bolt {
 
 
                 /*TODO - probably the forceRunMode should be replaced by getRunMode and setRunMode*/
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first1, last1 ) + std::distance( first2, last2 ) ),
+                    sizeof( oType ), false );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -297,11 +339,10 @@ namespace bolt {
                 typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first1, last1 ) + std::distance( first2, last2 ) ),
+                    sizeof( oType ), true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -391,11 +432,12 @@ namespace bolt {
                 typedef typename std::iterator_traits<DVInputIterator1>::value_type iType;
              
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first1, last1 ) + std::distance( first2, last2 ) ),
+                    sizeof( iType ), false );
+                runMode = detail::iteratorRunMode( ctl, runMode, first1 );
+                runMode = detail::iteratorRunMode( ctl, runMode, first2 );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 				#if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -21,11 +21,13 @@
 #pragma once
 
 #include <algorithm>
+#include <sstream>
 
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/functional.h"
 
 #ifdef ENABLE_TBB
@@ -51,6 +53,7 @@ namespace bolt {
             Min_KernelTemplateSpecializer() : KernelTemplateSpecializer()
                 {
                     addKernelName( "min_elementTemplate" );
+                    addKernelName( "min_elementFinalTemplate" );
                 }
 
             const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
@@ -58,15 +61,30 @@ namespace bolt {
                 const std::string templateSpecializationString =
                         "// Host generates this instantiation string with user-specified value type and functor\n"
                         "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
-                        "__attribute__((reqd_work_group_size(256,1,1)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
                         "kernel void " + name(0) + "(\n"
                         "global " + typeNames[min_iValueType] + "* input_ptr,\n"
                          + typeNames[min_iIterType] + " output_iter,\n"
-                        "const int length,\n"
+                        "const BOLT_INDEX_T length,\n"
                         "global " + typeNames[min_BinaryPredicate] + "* userFunctor,\n"
-                        "global int *result,\n"
+                        "global BOLT_INDEX_T *result,\n"
                         "local " + typeNames[min_iValueType] + "* scratch,\n"
-                        "local int *scratch_index\n"
+                        "local BOLT_INDEX_T *scratch_index,\n"
+                        "BOLT_LEAF_PARAMS\n"
+                        ");\n\n"
+
+                        "// Host generates this instantiation string with user-specified value type and functor\n"
+                        "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                        "kernel void " + name(1) + "(\n"
+                        "global " + typeNames[min_iValueType] + "* input_ptr,\n"
+                         + typeNames[min_iIterType] + " output_iter,\n"
+                        "const int numPartials,\n"
+                        "global " + typeNames[min_BinaryPredicate] + "* userFunctor,\n"
+                        "global BOLT_INDEX_T *result,\n"
+                        "local " + typeNames[min_iValueType] + "* scratch,\n"
+                        "local BOLT_INDEX_T *scratch_index,\n"
+                        "BOLT_LEAF_PARAMS\n"
                         ");\n\n";
 
                 return templateSpecializationString;
@@ -77,7 +95,7 @@ namespace bolt {
             // This is the base implementation of reduction that is called by all of the convenience wrappers below.
             // first and last must be iterators from a DeviceVector
             template<typename DVInputIterator, typename BinaryPredicate>
-            int min_element_enqueue(bolt::cl::control &ctl,
+            size_t min_element_enqueue(bolt::cl::control &ctl,
                 const DVInputIterator& first,
                 const DVInputIterator& last,
                 const BinaryPredicate& binary_op,
@@ -108,30 +126,40 @@ namespace bolt {
                 else
                     compileOptions = "-D_IS_MIN_KERNEL";
 
+                //  The indices of the winners are kept in BOLT_INDEX_T as well
+                const size_t szElements = static_cast< size_t >( first.distance_to(last ) );
+                const kernelIndex index( szElements );
+                const size_t indexSize = index.wide( ) ? sizeof( cl_ulong ) : sizeof( cl_uint );
+
+                const tuningParams defaultShape = { 256, 64, 8, 1 };
+                const tuningParams shape = findReduceTuning( ctl,
+                    std::strcmp( min_max, str ) == 0 ? "max_element" : "min_element", typeNames[min_iValueType],
+                    szElements, defaultShape );
+                const size_t wgSize = shape.wgSize;
+
+                std::ostringstream oss;
+                oss << " -DREDUCE_WG_SIZE=" << wgSize << index.compileOptions( );
+                compileOptions += oss.str( );
+
                 //std::ostringstream oss;
                 //oss << " -DKERNEL0WORKGROUPSIZE=" << kernel0_WgSize;
 
                 Min_KernelTemplateSpecializer ts_kts;
+                static ProgramCacheSlot ts_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &ts_kts,
                     typeDefinitions,
                     min_element_kernels,
-                    compileOptions);
-
+                    compileOptions,
+                    &ts_ktsSlot );
 
-                // Set up shape of launch grid and buffers:
-                cl_uint computeUnits     = ctl.getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
-                int wgPerComputeUnit =  64 ;//ctl.getWGPerComputeUnit();
-                size_t numWG = computeUnits * wgPerComputeUnit;
 
                 cl_int l_Error = CL_SUCCESS;
 
-                const size_t wgSize  = 256;//kernels[0].getWorkGroupInfo< CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE >(
-                    //ctl.getDevice( ), &l_Error );
-
-                V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
+                // Set up shape of launch grid and buffers:
+                size_t numWG = reduceWorkGroups( ctl, szElements, shape );
 
                 // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
                 ALIGNED( 256 ) BinaryPredicate aligned_reduce( binary_op );
@@ -141,22 +169,20 @@ namespace bolt {
                     CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_reduce );
 
                 // ::cl::Buffer result(ctl.context(), CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY, sizeof( iType )*numWG);
-                control::buffPointer result = ctl.acquireBuffer( sizeof( int ) * numWG,
-                    CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY );
+                control::buffPointer result = ctl.acquireBuffer( indexSize * numWG, CL_MEM_READ_WRITE );
 
-                cl_uint szElements = static_cast< cl_uint >( first.distance_to(last ) );
                 typename DVInputIterator::Payload first_payload = first.gpuPayload();
 
-                V_OPENCL( kernels[0].setArg(0, first.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( detail::setIteratorLeaves( kernels[0], 0, 7, first ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(1,first.gpuPayloadSize(),&first_payload),"Error setting a kernel argument");
 
-                V_OPENCL( kernels[0].setArg(2, szElements), "Error setting kernel argument" );
+                V_OPENCL( index.setArg( kernels[0], 2, szElements ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(3, *userFunctor), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(4, *result), "Error setting kernel argument" );
 
                 ::cl::LocalSpaceArg loc,loc2;
                 loc.size_ = wgSize*sizeof(iType);
-                loc2.size_ = wgSize*sizeof(int);;
+                loc2.size_ = wgSize*indexSize;
                 V_OPENCL( kernels[0].setArg(5, loc), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(6, loc2), "Error setting kernel argument" );
 
@@ -168,48 +194,34 @@ namespace bolt {
                     ::cl::NDRange(wgSize));
                 V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for reduce() kernel" );
 
-                ::cl::Event l_mapEvent;
-                int *h_result = (int*)ctl.getCommandQueue().enqueueMapBuffer(*result, false, CL_MAP_READ, 0,
-                    sizeof(int)*numWG, NULL, &l_mapEvent, &l_Error );
-                V_OPENCL( l_Error, "Error calling map on the result buffer" );
-
-                // Finish the tail end of the reduction on host side; the compute device reduces within the workgroups,
-                // with one result per workgroup
-                size_t ceilNumWG = static_cast< size_t >( std::ceil( static_cast< float >( szElements ) / wgSize) );
-                bolt::cl::minimum<size_t>  min_size_t;
-                size_t numTailReduce = min_size_t( ceilNumWG, numWG );
-
-                bolt::cl::wait(ctl, l_mapEvent);
-
-                int minele_indx =  h_result[0] ;
-                iType minele =  *(first + h_result[0]) ;
+                //  Every workgroup holds at least one element, so each wrote an index; pick the winner on the device
+                cl_int numPartials = static_cast< cl_int >( numWG );
+                V_OPENCL( detail::setIteratorLeaves( kernels[1], 0, 7, first ), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(1,first.gpuPayloadSize(),&first_payload),"Error setting a kernel argument");
+                V_OPENCL( kernels[1].setArg(2, numPartials), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(3, *userFunctor), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(4, *result), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(5, loc), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(6, loc2), "Error setting kernel argument" );
 
+                l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                    kernels[1],
+                    ::cl::NullRange,
+                    ::cl::NDRange(wgSize),
+                    ::cl::NDRange(wgSize));
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for min_element() final kernel" );
 
-				if(std::strcmp(min_max,str) == 0)
-                {
-					for(int i = 1; i < (int)numTailReduce; ++i){
-                       bool stat = binary_op(*(first + h_result[i]), minele);
-                       minele = stat ? minele : *(first + h_result[i]);
-                       minele_indx =  stat ? minele_indx : h_result[i];
-					}
-                }
-                else
-                {
-					for(int i = 1; i < (int)numTailReduce; ++i){
-                       bool stat = binary_op(minele,*(first + h_result[i]));
-                       minele = stat ? minele : *(first + h_result[i]);
-                       minele_indx =  stat ? minele_indx : h_result[i];
-					}
-                }
-
-				::cl::Event unmapEvent;
-
-				V_OPENCL( ctl.getCommandQueue().enqueueUnmapMemObject(*result,  h_result, NULL, &unmapEvent ),
-					"shared_ptr failed to unmap host memory back to device memory" );
-				V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+                //  Only the winning index crosses back to the host
+                cl_uint narrowIndex = 0;
+                cl_ulong wideIndex = 0;
+                void* minele_indx = index.wide( ) ? static_cast< void* >( &wideIndex ) : &narrowIndex;
+                ::cl::Event l_readEvent;
+                V_OPENCL( ctl.getCommandQueue().enqueueReadBuffer(*result, CL_FALSE, 0, indexSize, minele_indx,
+                    NULL, &l_readEvent ), "Error reading the result of min_element()" );
 
+                bolt::cl::wait(ctl, l_readEvent, "min_element");
 
-                return minele_indx;
+                return static_cast< size_t >( index.wide( ) ? wideIndex : narrowIndex );
             }
 
 
@@ -237,11 +249,8 @@ namespace bolt {
                 //How many threads we should spawn?
                 //Need to look at how to control the number of threads spawned.
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
                 const char * str = "MAX_KERNEL";
 
@@ -261,7 +270,7 @@ namespace bolt {
                         #endif
 						
                         device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
-                        int  dvminele = min_element_enqueue( ctl, dvInput.begin(), dvInput.end(), binary_op, cl_code, min_max);
+                        size_t dvminele = min_element_enqueue( ctl, dvInput.begin(), dvInput.end(), binary_op, cl_code, min_max);
                         return first + dvminele ;
                     }
 
@@ -324,11 +333,9 @@ namespace bolt {
                 if (szElements == 0)
                     return last;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements,
+                    sizeof( typename std::iterator_traits< DVInputIterator >::value_type ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
                 const char * str = "MAX_KERNEL";
             
@@ -347,7 +354,7 @@ namespace bolt {
 						   dblog->CodePathTaken(BOLTLOG::BOLT_MINELEMENT,BOLTLOG::BOLT_OPENCL_GPU,"::Min_Element::OPENCL_GPU");
                         #endif
 						
-                        int pos =  min_element_enqueue( ctl, first, last,  binary_op, cl_code, min_max);
+                        size_t pos = min_element_enqueue( ctl, first, last,  binary_op, cl_code, min_max);
                         return first+pos;
                     }
 
@@ -406,11 +413,11 @@ namespace bolt {
                 bolt::cl::fancy_iterator_tag,
                 const char * min_max )
             {
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl,
+                    static_cast< size_t >( std::distance( first, last ) ),
+                    sizeof( typename std::iterator_traits< DVInputIterator >::value_type ), false, true );
+                runMode = detail::iteratorRunMode( ctl, runMode, first, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
                 const char * str = "MAX_KERNEL";
 
@@ -429,7 +436,7 @@ namespace bolt {
 						   dblog->CodePathTaken(BOLTLOG::BOLT_MINELEMENT,BOLTLOG::BOLT_OPENCL_GPU,"::Min_Element::OPENCL_GPU");
                         #endif
 						
-                        int pos =  min_element_enqueue( ctl, first, last,  binary_op, cl_code, min_max);
+                        size_t pos = min_element_enqueue( ctl, first, last,  binary_op, cl_code, min_max);
                         return first+pos;
                     }
 
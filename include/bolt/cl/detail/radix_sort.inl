@@ -0,0 +1,360 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_RADIX_SORT_INL )
+#define BOLT_CL_RADIX_SORT_INL
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/functional.h"
+
+namespace bolt {
+namespace cl {
+
+namespace detail {
+
+/*! \brief Key types handled by the generic radix sort in radix_sort_kernels.cl.  int and unsigned int keep
+ *  their dedicated kernels in sort_int_kernels.cl and sort_uint_kernels.cl.
+ */
+template< typename T > struct radix_sort_key_type : std::false_type { };
+template< > struct radix_sort_key_type< cl_float >  : std::true_type { };
+template< > struct radix_sort_key_type< cl_double > : std::true_type { };
+template< > struct radix_sort_key_type< cl_long >   : std::true_type { };
+template< > struct radix_sort_key_type< cl_ulong >  : std::true_type { };
+
+/*! \brief The radix path only knows the natural ordering of the key, so it is taken only when the comparator
+ *  is bolt::cl::less or bolt::cl::greater; any other functor keeps the comparison based sorts.
+ */
+template< typename T, typename StrictWeakOrdering > struct radix_sort_comparator : std::false_type { };
+template< typename T > struct radix_sort_comparator< T, bolt::cl::less< T > >    : std::true_type { };
+template< typename T > struct radix_sort_comparator< T, bolt::cl::greater< T > > : std::true_type { };
+
+template< typename T, typename StrictWeakOrdering >
+struct radix_sort_supported
+{
+    static const bool value = radix_sort_key_type< T >::value && radix_sort_comparator< T, StrictWeakOrdering >::value;
+};
+
+/*! \brief Key types accepted by the begin_bit / end_bit overloads of sort, which always use the generic kernels.
+ */
+template< typename T > struct radix_sort_bits_key_type : radix_sort_key_type< T > { };
+template< > struct radix_sort_bits_key_type< cl_int >  : std::true_type { };
+template< > struct radix_sort_bits_key_type< cl_uint > : std::true_type { };
+
+/*! \brief sort_by_key takes the radix path for every key type of the begin_bit / end_bit overloads, int and
+ *  unsigned int included, so that all of them move their values with the same byte gather.
+ */
+template< typename T, typename StrictWeakOrdering >
+struct radix_sort_by_key_supported
+{
+    static const bool value = radix_sort_bits_key_type< T >::value && radix_sort_comparator< T, StrictWeakOrdering >::value;
+};
+
+/*! \brief Host copies of the order preserving maps in radix_sort_kernels.cl, used by the CPU paths of the
+ *  begin_bit / end_bit overloads so that every run mode orders keys by the same bits.
+ */
+inline cl_ulong radixHostKey( cl_uint k )
+{
+    return k;
+}
+
+inline cl_ulong radixHostKey( cl_int k )
+{
+    return static_cast< cl_uint >( k ) ^ 0x80000000u;
+}
+
+inline cl_ulong radixHostKey( cl_float k )
+{
+    cl_uint b = 0;
+    if( k != 0.0f )
+        memcpy( &b, &k, sizeof( b ) );
+    return b ^ ( ( b & 0x80000000u ) ? 0xFFFFFFFFu : 0x80000000u );
+}
+
+inline cl_ulong radixHostKey( cl_ulong k )
+{
+    return k;
+}
+
+inline cl_ulong radixHostKey( cl_long k )
+{
+    return static_cast< cl_ulong >( k ) ^ 0x8000000000000000ull;
+}
+
+inline cl_ulong radixHostKey( cl_double k )
+{
+    cl_ulong b = 0;
+    if( k != 0.0 )
+        memcpy( &b, &k, sizeof( b ) );
+    return b ^ ( ( b & 0x8000000000000000ull ) ? 0xFFFFFFFFFFFFFFFFull : 0x8000000000000000ull );
+}
+
+template< typename T >
+void radix_sort_check_bits( int beginBit, int endBit )
+{
+    if( beginBit < 0 || endBit > static_cast< int >( sizeof( T ) * 8 ) || beginBit > endBit )
+        throw ::cl::Error( CL_INVALID_VALUE, "radix sort bit range must satisfy 0 <= begin_bit <= end_bit <= key bits" );
+}
+
+template< typename T >
+class radix_bits_less
+{
+public:
+    radix_bits_less( int beginBit, int endBit ) : m_beginBit( beginBit ),
+        m_mask( ( endBit - beginBit >= 64 ) ? ~0ull : ( ( 1ull << ( endBit - beginBit ) ) - 1 ) )
+    { }
+
+    bool operator( )( const T& lhs, const T& rhs ) const
+    {
+        return ( ( radixHostKey( lhs ) >> m_beginBit ) & m_mask ) < ( ( radixHostKey( rhs ) >> m_beginBit ) & m_mask );
+    }
+
+private:
+    int m_beginBit;
+    cl_ulong m_mask;
+};
+
+enum radixSortTypes { radixSort_keyType, radixSort_end };
+
+class RadixSort_Generic_KernelTemplateSpecializer : public KernelTemplateSpecializer
+{
+public:
+    RadixSort_Generic_KernelTemplateSpecializer() : KernelTemplateSpecializer()
+    {
+        addKernelName( "radixHistogram" );
+        addKernelName( "radixScan" );
+        addKernelName( "radixPermute" );
+        addKernelName( "radixGatherWords" );
+        addKernelName( "radixGatherBytes" );
+    }
+
+    const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
+    {
+        const std::string templateSpecializationString =
+            "// Host generates this instantiation string with the key type\n"
+            "template __attribute__((mangled_name(" + name( 0 ) + "Instantiated)))\n"
+            "__attribute__((reqd_work_group_size(RADIX_WG_SIZE,1,1)))\n"
+            "kernel void radixHistogram(\n"
+            "global const " + typeNames[ radixSort_keyType ] + "* keys,\n"
+            "const ulong keysOffset,\n"
+            "global uint* isums,\n"
+            "int4 cb,\n"
+            "const int descending,\n"
+            "const uint digitMask\n"
+            ");\n\n"
+
+            "// Host generates this instantiation string with the key type\n"
+            "template __attribute__((mangled_name(" + name( 2 ) + "Instantiated)))\n"
+            "__attribute__((reqd_work_group_size(RADIX_WG_SIZE,1,1)))\n"
+            "kernel void radixPermute(\n"
+            "global const " + typeNames[ radixSort_keyType ] + "* srcKeys,\n"
+            "const ulong srcOffset,\n"
+            "global const uint* srcIndex,\n"
+            "global const uint* isums,\n"
+            "global " + typeNames[ radixSort_keyType ] + "* dstKeys,\n"
+            "const ulong dstOffset,\n"
+            "global uint* dstIndex,\n"
+            "int4 cb,\n"
+            "const int descending,\n"
+            "const uint digitMask,\n"
+            "const int indexMode\n"
+            ");\n\n";
+
+        return templateSpecializationString;
+    }
+};
+
+/*! \brief LSD radix sort of szElements keys of type Keys that start keysOffset elements into clKeys.
+ *  \details Only bits [ beginBit, endBit ) of the order preserving image of the key take part; for unsigned
+ *  keys that image is the key itself.  When clValues is not NULL the values ( valueSize bytes each, starting
+ *  valuesOffset elements into clValues ) are reordered to follow their keys.  The values are treated as raw
+ *  bytes, so any trivially copyable payload works and no TypeName is needed for it.  The sort is stable.
+ */
+template< typename Keys >
+void radix_sort_enqueue( control &ctl, const ::cl::Buffer& clKeys, size_t keysOffset, size_t szElements,
+                         bool descending,
+                         const ::cl::Buffer* clValues, size_t valuesOffset, size_t valueSize,
+                         int beginBit = 0, int endBit = static_cast< int >( sizeof( Keys ) * 8 ) )
+{
+    radix_sort_check_bits< Keys >( beginBit, endBit );
+    if( szElements < 2 || beginBit == endBit )
+        return;
+
+    const int RADIX = radixSortBits( ctl );
+    const int RADICES = ( 1 << RADIX );
+    const int localSize = 256;      // RADIX_WG_SIZE
+    const int wavefronts = 8;
+    const int passes = ( endBit - beginBit + RADIX - 1 ) / RADIX;
+
+    std::vector< std::string > typeNames( radixSort_end );
+    typeNames[ radixSort_keyType ] = TypeName< Keys >::get( );
+
+    std::vector< std::string > typeDefinitions;
+    PUSH_BACK_UNIQUE( typeDefinitions, ClCode< Keys >::get( ) )
+
+    std::ostringstream oss;
+    oss << " -DRADIX_BITS=" << RADIX;
+    std::string compileOptions = oss.str( );
+
+    RadixSort_Generic_KernelTemplateSpecializer radix_kts;
+    static ProgramCacheSlot radix_ktsSlot;
+    std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+        ctl,
+        typeNames,
+        &radix_kts,
+        typeDefinitions,
+        radix_sort_kernels,
+        compileOptions,
+        &radix_ktsSlot );
+
+    ::cl::Kernel histKernel    = kernels[ 0 ];
+    ::cl::Kernel scanKernel    = kernels[ 1 ];
+    ::cl::Kernel permuteKernel = kernels[ 2 ];
+
+    int computeUnits = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
+    int nBlocks = static_cast< int >( ( szElements + localSize - 1 ) / localSize );
+
+    //  The scan kernel runs as one work-group over RADICES entries per group; bound its work so that wide
+    //  digits trade histogram groups for fewer passes rather than a longer serial scan
+    const int maxScanEntries = 64 * localSize;
+    int numGroups = std::min( std::min( computeUnits * wavefronts, maxScanEntries / RADICES ), nBlocks );
+    int nBlocksPerWG = ( nBlocks + numGroups - 1 ) / numGroups;
+    numGroups = ( nBlocks + nBlocksPerWG - 1 ) / nBlocksPerWG;
+
+    cl_int4 cdata;
+    cdata.s[ 0 ] = static_cast< cl_int >( szElements );
+    cdata.s[ 1 ] = numGroups;
+    cdata.s[ 2 ] = beginBit;
+    cdata.s[ 3 ] = nBlocksPerWG;
+
+    control::buffPointer swapKeys  = ctl.acquireBuffer( szElements * sizeof( Keys ) );
+    control::buffPointer histogram = ctl.acquireBuffer( numGroups * RADICES * sizeof( cl_uint ) );
+    control::buffPointer index[ 2 ];
+    if( clValues != NULL )
+    {
+        index[ 0 ] = ctl.acquireBuffer( szElements * sizeof( cl_uint ) );
+        index[ 1 ] = ctl.acquireBuffer( szElements * sizeof( cl_uint ) );
+    }
+
+    ::cl::CommandQueue& myCQ = ctl.getCommandQueue( );
+    cl_int l_Error = CL_SUCCESS;
+    ::cl::Event radixEvent;
+
+    V_OPENCL( histKernel.setArg( 2, *histogram ), "Error setting a kernel argument" );
+    V_OPENCL( histKernel.setArg( 4, static_cast< cl_int >( descending ) ), "Error setting a kernel argument" );
+
+    V_OPENCL( scanKernel.setArg( 0, *histogram ), "Error setting a kernel argument" );
+    V_OPENCL( scanKernel.setArg( 1, numGroups ), "Error setting a kernel argument" );
+
+    V_OPENCL( permuteKernel.setArg( 3, *histogram ), "Error setting a kernel argument" );
+    V_OPENCL( permuteKernel.setArg( 8, static_cast< cl_int >( descending ) ), "Error setting a kernel argument" );
+
+    for( int pass = 0; pass < passes; ++pass )
+    {
+        const bool fromSwap = ( pass & 1 ) != 0;
+        const ::cl::Buffer& srcKeys = fromSwap ? *swapKeys : clKeys;
+        const ::cl::Buffer& dstKeys = fromSwap ? clKeys : *swapKeys;
+        cl_ulong srcOffset = static_cast< cl_ulong >( fromSwap ? 0 : keysOffset );
+        cl_ulong dstOffset = static_cast< cl_ulong >( fromSwap ? keysOffset : 0 );
+        cl_int startBit = beginBit + pass * RADIX;
+        cl_uint digitMask = ( 1u << std::min( RADIX, endBit - startBit ) ) - 1;
+        cdata.s[ 2 ] = startBit;
+
+        V_OPENCL( histKernel.setArg( 0, srcKeys ), "Error setting a kernel argument" );
+        V_OPENCL( histKernel.setArg( 1, srcOffset ), "Error setting a kernel argument" );
+        V_OPENCL( histKernel.setArg( 3, cdata ), "Error setting a kernel argument" );
+        V_OPENCL( histKernel.setArg( 5, digitMask ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( histKernel, ::cl::NullRange, ::cl::NDRange( numGroups * localSize ),
+                                             ::cl::NDRange( localSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for radixHistogram kernel" );
+
+        l_Error = myCQ.enqueueNDRangeKernel( scanKernel, ::cl::NullRange, ::cl::NDRange( localSize ),
+                                             ::cl::NDRange( localSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for radixScan kernel" );
+
+        //  With no values the histogram stands in for the unused index buffers; the kernel never touches them
+        cl_int indexMode = ( clValues == NULL ) ? 0 : ( ( pass == 0 ) ? 1 : 2 );
+        const ::cl::Buffer& srcIndex = ( indexMode == 0 ) ? *histogram : *index[ fromSwap ? 1 : 0 ];
+        const ::cl::Buffer& dstIndex = ( indexMode == 0 ) ? *histogram : *index[ fromSwap ? 0 : 1 ];
+
+        V_OPENCL( permuteKernel.setArg( 0, srcKeys ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 1, srcOffset ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 2, srcIndex ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 4, dstKeys ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 5, dstOffset ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 6, dstIndex ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 7, cdata ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 9, digitMask ), "Error setting a kernel argument" );
+        V_OPENCL( permuteKernel.setArg( 10, indexMode ), "Error setting a kernel argument" );
+        l_Error = myCQ.enqueueNDRangeKernel( permuteKernel, ::cl::NullRange, ::cl::NDRange( numGroups * localSize ),
+                                             ::cl::NDRange( localSize ), NULL, &radixEvent );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for radixPermute kernel" );
+    }
+
+    //  After an odd number of passes the sorted keys sit in the swap buffer
+    if( passes & 1 )
+    {
+        l_Error = myCQ.enqueueCopyBuffer( *swapKeys, clKeys, 0, keysOffset * sizeof( Keys ),
+                                          szElements * sizeof( Keys ), NULL, &radixEvent );
+        V_OPENCL( l_Error, "enqueueCopyBuffer() failed for radix sort keys" );
+    }
+
+    if( clValues != NULL )
+    {
+        //  The last index buffer written holds, for every sorted position, the position the key came from.
+        //  Gather the values into scratch in whole words when the payload allows it, then copy them back over
+        //  the input range
+        const ::cl::Buffer& sortedIndex = *index[ passes & 1 ];
+        control::buffPointer sortedValues = ctl.acquireBuffer( szElements * valueSize );
+        bool wordCopy = ( valueSize % sizeof( cl_uint ) ) == 0;
+        cl_int units = static_cast< cl_int >( wordCopy ? valueSize / sizeof( cl_uint ) : valueSize );
+        cl_ulong unitOffset = static_cast< cl_ulong >( valuesOffset ) * units;
+        ::cl::Kernel gatherKernel = wordCopy ? kernels[ 3 ] : kernels[ 4 ];
+
+        V_OPENCL( gatherKernel.setArg( 0, *clValues ), "Error setting a kernel argument" );
+        V_OPENCL( gatherKernel.setArg( 1, unitOffset ), "Error setting a kernel argument" );
+        V_OPENCL( gatherKernel.setArg( 2, sortedIndex ), "Error setting a kernel argument" );
+        V_OPENCL( gatherKernel.setArg( 3, *sortedValues ), "Error setting a kernel argument" );
+        V_OPENCL( gatherKernel.setArg( 4, static_cast< cl_int >( szElements ) ), "Error setting a kernel argument" );
+        V_OPENCL( gatherKernel.setArg( 5, units ), "Error setting a kernel argument" );
+
+        size_t totalUnits = szElements * units;
+        size_t gatherSize = std::min( ( totalUnits + localSize - 1 ) / localSize,
+                                      static_cast< size_t >( computeUnits * wavefronts ) ) * localSize;
+        l_Error = myCQ.enqueueNDRangeKernel( gatherKernel, ::cl::NullRange, ::cl::NDRange( gatherSize ),
+                                             ::cl::NDRange( localSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for radixGather kernel" );
+
+        l_Error = myCQ.enqueueCopyBuffer( *sortedValues, *clValues, 0, valuesOffset * valueSize,
+                                          szElements * valueSize, NULL, &radixEvent );
+        V_OPENCL( l_Error, "enqueueCopyBuffer() failed for radix sort values" );
+    }
+
+    //  The queue is in order, so the last command enqueued completes after every other one
+    bolt::cl::wait( ctl, radixEvent, "radixSort" );
+}
+
+}//namespace bolt::cl::detail
+}//namespace bolt::cl
+}//namespace bolt
+
+#endif
@@ -25,10 +25,12 @@
 #include <boost/thread/once.hpp>
 #include <boost/bind.hpp>
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/functional.h"
 #ifdef ENABLE_TBB
 //TBB Includes
 #include "bolt/btbb/reduce.h"
+#include "bolt/cl/detail/host_split.inl"
 #endif
 
 
@@ -50,6 +52,7 @@ namespace detail {
             Reduce_KernelTemplateSpecializer() : KernelTemplateSpecializer()
                 {
                     addKernelName( "reduceTemplate" );
+                    addKernelName( "reduceFinalTemplate" );
                 }
 
             const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -57,13 +60,25 @@ namespace detail {
                 const std::string templateSpecializationString =
                         "// Host generates this instantiation string with user-specified value type and functor\n"
                         "template __attribute__((mangled_name(" + name(0) + "Instantiated)))\n"
-                        "__attribute__((reqd_work_group_size(256,1,1)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
                         "kernel void reduceTemplate(\n"
                         "global " + typeNames[reduce_iValueType] + "* input_ptr,\n"
                          + typeNames[reduce_iIterType] + " output_iter,\n"
-                        "const int length,\n"
+                        "const BOLT_INDEX_T length,\n"
                         "global " + typeNames[reduce_BinaryFunction] + "* userFunctor,\n"
                         "global " + typeNames[reduce_resType] + "* result,\n"
+                        "local " + typeNames[reduce_resType] + "* scratch,\n"
+                        "BOLT_LEAF_PARAMS\n"
+                        ");\n\n"
+
+                        "// Host generates this instantiation string with user-specified value type and functor\n"
+                        "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                        "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                        "kernel void reduceFinalTemplate(\n"
+                        "global " + typeNames[reduce_resType] + "* partials,\n"
+                        "const int numPartials,\n"
+                        "const " + typeNames[reduce_resType] + " init,\n"
+                        "global " + typeNames[reduce_BinaryFunction] + "* userFunctor,\n"
                         "local " + typeNames[reduce_resType] + "* scratch\n"
                         ");\n\n";
 
@@ -73,10 +88,12 @@ namespace detail {
 
 
             //----
-            // This is the base implementation of reduction that is called by all of the convenience wrappers below.
-            // first and last must be iterators from a DeviceVector
+            // Enqueues the whole reduction on the device: reduceTemplate leaves one partial result per workgroup, and
+            // reduceFinalTemplate folds those and init into element 0 of the returned buffer.  Nothing is read back, so
+            // the result can feed further device work.  binary_op is passed to the device by address and must stay
+            // alive until the kernels have run.  first and last must be iterators from a DeviceVector
             template<typename T, typename DVInputIterator, typename BinaryFunction>
-            T reduce_enqueue(bolt::cl::control &ctl,
+            control::buffPointer reduce_enqueue_device(bolt::cl::control &ctl,
                 const DVInputIterator& first,
                 const DVInputIterator& last,
                 const T& init,
@@ -97,52 +114,46 @@ namespace detail {
                 PUSH_BACK_UNIQUE( typeDefinitions, ClCode< BinaryFunction  >::get() )
                 PUSH_BACK_UNIQUE( typeDefinitions, ClCode< T >::get() )
 
-                //bool cpuDevice = ctl.device().getInfo<CL_DEVICE_TYPE>() == CL_DEVICE_TYPE_CPU;
-                /*\TODO - Do CPU specific kernel work group size selection here*/
-                //const size_t kernel0_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL02WAVES;
-                std::string compileOptions;
-                //std::ostringstream oss;
-                //oss << " -DKERNEL0WORKGROUPSIZE=" << kernel0_WgSize;
+                // Set up shape of launch grid and buffers:
+                size_t szElements = static_cast< size_t >( first.distance_to(last ) );
+
+                //  The kernels hold steps of the tree reduction for work-groups of 64 to 256 work-items
+                const tuningParams defaultShape = { 256, 64, 8, 1 };
+                tuningParams shape = findReduceTuning( ctl, "reduce", typeNames[reduce_iValueType], szElements,
+                    defaultShape );
+                const size_t wgSize = shape.wgSize;
+
+                std::ostringstream oss;
+                oss << " -DREDUCE_WG_SIZE=" << wgSize << " -DREDUCE_UNROLL=" << std::max( shape.unroll, 1 );
+                const kernelIndex index( szElements );
+                oss << index.compileOptions( );
+                std::string compileOptions = oss.str( );
 
                 Reduce_KernelTemplateSpecializer ts_kts;
+                static ProgramCacheSlot ts_ktsSlot;
                 std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                     ctl,
                     typeNames,
                     &ts_kts,
                     typeDefinitions,
                     reduce_kernels,
-                    compileOptions);
-
-                // Set up shape of launch grid and buffers:
-                cl_uint computeUnits     = ctl.getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
-                int wgPerComputeUnit =  64; //ctl.getWGPerComputeUnit();  // This boosts up the performance
-                size_t numWG = computeUnits * wgPerComputeUnit;
+                    compileOptions,
+                    &ts_ktsSlot );
 
                 cl_int l_Error = CL_SUCCESS;
 
-				// Bumped up wgSize to achieve higher ALU usage and occupancy
-                const size_t wgSize  = 256 ;//kernels[0].getWorkGroupInfo< CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE >(
-                    //ctl.getDevice( ), &l_Error );
+                size_t numWG = reduceWorkGroups( ctl, szElements, shape );
 
-                V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
-
-                // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
-                ALIGNED( 256 ) BinaryFunction aligned_reduce( binary_op );
-                //::cl::Buffer userFunctor(ctl.context(), CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, sizeof(aligned_reduce),
-                //  &aligned_reduce );
-                control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( aligned_reduce ),
-                    CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_reduce );
+                control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( binary_op ),
+                    CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &binary_op );
 
-                // ::cl::Buffer result(ctl.context(), CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY, sizeof( iType )*numWG);
-                control::buffPointer result = ctl.acquireBuffer( sizeof( T ) * numWG,
-                    CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY );
+                control::buffPointer result = ctl.acquireBuffer( sizeof( T ) * numWG, CL_MEM_READ_WRITE );
 
-                cl_uint szElements = static_cast< cl_uint >( first.distance_to(last ) );
                 typename DVInputIterator::Payload first_payload = first.gpuPayload( ) ;
 
-                V_OPENCL( kernels[0].setArg(0, first.getContainer().getBuffer() ), "Error setting kernel argument" );
+                V_OPENCL( detail::setIteratorLeaves( kernels[0], 0, 6, first ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(1, first.gpuPayloadSize( ),&first_payload),"Error setting a kernel argument" );
-                V_OPENCL( kernels[0].setArg(2, szElements), "Error setting kernel argument" );
+                V_OPENCL( index.setArg( kernels[0], 2, szElements ), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(3, *userFunctor), "Error setting kernel argument" );
                 V_OPENCL( kernels[0].setArg(4, *result), "Error setting kernel argument" );
 
@@ -158,36 +169,113 @@ namespace detail {
 
                 V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for reduce() kernel" );
 
-                ::cl::Event l_mapEvent;
-                T *h_result = (T*)ctl.getCommandQueue().enqueueMapBuffer(*result, false, CL_MAP_READ, 0,
-                    sizeof(T)*numWG, NULL, &l_mapEvent, &l_Error );
-                V_OPENCL( l_Error, "Error calling map on the result buffer" );
+                //  Every workgroup holds at least one element, so each wrote a partial
+                cl_int numPartials = static_cast< cl_int >( numWG );
+                V_OPENCL( kernels[1].setArg(0, *result), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(1, numPartials), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(2, init), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(3, *userFunctor), "Error setting kernel argument" );
+                V_OPENCL( kernels[1].setArg(4, loc), "Error setting kernel argument" );
 
-                //  Finish the tail end of the reduction on host side;the compute device reduces within the workgroups,
-                //  with one result per workgroup
-                size_t ceilNumWG = static_cast< size_t >( std::ceil( static_cast< float >( szElements ) / wgSize) );
-                bolt::cl::minimum<size_t>  min_size_t;
-                size_t numTailReduce = min_size_t( ceilNumWG, numWG );
+                l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                    kernels[1],
+                    ::cl::NullRange,
+                    ::cl::NDRange(wgSize),
+                    ::cl::NDRange(wgSize));
 
-                bolt::cl::wait(ctl, l_mapEvent);
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for reduce() final kernel" );
 
-                T acc = init;
-                for(unsigned int i = 0; i < numTailReduce; ++i)
-                {
-                    acc =(T) binary_op(acc, h_result[i]);
-                }
+                return result;
+            };
 
+            //----
+            // This is the base implementation of reduction that is called by all of the convenience wrappers below.
+            // first and last must be iterators from a DeviceVector
+            template<typename T, typename DVInputIterator, typename BinaryFunction>
+            T reduce_enqueue(bolt::cl::control &ctl,
+                const DVInputIterator& first,
+                const DVInputIterator& last,
+                const T& init,
+                const BinaryFunction& binary_op,
+                const std::string& cl_code )
+            {
+                // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
+                ALIGNED( 256 ) BinaryFunction aligned_reduce( binary_op );
+                control::buffPointer result = reduce_enqueue_device( ctl, first, last, init, aligned_reduce, cl_code );
 
-				::cl::Event unmapEvent;
+                //  Only the final value crosses back to the host
+                T acc;
+                ::cl::Event l_readEvent;
+                V_OPENCL( ctl.getCommandQueue().enqueueReadBuffer(*result, CL_FALSE, 0, sizeof(T), &acc, NULL,
+                    &l_readEvent ), "Error reading the result of reduce()" );
 
-				V_OPENCL( ctl.getCommandQueue().enqueueUnmapMemObject(*result,  h_result, NULL, &unmapEvent ),
-					"shared_ptr failed to unmap host memory back to device memory" );
-				V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+                bolt::cl::wait(ctl, l_readEvent, "reduce");
 
                 return acc;
             };
 
 
+#ifdef ENABLE_TBB
+            template<typename T, typename InputIterator, typename BinaryFunction>
+            struct ReduceHostPart
+            {
+                InputIterator first, last;
+                T init;
+                BinaryFunction binary_op;
+                T result;
+
+                ReduceHostPart( const InputIterator& _first, const InputIterator& _last, const T& _init,
+                    const BinaryFunction& _binary_op ) : first( _first ), last( _last ), init( _init ),
+                    binary_op( _binary_op ), result( _init ) { }
+
+                void operator( )( ) { result = bolt::btbb::reduce( first, last, init, binary_op ); }
+            };
+
+            //  The device part starts from its own first element, so init is only counted once
+            template<typename T, typename InputIterator, typename BinaryFunction>
+            struct ReduceDevicePart
+            {
+                typedef typename std::iterator_traits<InputIterator>::value_type iType;
+
+                bolt::cl::control& ctl;
+                InputIterator first, last;
+                BinaryFunction binary_op;
+                const std::string& cl_code;
+                T result;
+
+                ReduceDevicePart( bolt::cl::control& _ctl, const InputIterator& _first, const InputIterator& _last,
+                    const BinaryFunction& _binary_op, const std::string& _cl_code ) : ctl( _ctl ), first( _first ),
+                    last( _last ), binary_op( _binary_op ), cl_code( _cl_code ), result( *_first ) { }
+
+                void operator( )( )
+                {
+                    device_vector< iType > dvInput( first + 1, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+                    result = reduce_enqueue( ctl, dvInput.begin(), dvInput.end(), result, binary_op, cl_code );
+                }
+            };
+
+            //  Reduces the first hostLength elements with TBB while the device reduces the rest
+            template<typename T, typename InputIterator, typename BinaryFunction>
+            T reduce_host_split(bolt::cl::control &ctl,
+                const InputIterator& first,
+                const InputIterator& last,
+                const T& init,
+                const BinaryFunction& binary_op,
+                const std::string& cl_code,
+                size_t hostLength )
+            {
+                ReduceHostPart< T, InputIterator, BinaryFunction > hostPart( first, first + hostLength, init,
+                                                                             binary_op );
+                ReduceDevicePart< T, InputIterator, BinaryFunction > devicePart( ctl, first + hostLength, last,
+                                                                                 binary_op, cl_code );
+                host_split_run( "reduce", hostPart, hostLength, devicePart,
+                                static_cast< size_t >( last - first ) - hostLength );
+
+                BinaryFunction combine( binary_op );
+                return combine( hostPart.result, devicePart.result );
+            };
+#endif
+
             // This template is called after we detect random access iterators
             // This is called strictly for any non-device_vector iterator
             template<typename T, typename InputIterator, typename BinaryFunction>
@@ -205,12 +293,8 @@ namespace detail {
                 if (szElements == 0)
                     return init;
                 /*TODO - probably the forceRunMode should be replaced by getRunMode and setRunMode*/
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), false, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
@@ -218,6 +302,16 @@ namespace detail {
                 {
                 case bolt::cl::control::OpenCL :
                     {
+                        #ifdef ENABLE_TBB
+                        size_t hostLength = bolt::cl::hostSplitLength( ctl, "reduce", szElements );
+                        if( hostLength != 0 )
+                        {
+                            #if defined(BOLT_DEBUG_LOG)
+                            dblog->CodePathTaken(BOLTLOG::BOLT_REDUCE,BOLTLOG::BOLT_HOST_SPLIT,"::Reduce::HOST_SPLIT");
+                            #endif
+                            return reduce_host_split( ctl, first, last, init, binary_op, cl_code, hostLength );
+                        }
+                        #endif
                         #if defined(BOLT_DEBUG_LOG)
                         dblog->CodePathTaken(BOLTLOG::BOLT_REDUCE,BOLTLOG::BOLT_OPENCL_GPU,"::Reduce::OPENCL_GPU");
                         #endif
@@ -271,11 +365,8 @@ namespace detail {
                 if (szElements == 0)
                     return init;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), true, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
 
                 switch(runMode)
                 {
@@ -342,11 +433,9 @@ namespace detail {
                 if (szElements == 0)
                     return init;
 
-                bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-                if(runMode == bolt::cl::control::Automatic)
-                {
-                    runMode = ctl.getDefaultPathToRun();
-                }
+                bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( iType ), false, true );
+                runMode = detail::iteratorRunMode( ctl, runMode, first, true );
+                bolt::cl::tbbArenaScope tbbScope( ctl );
                 #if defined(BOLT_DEBUG_LOG)
                 BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
                 #endif
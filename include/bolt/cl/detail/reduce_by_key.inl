@@ -20,14 +20,9 @@
 #define BOLT_CL_REDUCE_BY_KEY_INL
 
 #define KERNEL02WAVES 4
-#define KERNEL1WAVES 4
 #define WAVESIZE 64
 
-#define LENGTH_TEST 10
-#define ENABLE_PRINTS 0
-
 #include <iostream>
-#include <fstream>
 
 #ifdef ENABLE_TBB
 //TBB Includes
@@ -57,7 +52,7 @@ template<
     typename BinaryPredicate,
     typename BinaryFunction>
 //bolt::cl::pair<OutputIterator1, OutputIterator2>
-unsigned int
+size_t
 gold_reduce_by_key_enqueue( InputIterator1 keys_first,
                             InputIterator1 keys_last,
                             InputIterator2 values_first,
@@ -73,12 +68,10 @@ gold_reduce_by_key_enqueue( InputIterator1 keys_first,
     static_assert( std::is_convertible< vType, voType >::value,
                    "InputIterator2 and OutputIterator's value types are not convertible." );
 
-   unsigned int numElements = static_cast< unsigned int >( std::distance( keys_first, keys_last ) );
-
     // do zeroeth element
     *values_output = *values_first;
     *keys_output = *keys_first;
-    unsigned int count = 1;
+    size_t count = 1;
     // rbk oneth element and beyond
 
     values_first++;
@@ -123,15 +116,6 @@ gold_reduce_by_key_enqueue( InputIterator1 keys_first,
                      e_end };
 
 
-
-    /* "// Dynamic specialization of generic template definition, using user supplied types\n"
-            "template __attribute__((mangled_name(" + name(3) + "Instantiated)))\n"
-            "__attribute__((reqd_work_group_size(KERNEL2WORKGROUPSIZE,1,1)))\n"
-            "__kernel void " + name(3) + "(\n"
-            "global  int *h_result\n"
-            ");\n\n"*/
-
-
 /*********************************************************************************************************************
  * Kernel Template Specializer
  *********************************************************************************************************************/
@@ -141,11 +125,8 @@ class ReduceByKey_KernelTemplateSpecializer : public KernelTemplateSpecializer
 
     ReduceByKey_KernelTemplateSpecializer() : KernelTemplateSpecializer()
     {
-		addKernelName("OffsetCalculation");
-        addKernelName("perBlockScanByKey");
-        addKernelName("intraBlockInclusiveScanByKey");
-        addKernelName("perBlockAdditionByKey");
-        addKernelName("keyValueMapping");
+        addKernelName("perGroupSegmentSummary");
+        addKernelName("segmentedReduceAndCompact");
     }
 
     const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -157,69 +138,39 @@ class ReduceByKey_KernelTemplateSpecializer : public KernelTemplateSpecializer
             "__kernel void " + name(0) + "(\n"
             "global " + typeNames[e_kType] + "* ikeys,\n"
             + typeNames[e_kIterType] + " keys,\n"
-            "global int * output2,\n"
-            "const uint vecSize,\n"
-            "global " + typeNames[e_BinaryPredicate] + "* binaryPred,\n"
-            "global " + typeNames[e_BinaryFunction]  + "* binaryFunct\n"
-            ");\n\n"
-
-            "// Dynamic specialization of generic template definition, using user supplied types\n"
-            "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
-            "__attribute__((reqd_work_group_size(KERNEL0WORKGROUPSIZE,1,1)))\n"
-            "__kernel void " + name(1) + "(\n"
-            "global int *keys,\n"
             "global " + typeNames[e_vType] + "* ivals,\n"
             + typeNames[e_vIterType] + " vals,\n"
-            "global " + typeNames[e_voType] + "* output,\n"
-            "const uint vecSize,\n"
-            "local int * ldsKeys,\n"
+            "const BOLT_INDEX_T vecSize,\n"
+            "const BOLT_INDEX_T chunkSize,\n"
+            "local BOLT_INDEX_T * ldsHeads,\n"
             "local "  + typeNames[e_voType] + "* ldsVals,\n"
+            "global " + typeNames[e_BinaryPredicate] + "* binaryPred,\n"
             "global " + typeNames[e_BinaryFunction]  + "* binaryFunct,\n"
-            "global int * keyBuffer,\n"
-            "global " + typeNames[e_voType] + "* valBuffer\n"
-            ");\n\n"
-
-            "// Dynamic specialization of generic template definition, using user supplied types\n"
-            "template __attribute__((mangled_name(" + name(2) + "Instantiated)))\n"
-            "__attribute__((reqd_work_group_size(KERNEL1WORKGROUPSIZE,1,1)))\n"
-            "__kernel void " + name(2) + "(\n"
-            "global int * keySumArray,\n"
-            "global " + typeNames[e_voType] + "* preSumArray,\n"
-            "global " + typeNames[e_voType] + "* postSumArray,\n"
-            "const uint vecSize,\n"
-            "local int * ldsKeys,\n"
-            "local "  + typeNames[e_voType] + "* ldsVals,\n"
-            "const uint workPerThread,\n"
-            "global " + typeNames[e_BinaryFunction] + "* binaryFunct\n"
-            ");\n\n"
-
-
-            "// Dynamic specialization of generic template definition, using user supplied types\n"
-            "template __attribute__((mangled_name(" + name(3) + "Instantiated)))\n"
-            "__attribute__((reqd_work_group_size(KERNEL2WORKGROUPSIZE,1,1)))\n"
-            "__kernel void " + name(3) + "(\n"
-            "global int * keySumArray,\n"
-            "global " + typeNames[e_voType] + "* postSumArray,\n"
-            "global int *keys,\n"
-            "global " + typeNames[e_voType] + "* output,\n"
-            "const uint vecSize,\n"
-            "global " + typeNames[e_BinaryFunction] + "* binaryFunct\n"
+            "global ulong * groupHeads,\n"
+            "global " + typeNames[e_voType] + "* groupTail\n"
             ");\n\n"
 
             "// Dynamic specialization of generic template definition, using user supplied types\n"
-            "template __attribute__((mangled_name(" + name(4) + "Instantiated)))\n"
+            "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
             "__attribute__((reqd_work_group_size(KERNEL0WORKGROUPSIZE,1,1)))\n"
-            "__kernel void " + name(4) + "(\n"
-            "global " + typeNames[e_kType] + "*ikeys,\n"
+            "__kernel void " + name(1) + "(\n"
+            "global " + typeNames[e_kType] + "* ikeys,\n"
             + typeNames[e_kIterType] + " keys,\n"
-            "global " + typeNames[e_koType] + "*ikeys_output,\n"
+            "global " + typeNames[e_vType] + "* ivals,\n"
+            + typeNames[e_vIterType] + " vals,\n"
+            "global " + typeNames[e_koType] + "* ikeys_output,\n"
             + typeNames[e_koIterType] + " keys_output,\n"
-            "global " + typeNames[e_voType] + "*ivals_output,\n"
+            "global " + typeNames[e_voType] + "* ivals_output,\n"
             + typeNames[e_voIterType] + " vals_output,\n"
-            "global int *offsetArray,\n"
-            "global " + typeNames[e_voType] + "*offsetValArray,\n"
-            "const uint vecSize,\n"
-            "int numSections\n"
+            "const BOLT_INDEX_T vecSize,\n"
+            "const BOLT_INDEX_T chunkSize,\n"
+            "local BOLT_INDEX_T * ldsHeads,\n"
+            "local "  + typeNames[e_voType] + "* ldsVals,\n"
+            "global " + typeNames[e_BinaryPredicate] + "* binaryPred,\n"
+            "global " + typeNames[e_BinaryFunction]  + "* binaryFunct,\n"
+            "global ulong * groupHeads,\n"
+            "global " + typeNames[e_voType] + "* groupTail,\n"
+            "global ulong * segmentCount\n"
             ");\n\n";
 
         return templateSpecializationString;
@@ -227,8 +178,11 @@ class ReduceByKey_KernelTemplateSpecializer : public KernelTemplateSpecializer
 };
 
 
-//  All calls to reduce_by_key end up here, unless an exception was thrown
-//  This is the function that sets up the kernels to compile (once only) and execute
+//  Enqueues the whole reduction on the device and returns the buffer whose single cl_ulong receives the number of
+//  segments.  perGroupSegmentSummary leaves the segment heads and the trailing value of every chunk of the input,
+//  and segmentedReduceAndCompact reduces every segment and writes it straight to its place in the output.  Nothing
+//  is read back, so the count can be read whenever the caller needs it.  binary_pred and binary_op are passed to
+//  the device by address and must stay alive until the kernels have run.  All iterators must be from a DeviceVector
 template<
     typename DVInputIterator1,
     typename DVInputIterator2,
@@ -236,8 +190,8 @@ template<
     typename DVOutputIterator2,
     typename BinaryPredicate,
     typename BinaryFunction >
-unsigned int
-reduce_by_key_enqueue(
+control::buffPointer
+reduce_by_key_enqueue_device(
     control& ctl,
     const DVInputIterator1& keys_first,
     const DVInputIterator1& keys_last,
@@ -263,406 +217,182 @@ reduce_by_key_enqueue(
     typeNames[e_vType] = TypeName< vType >::get( );
     typeNames[e_vIterType] = TypeName< DVInputIterator2 >::get( );
     typeNames[e_koType] = TypeName< koType >::get( );
-    typeNames[e_koIterType] = TypeName< DVInputIterator1 >::get( );
+    typeNames[e_koIterType] = TypeName< DVOutputIterator1 >::get( );
     typeNames[e_voType] = TypeName< voType >::get( );
-    typeNames[e_voIterType] = TypeName< DVInputIterator2 >::get( );
+    typeNames[e_voIterType] = TypeName< DVOutputIterator2 >::get( );
     typeNames[e_BinaryPredicate] = TypeName< BinaryPredicate >::get( );
     typeNames[e_BinaryFunction]  = TypeName< BinaryFunction >::get( );
 
     /**********************************************************************************
      * Type Definitions - directly concatenated into kernel string
      *********************************************************************************/
-    /*std::vector<std::string> typeDefs; // try substituting a map
-    typeDefs.push_back( ClCode< kType >::get() );
-    if (TypeName< vType >::get() != TypeName< kType >::get())
-    {
-        typeDefs.push_back( ClCode< vType >::get() );
-    }
-    if (TypeName< oType >::get() != TypeName< kType >::get() &&
-        TypeName< oType >::get() != TypeName< vType >::get())
-    {
-        typeDefs.push_back( ClCode< oType >::get() );
-    }
-    typeDefs.push_back( ClCode< BinaryPredicate >::get() );
-    typeDefs.push_back( ClCode< BinaryFunction >::get() );*/
     std::vector<std::string> typeDefs; // typeDefs must be unique and order does matter
     PUSH_BACK_UNIQUE( typeDefs, ClCode< kType >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< DVInputIterator1 >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< vType >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< DVInputIterator2 >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< koType >::get() )
+    PUSH_BACK_UNIQUE( typeDefs, ClCode< DVOutputIterator1 >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< voType >::get() )
+    PUSH_BACK_UNIQUE( typeDefs, ClCode< DVOutputIterator2 >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< BinaryPredicate >::get() )
     PUSH_BACK_UNIQUE( typeDefs, ClCode< BinaryFunction  >::get() )
 
     /**********************************************************************************
      * Compile Options
      *********************************************************************************/
+    size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+    const kernelIndex index( numElements );
+
     bool cpuDevice = ctl.getDevice().getInfo<CL_DEVICE_TYPE>() == CL_DEVICE_TYPE_CPU;
-    //std::cout << "Device is CPU: " << (cpuDevice?"TRUE":"FALSE") << std::endl;
     const size_t kernel0_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL02WAVES;
-    const size_t kernel1_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL1WAVES;
-    const size_t kernel2_WgSize = (cpuDevice) ? 1 : WAVESIZE*KERNEL02WAVES;
     std::string compileOptions;
     std::ostringstream oss;
     oss << " -DKERNEL0WORKGROUPSIZE=" << kernel0_WgSize;
-    oss << " -DKERNEL1WORKGROUPSIZE=" << kernel1_WgSize;
-    oss << " -DKERNEL2WORKGROUPSIZE=" << kernel2_WgSize;
+    oss << index.compileOptions( );
     compileOptions = oss.str();
 
     /**********************************************************************************
      * Request Compiled Kernels
      *********************************************************************************/
     ReduceByKey_KernelTemplateSpecializer ts_kts;
+    static ProgramCacheSlot ts_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &ts_kts,
         typeDefs,
         reduce_by_key_kernels,
-        compileOptions);
+        compileOptions,
+        &ts_ktsSlot );
     // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
-    // for profiling
-    ::cl::Event kernel0Event, kernel1Event, kernel2Event, kernelAEvent, kernel3Event, kernel4Event;
-
-    // Set up shape of launch grid and buffers:
-    int computeUnits     = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
-    int wgPerComputeUnit =  ctl.getWGPerComputeUnit( );
-    int resultCnt = computeUnits * wgPerComputeUnit;
-
-    //  Ceiling function to bump the size of input to the next whole wavefront size
-    cl_uint numElements = static_cast< cl_uint >( std::distance( keys_first, keys_last ) );
-    typename device_vector< kType >::size_type sizeInputBuff = numElements;
-    size_t modWgSize = (sizeInputBuff & (kernel0_WgSize-1));
-    if( modWgSize )
+    control::buffPointer segmentCount = ctl.acquireBuffer( sizeof( cl_ulong ) );
+    if( numElements == 0 )
     {
-        sizeInputBuff &= ~modWgSize;
-        sizeInputBuff += kernel0_WgSize;
+        V_OPENCL( ctl.getCommandQueue( ).enqueueFillBuffer< cl_ulong >( *segmentCount, 0, 0, sizeof( cl_ulong ) ),
+            "Error clearing the segment count of reduce_by_key" );
+        return segmentCount;
     }
-    cl_uint numWorkGroupsK0 = static_cast< cl_uint >( sizeInputBuff / kernel0_WgSize );
 
-    //  Ceiling function to bump the size of the sum array to the next whole wavefront size
-    typename device_vector< kType >::size_type sizeScanBuff = numWorkGroupsK0;
-    modWgSize = (sizeScanBuff & (kernel0_WgSize-1));
-    if( modWgSize )
-    {
-        sizeScanBuff &= ~modWgSize;
-        sizeScanBuff += kernel0_WgSize;
-    }
+    //  Every work-group walks one contiguous chunk in tiles of kernel0_WgSize elements, so that kernel 1 only has to
+    //  combine one summary per work-group to find where its chunk starts
+    size_t computeUnits     = ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
+    size_t wgPerComputeUnit = std::max< size_t >( ctl.getWGPerComputeUnit( ), 1 );
+    size_t numTiles = ( numElements + kernel0_WgSize - 1 ) / kernel0_WgSize;
+    size_t numWorkGroups = std::min( numTiles, computeUnits * wgPerComputeUnit );
+    size_t chunkSize = ( ( numTiles + numWorkGroups - 1 ) / numWorkGroups ) * kernel0_WgSize;
+    numWorkGroups = ( numElements + chunkSize - 1 ) / chunkSize;
 
     // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
+    control::buffPointer binaryPredicateBuffer = ctl.acquireBuffer( sizeof( binary_pred ),
+        CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &binary_pred );
+    control::buffPointer binaryFunctionBuffer = ctl.acquireBuffer( sizeof( binary_op ),
+        CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &binary_op );
 
-    ALIGNED( 256 ) BinaryPredicate aligned_binary_pred( binary_pred );
-    control::buffPointer binaryPredicateBuffer = ctl.acquireBuffer( sizeof( aligned_binary_pred ),
-        CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_binary_pred );
-     ALIGNED( 256 ) BinaryFunction aligned_binary_op( binary_op );
-    control::buffPointer binaryFunctionBuffer = ctl.acquireBuffer( sizeof( aligned_binary_op ),
-        CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_binary_op );
-
-    control::buffPointer keySumArray  = ctl.acquireBuffer( sizeScanBuff*sizeof( int ) );
-    control::buffPointer preSumArray  = ctl.acquireBuffer( sizeScanBuff*sizeof( voType ) );
-    control::buffPointer postSumArray = ctl.acquireBuffer( sizeScanBuff*sizeof( voType ) );
-    control::buffPointer offsetValArray  = ctl.acquireBuffer( numElements *sizeof( voType ) );
-
-
-    device_vector< int > offsetArrayVec( numElements, 0, CL_MEM_READ_WRITE, false, ctl);
-    ::cl::Buffer offsetArray = offsetArrayVec.begin( ).getContainer().getBuffer();
+    control::buffPointer groupHeads = ctl.acquireBuffer( numWorkGroups*sizeof( cl_ulong ) );
+    control::buffPointer groupTail  = ctl.acquireBuffer( numWorkGroups*sizeof( voType ) );
 
+    const size_t indexSize = index.wide( ) ? sizeof( cl_ulong ) : sizeof( cl_uint );
+    ::cl::LocalSpaceArg ldsHeads, ldsVals;
+    ldsHeads.size_ = kernel0_WgSize * indexSize;
+    ldsVals.size_  = kernel0_WgSize * sizeof( voType );
 
+    typename DVInputIterator1::Payload keys_first_payload = keys_first.gpuPayload( );
+    typename DVInputIterator2::Payload values_first_payload = values_first.gpuPayload( );
+    typename DVOutputIterator1::Payload keys_output_payload = keys_output.gpuPayload( );
+    typename DVOutputIterator2::Payload values_output_payload = values_output.gpuPayload( );
 
     /**********************************************************************************
      *  Kernel 0
      *********************************************************************************/
-    typename DVInputIterator1::Payload keys_first_payload = keys_first.gpuPayload( );
-    try
-    {
     V_OPENCL( kernels[0].setArg( 0, keys_first.getContainer().getBuffer()), "Error setArg kernels[ 0 ]" ); // Input keys
     V_OPENCL( kernels[0].setArg( 1, keys_first.gpuPayloadSize( ),&keys_first_payload ), "Error setArg kernels[ 0 ]" );
-    V_OPENCL( kernels[0].setArg( 2, offsetArray ), "Error setArg kernels[ 0 ]" ); // Output keys
-    V_OPENCL( kernels[0].setArg( 3, numElements ), "Error setArg kernels[ 0 ]" ); // vecSize
-    V_OPENCL( kernels[0].setArg( 4, *binaryPredicateBuffer),"Error setArg kernels[ 0 ]" ); // User provided functor
-    V_OPENCL( kernels[0].setArg( 5, *binaryFunctionBuffer ),"Error setArg kernels[ 0 ]" ); // User provided functor
+    V_OPENCL( kernels[0].setArg( 2, values_first.getContainer().getBuffer()),"Error setArg kernels[ 0 ]" ); // Input values
+    V_OPENCL( kernels[0].setArg( 3, values_first.gpuPayloadSize( ),&values_first_payload ), "Error setArg kernels[ 0 ]" );
+    V_OPENCL( index.setArg( kernels[0], 4, numElements ),   "Error setArg kernels[ 0 ]" ); // vecSize
+    V_OPENCL( index.setArg( kernels[0], 5, chunkSize ),     "Error setArg kernels[ 0 ]" ); // Elements per work-group
+    V_OPENCL( kernels[0].setArg( 6, ldsHeads ),             "Error setArg kernels[ 0 ]" ); // Scratch buffer
+    V_OPENCL( kernels[0].setArg( 7, ldsVals ),              "Error setArg kernels[ 0 ]" ); // Scratch buffer
+    V_OPENCL( kernels[0].setArg( 8, *binaryPredicateBuffer),"Error setArg kernels[ 0 ]" ); // User provided functor
+    V_OPENCL( kernels[0].setArg( 9, *binaryFunctionBuffer ),"Error setArg kernels[ 0 ]" ); // User provided functor
+    V_OPENCL( kernels[0].setArg( 10, *groupHeads ),         "Error setArg kernels[ 0 ]" ); // Output heads per chunk
+    V_OPENCL( kernels[0].setArg( 11, *groupTail ),          "Error setArg kernels[ 0 ]" ); // Output value per chunk
 
     l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
         kernels[0],
         ::cl::NullRange,
-        ::cl::NDRange( sizeInputBuff ),
-        ::cl::NDRange( kernel0_WgSize ),
-        NULL,
-        &kernel0Event);
+        ::cl::NDRange( numWorkGroups * kernel0_WgSize ),
+        ::cl::NDRange( kernel0_WgSize ) );
     V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel[0]" );
-    }
-    catch( const ::cl::Error& e)
-    {
-        std::cerr << "::cl::enqueueNDRangeKernel( 0 ) in bolt::cl::reduce_by_key_enqueue()" << std::endl;
-        std::cerr << "Error Code:   " << clErrorStringA(e.err()) << " (" << e.err() << ")" << std::endl;
-        std::cerr << "File:         " << __FILE__ << ", line " << __LINE__ << std::endl;
-        std::cerr << "Error String: " << e.what() << std::endl;
-    }
-    // wait for results
-    l_Error = kernel0Event.wait( );
-    V_OPENCL( l_Error, "post-kernel[0] failed wait" );
-
-    detail::scan_enqueue(ctl, offsetArrayVec.begin(), offsetArrayVec.end(), offsetArrayVec.begin(), 0, plus< int >( ), true);
 
     /**********************************************************************************
      *  Kernel 1
      *********************************************************************************/
-    cl_uint ldsKeySize, ldsValueSize;
-    typename DVInputIterator2::Payload values_first_payload = values_first.gpuPayload( );
-    try
-    {
-    ldsKeySize   = static_cast< cl_uint >( kernel0_WgSize * sizeof( int ) );
-    ldsValueSize = static_cast< cl_uint >( kernel0_WgSize * sizeof( voType ) );
-    V_OPENCL( kernels[1].setArg( 0, offsetArray), "Error setArg kernels[ 1 ]" ); // Input keys
-    V_OPENCL( kernels[1].setArg( 1, values_first.getContainer().getBuffer()),"Error setArg kernels[ 1 ]" ); // Input values
-    V_OPENCL( kernels[1].setArg( 2, values_first.gpuPayloadSize( ),&values_first_payload ), "Error setArg kernels[ 1 ]" ); // Input values
-    V_OPENCL( kernels[1].setArg( 3, *offsetValArray ), "Error setArg kernels[ 1 ]" ); // Output values
-    V_OPENCL( kernels[1].setArg( 4, numElements ), "Error setArg kernels[ 1 ]" ); // vecSize
-    V_OPENCL( kernels[1].setArg( 5, ldsKeySize, NULL ),     "Error setArg kernels[ 1 ]" ); // Scratch buffer
-    V_OPENCL( kernels[1].setArg( 6, ldsValueSize, NULL ),   "Error setArg kernels[ 1 ]" ); // Scratch buffer
-    V_OPENCL( kernels[1].setArg( 7, *binaryFunctionBuffer ),"Error setArg kernels[ 1 ]" ); // User provided functor
-    V_OPENCL( kernels[1].setArg( 8, *keySumArray ),         "Error setArg kernels[ 1 ]" ); // Output per block sum
-    V_OPENCL( kernels[1].setArg( 9, *preSumArray ),         "Error setArg kernels[ 1 ]" ); // Output per block sum
+    V_OPENCL( kernels[1].setArg( 0, keys_first.getContainer().getBuffer()), "Error setArg kernels[ 1 ]" ); // Input keys
+    V_OPENCL( kernels[1].setArg( 1, keys_first.gpuPayloadSize( ),&keys_first_payload ), "Error setArg kernels[ 1 ]" );
+    V_OPENCL( kernels[1].setArg( 2, values_first.getContainer().getBuffer()),"Error setArg kernels[ 1 ]" ); // Input values
+    V_OPENCL( kernels[1].setArg( 3, values_first.gpuPayloadSize( ),&values_first_payload ), "Error setArg kernels[ 1 ]" );
+    V_OPENCL( kernels[1].setArg( 4, keys_output.getContainer().getBuffer() ),  "Error setArg kernels[ 1 ]" ); // Output keys
+    V_OPENCL( kernels[1].setArg( 5, keys_output.gpuPayloadSize( ),&keys_output_payload ), "Error setArg kernels[ 1 ]" );
+    V_OPENCL( kernels[1].setArg( 6, values_output.getContainer().getBuffer()), "Error setArg kernels[ 1 ]" ); // Output values
+    V_OPENCL( kernels[1].setArg( 7, values_output.gpuPayloadSize( ),&values_output_payload ), "Error setArg kernels[ 1 ]" );
+    V_OPENCL( index.setArg( kernels[1], 8, numElements ),   "Error setArg kernels[ 1 ]" ); // vecSize
+    V_OPENCL( index.setArg( kernels[1], 9, chunkSize ),     "Error setArg kernels[ 1 ]" ); // Elements per work-group
+    V_OPENCL( kernels[1].setArg( 10, ldsHeads ),            "Error setArg kernels[ 1 ]" ); // Scratch buffer
+    V_OPENCL( kernels[1].setArg( 11, ldsVals ),             "Error setArg kernels[ 1 ]" ); // Scratch buffer
+    V_OPENCL( kernels[1].setArg( 12, *binaryPredicateBuffer),"Error setArg kernels[ 1 ]" ); // User provided functor
+    V_OPENCL( kernels[1].setArg( 13, *binaryFunctionBuffer ),"Error setArg kernels[ 1 ]" ); // User provided functor
+    V_OPENCL( kernels[1].setArg( 14, *groupHeads ),         "Error setArg kernels[ 1 ]" ); // Input heads per chunk
+    V_OPENCL( kernels[1].setArg( 15, *groupTail ),          "Error setArg kernels[ 1 ]" ); // Input value per chunk
+    V_OPENCL( kernels[1].setArg( 16, *segmentCount ),       "Error setArg kernels[ 1 ]" ); // Output segment count
 
     l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
         kernels[1],
         ::cl::NullRange,
-        ::cl::NDRange( sizeInputBuff ),
-        ::cl::NDRange( kernel0_WgSize ),
-        NULL,
-        &kernel1Event);
+        ::cl::NDRange( numWorkGroups * kernel0_WgSize ),
+        ::cl::NDRange( kernel0_WgSize ) );
     V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel[1]" );
-    }
-    catch( const ::cl::Error& e)
-    {
-        std::cerr << "::cl::enqueueNDRangeKernel( 1 ) in bolt::cl::reduce_by_key_enqueue()" << std::endl;
-        std::cerr << "Error Code:   " << clErrorStringA(e.err()) << " (" << e.err() << ")" << std::endl;
-        std::cerr << "File:         " << __FILE__ << ", line " << __LINE__ << std::endl;
-        std::cerr << "Error String: " << e.what() << std::endl;
-    }
-
-    /**********************************************************************************
-     *  Kernel 2
-     *********************************************************************************/
-    cl_uint workPerThread = static_cast< cl_uint >( sizeScanBuff / kernel1_WgSize );
-    V_OPENCL( kernels[2].setArg( 0, *keySumArray ),         "Error setArg kernels[ 2 ]" ); // Input keys
-    V_OPENCL( kernels[2].setArg( 1, *preSumArray ),         "Error setArg kernels[ 2 ]" ); // Input buffer
-    V_OPENCL( kernels[2].setArg( 2, *postSumArray ),        "Error setArg kernels[ 2 ]" ); // Output buffer
-    V_OPENCL( kernels[2].setArg( 3, numWorkGroupsK0 ),      "Error setArg kernels[ 2 ]" ); // Size of scratch buffer
-    V_OPENCL( kernels[2].setArg( 4, ldsKeySize, NULL ),     "Error setArg kernels[ 2 ]" ); // Scratch buffer
-    V_OPENCL( kernels[2].setArg( 5, ldsValueSize, NULL ),   "Error setArg kernels[ 2 ]" ); // Scratch buffer
-    V_OPENCL( kernels[2].setArg( 6, workPerThread ),        "Error setArg kernels[ 2 ]" ); // Work Per Thread
-    V_OPENCL( kernels[2].setArg( 7, *binaryFunctionBuffer ),"Error setArg kernels[ 2 ]" ); // User provided functor
-
-    try
-    {
-    l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
-        kernels[2],
-        ::cl::NullRange,
-        ::cl::NDRange( kernel1_WgSize ), // only 1 work-group
-        ::cl::NDRange( kernel1_WgSize ),
-        NULL,
-        &kernel2Event);
-    V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel[2]" );
-    }
-    catch( const ::cl::Error& e)
-    {
-        std::cerr << "::cl::enqueueNDRangeKernel( 2 ) in bolt::cl::reduce_by_key_enqueue()" << std::endl;
-        std::cerr << "Error Code:   " << clErrorStringA(e.err()) << " (" << e.err() << ")" << std::endl;
-        std::cerr << "File:         " << __FILE__ << ", line " << __LINE__ << std::endl;
-        std::cerr << "Error String: " << e.what() << std::endl;
-    }
-
-#if ENABLE_PRINTS
-    //delete this code -start
-    bolt::cl::wait(ctl, kernel0Event);
-    bolt::cl::wait(ctl, kernel1Event);
-    ::cl::Event l_mapEvent_k1;
-    voType *post_sum_k1= (voType*)ctl.commandQueue().enqueueMapBuffer( *postSumArray,
-                                                                    false,
-                                                                    CL_MAP_READ,
-                                                                    0,
-                                                                    sizeof(voType)*sizeScanBuff,
-                                                                    NULL,
-                                                                    &l_mapEvent_k1,
-                                                                    &l_Error );
-    V_OPENCL( l_Error, "Error calling map on the result buffer" );
-    std::cout<<"Myval-------------------------starts"<<std::endl;
-    std::ofstream postsum("postsum.txt");
-    for(unsigned int i = 0; i < sizeScanBuff ; i++)
-    {
-        postsum<<post_sum_k1[i]<<std::endl;
-    }
-    postsum.close();
-    std::cout<<"Myval-------------------------ends"<<std::endl;
-    bolt::cl::wait(ctl, l_mapEvent_k1);
-    //delete this code -end
-
-#endif
-
-    /**********************************************************************************
-     *  Kernel 3
-     *********************************************************************************/
-    V_OPENCL( kernels[3].setArg( 0, *keySumArray ),         "Error setArg kernels[ 3 ]" ); // Input buffer
-    V_OPENCL( kernels[3].setArg( 1, *postSumArray ),        "Error setArg kernels[ 3 ]" ); // Input buffer
-    V_OPENCL( kernels[3].setArg( 2, offsetArray), "Error setArg kernels[ 3 ]" ); // Input keys
-    V_OPENCL( kernels[3].setArg( 3, *offsetValArray),   "Error setArg kernels[ 3 ]" ); // Output buffer
-    V_OPENCL( kernels[3].setArg( 4, numElements ),          "Error setArg kernels[ 3 ]" ); // Size of scratch buffer
-    V_OPENCL( kernels[3].setArg( 5, *binaryFunctionBuffer ),"Error setArg kernels[ 3 ]" ); // User provided functor
-
-    try
-    {
-    l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
-        kernels[3],
-        ::cl::NullRange,
-        ::cl::NDRange( sizeInputBuff ),
-        ::cl::NDRange( kernel2_WgSize ),
-        NULL,
-        &kernel2Event );
-    V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel[3]" );
-    }
-    catch( const ::cl::Error& e)
-    {
-        std::cerr << "::cl::enqueueNDRangeKernel( 3 ) in bolt::cl::reduce_by_key_enqueue()" << std::endl;
-        std::cerr << "Error Code:   " << clErrorStringA(e.err()) << " (" << e.err() << ")" << std::endl;
-        std::cerr << "File:         " << __FILE__ << ", line " << __LINE__ << std::endl;
-        std::cerr << "Error String: " << e.what() << std::endl;
-    }
-
-
-#if ENABLE_PRINTS
-    //delete this code -start
-    ::cl::Event l_mapEvent2;
-    voType *v_result = (voType*)ctl.commandQueue().enqueueMapBuffer( *offsetValArray,
-                                                                    false,
-                                                                    CL_MAP_READ,
-                                                                    0,
-                                                                    sizeof(voType)*numElements,
-                                                                    NULL,
-                                                                    &l_mapEvent2,
-                                                                    &l_Error );
-    V_OPENCL( l_Error, "Error calling map on the result buffer" );
-    std::cout<<"Myval-------------------------starts"<<std::endl;
-    std::ofstream val_result("offsetValArray.txt");
-    val_result<<numElements<<std::endl;
-    for(unsigned int i = 0; i < LENGTH_TEST ; i++)
-    {
-        val_result<<v_result[i]<<std::endl;
-    }
-    val_result.close();
-    std::cout<<"Myval-------------------------ends"<<std::endl;
-    bolt::cl::wait(ctl, l_mapEvent2);
-    //delete this code -end
-    std::ofstream result_b4_ser("result_b4_ser.txt");
-    for(unsigned int i = 0; i < LENGTH_TEST ; i++)
-    {
-        //std::cout<<h_result[i]<<std::endl;
-
-        result_b4_ser<<h_result[i]<<std::endl;
-    }
-    result_b4_ser.close();
-#endif
-
 
+    return segmentCount;
+}   //end of reduce_by_key_enqueue_device( )
 
 
-#if ENABLE_PRINTS
-    std::cout<<count_number_of_sections<<std::endl;
-    std::ofstream result_file("offsetArray.txt");
-    for(unsigned int i = 0; i < LENGTH_TEST ; i++)
-    {
-        result_file<<h_result[i]<<std::endl;
-    }
-    result_file.close();
+//  All calls to reduce_by_key on the device end up here, unless an exception was thrown.  The segment count is the
+//  only value read back, once both kernels have been enqueued
+template<
+    typename DVInputIterator1,
+    typename DVInputIterator2,
+    typename DVOutputIterator1,
+    typename DVOutputIterator2,
+    typename BinaryPredicate,
+    typename BinaryFunction >
+size_t
+reduce_by_key_enqueue(
+    control& ctl,
+    const DVInputIterator1& keys_first,
+    const DVInputIterator1& keys_last,
+    const DVInputIterator2& values_first,
+    const DVOutputIterator1& keys_output,
+    const DVOutputIterator2& values_output,
+    const BinaryPredicate& binary_pred,
+    const BinaryFunction& binary_op,
+    const std::string& user_code)
+{
+    ALIGNED( 256 ) BinaryPredicate aligned_binary_pred( binary_pred );
+    ALIGNED( 256 ) BinaryFunction aligned_binary_op( binary_op );
+    control::buffPointer segmentCount = reduce_by_key_enqueue_device( ctl, keys_first, keys_last, values_first,
+        keys_output, values_output, aligned_binary_pred, aligned_binary_op, user_code );
 
-#endif
-    unsigned int count_number_of_sections = 0;
-    /**********************************************************************************
-     *  Kernel 4
-     *********************************************************************************/
-    typename DVInputIterator2::Payload keys_first1_payload = keys_first.gpuPayload( );
-    typename DVOutputIterator1::Payload keys_output_payload = keys_output.gpuPayload( );
-    typename DVOutputIterator2::Payload values_output_payload = values_output.gpuPayload( );
+    cl_ulong count_number_of_sections = 0;
+    ::cl::Event l_readEvent;
+    V_OPENCL( ctl.getCommandQueue( ).enqueueReadBuffer( *segmentCount, CL_FALSE, 0, sizeof( cl_ulong ),
+        &count_number_of_sections, NULL, &l_readEvent ), "Error reading the segment count of reduce_by_key" );
 
-    V_OPENCL( kernels[4].setArg( 0, keys_first.getContainer().getBuffer()),    "Error setArg kernels[ 4 ]" ); // Input buffer
-    V_OPENCL( kernels[4].setArg( 1, keys_first.gpuPayloadSize( ), &keys_first1_payload), "Error setArg kernels[ 4 ]" );
-    V_OPENCL( kernels[4].setArg( 2, keys_output.getContainer().getBuffer() ),  "Error setArg kernels[ 4 ]" ); // Output buffer
-    V_OPENCL( kernels[4].setArg( 3, keys_output.gpuPayloadSize( ),&keys_output_payload ), "Error setArg kernels[ 4 ]" );
-    V_OPENCL( kernels[4].setArg( 4, values_output.getContainer().getBuffer()), "Error setArg kernels[ 4 ]" ); // Output buffer
-    V_OPENCL( kernels[4].setArg( 5, values_output.gpuPayloadSize( ),&values_output_payload ), "Error setArg kernels[ 4 ]" );
-    V_OPENCL( kernels[4].setArg( 6, offsetArray),                "Error setArg kernels[ 4 ]" ); // Input buffer
-    V_OPENCL( kernels[4].setArg( 7, *offsetValArray),             "Error setArg kernels[ 4 ]"  );
-    V_OPENCL( kernels[4].setArg( 8, numElements ),             "Error setArg kernels[ 4 ]" ); // Size of scratch buffer
-    V_OPENCL( kernels[4].setArg( 9, count_number_of_sections), "Error setArg kernels[ 4 ]" ); // Size of scratch buffer
-
-    try
-    {
-    l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
-        kernels[4],
-        ::cl::NullRange,
-        ::cl::NDRange( sizeInputBuff ),
-        ::cl::NDRange( kernel0_WgSize ),
-        NULL,
-        &kernel4Event );
-    V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for kernel[3]" );
-    }
-    catch( const ::cl::Error& e)
-    {
-        std::cerr << "::cl::enqueueNDRangeKernel( 3 ) in bolt::cl::reduce_by_key_enqueue()" << std::endl;
-        std::cerr << "Error Code:   " << clErrorStringA(e.err()) << " (" << e.err() << ")" << std::endl;
-        std::cerr << "File:         " << __FILE__ << ", line " << __LINE__ << std::endl;
-        std::cerr << "Error String: " << e.what() << std::endl;
-    }
-    // wait for results
-    l_Error = kernel4Event.wait( );
-    V_OPENCL( l_Error, "post-kernel[3] failed wait" );
-
-    ::cl::Event l_mapEvent;
-    int *h_result = (int*)ctl.getCommandQueue().enqueueMapBuffer( offsetArray,
-                                                                    false,
-                                                                    CL_MAP_READ | CL_MAP_WRITE,
-                                                                    (numElements-1)*sizeof(int),
-                                                                    sizeof(int)*1,
-                                                                    NULL,
-                                                                    &l_mapEvent,
-                                                                    &l_Error );
-    V_OPENCL( l_Error, "Error calling map on the result buffer" );
-
-    bolt::cl::wait(ctl, l_mapEvent);
-
-
-    count_number_of_sections = *(h_result);
-
-
-
-#if ENABLE_PRINTS
-    //delete this code -start
-    ::cl::Event l_mapEvent3;
-    voType *v_result2 = (voType*)ctl.commandQueue().enqueueMapBuffer( *offsetValArray,
-                                                                    false,
-                                                                    CL_MAP_READ,
-                                                                    0,
-                                                                    sizeof(voType)*numElements,
-                                                                    NULL,
-                                                                    &l_mapEvent3,
-                                                                    &l_Error );
-    V_OPENCL( l_Error, "Error calling map on the result buffer" );
-    std::cout<<"Myval-------------------------starts"<<std::endl;
-    std::ofstream result_val_after_launch("result_val_after_launch.txt");
-    for(unsigned int i = 0; i < LENGTH_TEST ; i++)
-    {
-        result_val_after_launch<<v_result2[i]<<std::endl;
-    }
-    result_val_after_launch.close();
-    std::cout<<"Myval-------------------------ends"<<std::endl;
-    bolt::cl::wait(ctl, l_mapEvent3);
-    //delete this code -end
+    bolt::cl::wait( ctl, l_readEvent, "reduce_by_key" );
 
-#endif
-    return count_number_of_sections;
-    }   //end of reduce_by_key_enqueue( )
+    return static_cast< size_t >( count_number_of_sections );
+}   //end of reduce_by_key_enqueue( )
 
 
 
@@ -706,14 +436,13 @@ reduce_by_key_pick_iterator(
     typedef typename std::iterator_traits< OutputIterator2 >::value_type voType;
     static_assert( std::is_convertible< vType, voType >::value, "InputValue and Output iterators are incompatible" );
 
-    unsigned int numElements = static_cast< unsigned int >( std::distance( keys_first, keys_last ) );
+    size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
     if( numElements == 1 )
         return bolt::cl::make_pair( keys_last, values_first+numElements );
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-    if(runMode == bolt::cl::control::Automatic) {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements,
+        sizeof( kType ) + sizeof( vType ), false, true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
 	#if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -722,7 +451,7 @@ reduce_by_key_pick_iterator(
             #if defined(BOLT_DEBUG_LOG)
             dblog->CodePathTaken(BOLTLOG::BOLT_REDUCEBYKEY,BOLTLOG::BOLT_SERIAL_CPU,"::Reduce_By_Key::SERIAL_CPU");
             #endif
-            unsigned int sizeOfOut = gold_reduce_by_key_enqueue( keys_first, keys_last, values_first, keys_output,
+            size_t sizeOfOut = gold_reduce_by_key_enqueue( keys_first, keys_last, values_first, keys_output,
             values_output, binary_pred, binary_op);
 
             return  bolt::cl::make_pair(keys_output+sizeOfOut, values_output+sizeOfOut);
@@ -743,7 +472,7 @@ reduce_by_key_pick_iterator(
      #if defined(BOLT_DEBUG_LOG)
      dblog->CodePathTaken(BOLTLOG::BOLT_REDUCEBYKEY,BOLTLOG::BOLT_OPENCL_GPU,"::Reduce_By_Key::OPENCL_GPU");
      #endif
-    unsigned int sizeOfOut;
+    size_t sizeOfOut;
     {
 
         // Map the input iterator to a device_vector
@@ -805,15 +534,13 @@ reduce_by_key_pick_iterator(
     typedef typename std::iterator_traits< DVOutputIterator2 >::value_type voType;
     static_assert( std::is_convertible< vType, voType >::value, "InputValue and Output iterators are incompatible" );
 
-    unsigned int numElements = static_cast< unsigned int >( std::distance( keys_first, keys_last ) );
+    size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
      if( numElements == 1 )
         return bolt::cl::make_pair( keys_last, values_first+numElements );
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );  // could be dynamic choice some day.
-    if(runMode == bolt::cl::control::Automatic)
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( kType ) + sizeof( vType ), true,
+        true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -828,7 +555,7 @@ reduce_by_key_pick_iterator(
         typename bolt::cl::device_vector< vType >::pointer valsPtr =  values_first.getContainer( ).data( );
         typename bolt::cl::device_vector< koType >::pointer oKeysPtr =  keys_output.getContainer( ).data( );
         typename bolt::cl::device_vector< voType >::pointer oValsPtr =  values_output.getContainer( ).data( );
-        unsigned int sizeOfOut = gold_reduce_by_key_enqueue( &keysPtr[keys_first.m_Index], &keysPtr[numElements],
+        size_t sizeOfOut = gold_reduce_by_key_enqueue( &keysPtr[keys_first.m_Index], &keysPtr[numElements],
                                            &valsPtr[values_first.m_Index], &oKeysPtr[keys_output.m_Index],
                                           &oValsPtr[values_output.m_Index], binary_pred, binary_op);
         return bolt::cl::make_pair(keys_output+sizeOfOut, values_output+sizeOfOut);
@@ -859,7 +586,7 @@ reduce_by_key_pick_iterator(
             dblog->CodePathTaken(BOLTLOG::BOLT_REDUCEBYKEY,BOLTLOG::BOLT_OPENCL_GPU,"::Reduce_By_Key::OPENCL_GPU");
             #endif
             //Now call the actual cl algorithm
-            unsigned int sizeOfOut = reduce_by_key_enqueue( ctl, keys_first, keys_last, values_first, keys_output,
+            size_t sizeOfOut = reduce_by_key_enqueue( ctl, keys_first, keys_last, values_first, keys_output,
             values_output, binary_pred, binary_op, user_code);
 
             return  bolt::cl::make_pair(keys_output+sizeOfOut, values_output+sizeOfOut);
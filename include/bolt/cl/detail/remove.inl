@@ -0,0 +1,52 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_REMOVE_INL )
+#define BOLT_CL_REMOVE_INL
+#pragma once
+
+#include "bolt/cl/detail/compaction.inl"
+
+namespace bolt {
+    namespace cl {
+
+        template< typename ForwardIterator, typename Predicate >
+        ForwardIterator remove_if( bolt::cl::control &ctl,
+                                   ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code )
+        {
+            size_t numKept = detail::compaction_inplace_detect_random_access( ctl, first, last, first,
+                detail::CompactionRemoveIf< Predicate >( pred ), false, false, cl_code,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+            return first + numKept;
+        }
+
+        template< typename ForwardIterator, typename Predicate >
+        ForwardIterator remove_if( ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code )
+        {
+            return bolt::cl::remove_if( bolt::cl::control::getDefault( ), first, last, pred, cl_code );
+        }
+
+    } // cl
+} // bolt
+
+#endif // BOLT_CL_REMOVE_INL
@@ -48,6 +48,7 @@
 #include <algorithm>
 #include <type_traits>
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include <exception>
 
 
@@ -142,6 +143,7 @@ public:
         addKernelName("perBlockInclusiveScan");
         addKernelName("intraBlockInclusiveScan");
         addKernelName("perBlockAddition");
+        addKernelName("singlePassScan");
 #endif
     }
 
@@ -210,6 +212,24 @@ public:
             "global " + typeNames[scan_BinaryFunction] + "* binaryOp,\n"
             "int exclusive,\n"
              ""        + typeNames[scan_initType] + " identity\n"
+            ");\n\n"
+
+            "// Template specialization\n"
+            "template __attribute__((mangled_name(" + name(3) + "Instantiated)))\n"
+            "__attribute__((reqd_work_group_size(KERNEL0WORKGROUPSIZE,1,1)))\n"
+            "kernel void " + name(3) + "(\n"
+            "global " + typeNames[scan_iValueType] + "* input_ptr,\n"
+            ""        + typeNames[scan_iIterType] + " input_iter,\n"
+            "global " + typeNames[scan_oValueType] + "* output_ptr,\n"
+            ""        + typeNames[scan_oIterType] + " output_iter,\n"
+            ""        + typeNames[scan_initType] + " identity,\n"
+            "const uint vecSize,\n"
+            "local "  + typeNames[scan_iValueType] + "* lds,\n"
+            "global " + typeNames[scan_BinaryFunction] + "* binaryOp,\n"
+            "global " + typeNames[scan_iValueType] + "* tileAggregate,\n"
+            "global " + typeNames[scan_iValueType] + "* tileInclusive,\n"
+            "global int* tileStatus,\n"
+            "int exclusive\n"
             ");\n\n";
 #endif
             return templateSpecializationString;
@@ -286,13 +306,15 @@ aProfiler.set(AsyncProfiler::device, control::SerialCpu);
      * Request Compiled Kernels
      *********************************************************************************/
     Scan_KernelTemplateSpecializer ts_kts;
+    static ProgramCacheSlot ts_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctrl,
         typeNames,
         &ts_kts,
         typeDefinitions,
-        scan_kernels,
-        compileOptions);
+        scan_lookback_kernels + scan_kernels,
+        compileOptions,
+        &ts_ktsSlot );
     // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
 #ifdef BOLT_PROFILER_ENABLED
@@ -498,6 +520,49 @@ aProfiler.stopTrial();
     // for profiling
     ::cl::Event kernel0Event, kernel1Event, kernel2Event, kernelAEvent;
 
+    /**********************************************************************************
+     *  Single pass: one tile per work-group, chained through a tile status buffer
+     *********************************************************************************/
+    if( !cpuDevice && singlePassScanSupported( ctrl ) )
+    {
+        // the last status word is the counter that hands out tile numbers
+        cl_uint numTiles = numWorkGroupsK0;
+        control::buffPointer tileAggregate = ctrl.acquireBuffer( numTiles*sizeof( iType ) );
+        control::buffPointer tileInclusive = ctrl.acquireBuffer( numTiles*sizeof( iType ) );
+        control::buffPointer tileStatus = ctrl.acquireBuffer( ( numTiles + 1 )*sizeof( cl_int ) );
+        V_OPENCL( ctrl.getCommandQueue( ).enqueueFillBuffer< cl_int >( *tileStatus, 0, 0,
+            ( numTiles + 1 )*sizeof( cl_int ) ), "Error clearing tile status for singlePassScan" );
+
+        typename DVInputIterator::Payload first_payload = first.gpuPayload( );
+        typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
+
+        ldsSize = static_cast< cl_uint >( ( kernel0_WgSize*2 ) * sizeof( iType ) );
+        V_OPENCL( kernels[ 3 ].setArg( 0, first.getContainer().getBuffer() ), "Error setting argument for kernels[ 3 ]" ); // Input buffer
+        V_OPENCL( kernels[ 3 ].setArg( 1, first.gpuPayloadSize( ), &first_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[ 3 ].setArg( 2, result.getContainer().getBuffer() ), "Error setting argument for kernels[ 3 ]" ); // Output buffer
+        V_OPENCL( kernels[ 3 ].setArg( 3, result.gpuPayloadSize( ), &result_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[ 3 ].setArg( 4, init_T ),           "Error setting argument for kernels[ 3 ]" ); // Initial value used for exclusive scan
+        V_OPENCL( kernels[ 3 ].setArg( 5, numElements ),      "Error setting argument for kernels[ 3 ]" ); // Number of elements
+        V_OPENCL( kernels[ 3 ].setArg( 6, ldsSize, NULL ),    "Error setting argument for kernels[ 3 ]" ); // Scratch buffer
+        V_OPENCL( kernels[ 3 ].setArg( 7, *userFunctor ),     "Error setting argument for kernels[ 3 ]" ); // User provided functor class
+        V_OPENCL( kernels[ 3 ].setArg( 8, *tileAggregate ),   "Error setting argument for kernels[ 3 ]" ); // Per tile reduction
+        V_OPENCL( kernels[ 3 ].setArg( 9, *tileInclusive ),   "Error setting argument for kernels[ 3 ]" ); // Per tile inclusive prefix
+        V_OPENCL( kernels[ 3 ].setArg( 10, *tileStatus ),     "Error setting argument for kernels[ 3 ]" ); // Per tile status flags
+        V_OPENCL( kernels[ 3 ].setArg( 11, doExclusiveScan ), "Error setting argument for kernels[ 3 ]" ); // Exclusive scan?
+
+        l_Error = ctrl.getCommandQueue( ).enqueueNDRangeKernel(
+            kernels[ 3 ],
+            ::cl::NullRange,
+            ::cl::NDRange( numElementsRUP/2 ),
+            ::cl::NDRange( kernel0_WgSize ),
+            NULL,
+            &kernelAEvent );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for singlePassScan kernel" );
+
+        bolt::cl::wait( ctrl, kernelAEvent, "scan" );
+        return;
+    }
+
                 //  Ceiling function to bump the size of the sum array to the next whole wavefront size
     typename device_vector< iType >::size_type sizeScanBuff = numWorkGroupsK0;
     modWgSize = (sizeScanBuff & ((kernel0_WgSize*2)-1));
@@ -778,12 +843,8 @@ aProfiler.setArchitecture(strDeviceName);
             if( numElements < 1 )
                 return result;
 
-            bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-            if( runMode == bolt::cl::control::Automatic )
-            {
-                runMode = ctrl.getDefaultPathToRun( );
-            }
+            bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, numElements, sizeof( iType ), false );
+            bolt::cl::tbbArenaScope tbbScope( ctrl );
             #if defined(BOLT_DEBUG_LOG)
             BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
             #endif
@@ -879,12 +940,8 @@ aProfiler.stopTrial();
             if( numElements < 1 )
                 return result;
 
-            bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-            if( runMode == bolt::cl::control::Automatic )
-            {
-                runMode = ctrl.getDefaultPathToRun( );
-            }
+            bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, numElements, sizeof( iType ), true );
+            bolt::cl::tbbArenaScope tbbScope( ctrl );
             #if defined(BOLT_DEBUG_LOG)
             BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
             #endif
@@ -951,12 +1008,9 @@ aProfiler.stopTrial();
             if( numElements == 0 )
                 return result;
 
-            bolt::cl::control::e_RunMode runMode = ctrl.getForceRunMode( );
-
-            if( runMode == bolt::cl::control::Automatic )
-            {
-                runMode = ctrl.getDefaultPathToRun( );
-            }
+            bolt::cl::control::e_RunMode runMode = selectRunMode( ctrl, numElements, sizeof( iType ), false );
+            runMode = detail::iteratorRunMode( ctrl, runMode, fancyFirst );
+            bolt::cl::tbbArenaScope tbbScope( ctrl );
             #if defined(BOLT_DEBUG_LOG)
             BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
             #endif
@@ -157,6 +157,7 @@ class ScanByKey_KernelTemplateSpecializer : public KernelTemplateSpecializer
         addKernelName("perBlockScanByKey");
         addKernelName("intraBlockInclusiveScanByKey");
         addKernelName("perBlockAdditionByKey");
+        addKernelName("singlePassScanByKey");
     }
 
     const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
@@ -218,6 +219,29 @@ class ScanByKey_KernelTemplateSpecializer : public KernelTemplateSpecializer
             "global " + typeNames[scanByKey_BinaryFunction] + "* binaryFunct,\n"
             "int exclusive,\n"
             ""        + typeNames[scanByKey_initType] + " identity\n"
+            ");\n\n"
+
+            "// Dynamic specialization of generic template definition, using user supplied types\n"
+            "template __attribute__((mangled_name(" + name(3) + "Instantiated)))\n"
+            "__attribute__((reqd_work_group_size(KERNEL0WORKGROUPSIZE,1,1)))\n"
+            "__kernel void " + name(3) + "(\n"
+            "global " + typeNames[scanByKey_kType] + "* keys,\n"
+            ""        + typeNames[scanByKey_kIterType] + " keys_iter,\n"
+            "global " + typeNames[scanByKey_vType] + "* vals,\n"
+            ""        + typeNames[scanByKey_iIterType] + " vals_iter,\n"
+            "global " + typeNames[scanByKey_oType] + "* output,\n"
+            ""        + typeNames[scanByKey_oIterType] + " output_iter,\n"
+            ""        + typeNames[scanByKey_initType] + " init,\n"
+            "const uint vecSize,\n"
+            "local "  + typeNames[scanByKey_kType] + "* ldsKeys,\n"
+            "local "  + typeNames[scanByKey_oType] + "* ldsVals,\n"
+            "local int* ldsFlags,\n"
+            "global " + typeNames[scanByKey_BinaryPredicate] + "* binaryPred,\n"
+            "global " + typeNames[scanByKey_BinaryFunction] + "* binaryFunct,\n"
+            "global " + typeNames[scanByKey_oType] + "* tileAggregate,\n"
+            "global " + typeNames[scanByKey_oType] + "* tileInclusive,\n"
+            "global int* tileStatus,\n"
+            "int exclusive\n"
             ");\n\n";
 
         return templateSpecializationString;
@@ -310,13 +334,15 @@ size_t k0_stepNum, k1_stepNum, k2_stepNum;
      * Request Compiled Kernels
      *********************************************************************************/
     ScanByKey_KernelTemplateSpecializer ts_kts;
+    static ProgramCacheSlot ts_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &ts_kts,
         typeDefs,
-        scan_by_key_kernels,
-        compileOptions);
+        scan_lookback_kernels + scan_by_key_kernels,
+        compileOptions,
+        &ts_ktsSlot );
     // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
     // for profiling
@@ -357,6 +383,59 @@ size_t k0_stepNum, k1_stepNum, k2_stepNum;
     control::buffPointer binaryFunctionBuffer = ctl.acquireBuffer( sizeof( aligned_binary_funct ),
         CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_binary_funct );
 
+    /**********************************************************************************
+     *  Single pass: one tile per work-group, chained through a tile status buffer
+     *********************************************************************************/
+    if( !cpuDevice && singlePassScanSupported( ctl ) )
+    {
+        // the last status word is the counter that hands out tile numbers
+        control::buffPointer tileAggregate = ctl.acquireBuffer( numWorkGroupsK0*sizeof( oType ) );
+        control::buffPointer tileInclusive = ctl.acquireBuffer( numWorkGroupsK0*sizeof( oType ) );
+        control::buffPointer tileStatus = ctl.acquireBuffer( ( numWorkGroupsK0 + 1 )*sizeof( cl_int ) );
+        V_OPENCL( ctl.getCommandQueue( ).enqueueFillBuffer< cl_int >( *tileStatus, 0, 0,
+            ( numWorkGroupsK0 + 1 )*sizeof( cl_int ) ), "Error clearing tile status for singlePassScanByKey" );
+
+        typename DVInputIterator1::Payload firstKey_payload = firstKey.gpuPayload( );
+        typename DVInputIterator2::Payload firstValue_payload = firstValue.gpuPayload( );
+        typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
+
+        cl_uint ldsKeySize   = static_cast< cl_uint >( (kernel0_WgSize*2) * sizeof( kType ) );
+        cl_uint ldsValueSize = static_cast< cl_uint >( (kernel0_WgSize*2) * sizeof( oType ) );
+        cl_uint ldsFlagSize  = static_cast< cl_uint >( (kernel0_WgSize*2) * sizeof( cl_int ) );
+        V_OPENCL( kernels[3].setArg( 0, firstKey.getContainer().getBuffer()),  "Error setArg kernels[ 3 ]" ); // Input keys
+        V_OPENCL( kernels[3].setArg( 1, firstKey.gpuPayloadSize( ), &firstKey_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[3].setArg( 2, firstValue.getContainer().getBuffer()),"Error setArg kernels[ 3 ]" ); // Input buffer
+        V_OPENCL( kernels[3].setArg( 3, firstValue.gpuPayloadSize( ), &firstValue_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[3].setArg( 4, result.getContainer().getBuffer()),    "Error setArg kernels[ 3 ]" ); // Output buffer
+        V_OPENCL( kernels[3].setArg( 5, result.gpuPayloadSize( ), &result_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[3].setArg( 6, init ),                 "Error setArg kernels[ 3 ]" ); // Initial value exclusive
+        V_OPENCL( kernels[3].setArg( 7, numElements ),          "Error setArg kernels[ 3 ]" ); // Number of elements
+        V_OPENCL( kernels[3].setArg( 8, ldsKeySize, NULL ),     "Error setArg kernels[ 3 ]" ); // Scratch buffer
+        V_OPENCL( kernels[3].setArg( 9, ldsValueSize, NULL ),   "Error setArg kernels[ 3 ]" ); // Scratch buffer
+        V_OPENCL( kernels[3].setArg(10, ldsFlagSize, NULL ),    "Error setArg kernels[ 3 ]" ); // Scratch buffer
+        V_OPENCL( kernels[3].setArg(11, *binaryPredicateBuffer),"Error setArg kernels[ 3 ]" ); // User provided functor
+        V_OPENCL( kernels[3].setArg(12, *binaryFunctionBuffer ),"Error setArg kernels[ 3 ]" ); // User provided functor
+        V_OPENCL( kernels[3].setArg(13, *tileAggregate ),       "Error setArg kernels[ 3 ]" ); // Per tile reduction
+        V_OPENCL( kernels[3].setArg(14, *tileInclusive ),       "Error setArg kernels[ 3 ]" ); // Per tile inclusive value
+        V_OPENCL( kernels[3].setArg(15, *tileStatus ),          "Error setArg kernels[ 3 ]" ); // Per tile status flags
+        V_OPENCL( kernels[3].setArg(16, doExclusiveScan ),      "Error setArg kernels[ 3 ]" ); // Exclusive scan?
+
+        l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
+            kernels[3],
+            ::cl::NullRange,
+            ::cl::NDRange( sizeInputBuff/2 ),
+            ::cl::NDRange( kernel0_WgSize ),
+            NULL,
+            &kernelAEvent );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for singlePassScanByKey" );
+
+        bolt::cl::wait( ctl, kernelAEvent, "scan_by_key" );
+#ifdef BOLT_ENABLE_PROFILING
+aProfiler.stopTrial();
+#endif
+        return;
+    }
+
     control::buffPointer keySumArray  = ctl.acquireBuffer( sizeScanBuff*sizeof( kType ) );
     control::buffPointer preSumArray  = ctl.acquireBuffer( sizeScanBuff*sizeof( vType ) );
     control::buffPointer preSumArray1  = ctl.acquireBuffer( sizeScanBuff*sizeof( vType ) );
@@ -632,12 +711,9 @@ scan_by_key_pick_iterator(
         return result;
 
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun( );
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements,
+        sizeof( kType ) + sizeof( vType ), false );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -737,12 +813,8 @@ scan_by_key_pick_iterator(
     if( numElements < 1 )
         return result;
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun( );
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( kType ) + sizeof( vType ), true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
 
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
@@ -27,6 +27,7 @@
 #endif
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/device_vector.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 #include "bolt/cl/functional.h"
@@ -49,9 +50,9 @@ void gold_scatter_enqueue (InputIterator1 first1,
                            InputIterator2 map,
                            OutputIterator result)
     {
-       size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
+       size_t numElements = static_cast< size_t >( std::distance( first1, last1 ) );
 
-       for(int iter = 0; iter<numElements; iter++)
+       for(size_t iter = 0; iter<numElements; iter++)
                 *(result+*(map + iter)) = *(first1 + iter);
     }
 
@@ -65,8 +66,8 @@ void gold_scatter_if_enqueue (InputIterator1 first1,
                               InputIterator3 stencil,
                               OutputIterator result)
    {
-       size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
-       for(int iter = 0; iter<numElements; iter++)
+       size_t numElements = static_cast< size_t >( std::distance( first1, last1 ) );
+       for(size_t iter = 0; iter<numElements; iter++)
         {
              if(stencil[iter] == 1)
                   result[*(map+(iter - 0))] = first1[iter];
@@ -85,8 +86,8 @@ void gold_scatter_if_enqueue (InputIterator1 first1,
                               OutputIterator result,
                               Predicate pred)
    {
-       size_t numElements = static_cast< unsigned int >( std::distance( first1, last1 ) );
-       for(int iter = 0; iter<numElements; iter++)
+       size_t numElements = static_cast< size_t >( std::distance( first1, last1 ) );
+       for(size_t iter = 0; iter<numElements; iter++)
         {
              if(pred(stencil[iter]) != 0)
                   result[*(map+(iter))] = first1[iter];
@@ -128,7 +129,7 @@ public:
         + scatterIfKernels[scatter_if_DVStencilType] + " stencilIter, \n"
         "global " + scatterIfKernels[scatter_if_resultType] + "* result, \n"
         + scatterIfKernels[scatter_if_DVResultType] + " resultIter, \n"
-        "const uint length, \n"
+        "const BOLT_INDEX_T length, \n"
         "global " + scatterIfKernels[scatter_if_Predicate] + "* functor);\n\n";
 
         return templateSpecializationString;
@@ -164,7 +165,7 @@ public:
         + scatterKernels[scatter_DVMapType] + " mapIter, \n"
         "global " + scatterKernels[scatter_resultType] + "* result, \n"
         + scatterKernels[scatter_DVResultType] + " resultIter, \n"
-        "const uint length ); \n";
+        "const BOLT_INDEX_T length ); \n";
 
         return templateSpecializationString;
     }
@@ -193,7 +194,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator3>::value_type iType3;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >(  first1.distance_to(last1) );
+        size_t distVec = static_cast< size_t >(  first1.distance_to(last1) );
         if( distVec == 0 )
             return;
 
@@ -266,19 +267,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
           * Request Compiled Kernels
           *********************************************************************************/
          ScatterIf_KernelTemplateSpecializer s_if_kts;
+         static ProgramCacheSlot s_if_ktsSlot;
          std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
              ctl,
              scatterIfKernels,
              &s_if_kts,
              typeDefinitions,
              scatter_kernels,
-             compileOptions);
+             compileOptions,
+             &s_if_ktsSlot );
          // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
         ALIGNED( 256 ) Predicate aligned_binary( pred );
@@ -299,7 +304,7 @@ public:
         kernels[boundsCheck].setArg( 5, stencil.gpuPayloadSize( ),&stencil_payload  );
         kernels[boundsCheck].setArg( 6, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg( 7, result.gpuPayloadSize( ),&result_payload );
-        kernels[boundsCheck].setArg( 8, distVec );
+        index.setArg( kernels[boundsCheck], 8, distVec );
         kernels[boundsCheck].setArg( 9, *userPredicate );
 
         ::cl::Event scatterIfEvent;
@@ -312,7 +317,7 @@ public:
             &scatterIfEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for scatter_if() kernel" );
 
-        ::bolt::cl::wait(ctl, scatterIfEvent);
+        ::bolt::cl::deferredWait(ctl, scatterIfEvent, "scatter_if");
 
     };
 
@@ -333,7 +338,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator2>::value_type iType2;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >(  first1.distance_to(last1) );
+        size_t distVec = static_cast< size_t >(  first1.distance_to(last1) );
         if( distVec == 0 )
             return;
 
@@ -400,19 +405,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
           * Request Compiled Kernels
           *********************************************************************************/
          ScatterKernelTemplateSpecializer s_kts;
+         static ProgramCacheSlot s_ktsSlot;
          std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
              ctl,
              scatterKernels,
              &s_kts,
              typeDefinitions,
              scatter_kernels,
-             compileOptions);
+             compileOptions,
+             &s_ktsSlot );
          // kernels returned in same order as added in KernelTemplaceSpecializer constructor
         typename DVInputIterator1::Payload first11_payload = first1.gpuPayload( );
         typename DVInputIterator2::Payload map1_payload = map.gpuPayload( ) ;
@@ -424,7 +433,7 @@ public:
         kernels[boundsCheck].setArg( 3, map.gpuPayloadSize( ), &map1_payload);
         kernels[boundsCheck].setArg( 4, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg( 5, result.gpuPayloadSize( ),&result1_payload );
-        kernels[boundsCheck].setArg( 6, distVec );
+        index.setArg( kernels[boundsCheck], 6, distVec );
 
         ::cl::Event scatterEvent;
         l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
@@ -436,7 +445,7 @@ public:
             &scatterEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for scatter_if() kernel" );
 
-        ::bolt::cl::wait(ctl, scatterEvent);
+        ::bolt::cl::deferredWait(ctl, scatterEvent, "scatter");
 
     };
 
@@ -482,11 +491,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -564,11 +570,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, stencilFancyIter );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -647,11 +651,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancyIterfirst );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -732,11 +734,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -820,11 +819,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -894,11 +890,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, firstFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -969,11 +963,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, mapFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 	    #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1044,11 +1036,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1120,11 +1109,9 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, firstFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1191,11 +1178,9 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, mapFancy );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1264,11 +1249,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -1340,11 +1322,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-          runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 	    #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -0,0 +1,617 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_SEGMENTED_SORT_INL )
+#define BOLT_CL_SEGMENTED_SORT_INL
+#pragma once
+
+#define SEGSORT_WGSIZE 256
+#define SEGSORT_SERIAL_MAX 32
+#define SEGSORT_LOCAL_MIN 64
+#define SEGSORT_LOCAL_MAX 2048
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/functional.h"
+#include "bolt/cl/copy.h"
+#include "bolt/cl/sort.h"
+#include "bolt/cl/sort_by_key.h"
+
+#if defined(ENABLE_TBB)
+#include "bolt/btbb/segmented_sort.h"
+#endif
+
+namespace bolt {
+namespace cl {
+namespace detail {
+
+    /*  Segment s of numElements elements ends where segment s + 1 starts  */
+    template< typename offType >
+    size_t segmented_sort_end( const std::vector< offType >& offsets, size_t s, size_t numElements )
+    {
+        return ( s + 1 < offsets.size( ) ) ? static_cast< size_t >( offsets[ s + 1 ] ) : numElements;
+    }
+
+    template< typename KeysIterator, typename StrictWeakOrdering >
+    struct SegmentedSortPositionLess
+    {
+        KeysIterator keys;
+        StrictWeakOrdering comp;
+        SegmentedSortPositionLess( const KeysIterator& _keys, const StrictWeakOrdering& _comp ) :
+            keys( _keys ), comp( _comp ) { }
+
+        bool operator()( size_t a, size_t b ) const { return comp( keys[ a ], keys[ b ] ); }
+    };
+
+    /*  Sorts count keys, and the values with them, on the host  */
+    template< typename KeysIterator, typename ValuesIterator, typename StrictWeakOrdering >
+    void segmented_sort_segment( KeysIterator keys, ValuesIterator values, size_t count,
+                                 const StrictWeakOrdering& comp, bool hasValues )
+    {
+        typedef typename std::iterator_traits< KeysIterator >::value_type kType;
+        typedef typename std::iterator_traits< ValuesIterator >::value_type vType;
+
+        if( !hasValues )
+        {
+            std::sort( keys, keys + count, comp );
+            return;
+        }
+
+        std::vector< size_t > order( count );
+        for( size_t i = 0; i < count; ++i )
+            order[ i ] = i;
+        std::sort( order.begin( ), order.end( ),
+                   SegmentedSortPositionLess< KeysIterator, StrictWeakOrdering >( keys, comp ) );
+
+        std::vector< kType > sortedKeys( count );
+        std::vector< vType > sortedValues( count );
+        for( size_t i = 0; i < count; ++i )
+        {
+            sortedKeys[ i ] = keys[ order[ i ] ];
+            sortedValues[ i ] = values[ order[ i ] ];
+        }
+        std::copy( sortedKeys.begin( ), sortedKeys.end( ), keys );
+        std::copy( sortedValues.begin( ), sortedValues.end( ), values );
+    }
+
+    template< typename KeysIterator, typename ValuesIterator, typename offType, typename StrictWeakOrdering >
+    void segmented_sort_cpu( bolt::cl::control::e_RunMode runMode, KeysIterator keys_first, size_t numElements,
+                             ValuesIterator values_first, const std::vector< offType >& offsets,
+                             const StrictWeakOrdering& comp, bool hasValues )
+    {
+        if( runMode == bolt::cl::control::SerialCpu )
+        {
+            for( size_t s = 0; s < offsets.size( ); ++s )
+            {
+                size_t begin = static_cast< size_t >( offsets[ s ] );
+                size_t end = segmented_sort_end( offsets, s, numElements );
+                if( end > begin + 1 )
+                    segmented_sort_segment( keys_first + begin, values_first + begin, end - begin, comp,
+                                            hasValues );
+            }
+            return;
+        }
+
+        #if defined( ENABLE_TBB )
+            if( hasValues )
+                bolt::btbb::segmented_sort_by_key( keys_first, keys_first + numElements, values_first,
+                                                   offsets.begin( ), offsets.end( ), comp );
+            else
+                bolt::btbb::segmented_sort( keys_first, keys_first + numElements, offsets.begin( ), offsets.end( ),
+                                            comp );
+        #else
+            throw std::runtime_error( "The MultiCoreCpu version of segmented_sort is not enabled to be built! \n" );
+        #endif
+    }
+
+    enum segmentedSortTypeName { ss_kType, ss_kIterType, ss_vType, ss_vIterType, ss_StrictWeakOrdering, ss_end };
+
+    class SegmentedSort_KernelTemplateSpecializer : public KernelTemplateSpecializer
+    {
+    public:
+        SegmentedSort_KernelTemplateSpecializer( ) : KernelTemplateSpecializer( )
+        {
+            addKernelName( "segmentedSortSerial" );
+            addKernelName( "segmentedSortLocal" );
+        }
+
+        const ::std::string operator() ( const ::std::vector< ::std::string >& typeNames ) const
+        {
+            const std::string templateSpecializationString =
+                "// Host generates this instantiation string with user-specified value type and functor\n"
+                "template __attribute__((mangled_name(" + name( 0 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(SEGSORT_WG_SIZE,1,1)))\n"
+                "kernel void segmentedSortSerial(\n"
+                "global " + typeNames[ ss_kType ] + "* keys_ptr,\n"
+                + typeNames[ ss_kIterType ] + " keys_iter,\n"
+                "global " + typeNames[ ss_vType ] + "* values_ptr,\n"
+                + typeNames[ ss_vIterType ] + " values_iter,\n"
+                "global const uint* segments,\n"
+                "const uint firstSegment,\n"
+                "const uint numSegments,\n"
+                "global " + typeNames[ ss_StrictWeakOrdering ] + "* comp,\n"
+                "const int hasValues\n"
+                ");\n\n"
+
+                "// Host generates this instantiation string with user-specified value type and functor\n"
+                "template __attribute__((mangled_name(" + name( 1 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(SEGSORT_WG_SIZE,1,1)))\n"
+                "kernel void segmentedSortLocal(\n"
+                "global " + typeNames[ ss_kType ] + "* keys_ptr,\n"
+                + typeNames[ ss_kIterType ] + " keys_iter,\n"
+                "global " + typeNames[ ss_vType ] + "* values_ptr,\n"
+                + typeNames[ ss_vIterType ] + " values_iter,\n"
+                "global const uint* segments,\n"
+                "const uint firstSegment,\n"
+                "const uint tileSize,\n"
+                "global " + typeNames[ ss_StrictWeakOrdering ] + "* comp,\n"
+                "const int hasValues,\n"
+                "local " + typeNames[ ss_kType ] + "* localKeys,\n"
+                "local " + typeNames[ ss_vType ] + "* localValues,\n"
+                "local uint* localOrder\n"
+                ");\n\n";
+
+            return templateSpecializationString;
+        }
+    };
+
+    /*! \brief Device segmented sort.  Without values, values_first is expected to repeat keys_first.
+     *  \details The segments are grouped on the host: those of up to SEGSORT_SERIAL_MAX elements go to
+     *  segmentedSortSerial, those that fit in local memory to one segmentedSortLocal launch per power of two
+     *  tile size, so that short segments do not pay for the local memory and the network of long ones.
+     *  Longer segments are sorted one after another by sort or sort_by_key.
+     */
+    template< typename DVKeysIterator, typename DVValuesIterator, typename offType, typename StrictWeakOrdering >
+    void segmented_sort_enqueue( bolt::cl::control &ctl, const DVKeysIterator& keys_first,
+                                 const DVKeysIterator& keys_last, const DVValuesIterator& values_first,
+                                 const std::vector< offType >& offsets, const StrictWeakOrdering& comp,
+                                 bool hasValues, const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< DVKeysIterator >::value_type kType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+        typedef typename std::iterator_traits< DVKeysIterator >::difference_type difference_type;
+
+        size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+
+        //  The largest tile whose keys, values and positions fit in local memory
+        cl_ulong localMemSize = ctl.getDevice( ).getInfo< CL_DEVICE_LOCAL_MEM_SIZE >( );
+        size_t bytesPerElement = sizeof( kType ) + ( hasValues ? sizeof( vType ) : 0 ) + sizeof( cl_uint );
+        size_t tileLimit = SEGSORT_LOCAL_MAX;
+        while( tileLimit >= SEGSORT_LOCAL_MIN && tileLimit * bytesPerElement > localMemSize )
+            tileLimit >>= 1;
+
+        //  groups[ 0 ] holds the serial segments, groups[ g ] those of tile size SEGSORT_LOCAL_MIN << ( g - 1 )
+        std::vector< std::vector< cl_uint > > groups( 1 );
+        for( size_t tile = SEGSORT_LOCAL_MIN; tile <= tileLimit; tile <<= 1 )
+            groups.push_back( std::vector< cl_uint >( ) );
+        std::vector< size_t > largeSegments;
+
+        for( size_t s = 0; s < offsets.size( ); ++s )
+        {
+            size_t begin = static_cast< size_t >( offsets[ s ] );
+            size_t end = segmented_sort_end( offsets, s, numElements );
+            if( end <= begin + 1 )
+                continue;
+
+            size_t count = end - begin;
+            size_t group = 0;
+            if( count > SEGSORT_SERIAL_MAX )
+            {
+                if( count > tileLimit )
+                {
+                    largeSegments.push_back( s );
+                    continue;
+                }
+                for( size_t tile = SEGSORT_LOCAL_MIN; tile < count; tile <<= 1 )
+                    ++group;
+                ++group;
+            }
+            groups[ group ].push_back( static_cast< cl_uint >( begin ) );
+            groups[ group ].push_back( static_cast< cl_uint >( end ) );
+        }
+
+        std::vector< cl_uint > segments;
+        std::vector< cl_uint > groupFirst( groups.size( ) );
+        for( size_t g = 0; g < groups.size( ); ++g )
+        {
+            groupFirst[ g ] = static_cast< cl_uint >( segments.size( ) / 2 );
+            segments.insert( segments.end( ), groups[ g ].begin( ), groups[ g ].end( ) );
+        }
+
+        if( !segments.empty( ) )
+        {
+            std::vector< std::string > typeNames( ss_end );
+            typeNames[ ss_kType ] = TypeName< kType >::get( );
+            typeNames[ ss_kIterType ] = TypeName< DVKeysIterator >::get( );
+            typeNames[ ss_vType ] = TypeName< vType >::get( );
+            typeNames[ ss_vIterType ] = TypeName< DVValuesIterator >::get( );
+            typeNames[ ss_StrictWeakOrdering ] = TypeName< StrictWeakOrdering >::get( );
+
+            std::vector< std::string > typeDefinitions;
+            PUSH_BACK_UNIQUE( typeDefinitions, cl_code )
+            PUSH_BACK_UNIQUE( typeDefinitions, ClCode< kType >::get( ) )
+            PUSH_BACK_UNIQUE( typeDefinitions, ClCode< vType >::get( ) )
+            PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVKeysIterator >::get( ) )
+            PUSH_BACK_UNIQUE( typeDefinitions, ClCode< DVValuesIterator >::get( ) )
+            PUSH_BACK_UNIQUE( typeDefinitions, ClCode< StrictWeakOrdering >::get( ) )
+
+            SegmentedSort_KernelTemplateSpecializer segmented_sort_kts;
+            static ProgramCacheSlot segmented_sort_ktsSlot;
+            std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
+                ctl,
+                typeNames,
+                &segmented_sort_kts,
+                typeDefinitions,
+                segmented_sort_kernels,
+                "",
+                &segmented_sort_ktsSlot );
+
+            ::cl::Kernel serialKernel = kernels[ 0 ];
+            ::cl::Kernel localKernel  = kernels[ 1 ];
+
+            device_vector< cl_uint > dvSegments( segments.begin( ), segments.end( ), CL_MEM_READ_ONLY, ctl );
+
+            ALIGNED( 256 ) StrictWeakOrdering aligned_comp( comp );
+            control::buffPointer userFunctor = ctl.acquireBuffer( sizeof( aligned_comp ),
+                                                                  CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_comp );
+
+            typename DVKeysIterator::Payload keys_payload = keys_first.gpuPayload( );
+            typename DVValuesIterator::Payload values_payload = values_first.gpuPayload( );
+
+            ::cl::CommandQueue& myCQ = ctl.getCommandQueue( );
+            cl_int l_Error = CL_SUCCESS;
+
+            cl_uint numSerial = static_cast< cl_uint >( groups[ 0 ].size( ) / 2 );
+            if( numSerial != 0 )
+            {
+                V_OPENCL( serialKernel.setArg( 0, keys_first.getContainer( ).getBuffer( ) ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 1, keys_first.gpuPayloadSize( ), &keys_payload ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 2, values_first.getContainer( ).getBuffer( ) ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 3, values_first.gpuPayloadSize( ), &values_payload ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 4, dvSegments.getBuffer( ) ), "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 5, groupFirst[ 0 ] ), "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 6, numSerial ), "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 7, *userFunctor ), "Error setting a kernel argument" );
+                V_OPENCL( serialKernel.setArg( 8, static_cast< cl_int >( hasValues ) ),
+                          "Error setting a kernel argument" );
+                cl_uint numWG = ( numSerial + SEGSORT_WGSIZE - 1 ) / SEGSORT_WGSIZE;
+                l_Error = myCQ.enqueueNDRangeKernel( serialKernel, ::cl::NullRange,
+                                                     ::cl::NDRange( numWG * SEGSORT_WGSIZE ),
+                                                     ::cl::NDRange( SEGSORT_WGSIZE ), NULL, NULL );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for segmentedSortSerial kernel" );
+            }
+
+            cl_uint tileSize = SEGSORT_LOCAL_MIN;
+            for( size_t g = 1; g < groups.size( ); ++g, tileSize <<= 1 )
+            {
+                cl_uint numLocal = static_cast< cl_uint >( groups[ g ].size( ) / 2 );
+                if( numLocal == 0 )
+                    continue;
+
+                ::cl::LocalSpaceArg localKeys;
+                localKeys.size_ = tileSize * sizeof( kType );
+                ::cl::LocalSpaceArg localValues;
+                localValues.size_ = ( hasValues ? tileSize : 1 ) * sizeof( vType );
+                ::cl::LocalSpaceArg localOrder;
+                localOrder.size_ = tileSize * sizeof( cl_uint );
+
+                V_OPENCL( localKernel.setArg( 0, keys_first.getContainer( ).getBuffer( ) ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 1, keys_first.gpuPayloadSize( ), &keys_payload ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 2, values_first.getContainer( ).getBuffer( ) ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 3, values_first.gpuPayloadSize( ), &values_payload ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 4, dvSegments.getBuffer( ) ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 5, groupFirst[ g ] ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 6, tileSize ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 7, *userFunctor ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 8, static_cast< cl_int >( hasValues ) ),
+                          "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 9, localKeys ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 10, localValues ), "Error setting a kernel argument" );
+                V_OPENCL( localKernel.setArg( 11, localOrder ), "Error setting a kernel argument" );
+                l_Error = myCQ.enqueueNDRangeKernel( localKernel, ::cl::NullRange,
+                                                     ::cl::NDRange( numLocal * SEGSORT_WGSIZE ),
+                                                     ::cl::NDRange( SEGSORT_WGSIZE ), NULL, NULL );
+                V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for segmentedSortLocal kernel" );
+            }
+
+            //  The functor and the segments must outlive the launches
+            l_Error = myCQ.finish( );
+            V_OPENCL( l_Error, "finish() failed for segmented_sort" );
+        }
+
+        //  The queue is in order, so these follow the launches above
+        for( size_t i = 0; i < largeSegments.size( ); ++i )
+        {
+            size_t s = largeSegments[ i ];
+            difference_type begin = static_cast< difference_type >( offsets[ s ] );
+            difference_type end = static_cast< difference_type >( segmented_sort_end( offsets, s, numElements ) );
+            if( hasValues )
+                bolt::cl::sort_by_key( ctl, keys_first + begin, keys_first + end, values_first + begin, comp,
+                                       cl_code );
+            else
+                bolt::cl::sort( ctl, keys_first + begin, keys_first + end, comp, cl_code );
+        }
+    }
+
+    /*  Reads the offsets to the host; they decide the grouping of the segments  */
+    template< typename OffsetIterator >
+    std::vector< typename std::iterator_traits< OffsetIterator >::value_type >
+    segmented_sort_offsets( bolt::cl::control &ctl, const OffsetIterator& offsets_first,
+                            const OffsetIterator& offsets_last )
+    {
+        typedef typename std::iterator_traits< OffsetIterator >::value_type offType;
+
+        std::vector< offType > offsets( static_cast< size_t >( std::distance( offsets_first, offsets_last ) ) );
+        if( !offsets.empty( ) )
+            bolt::cl::copy( ctl, offsets_first, offsets_last, offsets.begin( ) );
+        return offsets;
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename offType,
+              typename StrictWeakOrdering >
+    void segmented_sort_pick_iterator( bolt::cl::control &ctl, const RandomAccessIterator1& keys_first,
+                                       const RandomAccessIterator1& keys_last,
+                                       const RandomAccessIterator2& values_first,
+                                       const std::vector< offType >& offsets, const StrictWeakOrdering& comp,
+                                       bool hasValues, const std::string& cl_code, std::random_access_iterator_tag )
+    {
+        typedef typename std::iterator_traits< RandomAccessIterator1 >::value_type kType;
+        typedef typename std::iterator_traits< RandomAccessIterator2 >::value_type vType;
+
+        size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+        if( numElements < 2 || offsets.empty( ) )
+            return;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements,
+            sizeof( kType ) + sizeof( vType ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_SERIAL_CPU,
+                                      "::Segmented_Sort::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Segmented_Sort::MULTICORE_CPU" );
+            #endif
+            segmented_sort_cpu( runMode, keys_first, numElements, values_first, offsets, comp, hasValues );
+            return;
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_OPENCL_GPU,
+                              "::Segmented_Sort::OPENCL_GPU" );
+        #endif
+
+        device_vector< kType > dvKeys( keys_first, keys_last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, ctl );
+        if( !hasValues )
+        {
+            segmented_sort_enqueue( ctl, dvKeys.begin( ), dvKeys.end( ), dvKeys.begin( ), offsets, comp, false,
+                                    cl_code );
+        }
+        else
+        {
+            device_vector< vType > dvValues( values_first, numElements, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                                             true, ctl );
+            segmented_sort_enqueue( ctl, dvKeys.begin( ), dvKeys.end( ), dvValues.begin( ), offsets, comp, true,
+                                    cl_code );
+            dvValues.data( );
+        }
+
+        // This should immediately map/unmap the buffer
+        dvKeys.data( );
+    }
+
+    template< typename DVKeysIterator, typename DVValuesIterator, typename offType, typename StrictWeakOrdering >
+    void segmented_sort_pick_iterator( bolt::cl::control &ctl, const DVKeysIterator& keys_first,
+                                       const DVKeysIterator& keys_last, const DVValuesIterator& values_first,
+                                       const std::vector< offType >& offsets, const StrictWeakOrdering& comp,
+                                       bool hasValues, const std::string& cl_code, bolt::cl::device_vector_tag )
+    {
+        typedef typename std::iterator_traits< DVKeysIterator >::value_type kType;
+        typedef typename std::iterator_traits< DVValuesIterator >::value_type vType;
+
+        size_t numElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+        if( numElements < 2 || offsets.empty( ) )
+            return;
+
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements,
+            sizeof( kType ) + sizeof( vType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
+
+        #if defined( BOLT_DEBUG_LOG )
+        BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance( );
+        #endif
+
+        if( runMode == bolt::cl::control::SerialCpu || runMode == bolt::cl::control::MultiCoreCpu )
+        {
+            #if defined( BOLT_DEBUG_LOG )
+            if( runMode == bolt::cl::control::SerialCpu )
+                dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_SERIAL_CPU,
+                                      "::Segmented_Sort::SERIAL_CPU" );
+            else
+                dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_MULTICORE_CPU,
+                                      "::Segmented_Sort::MULTICORE_CPU" );
+            #endif
+            typename bolt::cl::device_vector< kType >::pointer keysPtr = keys_first.getContainer( ).data( );
+            if( !hasValues )
+            {
+                segmented_sort_cpu( runMode, &keysPtr[ keys_first.m_Index ], numElements,
+                                    &keysPtr[ keys_first.m_Index ], offsets, comp, false );
+                return;
+            }
+
+            typename bolt::cl::device_vector< vType >::pointer valuesPtr = values_first.getContainer( ).data( );
+            segmented_sort_cpu( runMode, &keysPtr[ keys_first.m_Index ], numElements,
+                                &valuesPtr[ values_first.m_Index ], offsets, comp, true );
+            return;
+        }
+
+        #if defined( BOLT_DEBUG_LOG )
+        dblog->CodePathTaken( BOLTLOG::BOLT_SEGMENTEDSORT, BOLTLOG::BOLT_OPENCL_GPU,
+                              "::Segmented_Sort::OPENCL_GPU" );
+        #endif
+        segmented_sort_enqueue( ctl, keys_first, keys_last, values_first, offsets, comp, hasValues, cl_code );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+              typename StrictWeakOrdering >
+    void segmented_sort_detect_random_access( bolt::cl::control &ctl, const RandomAccessIterator1& keys_first,
+                                              const RandomAccessIterator1& keys_last,
+                                              const RandomAccessIterator2& values_first,
+                                              const OffsetIterator& offsets_first,
+                                              const OffsetIterator& offsets_last, const StrictWeakOrdering& comp,
+                                              bool hasValues, const std::string& cl_code,
+                                              std::random_access_iterator_tag )
+    {
+        segmented_sort_pick_iterator( ctl, keys_first, keys_last, values_first,
+                                      segmented_sort_offsets( ctl, offsets_first, offsets_last ), comp, hasValues,
+                                      cl_code,
+                                      typename std::iterator_traits< RandomAccessIterator1 >::iterator_category( ) );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+              typename StrictWeakOrdering >
+    void segmented_sort_detect_random_access( bolt::cl::control &ctl, const RandomAccessIterator1& keys_first,
+                                              const RandomAccessIterator1& keys_last,
+                                              const RandomAccessIterator2& values_first,
+                                              const OffsetIterator& offsets_first,
+                                              const OffsetIterator& offsets_last, const StrictWeakOrdering& comp,
+                                              bool hasValues, const std::string& cl_code,
+                                              std::input_iterator_tag )
+    {
+        static_assert( std::is_same< RandomAccessIterator1, std::input_iterator_tag >::value,
+                       "Bolt only supports random access iterator types" );
+    }
+
+    //  Fancy iterators cannot be written to
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+              typename StrictWeakOrdering >
+    void segmented_sort_detect_random_access( bolt::cl::control &ctl, const RandomAccessIterator1& keys_first,
+                                              const RandomAccessIterator1& keys_last,
+                                              const RandomAccessIterator2& values_first,
+                                              const OffsetIterator& offsets_first,
+                                              const OffsetIterator& offsets_last, const StrictWeakOrdering& comp,
+                                              bool hasValues, const std::string& cl_code,
+                                              bolt::cl::fancy_iterator_tag )
+    {
+        static_assert( std::is_same< RandomAccessIterator1, bolt::cl::fancy_iterator_tag >::value,
+                       "It is not possible to sort fancy iterators. They are not mutable" );
+    }
+
+}//end of namespace detail
+
+    template< typename RandomAccessIterator, typename OffsetIterator >
+    void segmented_sort( bolt::cl::control &ctl, RandomAccessIterator first, RandomAccessIterator last,
+                         OffsetIterator offsets_first, OffsetIterator offsets_last, const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< RandomAccessIterator >::value_type kType;
+        detail::segmented_sort_detect_random_access( ctl, first, last, first, offsets_first, offsets_last,
+                                                     bolt::cl::less< kType >( ), false, cl_code,
+                                                     typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
+    }
+
+    template< typename RandomAccessIterator, typename OffsetIterator >
+    void segmented_sort( RandomAccessIterator first, RandomAccessIterator last, OffsetIterator offsets_first,
+                         OffsetIterator offsets_last, const std::string& cl_code )
+    {
+        bolt::cl::segmented_sort( control::getDefault( ), first, last, offsets_first, offsets_last, cl_code );
+    }
+
+    template< typename RandomAccessIterator, typename OffsetIterator, typename StrictWeakOrdering >
+    void segmented_sort( bolt::cl::control &ctl, RandomAccessIterator first, RandomAccessIterator last,
+                         OffsetIterator offsets_first, OffsetIterator offsets_last, StrictWeakOrdering comp,
+                         const std::string& cl_code )
+    {
+        detail::segmented_sort_detect_random_access( ctl, first, last, first, offsets_first, offsets_last, comp,
+                                                     false, cl_code,
+                                                     typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
+    }
+
+    template< typename RandomAccessIterator, typename OffsetIterator, typename StrictWeakOrdering >
+    void segmented_sort( RandomAccessIterator first, RandomAccessIterator last, OffsetIterator offsets_first,
+                         OffsetIterator offsets_last, StrictWeakOrdering comp, const std::string& cl_code )
+    {
+        bolt::cl::segmented_sort( control::getDefault( ), first, last, offsets_first, offsets_last, comp, cl_code );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator >
+    void segmented_sort_by_key( bolt::cl::control &ctl, RandomAccessIterator1 keys_first,
+                                RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first,
+                                OffsetIterator offsets_first, OffsetIterator offsets_last,
+                                const std::string& cl_code )
+    {
+        typedef typename std::iterator_traits< RandomAccessIterator1 >::value_type kType;
+        detail::segmented_sort_detect_random_access( ctl, keys_first, keys_last, values_first, offsets_first,
+                                                     offsets_last, bolt::cl::less< kType >( ), true, cl_code,
+                                                     typename std::iterator_traits< RandomAccessIterator1 >::iterator_category( ) );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator >
+    void segmented_sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last,
+                                RandomAccessIterator2 values_first, OffsetIterator offsets_first,
+                                OffsetIterator offsets_last, const std::string& cl_code )
+    {
+        bolt::cl::segmented_sort_by_key( control::getDefault( ), keys_first, keys_last, values_first, offsets_first,
+                                         offsets_last, cl_code );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+              typename StrictWeakOrdering >
+    void segmented_sort_by_key( bolt::cl::control &ctl, RandomAccessIterator1 keys_first,
+                                RandomAccessIterator1 keys_last, RandomAccessIterator2 values_first,
+                                OffsetIterator offsets_first, OffsetIterator offsets_last, StrictWeakOrdering comp,
+                                const std::string& cl_code )
+    {
+        detail::segmented_sort_detect_random_access( ctl, keys_first, keys_last, values_first, offsets_first,
+                                                     offsets_last, comp, true, cl_code,
+                                                     typename std::iterator_traits< RandomAccessIterator1 >::iterator_category( ) );
+    }
+
+    template< typename RandomAccessIterator1, typename RandomAccessIterator2, typename OffsetIterator,
+              typename StrictWeakOrdering >
+    void segmented_sort_by_key( RandomAccessIterator1 keys_first, RandomAccessIterator1 keys_last,
+                                RandomAccessIterator2 values_first, OffsetIterator offsets_first,
+                                OffsetIterator offsets_last, StrictWeakOrdering comp, const std::string& cl_code )
+    {
+        bolt::cl::segmented_sort_by_key( control::getDefault( ), keys_first, keys_last, values_first, offsets_first,
+                                         offsets_last, comp, cl_code );
+    }
+
+}//end of namespace cl
+}//end of namespace bolt
+
+#endif
@@ -44,8 +44,11 @@
 
 #include "bolt/cl/functional.h"
 #include "bolt/cl/device_vector.h"
+#include "bolt/cl/detail/radix_sort.inl"
 #ifdef ENABLE_TBB
 #include "bolt/btbb/sort.h"
+#include "bolt/btbb/stable_sort.h"
+#include "bolt/cl/detail/host_split.inl"
 #endif
 
 #include "bolt/cl/stablesort.h"
@@ -227,22 +230,26 @@ sort_enqueue(control &ctl,
     std::string compileOptions;
     //std::ostringstream oss;
     RadixSort_Common_KernelTemplateSpecializer radix_common_kts;
+    static ProgramCacheSlot radix_common_ktsSlot;
     std::vector< ::cl::Kernel > commonKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_common_kts,
         typeDefinitions,
         sort_common_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_common_ktsSlot );
 
     RadixSort_Uint_KernelTemplateSpecializer radix_uint_kts;
+    static ProgramCacheSlot radix_uint_ktsSlot;
     std::vector< ::cl::Kernel > uintKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_uint_kts,
         typeDefinitions,
         sort_uint_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_uint_ktsSlot );
 
     int localSize  = 256;
     int wavefronts = 8;
@@ -441,31 +448,37 @@ sort_enqueue(control &ctl,
     std::string compileOptions;
     //std::ostringstream oss;
     RadixSort_Common_KernelTemplateSpecializer radix_common_kts;
+    static ProgramCacheSlot radix_common_ktsSlot;
     std::vector< ::cl::Kernel > commonKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_common_kts,
         typeDefinitions,
         sort_common_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_common_ktsSlot );
 
     RadixSort_Int_KernelTemplateSpecializer radix_int_kts;
+    static ProgramCacheSlot radix_int_ktsSlot;
     std::vector< ::cl::Kernel > intKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_int_kts,
         typeDefinitions,
         sort_int_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_int_ktsSlot );
 
     RadixSort_Uint_KernelTemplateSpecializer radix_uint_kts;
+    static ProgramCacheSlot radix_uint_ktsSlot;
     std::vector< ::cl::Kernel > uintKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_uint_kts,
         typeDefinitions,
         sort_uint_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_uint_ktsSlot );
 
     int localSize  = 256;
     int wavefronts = 8;
@@ -705,10 +718,33 @@ sort_enqueue(control &ctl,
 }
 
 
+/*********************************************************************
+ * RADIX SORT ALGORITHM FOR float, double, long and unsigned long.
+ *********************************************************************/
+template<typename DVRandomAccessIterator, typename StrictWeakOrdering>
+typename std::enable_if< radix_sort_supported< typename std::iterator_traits<DVRandomAccessIterator >::value_type,
+                                               StrictWeakOrdering
+                                             >::value
+                       >::type   /*If enabled then this typename will be evaluated to void*/
+sort_enqueue(control &ctl,
+             DVRandomAccessIterator first, DVRandomAccessIterator last,
+             StrictWeakOrdering comp, const std::string& cl_code)
+{
+    typedef typename std::iterator_traits< DVRandomAccessIterator >::value_type T;
+    size_t szElements = static_cast< size_t >( std::distance( first, last ) );
+    bool descending = std::is_same< StrictWeakOrdering, bolt::cl::greater< T > >::value;
+
+    radix_sort_enqueue< T >( ctl, first.getContainer( ).getBuffer( ), first.m_Index, szElements, descending,
+                             NULL, 0, 0 );
+    return;
+}
+
+
 template<typename DVRandomAccessIterator, typename StrictWeakOrdering>
 typename std::enable_if<
     !(std::is_same< typename std::iterator_traits<DVRandomAccessIterator >::value_type, unsigned int >::value
    || std::is_same< typename std::iterator_traits<DVRandomAccessIterator >::value_type,          int >::value
+   || radix_sort_supported< typename std::iterator_traits<DVRandomAccessIterator >::value_type, StrictWeakOrdering >::value
     )
                        >::type
 sort_enqueue(control &ctl,
@@ -745,13 +781,15 @@ sort_enqueue(control &ctl,
     size_t temp;
 
     BitonicSort_KernelTemplateSpecializer ts_kts;
+    static ProgramCacheSlot ts_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &ts_kts,
         typeDefinitions,
         sort_kernels,
-        compileOptions);
+        compileOptions,
+        &ts_ktsSlot );
     //Power of 2 buffer size
     // For user-defined types, the user must create a TypeName trait which returns the name of the class -
     // Note use of TypeName<>::get to retreive the name here.
@@ -829,11 +867,8 @@ void sort_pick_iterator( control &ctl,
     size_t szElements = static_cast< size_t >( std::distance( first, last ) );
     if( szElements < 2 )
         return;
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-    if(runMode == bolt::cl::control::Automatic)
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( T ), true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -869,6 +904,56 @@ void sort_pick_iterator( control &ctl,
 }
 
 
+#ifdef ENABLE_TBB
+template<typename RandomAccessIterator, typename StrictWeakOrdering>
+struct SortHostPart
+{
+    RandomAccessIterator first, last;
+    StrictWeakOrdering comp;
+
+    SortHostPart( const RandomAccessIterator& _first, const RandomAccessIterator& _last,
+                  const StrictWeakOrdering& _comp ) : first( _first ), last( _last ), comp( _comp ) { }
+
+    void operator( )( ) { bolt::btbb::sort( first, last, comp ); }
+};
+
+template<typename RandomAccessIterator, typename StrictWeakOrdering>
+struct SortDevicePart
+{
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+
+    control& ctl;
+    RandomAccessIterator first, last;
+    const StrictWeakOrdering& comp;
+    const std::string& cl_code;
+
+    SortDevicePart( control& _ctl, const RandomAccessIterator& _first, const RandomAccessIterator& _last,
+                    const StrictWeakOrdering& _comp, const std::string& _cl_code ) : ctl( _ctl ), first( _first ),
+                    last( _last ), comp( _comp ), cl_code( _cl_code ) { }
+
+    void operator( )( )
+    {
+        device_vector< T > dvInputOutput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, ctl );
+        sort_enqueue( ctl, dvInputOutput.begin( ), dvInputOutput.end( ), comp, cl_code );
+        dvInputOutput.data( );
+    }
+};
+
+//Sorts the first hostLength elements with TBB while the device sorts the rest, then merges the two runs
+template<typename RandomAccessIterator, typename StrictWeakOrdering>
+void sort_host_split( control &ctl,
+                      const RandomAccessIterator& first, const RandomAccessIterator& last,
+                      const StrictWeakOrdering& comp, const std::string& cl_code, size_t hostLength )
+{
+    SortHostPart< RandomAccessIterator, StrictWeakOrdering > hostPart( first, first + hostLength, comp );
+    SortDevicePart< RandomAccessIterator, StrictWeakOrdering > devicePart( ctl, first + hostLength, last, comp,
+                                                                           cl_code );
+    host_split_run( "sort", hostPart, hostLength, devicePart, static_cast< size_t >( last - first ) - hostLength );
+
+    host_split_merge( first, first + hostLength, last, comp );
+}
+#endif
+
 //Non Device Vector specialization.
 //This implementation creates a cl::Buffer and passes the cl buffer to the sort specialization
 //whichtakes the cl buffer as a parameter. In the future, Each input buffer should be mapped to the device_vector
@@ -884,11 +969,8 @@ void sort_pick_iterator( control &ctl,
     if( szElements < 2 )
         return;
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-    if(runMode == bolt::cl::control::Automatic)
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( T ), false );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -909,6 +991,17 @@ void sort_pick_iterator( control &ctl,
         throw std::runtime_error( "The MultiCoreCpu version of sort is not enabled to be built! \n" );
 #endif
     } else {
+#ifdef ENABLE_TBB
+        size_t hostLength = bolt::cl::hostSplitLength( ctl, "sort", szElements );
+        if( hostLength != 0 )
+        {
+            #if defined(BOLT_DEBUG_LOG)
+            dblog->CodePathTaken(BOLTLOG::BOLT_SORT,BOLTLOG::BOLT_HOST_SPLIT,"::Sort::HOST_SPLIT");
+            #endif
+            sort_host_split( ctl, first, last, comp, cl_code, hostLength );
+            return;
+        }
+#endif
         #if defined(BOLT_DEBUG_LOG)
         dblog->CodePathTaken(BOLTLOG::BOLT_SORT,BOLTLOG::BOLT_OPENCL_GPU,"::Sort::OPENCL_GPU");
         #endif
@@ -956,6 +1049,112 @@ void sort_detect_random_access( control &ctl,
     static_assert(std::is_same< RandomAccessIterator, bolt::cl::fancy_iterator_tag >::value  , "Bolt only supports random access iterator types. And does not support Fancy Iterator Tags" );
 };
 
+/*********************************************************************
+ * Partial-bit sort: orders the keys by bits [begin_bit, end_bit) only.
+ * The CPU paths use a stable sort so that they agree with the device.
+ *********************************************************************/
+template<typename DVRandomAccessIterator>
+void sort_bits_pick_iterator( control &ctl,
+                              const DVRandomAccessIterator& first, const DVRandomAccessIterator& last,
+                              int begin_bit, int end_bit,
+                              bolt::cl::device_vector_tag )
+{
+    typedef typename std::iterator_traits<DVRandomAccessIterator>::value_type T;
+    static_assert( radix_sort_bits_key_type< T >::value,
+                   "sort with begin_bit and end_bit needs 32 or 64 bit integer or floating point keys" );
+    radix_sort_check_bits< T >( begin_bit, end_bit );
+    size_t szElements = static_cast< size_t >( std::distance( first, last ) );
+    if( ( szElements < 2 ) || ( begin_bit == end_bit ) )
+        return;
+
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( T ), true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
+
+    if ((runMode == bolt::cl::control::SerialCpu) || (szElements < SORT_CPU_THRESHOLD)) {
+        typename bolt::cl::device_vector< T >::pointer firstPtr =  first.getContainer( ).data( );
+        std::stable_sort( &firstPtr[ first.m_Index ], &firstPtr[ last.m_Index ], radix_bits_less< T >( begin_bit, end_bit ) );
+        return;
+    } else if (runMode == bolt::cl::control::MultiCoreCpu) {
+#ifdef ENABLE_TBB
+        typename bolt::cl::device_vector< T >::pointer firstPtr =  first.getContainer( ).data( );
+        bolt::btbb::stable_sort( &firstPtr[ first.m_Index ], &firstPtr[ last.m_Index ],
+                                 radix_bits_less< T >( begin_bit, end_bit ) );
+        return;
+#else
+        throw std::runtime_error( "The MultiCoreCpu version of sort is not enabled to be built! \n" );
+#endif
+    } else {
+        radix_sort_enqueue< T >( ctl, first.getContainer( ).getBuffer( ), first.m_Index, szElements, false,
+                                 NULL, 0, 0, begin_bit, end_bit );
+    }
+    return;
+}
+
+template<typename RandomAccessIterator>
+void sort_bits_pick_iterator( control &ctl,
+                              const RandomAccessIterator& first, const RandomAccessIterator& last,
+                              int begin_bit, int end_bit,
+                              std::random_access_iterator_tag )
+{
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+    static_assert( radix_sort_bits_key_type< T >::value,
+                   "sort with begin_bit and end_bit needs 32 or 64 bit integer or floating point keys" );
+    radix_sort_check_bits< T >( begin_bit, end_bit );
+    size_t szElements = (size_t)(last - first);
+    if( ( szElements < 2 ) || ( begin_bit == end_bit ) )
+        return;
+
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements, sizeof( T ), false );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
+
+    if ((runMode == bolt::cl::control::SerialCpu) || (szElements < SORT_CPU_THRESHOLD)) {
+        std::stable_sort( first, last, radix_bits_less< T >( begin_bit, end_bit ) );
+        return;
+    } else if (runMode == bolt::cl::control::MultiCoreCpu) {
+#ifdef ENABLE_TBB
+        bolt::btbb::stable_sort( first, last, radix_bits_less< T >( begin_bit, end_bit ) );
+        return;
+#else
+        throw std::runtime_error( "The MultiCoreCpu version of sort is not enabled to be built! \n" );
+#endif
+    } else {
+        device_vector< T > dvInputOutput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, ctl );
+        radix_sort_enqueue< T >( ctl, dvInputOutput.begin( ).getContainer( ).getBuffer( ), 0, szElements, false,
+                                 NULL, 0, 0, begin_bit, end_bit );
+        //Map the buffer back to the host
+        dvInputOutput.data( );
+        return;
+    }
+}
+
+template<typename RandomAccessIterator>
+void sort_bits_detect_random_access( control &ctl,
+                                     const RandomAccessIterator& first, const RandomAccessIterator& last,
+                                     int begin_bit, int end_bit,
+                                     std::random_access_iterator_tag )
+{
+    return sort_bits_pick_iterator( ctl, first, last, begin_bit, end_bit,
+                                    typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
+};
+
+template<typename RandomAccessIterator>
+void sort_bits_detect_random_access( control &ctl,
+                                     const RandomAccessIterator& first, const RandomAccessIterator& last,
+                                     int begin_bit, int end_bit,
+                                     std::input_iterator_tag )
+{
+    static_assert( std::is_same< RandomAccessIterator, std::input_iterator_tag >::value , "Bolt only supports random access iterator types" );
+};
+
+template<typename RandomAccessIterator>
+void sort_bits_detect_random_access( control &ctl,
+                                     const RandomAccessIterator& first, const RandomAccessIterator& last,
+                                     int begin_bit, int end_bit,
+                                     bolt::cl::fancy_iterator_tag )
+{
+    static_assert(std::is_same< RandomAccessIterator, bolt::cl::fancy_iterator_tag >::value  , "Bolt only supports random access iterator types. And does not support Fancy Iterator Tags" );
+};
+
 }//namespace bolt::cl::detail
 
 template<typename RandomAccessIterator>
@@ -1013,6 +1212,33 @@ void sort(control &ctl,
                                       typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
     return;
 }
+
+template<typename RandomAccessIterator>
+void sort(control &ctl,
+          RandomAccessIterator first,
+          RandomAccessIterator last,
+          int begin_bit,
+          int end_bit)
+{
+    detail::sort_bits_detect_random_access(ctl,
+                                           first, last,
+                                           begin_bit, end_bit,
+                                           typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
+    return;
+}
+
+template<typename RandomAccessIterator>
+void sort(RandomAccessIterator first,
+          RandomAccessIterator last,
+          int begin_bit,
+          int end_bit)
+{
+    detail::sort_bits_detect_random_access(control::getDefault( ),
+                                           first, last,
+                                           begin_bit, end_bit,
+                                           typename std::iterator_traits< RandomAccessIterator >::iterator_category( ) );
+    return;
+}
 }
 };
 
@@ -48,6 +48,7 @@
 #include "bolt/cl/stablesort_by_key.h"
 #include "bolt/cl/functional.h"
 #include "bolt/cl/device_vector.h"
+#include "bolt/cl/detail/radix_sort.inl"
 
 #ifdef ENABLE_TBB
 //TBB Includes
@@ -219,7 +220,8 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
     template< typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if<
         !( std::is_same< typename std::iterator_traits<DVKeys >::value_type, unsigned int >::value ||
-           std::is_same< typename std::iterator_traits<DVKeys >::value_type, int >::value 
+           std::is_same< typename std::iterator_traits<DVKeys >::value_type, int >::value ||
+           radix_sort_by_key_supported< typename std::iterator_traits<DVKeys >::value_type, StrictWeakOrdering >::value
          )
                            >::type
     sort_by_key_enqueue(control &ctl, const DVKeys& keys_first,
@@ -230,10 +232,38 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
         return;
     }// END of sort_by_key_enqueue
 
+    /*Keys of type int, unsigned int, float, double, long and unsigned long with any trivially copyable value type,
+      ordered by less or greater*/
+    template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
+    typename std::enable_if< radix_sort_by_key_supported< typename std::iterator_traits<DVKeys >::value_type,
+                                                          StrictWeakOrdering
+                                                        >::value
+                           >::type  /*If enabled then this typename will be evaluated to void*/
+    sort_by_key_enqueue( control &ctl,
+                         DVKeys keys_first, DVKeys keys_last,
+                         DVValues values_first,
+                         StrictWeakOrdering comp, const std::string& cl_code)
+    {
+        typedef typename std::iterator_traits< DVKeys >::value_type Keys;
+        typedef typename std::iterator_traits< DVValues >::value_type Values;
+        static_assert( std::is_trivially_copyable< Values >::value,
+                       "The radix sort moves values as raw bytes; the value type must be trivially copyable" );
+        size_t szElements = static_cast< size_t >( std::distance( keys_first, keys_last ) );
+        bool descending = std::is_same< StrictWeakOrdering, bolt::cl::greater< Keys > >::value;
+
+        ::cl::Buffer clValues = values_first.getContainer( ).getBuffer( );
+        radix_sort_enqueue< Keys >( ctl, keys_first.getContainer( ).getBuffer( ), keys_first.m_Index, szElements,
+                                    descending, &clValues, values_first.m_Index, sizeof( Values ) );
+        return;
+    }// END of sort_by_key_enqueue
+
     template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if< std::is_same< typename std::iterator_traits<DVKeys >::value_type,
                                            unsigned int
-                                         >::value
+                                         >::value &&
+                             !radix_sort_comparator< typename std::iterator_traits<DVKeys >::value_type,
+                                                     StrictWeakOrdering
+                                                   >::value
                            >::type  /*If enabled then this typename will be evaluated to void*/
     sort_by_key_enqueue( control &ctl,
                          DVKeys keys_first, DVKeys keys_last,
@@ -271,22 +301,26 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
 
     std::string compileOptions;
     RadixSortByKey_Common_KernelTemplateSpecializer radix_common_kts;
+    static ProgramCacheSlot radix_common_ktsSlot;
     std::vector< ::cl::Kernel > commonKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_common_kts,
         typeDefinitions,
         sort_common_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_common_ktsSlot );
 
     RadixSortByKey_Uint_KernelTemplateSpecializer radix_uint_kts;
+    static ProgramCacheSlot radix_uint_ktsSlot;
     std::vector< ::cl::Kernel > uintKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_uint_kts,
         typeDefinitions,
         sort_by_key_uint_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_uint_ktsSlot );
 
     int localSize  = 256;
     int wavefronts = 8;
@@ -454,7 +488,10 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
     template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if< std::is_same< typename std::iterator_traits<DVKeys >::value_type,
                                            int
-                                         >::value
+                                         >::value &&
+                             !radix_sort_comparator< typename std::iterator_traits<DVKeys >::value_type,
+                                                     StrictWeakOrdering
+                                                   >::value
                            >::type  /*If enabled then this typename will be evaluated to void*/
     sort_by_key_enqueue( control &ctl,
                          DVKeys keys_first, DVKeys keys_last,
@@ -492,31 +529,37 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
 
     std::string compileOptions;
     RadixSortByKey_Common_KernelTemplateSpecializer radix_common_kts;
+    static ProgramCacheSlot radix_common_ktsSlot;
     std::vector< ::cl::Kernel > commonKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_common_kts,
         typeDefinitions,
         sort_common_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_common_ktsSlot );
 
     RadixSortByKey_Uint_KernelTemplateSpecializer radix_uint_kts;
+    static ProgramCacheSlot radix_uint_ktsSlot;
     std::vector< ::cl::Kernel > uintKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_uint_kts,
         typeDefinitions,
         sort_by_key_uint_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_uint_ktsSlot );
 
     RadixSortByKey_Int_KernelTemplateSpecializer radix_int_kts;
+    static ProgramCacheSlot radix_int_ktsSlot;
     std::vector< ::cl::Kernel > intKernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &radix_int_kts,
         typeDefinitions,
         sort_by_key_int_kernels,
-        compileOptions);
+        compileOptions,
+        &radix_int_ktsSlot );
 
     int localSize  = 256;
     int wavefronts = 8;
@@ -786,11 +829,9 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
         size_t szElements = (size_t)(keys_last - keys_first);
         if (szElements == 0 )
                 return;
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-        if( runMode == bolt::cl::control::Automatic )
-        {
-            runMode = ctl.getDefaultPathToRun( );
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements,
+            sizeof( keyType ) + sizeof( valueType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -847,11 +888,9 @@ enum sortByKeyTypes {sort_by_key_keyValueType, sort_by_key_keyIterType,
         if (szElements == 0)
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-        if( runMode == bolt::cl::control::Automatic )
-        {
-            runMode = ctl.getDefaultPathToRun( );
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, szElements,
+            sizeof( T_keys ) + sizeof( T_values ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 	    #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
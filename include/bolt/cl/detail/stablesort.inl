@@ -29,6 +29,8 @@
 #include "bolt/cl/bolt.h"
 #include "bolt/cl/functional.h"
 #include "bolt/cl/device_vector.h"
+#include "bolt/cl/detail/radix_sort.inl"
+#include "bolt/cl/merge.h"
 
 #include "bolt/cl/detail/sort.inl"
 #ifdef ENABLE_TBB
@@ -66,6 +68,7 @@ template<typename DVRandomAccessIterator, typename StrictWeakOrdering>
 typename std::enable_if<
     !(std::is_same< typename std::iterator_traits<DVRandomAccessIterator >::value_type, unsigned int >::value
    || std::is_same< typename std::iterator_traits<DVRandomAccessIterator >::value_type,          int >::value
+   || radix_sort_supported< typename std::iterator_traits<DVRandomAccessIterator >::value_type, StrictWeakOrdering >::value
     )
                        >::type
 sort_enqueue(control &ctl,
@@ -81,14 +84,16 @@ sort_enqueue(control &ctl,
     public:
         StableSort_KernelTemplateSpecializer() : KernelTemplateSpecializer( )
         {
-            addKernelName( "blockInsertionSort" );
-            addKernelName( "merge" );
+            addKernelName( "blockMergeSort" );
+            addKernelName( "mergePassPartitions" );
+            addKernelName( "mergePass" );
         }
 
         const ::std::string operator( ) ( const ::std::vector< ::std::string >& typeNames ) const
         {
             const std::string templateSpecializationString =
                 "template __attribute__((mangled_name(" + name( 0 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(MERGE_WG_SIZE,1,1)))\n"
                 "kernel void " + name( 0 ) + "Template(\n"
                 "global " + typeNames[stableSort_iValueType] + "* data_ptr,\n"
                 ""        + typeNames[stableSort_iIterType] + " data_iter,\n"
@@ -101,10 +106,23 @@ sort_enqueue(control &ctl,
                 "kernel void " + name( 1 ) + "Template(\n"
                 "global " + typeNames[stableSort_iValueType] + "* source_ptr,\n"
                 ""        + typeNames[stableSort_iIterType] + " source_iter,\n"
+                "const uint srcVecSize,\n"
+                "const uint srcBlockSize,\n"
+                "const uint numTiles,\n"
+                "global int* partitions,\n"
+                "global " + typeNames[stableSort_lessFunction] + " * lessOp\n"
+                ");\n\n"
+
+                "template __attribute__((mangled_name(" + name( 2 ) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(MERGE_WG_SIZE,1,1)))\n"
+                "kernel void " + name( 2 ) + "Template(\n"
+                "global " + typeNames[stableSort_iValueType] + "* source_ptr,\n"
+                ""        + typeNames[stableSort_iIterType] + " source_iter,\n"
                 "global " + typeNames[stableSort_iValueType] + "* result_ptr,\n"
                 ""        + typeNames[stableSort_iIterType] + " result_iter,\n"
                 "const uint srcVecSize,\n"
                 "const uint srcBlockSize,\n"
+                "global const int* partitions,\n"
                 "local "  + typeNames[stableSort_iValueType] + "* lds,\n"
                 "global " + typeNames[stableSort_lessFunction] + " * lessOp\n"
                 ");\n\n";
@@ -175,44 +193,34 @@ stablesort_enqueue(control& ctrl, const DVRandomAccessIterator& first, const DVR
     /**********************************************************************************
      * Compile Options
      *********************************************************************************/
-    bool cpuDevice = ctrl.getDevice( ).getInfo< CL_DEVICE_TYPE >( ) == CL_DEVICE_TYPE_CPU;
+    //  The tile geometry is shared with bolt::cl::merge, whose kernels are compiled in front of ours
+    const int vt = mergePathValuesPerThread( ctrl, sizeof( iType ) );
+    const cl_uint tileSize = static_cast< cl_uint >( mergePathWgSize * vt );
+    std::string compileOptions = mergePathCompileOptions( vt );
 
     /**********************************************************************************
      * Request Compiled Kernels
      *********************************************************************************/
-    std::string compileOptions;
-
     StableSort_KernelTemplateSpecializer ss_kts;
+    static ProgramCacheSlot ss_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctrl,
         typeNames,
         &ss_kts,
         typeDefinitions,
-        stablesort_kernels,
-        compileOptions );
+        merge_kernels + stablesort_kernels,
+        compileOptions,
+        &ss_ktsSlot );
     // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
-    size_t localRange= kernels[0].getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>( ctrl.getDevice( ),
-                                                                                                  &l_Error );
-    V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
-
-
-    //  Make sure that globalRange is a multiple of localRange
-    size_t globalRange = vecSize;
-    size_t modlocalRange = ( globalRange & ( localRange-1 ) );
-    if( modlocalRange )
-    {
-        globalRange &= ~modlocalRange;
-        globalRange += localRange;
-    }
-
     ALIGNED( 256 ) StrictWeakOrdering aligned_comp( comp );
     control::buffPointer userFunctor = ctrl.acquireBuffer( sizeof( aligned_comp ),CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY,
                                                            &aligned_comp );
 
-    //  kernels[ 0 ] sorts values within a workgroup, in parallel across the entire vector
+    //  kernels[ 0 ] sorts every tile in local memory, in parallel across the entire vector
     //  kernels[ 0 ] reads and writes to the same vector
-    cl_uint ldsSize  = static_cast< cl_uint >( localRange * sizeof( iType ) );
+    cl_uint numTiles = ( vecSize + tileSize - 1 ) / tileSize;
+    cl_uint ldsSize  = static_cast< cl_uint >( tileSize * sizeof( iType ) );
 
     typename DVRandomAccessIterator::Payload first_payload = first.gpuPayload();
     // Input buffer
@@ -225,99 +233,81 @@ stablesort_enqueue(control& ctrl, const DVRandomAccessIterator& first, const DVR
      // User provided functor
     V_OPENCL( kernels[ 0 ].setArg( 4, *userFunctor ),           "Error setting argument for kernels[ 0 ]" );
 
-
-
-
     ::cl::CommandQueue& myCQ = ctrl.getCommandQueue( );
 
     ::cl::Event blockSortEvent;
     l_Error = myCQ.enqueueNDRangeKernel( kernels[ 0 ], ::cl::NullRange,
-            ::cl::NDRange( globalRange ), ::cl::NDRange( localRange ), NULL, &blockSortEvent );
-    V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for perBlockInclusiveScan kernel" );
+            ::cl::NDRange( numTiles * mergePathWgSize ), ::cl::NDRange( mergePathWgSize ), NULL, &blockSortEvent );
+    V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for blockMergeSort kernel" );
 
     //  Early exit for the case of no merge passes, values are already in destination vector
-    if( vecSize <= localRange )
+    if( numTiles == 1 )
     {
         wait( ctrl, blockSortEvent );
         return;
     };
 
-    //  An odd number of elements requires an extra merge pass to sort
+    //  Every pass merges pairs of sorted blocks, starting from one tile wide blocks
     size_t numMerges = 0;
-
-    //  Calculate the log2 of vecSize, taking into account our block size from kernel 1 is 64
-    //  this is how many merge passes we want
-    size_t log2BlockSize = vecSize >> 6;
-    for( ; log2BlockSize > 1; log2BlockSize >>= 1 )
+    for( cl_uint blockSize = tileSize; blockSize < vecSize; blockSize <<= 1 )
     {
         ++numMerges;
     }
 
-    //  Check to see if the input vector size is a power of 2, if not we will need last merge pass
-    size_t vecPow2 = (vecSize & (vecSize-1));
-    numMerges += vecPow2? 1: 0;
+    //  Allocate a flipflop buffer because the merge passes are out of place; the temporary buffer is
+    //  addressed from its start, the user buffer from first
+    control::buffPointer tmpBuffer = ctrl.acquireBuffer( vecSize * sizeof( iType ) );
+    control::buffPointer partitions = ctrl.acquireBuffer( numTiles * sizeof( cl_int ) );
+    typename DVRandomAccessIterator::Payload tmp_payload = first.gpuPayload( );
+    tmp_payload.m_Index = 0;
 
-    //  Allocate a flipflop buffer because the merge passes are out of place
-    control::buffPointer tmpBuffer = ctrl.acquireBuffer( globalRange * sizeof( iType ) );
-     // Size of scratch buffer
-    V_OPENCL( kernels[ 1 ].setArg( 4, vecSize ),            "Error setting argument for kernels[ 0 ]" );
-     // Scratch buffer
-    V_OPENCL( kernels[ 1 ].setArg( 6, ldsSize, NULL ),          "Error setting argument for kernels[ 0 ]" );
-     // User provided functor
-    V_OPENCL( kernels[ 1 ].setArg( 7, *userFunctor ),           "Error setting argument for kernels[ 0 ]" );
+    V_OPENCL( kernels[ 1 ].setArg( 2, vecSize ),                "Error setting argument for kernels[ 1 ]" );
+    V_OPENCL( kernels[ 1 ].setArg( 4, numTiles ),               "Error setting argument for kernels[ 1 ]" );
+    V_OPENCL( kernels[ 1 ].setArg( 5, *partitions ),            "Error setting argument for kernels[ 1 ]" );
+    V_OPENCL( kernels[ 1 ].setArg( 6, *userFunctor ),           "Error setting argument for kernels[ 1 ]" );
 
+    V_OPENCL( kernels[ 2 ].setArg( 4, vecSize ),                "Error setting argument for kernels[ 2 ]" );
+    V_OPENCL( kernels[ 2 ].setArg( 6, *partitions ),            "Error setting argument for kernels[ 2 ]" );
+    V_OPENCL( kernels[ 2 ].setArg( 7, ldsSize, NULL ),          "Error setting argument for kernels[ 2 ]" );
+    V_OPENCL( kernels[ 2 ].setArg( 8, *userFunctor ),           "Error setting argument for kernels[ 2 ]" );
 
+    const size_t partitionWgSize = 64;
+    size_t partitionThreads = ( ( numTiles + partitionWgSize - 1 ) / partitionWgSize ) * partitionWgSize;
 
     ::cl::Event kernelEvent;
     for( size_t pass = 1; pass <= numMerges; ++pass )
     {
         //  For each pass, flip the input-output buffers
-       typename DVRandomAccessIterator::Payload first1 = first.gpuPayload( );
-       typename DVRandomAccessIterator::Payload first2 = first.gpuPayload( );
+        const ::cl::Buffer& srcBuffer = ( pass & 0x1 ) ? first.getContainer().getBuffer() : *tmpBuffer;
+        const ::cl::Buffer& dstBuffer = ( pass & 0x1 ) ? *tmpBuffer : first.getContainer().getBuffer();
+        typename DVRandomAccessIterator::Payload src_payload = ( pass & 0x1 ) ? first_payload : tmp_payload;
+        typename DVRandomAccessIterator::Payload dst_payload = ( pass & 0x1 ) ? tmp_payload : first_payload;
 
-        if( pass & 0x1 )
-
-        {
-             // Input buffer
-            V_OPENCL( kernels[ 1 ].setArg( 0, first.getContainer().getBuffer() ),    "Error setting argument for kernels[ 0 ]" );
-            V_OPENCL( kernels[ 1 ].setArg( 1, first.gpuPayloadSize( ),&first1 ),
-                                          "Error setting a kernel argument" );
-             // Input buffer
-            V_OPENCL( kernels[ 1 ].setArg( 2, *tmpBuffer ),    "Error setting argument for kernels[ 0 ]" );
-            V_OPENCL( kernels[ 1 ].setArg( 3, first.gpuPayloadSize( ),&first2 ),
-                                           "Error setting a kernel argument" );
-        }
-        else
-        {
-             // Input buffer
-            V_OPENCL( kernels[ 1 ].setArg( 0, *tmpBuffer ),    "Error setting argument for kernels[ 0 ]" );
-            V_OPENCL( kernels[ 1 ].setArg( 1, first.gpuPayloadSize( ), &first1 ),
-                                           "Error setting a kernel argument" );
-             // Input buffer
-            V_OPENCL( kernels[ 1 ].setArg( 2, first.getContainer().getBuffer() ),    "Error setting argument for kernels[ 0 ]");
-            V_OPENCL( kernels[ 1 ].setArg( 3, first.gpuPayloadSize( ),&first2 ),
-                                           "Error setting a kernel argument" );
-
-        }
         //  For each pass, the merge window doubles
-        unsigned srcLogicalBlockSize = static_cast< unsigned >( localRange << (pass-1) );
-        V_OPENCL( kernels[ 1 ].setArg( 5, static_cast< unsigned >( srcLogicalBlockSize ) ),
-                                       "Error setting argument for kernels[ 0 ]" ); // Size of scratch buffer
-
-        if( pass == numMerges )
-        {
-            //  Grab the event to wait on from the last enqueue call
-            l_Error = myCQ.enqueueNDRangeKernel( kernels[ 1 ], ::cl::NullRange, ::cl::NDRange( globalRange ),
-                    ::cl::NDRange( localRange ), NULL, &kernelEvent );
-            V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergeTemplate kernel" );
-        }
-        else
-        {
-            l_Error = myCQ.enqueueNDRangeKernel( kernels[ 1 ], ::cl::NullRange, ::cl::NDRange( globalRange ),
-                    ::cl::NDRange( localRange ), NULL, NULL );
-            V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergeTemplate kernel" );
-        }
-
+        cl_uint srcBlockSize = tileSize << ( pass - 1 );
+
+        V_OPENCL( kernels[ 1 ].setArg( 0, srcBuffer ),              "Error setting argument for kernels[ 1 ]" );
+        V_OPENCL( kernels[ 1 ].setArg( 1, first.gpuPayloadSize( ), &src_payload ),
+                                                                    "Error setting a kernel argument" );
+        V_OPENCL( kernels[ 1 ].setArg( 3, srcBlockSize ),           "Error setting argument for kernels[ 1 ]" );
+
+        l_Error = myCQ.enqueueNDRangeKernel( kernels[ 1 ], ::cl::NullRange, ::cl::NDRange( partitionThreads ),
+                ::cl::NDRange( partitionWgSize ), NULL, NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergePassPartitions kernel" );
+
+        V_OPENCL( kernels[ 2 ].setArg( 0, srcBuffer ),              "Error setting argument for kernels[ 2 ]" );
+        V_OPENCL( kernels[ 2 ].setArg( 1, first.gpuPayloadSize( ), &src_payload ),
+                                                                    "Error setting a kernel argument" );
+        V_OPENCL( kernels[ 2 ].setArg( 2, dstBuffer ),              "Error setting argument for kernels[ 2 ]" );
+        V_OPENCL( kernels[ 2 ].setArg( 3, first.gpuPayloadSize( ), &dst_payload ),
+                                                                    "Error setting a kernel argument" );
+        V_OPENCL( kernels[ 2 ].setArg( 5, srcBlockSize ),           "Error setting argument for kernels[ 2 ]" );
+
+        //  Grab the event to wait on from the last enqueue call
+        l_Error = myCQ.enqueueNDRangeKernel( kernels[ 2 ], ::cl::NullRange,
+                ::cl::NDRange( numTiles * mergePathWgSize ), ::cl::NDRange( mergePathWgSize ), NULL,
+                ( pass == numMerges ) ? &kernelEvent : NULL );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for mergePass kernel" );
     }
 
     //  If there are an odd number of merges, then the output data is sitting in the temp buffer.  We need to copy
@@ -357,12 +347,8 @@ void stablesort_pick_iterator( control &ctl, const RandomAccessIterator& first,
     if( vecSize < 2 )
         return;
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, vecSize, sizeof( Type ), false );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -417,12 +403,8 @@ void stablesort_pick_iterator( control &ctl,
     if( vecSize < 2 )
         return;
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, vecSize, sizeof( Type ), true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
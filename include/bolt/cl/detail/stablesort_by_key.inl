@@ -28,6 +28,7 @@
 
 #include "bolt/cl/bolt.h"
 #include "bolt/cl/functional.h"
+#include "bolt/cl/detail/radix_sort.inl"
 #include "bolt/cl/sort_by_key.h"
 #include "bolt/cl/pair.h"
 #include "bolt/cl/device_vector.h"
@@ -46,17 +47,31 @@ namespace detail
     template< typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if<
         !( std::is_same< typename std::iterator_traits<DVKeys >::value_type, unsigned int >::value ||
-           std::is_same< typename std::iterator_traits<DVKeys >::value_type, int >::value 
+           std::is_same< typename std::iterator_traits<DVKeys >::value_type, int >::value ||
+           radix_sort_by_key_supported< typename std::iterator_traits<DVKeys >::value_type, StrictWeakOrdering >::value
          )
                            >::type
     sort_by_key_enqueue(control &ctl, const DVKeys& keys_first,
                         const DVKeys& keys_last, const DVValues& values_first,
                         const StrictWeakOrdering& comp, const std::string& cl_code);
 
+    template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
+    typename std::enable_if< radix_sort_by_key_supported< typename std::iterator_traits<DVKeys >::value_type,
+                                                          StrictWeakOrdering
+                                                        >::value
+                           >::type  /*If enabled then this typename will be evaluated to void*/
+    sort_by_key_enqueue( control &ctl,
+                         DVKeys keys_first, DVKeys keys_last,
+                         DVValues values_first,
+                         StrictWeakOrdering comp, const std::string& cl_code);
+
     template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if< std::is_same< typename std::iterator_traits<DVKeys >::value_type,
                                            int
-                                         >::value
+                                         >::value &&
+                             !radix_sort_comparator< typename std::iterator_traits<DVKeys >::value_type,
+                                                     StrictWeakOrdering
+                                                   >::value
                            >::type  /*If enabled then this typename will be evaluated to void*/
     sort_by_key_enqueue( control &ctl,
                          DVKeys keys_first, DVKeys keys_last,
@@ -67,7 +82,10 @@ namespace detail
     template<typename DVKeys, typename DVValues, typename StrictWeakOrdering>
     typename std::enable_if< std::is_same< typename std::iterator_traits<DVKeys >::value_type,
                                            unsigned int
-                                         >::value
+                                         >::value &&
+                             !radix_sort_comparator< typename std::iterator_traits<DVKeys >::value_type,
+                                                     StrictWeakOrdering
+                                                   >::value
                            >::type  /*If enabled then this typename will be evaluated to void*/
     sort_by_key_enqueue( control &ctl,
                          DVKeys keys_first, DVKeys keys_last,
@@ -261,13 +279,15 @@ namespace detail
         std::string compileOptions;
 
         StableSort_by_key_KernelTemplateSpecializer ss_kts;
+        static ProgramCacheSlot ss_ktsSlot;
         std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
             ctrl,
             typeNames,
             &ss_kts,
             typeDefinitions,
             stablesort_by_key_kernels,
-            compileOptions );
+            compileOptions,
+            &ss_ktsSlot );
         // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
         size_t localRange=kernels[0].getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>(ctrl.getDevice(),
@@ -472,13 +492,9 @@ namespace detail
         if( vecSize < 2 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();
-
-        if( runMode == bolt::cl::control::Automatic )
-        {
-            runMode = ctl.getDefaultPathToRun( );
-
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, vecSize,
+            sizeof( keyType ) + sizeof( valType ), false );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -535,12 +551,9 @@ namespace detail
         if( vecSize < 2 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();
-
-        if( runMode == bolt::cl::control::Automatic )
-        {
-            runMode = ctl.getDefaultPathToRun( );
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, vecSize,
+            sizeof( keyType ) + sizeof( valueType ), true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -25,9 +25,11 @@
 
 #ifdef ENABLE_TBB
     #include "bolt/btbb/transform.h"
+    #include "bolt/cl/detail/host_split.inl"
 #endif
 
 #include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_storage.h"
 #include "bolt/cl/device_vector.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 
@@ -62,7 +64,7 @@ public:
             + binaryTransformKernels[transform_DVInputIterator2] + " B_iter,\n"
             "global " + binaryTransformKernels[transform_oTypeB] + "* Z_ptr,\n"
             + binaryTransformKernels[transform_DVOutputIteratorB] + " Z_iter,\n"
-                "const uint length,\n"
+                "const BOLT_INDEX_T length,\n"
             "global " + binaryTransformKernels[transform_BinaryFunction] + "* userFunctor);\n\n"
 
                 "// Host generates this instantiation string with user-specified value type and functor\n"
@@ -74,7 +76,7 @@ public:
             + binaryTransformKernels[transform_DVInputIterator2] + " B_iter,\n"
             "global " + binaryTransformKernels[transform_oTypeB] + "* Z_ptr,\n"
             + binaryTransformKernels[transform_DVOutputIteratorB] + " Z_iter,\n"
-                "const uint length,\n"
+                "const BOLT_INDEX_T length,\n"
             "global " + binaryTransformKernels[transform_BinaryFunction] + "* userFunctor);\n\n";
 
             return templateSpecializationString;
@@ -100,7 +102,7 @@ public:
             + unaryTransformKernels[transform_DVInputIterator] + " A_iter,\n"
             "global " + unaryTransformKernels[transform_oTypeU] + "* Z,\n"
             + unaryTransformKernels[transform_DVOutputIteratorU] + " Z_iter,\n"
-            "const uint length,\n"
+            "const BOLT_INDEX_T length,\n"
             "global " + unaryTransformKernels[transform_UnaryFunction] + "* userFunctor);\n\n"
 
             "// Host generates this instantiation string with user-specified value type and functor\n"
@@ -110,7 +112,7 @@ public:
             + unaryTransformKernels[transform_DVInputIterator] + " A_iter,\n"
             "global " + unaryTransformKernels[transform_oTypeU] + "* Z,\n"
             + unaryTransformKernels[transform_DVOutputIteratorU] + " Z_iter,\n"
-            "const uint length,\n"
+            "const BOLT_INDEX_T length,\n"
             "global " +unaryTransformKernels[transform_UnaryFunction] + "* userFunctor);\n\n";
 
             return templateSpecializationString;
@@ -118,6 +120,14 @@ public:
         };
 
 
+    //  One wavefront per work-group, unless the tuning database holds another power of two for the device
+    inline size_t transformWgSize( const bolt::cl::control &ctl, const std::string& typeName, size_t length )
+    {
+        const tuningParams defaultShape = { WAVEFRONT_SIZE, 64, 1, 1 };
+        size_t wgSize = findTuning( ctl, "transform", typeName, length, defaultShape ).wgSize;
+        return ( wgSize != 0 && ( wgSize & ( wgSize - 1 ) ) == 0 ) ? wgSize : WAVEFRONT_SIZE;
+    }
+
     template<typename DVInputIterator1, typename DVInputIterator2, typename DVOutputIterator, typename BinaryFunction>
     void transform_enqueue( bolt::cl::control &ctl, const DVInputIterator1& first1, const DVInputIterator1& last1,
         const DVInputIterator2& first2, const DVOutputIterator& result,
@@ -127,7 +137,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator2>::value_type iType2;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >(  first1.distance_to(last1) );
+        size_t distVec = static_cast< size_t >(  first1.distance_to(last1) );
         if( distVec == 0 )
             return;
 
@@ -167,7 +177,7 @@ public:
          *********************************************************************************/
 
         cl_int l_Error = CL_SUCCESS;
-        const size_t wgSize  = WAVEFRONT_SIZE;
+        const size_t wgSize  = transformWgSize( ctl, TypeName< iType1 >::get( ), distVec );
         V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
         assert( (wgSize & (wgSize-1) ) == 0 ); // The bitwise &,~ logic below requires wgSize to be a power of 2
 
@@ -196,19 +206,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
           * Request Compiled Kernels
           *********************************************************************************/
          Transform_KernelTemplateSpecializer ts_kts;
+         static ProgramCacheSlot ts_ktsSlot;
          std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
              ctl,
              binaryTransformKernels,
              &ts_kts,
              typeDefinitions,
              transform_kernels,
-             compileOptions);
+             compileOptions,
+             &ts_ktsSlot );
          // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
 
@@ -226,7 +240,7 @@ public:
         kernels[boundsCheck].setArg( 3, first2.gpuPayloadSize( ),&first2_payload);
         kernels[boundsCheck].setArg( 4, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg( 5, result.gpuPayloadSize( ),&result_payload);
-        kernels[boundsCheck].setArg( 6, distVec );
+        index.setArg( kernels[boundsCheck], 6, distVec );
         kernels[boundsCheck].setArg( 7, *userFunctor);
 
         ::cl::Event transformEvent;
@@ -239,7 +253,7 @@ public:
             &transformEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for transform() kernel" );
 
-        ::bolt::cl::wait(ctl, transformEvent);
+        ::bolt::cl::deferredWait(ctl, transformEvent, "transform");
 
 #if TRANSFORM_ENABLE_PROFILING
         if( 0 )
@@ -264,7 +278,7 @@ public:
         typedef typename std::iterator_traits<DVInputIterator>::value_type iType;
         typedef typename std::iterator_traits<DVOutputIterator>::value_type oType;
 
-        cl_uint distVec = static_cast< cl_uint >( std::distance( first, last ) );
+        size_t distVec = static_cast< size_t >( std::distance( first, last ) );
         if( distVec == 0 )
             return;
 
@@ -298,7 +312,7 @@ public:
          * Calculate WG Size
          *********************************************************************************/
         cl_int l_Error = CL_SUCCESS;
-        const size_t wgSize  = WAVEFRONT_SIZE;
+        const size_t wgSize  = transformWgSize( ctl, TypeName< iType >::get( ), distVec );
         int boundsCheck = 0;
 
         V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
@@ -326,19 +340,23 @@ public:
         std::string compileOptions;
         std::ostringstream oss;
         oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+        const kernelIndex index( distVec );
+        oss << index.compileOptions( );
         compileOptions = oss.str();
 
         /**********************************************************************************
          * Request Compiled Kernels
          *********************************************************************************/
         TransformUnary_KernelTemplateSpecializer ts_kts;
+        static ProgramCacheSlot ts_ktsSlot;
         std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
             ctl,
             unaryTransformKernels,
             &ts_kts,
             typeDefinitions,
             transform_kernels,
-            compileOptions);
+            compileOptions,
+            &ts_ktsSlot );
         // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
         // Create buffer wrappers so we can access the host functors, for read or writing in the kernel
@@ -353,7 +371,7 @@ public:
         kernels[boundsCheck].setArg(1, first.gpuPayloadSize( ),&first_payload);
         kernels[boundsCheck].setArg(2, result.getContainer().getBuffer() );
         kernels[boundsCheck].setArg(3, result.gpuPayloadSize( ),&result_payload);
-        kernels[boundsCheck].setArg(4, distVec );
+        index.setArg( kernels[boundsCheck], 4, distVec );
         kernels[boundsCheck].setArg(5, *userFunctor);
         //k.setArg(3, numElementsPerThread );
 
@@ -367,7 +385,7 @@ public:
             &transformEvent );
         V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for transform() kernel" );
 
-        ::bolt::cl::wait(ctl, transformEvent);
+        ::bolt::cl::deferredWait(ctl, transformEvent, "transform");
 
 #if TRANSFORM_ENABLE_PROFILING
         if( 0 )
@@ -386,6 +404,96 @@ public:
 
     };
 
+#ifdef ENABLE_TBB
+    template< typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction >
+    struct TransformHostPart
+    {
+        InputIterator1 first1, last1;
+        InputIterator2 first2;
+        OutputIterator result;
+        BinaryFunction f;
+
+        TransformHostPart( const InputIterator1& _first1, const InputIterator1& _last1, const InputIterator2& _first2,
+            const OutputIterator& _result, const BinaryFunction& _f ) : first1( _first1 ), last1( _last1 ),
+            first2( _first2 ), result( _result ), f( _f ) { }
+
+        void operator( )( ) { bolt::btbb::transform( first1, last1, first2, result, f ); }
+    };
+
+    template< typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryFunction >
+    struct TransformDevicePart
+    {
+        typedef typename std::iterator_traits<InputIterator1>::value_type iType1;
+        typedef typename std::iterator_traits<InputIterator2>::value_type iType2;
+        typedef typename std::iterator_traits<OutputIterator>::value_type oType;
+
+        bolt::cl::control& ctl;
+        InputIterator1 first1, last1;
+        InputIterator2 first2;
+        OutputIterator result;
+        const BinaryFunction& f;
+        const std::string& user_code;
+
+        TransformDevicePart( bolt::cl::control& _ctl, const InputIterator1& _first1, const InputIterator1& _last1,
+            const InputIterator2& _first2, const OutputIterator& _result, const BinaryFunction& _f,
+            const std::string& _user_code ) : ctl( _ctl ), first1( _first1 ), last1( _last1 ), first2( _first2 ),
+            result( _result ), f( _f ), user_code( _user_code ) { }
+
+        void operator( )( )
+        {
+            size_t sz = std::distance( first1, last1 );
+            device_vector< iType1 > dvInput( first1, last1, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+            device_vector< iType2 > dvInput2( first2, sz, CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, true, ctl );
+            device_vector< oType > dvOutput( result, sz, CL_MEM_USE_HOST_PTR|CL_MEM_WRITE_ONLY, false, ctl );
+
+            transform_enqueue( ctl, dvInput.begin( ), dvInput.end( ), dvInput2.begin( ), dvOutput.begin( ), f,
+                               user_code );
+            dvOutput.data( );
+        }
+    };
+
+    template< typename InputIterator, typename OutputIterator, typename UnaryFunction >
+    struct TransformUnaryHostPart
+    {
+        InputIterator first, last;
+        OutputIterator result;
+        UnaryFunction f;
+
+        TransformUnaryHostPart( const InputIterator& _first, const InputIterator& _last,
+            const OutputIterator& _result, const UnaryFunction& _f ) : first( _first ), last( _last ),
+            result( _result ), f( _f ) { }
+
+        void operator( )( ) { bolt::btbb::transform( first, last, result, f ); }
+    };
+
+    template< typename InputIterator, typename OutputIterator, typename UnaryFunction >
+    struct TransformUnaryDevicePart
+    {
+        typedef typename std::iterator_traits<InputIterator>::value_type iType;
+        typedef typename std::iterator_traits<OutputIterator>::value_type oType;
+
+        bolt::cl::control& ctl;
+        InputIterator first, last;
+        OutputIterator result;
+        const UnaryFunction& f;
+        const std::string& user_code;
+
+        TransformUnaryDevicePart( bolt::cl::control& _ctl, const InputIterator& _first, const InputIterator& _last,
+            const OutputIterator& _result, const UnaryFunction& _f, const std::string& _user_code ) : ctl( _ctl ),
+            first( _first ), last( _last ), result( _result ), f( _f ), user_code( _user_code ) { }
+
+        void operator( )( )
+        {
+            size_t sz = std::distance( first, last );
+            device_vector< iType > dvInput( first, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, ctl );
+            device_vector< oType > dvOutput( result, sz, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, false, ctl );
+
+            transform_unary_enqueue( ctl, dvInput.begin( ), dvInput.end( ), dvOutput.begin( ), f, user_code );
+            dvOutput.data( );
+        }
+    };
+#endif
+
     /*! \brief This template function overload is used to seperate device_vector iterators from all other iterators
         \detail This template is called by the non-detail versions of inclusive_scan, it already assumes random access
         *  iterators.  This overload is called strictly for non-device_vector iterators
@@ -403,11 +511,8 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -437,6 +542,22 @@ public:
         }
         else
         {
+#ifdef ENABLE_TBB
+            size_t hostLength = bolt::cl::hostSplitLength( ctl, "transform", sz );
+            if( hostLength != 0 )
+            {
+                #if defined(BOLT_DEBUG_LOG)
+                dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORM,BOLTLOG::BOLT_HOST_SPLIT,"::Transform::HOST_SPLIT");
+                #endif
+                TransformHostPart< InputIterator1, InputIterator2, OutputIterator, BinaryFunction > hostPart(
+                    first1, first1 + hostLength, first2, result, f );
+                TransformDevicePart< InputIterator1, InputIterator2, OutputIterator, BinaryFunction > devicePart(
+                    ctl, first1 + hostLength, last1, first2 + hostLength, result + hostLength, f, user_code );
+                //  The TBB part transforms the first hostLength elements while the device transforms the rest
+                host_split_run( "transform", hostPart, hostLength, devicePart, sz - hostLength );
+                return;
+            }
+#endif
 		    #if defined(BOLT_DEBUG_LOG)
             dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORM,BOLTLOG::BOLT_OPENCL_GPU,"::Transform::OPENCL_GPU");
             #endif
@@ -468,11 +589,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancyIter );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -536,11 +655,9 @@ public:
             return;
 
         // Use host pointers memory since these arrays are only read once - no benefit to copying.
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancyIterfirst );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 		#if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -604,11 +721,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -677,11 +791,9 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        runMode = detail::iteratorRunMode( ctl, runMode, fancyIter );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -750,11 +862,8 @@ public:
         if (sz == 0)
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-           runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), false, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
 	    #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -784,6 +893,22 @@ public:
         }
         else
         {
+#ifdef ENABLE_TBB
+            size_t hostLength = bolt::cl::hostSplitLength( ctl, "transform", sz );
+            if( hostLength != 0 )
+            {
+                #if defined(BOLT_DEBUG_LOG)
+                dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORM,BOLTLOG::BOLT_HOST_SPLIT,"::Transform::HOST_SPLIT");
+                #endif
+                TransformUnaryHostPart< InputIterator, OutputIterator, UnaryFunction > hostPart( first,
+                    first + hostLength, result, f );
+                TransformUnaryDevicePart< InputIterator, OutputIterator, UnaryFunction > devicePart( ctl,
+                    first + hostLength, last, result + hostLength, f, user_code );
+                //  The TBB part transforms the first hostLength elements while the device transforms the rest
+                host_split_run( "transform", hostPart, hostLength, devicePart, sz - hostLength );
+                return;
+            }
+#endif
 		    #if defined(BOLT_DEBUG_LOG)
             dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORM,BOLTLOG::BOLT_OPENCL_GPU,"::Transform::OPENCL_GPU");
             #endif
@@ -817,11 +942,8 @@ public:
         if( sz == 0 )
             return;
 
-        bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode();  // could be dynamic choice some day.
-        if(runMode == bolt::cl::control::Automatic)
-        {
-             runMode = ctl.getDefaultPathToRun();
-        }
+        bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, sz, sizeof( oType ), true, true );
+        bolt::cl::tbbArenaScope tbbScope( ctl );
         #if defined(BOLT_DEBUG_LOG)
         BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
         #endif
@@ -30,6 +30,7 @@
 #ifdef ENABLE_TBB
 //TBB Includes
 #include "bolt/btbb/transform_reduce.h"
+#include "bolt/cl/detail/host_split.inl"
 #endif
 
 
@@ -49,6 +50,7 @@ namespace  detail {
        TransformReduce_KernelTemplateSpecializer() : KernelTemplateSpecializer()
         {
             addKernelName("transform_reduceTemplate");
+            addKernelName("transform_reduceFinalTemplate");
         }
 
         const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -57,16 +59,27 @@ namespace  detail {
             const std::string templateSpecializationString =
                 "// Host generates this instantiation string with user-specified value type and functor\n"
                 "template __attribute__((mangled_name("+name(0)+"Instantiated)))\n"
-                "__attribute__((reqd_work_group_size(256,1,1)))\n"
+                "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
                 "kernel void "+name(0)+"(\n"
                 "global " + typeNames[tr_iType] + "* input_ptr,\n"
                 + typeNames[tr_iIterType] + " iIter,\n"
-                "const int length,\n"
+                "const BOLT_INDEX_T length,\n"
                 "global " + typeNames[tr_UnaryFunction] + "* transformFunctor,\n"
                 "const " + typeNames[tr_oType] + " init,\n"
                 "global " + typeNames[tr_BinaryFunction] + "* reduceFunctor,\n"
                 "global " + typeNames[tr_oType] + "* result,\n"
                 "local " + typeNames[tr_oType] + "* scratch\n"
+                ");\n\n"
+
+                "// Host generates this instantiation string with user-specified value type and functor\n"
+                "template __attribute__((mangled_name(" + name(1) + "Instantiated)))\n"
+                "__attribute__((reqd_work_group_size(REDUCE_WG_SIZE,1,1)))\n"
+                "kernel void "+name(1)+"(\n"
+                "global " + typeNames[tr_oType] + "* partials,\n"
+                "const int numPartials,\n"
+                "const " + typeNames[tr_oType] + " init,\n"
+                "global " + typeNames[tr_BinaryFunction] + "* reduceFunctor,\n"
+                "local " + typeNames[tr_oType] + "* scratch\n"
                 ");\n\n";
                 return templateSpecializationString;
         }
@@ -111,16 +124,14 @@ namespace  detail {
              *********************************************************************************/
 
             // Set up shape of launch grid and buffers:
-            // FIXME, read from device attributes.
-
-            int computeUnits     = ctl.getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();// round up if we don't know.
-            int wgPerComputeUnit =  64;//ctl.getWGPerComputeUnit();
-
-            int numWG = computeUnits * wgPerComputeUnit;
-
             cl_int l_Error = CL_SUCCESS;
-            const size_t wgSize  = WAVEFRONT_SIZE;
-            V_OPENCL( l_Error, "Error querying kernel for CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE" );
+
+            size_t szElements = static_cast< size_t >( std::distance( first, last ) );
+            const tuningParams defaultShape = { WAVEFRONT_SIZE, 64, 8, 1 };
+            const tuningParams shape = findReduceTuning( ctl, "transform_reduce", typeNames[tr_iType], szElements,
+                defaultShape );
+            const size_t wgSize = shape.wgSize;
+            size_t numWG = reduceWorkGroups( ctl, szElements, shape );
 
             /**********************************************************************************
              * Compile Options
@@ -129,20 +140,24 @@ namespace  detail {
             const size_t kernel_WgSize = (cpuDevice) ? 1 : wgSize;
             std::string compileOptions;
             std::ostringstream oss;
-            oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize;
+            oss << " -DKERNELWORKGROUPSIZE=" << kernel_WgSize << " -DREDUCE_WG_SIZE=" << wgSize;
+            const kernelIndex index( szElements );
+            oss << index.compileOptions( );
             compileOptions = oss.str();
 
             /**********************************************************************************
              * Request Compiled Kernels
              *********************************************************************************/
             TransformReduce_KernelTemplateSpecializer ts_kts;
+            static ProgramCacheSlot ts_ktsSlot;
             std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
                 ctl,
                 typeNames,
                 &ts_kts,
                 typeDefinitions,
                 transform_reduce_kernels,
-                compileOptions);
+                compileOptions,
+                &ts_ktsSlot );
             // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
 
@@ -154,20 +169,7 @@ namespace  detail {
                                        CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_unary );
             control::buffPointer reduceFunctor = ctl.acquireBuffer( sizeof( aligned_binary ),
                                       CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_binary );
-            control::buffPointer result = ctl.acquireBuffer( sizeof( oType ) * numWG,
-                                                   CL_MEM_ALLOC_HOST_PTR|CL_MEM_WRITE_ONLY );
-
-            cl_uint szElements = static_cast< cl_uint >( std::distance( first, last ) );
-
-            /***** This is a temporaray fix *****/
-
-            /*What if  requiredWorkGroups > numWG? Do you want to loop or increase the work group size
-            or increase the per item processing?*/
-
-            int requiredWorkGroups = (int)ceil((float)szElements/wgSize);
-            if (requiredWorkGroups < numWG)
-                numWG = requiredWorkGroups;
-            /**********************/
+            control::buffPointer result = ctl.acquireBuffer( sizeof( oType ) * numWG, CL_MEM_READ_WRITE );
 
             typename  DVInputIterator::Payload first_payload = first.gpuPayload( ) ;
 
@@ -175,7 +177,7 @@ namespace  detail {
             V_OPENCL( kernels[0].setArg( 1, first.gpuPayloadSize( ),&first_payload),
                                                             "Error setting kernel argument" );
 
-            V_OPENCL( kernels[0].setArg( 2, szElements), "Error setting kernel argument" );
+            V_OPENCL( index.setArg( kernels[0], 2, szElements ), "Error setting kernel argument" );
             V_OPENCL( kernels[0].setArg( 3, *transformFunctor), "Error setting kernel argument" );
             V_OPENCL( kernels[0].setArg( 4, init), "Error setting kernel argument" );
             V_OPENCL( kernels[0].setArg( 5, *reduceFunctor), "Error setting kernel argument" );
@@ -192,36 +194,101 @@ namespace  detail {
                 ::cl::NDRange(wgSize) );
             V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for transform_reduce() kernel" );
 
-            ::cl::Event l_mapEvent;
-            oType *h_result = (oType*)ctl.getCommandQueue().enqueueMapBuffer(*result, false, CL_MAP_READ, 0,
-                                                        sizeof(oType)*numWG, NULL, &l_mapEvent, &l_Error );
-            V_OPENCL( l_Error, "Error calling map on the result buffer" );
+            //  Every workgroup holds at least one element, so each wrote a partial; fold them and init on the device
+            cl_int numPartials = static_cast< cl_int >( numWG );
+            V_OPENCL( kernels[1].setArg( 0, *result), "Error setting kernel argument" );
+            V_OPENCL( kernels[1].setArg( 1, numPartials), "Error setting kernel argument" );
+            V_OPENCL( kernels[1].setArg( 2, init), "Error setting kernel argument" );
+            V_OPENCL( kernels[1].setArg( 3, *reduceFunctor), "Error setting kernel argument" );
+            V_OPENCL( kernels[1].setArg( 4, loc ), "Error setting kernel argument" );
 
-            //  Finish the tail end of the reduction on host side; the compute device reduces within the workgroups,
-            // with one result per workgroup
-            size_t ceilNumWG = static_cast< size_t >( std::ceil( static_cast< float >( szElements ) / wgSize) );
-            bolt::cl::minimum< size_t >  min_size_t;
-            size_t numTailReduce = min_size_t( ceilNumWG, numWG );
+            l_Error = ctl.getCommandQueue().enqueueNDRangeKernel(
+                kernels[1],
+                ::cl::NullRange,
+                ::cl::NDRange(wgSize),
+                ::cl::NDRange(wgSize) );
+            V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for transform_reduce() final kernel" );
 
-            bolt::cl::wait(ctl, l_mapEvent);
+            //  Only the final value crosses back to the host
+            oType acc;
+            ::cl::Event l_readEvent;
+            V_OPENCL( ctl.getCommandQueue().enqueueReadBuffer(*result, CL_FALSE, 0, sizeof(oType), &acc, NULL,
+                &l_readEvent ), "Error reading the result of transform_reduce()" );
 
-            oType acc = static_cast< oType >( init );
-            for(unsigned int i = 0; i < numTailReduce; ++i)
-            {
-                acc = reduce_op( acc, h_result[ i ] );
-            }
+            bolt::cl::wait(ctl, l_readEvent, "transform_reduce");
 
+            return acc;
+        };
 
-			::cl::Event unmapEvent;
 
-			V_OPENCL( ctl.getCommandQueue().enqueueUnmapMemObject(*result,  h_result, NULL, &unmapEvent ),
-				"shared_ptr failed to unmap host memory back to device memory" );
-			V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
 
-            return acc;
+#ifdef ENABLE_TBB
+        template<typename InputIterator, typename UnaryFunction, typename oType, typename BinaryFunction>
+        struct TransformReduceHostPart
+        {
+            InputIterator first, last;
+            UnaryFunction transform_op;
+            oType init;
+            BinaryFunction reduce_op;
+            oType result;
+
+            TransformReduceHostPart( const InputIterator& _first, const InputIterator& _last,
+                const UnaryFunction& _transform_op, const oType& _init, const BinaryFunction& _reduce_op ) :
+                first( _first ), last( _last ), transform_op( _transform_op ), init( _init ),
+                reduce_op( _reduce_op ), result( _init ) { }
+
+            void operator( )( ) { result = bolt::btbb::transform_reduce( first, last, transform_op, init, reduce_op ); }
         };
 
+        //  The device part starts from its own first element, transformed, so init is only counted once
+        template<typename InputIterator, typename UnaryFunction, typename oType, typename BinaryFunction>
+        struct TransformReduceDevicePart
+        {
+            typedef typename std::iterator_traits<InputIterator>::value_type iType;
+
+            control& c;
+            InputIterator first, last;
+            UnaryFunction transform_op;
+            BinaryFunction reduce_op;
+            const std::string& user_code;
+            oType result;
+
+            TransformReduceDevicePart( control& _c, const InputIterator& _first, const InputIterator& _last,
+                const UnaryFunction& _transform_op, const BinaryFunction& _reduce_op, const std::string& _user_code ) :
+                c( _c ), first( _first ), last( _last ), transform_op( _transform_op ), reduce_op( _reduce_op ),
+                user_code( _user_code ), result( transform_op( *_first ) ) { }
+
+            void operator( )( )
+            {
+                device_vector< iType > dvInput( first + 1, last, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, c );
+                result = transform_reduce_enqueue( c, dvInput.begin( ), dvInput.end( ), transform_op, result,
+                                                   reduce_op, user_code );
+            }
+        };
 
+        //  Reduces the first hostLength elements with TBB while the device reduces the rest
+        template<typename InputIterator, typename UnaryFunction, typename oType, typename BinaryFunction>
+        oType transform_reduce_host_split(
+            control &c,
+            const InputIterator& first,
+            const InputIterator& last,
+            const UnaryFunction& transform_op,
+            const oType& init,
+            const BinaryFunction& reduce_op,
+            const std::string& user_code,
+            size_t hostLength )
+        {
+            TransformReduceHostPart< InputIterator, UnaryFunction, oType, BinaryFunction > hostPart( first,
+                first + hostLength, transform_op, init, reduce_op );
+            TransformReduceDevicePart< InputIterator, UnaryFunction, oType, BinaryFunction > devicePart( c,
+                first + hostLength, last, transform_op, reduce_op, user_code );
+            host_split_run( "transform_reduce", hostPart, hostLength, devicePart,
+                            static_cast< size_t >( last - first ) - hostLength );
+
+            BinaryFunction combine( reduce_op );
+            return combine( hostPart.result, devicePart.result );
+        };
+#endif
 
         // This template is called by the non-detail versions of transform_reduce,
         // it already assumes random access iterators
@@ -243,12 +310,8 @@ namespace  detail {
                     return init;
 
 
-            bolt::cl::control::e_RunMode runMode = c.getForceRunMode();  // could be dynamic choice some day.
-
-            if(runMode == bolt::cl::control::Automatic)
-            {
-                runMode = c.getDefaultPathToRun();
-            }
+            bolt::cl::control::e_RunMode runMode = selectRunMode( c, szElements, sizeof( iType ), false, true );
+            bolt::cl::tbbArenaScope tbbScope( c );
 			#if defined(BOLT_DEBUG_LOG)
             BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
             #endif
@@ -277,6 +340,17 @@ namespace  detail {
 					return init;
 #endif
             } else {
+                #ifdef ENABLE_TBB
+                size_t hostLength = bolt::cl::hostSplitLength( c, "transform_reduce", szElements );
+                if( hostLength != 0 )
+                {
+                    #if defined(BOLT_DEBUG_LOG)
+                    dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORMREDUCE,BOLTLOG::BOLT_HOST_SPLIT,"::Transform_Reduce::HOST_SPLIT");
+                    #endif
+                    return transform_reduce_host_split( c, first, last, transform_op, init, reduce_op, user_code,
+                                                        hostLength );
+                }
+                #endif
                 #if defined(BOLT_DEBUG_LOG)
                 dblog->CodePathTaken(BOLTLOG::BOLT_TRANSFORMREDUCE,BOLTLOG::BOLT_OPENCL_GPU,"::Transform_Reduce::OPENCL_GPU");
                 #endif
@@ -307,11 +381,8 @@ namespace  detail {
             if (szElements == 0)
                     return init;
 
-            bolt::cl::control::e_RunMode runMode = c.getForceRunMode();  // could be dynamic choice some day.
-            if(runMode == bolt::cl::control::Automatic)
-            {
-                runMode = c.getDefaultPathToRun();
-            }
+            bolt::cl::control::e_RunMode runMode = selectRunMode( c, szElements, sizeof( iType ), true, true );
+            bolt::cl::tbbArenaScope tbbScope( c );
 			#if defined(BOLT_DEBUG_LOG)
             BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
             #endif
@@ -111,6 +111,7 @@ public:
         addKernelName("perBlockTransformScan");
         addKernelName("intraBlockInclusiveScan");
         addKernelName("perBlockAddition");
+        addKernelName("singlePassTransformScan");
     }
 
     const ::std::string operator() ( const ::std::vector< ::std::string>& typeNames ) const
@@ -160,6 +161,25 @@ public:
             "global " + typeNames[transformScan_BinaryFunction] + "* binaryOp,\n"
             "int exclusive,\n"
             ""        + typeNames[transformScan_initType] + " identity\n"
+            ");\n\n"
+
+            "// Dynamic specialization of generic template definition, using user supplied types\n"
+            "template __attribute__((mangled_name(" + name(3) + "Instantiated)))\n"
+            "__attribute__((reqd_work_group_size(KERNEL0WORKGROUPSIZE,1,1)))\n"
+            "__kernel void " + name(3) + "(\n"
+            "global " + typeNames[transformScan_iValueType] + "* input_ptr,\n"
+            ""        + typeNames[transformScan_iIterType] + " input_iter,\n"
+            "global " + typeNames[transformScan_oValueType] + "* output_ptr,\n"
+            ""        + typeNames[transformScan_oIterType] + " output_iter,\n"
+            ""        + typeNames[transformScan_initType] + " identity,\n"
+            "const uint vecSize,\n"
+            "local "  + typeNames[transformScan_oValueType] + "* lds,\n"
+            "global " + typeNames[transformScan_UnaryFunction] + "* unaryOp,\n"
+            "global " + typeNames[transformScan_BinaryFunction] + "* binaryOp,\n"
+            "global " + typeNames[transformScan_oValueType] + "* tileAggregate,\n"
+            "global " + typeNames[transformScan_oValueType] + "* tileInclusive,\n"
+            "global int* tileStatus,\n"
+            "int exclusive\n"
             ");\n\n";
 
         return templateSpecializationString;
@@ -240,13 +260,15 @@ size_t k0_stepNum, k1_stepNum, k2_stepNum;
      * Request Compiled Kernels
      *********************************************************************************/
     TransformScan_KernelTemplateSpecializer ts_kts;
+    static ProgramCacheSlot ts_ktsSlot;
     std::vector< ::cl::Kernel > kernels = bolt::cl::getKernels(
         ctl,
         typeNames,
         &ts_kts,
         typeDefinitions,
-        transform_scan_kernels,
-        compileOptions);
+        scan_lookback_kernels + transform_scan_kernels,
+        compileOptions,
+        &ts_ktsSlot );
     // kernels returned in same order as added in KernelTemplaceSpecializer constructor
 
     // for profiling
@@ -287,10 +309,57 @@ size_t k0_stepNum, k1_stepNum, k2_stepNum;
         CL_MEM_USE_HOST_PTR|CL_MEM_READ_ONLY, &aligned_binary_op );
 
 
+    cl_uint ldsSize;
+
+    /**********************************************************************************
+     *  Single pass: one tile per work-group, chained through a tile status buffer
+     *********************************************************************************/
+    if( !cpuDevice && singlePassScanSupported( ctl ) )
+    {
+        // the last status word is the counter that hands out tile numbers
+        control::buffPointer tileAggregate = ctl.acquireBuffer( numWorkGroupsK0*sizeof( oType ) );
+        control::buffPointer tileInclusive = ctl.acquireBuffer( numWorkGroupsK0*sizeof( oType ) );
+        control::buffPointer tileStatus = ctl.acquireBuffer( ( numWorkGroupsK0 + 1 )*sizeof( cl_int ) );
+        V_OPENCL( ctl.getCommandQueue( ).enqueueFillBuffer< cl_int >( *tileStatus, 0, 0,
+            ( numWorkGroupsK0 + 1 )*sizeof( cl_int ) ), "Error clearing tile status for singlePassTransformScan" );
+
+        typename DVInputIterator::Payload first_payload = first.gpuPayload( );
+        typename DVOutputIterator::Payload result_payload = result.gpuPayload( );
+
+        ldsSize = static_cast< cl_uint >( ( kernel0_WgSize*2 ) * sizeof( oType ) );
+        V_OPENCL( kernels[3].setArg( 0, first.getContainer().getBuffer() ),  "Error setArg kernels[ 3 ]" ); // Input buffer
+        V_OPENCL( kernels[3].setArg( 1, first.gpuPayloadSize( ), &first_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[3].setArg( 2, result.getContainer().getBuffer() ), "Error setArg kernels[ 3 ]" ); // Output buffer
+        V_OPENCL( kernels[3].setArg( 3, result.gpuPayloadSize( ), &result_payload ), "Error setting a kernel argument" );
+        V_OPENCL( kernels[3].setArg( 4, init_T ),               "Error setArg kernels[ 3 ]" ); // Initial value exclusive
+        V_OPENCL( kernels[3].setArg( 5, numElements ),          "Error setArg kernels[ 3 ]" ); // Number of elements
+        V_OPENCL( kernels[3].setArg( 6, ldsSize, NULL ),        "Error setArg kernels[ 3 ]" ); // Scratch buffer
+        V_OPENCL( kernels[3].setArg( 7, *unaryBuffer ),         "Error setArg kernels[ 3 ]" ); // User provided functor
+        V_OPENCL( kernels[3].setArg( 8, *binaryBuffer ),        "Error setArg kernels[ 3 ]" ); // User provided functor
+        V_OPENCL( kernels[3].setArg( 9, *tileAggregate ),       "Error setArg kernels[ 3 ]" ); // Per tile reduction
+        V_OPENCL( kernels[3].setArg( 10, *tileInclusive ),      "Error setArg kernels[ 3 ]" ); // Per tile inclusive prefix
+        V_OPENCL( kernels[3].setArg( 11, *tileStatus ),         "Error setArg kernels[ 3 ]" ); // Per tile status flags
+        V_OPENCL( kernels[3].setArg( 12, doExclusiveScan ),     "Error setArg kernels[ 3 ]" ); // Exclusive scan?
+
+        l_Error = ctl.getCommandQueue( ).enqueueNDRangeKernel(
+            kernels[3],
+            ::cl::NullRange,
+            ::cl::NDRange( sizeInputBuff/2 ),
+            ::cl::NDRange( kernel0_WgSize ),
+            NULL,
+            &kernelAEvent );
+        V_OPENCL( l_Error, "enqueueNDRangeKernel() failed for singlePassTransformScan" );
+
+        bolt::cl::wait( ctl, kernelAEvent, "transform_scan" );
+#ifdef BOLT_ENABLE_PROFILING
+aProfiler.stopTrial();
+#endif
+        return;
+    }
+
     control::buffPointer preSumArray  = ctl.acquireBuffer( sizeScanBuff*sizeof( iType ) );
     control::buffPointer preSumArray1 = ctl.acquireBuffer( (sizeScanBuff)*sizeof( iType ) );
     control::buffPointer postSumArray = ctl.acquireBuffer( sizeScanBuff*sizeof( iType ) );
-    cl_uint ldsSize;
 
 
     /**********************************************************************************
@@ -526,12 +595,8 @@ transform_scan_pick_iterator(
     if( numElements == 0 )
         return result;
 
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( iType ), false );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -620,12 +685,8 @@ transform_scan_pick_iterator(
     unsigned int numElements = static_cast< unsigned int >( std::distance( first, last ) );
     if( numElements < 1 )
         return result;
-    bolt::cl::control::e_RunMode runMode = ctl.getForceRunMode( );
-
-    if( runMode == bolt::cl::control::Automatic )
-    {
-        runMode = ctl.getDefaultPathToRun();
-    }
+    bolt::cl::control::e_RunMode runMode = selectRunMode( ctl, numElements, sizeof( iType ), true );
+    bolt::cl::tbbArenaScope tbbScope( ctl );
     #if defined(BOLT_DEBUG_LOG)
     BOLTLOG::CaptureLog *dblog = BOLTLOG::CaptureLog::getInstance();
     #endif
@@ -0,0 +1,124 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_UNIQUE_INL )
+#define BOLT_CL_UNIQUE_INL
+#pragma once
+
+#include "bolt/cl/detail/compaction.inl"
+
+namespace bolt {
+    namespace cl {
+
+        template< typename ForwardIterator, typename BinaryPredicate >
+        ForwardIterator unique( bolt::cl::control &ctl,
+                                ForwardIterator first,
+                                ForwardIterator last,
+                                BinaryPredicate binary_pred,
+                                const std::string& cl_code )
+        {
+            size_t numKept = detail::compaction_inplace_detect_random_access( ctl, first, last, first,
+                detail::CompactionUniqueHeads< BinaryPredicate >( binary_pred ), false, false, cl_code,
+                typename std::iterator_traits< ForwardIterator >::iterator_category( ) );
+            return first + numKept;
+        }
+
+        template< typename ForwardIterator, typename BinaryPredicate >
+        ForwardIterator unique( ForwardIterator first,
+                                ForwardIterator last,
+                                BinaryPredicate binary_pred,
+                                const std::string& cl_code )
+        {
+            return bolt::cl::unique( bolt::cl::control::getDefault( ), first, last, binary_pred, cl_code );
+        }
+
+        template< typename ForwardIterator >
+        ForwardIterator unique( bolt::cl::control &ctl,
+                                ForwardIterator first,
+                                ForwardIterator last,
+                                const std::string& cl_code )
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type kType;
+            return bolt::cl::unique( ctl, first, last, bolt::cl::equal_to< kType >( ), cl_code );
+        }
+
+        template< typename ForwardIterator >
+        ForwardIterator unique( ForwardIterator first,
+                                ForwardIterator last,
+                                const std::string& cl_code )
+        {
+            typedef typename std::iterator_traits< ForwardIterator >::value_type kType;
+            return bolt::cl::unique( bolt::cl::control::getDefault( ), first, last, bolt::cl::equal_to< kType >( ),
+                                     cl_code );
+        }
+
+        template< typename ForwardIterator1, typename ForwardIterator2, typename BinaryPredicate >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( bolt::cl::control &ctl,
+                       ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       BinaryPredicate binary_pred,
+                       const std::string& cl_code )
+        {
+            size_t numKept = detail::compaction_inplace_detect_random_access( ctl, keys_first, keys_last,
+                values_first, detail::CompactionUniqueHeads< BinaryPredicate >( binary_pred ), true, false, cl_code,
+                typename std::iterator_traits< ForwardIterator1 >::iterator_category( ) );
+            return bolt::cl::make_pair( keys_first + numKept, values_first + numKept );
+        }
+
+        template< typename ForwardIterator1, typename ForwardIterator2, typename BinaryPredicate >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       BinaryPredicate binary_pred,
+                       const std::string& cl_code )
+        {
+            return bolt::cl::unique_by_key( bolt::cl::control::getDefault( ), keys_first, keys_last, values_first,
+                                            binary_pred, cl_code );
+        }
+
+        template< typename ForwardIterator1, typename ForwardIterator2 >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( bolt::cl::control &ctl,
+                       ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       const std::string& cl_code )
+        {
+            typedef typename std::iterator_traits< ForwardIterator1 >::value_type kType;
+            return bolt::cl::unique_by_key( ctl, keys_first, keys_last, values_first, bolt::cl::equal_to< kType >( ),
+                                            cl_code );
+        }
+
+        template< typename ForwardIterator1, typename ForwardIterator2 >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       const std::string& cl_code )
+        {
+            typedef typename std::iterator_traits< ForwardIterator1 >::value_type kType;
+            return bolt::cl::unique_by_key( bolt::cl::control::getDefault( ), keys_first, keys_last, values_first,
+                                            bolt::cl::equal_to< kType >( ), cl_code );
+        }
+
+    } // cl
+} // bolt
+
+#endif // BOLT_CL_UNIQUE_INL
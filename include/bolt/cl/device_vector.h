@@ -22,9 +22,13 @@
 #if !defined( BOLT_CL_DEVICE_VECTOR_H )
 #define BOLT_CL_DEVICE_VECTOR_H
 
+#include <cstddef>
 #include <iterator>
 #include <type_traits>
 #include <numeric>
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "bolt/cl/bolt.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 #include <iostream>
@@ -113,7 +117,8 @@ namespace cl
             *   memory, which may be in a partitioned memory space.  Access to a reference of the container results in
             *   a mapping and unmapping operation of device memory.
             *   \note The container element reference is implemented as a proxy object.
-            *   \warning Use of this class can be slow: each operation on it results in a map/unmap sequence.
+            *   \warning Use of this class can be slow: each operation on it results in a map/unmap sequence, unless the
+            *   container keeps a host mirror (see setHostMirror).  To touch many elements, map them once with a host_view.
             */
             template< typename Container >
             class reference_base
@@ -127,32 +132,12 @@ namespace cl
                 //  Automatic type conversion operator to turn the reference object into a value_type
                 operator value_type( ) const
                 {
-                    cl_int l_Error = CL_SUCCESS;
-                    naked_pointer result = reinterpret_cast< naked_pointer >( m_Container.m_commQueue.enqueueMapBuffer(
-                    m_Container.m_devMemory, true, CL_MAP_READ, m_Index * sizeof( value_type ), sizeof( value_type ), NULL, NULL, &l_Error ) );
-                    V_OPENCL( l_Error, "device_vector failed map device memory to host memory for operator[]" );
-
-                    value_type valTmp = *result;
-
-                    ::cl::Event unmapEvent;
-                    V_OPENCL( m_Container.m_commQueue.enqueueUnmapMemObject( m_Container.m_devMemory, result, NULL, &unmapEvent ), "device_vector failed to unmap host memory back to device memory" );
-                    V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
-
-                    return valTmp;
+                    return m_Container.readElement( m_Index );
                 }
 
                 reference_base< Container >& operator=( const value_type& rhs )
                 {
-                    cl_int l_Error = CL_SUCCESS;
-                    naked_pointer result = reinterpret_cast< naked_pointer >( m_Container.m_commQueue.enqueueMapBuffer(
-                    m_Container.m_devMemory, true, CL_MAP_WRITE_INVALIDATE_REGION, m_Index * sizeof( value_type ), sizeof( value_type ), NULL, NULL, &l_Error ) );
-                    V_OPENCL( l_Error, "device_vector failed map device memory to host memory for operator[]" );
-
-                    *result = rhs;
-
-                    ::cl::Event unmapEvent;
-                    V_OPENCL( m_Container.m_commQueue.enqueueUnmapMemObject( m_Container.m_devMemory, result, NULL, &unmapEvent ), "device_vector failed to unmap host memory back to device memory" );
-                    V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+                    m_Container.writeElement( m_Index, rhs );
 
                     return *this;
                 }
@@ -195,16 +180,16 @@ namespace cl
             *   \bug operator[] with device_vector iterators result in a compile-time error when accessed for reading.
             *   Writing with operator[] appears to be OK.  Workarounds: either use the operator[] on the device_vector
             *   container, or use iterator arithmetic instead, such as *(iter + 5) for reading from the iterator.
-            *   \note The difference_type for this iterator has been explicitely set to a 32-bit int, because m_Index 
-            *   is used in clSetKernelArg(), which does not accept size_t parameters
+            *   \note m_Index is passed to the kernels in a Payload of fixed layout, with a 64-bit offset, so an
+            *   iterator reaches every element of a container of more than 2^32 elements on the device as well.
             */
             template< typename Container >
             class iterator_base: public boost::iterator_facade< iterator_base< Container >, value_type, device_vector_tag, 
-            typename device_vector::reference, int >
+            typename device_vector::reference, std::ptrdiff_t >
             {
             public:
             typedef typename boost::iterator_facade< iterator_base< Container >, value_type, device_vector_tag, 
-            typename device_vector::reference, int >::difference_type difference_type;
+            typename device_vector::reference, std::ptrdiff_t >::difference_type difference_type;
 
 
                 //typedef iterator_facade::difference_type difference_type;
@@ -213,13 +198,12 @@ namespace cl
                 //  the only reason we allocate space for a pointer in this payload is because the openCl clSetKernelArg() checks the
                 //  size ( bytes ) of the argument passed in, and the corresponding GPU iterator has a pointer member.  
                 //  The value of the pointer is not relevant on host side, and is initialized on the device side with the init method 
-                //  This size of the payload needs to be able to encapsulate both 32bit and 64bit devices
-                //  sizeof( 32bit device payload ) = 32bit index & 32bit pointer = 8 bytes
-                //  sizeof( 64bit device payload ) = 32bit index & 64bit aligned pointer = 16 bytes
+                //  The index is 64bit on every device, which aligns the pointer that follows it to 8 bytes, so the
+                //  payload is 16 bytes on both 32bit and 64bit devices
                 struct Payload
                 {
-                    difference_type m_Index;
-                    difference_type m_Ptr1[ 3 ];  // Represents device pointer, big enough for 32 or 64bit
+                    cl_long m_Index;
+                    cl_long m_Ptr;  // Represents device pointer, big enough for 32 or 64bit
                 };
 
                 
@@ -275,30 +259,15 @@ namespace cl
                 //  on the host
                 const Payload  gpuPayload( ) const
                 {
-                    Payload payload = { m_Index, { 0, 0, 0 } };
+                    Payload payload = { m_Index, 0 };
                     return payload;
                 }
 
-                //  Calculates the size of payload for the cl device.  The bitness of the device is independant of the host and must be 
-                //  queried.  The bitness of the device determines the size of the pointer contained in the payload.  64bit pointers must
-                //  be 8 byte aligned, so 
+                //  Calculates the size of payload for the cl device.  The 64bit index pads the pointer to 8 bytes whatever the
+                //  bitness of the device, so no device query is needed
                 const difference_type gpuPayloadSize( ) const
                 {
-                    cl_int l_Error = CL_SUCCESS;
-		    ::cl::Device which_device;
-		   l_Error  = m_Container.m_commQueue.getInfo(CL_QUEUE_DEVICE,&which_device );	
-                   
-		  cl_uint deviceBits = which_device.getInfo< CL_DEVICE_ADDRESS_BITS >( );
-
-                    //  Size of index and pointer
-                    difference_type payloadSize = sizeof( difference_type ) + ( deviceBits >> 3 );
-
-                    //  64bit devices need to add padding for 8 byte aligned pointer
-                    if( deviceBits == 64 )
-                        payloadSize += 4;
-
-                    return payloadSize;
-
+                    return sizeof( Payload );
                 }
 
                 difference_type m_Index;
@@ -481,6 +450,128 @@ namespace cl
             */
             typedef reverse_iterator_base< const device_vector< value_type > > const_reverse_iterator;
 
+            /*! \brief A range of the container mapped into host memory for as long as the view lives.
+            *   \details The range is mapped once with the map flags given, and unmapped by the destructor.  In between,
+            *   its elements are plain host memory, read and written through data( ), begin( ) and operator[] without
+            *   further OpenCL calls.  Kernels must not use the container while a view of it is alive.
+            *   \note CL_MAP_WRITE_INVALIDATE_REGION leaves the previous contents of the range undefined; use it for
+            *   ranges the view overwrites.
+            */
+            template< typename Container, typename Pointer >
+            class host_view_base
+            {
+            public:
+                typedef Pointer iterator;
+                typedef Pointer pointer;
+                typedef typename std::iterator_traits< Pointer >::reference reference;
+                typedef typename device_vector::size_type size_type;
+
+                //  Maps the whole container; for reading and writing unless the container is const
+                explicit host_view_base( Container& rhs ): m_Container( rhs )
+                {
+                    map( 0, rhs.size( ), defaultMapFlags( rhs ) );
+                }
+
+                host_view_base( Container& rhs, cl_map_flags flags ): m_Container( rhs )
+                {
+                    map( 0, rhs.size( ), flags );
+                }
+
+                //  Maps the count elements starting at offset
+                host_view_base( Container& rhs, size_type offset, size_type count ): m_Container( rhs )
+                {
+                    map( offset, count, defaultMapFlags( rhs ) );
+                }
+
+                host_view_base( Container& rhs, size_type offset, size_type count, cl_map_flags flags ):
+                    m_Container( rhs )
+                {
+                    map( offset, count, flags );
+                }
+
+                ~host_view_base( )
+                {
+                    if( m_Ptr == NULL )
+                        return;
+
+                    //  A destructor must not throw, so a failed unmap is left for the next call on the queue to report
+                    ::cl::Event unmapEvent;
+                    if( m_Container.m_commQueue.enqueueUnmapMemObject( m_Container.m_devMemory,
+                        const_cast< naked_pointer >( m_Ptr ), NULL, &unmapEvent ) == CL_SUCCESS )
+                        unmapEvent.wait( );
+                }
+
+                pointer data( ) const
+                {
+                    return m_Ptr;
+                }
+
+                iterator begin( ) const
+                {
+                    return m_Ptr;
+                }
+
+                iterator end( ) const
+                {
+                    return m_Ptr + m_Count;
+                }
+
+                size_type size( ) const
+                {
+                    return m_Count;
+                }
+
+                reference operator[]( size_type n ) const
+                {
+                    return m_Ptr[ n ];
+                }
+
+            private:
+                host_view_base( const host_view_base& );
+                host_view_base& operator=( const host_view_base& );
+
+                static cl_map_flags defaultMapFlags( const device_vector& )
+                {
+                    return CL_MAP_READ;
+                }
+
+                static cl_map_flags defaultMapFlags( device_vector& )
+                {
+                    return CL_MAP_READ | CL_MAP_WRITE;
+                }
+
+                void map( size_type offset, size_type count, cl_map_flags flags )
+                {
+                    m_Ptr = NULL;
+                    m_Count = count;
+                    if( offset > m_Container.m_Size || count > m_Container.m_Size - offset )
+                        throw ::cl::Error( CL_INVALID_VALUE, "host_view range exceeds the size of the device_vector" );
+                    if( count == 0 )
+                        return;
+
+                    //  Elements written through the host mirror must reach the buffer before it is mapped
+                    m_Container.releaseHostMirror( );
+
+                    cl_int l_Error = CL_SUCCESS;
+                    m_Ptr = reinterpret_cast< Pointer >( m_Container.m_commQueue.enqueueMapBuffer(
+                        m_Container.m_devMemory, true, flags, offset * sizeof( value_type ),
+                        count * sizeof( value_type ), NULL, NULL, &l_Error ) );
+                    V_OPENCL( l_Error, "device_vector failed map device memory to host memory for host_view" );
+                }
+
+                Container& m_Container;
+                Pointer m_Ptr;
+                size_type m_Count;
+            };
+
+            /*! \brief A view that reads and writes a range of the container in host memory.
+            */
+            typedef host_view_base< device_vector< value_type >, naked_pointer > host_view;
+
+            /*! \brief A view that reads a range of the container in host memory.
+            */
+            typedef host_view_base< const device_vector< value_type >, const_naked_pointer > const_host_view;
+
 
             /*! \brief A default constructor that creates an empty device_vector
             *   \param ctl An Bolt control class used to perform copy operations; a default is used if not supplied by the user
@@ -626,6 +717,7 @@ namespace cl
 
                 if( m_Flags & CL_MEM_USE_HOST_PTR )
                 {
+                    recordHostPtrWrap( ctl, &*begin, m_Size * sizeof( value_type ) );
                     m_devMemory = ::cl::Buffer( l_Context, m_Flags, m_Size * sizeof( value_type ),
                         reinterpret_cast< value_type* >( const_cast< value_type* >( &*begin ) ) );
                 }
@@ -683,6 +775,7 @@ namespace cl
 
                 if( m_Flags & CL_MEM_USE_HOST_PTR )
                 {
+                    recordHostPtrWrap( ctl, &*begin, byteSize );
                     m_devMemory = ::cl::Buffer( l_Context, m_Flags, byteSize,
                         reinterpret_cast< value_type* >( const_cast< value_type* >( &*begin ) ) );
                 }
@@ -729,6 +822,8 @@ namespace cl
                 if( m_Size == 0 )
                     return;
 
+                rhs.writeBackHostMirror( );
+
                 size_type l_srcSize = m_Size * sizeof( value_type );
                 ::cl::Event copyEvent;
 
@@ -743,6 +838,14 @@ namespace cl
                 if( this == &rhs )
                     return *this;
 
+                discardHostMirror( );
+                rhs.writeBackHostMirror( );
+
+                //  The buffer held is only reused when it was allocated with the same flags; one wrapping host memory
+                //  or one the device may not write is released instead of being written through
+                if( m_Flags != rhs.m_Flags )
+                    clear( );
+
                 m_Flags         = rhs.m_Flags;
                 m_commQueue     = rhs.m_commQueue;
                 m_Size        = capacity( );
@@ -764,6 +867,27 @@ namespace cl
                 return *this;
             }
 
+            /*! \brief Takes over the buffer of \p rhs without copying device memory; \p rhs is left empty, on the same
+            *   command queue.
+            */
+            device_vector( device_vector&& rhs ): m_Size( 0 ), m_commQueue( rhs.m_commQueue ), m_Flags( rhs.m_Flags )
+            {
+                swap( rhs );
+            }
+
+            /*! \brief Takes over the buffer of \p rhs without copying device memory, and releases the buffer held
+            *   before; \p rhs is left empty.
+            */
+            device_vector& operator=( device_vector&& rhs )
+            {
+                if( this == &rhs )
+                    return *this;
+
+                swap( rhs );
+                rhs.clear( );
+                return *this;
+            }
+
             //  Member functions
 
             /*! \brief Change the number of elements in device_vector to reqSize.
@@ -780,16 +904,22 @@ namespace cl
 
             void resize( size_type reqSize, const value_type& val = value_type( ) )
             {
+                releaseHostMirror( );
+
                 if( (m_Flags & CL_MEM_USE_HOST_PTR) != 0 )
                 {
                     throw ::cl::Error( CL_MEM_OBJECT_ALLOCATION_FAILURE ,
                         "A device_vector can not resize() memory not under its direct control" );
                 }
 
-                size_type cap = capacity( );
-
-                if( reqSize == cap )
+                //  Within the capacity only the new elements are touched, as in std::vector
+                if( reqSize <= capacity( ) )
+                {
+                    if( reqSize > m_Size )
+                        fillElements( m_Size, reqSize, val );
+                    m_Size = reqSize;
                     return;
+                }
 
                 if( reqSize > max_size( ) )
                     throw ::cl::Error( CL_MEM_OBJECT_ALLOCATION_FAILURE ,
@@ -940,6 +1070,7 @@ namespace cl
 
                 //  Operator= should call retain/release appropriately
                 m_devMemory = l_tmpBuffer;
+                m_poolBuffer.reset( );
             }
 
             /*! \brief Return the number of known elements
@@ -981,6 +1112,8 @@ namespace cl
                 if( reqSize <= capacity( ) )
                     return;
 
+                releaseHostMirror( );
+
                 if( reqSize > max_size( ) )
                     throw ::cl::Error( CL_MEM_OBJECT_ALLOCATION_FAILURE , "The amount of memory requested exceeds what is available" );
 
@@ -993,6 +1126,7 @@ namespace cl
                 {
                     ::cl::Buffer l_tmpBuffer( l_Context, m_Flags, reqSize * sizeof( value_type ) );
                     m_devMemory = l_tmpBuffer;
+                    m_poolBuffer.reset( );
                     return;
                 }
 
@@ -1013,6 +1147,7 @@ namespace cl
 
                 //  Operator= should call retain/release appropriately
                 m_devMemory = l_tmpBuffer;
+                m_poolBuffer.reset( );
             }
 
             /*! \brief Return the maximum possible number of elements without reallocation.
@@ -1051,6 +1186,8 @@ namespace cl
                 if( m_Size == capacity( ) )
                     return;
 
+                releaseHostMirror( );
+
                 //  We want to use the context from the passed in commandqueue to initialize our buffer
                 cl_int l_Error = CL_SUCCESS;
                 ::cl::Context l_Context = m_commQueue.getInfo< CL_QUEUE_CONTEXT >( &l_Error );
@@ -1074,6 +1211,7 @@ namespace cl
 
                 //  Operator= should call retain/release appropriately
                 m_devMemory = l_tmpBuffer;
+                m_poolBuffer.reset( );
             }
 
             /*! \brief Retrieves the value stored at index n.
@@ -1090,19 +1228,7 @@ namespace cl
             */
             const_reference operator[]( size_type n ) const
             {
-                cl_int l_Error = CL_SUCCESS;
-
-                naked_pointer ptrBuff = reinterpret_cast< naked_pointer >( m_commQueue.enqueueMapBuffer( m_devMemory, true, CL_MAP_READ, n * sizeof( value_type), sizeof( value_type), NULL, NULL, &l_Error ) );
-                V_OPENCL( l_Error, "device_vector failed map device memory to host memory for operator[]" );
-
-                const_reference tmpRef = *ptrBuff;
-
-                ::cl::Event unmapEvent;
-                l_Error = m_commQueue.enqueueUnmapMemObject( m_devMemory, ptrBuff, NULL, &unmapEvent );
-                V_OPENCL( l_Error, "device_vector failed to unmap host memory back to device memory" );
-                V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
-
-                return tmpRef;
+                return readElement( n );
             }
 
             /*! \brief Retrieves an iterator for this container that points at the beginning element.
@@ -1261,6 +1387,7 @@ namespace cl
                     pointer sp;
                     return sp;
                 }
+                releaseHostMirror( );
                 cl_int l_Error = CL_SUCCESS;
 
                 naked_pointer ptrBuff = reinterpret_cast< naked_pointer >( m_commQueue.enqueueMapBuffer( m_devMemory, true, CL_MAP_READ | CL_MAP_WRITE,
@@ -1275,6 +1402,7 @@ namespace cl
 
             const_pointer data( void ) const
             {
+                releaseHostMirror( );
                 cl_int l_Error = CL_SUCCESS;
 
                 const_naked_pointer ptrBuff = reinterpret_cast< const_naked_pointer >( m_commQueue.enqueueMapBuffer( m_devMemory, true, CL_MAP_READ,
@@ -1290,6 +1418,8 @@ namespace cl
             */
             void clear( void )
             {
+                discardHostMirror( );
+
                 //  Only way to release the Buffer resource is to explicitly call the destructor
                 // m_devMemory.~Buffer( );
 
@@ -1297,6 +1427,7 @@ namespace cl
                 //  calling the Wrapper destructor with cl.hpp version 1.2.
                 ::cl::Buffer tmp;
                 m_devMemory = tmp;
+                m_poolBuffer.reset( );
 
                 m_Size = 0;
             }
@@ -1318,10 +1449,16 @@ namespace cl
                     throw ::cl::Error( CL_MEM_OBJECT_ALLOCATION_FAILURE , "device_vector size can not be greater than capacity( )" );
 
                 //  Need to grow the vector to push new value.
-                //  Vectors double their capacity on push_back if the array is not big enough.
                 if( m_Size == capacity( ) )
+                    growCapacity( m_Size + 1 );
+
+                if( m_Mirror.enabled )
                 {
-                    m_Size ? reserve( m_Size * 2 ) : reserve( 1 );
+                    loadHostMirror( );
+                    m_Mirror.values.push_back( value );
+                    markHostMirrorDirty( m_Size, m_Size + 1 );
+                    ++m_Size;
+                    return;
                 }
 
                 cl_int l_Error = CL_SUCCESS;
@@ -1346,6 +1483,8 @@ namespace cl
                 if( m_Size > 0 )
                 {
                     --m_Size;
+                    if( m_Mirror.valid )
+                        m_Mirror.values.pop_back( );
                 }
             }
 
@@ -1357,6 +1496,10 @@ namespace cl
                 if( this == &vec )
                     return;
 
+                //  The host mirrors and pool leases describe the buffers, so they change hands with them
+                std::swap( m_Mirror, vec.m_Mirror );
+                m_poolBuffer.swap( vec.m_poolBuffer );
+
                 ::cl::Buffer    swapBuffer( m_devMemory );
                 m_devMemory = vec.m_devMemory;
                 vec.m_devMemory = swapBuffer;
@@ -1387,6 +1530,8 @@ namespace cl
             if( index.m_Index >= l_End.m_Index )
                     throw ::cl::Error( CL_INVALID_ARG_INDEX , "Iterator is pointing past the end of this container" );
 
+                releaseHostMirror( );
+
             size_type sizeRegion = l_End.m_Index - index.m_Index;
 
                 cl_int l_Error = CL_SUCCESS;
@@ -1420,6 +1565,8 @@ namespace cl
             if( last.m_Index > m_Size )
                     throw ::cl::Error( CL_INVALID_ARG_INDEX , "Iterator is pointing past the end of this container" );
 
+                releaseHostMirror( );
+
                 if( (first == begin( )) && (last == end( )) )
                 {
                     clear( );
@@ -1463,6 +1610,8 @@ namespace cl
             if( index.m_Index > m_Size )
                     throw ::cl::Error( CL_INVALID_ARG_INDEX , "Iterator is pointing past the end of this container" );
 
+                releaseHostMirror( );
+
             if( index.m_Index == m_Size )
                 {
                     push_back( value );
@@ -1470,12 +1619,8 @@ namespace cl
                 }
 
                 //  Need to grow the vector to insert a new value.
-                //  TODO:  What is an appropriate growth strategy for GPU memory allocation?  Exponential growth does not seem
-                //  right at first blush.
                 if( m_Size == capacity( ) )
-                {
-                    reserve( m_Size + 10 );
-                }
+                    growCapacity( m_Size + 1 );
 
             size_type sizeMap = (m_Size - index.m_Index) + 1;
 
@@ -1515,13 +1660,13 @@ namespace cl
             if( index.m_Index > m_Size )
                     throw ::cl::Error( CL_INVALID_ARG_INDEX , "Iterator is pointing past the end of this container" );
 
+                releaseHostMirror( );
+
                 //  Need to grow the vector to insert a new value.
                 //  TODO:  What is an appropriate growth strategy for GPU memory allocation?  Exponential growth does not seem
                 //  right at first blush.
                 if( ( m_Size + n ) > capacity( ) )
-                {
-                    reserve( m_Size + n );
-                }
+                    growCapacity( m_Size + n );
 
             size_type sizeMap = (m_Size - index.m_Index) + n;
 
@@ -1556,14 +1701,14 @@ namespace cl
             if( index.m_Index > m_Size )
                     throw ::cl::Error( CL_INVALID_ARG_INDEX , "Iterator is pointing past the end of this container" );
 
+                releaseHostMirror( );
+
                 //  Need to grow the vector to insert a new value.
                 //  TODO:  What is an appropriate growth strategy for GPU memory allocation?  Exponential growth does not seem
                 //  right at first blush.
                 size_type n = std::distance( begin, end );
                 if( ( m_Size + n ) > capacity( ) )
-                {
-                    reserve( m_Size + n );
-                }
+                    growCapacity( m_Size + n );
             size_type sizeMap = (m_Size - index.m_Index) + n;
 
                 cl_int l_Error = CL_SUCCESS;
@@ -1597,6 +1742,7 @@ namespace cl
 
             void assign( size_type newSize, const value_type& value )
             {
+                discardHostMirror( );
                 if( newSize > m_Size )
                 {
                     reserve( newSize );
@@ -1668,6 +1814,7 @@ namespace cl
             assign( InputIterator begin, InputIterator end )
 #endif
             {
+                discardHostMirror( );
                 size_type l_Count = std::distance( begin, end );
 
                 if( l_Count > m_Size )
@@ -1701,6 +1848,7 @@ namespace cl
             */
             const ::cl::Buffer& getBuffer( ) const
                 {
+                releaseHostMirror( );
                 return m_devMemory;
                 }
 
@@ -1712,14 +1860,272 @@ namespace cl
             */
             ::cl::Buffer& getBuffer( )
             {
+                releaseHostMirror( );
                 return m_devMemory;
             }
 
+            /*! \brief Keeps a host copy of the elements for operator[], front( ), back( ) and push_back( ), so that
+            *   they no longer map device memory for every element.
+            *   \details The copy is read from the device in one transfer by the first element access.  Elements written
+            *   through it are marked dirty, and the dirty ranges are written back together by flushHostMirror( ), or
+            *   before the buffer is next used: getBuffer( ), data( ), a host_view and every member function that
+            *   reallocates or moves elements write back first and drop the copy, and the next element access reads
+            *   it again.  Bolt algorithms reach the buffer through getBuffer( ), so they see the writes and their
+            *   results are seen in turn.
+            *   \note Another device_vector that wraps the same ::cl::Buffer does not see the copy.
+            *   \param enable false writes the copy back and frees it.
+            */
+            void setHostMirror( bool enable )
+            {
+                if( !enable )
+                {
+                    releaseHostMirror( );
+                    std::vector< value_type >( ).swap( m_Mirror.values );
+                }
+                m_Mirror.enabled = enable;
+            }
+
+            /*! \brief Whether element accesses go through a host copy; see setHostMirror.
+            */
+            bool getHostMirror( ) const
+            {
+                return m_Mirror.enabled;
+            }
+
+            /*! \brief Writes the elements changed through the host mirror back to the device, in one transfer per
+            *   dirty range.  The mirror stays valid.
+            */
+            void flushHostMirror( )
+            {
+                writeBackHostMirror( );
+            }
+
         private:
+            //  The host copy of the elements behind setHostMirror, and the ranges of it written since the last write back
+            struct hostMirror
+            {
+                hostMirror( ): valid( false ), enabled( false )
+                {}
+
+                std::vector< value_type > values;
+                std::vector< std::pair< size_type, size_type > > dirty;
+                bool valid;
+                bool enabled;
+            };
+
+            //  Past this many dirty ranges they are merged into the one range that spans them all
+            static const size_t maxDirtyRanges = 64;
+
+            value_type readElement( size_type index ) const
+            {
+                if( m_Mirror.enabled )
+                {
+                    loadHostMirror( );
+                    return m_Mirror.values[ index ];
+                }
+
+                cl_int l_Error = CL_SUCCESS;
+                naked_pointer result = reinterpret_cast< naked_pointer >( m_commQueue.enqueueMapBuffer( m_devMemory,
+                    true, CL_MAP_READ, index * sizeof( value_type ), sizeof( value_type ), NULL, NULL, &l_Error ) );
+                V_OPENCL( l_Error, "device_vector failed map device memory to host memory for operator[]" );
+
+                value_type valTmp = *result;
+
+                ::cl::Event unmapEvent;
+                V_OPENCL( m_commQueue.enqueueUnmapMemObject( m_devMemory, result, NULL, &unmapEvent ), "device_vector failed to unmap host memory back to device memory" );
+                V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+
+                return valTmp;
+            }
+
+            void writeElement( size_type index, const value_type& value ) const
+            {
+                if( m_Mirror.enabled )
+                {
+                    loadHostMirror( );
+                    m_Mirror.values[ index ] = value;
+                    markHostMirrorDirty( index, index + 1 );
+                    return;
+                }
+
+                cl_int l_Error = CL_SUCCESS;
+                naked_pointer result = reinterpret_cast< naked_pointer >( m_commQueue.enqueueMapBuffer( m_devMemory,
+                    true, CL_MAP_WRITE_INVALIDATE_REGION, index * sizeof( value_type ), sizeof( value_type ), NULL, NULL,
+                    &l_Error ) );
+                V_OPENCL( l_Error, "device_vector failed map device memory to host memory for operator[]" );
+
+                *result = value;
+
+                ::cl::Event unmapEvent;
+                V_OPENCL( m_commQueue.enqueueUnmapMemObject( m_devMemory, result, NULL, &unmapEvent ), "device_vector failed to unmap host memory back to device memory" );
+                V_OPENCL( unmapEvent.wait( ), "failed to wait for unmap event" );
+            }
+
+            void loadHostMirror( ) const
+            {
+                if( m_Mirror.valid )
+                    return;
+
+                m_Mirror.values.resize( m_Size );
+                m_Mirror.dirty.clear( );
+                if( m_Size != 0 )
+                    V_OPENCL( m_commQueue.enqueueReadBuffer( m_devMemory, CL_TRUE, 0, m_Size * sizeof( value_type ),
+                        &m_Mirror.values.front( ) ), "device_vector failed to read its host mirror" );
+                m_Mirror.valid = true;
+            }
+
+            void markHostMirrorDirty( size_type first, size_type last ) const
+            {
+                std::vector< std::pair< size_type, size_type > >& dirty = m_Mirror.dirty;
+
+                //  Writes that touch or extend the latest range, such as a sequential sweep, grow it in place
+                if( !dirty.empty( ) && first <= dirty.back( ).second && last >= dirty.back( ).first )
+                {
+                    dirty.back( ).first = std::min( dirty.back( ).first, first );
+                    dirty.back( ).second = std::max( dirty.back( ).second, last );
+                    return;
+                }
+
+                dirty.push_back( std::make_pair( first, last ) );
+                if( dirty.size( ) > maxDirtyRanges )
+                {
+                    std::pair< size_type, size_type > span = dirty.front( );
+                    for( size_t r = 1; r < dirty.size( ); ++r )
+                    {
+                        span.first = std::min( span.first, dirty[ r ].first );
+                        span.second = std::max( span.second, dirty[ r ].second );
+                    }
+                    dirty.assign( 1, span );
+                }
+            }
+
+            void writeBackHostMirror( ) const
+            {
+                std::vector< std::pair< size_type, size_type > >& dirty = m_Mirror.dirty;
+                if( dirty.empty( ) )
+                    return;
+
+                //  Ranges may reach past elements removed by pop_back( ) since they were written
+                std::vector< ::cl::Event > writeEvents;
+                for( size_t r = 0; r < dirty.size( ); ++r )
+                {
+                    size_type first = dirty[ r ].first;
+                    size_type last = std::min( dirty[ r ].second, m_Mirror.values.size( ) );
+                    if( first >= last )
+                        continue;
+
+                    writeEvents.push_back( ::cl::Event( ) );
+                    V_OPENCL( m_commQueue.enqueueWriteBuffer( m_devMemory, CL_FALSE, first * sizeof( value_type ),
+                        ( last - first ) * sizeof( value_type ), &m_Mirror.values[ first ], NULL, &writeEvents.back( ) ),
+                        "device_vector failed to write back its host mirror" );
+                }
+                dirty.clear( );
+
+                if( !writeEvents.empty( ) )
+                    V_OPENCL( ::cl::WaitForEvents( writeEvents ), "device_vector failed to wait for its host mirror" );
+            }
+
+            //  Called before the buffer is used other than through the mirror, which may change it
+            void releaseHostMirror( ) const
+            {
+                if( !m_Mirror.valid )
+                    return;
+
+                writeBackHostMirror( );
+                m_Mirror.valid = false;
+            }
+
+            //  Called when every element is about to be overwritten
+            void discardHostMirror( ) const
+            {
+                m_Mirror.dirty.clear( );
+                m_Mirror.valid = false;
+            }
+
+            /*  Grows the capacity for push_back( ) and insert( ) to at least reqSize, and at least twice the size, so
+            *   that a run of them reallocates a logarithmic number of times.  The new buffer is leased from the buffer
+            *   pool of control::getDefault( ) when it shares the context of the vector, so that the buffer given up by
+            *   one vector is reused by the next instead of clCreateBuffer being called for every reallocation.  The
+            *   pool rounds the lease up to its size class, which capacity( ) reports.
+            */
+            void growCapacity( size_type reqSize )
+            {
+                if( reqSize <= capacity( ) )
+                    return;
+
+                reqSize = std::max( reqSize, 2 * m_Size );
+
+                const cl_mem_flags hostFlags = CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR;
+                control& l_Pool = control::getDefault( );
+
+                cl_int l_Error = CL_SUCCESS;
+                ::cl::Context l_Context = m_commQueue.getInfo< CL_QUEUE_CONTEXT >( &l_Error );
+                V_OPENCL( l_Error, "device_vector failed to query for the context of the ::cl::CommandQueue object" );
+                ::cl::Context l_PoolContext = l_Pool.getCommandQueue( ).getInfo< CL_QUEUE_CONTEXT >( &l_Error );
+                V_OPENCL( l_Error, "device_vector failed to query for the context of the default ::cl::CommandQueue" );
+
+                if( ( m_Flags & hostFlags ) != 0 || l_Context( ) != l_PoolContext( ) )
+                {
+                    reserve( reqSize );
+                    return;
+                }
+
+                if( reqSize > max_size( ) )
+                    throw ::cl::Error( CL_MEM_OBJECT_ALLOCATION_FAILURE , "The amount of memory requested exceeds what is available" );
+
+                //  The elements are copied below, so a valid host mirror stays valid
+                writeBackHostMirror( );
+
+                control::buffPointer l_Lease = l_Pool.acquireBuffer( reqSize * sizeof( value_type ), m_Flags );
+                if( m_Size != 0 )
+                {
+                    ::cl::Event copyEvent;
+                    V_OPENCL( m_commQueue.enqueueCopyBuffer( m_devMemory, *l_Lease, 0, 0, m_Size * sizeof( value_type ),
+                        NULL, &copyEvent ), "device_vector failed to copy from buffer to buffer " );
+                    V_OPENCL( copyEvent.wait( ), "device_vector failed to wait on an event object" );
+                }
+
+                //  The previous lease, if any, goes back to the pool
+                m_devMemory = *l_Lease;
+                m_poolBuffer = l_Lease;
+            }
+
+            //  Sets the elements [first, last), which must lie within the capacity, to val
+            void fillElements( size_type first, size_type last, const value_type& val )
+            {
+                cl_int l_Error = CL_SUCCESS;
+                ::cl::Event fillEvent;
+
+                size_t sizeDS = sizeof( value_type );
+                if( !( sizeDS & ( sizeDS - 1 ) ) )  // 2^n data types
+                {
+                    l_Error = m_commQueue.enqueueFillBuffer< value_type >( m_devMemory, val, first * sizeof( value_type ),
+                        ( last - first ) * sizeof( value_type ), NULL, &fillEvent );
+                    V_OPENCL( l_Error, "device_vector failed to fill the new data with the provided pattern" );
+                }
+                else // non 2^n data types
+                {
+                    naked_pointer host_buffer = reinterpret_cast< naked_pointer >( m_commQueue.enqueueMapBuffer(
+                        m_devMemory, true, CL_MAP_WRITE_INVALIDATE_REGION, first * sizeof( value_type ),
+                        ( last - first ) * sizeof( value_type ), NULL, NULL, &l_Error ) );
+                    V_OPENCL( l_Error, "Error calling map on device_vector buffer. Fill device_vector" );
+
+                    std::fill_n( host_buffer, last - first, val );
+
+                    l_Error = m_commQueue.enqueueUnmapMemObject( m_devMemory, host_buffer, NULL, &fillEvent );
+                    V_OPENCL( l_Error, "Error calling map on device_vector buffer. Fill device_vector" );
+                }
+
+                l_Error = fillEvent.wait( );
+                V_OPENCL( l_Error, "device_vector failed to wait for fill event" );
+            }
+
             ::cl::Buffer m_devMemory;
             ::cl::CommandQueue m_commQueue;
             size_type m_Size;
             cl_mem_flags m_Flags;
+            mutable hostMirror m_Mirror;
+            control::buffPointer m_poolBuffer;  // lease on m_devMemory when growCapacity took it from the buffer pool
         };
 
     //  This string represents the device side definition of the constant_iterator template
@@ -1734,8 +2140,8 @@ namespace cl
             public:
                 typedef int iterator_category;      // device code does not understand std:: tags  \n
                 typedef T value_type; \n
-                typedef int difference_type; \n
-                typedef int size_type; \n
+                typedef long difference_type; \n
+                typedef BOLT_INDEX_T size_type; \n
                 typedef T* pointer; \n
                 typedef T& reference; \n
 
@@ -1747,7 +2153,13 @@ namespace cl
                     m_Ptr = ptr; \n
                 }; \n
 
-                global value_type& operator[]( size_type threadID ) const \n
+                int initLeaves( global void** leaves, int leaf ) \n
+                { \n
+                    m_Ptr = (global value_type*)leaves[ leaf ]; \n
+                    return leaf + 1; \n
+                }; \n
+
+                global value_type& operator[]( difference_type threadID ) const \n
                 { \n
                     return m_Ptr[ m_StartIndex + threadID ]; \n
                 } \n
@@ -1757,7 +2169,7 @@ namespace cl
                     return m_Ptr[ m_StartIndex + threadID ]; \n
                 } \n
 
-                size_type m_StartIndex; \n
+                difference_type m_StartIndex; \n
                 global value_type* m_Ptr; \n
             }; \n
         }; \n
@@ -19,11 +19,11 @@ void fill_kernel(
     const T src,
     global Type * dst,
 	iIterType input_iter,
-    const uint numElements )
+    const BOLT_INDEX_T numElements )
 {
     input_iter.init(dst);
 
-    size_t gloId = get_global_id( 0 );
+    BOLT_INDEX_T gloId = get_global_id( 0 );
     if( gloId >= numElements ) return; // on SI this doesn't mess-up barriers
     
 	input_iter[ gloId ] = src;
@@ -34,10 +34,10 @@ void gatherIfTemplate (
             iIterType input,
             global oType* output_naked,
             oIterType output,
-            const uint length,
+            const BOLT_INDEX_T length,
             global Predicate* pred )
 {
-    int gid = get_global_id( 0 );
+    BOLT_INDEX_T gid = get_global_id( 0 );
     if ( gid >= length ) return;
 
     map.init( map_naked );
@@ -70,9 +70,9 @@ void gatherTemplate (
             iIterType input,
             global oType* output_naked,
             oIterType output,
-            const uint length )
+            const BOLT_INDEX_T length )
 {
-    int gid = get_global_id( 0 );
+    BOLT_INDEX_T gid = get_global_id( 0 );
     if ( gid >= length ) return;
 
     map.init( map_naked );
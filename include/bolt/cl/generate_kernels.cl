@@ -23,12 +23,12 @@ __kernel
 void generate_I(
     global oType * restrict dst,
 	 iIterType input_iter,
-    const int numElements,
+    const BOLT_INDEX_T numElements,
     global Generator * restrict genPtr)
 {
     input_iter.init(dst);
 
-    int gloIdx = get_global_id(0);
+    BOLT_INDEX_T gloIdx = get_global_id(0);
 #if BOUNDARY_CHECK
     if (gloIdx < numElements)
 #endif
@@ -42,13 +42,13 @@ template <typename oType, typename Generator>
 kernel
 void generate_II(
     global oType * restrict dst,
-    const int numElements,
+    const BOLT_INDEX_T numElements,
     global Generator * restrict genPtr)
 {
     __private Generator gen = *genPtr;
     __private const oType val = gen();
     for (
-        unsigned int i = get_global_id(0);
+        BOLT_INDEX_T i = get_global_id(0);
         i < numElements;
         i += get_global_size(0) )
     {
@@ -65,13 +65,13 @@ template <typename oType, typename Generator>
 kernel
 void generate_III(
     global oType * restrict dst,
-		const int numElements,
+		const BOLT_INDEX_T numElements,
 		global Generator * restrict genPtr)
 {
     __private Generator gen = *genPtr;
     __private const oType val = gen();
     for (
-        unsigned int i = get_global_id(0)*STRIDE;
+        BOLT_INDEX_T i = get_global_id(0)*STRIDE;
         i < numElements;
         i += get_global_size(0)*STRIDE )
     {
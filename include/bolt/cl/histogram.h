@@ -0,0 +1,162 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_HISTOGRAM_H )
+#define BOLT_CL_HISTOGRAM_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+
+#include <string>
+
+/*! \file bolt/cl/histogram.h
+    \brief Counts how many elements of a range fall into each of a number of bins.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup reductions
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-histogram
+        *   \ingroup reductions
+        *   \{
+        */
+
+       /*! \brief \p histogram splits [lower, upper) into \p num_bins bins of equal width and writes the number of
+         * elements of [first, last) that fall into each bin to the range beginning at \p bins_first.
+         *
+         * \details Bins are half open: an element x is counted in bin ( x - lower ) * num_bins / ( upper - lower ),
+         * computed exactly for integral types. Elements below \p lower, at or above \p upper and NaNs are not
+         * counted. On the device every work-group counts into its own histogram in local memory and adds it to the
+         * result with one atomic per non-empty bin, so the input is read once. When the bins do not fit in local
+         * memory the bin of every element is computed, sorted and the bin boundaries are found with
+         * \p upper_bound instead.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the input sequence.
+         * \param last The end of the input sequence.
+         * \param bins_first The beginning of the \p num_bins counts.
+         * \param num_bins The number of bins.
+         * \param lower The lower edge of the first bin.
+         * \param upper The upper edge of the last bin, excluded.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam InputIterator is a model of InputIterator whose value type is an arithmetic type
+         *  \tparam OutputIterator is a model of OutputIterator whose value type is an integral type
+         *  \return The end of the counts, \p bins_first + \p num_bins.
+         *
+         *  \details The following code snippet demonstrates how to use \p histogram
+         *
+         *  \code
+         *  #include <bolt/cl/histogram.h>
+         *
+         *  float input[8] = {0.5f, 1.5f, 1.75f, 2.0f, 3.5f, 3.9f, 4.0f, -1.0f};
+         *  int bins[4];
+         *  bolt::cl::histogram( input, input + 8, bins, 4, 0.0f, 4.0f );
+         *
+         *  // bins are now {1, 2, 1, 2}; 4.0f and -1.0f lie outside [0, 4)
+         *  \endcode
+         *
+         *  \sa bincount
+         */
+
+        template< typename InputIterator,
+                  typename OutputIterator >
+        OutputIterator histogram( bolt::cl::control &ctl,
+                                  InputIterator first,
+                                  InputIterator last,
+                                  OutputIterator bins_first,
+                                  size_t num_bins,
+                                  typename std::iterator_traits< InputIterator >::value_type lower,
+                                  typename std::iterator_traits< InputIterator >::value_type upper,
+                                  const std::string& cl_code="" );
+
+        template< typename InputIterator,
+                  typename OutputIterator >
+        OutputIterator histogram( InputIterator first,
+                                  InputIterator last,
+                                  OutputIterator bins_first,
+                                  size_t num_bins,
+                                  typename std::iterator_traits< InputIterator >::value_type lower,
+                                  typename std::iterator_traits< InputIterator >::value_type upper,
+                                  const std::string& cl_code="" );
+
+       /*! \brief \p bincount writes the number of occurrences of each of the integers 0 ... \p num_bins - 1 in
+         * [first, last) to the range beginning at \p bins_first.
+         *
+         * \details Negative elements and elements of \p num_bins or more are not counted. Runs on the same
+         * kernels as \p histogram.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the input sequence.
+         * \param last The end of the input sequence.
+         * \param bins_first The beginning of the \p num_bins counts.
+         * \param num_bins The number of bins.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam InputIterator is a model of InputIterator whose value type is an integral type
+         *  \tparam OutputIterator is a model of OutputIterator whose value type is an integral type
+         *  \return The end of the counts, \p bins_first + \p num_bins.
+         *
+         *  \details The following code snippet demonstrates how to use \p bincount
+         *
+         *  \code
+         *  #include <bolt/cl/histogram.h>
+         *
+         *  int input[8] = {0, 1, 1, 3, 1, 0, 7, -2};
+         *  int bins[4];
+         *  bolt::cl::bincount( input, input + 8, bins, 4 );
+         *
+         *  // bins are now {2, 3, 0, 1}
+         *  \endcode
+         *
+         *  \sa histogram
+         */
+
+        template< typename InputIterator,
+                  typename OutputIterator >
+        OutputIterator bincount( bolt::cl::control &ctl,
+                                 InputIterator first,
+                                 InputIterator last,
+                                 OutputIterator bins_first,
+                                 size_t num_bins,
+                                 const std::string& cl_code="" );
+
+        template< typename InputIterator,
+                  typename OutputIterator >
+        OutputIterator bincount( InputIterator first,
+                                 InputIterator last,
+                                 OutputIterator bins_first,
+                                 size_t num_bins,
+                                 const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/histogram.inl>
+#endif
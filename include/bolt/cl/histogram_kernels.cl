@@ -0,0 +1,138 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Histogram and bincount.
+ *      histogramLocal    - every work-group counts its share of the input into a private
+ *                          histogram in local memory and adds the non-zero bins to the
+ *                          global counts with atomics
+ *      histogramBinIndex - writes the bin of every element; the host sorts these and
+ *                          finds the bin boundaries when the bins do not fit in local memory
+ *      histogramDiff     - turns the upper bounds of the sorted bins into counts
+ *  HISTOGRAM_MODE is set by the host: 0 splits [lower, upper) into numBins bins of equal width,
+ *  1 counts the integers 0 ... numBins - 1.  Elements outside the bins map to numBins and are
+ *  not counted.  HISTOGRAM_INTEGRAL selects exact integer arithmetic for the bin width.
+ *****************************************************************************/
+
+#ifndef HISTOGRAM_MODE
+#define HISTOGRAM_MODE          0
+#endif
+#ifndef HISTOGRAM_INTEGRAL
+#define HISTOGRAM_INTEGRAL      1
+#endif
+#define HISTOGRAM_WG_SIZE       256
+
+/*  Must compute what HistogramEvenBins and HistogramBincount compute on the host.  scale is
+ *  numBins / ( upper - lower ), precomputed by the host for floating point types.  */
+template< typename iType >
+inline uint histogramBin( iType x, iType lower, iType upper, iType scale, uint numBins )
+{
+#if HISTOGRAM_MODE == 1
+    return ( (ulong)x < (ulong)numBins ) ? (uint)x : numBins;
+#else
+    if( !( x >= lower ) || !( x < upper ) )
+        return numBins;
+#if HISTOGRAM_INTEGRAL
+    ulong d = (ulong)x - (ulong)lower;
+    ulong range = (ulong)upper - (ulong)lower;
+    ulong hi = mul_hi( d, (ulong)numBins );
+    ulong lo = d * numBins;
+    ulong bin = 0;
+    if( hi == 0 )
+        bin = lo / range;
+    else
+    {
+        //  d * numBins needs 128 bits, but the bin is below numBins; 32 steps of long division find it
+        ulong rem = ( hi << 32 ) | ( lo >> 32 );
+        for( int b = 31; b >= 0; --b )
+        {
+            ulong carry = rem >> 63;
+            rem = ( rem << 1 ) | ( ( lo >> b ) & 1 );
+            bin <<= 1;
+            if( carry || rem >= range )
+            {
+                rem -= range;
+                bin |= 1;
+            }
+        }
+    }
+#else
+    ulong bin = (ulong)( ( x - lower ) * scale );
+#endif
+    return (uint)min( bin, (ulong)( numBins - 1 ) );
+#endif
+}
+
+template< typename iType, typename iIterType >
+kernel void histogramLocal( global iType* input_ptr,
+                            iIterType input_iter,
+                            const uint numElements,
+                            const iType lower,
+                            const iType upper,
+                            const iType scale,
+                            const uint numBins,
+                            global uint* bins,
+                            local uint* localBins )
+{
+    input_iter.init( input_ptr );
+
+    uint lid = get_local_id( 0 );
+    for( uint b = lid; b < numBins; b += HISTOGRAM_WG_SIZE )
+        localBins[ b ] = 0;
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( uint i = get_global_id( 0 ); i < numElements; i += get_global_size( 0 ) )
+    {
+        iType x = input_iter[ i ];
+        uint bin = histogramBin( x, lower, upper, scale, numBins );
+        if( bin < numBins )
+            atomic_inc( &localBins[ bin ] );
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    //  Sparse inputs leave most bins of a work-group empty; those cost no global atomic
+    for( uint b = lid; b < numBins; b += HISTOGRAM_WG_SIZE )
+    {
+        uint count = localBins[ b ];
+        if( count != 0 )
+            atomic_add( &bins[ b ], count );
+    }
+}
+
+template< typename iType, typename iIterType >
+kernel void histogramBinIndex( global iType* input_ptr,
+                               iIterType input_iter,
+                               const uint numElements,
+                               const iType lower,
+                               const iType upper,
+                               const iType scale,
+                               const uint numBins,
+                               global uint* binIndex )
+{
+    input_iter.init( input_ptr );
+
+    for( uint i = get_global_id( 0 ); i < numElements; i += get_global_size( 0 ) )
+        binIndex[ i ] = histogramBin( input_iter[ i ], lower, upper, scale, numBins );
+}
+
+/*  upperBounds[ b ] is the number of sorted bin indices that are <= b  */
+kernel __attribute__((reqd_work_group_size(HISTOGRAM_WG_SIZE,1,1)))
+void histogramDiffInstantiated( global const uint* upperBounds, const uint numBins, global uint* bins )
+{
+    for( uint b = get_global_id( 0 ); b < numBins; b += get_global_size( 0 ) )
+        bins[ b ] = upperBounds[ b ] - ( ( b == 0 ) ? 0 : upperBounds[ b - 1 ] );
+}
@@ -0,0 +1,138 @@
+/***************************************************************************                                                                                     
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.                                     
+*                                                                                    
+*   Licensed under the Apache License, Version 2.0 (the "License");   
+*   you may not use this file except in compliance with the License.                 
+*   You may obtain a copy of the License at                                          
+*                                                                                    
+*       http://www.apache.org/licenses/LICENSE-2.0                      
+*                                                                                    
+*   Unless required by applicable law or agreed to in writing, software              
+*   distributed under the License is distributed on an "AS IS" BASIS,              
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.         
+*   See the License for the specific language governing permissions and              
+*   limitations under the License.                                                   
+
+***************************************************************************/                                                                                     
+//  REDUCE_WG_SIZE, the work-items of a work-group, is 64, 128 or 256 as set by the host from the tuning database
+#ifndef REDUCE_WG_SIZE
+#define REDUCE_WG_SIZE 256
+#endif
+
+#define _REDUCE_STEP(_LENGTH, _IDX, _W) \
+    if ((_IDX < _W) && ((_IDX + _W) < _LENGTH)) {\
+      oNakedType mine = scratch[_IDX];\
+      oNakedType other = scratch[_IDX + _W];\
+      scratch[_IDX] = (*reduceFunctor)(mine, other); \
+    }\
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+//  The product of each pair of elements is folded into a private accumulator as soon as it is formed, so the
+//  products never reach global memory; each workgroup writes one partial result
+template< typename iNakedType1, typename iIterType1, typename iNakedType2, typename iIterType2,
+    typename oNakedType, typename binary_function1, typename binary_function2 >
+kernel void innerProductTemplate(
+    global iNakedType1* input_ptr1,
+    iIterType1 input_iter1,
+    global iNakedType2* input_ptr2,
+    iIterType2 input_iter2,
+    const BOLT_INDEX_T length,
+    global binary_function2* productFunctor,
+    global binary_function1* reduceFunctor,
+    global oNakedType* result_ptr,
+    local oNakedType* scratch
+)
+{
+    BOLT_INDEX_T gx = get_global_id( 0 );
+
+    input_iter1.init( input_ptr1 );
+    input_iter2.init( input_ptr2 );
+
+    //  Work-items past the end of the input stay in the kernel for the barriers below; the tail keeps their
+    //  accumulator out of the reduction
+    oNakedType accumulator;
+    if( gx < length )
+    {
+        iNakedType1 a = input_iter1[ gx ];
+        iNakedType2 b = input_iter2[ gx ];
+        accumulator = (*productFunctor)( a, b );
+        gx += get_global_size( 0 );
+    }
+
+    while( gx < length )
+    {
+        iNakedType1 a = input_iter1[ gx ];
+        iNakedType2 b = input_iter2[ gx ];
+        oNakedType product = (*productFunctor)( a, b );
+
+        accumulator = (*reduceFunctor)( accumulator, product );
+        gx += get_global_size( 0 );
+    }
+
+    int local_index = get_local_id( 0 );
+    scratch[ local_index ] = accumulator;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    //  Tail stops the last workgroup from reading past the end of the input vector
+    BOLT_INDEX_T tail = length - (get_group_id(0) * get_local_size(0));
+
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP( tail, local_index, 128 );
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP( tail, local_index, 64 );
+#endif
+    _REDUCE_STEP( tail, local_index, 32 );
+    _REDUCE_STEP( tail, local_index, 16 );
+    _REDUCE_STEP( tail, local_index,  8 );
+    _REDUCE_STEP( tail, local_index,  4 );
+    _REDUCE_STEP( tail, local_index,  2 );
+    _REDUCE_STEP( tail, local_index,  1 );
+
+    if( local_index == 0 )
+    {
+        result_ptr[ get_group_id( 0 ) ] = scratch[ 0 ];
+    }
+};
+
+//  Second pass: a single workgroup combines the partials with init and leaves the result in partials[0]
+template< typename oNakedType, typename binary_function1 >
+kernel void innerProductFinalTemplate(
+    global oNakedType* partials,
+    const int numPartials,
+    const oNakedType init,
+    global binary_function1* reduceFunctor,
+    local oNakedType* scratch
+)
+{
+    int local_index = get_local_id( 0 );
+
+    //  Every partial is read into registers before the first barrier, so partials[0] can be overwritten at the end
+    oNakedType accumulator;
+    if( local_index < numPartials )
+    {
+        accumulator = partials[ local_index ];
+        for( int i = local_index + get_local_size( 0 ); i < numPartials; i += get_local_size( 0 ) )
+            accumulator = (*reduceFunctor)( accumulator, partials[ i ] );
+    }
+    scratch[ local_index ] = accumulator;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP( numPartials, local_index, 128 );
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP( numPartials, local_index, 64 );
+#endif
+    _REDUCE_STEP( numPartials, local_index, 32 );
+    _REDUCE_STEP( numPartials, local_index, 16 );
+    _REDUCE_STEP( numPartials, local_index,  8 );
+    _REDUCE_STEP( numPartials, local_index,  4 );
+    _REDUCE_STEP( numPartials, local_index,  2 );
+    _REDUCE_STEP( numPartials, local_index,  1 );
+
+    if( local_index == 0 )
+    {
+        partials[ 0 ] = (*reduceFunctor)( init, scratch[ 0 ] );
+    }
+};
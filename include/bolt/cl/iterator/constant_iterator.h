@@ -20,6 +20,7 @@
 #include "bolt/cl/bolt.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 #include <boost/iterator/iterator_facade.hpp>
+#include <cstddef>
 
 /*! \file bolt/cl/iterator/constant_iterator.h
     \brief Return Same Value or Constant Value on dereferencing.
@@ -38,11 +39,11 @@ namespace cl {
     //BOLT_TEMPLATE_FUNCTOR3( constant_iterator, int, float, double,
         template< typename value_type >
         class constant_iterator: public boost::iterator_facade< constant_iterator< value_type >, value_type, 
-            constant_iterator_tag, value_type, int >
+            constant_iterator_tag, value_type, std::ptrdiff_t >
         {
         public:
              typedef typename boost::iterator_facade< constant_iterator< value_type >, value_type, 
-            constant_iterator_tag, value_type, int >::difference_type difference_type;
+            constant_iterator_tag, value_type, std::ptrdiff_t >::difference_type difference_type;
            
 
             struct Payload
@@ -158,7 +159,7 @@ namespace cl {
             }
 
             typename boost::iterator_facade< constant_iterator< value_type >, value_type, 
-            constant_iterator_tag, value_type, int >::reference dereference( ) const
+            constant_iterator_tag, value_type, std::ptrdiff_t >::reference dereference( ) const
             {
                 return m_constValue;
             }
@@ -177,8 +178,8 @@ namespace cl {
         public: \n
             typedef int iterator_category;      // device code does not understand std:: tags \n
             typedef T value_type; \n
-            typedef size_t difference_type; \n
-            typedef size_t size_type; \n
+            typedef long difference_type; \n
+            typedef BOLT_INDEX_T size_type; \n
             typedef T* pointer; \n
             typedef T& reference; \n
 
@@ -188,7 +189,12 @@ namespace cl {
             void init( global value_type* ptr ) \n
             { }; \n
 
-            value_type operator[]( size_type threadID ) const \n
+            int initLeaves( global void** leaves, int leaf ) \n
+            { \n
+                return leaf; \n
+            }; \n
+
+            value_type operator[]( difference_type threadID ) const \n
             { \n
                 return m_constValue; \n
             } \n
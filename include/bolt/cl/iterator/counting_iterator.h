@@ -20,6 +20,7 @@
 #include "bolt/cl/bolt.h"
 #include "bolt/cl/iterator/iterator_traits.h"
 #include <boost/iterator/iterator_facade.hpp>
+#include <cstddef>
 
 /*! \file bolt/cl/iterator/counting_iterator.h
     \brief Return Incremented Value on dereferencing.
@@ -37,12 +38,12 @@ namespace cl {
     //BOLT_TEMPLATE_FUNCTOR3( counting_iterator, int, float, double,
         template< typename value_type >
         class counting_iterator: public boost::iterator_facade< counting_iterator< value_type >, value_type, 
-            counting_iterator_tag, value_type, int >
+            counting_iterator_tag, value_type, std::ptrdiff_t >
         {
         public:
 
 	    typedef typename boost::iterator_facade< counting_iterator< value_type >, value_type, 
-            counting_iterator_tag, value_type, int >::difference_type  difference_type;
+            counting_iterator_tag, value_type, std::ptrdiff_t >::difference_type  difference_type;
 
             struct Payload
             {
@@ -159,9 +160,9 @@ namespace cl {
             }
 
             typename boost::iterator_facade< counting_iterator< value_type >, value_type, 
-            counting_iterator_tag, value_type, int >::reference  dereference( ) const
+            counting_iterator_tag, value_type, std::ptrdiff_t >::reference  dereference( ) const
             {
-                return m_initValue + m_Index;
+                return m_initValue + static_cast< value_type >( m_Index );
             }
 
             ::cl::Buffer m_devMemory;
@@ -179,8 +180,8 @@ namespace cl {
         public: \n
             typedef int iterator_category;      // device code does not understand std:: tags \n
             typedef T value_type; \n
-            typedef size_t difference_type; \n
-            typedef size_t size_type; \n
+            typedef long difference_type; \n
+            typedef BOLT_INDEX_T size_type; \n
             typedef T* pointer; \n
             typedef T& reference; \n
 
@@ -193,7 +194,12 @@ namespace cl {
                 //m_Ptr = ptr; \n
             }; \n
 
-            value_type operator[]( size_type threadID ) const \n
+            int initLeaves( global void** leaves, int leaf ) \n
+            { \n
+                return leaf; \n
+            }; \n
+
+            value_type operator[]( difference_type threadID ) const \n
             { \n
                 return m_StartIndex + threadID; \n
             } \n
@@ -0,0 +1,176 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_CL_ITERATOR_STORAGE_H )
+#define BOLT_CL_ITERATOR_STORAGE_H
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/iterator/iterator_traits.h"
+#include "bolt/cl/iterator/constant_iterator.h"
+#include "bolt/cl/iterator/counting_iterator.h"
+#include <vector>
+
+/*! \file bolt/cl/iterator/iterator_storage.h
+    \brief Finds the device buffers behind an iterator adaptor and binds them to kernels.
+*/
+
+namespace bolt {
+namespace cl {
+namespace detail {
+
+    /*  The buffers behind an iterator are its leaves: the device_vector iterators it is built from, in the order
+     *  the device iterator binds them with initLeaves, the first member of an adaptor first.  A buffer read through
+     *  two leaves is listed twice.  Iterators that compute their elements (counting_iterator, constant_iterator)
+     *  have none.  */
+    inline size_t distinctBuffers( const std::vector< ::cl::Buffer >& buffers )
+    {
+        size_t distinct = 0;
+        for( size_t i = 0; i < buffers.size( ); ++i )
+        {
+            size_t j = 0;
+            while( j < i && buffers[ j ]( ) != buffers[ i ]( ) )
+                ++j;
+            if( j == i )
+                ++distinct;
+        }
+        return distinct;
+    }
+
+    //  Host iterators are wrapped by the algorithms themselves
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers,
+                                std::random_access_iterator_tag )
+    {
+    }
+
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers,
+                                bolt::cl::device_vector_tag )
+    {
+        buffers.push_back( iter.getContainer( ).getBuffer( ) );
+    }
+
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers,
+                                bolt::cl::counting_iterator_tag )
+    {
+    }
+
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers,
+                                bolt::cl::constant_iterator_tag )
+    {
+    }
+
+    //  Iterator adaptors report the buffers of the iterators they are built from
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers,
+                                bolt::cl::fancy_iterator_tag )
+    {
+        iter.appendBuffers( buffers );
+    }
+
+    template< typename Iterator >
+    void appendIteratorBuffers( const Iterator& iter, std::vector< ::cl::Buffer >& buffers )
+    {
+        appendIteratorBuffers( iter, buffers, typename std::iterator_traits< Iterator >::iterator_category( ) );
+    }
+
+    /*! \brief The most leaves a kernel that binds them reads through one iterator argument: its pointer argument
+     *  and the three of BOLT_LEAF_PARAMS.
+     */
+    const size_t maxIteratorLeaves = 4;
+
+    /*! \brief The run mode of a call that reads \p iter, on the path \p runMode that selectRunMode chose.
+     *  \details \p leafKernels tells whether the kernels of the algorithm bind the leaves of \p iter with
+     *  setIteratorLeaves, which reads up to maxIteratorLeaves buffers; the other kernels take a single buffer per
+     *  iterator.  An OpenCL call whose iterator needs more runs on the host when the run mode of \p ctl is
+     *  Automatic, and throws ::cl::Error when OpenCL is forced, as selectRunMode does for calls too long for the
+     *  kernels.
+     */
+    template< typename Iterator >
+    control::e_RunMode iteratorRunMode( const control& ctl, control::e_RunMode runMode, const Iterator& iter,
+                                        bool leafKernels = false )
+    {
+        if( runMode != control::OpenCL )
+            return runMode;
+
+        std::vector< ::cl::Buffer > buffers;
+        appendIteratorBuffers( iter, buffers );
+        if( leafKernels ? buffers.size( ) <= maxIteratorLeaves : distinctBuffers( buffers ) <= 1 )
+            return runMode;
+
+        if( ctl.getForceRunMode( ) == control::OpenCL )
+            throw ::cl::Error( CL_INVALID_MEM_OBJECT,
+                "The OpenCL kernels of this algorithm cannot read an iterator adaptor over this many device buffers" );
+#if defined( ENABLE_TBB )
+        return control::MultiCoreCpu;
+#else
+        return control::SerialCpu;
+#endif
+    }
+
+    /*! \brief Returns the buffer that is passed to a kernel that takes a single buffer for an iterator adaptor.
+     *  \details iteratorRunMode keeps adaptors over more than one buffer away from such kernels; should one get
+     *  here, it throws rather than run the kernel on the wrong buffer.  Without any buffer the placeholder buffer
+     *  of fallback is returned.
+     */
+    template< typename Iterator >
+    ::cl::Buffer selectIteratorBuffer( const std::vector< ::cl::Buffer >& buffers, const Iterator& fallback )
+    {
+        if( distinctBuffers( buffers ) > 1 )
+            throw ::cl::Error( CL_INVALID_MEM_OBJECT,
+                "An iterator adaptor over more than one device buffer needs a kernel that binds its leaves" );
+
+        if( !buffers.empty( ) )
+            return buffers[ 0 ];
+
+        return fallback.getContainer( ).getBuffer( );
+    }
+
+    /*! \brief Binds the leaves of \p iter to \p kernel: the first to the pointer argument \p ptrArg, the others
+     *  to the BOLT_LEAF_PARAMS from argument \p leafArg on.
+     *  \details The kernel hands the pointer argument and its leaf parameters to the initLeaves method of the
+     *  device iterator, which takes them in the order of appendIteratorBuffers.  Leaf parameters \p iter does not
+     *  need get the first buffer again, so the arguments are always set.
+     */
+    template< typename Iterator >
+    cl_int setIteratorLeaves( ::cl::Kernel& kernel, cl_uint ptrArg, cl_uint leafArg, const Iterator& iter )
+    {
+        std::vector< ::cl::Buffer > leaves;
+        appendIteratorBuffers( iter, leaves );
+        if( leaves.size( ) > maxIteratorLeaves )
+            throw ::cl::Error( CL_INVALID_MEM_OBJECT,
+                "An iterator adaptor over more device buffers than a kernel binds must be read on the host" );
+
+        if( leaves.empty( ) )
+            leaves.push_back( iter.getContainer( ).getBuffer( ) );
+
+        cl_int l_Error = kernel.setArg( ptrArg, leaves[ 0 ] );
+        for( size_t i = 1; i < maxIteratorLeaves && l_Error == CL_SUCCESS; ++i )
+        {
+            const ::cl::Buffer& leaf = ( i < leaves.size( ) ) ? leaves[ i ] : leaves[ 0 ];
+            l_Error = kernel.setArg( leafArg + static_cast< cl_uint >( i - 1 ), leaf );
+        }
+        return l_Error;
+    }
+
+}
+}
+}
+
+#endif
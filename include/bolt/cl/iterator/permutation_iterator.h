@@ -0,0 +1,238 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_CL_PERMUTATION_ITERATOR_H )
+#define BOLT_CL_PERMUTATION_ITERATOR_H
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_traits.h"
+#include "bolt/cl/iterator/iterator_storage.h"
+#include <boost/iterator/iterator_facade.hpp>
+#include <cstddef>
+
+/*! \file bolt/cl/iterator/permutation_iterator.h
+    \brief Return the element selected by an index iterator on dereferencing.
+*/
+
+namespace bolt {
+namespace cl {
+
+    struct permutation_iterator_tag
+        : public fancy_iterator_tag
+        {   // identifying tag for random-access iterators
+        };
+
+    /*! \brief A permutation_iterator reads elements[ indices[ i ] ], a gather that is fused into the reading
+     *  algorithm instead of being written out.
+     *  \details Advancing the iterator advances the index iterator only.  Both iterators must be device_vector
+     *  iterators or other Bolt fancy iterators.  The kernels of reduce, count, min_element and max_element bind the
+     *  element buffer and a device_vector of indices to arguments of their own.  The kernels of the other
+     *  algorithms take a single buffer per iterator, so they read a permutation_iterator only when at most one
+     *  device buffer backs the two of them, as with indices computed by a counting_iterator or a
+     *  transform_iterator over one; see detail::iteratorRunMode for calls over more.
+     *  \tparam ElementIterator The elements that are read.
+     *  \tparam IndexIterator The positions in \p ElementIterator to read.
+     */
+    template< typename ElementIterator, typename IndexIterator >
+    class permutation_iterator: public boost::iterator_facade< permutation_iterator< ElementIterator, IndexIterator >,
+        typename std::iterator_traits< ElementIterator >::value_type, permutation_iterator_tag,
+        typename std::iterator_traits< ElementIterator >::value_type, std::ptrdiff_t >
+    {
+    public:
+        typedef typename std::iterator_traits< ElementIterator >::value_type value_type;
+        typedef typename boost::iterator_facade< permutation_iterator< ElementIterator, IndexIterator >, value_type,
+            permutation_iterator_tag, value_type, std::ptrdiff_t >::difference_type difference_type;
+
+        //  Laid out like the device class below; every member starts on an 8 byte boundary on both sides
+        struct Payload
+        {
+            ALIGNED( 8 ) typename ElementIterator::Payload m_Elements;
+            ALIGNED( 8 ) typename IndexIterator::Payload m_Indices;
+        };
+
+        permutation_iterator( const ElementIterator& elements, const IndexIterator& indices ):
+            m_Elements( elements ), m_Indices( indices )
+        {
+        }
+
+        permutation_iterator< ElementIterator, IndexIterator >& operator+= ( const difference_type & n )
+        {
+            advance( n );
+            return *this;
+        }
+
+        const permutation_iterator< ElementIterator, IndexIterator > operator+ ( const difference_type & n ) const
+        {
+            permutation_iterator< ElementIterator, IndexIterator > result( *this );
+            result.advance( n );
+            return result;
+        }
+
+        const ElementIterator& base( ) const
+        {
+            return m_Elements;
+        }
+
+        const IndexIterator& indices( ) const
+        {
+            return m_Indices;
+        }
+
+        ::cl::Buffer getBuffer( ) const
+        {
+            std::vector< ::cl::Buffer > buffers;
+            appendBuffers( buffers );
+            return detail::selectIteratorBuffer( buffers, m_Elements );
+        }
+
+        void appendBuffers( std::vector< ::cl::Buffer >& buffers ) const
+        {
+            detail::appendIteratorBuffers( m_Elements, buffers );
+            detail::appendIteratorBuffers( m_Indices, buffers );
+        }
+
+        const permutation_iterator< ElementIterator, IndexIterator >& getContainer( ) const
+        {
+            return *this;
+        }
+
+        Payload gpuPayload( ) const
+        {
+            Payload payload = { m_Elements.gpuPayload( ), m_Indices.gpuPayload( ) };
+            return payload;
+        }
+
+        const difference_type gpuPayloadSize( ) const
+        {
+            return sizeof( Payload );
+        }
+
+        difference_type distance_to( const permutation_iterator< ElementIterator, IndexIterator >& rhs ) const
+        {
+            return static_cast< difference_type >( rhs.m_Indices - m_Indices );
+        }
+
+    private:
+        //  Implementation detail of boost.iterator
+        friend class boost::iterator_core_access;
+
+        void advance( difference_type n )
+        {
+            m_Indices += n;
+        }
+
+        void increment( )
+        {
+            advance( 1 );
+        }
+
+        void decrement( )
+        {
+            advance( -1 );
+        }
+
+        bool equal( const permutation_iterator< ElementIterator, IndexIterator >& rhs ) const
+        {
+            return m_Indices == rhs.m_Indices;
+        }
+
+        value_type dereference( ) const
+        {
+            typedef typename std::iterator_traits< IndexIterator >::value_type indexType;
+            indexType index = *m_Indices;
+            return *( m_Elements + static_cast< difference_type >( index ) );
+        }
+
+        ElementIterator m_Elements;
+        IndexIterator m_Indices;
+    };
+
+    //  This string represents the device side definition of the permutation_iterator template
+    static std::string devicePermutationIterator = STRINGIFY_CODE(
+
+        namespace bolt { namespace cl { \n
+        template< typename ElementIterator, typename IndexIterator > \n
+        class permutation_iterator \n
+        { \n
+        public: \n
+            typedef int iterator_category;      // device code does not understand std:: tags \n
+            typedef typename ElementIterator::value_type value_type; \n
+            typedef typename IndexIterator::value_type index_type; \n
+            typedef long difference_type; \n
+            typedef BOLT_INDEX_T size_type; \n
+            typedef value_type* pointer; \n
+            typedef value_type& reference; \n
+
+            void init( global value_type* ptr ) \n
+            { \n
+                m_Elements.init( ptr ); \n
+                m_Indices.init( (global index_type*)ptr ); \n
+            }; \n
+
+            int initLeaves( global void** leaves, int leaf ) \n
+            { \n
+                return m_Indices.initLeaves( leaves, m_Elements.initLeaves( leaves, leaf ) ); \n
+            }; \n
+
+            value_type operator[]( difference_type threadID ) const \n
+            { \n
+                return m_Elements[ m_Indices[ threadID ] ]; \n
+            } \n
+
+            ElementIterator m_Elements __attribute__((aligned(8))); \n
+            IndexIterator m_Indices __attribute__((aligned(8))); \n
+        }; \n
+    } } \n
+    );
+
+    template< typename ElementIterator, typename IndexIterator >
+    permutation_iterator< ElementIterator, IndexIterator > make_permutation_iterator( const ElementIterator& elements,
+                                                                                     const IndexIterator& indices )
+    {
+        permutation_iterator< ElementIterator, IndexIterator > tmp( elements, indices );
+        return tmp;
+    }
+
+}
+}
+
+//  The device names and definitions of a permutation_iterator follow from the types it is built from
+template< typename ElementIterator, typename IndexIterator >
+struct TypeName< bolt::cl::permutation_iterator< ElementIterator, IndexIterator > >
+{
+    static std::string get( )
+    {
+        return "bolt::cl::permutation_iterator< " + TypeName< ElementIterator >::get( ) + ", " +
+            TypeName< IndexIterator >::get( ) + " >";
+    }
+};
+
+template< typename ElementIterator, typename IndexIterator >
+struct ClCode< bolt::cl::permutation_iterator< ElementIterator, IndexIterator > >
+{
+    static std::string get( )
+    {
+        return ClCode< typename std::iterator_traits< ElementIterator >::value_type >::get( ) +
+            BOLT_CLCODE_PART_DELIMITER +
+            ClCode< typename std::iterator_traits< IndexIterator >::value_type >::get( ) +
+            BOLT_CLCODE_PART_DELIMITER +
+            ClCode< ElementIterator >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            ClCode< IndexIterator >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            bolt::cl::devicePermutationIterator;
+    }
+};
+
+#endif
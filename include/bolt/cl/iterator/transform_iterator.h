@@ -0,0 +1,234 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_CL_TRANSFORM_ITERATOR_H )
+#define BOLT_CL_TRANSFORM_ITERATOR_H
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/iterator/iterator_traits.h"
+#include "bolt/cl/iterator/iterator_storage.h"
+#include <boost/iterator/iterator_facade.hpp>
+#include <cstddef>
+#include <type_traits>
+
+/*! \file bolt/cl/iterator/transform_iterator.h
+    \brief Return the functor applied to the underlying element on dereferencing.
+*/
+
+namespace bolt {
+namespace cl {
+
+    struct transform_iterator_tag
+        : public fancy_iterator_tag
+        {   // identifying tag for random-access iterators
+        };
+
+    /*! \brief A transform_iterator applies a unary functor to the elements of another iterator as they are read.
+     *  \details Nothing is materialized: on the device the functor runs inside the kernel of the algorithm that
+     *  reads the iterator, so reduce( transform_iterator ) is a single kernel.  The underlying iterator must be a
+     *  device_vector iterator or another Bolt fancy iterator.  The functor needs the usual Bolt TypeName and
+     *  ClCode traits.
+     *  \tparam UnaryFunction Functor applied to every element read.
+     *  \tparam Iterator The underlying iterator.
+     *  \tparam Value The type the functor returns.
+     */
+    template< typename UnaryFunction, typename Iterator,
+              typename Value = typename std::result_of<
+                  UnaryFunction( typename std::iterator_traits< Iterator >::value_type ) >::type >
+    class transform_iterator: public boost::iterator_facade< transform_iterator< UnaryFunction, Iterator, Value >,
+        Value, transform_iterator_tag, Value, std::ptrdiff_t >
+    {
+    public:
+        typedef typename boost::iterator_facade< transform_iterator< UnaryFunction, Iterator, Value >, Value,
+            transform_iterator_tag, Value, std::ptrdiff_t >::difference_type difference_type;
+
+        //  Laid out like the device class below; every member starts on an 8 byte boundary on both sides
+        struct Payload
+        {
+            ALIGNED( 8 ) typename Iterator::Payload m_Base;
+            ALIGNED( 8 ) UnaryFunction m_Functor;
+        };
+
+        transform_iterator( const Iterator& base, const UnaryFunction& functor ):
+            m_Base( base ), m_Functor( functor )
+        {
+        }
+
+        transform_iterator< UnaryFunction, Iterator, Value >& operator+= ( const difference_type & n )
+        {
+            advance( n );
+            return *this;
+        }
+
+        const transform_iterator< UnaryFunction, Iterator, Value > operator+ ( const difference_type & n ) const
+        {
+            transform_iterator< UnaryFunction, Iterator, Value > result( *this );
+            result.advance( n );
+            return result;
+        }
+
+        const Iterator& base( ) const
+        {
+            return m_Base;
+        }
+
+        const UnaryFunction& functor( ) const
+        {
+            return m_Functor;
+        }
+
+        ::cl::Buffer getBuffer( ) const
+        {
+            std::vector< ::cl::Buffer > buffers;
+            appendBuffers( buffers );
+            return detail::selectIteratorBuffer( buffers, m_Base );
+        }
+
+        void appendBuffers( std::vector< ::cl::Buffer >& buffers ) const
+        {
+            detail::appendIteratorBuffers( m_Base, buffers );
+        }
+
+        const transform_iterator< UnaryFunction, Iterator, Value >& getContainer( ) const
+        {
+            return *this;
+        }
+
+        Payload gpuPayload( ) const
+        {
+            Payload payload = { m_Base.gpuPayload( ), m_Functor };
+            return payload;
+        }
+
+        const difference_type gpuPayloadSize( ) const
+        {
+            return sizeof( Payload );
+        }
+
+        difference_type distance_to( const transform_iterator< UnaryFunction, Iterator, Value >& rhs ) const
+        {
+            return static_cast< difference_type >( rhs.m_Base - m_Base );
+        }
+
+    private:
+        //  Implementation detail of boost.iterator
+        friend class boost::iterator_core_access;
+
+        void advance( difference_type n )
+        {
+            m_Base += n;
+        }
+
+        void increment( )
+        {
+            advance( 1 );
+        }
+
+        void decrement( )
+        {
+            advance( -1 );
+        }
+
+        bool equal( const transform_iterator< UnaryFunction, Iterator, Value >& rhs ) const
+        {
+            return m_Base == rhs.m_Base;
+        }
+
+        typename boost::iterator_facade< transform_iterator< UnaryFunction, Iterator, Value >, Value,
+            transform_iterator_tag, Value, std::ptrdiff_t >::reference dereference( ) const
+        {
+            UnaryFunction f( m_Functor );
+            return static_cast< Value >( f( *m_Base ) );
+        }
+
+        Iterator m_Base;
+        UnaryFunction m_Functor;
+    };
+
+    //  This string represents the device side definition of the transform_iterator template
+    static std::string deviceTransformIterator = STRINGIFY_CODE(
+
+        namespace bolt { namespace cl { \n
+        template< typename UnaryFunction, typename Iterator, typename Value > \n
+        class transform_iterator \n
+        { \n
+        public: \n
+            typedef int iterator_category;      // device code does not understand std:: tags \n
+            typedef Value value_type; \n
+            typedef long difference_type; \n
+            typedef BOLT_INDEX_T size_type; \n
+            typedef Value* pointer; \n
+            typedef Value& reference; \n
+            typedef typename Iterator::value_type base_type; \n
+
+            void init( global value_type* ptr ) \n
+            { \n
+                m_Base.init( (global base_type*)ptr ); \n
+            }; \n
+
+            int initLeaves( global void** leaves, int leaf ) \n
+            { \n
+                return m_Base.initLeaves( leaves, leaf ); \n
+            }; \n
+
+            value_type operator[]( difference_type threadID ) const \n
+            { \n
+                UnaryFunction f = m_Functor; \n
+                return f( m_Base[ threadID ] ); \n
+            } \n
+
+            Iterator m_Base __attribute__((aligned(8))); \n
+            UnaryFunction m_Functor __attribute__((aligned(8))); \n
+        }; \n
+    } } \n
+    );
+
+    template< typename UnaryFunction, typename Iterator >
+    transform_iterator< UnaryFunction, Iterator > make_transform_iterator( const Iterator& base,
+                                                                           const UnaryFunction& functor )
+    {
+        transform_iterator< UnaryFunction, Iterator > tmp( base, functor );
+        return tmp;
+    }
+
+}
+}
+
+//  The device names and definitions of a transform_iterator follow from the types it is built from
+template< typename UnaryFunction, typename Iterator, typename Value >
+struct TypeName< bolt::cl::transform_iterator< UnaryFunction, Iterator, Value > >
+{
+    static std::string get( )
+    {
+        return "bolt::cl::transform_iterator< " + TypeName< UnaryFunction >::get( ) + ", " +
+            TypeName< Iterator >::get( ) + ", " + TypeName< Value >::get( ) + " >";
+    }
+};
+
+template< typename UnaryFunction, typename Iterator, typename Value >
+struct ClCode< bolt::cl::transform_iterator< UnaryFunction, Iterator, Value > >
+{
+    static std::string get( )
+    {
+        return ClCode< typename std::iterator_traits< Iterator >::value_type >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            ClCode< Value >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            ClCode< UnaryFunction >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            ClCode< Iterator >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            bolt::cl::deviceTransformIterator;
+    }
+};
+
+#endif
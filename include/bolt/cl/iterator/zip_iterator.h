@@ -0,0 +1,239 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#pragma once
+#if !defined( BOLT_CL_ZIP_ITERATOR_H )
+#define BOLT_CL_ZIP_ITERATOR_H
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/pair.h"
+#include "bolt/cl/iterator/iterator_traits.h"
+#include "bolt/cl/iterator/iterator_storage.h"
+#include <boost/iterator/iterator_facade.hpp>
+#include <cstddef>
+
+/*! \file bolt/cl/iterator/zip_iterator.h
+    \brief Return a bolt::cl::pair of the elements of two iterators on dereferencing.
+*/
+
+namespace bolt {
+namespace cl {
+
+    struct zip_iterator_tag
+        : public fancy_iterator_tag
+        {   // identifying tag for random-access iterators
+        };
+
+    /*! \brief A zip_iterator walks two iterators in step and reads their elements as a bolt::cl::pair.
+     *  \details The underlying iterators must be device_vector iterators or other Bolt fancy iterators.  The
+     *  kernels of reduce, count, min_element and max_element bind each device buffer behind the zip_iterator to an
+     *  argument of its own, up to detail::maxIteratorLeaves of them.  The kernels of the other algorithms take a
+     *  single buffer per iterator, so they read a zip_iterator only when at most one device buffer backs the two
+     *  of them, as when zipping a counting_iterator or a second range of the same device_vector; see
+     *  detail::iteratorRunMode for calls over more.
+     *  \tparam Iterator1 Provides pair::first.
+     *  \tparam Iterator2 Provides pair::second.
+     */
+    template< typename Iterator1, typename Iterator2 >
+    class zip_iterator: public boost::iterator_facade< zip_iterator< Iterator1, Iterator2 >,
+        bolt::cl::pair< typename std::iterator_traits< Iterator1 >::value_type,
+                        typename std::iterator_traits< Iterator2 >::value_type >,
+        zip_iterator_tag,
+        bolt::cl::pair< typename std::iterator_traits< Iterator1 >::value_type,
+                        typename std::iterator_traits< Iterator2 >::value_type >, std::ptrdiff_t >
+    {
+    public:
+        typedef bolt::cl::pair< typename std::iterator_traits< Iterator1 >::value_type,
+                                typename std::iterator_traits< Iterator2 >::value_type > value_type;
+        typedef typename boost::iterator_facade< zip_iterator< Iterator1, Iterator2 >, value_type,
+            zip_iterator_tag, value_type, std::ptrdiff_t >::difference_type difference_type;
+
+        //  Laid out like the device class below; every member starts on an 8 byte boundary on both sides
+        struct Payload
+        {
+            ALIGNED( 8 ) typename Iterator1::Payload m_First;
+            ALIGNED( 8 ) typename Iterator2::Payload m_Second;
+        };
+
+        zip_iterator( const Iterator1& first, const Iterator2& second ): m_First( first ), m_Second( second )
+        {
+        }
+
+        zip_iterator< Iterator1, Iterator2 >& operator+= ( const difference_type & n )
+        {
+            advance( n );
+            return *this;
+        }
+
+        const zip_iterator< Iterator1, Iterator2 > operator+ ( const difference_type & n ) const
+        {
+            zip_iterator< Iterator1, Iterator2 > result( *this );
+            result.advance( n );
+            return result;
+        }
+
+        const Iterator1& first( ) const
+        {
+            return m_First;
+        }
+
+        const Iterator2& second( ) const
+        {
+            return m_Second;
+        }
+
+        ::cl::Buffer getBuffer( ) const
+        {
+            std::vector< ::cl::Buffer > buffers;
+            appendBuffers( buffers );
+            return detail::selectIteratorBuffer( buffers, m_First );
+        }
+
+        void appendBuffers( std::vector< ::cl::Buffer >& buffers ) const
+        {
+            detail::appendIteratorBuffers( m_First, buffers );
+            detail::appendIteratorBuffers( m_Second, buffers );
+        }
+
+        const zip_iterator< Iterator1, Iterator2 >& getContainer( ) const
+        {
+            return *this;
+        }
+
+        Payload gpuPayload( ) const
+        {
+            Payload payload = { m_First.gpuPayload( ), m_Second.gpuPayload( ) };
+            return payload;
+        }
+
+        const difference_type gpuPayloadSize( ) const
+        {
+            return sizeof( Payload );
+        }
+
+        difference_type distance_to( const zip_iterator< Iterator1, Iterator2 >& rhs ) const
+        {
+            return static_cast< difference_type >( rhs.m_First - m_First );
+        }
+
+    private:
+        //  Implementation detail of boost.iterator
+        friend class boost::iterator_core_access;
+
+        void advance( difference_type n )
+        {
+            m_First += n;
+            m_Second += n;
+        }
+
+        void increment( )
+        {
+            advance( 1 );
+        }
+
+        void decrement( )
+        {
+            advance( -1 );
+        }
+
+        bool equal( const zip_iterator< Iterator1, Iterator2 >& rhs ) const
+        {
+            return m_First == rhs.m_First;
+        }
+
+        value_type dereference( ) const
+        {
+            return value_type( *m_First, *m_Second );
+        }
+
+        Iterator1 m_First;
+        Iterator2 m_Second;
+    };
+
+    //  This string represents the device side definition of the zip_iterator template
+    static std::string deviceZipIterator = STRINGIFY_CODE(
+
+        namespace bolt { namespace cl { \n
+        template< typename Iterator1, typename Iterator2 > \n
+        class zip_iterator \n
+        { \n
+        public: \n
+            typedef int iterator_category;      // device code does not understand std:: tags \n
+            typedef bolt::cl::pair< typename Iterator1::value_type, typename Iterator2::value_type > value_type; \n
+            typedef long difference_type; \n
+            typedef BOLT_INDEX_T size_type; \n
+            typedef value_type* pointer; \n
+            typedef value_type& reference; \n
+
+            void init( global value_type* ptr ) \n
+            { \n
+                m_First.init( (global typename Iterator1::value_type*)ptr ); \n
+                m_Second.init( (global typename Iterator2::value_type*)ptr ); \n
+            }; \n
+
+            int initLeaves( global void** leaves, int leaf ) \n
+            { \n
+                return m_Second.initLeaves( leaves, m_First.initLeaves( leaves, leaf ) ); \n
+            }; \n
+
+            value_type operator[]( difference_type threadID ) const \n
+            { \n
+                value_type result; \n
+                result.first = m_First[ threadID ]; \n
+                result.second = m_Second[ threadID ]; \n
+                return result; \n
+            } \n
+
+            Iterator1 m_First __attribute__((aligned(8))); \n
+            Iterator2 m_Second __attribute__((aligned(8))); \n
+        }; \n
+    } } \n
+    );
+
+    template< typename Iterator1, typename Iterator2 >
+    zip_iterator< Iterator1, Iterator2 > make_zip_iterator( const Iterator1& first, const Iterator2& second )
+    {
+        zip_iterator< Iterator1, Iterator2 > tmp( first, second );
+        return tmp;
+    }
+
+}
+}
+
+//  The device names and definitions of a zip_iterator follow from the types it is built from
+template< typename Iterator1, typename Iterator2 >
+struct TypeName< bolt::cl::zip_iterator< Iterator1, Iterator2 > >
+{
+    static std::string get( )
+    {
+        return "bolt::cl::zip_iterator< " + TypeName< Iterator1 >::get( ) + ", " + TypeName< Iterator2 >::get( ) +
+            " >";
+    }
+};
+
+template< typename Iterator1, typename Iterator2 >
+struct ClCode< bolt::cl::zip_iterator< Iterator1, Iterator2 > >
+{
+    static std::string get( )
+    {
+        return ClCode< typename bolt::cl::zip_iterator< Iterator1, Iterator2 >::value_type >::get( ) +
+            BOLT_CLCODE_PART_DELIMITER +
+            ClCode< Iterator1 >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            ClCode< Iterator2 >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            bolt::cl::deviceZipIterator;
+    }
+};
+
+#endif
@@ -14,83 +14,175 @@
 *   limitations under the License.
 
 ***************************************************************************/
-
 //#pragma OPENCL EXTENSION cl_amd_printf : enable
 
-template< typename iTypePtr1,typename iTypeIter1,typename comp_function >
-int binary_search1( iTypePtr1 value, iTypeIter1  a,int start, int length,global comp_function *userFunctor)
+/******************************************************************************
+ *  Merge path: the output of merging A and B is cut into tiles of MERGE_TILE
+ *  elements.  The cross diagonal through the merge matrix at every tile boundary
+ *  is binary searched once in global memory ( mergePartitions ); each work-group
+ *  then loads the A and B ranges of its tile into local memory and every work item
+ *  merges MERGE_VT consecutive outputs sequentially, again after a merge path
+ *  search, this time in local memory ( mergePath ).  Ties are taken from A, so the
+ *  merge is stable.  stablesort_kernels.cl builds its merge passes on the same
+ *  helpers and is compiled together with this file.
+ *****************************************************************************/
+
+#ifndef MERGE_WG_SIZE
+#define MERGE_WG_SIZE   128
+#endif
+#ifndef MERGE_VT
+#define MERGE_VT        8
+#endif
+#define MERGE_TILE      ( MERGE_WG_SIZE * MERGE_VT )
+
+//  Returns how many elements of a the first diag elements of the stable merge of a and b take
+template< typename vType, typename aIterType, typename bIterType, typename comp_function >
+int mergePathGlobal( aIterType a, int aBegin, int aCount, bIterType b, int bBegin, int bCount, int diag,
+                     global comp_function *userFunctor )
 {
-	int low  = start;
-	int high = length;
-	while( low < high )
-	{
-		long mid = ( low + high ) / 2;
-        iTypePtr1 val1 = a[ mid ];
-		if ((*userFunctor)( val1,value ))
-		    low  = mid + 1;
-		else
-			high = mid;
-
-	}
-	return high;
+    int low  = max( 0, diag - bCount );
+    int high = min( diag, aCount );
+    while( low < high )
+    {
+        int mid = ( low + high ) >> 1;
+        vType aVal = a[ aBegin + mid ];
+        vType bVal = b[ bBegin + diag - 1 - mid ];
+        if( !(*userFunctor)( bVal, aVal ) )
+            low  = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
 }
 
-template< typename iTypePtr1,typename iTypeIter1,typename comp_function >
-int binary_search2( iTypePtr1 value, iTypeIter1  a,int start, int length,global comp_function *userFunctor)
+//  Same search with a in lds[ 0, aCount ) and b in lds[ aCount, aCount + bCount )
+template< typename vType, typename comp_function >
+int mergePathLocal( local vType* lds, int aCount, int bCount, int diag, global comp_function *userFunctor )
 {
-	int low  = start;
-	int high = length;
-	while( low < high )
-	{
-		long mid = ( low + high ) / 2;
-        iTypePtr1 val1 = a[ mid ];
-		if ((*userFunctor)( value,val1 ))
-              high = mid;
-		else
-		    low  = mid + 1;
-
-	}
-	return high;
+    int low  = max( 0, diag - bCount );
+    int high = min( diag, aCount );
+    while( low < high )
+    {
+        int mid = ( low + high ) >> 1;
+        vType aVal = lds[ mid ];
+        vType bVal = lds[ aCount + diag - 1 - mid ];
+        if( !(*userFunctor)( bVal, aVal ) )
+            low  = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
 }
 
+//  Merges count ( <= MERGE_VT ) elements of lds[ aBegin, aEnd ) and lds[ bBegin, bEnd ) into results
+template< typename vType, typename comp_function >
+void mergeSerial( local vType* lds, int aBegin, int aEnd, int bBegin, int bEnd, int count, vType* results,
+                  global comp_function *userFunctor )
+{
+    for( int i = 0; i < MERGE_VT; ++i )
+    {
+        if( i < count )
+        {
+            bool takeB = bBegin < bEnd;
+            if( takeB && aBegin < aEnd )
+            {
+                vType aVal = lds[ aBegin ];
+                vType bVal = lds[ bBegin ];
+                takeB = (*userFunctor)( bVal, aVal );
+            }
+            results[ i ] = takeB ? lds[ bBegin++ ] : lds[ aBegin++ ];
+        }
+    }
+}
+
+//  Merges a[ a0, a1 ) and b[ b0, b1 ) into r[ r0, ... ) through local memory; lds holds MERGE_TILE elements
+template< typename vType, typename aIterType, typename bIterType, typename rIterType, typename comp_function >
+void mergePathTile( aIterType a, int a0, int a1, bIterType b, int b0, int b1, rIterType r, int r0,
+                    local vType* lds, global comp_function *userFunctor )
+{
+    int lid    = get_local_id( 0 );
+    int aCount = a1 - a0;
+    int bCount = b1 - b0;
+    int count  = aCount + bCount;
+
+    for( int i = lid; i < aCount; i += MERGE_WG_SIZE )
+        lds[ i ] = a[ a0 + i ];
+    for( int i = lid; i < bCount; i += MERGE_WG_SIZE )
+        lds[ aCount + i ] = b[ b0 + i ];
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    int diag  = min( lid * MERGE_VT, count );
+    int split = mergePathLocal( lds, aCount, bCount, diag, userFunctor );
+
+    vType results[ MERGE_VT ];
+    mergeSerial( lds, split, aCount, aCount + diag - split, count, min( MERGE_VT, count - diag ), results,
+                 userFunctor );
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( int i = 0; i < MERGE_VT; ++i )
+    {
+        if( diag + i < count )
+            lds[ diag + i ] = results[ i ];
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( int i = lid; i < count; i += MERGE_WG_SIZE )
+        r[ r0 + i ] = lds[ i ];
+}
 
-template< typename iTypePtr1, typename iTypeIter1,typename iTypePtr2, typename iTypeIter2,
-    typename riTypeIter,typename oTypePtr, typename comp_function>
-__kernel void mergeTemplate(
+//  One work item per tile boundary, numTiles + 1 in total
+template< typename iTypePtr1, typename iTypeIter1, typename iTypePtr2, typename iTypeIter2, typename comp_function >
+__kernel void mergePartitionsTemplate(
     global iTypePtr1*    input_ptr1,
     iTypeIter1 input_iter1,
     const int length1,
     global iTypePtr2*    input_ptr2,
     iTypeIter2 input_iter2,
     const int length2,
-    global oTypePtr* result,
-    riTypeIter riter,
+    const int numTiles,
+    global int* partitions,
     global comp_function* userFunctor
 )
 {
-    int gx = get_global_id (0);
-    int pos1,pos2;
+    int gx = get_global_id( 0 );
+    if( gx > numTiles )
+        return;
 
     input_iter1.init( input_ptr1 );
     input_iter2.init( input_ptr2 );
-    riter.init(result);
 
+    int diag = min( gx * MERGE_TILE, length1 + length2 );
+    partitions[ gx ] = mergePathGlobal< iTypePtr1 >( input_iter1, 0, length1, input_iter2, 0, length2, diag,
+                                                     userFunctor );
+}
 
-    if(gx < length1 )
-    {
-        iTypePtr1 val = input_iter1[gx];
-        pos1 = binary_search1(val , input_iter2,input_iter2.m_StartIndex, length2, userFunctor);
-        if (input_iter2[pos1 -1] == val  && pos1 !=0 )
-             riter[pos1 + gx -1] = val;
-        else
-            riter[pos1 + gx] = val;
+//  One work-group per tile
+template< typename iTypePtr1, typename iTypeIter1, typename iTypePtr2, typename iTypeIter2,
+    typename riTypeIter, typename oTypePtr, typename comp_function >
+__kernel void mergePathTemplate(
+    global iTypePtr1*    input_ptr1,
+    iTypeIter1 input_iter1,
+    const int length1,
+    global iTypePtr2*    input_ptr2,
+    iTypeIter2 input_iter2,
+    const int length2,
+    global oTypePtr* result,
+    riTypeIter riter,
+    global const int* partitions,
+    local iTypePtr1* lds,
+    global comp_function* userFunctor
+)
+{
+    int tile = get_group_id( 0 );
 
-    }
+    input_iter1.init( input_ptr1 );
+    input_iter2.init( input_ptr2 );
+    riter.init( result );
 
-    if(gx < length2 )
-    {
-         iTypePtr2 val = input_iter2[gx];
-        pos2 = binary_search2(val, input_iter1,input_iter1.m_StartIndex,length1,userFunctor);
-        riter[pos2 + gx ] = val;
-    }
+    int d0 = tile * MERGE_TILE;
+    int d1 = min( d0 + MERGE_TILE, length1 + length2 );
+    int a0 = partitions[ tile ];
+    int a1 = partitions[ tile + 1 ];
+
+    mergePathTile( input_iter1, a0, a1, input_iter2, d0 - a0, d1 - a1, riter, d0, lds, userFunctor );
 }
@@ -17,6 +17,11 @@
 
 //#pragma OPENCL EXTENSION cl_amd_printf : enable
 
+//  REDUCE_WG_SIZE, the work-items of a work-group, is 64, 128 or 256 as set by the host from the tuning database
+#ifndef REDUCE_WG_SIZE
+#define REDUCE_WG_SIZE 256
+#endif
+
 #define _REDUCE_STEP_MIN(_LENGTH, _IDX, _W)\
 if ((_IDX < _W) && ((_IDX + _W) < _LENGTH)) {\
       iTypePtr mine = scratch[_IDX];\
@@ -43,19 +48,20 @@ template< typename iTypePtr, typename iTypeIter, typename binary_function >
 kernel void min_elementTemplate(
     global iTypePtr*    input_ptr, 
     iTypeIter input_iter,
-    const int length,
+    const BOLT_INDEX_T length,
     global binary_function* userFunctor,
-    global int*    result,
+    global BOLT_INDEX_T*    result,
     local iTypePtr*     scratch,
-    local int*     scratch_index
+    local BOLT_INDEX_T*     scratch_index,
+    BOLT_LEAF_PARAMS
 )
 {
-    int gx = get_global_id (0);
-    int igx = gx;
-    int gloId = gx;
+    BOLT_INDEX_T gx = get_global_id (0);
+    BOLT_INDEX_T igx = gx;
+    BOLT_INDEX_T gloId = gx;
     bool stat;
     
-    input_iter.init( input_ptr );
+    BOLT_INIT_LEAVES( input_iter, input_ptr );
 
     //  Initialize the accumulator private variable with data from the input array
     //  This essentially unrolls the loop below at least once
@@ -87,14 +93,18 @@ kernel void min_elementTemplate(
     barrier(CLK_LOCAL_MEM_FENCE);
 
     //  Tail stops the last workgroup from reading past the end of the input vector
-    uint tail = length - (get_group_id(0) * get_local_size(0));
+    BOLT_INDEX_T tail = length - (get_group_id(0) * get_local_size(0));
 
     // Parallel reduction within a given workgroup using local data store
     // to share values between workitems
 
  #if defined(_IS_MAX_KERNEL)
+#if REDUCE_WG_SIZE > 128
     _REDUCE_STEP_MAX(tail, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
     _REDUCE_STEP_MAX(tail, local_index, 64);
+#endif
     _REDUCE_STEP_MAX(tail, local_index, 32);
     _REDUCE_STEP_MAX(tail, local_index, 16);
     _REDUCE_STEP_MAX(tail, local_index,  8);
@@ -102,8 +112,12 @@ kernel void min_elementTemplate(
     _REDUCE_STEP_MAX(tail, local_index,  2);
     _REDUCE_STEP_MAX(tail, local_index,  1);	
 #else if
+#if REDUCE_WG_SIZE > 128
     _REDUCE_STEP_MIN(tail, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
     _REDUCE_STEP_MIN(tail, local_index, 64);      
+#endif
 	  _REDUCE_STEP_MIN(tail, local_index, 32);
     _REDUCE_STEP_MIN(tail, local_index, 16);
     _REDUCE_STEP_MIN(tail, local_index,  8);
@@ -123,3 +137,79 @@ kernel void min_elementTemplate(
         result[get_group_id(0)] = scratch_index[0];        
     }
 };
+
+//  Second pass: a single workgroup picks the winner among the per-workgroup indices of min_elementTemplate, and leaves
+//  its index in result[0], so only one index has to leave the device
+template< typename iTypePtr, typename iTypeIter, typename binary_function >
+kernel void min_elementFinalTemplate(
+    global iTypePtr*    input_ptr,
+    iTypeIter input_iter,
+    const int numPartials,
+    global binary_function* userFunctor,
+    global BOLT_INDEX_T*    result,
+    local iTypePtr*     scratch,
+    local BOLT_INDEX_T*     scratch_index,
+    BOLT_LEAF_PARAMS
+)
+{
+    int local_index = get_local_id(0);
+    bool stat;
+
+    BOLT_INIT_LEAVES( input_iter, input_ptr );
+
+    //  Every index is read into registers before the first barrier, so result[0] can be overwritten at the end
+    iTypePtr accumulator;
+    BOLT_INDEX_T igx;
+    if(local_index < numPartials){
+       igx = result[local_index];
+       accumulator = input_iter[igx];
+       for(int i = local_index + get_local_size(0); i < numPartials; i += get_local_size(0))
+       {
+           BOLT_INDEX_T candidate = result[i];
+           iTypePtr element = input_iter[candidate];
+		#if defined(_IS_MAX_KERNEL)
+			stat =  (*userFunctor)(element, accumulator);
+		#else
+			stat =  (*userFunctor)(accumulator, element);
+		#endif
+           accumulator = stat ? accumulator : element;
+           igx = stat ? igx : candidate;
+       }
+    }
+    scratch[local_index] = accumulator;
+    scratch_index[local_index] = igx;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+ #if defined(_IS_MAX_KERNEL)
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP_MAX(numPartials, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP_MAX(numPartials, local_index, 64);
+#endif
+    _REDUCE_STEP_MAX(numPartials, local_index, 32);
+    _REDUCE_STEP_MAX(numPartials, local_index, 16);
+    _REDUCE_STEP_MAX(numPartials, local_index,  8);
+    _REDUCE_STEP_MAX(numPartials, local_index,  4);
+    _REDUCE_STEP_MAX(numPartials, local_index,  2);
+    _REDUCE_STEP_MAX(numPartials, local_index,  1);
+#else
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP_MIN(numPartials, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP_MIN(numPartials, local_index, 64);
+#endif
+    _REDUCE_STEP_MIN(numPartials, local_index, 32);
+    _REDUCE_STEP_MIN(numPartials, local_index, 16);
+    _REDUCE_STEP_MIN(numPartials, local_index,  8);
+    _REDUCE_STEP_MIN(numPartials, local_index,  4);
+    _REDUCE_STEP_MIN(numPartials, local_index,  2);
+    _REDUCE_STEP_MIN(numPartials, local_index,  1);
+#endif
+
+    if (local_index == 0)
+    {
+        result[0] = scratch_index[0];
+    }
+};
@@ -230,9 +230,43 @@ template<typename Pair> struct tuple_size;
 
 /*! \} // Miscellaneous
  */
+
+    //  This string represents the device side definition of the pair template; it holds the data members only
+    static std::string devicePair = STRINGIFY_CODE(
+        namespace bolt { namespace cl { \n
+        template< typename T1, typename T2 > \n
+        struct pair \n
+        { \n
+            typedef T1 first_type; \n
+            typedef T2 second_type; \n
+            first_type first; \n
+            second_type second; \n
+        }; \n
+    } } \n
+    );
+
     } //end cl
 } // end bolt
 
+template< typename T1, typename T2 >
+struct TypeName< bolt::cl::pair< T1, T2 > >
+{
+    static std::string get( )
+    {
+        return "bolt::cl::pair< " + TypeName< T1 >::get( ) + ", " + TypeName< T2 >::get( ) + " >";
+    }
+};
+
+template< typename T1, typename T2 >
+struct ClCode< bolt::cl::pair< T1, T2 > >
+{
+    static std::string get( )
+    {
+        return ClCode< T1 >::get( ) + BOLT_CLCODE_PART_DELIMITER + ClCode< T2 >::get( ) + BOLT_CLCODE_PART_DELIMITER +
+            bolt::cl::devicePair;
+    }
+};
+
 #include <bolt/cl/detail/pair.inl>
 
 #endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_PARTITION_H )
+#define BOLT_CL_PARTITION_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+
+#include <string>
+
+/*! \file bolt/cl/partition.h
+    \brief Reorders a range so that the elements satisfying a predicate precede the others.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup reordering
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-partition
+        *   \ingroup reordering
+        *   \{
+        */
+
+       /*! \brief \p stable_partition reorders [first, last) so that every element for which \p pred is \p true
+         * precedes every element for which it is \p false. Both groups keep their relative order.
+         *
+         * \details Runs on the compaction engine shared with \p copy_if: the scatter writes each element either
+         * behind the kept elements before it or, when rejected, behind all kept elements and the rejected
+         * elements before it, so a single pass places both groups.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the sequence.
+         * \param last The end of the sequence.
+         * \param pred A predicate deciding which elements go first.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam ForwardIterator is a model of ForwardIterator
+         *  \tparam Predicate is a model of Predicate
+         *  \return The beginning of the elements for which \p pred is \p false.
+         *
+         *  \details The following code snippet demonstrates how to use \p stable_partition
+         *
+         *  \code
+         *  #include <bolt/cl/partition.h>
+         *
+         *  BOLT_FUNCTOR( is_odd,
+         *    struct is_odd{
+         *        bool operator () (int x) const
+         *        {
+         *            return ( x & 1 ) == 1;
+         *        }
+         *    };
+         *  );
+         *
+         *  ...
+         *
+         *  int a[8] = {5, 7, 2, 3, 12, 6, 9, 8};
+         *  int* middle = bolt::cl::stable_partition( a, a + 8, is_odd( ) );
+         *
+         *  // a is now {5, 7, 3, 9, 2, 12, 6, 8} and middle == a + 4
+         *  \endcode
+         *
+         *  \sa http://www.sgi.com/tech/stl/stable_partition.html
+         */
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator stable_partition( bolt::cl::control &ctl,
+                                          ForwardIterator first,
+                                          ForwardIterator last,
+                                          Predicate pred,
+                                          const std::string& cl_code="" );
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator stable_partition( ForwardIterator first,
+                                          ForwardIterator last,
+                                          Predicate pred,
+                                          const std::string& cl_code="" );
+
+       /*! \brief \p partition reorders [first, last) so that every element for which \p pred is \p true
+         * precedes every element for which it is \p false. The relative order within the groups is not
+         * guaranteed by the interface; the current implementation is that of \p stable_partition.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the sequence.
+         * \param last The end of the sequence.
+         * \param pred A predicate deciding which elements go first.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam ForwardIterator is a model of ForwardIterator
+         *  \tparam Predicate is a model of Predicate
+         *  \return The beginning of the elements for which \p pred is \p false.
+         *
+         *  \sa http://www.sgi.com/tech/stl/partition.html
+         */
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator partition( bolt::cl::control &ctl,
+                                   ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code="" );
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator partition( ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/partition.inl>
+#endif
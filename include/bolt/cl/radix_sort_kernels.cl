@@ -0,0 +1,296 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Generic LSD radix sort for 32 and 64 bit keys ( uint, int, float, ulong, long, double ).
+ *  Every key is mapped to an unsigned integer whose ordering matches the ordering of the key
+ *  ( radixKey ), so a single set of kernels serves every key type.  Each pass handles up to
+ *  RADIX_BITS bits ( set by the host per device, 4 or 8 ); the last pass of a partial-bit sort
+ *  handles fewer, selected by digitMask:
+ *      radixHistogram  - per work-group digit counts, stored digit major in isums
+ *      radixScan       - exclusive scan of isums, gives every (digit, work-group) its output offset
+ *      radixPermute    - stable local split of each block, then scatter of keys and an optional
+ *                        uint index payload
+ *  Values of sort_by_key are never moved by the passes; the index payload records where every
+ *  key came from and radixGatherWords / radixGatherBytes move the values once at the end.  The
+ *  value type therefore never reaches the device compiler.
+ *****************************************************************************/
+
+#if defined(cl_khr_fp64)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#elif defined(cl_amd_fp64)
+#pragma OPENCL EXTENSION cl_amd_fp64 : enable
+#endif
+
+#ifndef RADIX_BITS
+#define RADIX_BITS      4
+#endif
+#define RADIX_WG_SIZE   256
+#define RADICES         ( 1 << RADIX_BITS )
+#define RADIX_MASK      ( RADICES - 1 )
+
+#if RADICES > RADIX_WG_SIZE
+#error "A work-group must be able to hold one histogram bin per work item"
+#endif
+
+#define m_n             x
+#define m_nWGs          y
+#define m_startBit      z
+#define m_nBlocksPerWG  w
+
+/*  Order preserving maps from key to unsigned bits.  Signed integers flip the sign bit; floating
+ *  point flips the sign bit of positive values and every bit of negative values.  -0.0 is folded
+ *  onto +0.0 so that the two compare equal, as they do for less<>.  */
+inline uint radixKey( uint k )
+{
+    return k;
+}
+
+inline uint radixKey( int k )
+{
+    return as_uint( k ) ^ 0x80000000u;
+}
+
+inline uint radixKey( float k )
+{
+    uint b = ( k == 0.0f ) ? 0u : as_uint( k );
+    return b ^ ( ( b & 0x80000000u ) ? 0xFFFFFFFFu : 0x80000000u );
+}
+
+inline ulong radixKey( ulong k )
+{
+    return k;
+}
+
+inline ulong radixKey( long k )
+{
+    return as_ulong( k ) ^ 0x8000000000000000ul;
+}
+
+#if defined(cl_khr_fp64) || defined(cl_amd_fp64)
+inline ulong radixKey( double k )
+{
+    ulong b = ( k == 0.0 ) ? 0ul : as_ulong( k );
+    return b ^ ( ( b & 0x8000000000000000ul ) ? 0xFFFFFFFFFFFFFFFFul : 0x8000000000000000ul );
+}
+#endif
+
+template< typename kType >
+inline uint radixDigit( kType k, int startBit, uint digitMask, int descending )
+{
+    uint d = (uint)( radixKey( k ) >> startBit ) & digitMask;
+    return descending ? digitMask - d : d;
+}
+
+/*  Work-group wide exclusive scan of one uint per work item; the group total is returned
+ *  through total.  lds needs RADIX_WG_SIZE entries.  */
+inline uint radixLocalScan( uint val, local uint* lds, uint* total )
+{
+    int lid = get_local_id( 0 );
+    lds[ lid ] = val;
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( int offset = 1; offset < RADIX_WG_SIZE; offset <<= 1 )
+    {
+        uint t = ( lid >= offset ) ? lds[ lid - offset ] : 0;
+        barrier( CLK_LOCAL_MEM_FENCE );
+        lds[ lid ] += t;
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
+
+    *total = lds[ RADIX_WG_SIZE - 1 ];
+    uint result = lds[ lid ] - val;
+    barrier( CLK_LOCAL_MEM_FENCE );
+    return result;
+}
+
+template< typename kType >
+kernel void radixHistogram( global const kType* keys,
+                            const ulong keysOffset,
+                            global uint* isums,
+                            int4 cb,
+                            const int descending,
+                            const uint digitMask )
+{
+    local uint counts[ RADICES ];
+
+    int lid = get_local_id( 0 );
+    int wg  = get_group_id( 0 );
+
+    if( lid < RADICES )
+        counts[ lid ] = 0;
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    int first = wg * cb.m_nBlocksPerWG * RADIX_WG_SIZE;
+    for( int block = 0; block < cb.m_nBlocksPerWG; ++block )
+    {
+        int i = first + block * RADIX_WG_SIZE + lid;
+        if( i < cb.m_n )
+            atomic_inc( &counts[ radixDigit( keys[ keysOffset + i ], cb.m_startBit, digitMask, descending ) ] );
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    if( lid < RADICES )
+        isums[ lid * cb.m_nWGs + wg ] = counts[ lid ];
+}
+
+/*  Launched as a single work-group.  isums is digit major, so one exclusive scan over all
+ *  RADICES * nWGs counts yields the output offset of every ( digit, work-group ) pair.  */
+kernel __attribute__((reqd_work_group_size(RADIX_WG_SIZE,1,1)))
+void radixScanInstantiated( global uint* isums, const int nWGs )
+{
+    local uint lds[ RADIX_WG_SIZE ];
+
+    int lid = get_local_id( 0 );
+    int count = RADICES * nWGs;
+    uint seed = 0;
+
+    for( int base = 0; base < count; base += RADIX_WG_SIZE )
+    {
+        int i = base + lid;
+        uint val = ( i < count ) ? isums[ i ] : 0;
+        uint total;
+        uint res = radixLocalScan( val, lds, &total );
+        if( i < count )
+            isums[ i ] = res + seed;
+        seed += total;
+    }
+}
+
+/*  indexMode: 0 - keys only, 1 - write the source position as the index payload ( first pass ),
+ *  2 - carry the index payload from srcIndex to dstIndex.  */
+template< typename kType >
+kernel void radixPermute( global const kType* srcKeys,
+                          const ulong srcOffset,
+                          global const uint* srcIndex,
+                          global const uint* isums,
+                          global kType* dstKeys,
+                          const ulong dstOffset,
+                          global uint* dstIndex,
+                          int4 cb,
+                          const int descending,
+                          const uint digitMask,
+                          const int indexMode )
+{
+    local uint  lds[ RADIX_WG_SIZE ];
+    local uint  sorted[ RADIX_WG_SIZE ];
+    local kType ldsKeys[ RADIX_WG_SIZE ];
+    local uint  groupOffset[ RADICES ];
+    local uint  blockCount[ RADICES ];
+    local uint  blockStart[ RADICES ];
+
+    int lid = get_local_id( 0 );
+    int wg  = get_group_id( 0 );
+
+    if( lid < RADICES )
+        groupOffset[ lid ] = isums[ lid * cb.m_nWGs + wg ];
+
+    int first = wg * cb.m_nBlocksPerWG * RADIX_WG_SIZE;
+    for( int block = 0; block < cb.m_nBlocksPerWG; ++block )
+    {
+        int base = first + block * RADIX_WG_SIZE;
+        if( base >= cb.m_n )
+            break;
+        int nValid = min( RADIX_WG_SIZE, cb.m_n - base );
+
+        if( lid < RADICES )
+            blockCount[ lid ] = 0;
+        barrier( CLK_LOCAL_MEM_FENCE );
+
+        //  Elements past the end take the largest digit; being last in the block they stay behind
+        //  every valid element through the stable splits
+        uint digit = digitMask;
+        if( lid < nValid )
+        {
+            kType key = srcKeys[ srcOffset + base + lid ];
+            ldsKeys[ lid ] = key;
+            digit = radixDigit( key, cb.m_startBit, digitMask, descending );
+            atomic_inc( &blockCount[ digit ] );
+        }
+
+        //  Stable local sort of ( digit, position ) pairs, one bit per split
+        uint packed = ( digit << 16 ) | (uint)lid;
+        for( int bit = 0; ( digitMask >> bit ) != 0; ++bit )
+        {
+            uint isZero = ( ( packed >> ( 16 + bit ) ) & 1 ) ^ 1;
+            uint totalZeros;
+            uint zerosBefore = radixLocalScan( isZero, lds, &totalZeros );
+            uint newPos = isZero ? zerosBefore : totalZeros + lid - zerosBefore;
+            sorted[ newPos ] = packed;
+            barrier( CLK_LOCAL_MEM_FENCE );
+            packed = sorted[ lid ];
+            barrier( CLK_LOCAL_MEM_FENCE );
+        }
+
+        uint blockTotal;
+        uint start = radixLocalScan( ( lid < RADICES ) ? blockCount[ lid ] : 0, lds, &blockTotal );
+        if( lid < RADICES )
+            blockStart[ lid ] = start;
+        barrier( CLK_LOCAL_MEM_FENCE );
+
+        if( lid < nValid )
+        {
+            uint d   = packed >> 16;
+            uint src = packed & 0xFFFF;
+            uint dst = groupOffset[ d ] + lid - blockStart[ d ];
+
+            dstKeys[ dstOffset + dst ] = ldsKeys[ src ];
+            if( indexMode == 1 )
+                dstIndex[ dst ] = base + src;
+            else if( indexMode == 2 )
+                dstIndex[ dst ] = srcIndex[ base + src ];
+        }
+        barrier( CLK_LOCAL_MEM_FENCE );
+
+        if( lid < RADICES )
+            groupOffset[ lid ] += blockCount[ lid ];
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
+}
+
+/*  dst[ i ] = src[ index[ i ] ] for values of width words uints ( or bytes uchars )  */
+kernel void radixGatherWordsInstantiated( global const uint* src,
+                                          const ulong srcOffset,
+                                          global const uint* index,
+                                          global uint* dst,
+                                          const int n,
+                                          const int words )
+{
+    const ulong total = (ulong)n * words;
+    for( ulong i = get_global_id( 0 ); i < total; i += get_global_size( 0 ) )
+    {
+        ulong e = i / words;
+        ulong w = i - e * words;
+        dst[ i ] = src[ srcOffset + (ulong)index[ e ] * words + w ];
+    }
+}
+
+kernel void radixGatherBytesInstantiated( global const uchar* src,
+                                          const ulong srcOffset,
+                                          global const uint* index,
+                                          global uchar* dst,
+                                          const int n,
+                                          const int bytes )
+{
+    const ulong total = (ulong)n * bytes;
+    for( ulong i = get_global_id( 0 ); i < total; i += get_global_size( 0 ) )
+    {
+        ulong e = i / bytes;
+        ulong b = i - e * bytes;
+        dst[ i ] = src[ srcOffset + (ulong)index[ e ] * bytes + b ];
+    }
+}
@@ -23,8 +23,6 @@
 #include <bolt/cl/functional.h>
 #include <bolt/cl/device_vector.h>
 #include <bolt/cl/pair.h>
-#include "bolt/cl/scan.h"
-#include "bolt/cl/scan_by_key.h"
 
 /*! \file bolt/cl/reduce_by_key.h
     \brief Performs on a sequence, a reduction of each sub-sequence as defined by equivalent keys.
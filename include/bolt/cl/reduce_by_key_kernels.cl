@@ -15,318 +15,217 @@
 ***************************************************************************/
 #pragma OPENCL EXTENSION cl_amd_printf : enable
 
+// reduce_by_key runs in two kernels over the same grid of work-groups.  Work-group g owns the chunk
+// [ g * chunkSize, ( g + 1 ) * chunkSize ) of the input and walks it in tiles of one element per work item.
+// Every element stands for the pair ( heads, value ): the number of segment heads among the elements it covers, and the
+// reduction of those elements since the last head.  Combining a pair with its successor adds the heads, and restarts
+// the value when the successor holds a head, so an inclusive scan of the pairs gives every element the number of
+// segments begun so far and the reduction of its own segment up to it.
 
 /******************************************************************************
- *  Kernel 0
+ *  Inclusive scan of one tile of ( heads, value ) pairs
  *****************************************************************************/
 template<
-    typename kType,
-    typename kIterType,
-    typename BinaryPredicate,
-    typename BinaryFunction >
-__kernel void OffsetCalculation(
-    global kType *ikeys, //input keys
-    kIterType keys,
-    global int *output2, //offsetKeys
-    const uint vecSize,
-    global BinaryPredicate *binaryPred,
-    global BinaryFunction *binaryFunct)
-{
-
-    keys.init( ikeys );
-
-    size_t gloId = get_global_id( 0 );
-    size_t groId = get_group_id( 0 );
-    size_t locId = get_local_id( 0 );
-    size_t wgSize = get_local_size( 0 );
-
-	 if (gloId >= vecSize) return;
-
-    kType key, prev_key;
-
-    if(gloId > 0){
-      key = keys[ gloId ];
-	  prev_key = keys[ gloId - 1];
-	  if((*binaryPred)(key, prev_key))
-	    output2[ gloId ] = 0;
-	  else
-		output2[ gloId ] = 1;
-	}
-	else{
-		 output2[ gloId ] = 0;
-	}
-}
-
-/******************************************************************************
- *  Kernel 1
- *****************************************************************************/
-template<
-    typename vType,
-    typename vIterType,
-    typename oType,
     typename voType,
     typename BinaryFunction >
-__kernel void perBlockScanByKey(
-    global int *keys,
-    global vType *ivals, //input values
-    vIterType vals,
-    global voType *output, // offsetValues
-    const uint vecSize,
-    local int *ldsKeys,
-    local oType *ldsVals,
-    global BinaryFunction *binaryFunct,
-    global int *keyBuffer,
-    global oType *valBuffer)
+void segmentedTileScan(
+    local BOLT_INDEX_T *ldsHeads,
+    local voType *ldsVals,
+    BOLT_INDEX_T *heads,
+    voType *val,
+    global BinaryFunction *binaryFunct )
 {
-
-    vals.init( ivals );
-
-    size_t gloId = get_global_id( 0 );
-    size_t groId = get_group_id( 0 );
     size_t locId = get_local_id( 0 );
     size_t wgSize = get_local_size( 0 );
 
-    // if exclusive, load gloId=0 w/ init, and all others shifted-1
-    int key;
-    oType val;
-
-    if(gloId < vecSize){
-      key = keys[ gloId ];
-      val = vals[ gloId ];
-      ldsKeys[ locId ] = key;
-      ldsVals[ locId ] = val;
-    }
-    // Computes a scan within a workgroup
-    // updates vals in lds but not keys
-    oType sum = val;
+    // work items past the end of the input only ever combine with the ones before them, so their values are unused
+    ldsHeads[ locId ] = *heads;
+    ldsVals[ locId ] = *val;
     for( size_t offset = 1; offset < wgSize; offset *= 2 )
     {
         barrier( CLK_LOCAL_MEM_FENCE );
-        int key2 = ldsKeys[locId - offset];
-        if (locId >= offset && key == key2)
+        if( locId >= offset )
         {
-            oType y = ldsVals[ locId - offset ];
-            sum = (*binaryFunct)( sum, y );
+            if( *heads == 0 )
+                *val = (*binaryFunct)( ldsVals[ locId - offset ], *val );
+            *heads += ldsHeads[ locId - offset ];
         }
         barrier( CLK_LOCAL_MEM_FENCE );
-        ldsVals[ locId ] = sum;
-    }
-    barrier( CLK_LOCAL_MEM_FENCE ); // needed for large data types
-    //  Abort threads that are passed the end of the input vector
-    if (gloId >= vecSize) return;
-
-    // Each work item writes out its calculated scan result, relative to the beginning
-    // of each work group
-	int key2 = -1;
-	if (gloId < vecSize -1 )
-		key2 = keys[gloId + 1];
-	if(key != key2)
-       output[ gloId ] = sum;
-
-    if (locId == 0)
-    {
-        keyBuffer[ groId ] = ldsKeys[ wgSize-1 ];
-        valBuffer[ groId ] = ldsVals[ wgSize-1 ];
+        ldsHeads[ locId ] = *heads;
+        ldsVals[ locId ] = *val;
     }
+    barrier( CLK_LOCAL_MEM_FENCE );
 }
 
-
 /******************************************************************************
- *  Kernel 2
+ *  Kernel 0: the ( heads, value ) pair of every chunk
  *****************************************************************************/
 template<
-    typename oType,
+    typename kType,
+    typename kIterType,
+    typename vType,
+    typename vIterType,
+    typename voType,
+    typename BinaryPredicate,
     typename BinaryFunction >
-__kernel void intraBlockInclusiveScanByKey(
-    global int *keySumArray,
-    global oType *preSumArray,
-    global oType *postSumArray,
-    const uint vecSize,
-    local int *ldsKeys,
-    local oType *ldsVals,
-    const uint workPerThread,
-    global BinaryFunction  *binaryFunct )
+__kernel void perGroupSegmentSummary(
+    global kType *ikeys,
+    kIterType keys,
+    global vType *ivals,
+    vIterType vals,
+    const BOLT_INDEX_T vecSize,
+    const BOLT_INDEX_T chunkSize,
+    local BOLT_INDEX_T *ldsHeads,
+    local voType *ldsVals,
+    global BinaryPredicate *binaryPred,
+    global BinaryFunction *binaryFunct,
+    global ulong *groupHeads,
+    global voType *groupTail )
 {
+    keys.init( ikeys );
+    vals.init( ivals );
+
     size_t groId = get_group_id( 0 );
-    size_t gloId = get_global_id( 0 );
     size_t locId = get_local_id( 0 );
     size_t wgSize = get_local_size( 0 );
-    uint mapId  = gloId * workPerThread;
 
-    // do offset of zero manually
-    uint offset;
-    int key;
-    oType workSum;
+    // the host launches one work-group per non-empty chunk
+    BOLT_INDEX_T first = groId * chunkSize;
+    BOLT_INDEX_T last = ( vecSize - first < chunkSize ) ? vecSize : first + chunkSize;
 
-    if (mapId < vecSize)
+    BOLT_INDEX_T runHeads = 0;
+    voType runVal;
+    for( BOLT_INDEX_T base = first; base < last; base += wgSize )
     {
-        int prevKey;
-
-        // accumulate zeroth value manually
-        offset = 0;
-        key = keySumArray[ mapId+offset ];
-        workSum = preSumArray[ mapId+offset ];
-        postSumArray[ mapId+offset ] = workSum;
-
-        //  Serial accumulation
-        for( offset = offset+1; offset < workPerThread; offset += 1 )
+        BOLT_INDEX_T k = base + locId;
+        BOLT_INDEX_T heads = 0;
+        voType val;
+        if( k < last )
         {
-            prevKey = key;
-            key = keySumArray[ mapId+offset ];
-            if (mapId+offset<vecSize )
-            {
-                oType y = preSumArray[ mapId+offset ];
-                if ( key == prevKey )
-                {
-                    workSum = (*binaryFunct)( workSum, y );
-                }
-                else
-                {
-                    workSum = y;
-                }
-                postSumArray[ mapId+offset ] = workSum;
-            }
+            heads = ( k == 0 ) || !(*binaryPred)( keys[ k ], keys[ k - 1 ] );
+            val = vals[ k ];
         }
-    }
-    barrier( CLK_LOCAL_MEM_FENCE );
+        segmentedTileScan( ldsHeads, ldsVals, &heads, &val, binaryFunct );
 
-    oType scanSum = workSum;
-    offset = 1;
-    // load LDS with register sums
-    ldsVals[ locId ] = workSum;
-    ldsKeys[ locId ] = key;
-    // scan in lds
-    for( offset = offset*1; offset < wgSize; offset *= 2 )
-    {
+        BOLT_INDEX_T lastItem = ( last - base < wgSize ) ? ( last - base - 1 ) : ( wgSize - 1 );
+        BOLT_INDEX_T tileHeads = ldsHeads[ lastItem ];
+        voType tileVal = ldsVals[ lastItem ];
+        runVal = ( tileHeads || base == first ) ? tileVal : (*binaryFunct)( runVal, tileVal );
+        runHeads += tileHeads;
         barrier( CLK_LOCAL_MEM_FENCE );
-        if (mapId < vecSize)
-        {
-            if (locId >= offset  )
-            {
-                oType y = ldsVals[ locId - offset ];
-                int key1 = ldsKeys[ locId ];
-                int key2 = ldsKeys[ locId-offset ];
-                if ( key1 == key2 )
-                {
-                   scanSum = (*binaryFunct)( scanSum, y );
-                }
-                else
-                   scanSum = ldsVals[ locId ];
-             }
-
-        }
-        barrier( CLK_LOCAL_MEM_FENCE );
-        ldsVals[ locId ] = scanSum;
-    } // for offset
-    barrier( CLK_LOCAL_MEM_FENCE );
-
-    // write final scan from pre-scan and lds scan
-    for( offset = 0; offset < workPerThread; offset += 1 )
-    {
-        barrier( CLK_GLOBAL_MEM_FENCE );
-
-        if (mapId < vecSize && locId > 0)
-        {
-            oType y = postSumArray[ mapId+offset ];
-            int key1 = keySumArray[ mapId+offset ]; // change me
-            int key2 = ldsKeys[ locId-1 ];
-            if ( key1 == key2 )
-            {
-                oType y2 = ldsVals[locId-1];
-                y = (*binaryFunct)( y, y2 );
-            }
-            postSumArray[ mapId+offset ] = y;
-        } // thread in bounds
-    } // for
-
-} // end kernel
-
-
-/******************************************************************************
- *  Kernel 3
- *****************************************************************************/
-template<
-    typename oType,
-    typename BinaryFunction >
-__kernel void perBlockAdditionByKey(
-    global int *keySumArray, //InputBuffer
-    global oType *postSumArray, //InputBuffer
-	global int *keys,
-    global oType *output, //offsetValArray
-    const uint vecSize,
-    global BinaryFunction *binaryFunct)
-{
-    size_t gloId = get_global_id( 0 );
-    size_t groId = get_group_id( 0 );
-    size_t locId = get_local_id( 0 );
-
-    //  Abort threads that are passed the end of the input vector
-    if( gloId >= vecSize )
-        return;
+    }
 
-    // accumulate prefix
-    int key1 = keySumArray[ groId-1 ];
-    int key2 = keys[ gloId ];
-	int key3 = -1;
-	if(gloId < vecSize -1 )
-	  key3 =  keys[ gloId + 1];
-    if (groId > 0 && key1 == key2 && key2 != key3)
+    if( locId == 0 )
     {
-	    oType scanResult = output[ gloId ];
-        oType postBlockSum = postSumArray[ groId-1 ];
-        oType newResult = (*binaryFunct)( scanResult, postBlockSum );
-        output[ gloId ] = newResult;
-
+        groupHeads[ groId ] = runHeads;
+        groupTail[ groId ] = runVal;
     }
 }
 
-
 /******************************************************************************
- *  Kernel 4
+ *  Kernel 1: reduce every segment and write it to its place in the output
  *****************************************************************************/
- template<
+template<
     typename kType,
     typename kIterType,
+    typename vType,
+    typename vIterType,
     typename koType,
     typename koIterType,
     typename voType,
-    typename voIterType >
-__kernel void keyValueMapping(
+    typename voIterType,
+    typename BinaryPredicate,
+    typename BinaryFunction >
+__kernel void segmentedReduceAndCompact(
     global kType *ikeys,
     kIterType keys,
+    global vType *ivals,
+    vIterType vals,
     global koType *ikeys_output,
     koIterType keys_output,
     global voType *ivals_output,
     voIterType vals_output,
-    global int *offsetArray,
-    global voType *offsetValArray,
-    const uint vecSize,
-    int numSections)
+    const BOLT_INDEX_T vecSize,
+    const BOLT_INDEX_T chunkSize,
+    local BOLT_INDEX_T *ldsHeads,
+    local voType *ldsVals,
+    global BinaryPredicate *binaryPred,
+    global BinaryFunction *binaryFunct,
+    global ulong *groupHeads,
+    global voType *groupTail,
+    global ulong *segmentCount )
 {
     keys.init( ikeys );
+    vals.init( ivals );
     keys_output.init( ikeys_output );
     vals_output.init( ivals_output );
 
+    size_t groId = get_group_id( 0 );
+    size_t locId = get_local_id( 0 );
+    size_t wgSize = get_local_size( 0 );
 
-    size_t gloId = get_global_id( 0 );
-	size_t locId = get_local_id( 0 );
+    BOLT_INDEX_T first = groId * chunkSize;
+    BOLT_INDEX_T last = ( vecSize - first < chunkSize ) ? vecSize : first + chunkSize;
 
-    //  Abort threads that are passed the end of the input vector
-    if( gloId >= vecSize )
-        return;
+    // the segments begun in the chunks before this one; the work-group size is a power of two
+    BOLT_INDEX_T priorHeads = 0;
+    for( size_t g = locId; g < groId; g += wgSize )
+        priorHeads += groupHeads[ g ];
+    ldsHeads[ locId ] = priorHeads;
+    barrier( CLK_LOCAL_MEM_FENCE );
+    for( size_t offset = wgSize / 2; offset > 0; offset /= 2 )
+    {
+        if( locId < offset )
+            ldsHeads[ locId ] += ldsHeads[ locId + offset ];
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
 
-	numSections = *(offsetArray+vecSize-1) + 1;
-    if(gloId < (vecSize-1) && offsetArray[ gloId ] != offsetArray[ gloId +1])
+    // the value of the segment running into this chunk; chunk 0 starts with a head, so the walk ends there at the latest
+    if( locId == 0 && groId > 0 )
     {
-		keys_output[ offsetArray [ gloId ]] = keys[ gloId];
-        vals_output[ offsetArray [ gloId ]] = offsetValArray [ gloId];
+        size_t look = groId - 1;
+        voType carry = groupTail[ look ];
+        while( groupHeads[ look ] == 0 )
+        {
+            --look;
+            carry = (*binaryFunct)( groupTail[ look ], carry );
+        }
+        ldsVals[ 0 ] = carry;
     }
+    barrier( CLK_LOCAL_MEM_FENCE );
+    BOLT_INDEX_T runHeads = ldsHeads[ 0 ];
+    voType runVal = ldsVals[ 0 ];
+    barrier( CLK_LOCAL_MEM_FENCE );
 
-  if( gloId == (vecSize-1) )
-  {
-        keys_output[ numSections - 1 ] = keys[ gloId ]; //Copying the last key directly. Works either ways
-        vals_output[ numSections - 1 ] = offsetValArray [ gloId ];
-	    offsetArray [ gloId ] = numSections;
-  }
+    for( BOLT_INDEX_T base = first; base < last; base += wgSize )
+    {
+        BOLT_INDEX_T k = base + locId;
+        BOLT_INDEX_T heads = 0;
+        kType key;
+        voType val;
+        if( k < last )
+        {
+            key = keys[ k ];
+            heads = ( k == 0 ) || !(*binaryPred)( key, keys[ k - 1 ] );
+            val = vals[ k ];
+        }
+        segmentedTileScan( ldsHeads, ldsVals, &heads, &val, binaryFunct );
+
+        // the last element of a segment writes it, to the place the heads before it give
+        if( k < last && ( k + 1 == vecSize || !(*binaryPred)( keys[ k + 1 ], key ) ) )
+        {
+            BOLT_INDEX_T segment = runHeads + heads - 1;
+            keys_output[ segment ] = key;
+            vals_output[ segment ] = heads ? val : (*binaryFunct)( runVal, val );
+            if( k + 1 == vecSize )
+                *segmentCount = segment + 1;
+        }
 
+        BOLT_INDEX_T lastItem = ( last - base < wgSize ) ? ( last - base - 1 ) : ( wgSize - 1 );
+        BOLT_INDEX_T tileHeads = ldsHeads[ lastItem ];
+        voType tileVal = ldsVals[ lastItem ];
+        runVal = tileHeads ? tileVal : (*binaryFunct)( runVal, tileVal );
+        runHeads += tileHeads;
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
 }
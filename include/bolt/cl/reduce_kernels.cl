@@ -17,6 +17,15 @@
 
 //#pragma OPENCL EXTENSION cl_amd_printf : enable
 
+//  The launch shape is set by the host from the tuning database: REDUCE_WG_SIZE is 64, 128 or 256 work-items and
+//  REDUCE_UNROLL the number of elements a work-item loads before it combines them
+#ifndef REDUCE_WG_SIZE
+#define REDUCE_WG_SIZE 256
+#endif
+#ifndef REDUCE_UNROLL
+#define REDUCE_UNROLL 1
+#endif
+
 #define _REDUCE_STEP(_LENGTH, _IDX, _W) \
     if ((_IDX < _W) && ((_IDX + _W) < _LENGTH)) {\
       T mine = scratch[_IDX];\
@@ -29,15 +38,16 @@ template< typename iTypePtr, typename iTypeIter, typename binary_function,typena
 kernel void reduceTemplate(
     global iTypePtr*    input_ptr, 
     iTypeIter input_iter,
-    const int length,
+    const BOLT_INDEX_T length,
     global binary_function* userFunctor,
     global T*    result,
-    local T*     scratch
+    local T*     scratch,
+    BOLT_LEAF_PARAMS
 )
 {
-    int gx = get_global_id (0);
-    int gloId = gx;
-    input_iter.init( input_ptr );
+    BOLT_INDEX_T gx = get_global_id (0);
+    BOLT_INDEX_T gloId = gx;
+    BOLT_INIT_LEAVES( input_iter, input_ptr );
 
     //  Initialize the accumulator private variable with data from the input array
     //  This essentially unrolls the loop below at least once
@@ -49,6 +59,19 @@ kernel void reduceTemplate(
 
     // Loop sequentially over chunks of input vector, reducing an arbitrary size input
     // length into a length related to the number of workgroups
+#if REDUCE_UNROLL > 1
+    //  Independent loads first, so that several memory requests are in flight per work-item
+    BOLT_INDEX_T stride = get_global_size(0);
+    while (gx + (REDUCE_UNROLL - 1) * stride < length)
+    {
+        iTypePtr elements[REDUCE_UNROLL];
+        for (int u = 0; u < REDUCE_UNROLL; ++u)
+            elements[u] = input_iter[gx + u * stride];
+        for (int u = 0; u < REDUCE_UNROLL; ++u)
+            accumulator = (*userFunctor)(accumulator, elements[u]);
+        gx += REDUCE_UNROLL * stride;
+    }
+#endif
     while (gx < length)
     {
         iTypePtr element = input_iter[gx];
@@ -62,12 +85,16 @@ kernel void reduceTemplate(
     barrier(CLK_LOCAL_MEM_FENCE);
 
     //  Tail stops the last workgroup from reading past the end of the input vector
-    uint tail = length - (get_group_id(0) * get_local_size(0));
+    BOLT_INDEX_T tail = length - (get_group_id(0) * get_local_size(0));
 
     // Parallel reduction within a given workgroup using local data store
-    // to share values between workitems - 256 is good to achieve high occupancy
+    // to share values between workitems
+#if REDUCE_WG_SIZE > 128
     _REDUCE_STEP(tail, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
     _REDUCE_STEP(tail, local_index, 64);
+#endif
     _REDUCE_STEP(tail, local_index, 32);
     _REDUCE_STEP(tail, local_index, 16);
     _REDUCE_STEP(tail, local_index,  8);
@@ -84,3 +111,44 @@ kernel void reduceTemplate(
         result[get_group_id(0)] = scratch[0];
     }
 };
+
+//  Second pass: a single workgroup combines the per-workgroup results of reduceTemplate with init, and leaves the
+//  final value in partials[0], so only one element has to leave the device
+template< typename binary_function, typename T >
+kernel void reduceFinalTemplate(
+    global T*    partials,
+    const int numPartials,
+    const T init,
+    global binary_function* userFunctor,
+    local T*     scratch
+)
+{
+    int local_index = get_local_id(0);
+
+    //  Every partial is read into registers before the first barrier, so partials[0] can be overwritten at the end
+    T accumulator;
+    if(local_index < numPartials){
+       accumulator = partials[local_index];
+       for(int i = local_index + get_local_size(0); i < numPartials; i += get_local_size(0))
+           accumulator = (*userFunctor)(accumulator, partials[i]);
+    }
+    scratch[local_index] = accumulator;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP(numPartials, local_index, 128);
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP(numPartials, local_index, 64);
+#endif
+    _REDUCE_STEP(numPartials, local_index, 32);
+    _REDUCE_STEP(numPartials, local_index, 16);
+    _REDUCE_STEP(numPartials, local_index,  8);
+    _REDUCE_STEP(numPartials, local_index,  4);
+    _REDUCE_STEP(numPartials, local_index,  2);
+    _REDUCE_STEP(numPartials, local_index,  1);
+
+    if (local_index == 0) {
+        partials[0] = (*userFunctor)(init, scratch[0]);
+    }
+};
@@ -0,0 +1,110 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_REMOVE_H )
+#define BOLT_CL_REMOVE_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+
+#include <string>
+
+/*! \file bolt/cl/remove.h
+    \brief Removes the elements of a range that satisfy a predicate.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup reordering
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-remove
+        *   \ingroup reordering
+        *   \{
+        */
+
+       /*! \brief \p remove_if removes every element of [first, last) for which \p pred is \p true. The remaining
+         * elements keep their relative order and are moved to the front of the range; the contents of the range
+         * past the returned iterator are unspecified.
+         *
+         * \details Runs on the compaction engine shared with \p copy_if; on the device the kept elements are
+         * compacted into a temporary and copied back over the front of the range.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the sequence.
+         * \param last The end of the sequence.
+         * \param pred A predicate deciding which elements are removed.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam ForwardIterator is a model of ForwardIterator
+         *  \tparam Predicate is a model of Predicate
+         *  \return The end of the remaining elements.
+         *
+         *  \details The following code snippet demonstrates how to use \p remove_if
+         *
+         *  \code
+         *  #include <bolt/cl/remove.h>
+         *
+         *  BOLT_FUNCTOR( is_odd,
+         *    struct is_odd{
+         *        bool operator () (int x) const
+         *        {
+         *            return ( x & 1 ) == 1;
+         *        }
+         *    };
+         *  );
+         *
+         *  ...
+         *
+         *  int a[8] = {5, 7, 2, 3, 12, 6, 9, 8};
+         *  int* end = bolt::cl::remove_if( a, a + 8, is_odd( ) );
+         *
+         *  // a now starts with {2, 12, 6, 8} and end == a + 4
+         *  \endcode
+         *
+         *  \sa http://www.sgi.com/tech/stl/remove_if.html
+         */
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator remove_if( bolt::cl::control &ctl,
+                                   ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code="" );
+
+        template< typename ForwardIterator,
+                  typename Predicate >
+        ForwardIterator remove_if( ForwardIterator first,
+                                   ForwardIterator last,
+                                   Predicate pred,
+                                   const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/remove.inl>
+#endif
@@ -395,3 +395,162 @@ __kernel void perBlockAdditionByKey(
     output_iter[ gloId ] = sum;
     
 }
+
+/******************************************************************************
+ *  Single-pass segmented scan with decoupled look-back
+ *****************************************************************************/
+// Same scheme as singlePassScan in scan_kernels.cl, scanning ( head, value ) pairs: a value only combines with its
+// predecessor when it does not start a segment.  TILE_STATUS_AGGREGATE is only published by tiles without a segment
+// head; a tile that contains one knows the running value at its end without looking back, so it publishes
+// TILE_STATUS_PREFIX immediately, and a tile whose first element is a head needs no carry.
+template<
+    typename kType,
+    typename kIterType,
+    typename vType,
+    typename iIterType,
+    typename oType,
+    typename oIterType,
+    typename initType,
+    typename BinaryPredicate,
+    typename BinaryFunction >
+__kernel void singlePassScanByKey(
+    global kType *keys,
+    kIterType    keys_iter,
+    global vType *vals,
+    iIterType     vals_iter,
+    global oType *output,
+    oIterType     output_iter,
+    initType init,
+    const uint vecSize,
+    local kType   *ldsKeys,
+    local oType   *ldsVals,
+    local int     *ldsFlags,
+    global BinaryPredicate *binaryPred,
+    global BinaryFunction *binaryFunct,
+    global oType *tileAggregate,
+    global oType *tileInclusive,
+    global int *tileStatus,
+    int exclusive )
+{
+    local uint tileId;
+    size_t locId = get_local_id( 0 );
+    size_t wgSize = get_local_size( 0 );
+    size_t tileSize = wgSize * 2;
+    keys_iter.init( keys );
+    vals_iter.init( vals );
+    output_iter.init( output );
+
+    if( locId == 0 )
+        tileId = atomic_inc( &tileStatus[ get_num_groups( 0 ) ] );
+    barrier( CLK_LOCAL_MEM_FENCE );
+    size_t tile = tileId;
+    size_t base = tile * tileSize;
+
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+            ldsKeys[ i ] = keys_iter[ base + i ];
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    // mark segment heads; a tile only reads its own values, so the scan may be done in place
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        size_t k = base + i;
+        if( k < vecSize )
+        {
+            int head = 1;
+            if( k > 0 )
+            {
+                kType key = ldsKeys[ i ];
+                kType prevKey = ( i > 0 ) ? ldsKeys[ i - 1 ] : keys_iter[ k - 1 ];
+                head = !(*binaryPred)( key, prevKey );
+            }
+            ldsFlags[ i ] = head;
+            ldsVals[ i ] = vals_iter[ k ];
+        }
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    // every work item reduces its pair, then the work-group scans the pair sums
+    int h0 = ldsFlags[ 2 * locId ];
+    int h1 = ldsFlags[ 2 * locId + 1 ];
+    oType a0 = ldsVals[ 2 * locId ];
+    oType a1 = ldsVals[ 2 * locId + 1 ];
+    oType sum = a0;
+    int flag = h0;
+    if( base + 2 * locId + 1 < vecSize )
+    {
+        sum = h1 ? a1 : (*binaryFunct)( a0, a1 );
+        flag = h0 | h1;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+    ldsVals[ locId ] = sum;
+    ldsFlags[ locId ] = flag;
+    for( size_t offset = 1; offset < wgSize; offset *= 2 )
+    {
+        barrier( CLK_LOCAL_MEM_FENCE );
+        if( locId >= offset )
+        {
+            oType y = ldsVals[ locId - offset ];
+            if( !flag )
+                sum = (*binaryFunct)( y, sum );
+            flag |= ldsFlags[ locId - offset ];
+        }
+        barrier( CLK_LOCAL_MEM_FENCE );
+        ldsVals[ locId ] = sum;
+        ldsFlags[ locId ] = flag;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    if( locId == 0 )
+    {
+        size_t lastItem = ( vecSize - base < tileSize ) ? ( vecSize - base - 1 ) : ( tileSize - 1 );
+        oType aggregate = ldsVals[ lastItem / 2 ];
+        int aggregateHasHead = ldsFlags[ lastItem / 2 ];
+
+        if( aggregateHasHead )
+            publishTile( tileInclusive, tileStatus, tile, aggregate, TILE_STATUS_PREFIX );
+        else
+            publishTile( tileAggregate, tileStatus, tile, aggregate, TILE_STATUS_AGGREGATE );
+
+        // element 0 is always a head, so tile 0 never looks back and always publishes TILE_STATUS_PREFIX
+        if( !h0 )
+        {
+            oType prefix = lookBack( tileAggregate, tileInclusive, tileStatus, tile, binaryFunct );
+            if( !aggregateHasHead )
+                publishTile( tileInclusive, tileStatus, tile, (*binaryFunct)( prefix, aggregate ), TILE_STATUS_PREFIX );
+            ldsVals[ wgSize ] = prefix;
+        }
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    // carry into this work item's pair; it is never used when the tile itself starts with a head
+    oType carry = ldsVals[ wgSize ];
+    int haveCarry = ( tile > 0 );
+    if( locId > 0 )
+    {
+        oType y = ldsVals[ locId - 1 ];
+        carry = ( haveCarry && !ldsFlags[ locId - 1 ] ) ? (*binaryFunct)( carry, y ) : y;
+        haveCarry = 1;
+    }
+    oType r0 = ( haveCarry && !h0 ) ? (*binaryFunct)( carry, a0 ) : a0;
+    oType r1 = h1 ? a1 : (*binaryFunct)( r0, a1 );
+    if( exclusive )
+    {
+        // every segment restarts from init, and each element sees only the values before it
+        oType seed = init;
+        r1 = h1 ? seed : (*binaryFunct)( seed, r0 );
+        r0 = h0 ? seed : (*binaryFunct)( seed, carry );
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+    ldsVals[ 2 * locId ] = r0;
+    ldsVals[ 2 * locId + 1 ] = r1;
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+            output_iter[ base + i ] = ldsVals[ i ];
+    }
+}
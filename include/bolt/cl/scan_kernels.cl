@@ -328,5 +328,59 @@ kernel void perBlockInclusiveScan(
   
 }
 
+
+/******************************************************************************
+ *  Single-pass scan with decoupled look-back
+ *****************************************************************************/
+// Each work-group scans one tile of 2 elements per work item.  Tiles are numbered in the order work-groups start, by
+// an atomic counter in tileStatus[ numTiles ], so a tile only ever waits on tiles that are already running.  The scan
+// of the tile and the look-back over its predecessors are scanTileDecoupled, in scan_lookback_kernels.cl.  Input and
+// output are each touched once.
+template< typename iPtrType, typename iIterType, typename oPtrType, typename oIterType, typename initType, typename BinaryFunction >
+kernel void singlePassScan(
+                global iPtrType* input_ptr,
+                iIterType    input_iter,
+                global oPtrType* output_ptr,
+                oIterType    output_iter,
+                initType identity,
+                const uint vecSize,
+                local iPtrType* lds,
+                global BinaryFunction* binaryOp,
+                global iPtrType* tileAggregate,
+                global iPtrType* tileInclusive,
+                global int* tileStatus,
+                int exclusive )
+{
+    local uint tileId;
+    size_t locId = get_local_id( 0 );
+    size_t wgSize = get_local_size( 0 );
+    size_t tileSize = wgSize * 2;
+    input_iter.init( input_ptr );
+    output_iter.init( output_ptr );
+
+    if( locId == 0 )
+        tileId = atomic_inc( &tileStatus[ get_num_groups( 0 ) ] );
+    barrier( CLK_LOCAL_MEM_FENCE );
+    size_t tile = tileId;
+    size_t base = tile * tileSize;
+
+    // a tile only reads its own elements, so the scan may be done in place
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+            lds[ i ] = input_iter[ base + i ];
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    scanTileDecoupled( lds, tile, base, vecSize, identity, exclusive, binaryOp, tileAggregate, tileInclusive,
+        tileStatus );
+
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+            output_iter[ base + i ] = lds[ i ];
+    }
+}
+
 // not using HSA
 #endif
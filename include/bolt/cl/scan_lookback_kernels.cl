@@ -0,0 +1,188 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.                                     
+*                                                                                    
+*   Licensed under the Apache License, Version 2.0 (the "License");   
+*   you may not use this file except in compliance with the License.                 
+*   You may obtain a copy of the License at                                          
+*                                                                                    
+*       http://www.apache.org/licenses/LICENSE-2.0                      
+*                                                                                    
+*   Unless required by applicable law or agreed to in writing, software              
+*   distributed under the License is distributed on an "AS IS" BASIS,              
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.         
+*   See the License for the specific language governing permissions and              
+*   limitations under the License.                                                   
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Decoupled look-back shared by the single-pass scans
+ *
+ *  Prepended to scan_kernels, transform_scan_kernels and scan_by_key_kernels.
+ *  Every tile publishes a value together with a status word.  The value is
+ *  stored first, then the status is set with an atomic; a reader polls the
+ *  status atomically and only then loads the value.  The values are stored and
+ *  loaded through volatile pointers, so on devices whose L1 caches are not
+ *  coherent between compute units neither side works on a stale cached copy.
+ *****************************************************************************/
+#define TILE_STATUS_INVALID   0 // tile has not published anything yet
+#define TILE_STATUS_AGGREGATE 1 // tileAggregate holds the reduction of the tile alone
+#define TILE_STATUS_PREFIX    2 // tileInclusive holds the reduction of the tile and every tile before it
+
+// Values are copied a word at a time where their size allows it, and a byte at a time otherwise
+template< typename T >
+void storePublished( global T* slot, T value )
+{
+    if( sizeof( T ) % sizeof( uint ) == 0 )
+    {
+        volatile global uint* dst = ( volatile global uint* )slot;
+        uint* src = ( uint* )&value;
+        for( uint w = 0; w < sizeof( T ) / sizeof( uint ); ++w )
+            dst[ w ] = src[ w ];
+    }
+    else
+    {
+        volatile global uchar* dst = ( volatile global uchar* )slot;
+        uchar* src = ( uchar* )&value;
+        for( uint b = 0; b < sizeof( T ); ++b )
+            dst[ b ] = src[ b ];
+    }
+}
+
+template< typename T >
+T loadPublished( global T* slot )
+{
+    T value;
+    if( sizeof( T ) % sizeof( uint ) == 0 )
+    {
+        volatile global uint* src = ( volatile global uint* )slot;
+        uint* dst = ( uint* )&value;
+        for( uint w = 0; w < sizeof( T ) / sizeof( uint ); ++w )
+            dst[ w ] = src[ w ];
+    }
+    else
+    {
+        volatile global uchar* src = ( volatile global uchar* )slot;
+        uchar* dst = ( uchar* )&value;
+        for( uint b = 0; b < sizeof( T ); ++b )
+            dst[ b ] = src[ b ];
+    }
+    return value;
+}
+
+// Publishes value as the entry of tile, with the status that tells which of the two arrays values is
+template< typename T >
+void publishTile( global T* values, global int* tileStatus, size_t tile, T value, int status )
+{
+    storePublished( &values[ tile ], value );
+    mem_fence( CLK_GLOBAL_MEM_FENCE );
+    atomic_xchg( &tileStatus[ tile ], status );
+}
+
+// Combines the values published by the tiles before tile, walking back until one that has published its inclusive
+// prefix.  Tile 0 always ends in TILE_STATUS_PREFIX, so the walk stops before running off the front.
+template< typename T, typename BinaryFunction >
+T lookBack( global T* tileAggregate, global T* tileInclusive, global int* tileStatus, size_t tile,
+            global BinaryFunction* binaryOp )
+{
+    size_t look = tile - 1;
+    int status;
+    do { status = atomic_or( &tileStatus[ look ], 0 ); } while( status == TILE_STATUS_INVALID );
+    mem_fence( CLK_GLOBAL_MEM_FENCE );
+    T prefix = loadPublished( ( status == TILE_STATUS_PREFIX ) ? &tileInclusive[ look ] : &tileAggregate[ look ] );
+    while( status != TILE_STATUS_PREFIX )
+    {
+        --look;
+        do { status = atomic_or( &tileStatus[ look ], 0 ); } while( status == TILE_STATUS_INVALID );
+        mem_fence( CLK_GLOBAL_MEM_FENCE );
+        T y = loadPublished( ( status == TILE_STATUS_PREFIX ) ? &tileInclusive[ look ] : &tileAggregate[ look ] );
+        prefix = (*binaryOp)( y, prefix );
+    }
+    return prefix;
+}
+
+// The body of singlePassScan and singlePassTransformScan once a tile of 2 elements per work item is loaded into lds:
+// scans the tile, takes its prefix from the tiles before it, and leaves the inclusive or exclusive results in lds.
+// The exclusive result of an element is computed directly as the carry into it, not by shifting the inclusive one.
+template< typename T, typename initType, typename BinaryFunction >
+void scanTileDecoupled(
+                local T* lds,
+                size_t tile,
+                size_t base,
+                const uint vecSize,
+                initType identity,
+                int exclusive,
+                global BinaryFunction* binaryOp,
+                global T* tileAggregate,
+                global T* tileInclusive,
+                global int* tileStatus )
+{
+    size_t locId = get_local_id( 0 );
+    size_t wgSize = get_local_size( 0 );
+    size_t tileSize = wgSize * 2;
+
+    // every work item reduces its pair, then the work-group scans the pair sums
+    T a0 = lds[ 2 * locId ];
+    T a1 = lds[ 2 * locId + 1 ];
+    T sum = a0;
+    if( base + 2 * locId + 1 < vecSize )
+        sum = (*binaryOp)( a0, a1 );
+    barrier( CLK_LOCAL_MEM_FENCE );
+    lds[ locId ] = sum;
+    for( size_t offset = 1; offset < wgSize; offset *= 2 )
+    {
+        barrier( CLK_LOCAL_MEM_FENCE );
+        if( locId >= offset )
+        {
+            T y = lds[ locId - offset ];
+            sum = (*binaryOp)( y, sum );
+        }
+        barrier( CLK_LOCAL_MEM_FENCE );
+        lds[ locId ] = sum;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    if( locId == 0 )
+    {
+        size_t lastItem = ( vecSize - base < tileSize ) ? ( vecSize - base - 1 ) : ( tileSize - 1 );
+        T aggregate = lds[ lastItem / 2 ];
+
+        if( tile == 0 )
+        {
+            // an exclusive scan seeds the first tile with identity
+            T seed = identity;
+            publishTile( tileInclusive, tileStatus, 0, exclusive ? (*binaryOp)( seed, aggregate ) : aggregate,
+                TILE_STATUS_PREFIX );
+            lds[ wgSize ] = seed;
+        }
+        else
+        {
+            publishTile( tileAggregate, tileStatus, tile, aggregate, TILE_STATUS_AGGREGATE );
+            T prefix = lookBack( tileAggregate, tileInclusive, tileStatus, tile, binaryOp );
+            publishTile( tileInclusive, tileStatus, tile, (*binaryOp)( prefix, aggregate ), TILE_STATUS_PREFIX );
+            lds[ wgSize ] = prefix;
+        }
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    // prefix of everything before this work item's pair, which is the exclusive result of its first element
+    T carry = lds[ wgSize ];
+    int haveCarry = ( tile > 0 ) || exclusive;
+    if( locId > 0 )
+    {
+        T y = lds[ locId - 1 ];
+        carry = haveCarry ? (*binaryOp)( carry, y ) : y;
+        haveCarry = 1;
+    }
+    T r0 = haveCarry ? (*binaryOp)( carry, a0 ) : a0;
+    T r1 = (*binaryOp)( r0, a1 );
+    if( exclusive )
+    {
+        r1 = r0;
+        r0 = carry;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+    lds[ 2 * locId ] = r0;
+    lds[ 2 * locId + 1 ] = r1;
+    barrier( CLK_LOCAL_MEM_FENCE );
+}
@@ -33,10 +33,10 @@ void scatterIfTemplate (
             stencilIterType stencil,
             global oType* output_naked,
             oIterType output,
-            const uint length,
+            const BOLT_INDEX_T length,
             global Predicate* pred )
 {
-    int gid = get_global_id( 0 );
+    BOLT_INDEX_T gid = get_global_id( 0 );
     if ( gid >= length ) return;
 
     input.init( input_naked );
@@ -69,9 +69,9 @@ void scatterTemplate (
             mapIterType map,
             global oType* output_naked,
             oIterType output,
-            const uint length )
+            const BOLT_INDEX_T length )
 {
-    int gid = get_global_id( 0 );
+    BOLT_INDEX_T gid = get_global_id( 0 );
     if ( gid >= length ) return;
 
     input.init( input_naked );
@@ -0,0 +1,200 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_SEGMENTED_SORT_H )
+#define BOLT_CL_SEGMENTED_SORT_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+
+#include <string>
+
+/*! \file bolt/cl/segmented_sort.h
+    \brief Sorts every segment of a range independently.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup sorting
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-segmented_sort
+        *   \ingroup sorting
+        *   \{
+        */
+
+       /*! \brief \p segmented_sort sorts each segment of [first, last) on its own. Segment i starts at
+         * first + offsets_first[ i ] and ends where segment i + 1 starts; the last segment ends at \p last.
+         *
+         * \details The offsets must be non-decreasing and lie in [0, last - first]; elements before the first
+         * offset are left alone. All segments are sorted by a few launches, grouped by size: segments of up to 32
+         * elements are insertion sorted by one work item each, segments that fit in local memory are bitonic
+         * sorted by one work-group each, in launches per power of two size, and longer segments go through
+         * \p sort. Like \p sort, the order of equal elements is not preserved: the bitonic networks of the OpenCL
+         * path are not stable, and the host paths use std::sort, so equal elements may end up in a different order
+         * from one run mode to another.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the sequence.
+         * \param last The end of the sequence.
+         * \param offsets_first The offset of the first segment.
+         * \param offsets_last The end of the offsets; there is one offset per segment.
+         * \param comp \b Optional The comparison operation used to order the elements; bolt::cl::less by default.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam RandomAccessIterator is a model of RandomAccessIterator and is mutable
+         *  \tparam OffsetIterator is a model of InputIterator whose value type is an integral type
+         *  \tparam StrictWeakOrdering is a model of StrictWeakOrdering
+         *
+         *  \details The following code snippet demonstrates how to use \p segmented_sort
+         *
+         *  \code
+         *  #include <bolt/cl/segmented_sort.h>
+         *
+         *  int values[8] = {5, 7, 2, 3, 12, 6, 9, 8};
+         *  int offsets[3] = {0, 3, 4};
+         *  bolt::cl::segmented_sort( values, values + 8, offsets, offsets + 3 );
+         *
+         *  // values are now {2, 5, 7, 3, 6, 8, 9, 12}
+         *  \endcode
+         *
+         *  \sa sort
+         */
+
+        template< typename RandomAccessIterator,
+                  typename OffsetIterator >
+        void segmented_sort( bolt::cl::control &ctl,
+                             RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             OffsetIterator offsets_first,
+                             OffsetIterator offsets_last,
+                             const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator,
+                  typename OffsetIterator >
+        void segmented_sort( RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             OffsetIterator offsets_first,
+                             OffsetIterator offsets_last,
+                             const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator,
+                  typename OffsetIterator,
+                  typename StrictWeakOrdering >
+        void segmented_sort( bolt::cl::control &ctl,
+                             RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             OffsetIterator offsets_first,
+                             OffsetIterator offsets_last,
+                             StrictWeakOrdering comp,
+                             const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator,
+                  typename OffsetIterator,
+                  typename StrictWeakOrdering >
+        void segmented_sort( RandomAccessIterator first,
+                             RandomAccessIterator last,
+                             OffsetIterator offsets_first,
+                             OffsetIterator offsets_last,
+                             StrictWeakOrdering comp,
+                             const std::string& cl_code="" );
+
+       /*! \brief \p segmented_sort_by_key sorts the keys of each segment of [keys_first, keys_last) on their own
+         * and moves the values along with them.
+         *
+         * \details The segments are those of \p segmented_sort. Long segments go through \p sort_by_key. The sort is
+         * not stable on any path, and the OpenCL path orders the values of equal keys differently from the host
+         * paths; to keep equal keys in input order, make the position of the element part of its key.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param keys_first The beginning of the keys.
+         * \param keys_last The end of the keys.
+         * \param values_first The beginning of the values.
+         * \param offsets_first The offset of the first segment.
+         * \param offsets_last The end of the offsets; there is one offset per segment.
+         * \param comp \b Optional The comparison operation used to order the keys; bolt::cl::less by default.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam RandomAccessIterator1 is a model of RandomAccessIterator and is mutable
+         *  \tparam RandomAccessIterator2 is a model of RandomAccessIterator and is mutable
+         *  \tparam OffsetIterator is a model of InputIterator whose value type is an integral type
+         *  \tparam StrictWeakOrdering is a model of StrictWeakOrdering
+         *
+         *  \sa sort_by_key
+         */
+
+        template< typename RandomAccessIterator1,
+                  typename RandomAccessIterator2,
+                  typename OffsetIterator >
+        void segmented_sort_by_key( bolt::cl::control &ctl,
+                                    RandomAccessIterator1 keys_first,
+                                    RandomAccessIterator1 keys_last,
+                                    RandomAccessIterator2 values_first,
+                                    OffsetIterator offsets_first,
+                                    OffsetIterator offsets_last,
+                                    const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator1,
+                  typename RandomAccessIterator2,
+                  typename OffsetIterator >
+        void segmented_sort_by_key( RandomAccessIterator1 keys_first,
+                                    RandomAccessIterator1 keys_last,
+                                    RandomAccessIterator2 values_first,
+                                    OffsetIterator offsets_first,
+                                    OffsetIterator offsets_last,
+                                    const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator1,
+                  typename RandomAccessIterator2,
+                  typename OffsetIterator,
+                  typename StrictWeakOrdering >
+        void segmented_sort_by_key( bolt::cl::control &ctl,
+                                    RandomAccessIterator1 keys_first,
+                                    RandomAccessIterator1 keys_last,
+                                    RandomAccessIterator2 values_first,
+                                    OffsetIterator offsets_first,
+                                    OffsetIterator offsets_last,
+                                    StrictWeakOrdering comp,
+                                    const std::string& cl_code="" );
+
+        template< typename RandomAccessIterator1,
+                  typename RandomAccessIterator2,
+                  typename OffsetIterator,
+                  typename StrictWeakOrdering >
+        void segmented_sort_by_key( RandomAccessIterator1 keys_first,
+                                    RandomAccessIterator1 keys_last,
+                                    RandomAccessIterator2 values_first,
+                                    OffsetIterator offsets_first,
+                                    OffsetIterator offsets_last,
+                                    StrictWeakOrdering comp,
+                                    const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/segmented_sort.inl>
+#endif
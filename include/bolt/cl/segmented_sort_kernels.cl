@@ -0,0 +1,152 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+/******************************************************************************
+ *  Segmented sort.  The host groups the segments by length and passes the begin and
+ *  end of every segment as consecutive pairs in segments; a launch sorts the segments of
+ *  one group, which start at firstSegment:
+ *      segmentedSortSerial - one work item per segment of at most SEGSORT_SERIAL_MAX
+ *                            elements, insertion sort in place
+ *      segmentedSortLocal  - one work-group per segment that fits in tileSize elements,
+ *                            a power of two; the keys ( and values ) are staged in local
+ *                            memory and a bitonic network sorts their positions
+ *  Without values, values_iter repeats keys_iter and is not touched.
+ *****************************************************************************/
+
+#define SEGSORT_WG_SIZE         256
+#define SEGSORT_SERIAL_MAX      32
+
+template< typename kType, typename kIterType, typename vType, typename vIterType, typename StrictWeakOrdering >
+kernel void segmentedSortSerial( global kType* keys_ptr,
+                                 kIterType keys_iter,
+                                 global vType* values_ptr,
+                                 vIterType values_iter,
+                                 global const uint* segments,
+                                 const uint firstSegment,
+                                 const uint numSegments,
+                                 global StrictWeakOrdering* comp,
+                                 const int hasValues )
+{
+    keys_iter.init( keys_ptr );
+    values_iter.init( values_ptr );
+
+    if( get_global_id( 0 ) >= numSegments )
+        return;
+    uint segment = firstSegment + get_global_id( 0 );
+
+    uint begin = segments[ 2 * segment ];
+    uint end = segments[ 2 * segment + 1 ];
+    for( uint i = begin + 1; i < end; ++i )
+    {
+        kType key = keys_iter[ i ];
+        vType value;
+        if( hasValues )
+            value = values_iter[ i ];
+
+        uint j = i;
+        while( j > begin && (*comp)( key, keys_iter[ j - 1 ] ) )
+        {
+            keys_iter[ j ] = keys_iter[ j - 1 ];
+            if( hasValues )
+                values_iter[ j ] = values_iter[ j - 1 ];
+            --j;
+        }
+
+        keys_iter[ j ] = key;
+        if( hasValues )
+            values_iter[ j ] = value;
+    }
+}
+
+/*  Positions at or past count are padding and order after every element  */
+template< typename kType, typename StrictWeakOrdering >
+inline bool segmentedSortLess( local kType* keys, uint a, uint b, uint count, global StrictWeakOrdering* comp )
+{
+    if( a >= count )
+        return false;
+    if( b >= count )
+        return true;
+    return (*comp)( keys[ a ], keys[ b ] );
+}
+
+template< typename kType, typename kIterType, typename vType, typename vIterType, typename StrictWeakOrdering >
+kernel void segmentedSortLocal( global kType* keys_ptr,
+                                kIterType keys_iter,
+                                global vType* values_ptr,
+                                vIterType values_iter,
+                                global const uint* segments,
+                                const uint firstSegment,
+                                const uint tileSize,
+                                global StrictWeakOrdering* comp,
+                                const int hasValues,
+                                local kType* localKeys,
+                                local vType* localValues,
+                                local uint* localOrder )
+{
+    keys_iter.init( keys_ptr );
+    values_iter.init( values_ptr );
+
+    uint lid = get_local_id( 0 );
+    uint segment = firstSegment + get_group_id( 0 );
+    uint begin = segments[ 2 * segment ];
+    uint count = segments[ 2 * segment + 1 ] - begin;
+
+    for( uint i = lid; i < tileSize; i += SEGSORT_WG_SIZE )
+    {
+        if( i < count )
+        {
+            localKeys[ i ] = keys_iter[ begin + i ];
+            if( hasValues )
+                localValues[ i ] = values_iter[ begin + i ];
+        }
+        localOrder[ i ] = i;
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    //  Bitonic sort of the positions; every pair of a step is handled by the work item of its lower position
+    for( uint k = 2; k <= tileSize; k <<= 1 )
+    {
+        for( uint j = k >> 1; j > 0; j >>= 1 )
+        {
+            for( uint i = lid; i < tileSize; i += SEGSORT_WG_SIZE )
+            {
+                uint ixj = i ^ j;
+                if( ixj > i )
+                {
+                    uint a = localOrder[ i ];
+                    uint b = localOrder[ ixj ];
+                    bool swap = ( ( i & k ) == 0 ) ? segmentedSortLess( localKeys, b, a, count, comp )
+                                                   : segmentedSortLess( localKeys, a, b, count, comp );
+                    if( swap )
+                    {
+                        localOrder[ i ] = b;
+                        localOrder[ ixj ] = a;
+                    }
+                }
+            }
+            barrier( CLK_LOCAL_MEM_FENCE );
+        }
+    }
+
+    for( uint i = lid; i < count; i += SEGSORT_WG_SIZE )
+    {
+        uint from = localOrder[ i ];
+        keys_iter[ begin + i ] = localKeys[ from ];
+        if( hasValues )
+            values_iter[ begin + i ] = localValues[ from ];
+    }
+}
@@ -145,6 +145,44 @@ namespace bolt {
             StrictWeakOrdering comp,
             const std::string& cl_code="");
 
+        /*! \brief This version of \p sort arranges the elements in ascending order of bits [ \p begin_bit,
+        * \p end_bit ) of each key, so that keys known to use only their low bits are sorted in fewer radix passes.
+        *
+        * \details Integer and floating point keys of 32 and 64 bits are accepted.  The bits are those of the order
+        * preserving unsigned image of the key: unsigned keys as they are, signed keys with the sign bit flipped, and
+        * floating point keys with the sign bit flipped for positive values and every bit flipped for negative ones.
+        * Sorting [ 0, 8 * sizeof( key ) ) is therefore the same as sorting with bolt::cl::less.  Keys that compare
+        * equal on the selected bits keep their relative order.
+        *
+        * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc. See bolt::cl::control.
+        * \param first The first position in the sequence to be sorted.
+        * \param last  The last position in the sequence to be sorted.
+        * \param begin_bit The least significant bit that takes part in the comparison.
+        * \param end_bit One past the most significant bit that takes part in the comparison.
+        * \return The sorted data that is available in place.
+        *
+        * \code
+        * #include <bolt/cl/sort.h>
+        *
+        * //  Identifiers below 2^20 need 20 bits: 3 passes of 8 bits instead of 4
+        * bolt::cl::device_vector< cl_uint > ids( ... );
+        * bolt::cl::sort( ids.begin( ), ids.end( ), 0, 20 );
+        *
+        *  \endcode
+        */
+        template<typename RandomAccessIterator>
+        void sort(bolt::cl::control &ctl,
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            int begin_bit,
+            int end_bit);
+
+        template<typename RandomAccessIterator>
+        void sort(RandomAccessIterator first,
+            RandomAccessIterator last,
+            int begin_bit,
+            int end_bit);
+
 
         /*!   \}  */
 
@@ -27,229 +27,137 @@
 
 // #pragma OPENCL EXTENSION cl_amd_printf : enable
 
-//  This implements a linear search routine to look for an 'insertion point' in a sequence, denoted
-//  by a base pointer and a left and right index, with a  candidate value.  The comparison operator is 
-//  passed as a functor parameter lessOp
-//  This function returns an index that would be the appropriate index to use to insert the value
-template< typename sType, typename StrictWeakOrdering >
-uint lowerBoundLinear( global sType* data, uint left, uint right, sType searchVal, global StrictWeakOrdering* lessOp )
+//  This file is compiled behind merge_kernels.cl and uses its merge path helpers ( mergePathGlobal,
+//  mergePathLocal, mergeSerial, mergePathTile ) and its MERGE_WG_SIZE / MERGE_VT / MERGE_TILE settings.
+
+//  This kernel sorts each tile of MERGE_TILE elements in local memory.  Every work item first sorts its
+//  own MERGE_VT elements with an insertion sort, then sorted runs are merged pairwise through local memory,
+//  doubling in width until one run covers the tile.  Both steps are stable.
+template< typename dPtrType, typename dIterType, typename StrictWeakOrdering >
+kernel void blockMergeSortTemplate( 
+                global dPtrType* data_ptr,
+                dIterType    data_iter, 
+                const uint vecSize,
+                local dPtrType* lds,
+                global StrictWeakOrdering* lessOp
+            )
 {
-    //  The values firstIndex and lastIndex get modified within the loop, narrowing down the potential sequence
-    uint firstIndex = left;
-    uint lastIndex = right;
-    
-    //  This loops through [firstIndex, lastIndex)
-    //  Since firstIndex and lastIndex will be different for every thread depending on the nested branch,
-    //  this while loop will be divergent within a wavefront
-    while( firstIndex < lastIndex )
-    {
-        sType dataVal = data[ firstIndex ];
-        
-        //  This branch will create divergent wavefronts
-        if( (*lessOp)( dataVal, searchVal ) )
-        {
-            firstIndex = firstIndex+1;
-        }
-        else
-        {
-            break;
-        }
-    }
+    int locId     = get_local_id( 0 );
+    int tileStart = get_group_id( 0 ) * MERGE_TILE;
+    int count     = min( MERGE_TILE, (int)vecSize - tileStart );
 
-    return firstIndex;
-}
+    data_iter.init( data_ptr );
 
-//  This implements a binary search routine to look for an 'insertion point' in a sequence, denoted
-//  by a base pointer and left and right index for a particular candidate value.  The comparison operator is 
-//  passed as a functor parameter lessOp
-//  This function returns an index that is the first index whos value would be equal to the searched value
-template< typename sType, typename StrictWeakOrdering >
-uint lowerBoundBinary( global sType* data, uint left, uint right, sType searchVal, global StrictWeakOrdering* lessOp )
-{
-    //  The values firstIndex and lastIndex get modified within the loop, narrowing down the potential sequence
-    uint firstIndex = left;
-    uint lastIndex = right;
-    
-    //  This loops through [firstIndex, lastIndex)
-    //  Since firstIndex and lastIndex will be different for every thread depending on the nested branch,
-    //  this while loop will be divergent within a wavefront
-    while( firstIndex < lastIndex )
+    for( int i = locId; i < count; i += MERGE_WG_SIZE )
+        lds[ i ] = data_iter[ tileStart + i ];
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    int runBegin = min( locId * MERGE_VT, count );
+    int runEnd   = min( runBegin + MERGE_VT, count );
+    for( int currIndex = runBegin + 1; currIndex < runEnd; ++currIndex )
     {
-        //  midIndex is the average of first and last, rounded down
-        uint midIndex = ( firstIndex + lastIndex ) / 2;
-        sType midValue = data[ midIndex ];
-        
-        //  This branch will create divergent wavefronts
-        if( (*lessOp)( midValue, searchVal ) )
-        {
-            firstIndex = midIndex+1;
-             //printf( "lowerBound: lastIndex[ %i ]=%i\n", get_local_id( 0 ), lastIndex );
-        }
-        else
+        dPtrType val = lds[ currIndex ];
+        int scanIndex = currIndex;
+        while( scanIndex > runBegin )
         {
-            lastIndex = midIndex;
-             //printf( "lowerBound: firstIndex[ %i ]=%i\n", get_local_id( 0 ), firstIndex );
+            dPtrType ldsVal = lds[ scanIndex - 1 ];
+            if( !(*lessOp)( val, ldsVal ) )
+                break;
+            lds[ scanIndex ] = ldsVal;
+            --scanIndex;
         }
+        lds[ scanIndex ] = val;
     }
-    //printf("lowerBoundBinary: left=%d, right=%d, firstIndex=%d\n", left, right, firstIndex);
-    return firstIndex;
-}
+    barrier( CLK_LOCAL_MEM_FENCE );
 
-//  This implements a binary search routine to look for an 'insertion point' in a sequence, denoted
-//  by a base pointer and left and right index for a particular candidate value.  The comparison operator is 
-//  passed as a functor parameter lessOp
-//  This function returns an index that is the first index whos value would be greater than the searched value
-//  If the search value is not found in the sequence, upperbound returns the same result as lowerbound
-template< typename sType, typename StrictWeakOrdering >
-uint upperBoundBinary( global sType* data, uint left, uint right, sType searchVal, global StrictWeakOrdering* lessOp )
-{
-    uint upperBound = lowerBoundBinary( data, left, right, searchVal, lessOp );
-    
-     //printf( "start of upperBoundBinary: upperBound, left, right = [%d, %d, %d]\n", upperBound, left, right );
-    //  upperBound is always between left and right or equal to right
-    //  If upperBound == right, then  searchVal was not found in the sequence.  Just return.
-    if( upperBound != right )
+    dPtrType results[ MERGE_VT ];
+    for( int width = MERGE_VT; width < MERGE_TILE; width <<= 1 )
     {
-        //  While the values are equal i.e. !(x < y) && !(y < x) increment the index
-        uint mid = 0;
-        sType upperValue = data[ upperBound ];
-        //This loop is a kind of a specialized binary search. 
-        //This will find the first index location which is not equal to searchVal.
-        while( !(*lessOp)( upperValue, searchVal ) && !(*lessOp)( searchVal, upperValue) && (upperBound < right))
+        //  The MERGE_VT outputs of a work item always fall into a single pair of runs
+        int diag      = runBegin;
+        int pairStart = diag - diag % ( 2 * width );
+        int aEnd      = min( pairStart + width, count );
+        int bEnd      = min( pairStart + 2 * width, count );
+
+        int split = mergePathLocal( lds + pairStart, aEnd - pairStart, bEnd - aEnd, diag - pairStart, lessOp );
+        mergeSerial( lds, pairStart + split, aEnd, aEnd + diag - pairStart - split, bEnd,
+                     min( MERGE_VT, bEnd - diag ), results, lessOp );
+        barrier( CLK_LOCAL_MEM_FENCE );
+
+        for( int i = 0; i < MERGE_VT; ++i )
         {
-            mid = (upperBound + right)/2;
-            sType midValue = data[mid];
-            if( !(*lessOp)( midValue, searchVal ) && !(*lessOp)( searchVal, midValue) )
-            {
-                upperBound = mid + 1;
-            }   
-            else
-            {
-                right = mid;
-                upperBound++;
-            }
-            upperValue = data[ upperBound ];
-            //printf( "upperBoundBinary: upperBound, left, right = [%d, %d, %d]\n", upperBound, left, right);
+            if( diag + i < bEnd )
+                lds[ diag + i ] = results[ i ];
         }
+        barrier( CLK_LOCAL_MEM_FENCE );
     }
-    //printf( "end of upperBoundBinary: upperBound, left, right = [%d, %d, %d]\n", upperBound, left, right);
-    return upperBound;
+
+    for( int i = locId; i < count; i += MERGE_WG_SIZE )
+        data_iter[ tileStart + i ] = lds[ i ];
 }
 
-//  This kernel implements merging of blocks of sorted data.  The input to this kernel most likely is
-//  the output of blockInsertionSortTemplate.  It is expected that the source array contains multiple
-//  blocks, each block is independently sorted.  The goal is to write into the output buffer half as 
-//  many blocks, of double the size.  The even and odd blocks are stably merged together to form
-//  a new sorted block of twice the size.  The algorithm is out-of-place.
+//  Global merge passes, used once the sorted blocks are at least one tile wide.  Each pass merges pairs
+//  of srcBlockSize blocks; srcBlockSize is a multiple of MERGE_TILE, so no tile spans two pairs.
+//  This kernel finds where every tile starts in the A block of its pair, one work item per tile.
 template< typename sPtrType, typename dIterType, typename StrictWeakOrdering >
-kernel void mergeTemplate( 
+kernel void mergePassPartitionsTemplate( 
                 global sPtrType* source_ptr,
                 dIterType    source_iter, 
-                global sPtrType* result_ptr,
-                dIterType    result_iter, 
                 const uint srcVecSize,
-                const uint srcLogicalBlockSize,
-                local sPtrType* lds,
+                const uint srcBlockSize,
+                const uint numTiles,
+                global int* partitions,
                 global StrictWeakOrdering* lessOp
             )
 {
-    size_t globalID     = get_global_id( 0 );
-    size_t groupID      = get_group_id( 0 );
-    size_t localID      = get_local_id( 0 );
-    size_t wgSize       = get_local_size( 0 );
-
-    //  Abort threads that are passed the end of the input vector
-    if( globalID >= srcVecSize )
-        return; // on SI this doesn't mess-up barriers
-
-    //  For an element in sequence A, find the lowerbound index for it in sequence B
-    uint srcBlockNum = globalID / srcLogicalBlockSize;
-    uint srcBlockIndex = globalID % srcLogicalBlockSize;
-    
-    //printf( "mergeTemplate: srcBlockNum[%i]=%i\n", srcBlockNum, srcBlockIndex );
-
-    //  Pairs of even-odd blocks will be merged together 
-    //  An even block should search for an insertion point in the next odd block, 
-    //  and the odd block should look for an insertion point in the corresponding previous even block
-    uint dstLogicalBlockSize = srcLogicalBlockSize<<1;
-    uint leftBlockIndex = globalID & ~(dstLogicalBlockSize - 1 );
-    //printf("mergeTemplate: leftBlockIndex=%d\n", leftBlockIndex );
-    leftBlockIndex += (srcBlockNum & 0x1) ? 0 : srcLogicalBlockSize;
-    leftBlockIndex = min( leftBlockIndex, srcVecSize );
-    uint rightBlockIndex = min( leftBlockIndex + srcLogicalBlockSize, srcVecSize );
-    
-    //  For a particular element in the input array, find the lowerbound index for it in the search sequence given by leftBlockIndex & rightBlockIndex
-    // uint insertionIndex = lowerBoundLinear( source_ptr, leftBlockIndex, rightBlockIndex, source_ptr[ globalID ], lessOp ) - leftBlockIndex;
-    uint insertionIndex = 0;
-    if( (srcBlockNum & 0x1) == 0 )
-    {
-        insertionIndex = lowerBoundBinary( source_ptr, leftBlockIndex, rightBlockIndex, source_ptr[ globalID ], lessOp ) - leftBlockIndex;
-    }
-    else
-    {
-        insertionIndex = upperBoundBinary( source_ptr, leftBlockIndex, rightBlockIndex, source_ptr[ globalID ], lessOp ) - leftBlockIndex;
-    }
-    
-    //  The index of an element in the result sequence is the summation of it's indixes in the two input 
-    //  sequences
-    uint dstBlockIndex = srcBlockIndex + insertionIndex;
-    uint dstBlockNum = srcBlockNum/2;
-    
-    result_ptr[ (dstBlockNum*dstLogicalBlockSize)+dstBlockIndex ] = source_ptr[ globalID ];
+    uint tile = get_global_id( 0 );
+    if( tile >= numTiles )
+        return;
+
+    source_iter.init( source_ptr );
+
+    uint tileStart = tile * MERGE_TILE;
+    uint pairStart = tileStart - tileStart % ( 2 * srcBlockSize );
+    uint aCount    = min( srcBlockSize, srcVecSize - pairStart );
+    uint bCount    = min( srcBlockSize, srcVecSize - pairStart - aCount );
+
+    partitions[ tile ] = mergePathGlobal< sPtrType >( source_iter, pairStart, aCount,
+                                                      source_iter, pairStart + aCount, bCount,
+                                                      tileStart - pairStart, lessOp );
 }
 
-template< typename dPtrType, typename dIterType, typename StrictWeakOrdering >
-kernel void blockInsertionSortTemplate( 
-                global dPtrType* data_ptr,
-                dIterType    data_iter, 
-                const uint vecSize,
-                local dPtrType* lds,
+//  One work-group per tile of the output
+template< typename sPtrType, typename dIterType, typename StrictWeakOrdering >
+kernel void mergePassTemplate( 
+                global sPtrType* source_ptr,
+                dIterType    source_iter, 
+                global sPtrType* result_ptr,
+                dIterType    result_iter, 
+                const uint srcVecSize,
+                const uint srcBlockSize,
+                global const int* partitions,
+                local sPtrType* lds,
                 global StrictWeakOrdering* lessOp
             )
 {
-    size_t gloId    = get_global_id( 0 );
-    size_t groId    = get_group_id( 0 );
-    size_t locId    = get_local_id( 0 );
-    size_t wgSize   = get_local_size( 0 );
-
-    //  Abort threads that are passed the end of the input vector
-    if (gloId >= vecSize) return; // on SI this doesn't mess-up barriers
-
-    data_iter.init( data_ptr );
-
-    //  Make a copy of the entire input array into fast local memory
-    dPtrType val = data_iter[ gloId ];
-    lds[ locId ] = val;
-    barrier( CLK_LOCAL_MEM_FENCE );
-
-    //  Sorts a workgroup using a naive insertion sort
-    //  The sort uses one thread within a workgroup to sort the entire workgroup
-    if( locId == 0 )
-    {
-        //  The last workgroup may have an irregular size, so we calculate a per-block endIndex
-        //  endIndex is essentially emulating a mod operator with subtraction and multiply
-        size_t endIndex = vecSize - ( groId * wgSize );
-        endIndex = min( endIndex, wgSize );
-
-        // printf( "Debug: endIndex[%i]=%i\n", groId, endIndex );
-
-        //  Indices are signed because the while loop will generate a -1 index inside of the max function
-        for( int currIndex = 1; currIndex < endIndex; ++currIndex )
-        {
-            val = lds[ currIndex ];
-            int scanIndex = currIndex;
-            dPtrType ldsVal = lds[scanIndex - 1];
-            while( scanIndex > 0 && (*lessOp)( val, ldsVal ) )
-            {
-                lds[ scanIndex ] = ldsVal;
-                scanIndex = scanIndex - 1;
-                ldsVal = lds[ max(0, scanIndex - 1) ];  // scanIndex-1 may be -1
-            }
-            lds[ scanIndex ] = val;
-        }
-    }
-    barrier( CLK_LOCAL_MEM_FENCE );
-
-    val = lds[ locId ];
-    data_iter[ gloId ] = val;
+    uint tile = get_group_id( 0 );
+
+    source_iter.init( source_ptr );
+    result_iter.init( result_ptr );
+
+    uint tileStart = tile * MERGE_TILE;
+    uint tileEnd   = min( tileStart + MERGE_TILE, srcVecSize );
+    uint pairStart = tileStart - tileStart % ( 2 * srcBlockSize );
+    uint aCount    = min( srcBlockSize, srcVecSize - pairStart );
+    uint bCount    = min( srcBlockSize, srcVecSize - pairStart - aCount );
+
+    //  The last tile of a pair ends where the pair ends, any other where the next tile begins
+    int a0 = partitions[ tile ];
+    int a1 = ( tileEnd < pairStart + aCount + bCount ) ? partitions[ tile + 1 ] : (int)aCount;
+    int b0 = (int)( tileStart - pairStart ) - a0;
+    int b1 = (int)( tileEnd - pairStart ) - a1;
+
+    mergePathTile( source_iter, (int)pairStart + a0, (int)pairStart + a1,
+                   source_iter, (int)( pairStart + aCount ) + b0, (int)( pairStart + aCount ) + b1,
+                   result_iter, (int)tileStart, lds, lessOp );
 }
@@ -15,6 +15,11 @@
 
 ***************************************************************************/                                                                                     
 
+//  REDUCE_WG_SIZE, the work-items of a work-group, is 64, 128 or 256 as set by the host from the tuning database
+#ifndef REDUCE_WG_SIZE
+#define REDUCE_WG_SIZE 256
+#endif
+
 #define _REDUCE_STEP(_LENGTH, _IDX, _W) \
     if ((_IDX < _W) && ((_IDX + _W) < _LENGTH)) {\
       oNakedType mine = scratch[_IDX];\
@@ -28,7 +33,7 @@ template< typename iNakedType, typename iIterType, typename oNakedType, typename
 kernel void transform_reduceTemplate(
     global iNakedType* input_ptr,
     iIterType input_iter,
-    const int length,
+    const BOLT_INDEX_T length,
     global unary_function* transformFunctor,
     const oNakedType init,
     global binary_function* reduceFunctor,
@@ -37,20 +42,21 @@ kernel void transform_reduceTemplate(
     local oNakedType* scratch
 )
 {
-    int gx = get_global_id( 0 );
-
-    //  Abort threads that are passed the end of the input vector
-    if( gx >= length )
-        return;
+    BOLT_INDEX_T gx = get_global_id( 0 );
 
     input_iter.init( input_ptr );
     // result_iter.init( result_ptr );
 
     //  Initialize the accumulator private variable with data from the input array
-    //  This essentially unrolls the loop below at least once
-    iNakedType inputReg = input_iter[gx];
-    oNakedType accumulator = (*transformFunctor)( inputReg );
-    gx += get_global_size( 0 );
+    //  This essentially unrolls the loop below at least once.  Work-items past the end of the input stay in the
+    //  kernel for the barriers below; the tail keeps their accumulator out of the reduction
+    oNakedType accumulator;
+    if( gx < length )
+    {
+        iNakedType inputReg = input_iter[gx];
+        accumulator = (*transformFunctor)( inputReg );
+        gx += get_global_size( 0 );
+    }
 
     // Loop sequentially over chunks of input vector, reducing an arbitrary size input
     // length into a length related to the number of workgroups
@@ -69,7 +75,7 @@ kernel void transform_reduceTemplate(
     barrier(CLK_LOCAL_MEM_FENCE);   
 
     //  Tail stops the last workgroup from reading past the end of the input vector
-    uint tail = length - (get_group_id(0) * get_local_size(0));
+    BOLT_INDEX_T tail = length - (get_group_id(0) * get_local_size(0));
     
     //for(int offset = get_local_size(0) / 2;
     //    offset > 0;
@@ -84,8 +90,12 @@ kernel void transform_reduceTemplate(
     //}
     // Parallel reduction within a given workgroup using local data store
     // to share values between workitems
+#if REDUCE_WG_SIZE > 128
     _REDUCE_STEP( tail, local_index, 128 );
+#endif
+#if REDUCE_WG_SIZE > 64
     _REDUCE_STEP( tail, local_index, 64 );
+#endif
     _REDUCE_STEP( tail, local_index, 32 );
     _REDUCE_STEP( tail, local_index, 16 );
     _REDUCE_STEP( tail, local_index,  8 );
@@ -98,3 +108,46 @@ kernel void transform_reduceTemplate(
         result_ptr[ get_group_id( 0 ) ] = scratch[ 0 ];
     }
 };
+
+//  Second pass: a single workgroup combines the per-workgroup results of transform_reduceTemplate with init, and
+//  leaves the final value in partials[0], so only one element has to leave the device
+template< typename oNakedType, typename binary_function >
+kernel void transform_reduceFinalTemplate(
+    global oNakedType* partials,
+    const int numPartials,
+    const oNakedType init,
+    global binary_function* reduceFunctor,
+    local oNakedType* scratch
+)
+{
+    int local_index = get_local_id( 0 );
+
+    //  Every partial is read into registers before the first barrier, so partials[0] can be overwritten at the end
+    oNakedType accumulator;
+    if( local_index < numPartials )
+    {
+        accumulator = partials[ local_index ];
+        for( int i = local_index + get_local_size( 0 ); i < numPartials; i += get_local_size( 0 ) )
+            accumulator = (*reduceFunctor)( accumulator, partials[ i ] );
+    }
+    scratch[ local_index ] = accumulator;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+#if REDUCE_WG_SIZE > 128
+    _REDUCE_STEP( numPartials, local_index, 128 );
+#endif
+#if REDUCE_WG_SIZE > 64
+    _REDUCE_STEP( numPartials, local_index, 64 );
+#endif
+    _REDUCE_STEP( numPartials, local_index, 32 );
+    _REDUCE_STEP( numPartials, local_index, 16 );
+    _REDUCE_STEP( numPartials, local_index,  8 );
+    _REDUCE_STEP( numPartials, local_index,  4 );
+    _REDUCE_STEP( numPartials, local_index,  2 );
+    _REDUCE_STEP( numPartials, local_index,  1 );
+
+    if( local_index == 0 )
+    {
+        partials[ 0 ] = (*reduceFunctor)( init, scratch[ 0 ] );
+    }
+};
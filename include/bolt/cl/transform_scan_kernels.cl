@@ -261,3 +261,58 @@ __kernel void perBlockAddition(
 
     output_iter[ gloId ] = sum;
 }
+
+/******************************************************************************
+ *  Single-pass transform scan with decoupled look-back
+ *****************************************************************************/
+// Same scheme as singlePassScan in scan_kernels.cl, with unaryOp applied as the tile is loaded
+template< typename iValueType, typename iIterType, typename oValueType, typename oIterType, typename initType,
+          typename UnaryFunction, typename BinaryFunction >
+__kernel void singlePassTransformScan(
+                global iValueType* input_ptr,
+                iIterType input_iter,
+                global oValueType* output_ptr,
+                oIterType output_iter,
+                initType identity,
+                const uint vecSize,
+                local oValueType* lds,
+                global UnaryFunction* unaryOp,
+                global BinaryFunction* binaryOp,
+                global oValueType* tileAggregate,
+                global oValueType* tileInclusive,
+                global int* tileStatus,
+                int exclusive )
+{
+    local uint tileId;
+    size_t locId = get_local_id( 0 );
+    size_t wgSize = get_local_size( 0 );
+    size_t tileSize = wgSize * 2;
+    input_iter.init( input_ptr );
+    output_iter.init( output_ptr );
+
+    if( locId == 0 )
+        tileId = atomic_inc( &tileStatus[ get_num_groups( 0 ) ] );
+    barrier( CLK_LOCAL_MEM_FENCE );
+    size_t tile = tileId;
+    size_t base = tile * tileSize;
+
+    // a tile only reads its own elements, so the scan may be done in place
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+        {
+            iValueType inVal = input_iter[ base + i ];
+            lds[ i ] = (*unaryOp)( inVal );
+        }
+    }
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    scanTileDecoupled( lds, tile, base, vecSize, identity, exclusive, binaryOp, tileAggregate, tileInclusive,
+        tileStatus );
+
+    for( size_t i = locId; i < tileSize; i += wgSize )
+    {
+        if( base + i < vecSize )
+            output_iter[ base + i ] = lds[ i ];
+    }
+}
@@ -0,0 +1,182 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#if !defined( BOLT_CL_UNIQUE_H )
+#define BOLT_CL_UNIQUE_H
+#pragma once
+
+#include "bolt/cl/bolt.h"
+#include "bolt/cl/device_vector.h"
+#include "bolt/cl/functional.h"
+#include "bolt/cl/pair.h"
+
+#include <string>
+
+/*! \file bolt/cl/unique.h
+    \brief Removes all but the first element of every run of equivalent elements.
+*/
+
+
+namespace bolt {
+    namespace cl {
+
+        /*! \addtogroup algorithms
+         */
+
+        /*! \addtogroup reordering
+        *   \ingroup algorithms
+        */
+
+        /*! \addtogroup CL-unique
+        *   \ingroup reordering
+        *   \{
+        */
+
+       /*! \brief \p unique removes all but the first element of every run of consecutive equivalent elements in
+         * [first, last). The remaining elements keep their relative order and are moved to the front of the range;
+         * the contents of the range past the returned iterator are unspecified.
+         *
+         * \details Runs on the compaction engine shared with \p copy_if; an element is kept when it is the first
+         * one or when \p binary_pred rejects it together with its predecessor.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param first The beginning of the sequence.
+         * \param last The end of the sequence.
+         * \param binary_pred \b Optional The predicate deciding whether two neighbours are equivalent;
+         *   bolt::cl::equal_to by default.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam ForwardIterator is a model of ForwardIterator
+         *  \tparam BinaryPredicate is a model of BinaryPredicate
+         *  \return The end of the remaining elements.
+         *
+         *  \details The following code snippet demonstrates how to use \p unique
+         *
+         *  \code
+         *  #include <bolt/cl/unique.h>
+         *
+         *  int a[8] = {1, 1, 2, 3, 3, 3, 1, 4};
+         *  int* end = bolt::cl::unique( a, a + 8 );
+         *
+         *  // a now starts with {1, 2, 3, 1, 4} and end == a + 5
+         *  \endcode
+         *
+         *  \sa http://www.sgi.com/tech/stl/unique.html
+         */
+
+        template< typename ForwardIterator >
+        ForwardIterator unique( bolt::cl::control &ctl,
+                                ForwardIterator first,
+                                ForwardIterator last,
+                                const std::string& cl_code="" );
+
+        template< typename ForwardIterator >
+        ForwardIterator unique( ForwardIterator first,
+                                ForwardIterator last,
+                                const std::string& cl_code="" );
+
+        template< typename ForwardIterator,
+                  typename BinaryPredicate >
+        ForwardIterator unique( bolt::cl::control &ctl,
+                                ForwardIterator first,
+                                ForwardIterator last,
+                                BinaryPredicate binary_pred,
+                                const std::string& cl_code="" );
+
+        template< typename ForwardIterator,
+                  typename BinaryPredicate >
+        ForwardIterator unique( ForwardIterator first,
+                                ForwardIterator last,
+                                BinaryPredicate binary_pred,
+                                const std::string& cl_code="" );
+
+       /*! \brief \p unique_by_key removes all but the first key of every run of consecutive equivalent keys in
+         * [keys_first, keys_last), together with the values that belong to the removed keys. The remaining keys and
+         * values keep their relative order and are moved to the front of their ranges.
+         *
+         * \param ctl \b Optional Control structure to control command-queue, debug, tuning, etc.See bolt::cl::control.
+         * \param keys_first The beginning of the key sequence.
+         * \param keys_last The end of the key sequence.
+         * \param values_first The beginning of the value sequence.
+         * \param binary_pred \b Optional The predicate deciding whether two neighbouring keys are equivalent;
+         *   bolt::cl::equal_to by default.
+         * \param cl_code Optional OpenCL&tm; code to be passed to the OpenCL compiler. The cl_code is inserted
+         *   first in the generated code, before the cl_code trait.
+         *
+         *  \tparam ForwardIterator1 is a model of ForwardIterator
+         *  \tparam ForwardIterator2 is a model of ForwardIterator
+         *  \tparam BinaryPredicate is a model of BinaryPredicate
+         *  \return A pair of the ends of the remaining keys and values.
+         *
+         *  \details The following code snippet demonstrates how to use \p unique_by_key
+         *
+         *  \code
+         *  #include <bolt/cl/unique.h>
+         *
+         *  int keys[7]   = {1, 1, 2, 3, 3, 3, 1};
+         *  int values[7] = {9, 8, 7, 6, 5, 4, 3};
+         *  bolt::cl::unique_by_key( keys, keys + 7, values );
+         *
+         *  // keys now start with {1, 2, 3, 1} and values with {9, 7, 6, 3}
+         *  \endcode
+         */
+
+        template< typename ForwardIterator1,
+                  typename ForwardIterator2 >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( bolt::cl::control &ctl,
+                       ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       const std::string& cl_code="" );
+
+        template< typename ForwardIterator1,
+                  typename ForwardIterator2 >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       const std::string& cl_code="" );
+
+        template< typename ForwardIterator1,
+                  typename ForwardIterator2,
+                  typename BinaryPredicate >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( bolt::cl::control &ctl,
+                       ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       BinaryPredicate binary_pred,
+                       const std::string& cl_code="" );
+
+        template< typename ForwardIterator1,
+                  typename ForwardIterator2,
+                  typename BinaryPredicate >
+        bolt::cl::pair< ForwardIterator1, ForwardIterator2 >
+        unique_by_key( ForwardIterator1 keys_first,
+                       ForwardIterator1 keys_last,
+                       ForwardIterator2 values_first,
+                       BinaryPredicate binary_pred,
+                       const std::string& cl_code="" );
+
+        /*!   \}  */
+    };
+};
+
+#include <bolt/cl/detail/unique.inl>
+#endif
@@ -0,0 +1,182 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+#include "common/stdafx.h"
+#include "common/myocl.h"
+#include <bolt/cl/async.h>
+#include <bolt/cl/device_vector.h>
+#include <bolt/cl/iterator/counting_iterator.h>
+#include "common/test_common.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+TEST( AsyncDeviceVector, ChainedCallsThenReduce )
+{
+    int length = 1<<16;
+    std::vector< int > hA( length ), hB( length ), hO( length );
+
+    std::fill( hA.begin( ), hA.end( ), 3 );
+    std::transform( hA.begin( ), hA.end( ), hB.begin( ), std::negate< int >( ) );
+    std::transform( hA.begin( ), hA.end( ), hB.begin( ), hO.begin( ), std::plus< int >( ) );
+    std::transform( hO.begin( ), hO.end( ), hB.begin( ), hO.begin( ), std::plus< int >( ) );
+    int stdSum = std::accumulate( hO.begin( ), hO.end( ), 7 );
+
+    bolt::cl::device_vector< int > dA( length ), dB( length ), dO( length );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+
+    //  No host wait between these; the queue orders them
+    bolt::cl::async::fill( ctl, dA.begin( ), dA.end( ), 3 );
+    bolt::cl::async::transform( ctl, dA.begin( ), dA.end( ), dB.begin( ), bolt::cl::negate< int >( ) );
+    bolt::cl::async::transform( ctl, dA.begin( ), dA.end( ), dB.begin( ), dO.begin( ), bolt::cl::plus< int >( ) );
+    bolt::cl::async::future< void > done = bolt::cl::async::transform( ctl, dO.begin( ), dO.end( ), dB.begin( ),
+        dO.begin( ), bolt::cl::plus< int >( ) );
+    bolt::cl::async::future< int > sum = bolt::cl::async::reduce( ctl, dO.begin( ), dO.end( ), 7,
+        bolt::cl::plus< int >( ) );
+
+    EXPECT_TRUE( done.valid( ) );
+    EXPECT_TRUE( sum.valid( ) );
+    EXPECT_EQ( stdSum, sum.get( ) );
+    EXPECT_TRUE( done.ready( ) );
+
+    done.wait( );
+    cmpArrays( hO, dO );
+}
+
+TEST( AsyncDeviceVector, CopyThenReduce )
+{
+    int length = 1<<12;
+    std::vector< float > hA( length );
+    for( int i = 0; i < length; ++i )
+        hA[ i ] = static_cast< float >( i % 17 );
+
+    bolt::cl::device_vector< float > dA( hA.begin( ), hA.end( ) ), dB( length );
+
+    bolt::cl::async::future< void > copied = bolt::cl::async::copy( dA.begin( ), dA.end( ), dB.begin( ) );
+    bolt::cl::async::future< float > sum = bolt::cl::async::reduce( dB.begin( ), dB.end( ), 0.0f );
+
+    EXPECT_FLOAT_EQ( std::accumulate( hA.begin( ), hA.end( ), 0.0f ), sum.get( ) );
+    //  get( ) is idempotent
+    EXPECT_FLOAT_EQ( std::accumulate( hA.begin( ), hA.end( ), 0.0f ), sum.get( ) );
+
+    copied.get( );
+    cmpArrays( hA, dB );
+}
+
+TEST( AsyncFancyIterator, ReduceCountingIterator )
+{
+    int length = 1025;
+    bolt::cl::counting_iterator< int > first( 0 );
+    bolt::cl::counting_iterator< int > last = first + length;
+
+    bolt::cl::async::future< int > sum = bolt::cl::async::reduce( first, last, 0 );
+
+    EXPECT_EQ( length * ( length - 1 ) / 2, sum.get( ) );
+}
+
+TEST( AsyncDeviceVector, ReduceByKeyCountStaysOnDevice )
+{
+    int length = 1<<16;
+    std::vector< int > hKeys( length ), hVals( length );
+    for( int i = 0; i < length; ++i )
+    {
+        hKeys[ i ] = i / 100;
+        hVals[ i ] = 1;
+    }
+    int segments = ( length + 99 ) / 100;
+
+    bolt::cl::device_vector< int > dKeys( hKeys.begin( ), hKeys.end( ) ), dVals( hVals.begin( ), hVals.end( ) );
+    bolt::cl::device_vector< int > dKOut( length ), dVOut( length );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+
+    bolt::cl::async::future< size_t > count = bolt::cl::async::reduce_by_key( ctl, dKeys.begin( ), dKeys.end( ),
+        dVals.begin( ), dKOut.begin( ), dVOut.begin( ) );
+    bolt::cl::async::future< int > total = bolt::cl::async::reduce( ctl, dVOut.begin( ),
+        dVOut.begin( ) + segments, 0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( static_cast< size_t >( segments ), count.get( ) );
+    EXPECT_EQ( length, total.get( ) );
+    int lastKey = dKOut[ segments - 1 ];
+    int lastCount = dVOut[ segments - 1 ];
+    EXPECT_EQ( segments - 1, lastKey );
+    EXPECT_EQ( length - 100 * ( segments - 1 ), lastCount );
+}
+
+TEST( AsyncStdVector, ReduceIsReadyOnReturn )
+{
+    std::vector< int > hA( 1000 );
+    std::fill( hA.begin( ), hA.end( ), 2 );
+
+    bolt::cl::async::future< int > sum = bolt::cl::async::reduce( hA.begin( ), hA.end( ), 0 );
+
+    EXPECT_TRUE( sum.ready( ) );
+    EXPECT_EQ( 2000, sum.get( ) );
+}
+
+TEST( AsyncStdVector, TransformResultsVisibleAfterGet )
+{
+    std::vector< int > hA( 1000 ), hO( 1000 ), stdO( 1000 );
+    std::fill( hA.begin( ), hA.end( ), 5 );
+    std::transform( hA.begin( ), hA.end( ), stdO.begin( ), std::negate< int >( ) );
+
+    bolt::cl::async::transform( hA.begin( ), hA.end( ), hO.begin( ), bolt::cl::negate< int >( ) ).get( );
+
+    cmpArrays( stdO, hO );
+}
+
+TEST( AsyncControl, WaitModeIsRestored )
+{
+    bolt::cl::device_vector< int > dA( 256 );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setWaitMode( bolt::cl::control::NiceWait );
+
+    bolt::cl::async::fill( ctl, dA.begin( ), dA.end( ), 1 ).wait( );
+    EXPECT_EQ( bolt::cl::control::NiceWait, ctl.getWaitMode( ) );
+
+    bolt::cl::async::reduce( ctl, dA.begin( ), dA.end( ), 0 ).get( );
+    EXPECT_EQ( bolt::cl::control::NiceWait, ctl.getWaitMode( ) );
+}
+
+TEST( AsyncControl, SerialCpuCompletesOnReturn )
+{
+    std::vector< int > hA( 300 );
+    std::fill( hA.begin( ), hA.end( ), 1 );
+    bolt::cl::device_vector< int > dA( hA.begin( ), hA.end( ) );
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+
+    bolt::cl::async::future< int > sum = bolt::cl::async::reduce( ctl, dA.begin( ), dA.end( ), 0 );
+    EXPECT_TRUE( sum.ready( ) );
+    EXPECT_EQ( 300, sum.get( ) );
+}
+
+TEST( AsyncFuture, DefaultIsNotValid )
+{
+    bolt::cl::async::future< int > value;
+    bolt::cl::async::future< void > done;
+
+    EXPECT_FALSE( value.valid( ) );
+    EXPECT_FALSE( done.valid( ) );
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest( &argc, &argv[ 0 ] );
+    return RUN_ALL_TESTS();
+}
@@ -457,6 +457,67 @@ TEST(MultiCoreCPU, MultiCoreAddDouble4)
 }
 #endif 
 
+TEST( VectorizedSearch, ManyRandomValues )
+{
+    int length = 100000;
+    int numValues = 5000;
+    std::vector< int > input( length );
+    std::vector< int > values( numValues );
+
+    for (int j = 0; j < length; j++)
+        input[j] = rand() % 20000;
+    for (int j = 0; j < numValues; j++)
+        values[j] = rand() % 22000 - 1000;
+    std::sort( input.begin(), input.end() );
+
+    std::vector< int > stdLower( numValues ), stdUpper( numValues ), stdFound( numValues );
+    for (int j = 0; j < numValues; j++)
+    {
+        stdLower[j] = (int)( std::lower_bound( input.begin(), input.end(), values[j] ) - input.begin() );
+        stdUpper[j] = (int)( std::upper_bound( input.begin(), input.end(), values[j] ) - input.begin() );
+        stdFound[j] = std::binary_search( input.begin(), input.end(), values[j] ) ? 1 : 0;
+    }
+
+    std::vector< int > boltLower( numValues ), boltUpper( numValues ), boltFound( numValues );
+    bolt::cl::lower_bound( input.begin(), input.end(), values.begin(), values.end(), boltLower.begin() );
+    bolt::cl::upper_bound( input.begin(), input.end(), values.begin(), values.end(), boltUpper.begin() );
+    bolt::cl::binary_search( input.begin(), input.end(), values.begin(), values.end(), boltFound.begin() );
+
+    cmpArrays( stdLower, boltLower );
+    cmpArrays( stdUpper, boltUpper );
+    cmpArrays( stdFound, boltFound );
+}
+
+TEST( VectorizedSearch, SortedValuesDeviceVectorGreater )
+{
+    int length = 65536;
+    int numValues = 4099;
+    std::vector< int > stdInput( length );
+    std::vector< int > stdValues( numValues );
+
+    for (int j = 0; j < length; j++)
+        stdInput[j] = rand() % 1000;
+    for (int j = 0; j < numValues; j++)
+        stdValues[j] = rand() % 1000;
+    std::sort( stdInput.begin(), stdInput.end(), std::greater< int >() );
+    std::sort( stdValues.begin(), stdValues.end(), std::greater< int >() );
+
+    bolt::cl::device_vector< int > boltInput( stdInput.begin(), stdInput.end() );
+    bolt::cl::device_vector< int > boltValues( stdValues.begin(), stdValues.end() );
+    bolt::cl::device_vector< int > boltResult( numValues );
+    std::vector< int > stdResult( numValues );
+
+    for (int j = 0; j < numValues; j++)
+        stdResult[j] = (int)( std::lower_bound( stdInput.begin(), stdInput.end(), stdValues[j],
+                                                std::greater< int >() ) - stdInput.begin() );
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    bolt::cl::lower_bound( ctl, boltInput.begin(), boltInput.end(), boltValues.begin(), boltValues.end(),
+                           boltResult.begin(), bolt::cl::greater< int >() );
+
+    cmpArrays( stdResult, boltResult );
+}
+
 TEST( DefaultGPU, Normal )
 {
     int length = 1025;
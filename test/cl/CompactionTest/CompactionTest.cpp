@@ -0,0 +1,208 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+***************************************************************************/
+
+#include "common/stdafx.h"
+#include "common/myocl.h"
+#include "common/test_common.h"
+
+#include "bolt/cl/functional.h"
+#include "bolt/miniDump.h"
+#include "bolt/cl/copy_if.h"
+#include "bolt/cl/remove.h"
+#include "bolt/cl/unique.h"
+#include "bolt/cl/partition.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+BOLT_FUNCTOR( is_odd,
+struct is_odd
+{
+    bool operator () ( const int x ) const
+    {
+        return ( ( x & 1 ) == 1 );
+    }
+};
+);
+
+BOLT_FUNCTOR( is_even_int,
+struct is_even_int
+{
+    bool operator () ( const int x ) const
+    {
+        return ( ( x & 1 ) == 0 );
+    }
+};
+);
+
+//  Sizes straddle the tile of 2048 elements so that partial tiles and the multi-pass tile scan are covered
+class CompactionIntegerVector: public ::testing::TestWithParam< int >
+{
+public:
+    CompactionIntegerVector( ): stdInput( GetParam( ) )
+    {
+        for( size_t i = 0; i < stdInput.size( ); ++i )
+            stdInput[ i ] = rand( ) % 1024;
+    }
+
+protected:
+    std::vector< int > stdInput;
+};
+
+TEST_P( CompactionIntegerVector, CopyIf )
+{
+    std::vector< int > stdResult( stdInput.size( ) ), boltResult( stdInput.size( ) );
+    std::vector< int >::iterator stdEnd = std::remove_copy_if( stdInput.begin( ), stdInput.end( ),
+                                                                stdResult.begin( ), is_even_int( ) );
+    std::vector< int >::iterator boltEnd = bolt::cl::copy_if( stdInput.begin( ), stdInput.end( ),
+                                                              boltResult.begin( ), is_odd( ) );
+
+    EXPECT_EQ( stdEnd - stdResult.begin( ), boltEnd - boltResult.begin( ) );
+    cmpArrays( stdResult, boltResult, stdEnd - stdResult.begin( ) );
+}
+
+TEST_P( CompactionIntegerVector, RemoveIfDeviceVector )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+
+    std::vector< int >::iterator stdEnd = std::remove_if( stdInput.begin( ), stdInput.end( ), is_odd( ) );
+    bolt::cl::device_vector< int >::iterator boltEnd = bolt::cl::remove_if( boltInput.begin( ), boltInput.end( ),
+                                                                            is_odd( ) );
+
+    EXPECT_EQ( stdEnd - stdInput.begin( ), boltEnd - boltInput.begin( ) );
+    cmpArrays( stdInput, boltInput, stdEnd - stdInput.begin( ) );
+}
+
+TEST_P( CompactionIntegerVector, Unique )
+{
+    //  Long runs of equal neighbours
+    std::sort( stdInput.begin( ), stdInput.end( ) );
+    std::vector< int > boltInput( stdInput );
+
+    std::vector< int >::iterator stdEnd = std::unique( stdInput.begin( ), stdInput.end( ) );
+    std::vector< int >::iterator boltEnd = bolt::cl::unique( boltInput.begin( ), boltInput.end( ) );
+
+    EXPECT_EQ( stdEnd - stdInput.begin( ), boltEnd - boltInput.begin( ) );
+    cmpArrays( stdInput, boltInput, stdEnd - stdInput.begin( ) );
+}
+
+TEST_P( CompactionIntegerVector, UniqueByKey )
+{
+    std::sort( stdInput.begin( ), stdInput.end( ) );
+    std::vector< int > boltKeys( stdInput );
+    std::vector< int > boltValues( stdInput.size( ) );
+    for( size_t i = 0; i < boltValues.size( ); ++i )
+        boltValues[ i ] = static_cast< int >( i );
+
+    //  The first value of every run of equal keys is kept
+    std::vector< int > stdKeys, stdValues;
+    for( size_t i = 0; i < stdInput.size( ); ++i )
+    {
+        if( i == 0 || stdInput[ i - 1 ] != stdInput[ i ] )
+        {
+            stdKeys.push_back( stdInput[ i ] );
+            stdValues.push_back( static_cast< int >( i ) );
+        }
+    }
+
+    bolt::cl::pair< std::vector< int >::iterator, std::vector< int >::iterator > boltEnd =
+        bolt::cl::unique_by_key( boltKeys.begin( ), boltKeys.end( ), boltValues.begin( ) );
+
+    EXPECT_EQ( stdKeys.size( ), static_cast< size_t >( boltEnd.first - boltKeys.begin( ) ) );
+    EXPECT_EQ( stdValues.size( ), static_cast< size_t >( boltEnd.second - boltValues.begin( ) ) );
+    cmpArrays( stdKeys, boltKeys, stdKeys.size( ) );
+    cmpArrays( stdValues, boltValues, stdValues.size( ) );
+}
+
+TEST_P( CompactionIntegerVector, StablePartition )
+{
+    std::vector< int > boltInput( stdInput );
+
+    std::vector< int >::iterator stdMid = std::stable_partition( stdInput.begin( ), stdInput.end( ), is_odd( ) );
+    std::vector< int >::iterator boltMid = bolt::cl::stable_partition( boltInput.begin( ), boltInput.end( ),
+                                                                       is_odd( ) );
+
+    EXPECT_EQ( stdMid - stdInput.begin( ), boltMid - boltInput.begin( ) );
+    cmpArrays( stdInput, boltInput );
+}
+
+TEST_P( CompactionIntegerVector, StablePartitionSerialCpu )
+{
+    std::vector< int > boltInput( stdInput );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+
+    std::vector< int >::iterator stdMid = std::stable_partition( stdInput.begin( ), stdInput.end( ), is_odd( ) );
+    std::vector< int >::iterator boltMid = bolt::cl::stable_partition( ctl, boltInput.begin( ), boltInput.end( ),
+                                                                       is_odd( ) );
+
+    EXPECT_EQ( stdMid - stdInput.begin( ), boltMid - boltInput.begin( ) );
+    cmpArrays( stdInput, boltInput );
+}
+
+#if defined( ENABLE_TBB )
+TEST_P( CompactionIntegerVector, StablePartitionMultiCoreCpu )
+{
+    std::vector< int > boltInput( stdInput );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::MultiCoreCpu );
+
+    std::vector< int >::iterator stdMid = std::stable_partition( stdInput.begin( ), stdInput.end( ), is_odd( ) );
+    std::vector< int >::iterator boltMid = bolt::cl::stable_partition( ctl, boltInput.begin( ), boltInput.end( ),
+                                                                       is_odd( ) );
+
+    EXPECT_EQ( stdMid - stdInput.begin( ), boltMid - boltInput.begin( ) );
+    cmpArrays( stdInput, boltInput );
+}
+#endif
+
+INSTANTIATE_TEST_CASE_P( CompactionRange, CompactionIntegerVector, ::testing::Values( 1, 31, 2048, 2049, 65535,
+                                                                                      1048577 ) );
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest( &argc, &argv[ 0 ] );
+
+    int retVal = RUN_ALL_TESTS( );
+
+    //  Reflection code to inspect how many tests failed in gTest
+    ::testing::UnitTest& unitTest = *::testing::UnitTest::GetInstance( );
+
+    unsigned int failedTests = 0;
+    for( int i = 0; i < unitTest.total_test_case_count( ); ++i )
+    {
+        const ::testing::TestCase& testCase = *unitTest.GetTestCase( i );
+        for( int j = 0; j < testCase.total_test_count( ); ++j )
+        {
+            const ::testing::TestInfo& testInfo = *testCase.GetTestInfo( j );
+            if( testInfo.result( )->Failed( ) )
+                ++failedTests;
+        }
+    }
+
+    //  Print helpful message at termination if we detect errors, to help users figure out what to do next
+    if( failedTests )
+    {
+        bolt::tout << _T( "\nFailed tests detected in test pass; please run test again with:" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_filter=<XXX> to select a specific failing test of interest" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_catch_exceptions=0 to generate minidump of failing test, or" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_break_on_failure to debug interactively with debugger" ) << std::endl;
+        bolt::tout << _T( "\t    (only on googletest assertion failures, not SEH exceptions)" ) << std::endl;
+    }
+
+    return retVal;
+}
@@ -24,6 +24,7 @@
 #include "bolt/cl/functional.h"
 #include "bolt/cl/device_vector.h"
 #include "bolt/cl/scan.h"
+#include "bolt/cl/transform.h"
 
 #include "bolt/unicode.h"
 #include "bolt/miniDump.h"
@@ -194,7 +195,8 @@ TEST_F( ReferenceControlTest, zeroMemory )
     myControl.acquireBuffer( 100 * sizeof( int ) );
 
     size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_LE( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.getBufferPoolStats( ).bytesResident );
 
     myControl.freeBuffers( );
     internalBuffSize = myControl.totalBufferSize( );
@@ -203,12 +205,16 @@ TEST_F( ReferenceControlTest, zeroMemory )
 
 TEST_F( ReferenceControlTest, acquire1Buffer )
 {
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
     bolt::cl::control::buffPointer myBuff = myControl.acquireBuffer( 100 * sizeof( int ) );
     cl_uint myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    //  400 bytes are served from the 512 byte size class
+    bolt::cl::control::bufferPoolStats after = myControl.getBufferPoolStats( );
+    EXPECT_EQ( before.misses + 1, after.misses );
+    EXPECT_EQ( 112, after.bytesWasted );
+    EXPECT_EQ( 512, myBuff->getInfo< CL_MEM_SIZE >( ) );
 }
 
 TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireSame )
@@ -218,12 +224,15 @@ TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireSame )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
     myBuff = myControl.acquireBuffer( 100 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireSmaller )
@@ -233,12 +242,15 @@ TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireSmaller )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
     myBuff = myControl.acquireBuffer( 99 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireBigger )
@@ -248,12 +260,16 @@ TEST_F( ReferenceControlTest, acquire1BufferReleaseAcquireBigger )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
+    //  Still fits the 512 byte size class, so the released buffer is reused
     myBuff = myControl.acquireBuffer( 101 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 404, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( ReferenceControlTest, acquire2BufferEqual )
@@ -266,8 +282,8 @@ TEST_F( ReferenceControlTest, acquire2BufferEqual )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 800, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 112, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( ReferenceControlTest, acquire2BufferBigger )
@@ -280,8 +296,8 @@ TEST_F( ReferenceControlTest, acquire2BufferBigger )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 804, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 108, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( ReferenceControlTest, acquire2BufferSmaller )
@@ -294,8 +310,8 @@ TEST_F( ReferenceControlTest, acquire2BufferSmaller )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 796, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 116, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( CopyControlTest, init )
@@ -310,7 +326,8 @@ TEST_F( CopyControlTest, zeroMemory )
     myControl.acquireBuffer( 100 * sizeof( int ) );
 
     size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_LE( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.getBufferPoolStats( ).bytesResident );
 
     myControl.freeBuffers( );
     internalBuffSize = myControl.totalBufferSize( );
@@ -319,12 +336,16 @@ TEST_F( CopyControlTest, zeroMemory )
 
 TEST_F( CopyControlTest, acquire1Buffer )
 {
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
     bolt::cl::control::buffPointer myBuff = myControl.acquireBuffer( 100 * sizeof( int ) );
     cl_uint myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    //  400 bytes are served from the 512 byte size class
+    bolt::cl::control::bufferPoolStats after = myControl.getBufferPoolStats( );
+    EXPECT_EQ( before.misses + 1, after.misses );
+    EXPECT_EQ( 112, after.bytesWasted );
+    EXPECT_EQ( 512, myBuff->getInfo< CL_MEM_SIZE >( ) );
 }
 
 TEST_F( CopyControlTest, acquire1BufferReleaseAcquireSame )
@@ -334,12 +355,15 @@ TEST_F( CopyControlTest, acquire1BufferReleaseAcquireSame )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
     myBuff = myControl.acquireBuffer( 100 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( CopyControlTest, acquire1BufferReleaseAcquireSmaller )
@@ -349,12 +373,15 @@ TEST_F( CopyControlTest, acquire1BufferReleaseAcquireSmaller )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
     myBuff = myControl.acquireBuffer( 99 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 400, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( CopyControlTest, acquire1BufferReleaseAcquireBigger )
@@ -364,12 +391,16 @@ TEST_F( CopyControlTest, acquire1BufferReleaseAcquireBigger )
     EXPECT_EQ( 1, myRefCount );
     myBuff.reset( );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
+    //  Still fits the 512 byte size class, so the released buffer is reused
     myBuff = myControl.acquireBuffer( 101 * sizeof( int ) );
     myRefCount = myBuff->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 404, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.hits + 1, myControl.getBufferPoolStats( ).hits );
 }
 
 TEST_F( CopyControlTest, acquire2BufferEqual )
@@ -382,8 +413,8 @@ TEST_F( CopyControlTest, acquire2BufferEqual )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 800, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 112, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( CopyControlTest, acquire2BufferBigger )
@@ -396,8 +427,8 @@ TEST_F( CopyControlTest, acquire2BufferBigger )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 804, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 108, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( CopyControlTest, acquire2BufferSmaller )
@@ -410,8 +441,31 @@ TEST_F( CopyControlTest, acquire2BufferSmaller )
     cl_uint myRefCount2 = myBuff2->getInfo< CL_MEM_REFERENCE_COUNT >( );
     EXPECT_EQ( 1, myRefCount2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 796, internalBuffSize );
+    EXPECT_NE( (*myBuff1)( ), (*myBuff2)( ) );
+    EXPECT_EQ( 112 + 116, myControl.getBufferPoolStats( ).bytesWasted );
+}
+
+TEST_F( CopyControlTest, acquireBufferHighWater )
+{
+    //  Idle buffers beyond the high-water mark are released as soon as they are returned to the pool
+    myControl.setBufferPoolHighWater( 1 );
+
+    bolt::cl::control::buffPointer myBuff = myControl.acquireBuffer( 100 * sizeof( int ) );
+    EXPECT_LE( 400, myControl.totalBufferSize( ) );
+
+    myBuff.reset( );
+    EXPECT_EQ( 0, myControl.totalBufferSize( ) );
+}
+
+TEST_F( CopyControlTest, acquireBufferHostPtrExactSize )
+{
+    //  Buffers wrapping host memory are never rounded up to a size class
+    std::vector< int > hostMem( 100 );
+    bolt::cl::control::buffPointer myBuff = myControl.acquireBuffer( 100 * sizeof( int ),
+        CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, &hostMem[ 0 ] );
+
+    EXPECT_EQ( 400, myBuff->getInfo< CL_MEM_SIZE >( ) );
+    EXPECT_EQ( 0, myControl.getBufferPoolStats( ).bytesWasted );
 }
 
 TEST_F( CopyControlTest, ScanIntegerVector )
@@ -425,11 +479,88 @@ TEST_F( CopyControlTest, ScanIntegerVector )
     bolt::cl::inclusive_scan( myControl, boltInput1.begin( ), boltInput1.end( ), boltInput1.begin( ) );
     cmpArrays( stdInput, boltInput1 );
 
+    size_t internalBuffSize = myControl.totalBufferSize( );
+    bolt::cl::control::bufferPoolStats before = myControl.getBufferPoolStats( );
+
+    //  The second scan is served entirely from the scratch buffers released by the first
     bolt::cl::inclusive_scan( myControl, boltInput2.begin( ), boltInput2.end( ), boltInput2.begin( ) );
     cmpArrays( stdInput, boltInput2 );
 
-    size_t internalBuffSize = myControl.totalBufferSize( );
-    EXPECT_EQ( 2049, internalBuffSize );
+    EXPECT_EQ( internalBuffSize, myControl.totalBufferSize( ) );
+    EXPECT_EQ( before.misses, myControl.getBufferPoolStats( ).misses );
+}
+
+TEST_F( CopyControlTest, ScanKernelCacheDir )
+{
+    bolt::cl::device_vector< int > boltInput1( 1024, 1 );
+    bolt::cl::device_vector< int > boltInput2( 1024, 1 );
+    std::vector< int > stdInput( 1024, 1 );
+
+    std::partial_sum( stdInput.begin( ), stdInput.end( ), stdInput.begin( ) );
+
+    //  First call compiles from source and writes the binary; after dropping the in-memory programs the second
+    //  call has to be served from the on-disk cache
+    myControl.setKernelCacheDir( "." );
+    bolt::cl::inclusive_scan( myControl, boltInput1.begin( ), boltInput1.end( ), boltInput1.begin( ) );
+    cmpArrays( stdInput, boltInput1 );
+
+    bolt::cl::clearProgramCache( );
+
+    bolt::cl::inclusive_scan( myControl, boltInput2.begin( ), boltInput2.end( ), boltInput2.begin( ) );
+    cmpArrays( stdInput, boltInput2 );
+}
+
+TEST_F( CopyControlTest, ScanProgramCacheCompileOptions )
+{
+    bolt::cl::device_vector< int > boltInput1( 1024, 1 );
+    bolt::cl::device_vector< int > boltInput2( 1024, 1 );
+    bolt::cl::device_vector< int > boltInput3( 1024, 1 );
+    std::vector< int > stdInput( 1024, 1 );
+
+    std::partial_sum( stdInput.begin( ), stdInput.end( ), stdInput.begin( ) );
+
+    //  The same call site must not hand back a program built with different compile options
+    bolt::cl::inclusive_scan( myControl, boltInput1.begin( ), boltInput1.end( ), boltInput1.begin( ) );
+    cmpArrays( stdInput, boltInput1 );
+
+    std::string testOptions( " -DBOLT_CONTROL_TEST_OPTION " );
+    myControl.setCompileOptions( testOptions );
+    bolt::cl::inclusive_scan( myControl, boltInput2.begin( ), boltInput2.end( ), boltInput2.begin( ) );
+    cmpArrays( stdInput, boltInput2 );
+
+    std::string noOptions;
+    myControl.setCompileOptions( noOptions );
+    bolt::cl::inclusive_scan( myControl, boltInput3.begin( ), boltInput3.end( ), boltInput3.begin( ) );
+    cmpArrays( stdInput, boltInput3 );
+}
+
+TEST_F( CopyControlTest, BalancedWaitStatistics )
+{
+    bolt::cl::device_vector< int > boltInput( 1024, 1 );
+    bolt::cl::device_vector< int > boltOutput( 1024, 0 );
+    std::vector< int > stdOutput( 1024, -1 );
+
+    EXPECT_EQ( bolt::cl::control::BalancedWait, bolt::cl::control::getDefault( ).getWaitMode( ) );
+
+    myControl.setWaitMode( bolt::cl::control::BalancedWait );
+    bolt::cl::resetWaitStatistics( );
+
+    //  The first wait spins for the default window; the second uses the window learned from the first
+    bolt::cl::transform( myControl, boltInput.begin( ), boltInput.end( ), boltOutput.begin( ),
+        bolt::cl::negate< int >( ) );
+    bolt::cl::transform( myControl, boltInput.begin( ), boltInput.end( ), boltOutput.begin( ),
+        bolt::cl::negate< int >( ) );
+    cmpArrays( stdOutput, boltOutput );
+
+    bolt::cl::waitStatistics stats = bolt::cl::getWaitStatistics( );
+    EXPECT_EQ( 2u, stats.spinWaits + stats.blockWaits );
+    EXPECT_LE( 0.0, stats.spinSeconds );
+    EXPECT_LE( 0.0, stats.blockSeconds );
+    if( stats.blockWaits == 0 )
+        EXPECT_EQ( 0.0, stats.blockSeconds );
+
+    bolt::cl::resetWaitStatistics( );
+    EXPECT_EQ( 0u, bolt::cl::getWaitStatistics( ).spinWaits + bolt::cl::getWaitStatistics( ).blockWaits );
 }
 
 int _tmain(int argc, _TCHAR* argv[])
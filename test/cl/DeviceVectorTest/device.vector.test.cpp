@@ -36,6 +36,7 @@
     #include "bolt/cl/functional.h"
     #include "bolt/cl/device_vector.h"
     #include "bolt/cl/fill.h"
+    #include "bolt/cl/aligned_allocator.h"
     #include "common/test_common.h"
     #define BCKND cl
 
@@ -842,6 +843,121 @@ TEST( Vector, DataRoutine )
     EXPECT_EQ( 0, pDa[50] );
 }
 
+#if !AMP_TESTS
+TEST( Vector, HostView )
+{
+    bolt::cl::device_vector< int > dV( 1000, 0 );
+
+    {
+        bolt::cl::device_vector< int >::host_view view( dV );
+        ASSERT_EQ( 1000, view.size( ) );
+        for( size_t i = 0; i < view.size( ); ++i )
+            view[ i ] = static_cast< int >( i );
+    }
+
+    bolt::cl::device_vector< int >::const_host_view part( dV, 100, 10 );
+    ASSERT_EQ( 10, part.size( ) );
+    EXPECT_EQ( 100, part[ 0 ] );
+    EXPECT_EQ( 109, *( part.end( ) - 1 ) );
+}
+
+TEST( Vector, HostMirror )
+{
+    bolt::cl::device_vector< int > dV( 1000, 0 );
+    dV.setHostMirror( true );
+
+    for( int i = 0; i < 1000; ++i )
+        dV[ i ] = i;
+    dV.push_back( 1000 );
+    EXPECT_EQ( 1001, dV.size( ) );
+    EXPECT_EQ( 500, dV[ 500 ] );
+
+    //  The writes reach the device before the buffer is used
+    {
+        bolt::cl::device_vector< int >::pointer pV = dV.data( );
+        for( int i = 0; i < 1001; ++i )
+            EXPECT_EQ( i, pV[ i ] );
+    }
+
+    //  And the mirror is read again once the vector has been used on the device
+    bolt::cl::fill( dV.begin( ), dV.end( ), 7 );
+    EXPECT_EQ( 7, dV[ 0 ] );
+    EXPECT_EQ( 7, dV.back( ) );
+}
+
+TEST( Vector, MoveKeepsBuffer )
+{
+    bolt::cl::device_vector< int > dV( 1024, 5 );
+    cl_mem original = dV.getBuffer( )( );
+
+    bolt::cl::device_vector< int > moved( std::move( dV ) );
+    EXPECT_EQ( original, moved.getBuffer( )( ) );
+    EXPECT_EQ( 1024, moved.size( ) );
+    EXPECT_EQ( 0, dV.size( ) );
+
+    std::vector< bolt::cl::device_vector< int > > stored;
+    stored.push_back( std::move( moved ) );
+    EXPECT_EQ( original, stored.front( ).getBuffer( )( ) );
+    EXPECT_EQ( 5, stored.front( )[ 1023 ] );
+}
+
+TEST( Vector, CopyAssignLeavesWrappedHostMemory )
+{
+    std::vector< int > host( 1024, 3 );
+    bolt::cl::device_vector< int > wrapped( host.begin( ), host.size( ), CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE );
+    cl_mem original = wrapped.getBuffer( )( );
+
+    bolt::cl::device_vector< int > dV( 1024, 5 );
+    wrapped = dV;
+    EXPECT_NE( original, wrapped.getBuffer( )( ) );
+    EXPECT_EQ( 1024, wrapped.size( ) );
+    EXPECT_EQ( 5, wrapped[ 1023 ] );
+
+    //  The host memory the old buffer wrapped was not written through
+    for( size_t i = 0; i < host.size( ); ++i )
+        EXPECT_EQ( 3, host[ i ] );
+}
+
+TEST( Vector, PushBackGrowsFromPool )
+{
+    bolt::cl::device_vector< int > dV;
+    for( int i = 0; i < 5000; ++i )
+        dV.push_back( i );
+
+    EXPECT_EQ( 5000, dV.size( ) );
+    EXPECT_LE( dV.size( ), dV.capacity( ) );
+    for( int i = 0; i < 5000; i += 499 )
+        EXPECT_EQ( i, dV[ i ] );
+
+    //  The buffers given up while growing went back to the pool, so growing a second vector reuses them
+    bolt::cl::control::bufferPoolStats before = bolt::cl::control::getDefault( ).getBufferPoolStats( );
+    bolt::cl::device_vector< int > dV2;
+    for( int i = 0; i < 1000; ++i )
+        dV2.push_back( i );
+    bolt::cl::control::bufferPoolStats after = bolt::cl::control::getDefault( ).getBufferPoolStats( );
+    EXPECT_LT( before.hits, after.hits );
+}
+
+TEST( Vector, HostPtrStatistics )
+{
+    std::vector< int, bolt::cl::aligned_allocator< int > > aligned( 1024, 1 );
+    EXPECT_EQ( 0, reinterpret_cast< size_t >( &aligned.front( ) ) % bolt::cl::zeroCopyAlignment );
+
+    bolt::cl::resetHostPtrStatistics( );
+    {
+        bolt::cl::device_vector< int > whole( aligned.begin( ), aligned.end( ), CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE );
+        bolt::cl::device_vector< int > offset( aligned.begin( ) + 1, aligned.end( ), CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE );
+        EXPECT_EQ( 1023, offset.size( ) );
+    }
+    bolt::cl::hostPtrStatistics stats = bolt::cl::getHostPtrStatistics( );
+
+    //  A range off the page boundary is copied whatever the device
+    EXPECT_EQ( 2, stats.zeroCopies + stats.implicitCopies );
+    EXPECT_LE( 1, stats.implicitCopies );
+    EXPECT_LE( 1023 * sizeof( int ), stats.implicitCopyBytes );
+}
+#endif
+
 TEST( DeviceVector, Swap )
 {
     bolt::BCKND::device_vector< int > dV( 5ul, 3 ), dV2(5ul, 10);
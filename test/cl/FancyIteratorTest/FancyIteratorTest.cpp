@@ -0,0 +1,256 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#include "common/stdafx.h"
+#include <vector>
+#include <numeric>
+
+#include "bolt/cl/iterator/counting_iterator.h"
+#include "bolt/cl/iterator/transform_iterator.h"
+#include "bolt/cl/iterator/zip_iterator.h"
+#include "bolt/cl/iterator/permutation_iterator.h"
+#include "bolt/cl/reduce.h"
+#include "bolt/cl/transform.h"
+#include "bolt/cl/functional.h"
+#include "bolt/miniDump.h"
+#include "bolt/unicode.h"
+
+#include <gtest/gtest.h>
+
+BOLT_FUNCTOR( twice,
+struct twice
+{
+    int operator( ) ( const int x ) const
+    {
+        return 2 * x;
+    }
+};
+);
+
+BOLT_FUNCTOR( pairProduct,
+struct pairProduct
+{
+    int operator( ) ( const bolt::cl::pair< int, int >& x ) const
+    {
+        return x.first * x.second;
+    }
+};
+);
+
+class FancyIterator: public ::testing::TestWithParam< int >
+{
+public:
+    FancyIterator( ): stdInput( GetParam( ) )
+    {
+        for( size_t i = 0; i < stdInput.size( ); ++i )
+            stdInput[ i ] = rand( ) % 64;
+    }
+
+protected:
+    std::vector< int > stdInput;
+};
+
+TEST_P( FancyIterator, ReduceOfTransform )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+
+    int stdSum = 0;
+    for( size_t i = 0; i < stdInput.size( ); ++i )
+        stdSum += stdInput[ i ] * stdInput[ i ];
+
+    int boltSum = bolt::cl::reduce( bolt::cl::make_transform_iterator( boltInput.begin( ), bolt::cl::square< int >( ) ),
+                                    bolt::cl::make_transform_iterator( boltInput.end( ), bolt::cl::square< int >( ) ),
+                                    0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+TEST_P( FancyIterator, ReduceOfTransformSerialCpu )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+
+    int stdSum = 0;
+    for( size_t i = 0; i < stdInput.size( ); ++i )
+        stdSum += stdInput[ i ] * stdInput[ i ];
+
+    int boltSum = bolt::cl::reduce( ctl,
+                                    bolt::cl::make_transform_iterator( boltInput.begin( ), bolt::cl::square< int >( ) ),
+                                    bolt::cl::make_transform_iterator( boltInput.end( ), bolt::cl::square< int >( ) ),
+                                    0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+//  Gather of every other element through computed indices, reduced in the same kernel
+TEST_P( FancyIterator, ReduceOfStridedPermutation )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    int numEven = static_cast< int >( ( stdInput.size( ) + 1 ) / 2 );
+
+    int stdSum = 0;
+    for( size_t i = 0; i < stdInput.size( ); i += 2 )
+        stdSum += stdInput[ i ];
+
+    bolt::cl::counting_iterator< int > index( 0 );
+    bolt::cl::transform_iterator< twice, bolt::cl::counting_iterator< int > > evenIndex =
+        bolt::cl::make_transform_iterator( index, twice( ) );
+
+    int boltSum = bolt::cl::reduce( bolt::cl::make_permutation_iterator( boltInput.begin( ), evenIndex ),
+                                    bolt::cl::make_permutation_iterator( boltInput.begin( ), evenIndex + numEven ),
+                                    0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+//  Weighted sum of the elements by their position, as a zip with a counting_iterator
+TEST_P( FancyIterator, ReduceOfZipWithCounting )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    int length = static_cast< int >( stdInput.size( ) );
+
+    int stdSum = 0;
+    for( int i = 0; i < length; ++i )
+        stdSum += stdInput[ i ] * i;
+
+    bolt::cl::counting_iterator< int > index( 0 );
+    int boltSum = bolt::cl::reduce(
+        bolt::cl::make_transform_iterator( bolt::cl::make_zip_iterator( boltInput.begin( ), index ), pairProduct( ) ),
+        bolt::cl::make_transform_iterator( bolt::cl::make_zip_iterator( boltInput.end( ), index + length ),
+                                           pairProduct( ) ),
+        0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+//  A zip over two device_vectors binds both buffers to the reduce kernel, so a forced OpenCL call runs as forced
+TEST_P( FancyIterator, ReduceOfZipOfTwoVectors )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    bolt::cl::device_vector< int > boltWeights( stdInput.size( ), 3 );
+    int length = static_cast< int >( stdInput.size( ) );
+
+    int stdSum = 0;
+    for( int i = 0; i < length; ++i )
+        stdSum += stdInput[ i ] * 3;
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::OpenCL );
+    int boltSum = bolt::cl::reduce( ctl,
+        bolt::cl::make_transform_iterator( bolt::cl::make_zip_iterator( boltInput.begin( ), boltWeights.begin( ) ),
+                                           pairProduct( ) ),
+        bolt::cl::make_transform_iterator( bolt::cl::make_zip_iterator( boltInput.end( ), boltWeights.end( ) ),
+                                           pairProduct( ) ),
+        0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+//  Gather through an index map in device memory, reduced in the same kernel
+TEST_P( FancyIterator, ReduceOfPermutationByIndexVector )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    size_t length = stdInput.size( );
+
+    std::vector< int > stdIndices( length / 2 + 1 );
+    int stdSum = 0;
+    for( size_t i = 0; i < stdIndices.size( ); ++i )
+    {
+        stdIndices[ i ] = static_cast< int >( length - 1 - i );
+        stdSum += stdInput[ stdIndices[ i ] ];
+    }
+    bolt::cl::device_vector< int > boltIndices( stdIndices.begin( ), stdIndices.end( ) );
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::OpenCL );
+    int boltSum = bolt::cl::reduce( ctl,
+                                    bolt::cl::make_permutation_iterator( boltInput.begin( ), boltIndices.begin( ) ),
+                                    bolt::cl::make_permutation_iterator( boltInput.begin( ), boltIndices.end( ) ),
+                                    0, bolt::cl::plus< int >( ) );
+
+    EXPECT_EQ( stdSum, boltSum );
+}
+
+//  The transform kernels take one buffer per iterator: a forced OpenCL call on a permutation over two buffers throws
+//  rather than run elsewhere, and an Automatic one reads it on the host
+TEST_P( FancyIterator, TransformOfPermutationByIndexVector )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    size_t length = stdInput.size( );
+
+    std::vector< int > stdIndices( length );
+    std::vector< int > stdOutput( length );
+    for( size_t i = 0; i < length; ++i )
+    {
+        stdIndices[ i ] = static_cast< int >( length - 1 - i );
+        stdOutput[ i ] = stdInput[ i ] + stdInput[ stdIndices[ i ] ];
+    }
+    bolt::cl::device_vector< int > boltIndices( stdIndices.begin( ), stdIndices.end( ) );
+    bolt::cl::device_vector< int > boltOutput( length );
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::OpenCL );
+    EXPECT_THROW( bolt::cl::transform( ctl, boltInput.begin( ), boltInput.end( ),
+                                       bolt::cl::make_permutation_iterator( boltInput.begin( ), boltIndices.begin( ) ),
+                                       boltOutput.begin( ), bolt::cl::plus< int >( ) ),
+                  ::cl::Error );
+
+    ctl.setForceRunMode( bolt::cl::control::Automatic );
+    bolt::cl::transform( ctl, boltInput.begin( ), boltInput.end( ),
+                         bolt::cl::make_permutation_iterator( boltInput.begin( ), boltIndices.begin( ) ),
+                         boltOutput.begin( ), bolt::cl::plus< int >( ) );
+
+    for( size_t i = 0; i < length; ++i )
+        EXPECT_EQ( stdOutput[ i ], boltOutput[ i ] );
+}
+
+INSTANTIATE_TEST_CASE_P( FancyIteratorRange, FancyIterator, ::testing::Values( 1, 255, 256, 4097, 1048576 ) );
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest( &argc, &argv[ 0 ] );
+
+    int retVal = RUN_ALL_TESTS( );
+
+    //  Reflection code to inspect how many tests failed in gTest
+    ::testing::UnitTest& unitTest = *::testing::UnitTest::GetInstance( );
+
+    unsigned int failedTests = 0;
+    for( int i = 0; i < unitTest.total_test_case_count( ); ++i )
+    {
+        const ::testing::TestCase& testCase = *unitTest.GetTestCase( i );
+        for( int j = 0; j < testCase.total_test_count( ); ++j )
+        {
+            const ::testing::TestInfo& testInfo = *testCase.GetTestInfo( j );
+            if( testInfo.result( )->Failed( ) )
+                ++failedTests;
+        }
+    }
+
+    //  Print helpful message at termination if we detect errors, to help users figure out what to do next
+    if( failedTests )
+    {
+        bolt::tout << _T( "\nFailed tests detected in test pass; please run test again with:" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_filter=<XXX> to select a specific failing test of interest" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_catch_exceptions=0 to generate minidump of failing test, or" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_break_on_failure to debug interactively with debugger" ) << std::endl;
+        bolt::tout << _T( "\t    (only on googletest assertion failures, not SEH exceptions)" ) << std::endl;
+    }
+
+    return retVal;
+}
@@ -0,0 +1,206 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+***************************************************************************/
+
+
+#include "common/stdafx.h"
+#include "common/myocl.h"
+#include "common/test_common.h"
+
+#include "bolt/cl/functional.h"
+#include "bolt/miniDump.h"
+#include "bolt/cl/histogram.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <limits>
+
+//  Reference counts of [lower, upper) split into numBins bins of equal width
+static std::vector< int > referenceHistogram( const std::vector< int >& input, size_t numBins, int lower, int upper )
+{
+    std::vector< int > bins( numBins, 0 );
+    for( size_t i = 0; i < input.size( ); ++i )
+    {
+        if( input[ i ] >= lower && input[ i ] < upper )
+            ++bins[ static_cast< size_t >( ( static_cast< long long >( input[ i ] ) - lower ) * numBins /
+                                           ( upper - lower ) ) ];
+    }
+    return bins;
+}
+
+//  Values run from -100 to 1123 so that some fall below and above the bins
+class HistogramIntegerVector: public ::testing::TestWithParam< int >
+{
+public:
+    HistogramIntegerVector( ): stdInput( GetParam( ) )
+    {
+        for( size_t i = 0; i < stdInput.size( ); ++i )
+            stdInput[ i ] = rand( ) % 1224 - 100;
+    }
+
+protected:
+    std::vector< int > stdInput;
+};
+
+TEST_P( HistogramIntegerVector, EvenBins )
+{
+    std::vector< int > stdBins = referenceHistogram( stdInput, 64, 0, 1000 );
+    std::vector< int > boltBins( 64 );
+    std::vector< int >::iterator boltEnd = bolt::cl::histogram( stdInput.begin( ), stdInput.end( ), boltBins.begin( ),
+                                                                64, 0, 1000 );
+
+    EXPECT_EQ( 64, boltEnd - boltBins.begin( ) );
+    cmpArrays( stdBins, boltBins );
+}
+
+TEST_P( HistogramIntegerVector, EvenBinsDeviceVector )
+{
+    bolt::cl::device_vector< int > boltInput( stdInput.begin( ), stdInput.end( ) );
+    bolt::cl::device_vector< int > boltBins( 1000, 0 );
+    std::vector< int > stdBins = referenceHistogram( stdInput, 1000, -100, 900 );
+
+    bolt::cl::histogram( boltInput.begin( ), boltInput.end( ), boltBins.begin( ), 1000, -100, 900 );
+
+    cmpArrays( stdBins, boltBins );
+}
+
+//  More bins than fit in local memory take the sort based path
+TEST_P( HistogramIntegerVector, EvenBinsSortFallback )
+{
+    const size_t numBins = 1 << 18;
+    std::vector< int > stdBins = referenceHistogram( stdInput, numBins, -50, 1050 );
+    std::vector< int > boltBins( numBins );
+
+    bolt::cl::histogram( stdInput.begin( ), stdInput.end( ), boltBins.begin( ), numBins, -50, 1050 );
+
+    cmpArrays( stdBins, boltBins );
+}
+
+TEST_P( HistogramIntegerVector, Bincount )
+{
+    std::vector< int > stdBins = referenceHistogram( stdInput, 512, 0, 512 );
+    std::vector< int > boltBins( 512 );
+
+    bolt::cl::bincount( stdInput.begin( ), stdInput.end( ), boltBins.begin( ), 512 );
+
+    cmpArrays( stdBins, boltBins );
+}
+
+TEST_P( HistogramIntegerVector, BincountSerialCpu )
+{
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+    std::vector< int > stdBins = referenceHistogram( stdInput, 512, 0, 512 );
+    std::vector< int > boltBins( 512 );
+
+    bolt::cl::bincount( ctl, stdInput.begin( ), stdInput.end( ), boltBins.begin( ), 512 );
+
+    cmpArrays( stdBins, boltBins );
+}
+
+#if defined( ENABLE_TBB )
+TEST_P( HistogramIntegerVector, BincountMultiCoreCpu )
+{
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::MultiCoreCpu );
+    std::vector< int > stdBins = referenceHistogram( stdInput, 512, 0, 512 );
+    std::vector< int > boltBins( 512 );
+
+    bolt::cl::bincount( ctl, stdInput.begin( ), stdInput.end( ), boltBins.begin( ), 512 );
+
+    cmpArrays( stdBins, boltBins );
+}
+#endif
+
+INSTANTIATE_TEST_CASE_P( HistogramRange, HistogramIntegerVector, ::testing::Values( 1, 255, 256, 4097, 65535,
+                                                                                    1048577 ) );
+
+//  Quarter steps are exact in float, so every element lies clearly inside its bin
+TEST( HistogramFloat, EvenBins )
+{
+    std::vector< float > input( 100000 );
+    std::vector< int > stdBins( 32, 0 );
+    for( size_t i = 0; i < input.size( ); ++i )
+    {
+        input[ i ] = static_cast< float >( i % 160 ) * 0.25f - 4.0f;
+        if( input[ i ] >= 0.0f && input[ i ] < 32.0f )
+            ++stdBins[ static_cast< size_t >( input[ i ] ) ];
+    }
+
+    std::vector< int > boltBins( 32 );
+    bolt::cl::histogram( input.begin( ), input.end( ), boltBins.begin( ), 32, 0.0f, 32.0f );
+
+    cmpArrays( stdBins, boltBins );
+}
+
+//  Bins 2^60 wide over the whole range of cl_long; the offset of an element times numBins does not fit in 64 bits
+TEST( HistogramLong, FullRangeEvenBins )
+{
+    const cl_long lower = ( std::numeric_limits< cl_long >::min )( );
+    const cl_long upper = ( std::numeric_limits< cl_long >::max )( );
+    std::vector< cl_long > input( 100000 );
+    std::vector< int > stdBins( 16, 0 );
+    for( size_t i = 0; i < input.size( ); ++i )
+    {
+        cl_ulong bin = i % 16;
+        input[ i ] = static_cast< cl_long >( static_cast< cl_ulong >( lower ) + ( bin << 60 ) + 5 );
+        ++stdBins[ bin ];
+    }
+
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::OpenCL );
+    std::vector< int > boltBins( 16 );
+    bolt::cl::histogram( ctl, input.begin( ), input.end( ), boltBins.begin( ), 16, lower, upper );
+    cmpArrays( stdBins, boltBins );
+
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+    std::vector< int > serialBins( 16 );
+    bolt::cl::histogram( ctl, input.begin( ), input.end( ), serialBins.begin( ), 16, lower, upper );
+    cmpArrays( stdBins, serialBins );
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest( &argc, &argv[ 0 ] );
+
+    int retVal = RUN_ALL_TESTS( );
+
+    //  Reflection code to inspect how many tests failed in gTest
+    ::testing::UnitTest& unitTest = *::testing::UnitTest::GetInstance( );
+
+    unsigned int failedTests = 0;
+    for( int i = 0; i < unitTest.total_test_case_count( ); ++i )
+    {
+        const ::testing::TestCase& testCase = *unitTest.GetTestCase( i );
+        for( int j = 0; j < testCase.total_test_count( ); ++j )
+        {
+            const ::testing::TestInfo& testInfo = *testCase.GetTestInfo( j );
+            if( testInfo.result( )->Failed( ) )
+                ++failedTests;
+        }
+    }
+
+    //  Print helpful message at termination if we detect errors, to help users figure out what to do next
+    if( failedTests )
+    {
+        bolt::tout << _T( "\nFailed tests detected in test pass; please run test again with:" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_filter=<XXX> to select a specific failing test of interest" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_catch_exceptions=0 to generate minidump of failing test, or" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_break_on_failure to debug interactively with debugger" ) << std::endl;
+        bolt::tout << _T( "\t    (only on googletest assertion failures, not SEH exceptions)" ) << std::endl;
+    }
+
+    return retVal;
+}
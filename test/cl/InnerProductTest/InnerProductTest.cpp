@@ -429,6 +429,34 @@ TEST( InnerProductStdVectWithInit, withIntWdInitWithStdPlusMinus)
     EXPECT_EQ(stlInnerProduct, boltInnerProduct);
 }
 
+TEST( InnerProductDeviceVector, OffsetRangesWithInit )
+{
+    //  Both ranges start at different offsets into their containers and span many workgroups
+    const int mySize = 1<<18;
+    const int offset1 = 3;
+    const int offset2 = 17;
+    int init = 5;
+
+    std::vector<int> stdInput( mySize );
+    std::vector<int> stdInput2( mySize );
+    for (int i = 0; i < mySize; ++i){
+        stdInput[i] = ( i % 7 ) - 3;
+        stdInput2[i] = ( i % 5 ) + 1;
+    }
+    bolt::cl::device_vector<int> boltInput( stdInput.begin( ), stdInput.end( ) );
+    bolt::cl::device_vector<int> boltInput2( stdInput2.begin( ), stdInput2.end( ) );
+
+    int length = mySize - offset2;
+    int stlInnerProduct = std::inner_product( stdInput.begin( ) + offset1, stdInput.begin( ) + offset1 + length,
+                                              stdInput2.begin( ) + offset2, init );
+    int boltInnerProduct = bolt::cl::inner_product( boltInput.begin( ) + offset1,
+                                                    boltInput.begin( ) + offset1 + length,
+                                                    boltInput2.begin( ) + offset2, init,
+                                                    bolt::cl::plus<int>( ), bolt::cl::multiplies<int>( ) );
+
+    EXPECT_EQ( stlInnerProduct, boltInnerProduct );
+}
+
 TEST( CPUInnerProductStdVectWithInit, withIntWdInitWithStdPlusMinus)
 {
     //int mySize = 10;
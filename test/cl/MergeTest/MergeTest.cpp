@@ -439,6 +439,44 @@ TEST(sanity_merge__dev_vect_2, wi_ctrl_floats){
 }
 
 
+TEST( MergeUDD, UnequalLengthsDuplicateKeysAreStable )
+{
+    //  Lengths that are not multiples of a tile and keys ( a + b ) that repeat across tile boundaries.
+    //  Elements of the second input store their key as ( key - 1, 1 ), so a tells where an element came from
+    const int length1 = 10007;
+    const int length2 = 3001;
+
+    std::vector< UDD > std1_source( length1 );
+    std::vector< UDD > std2_source( length2 );
+    for( int i = 0; i < length1; ++i )
+    {
+        std1_source[ i ].a = i / 7;
+        std1_source[ i ].b = 0;
+    }
+    for( int i = 0; i < length2; ++i )
+    {
+        std2_source[ i ].a = rand( ) % 2000 - 1;
+        std2_source[ i ].b = 1;
+    }
+    std::sort( std2_source.begin( ), std2_source.end( ), UDDless( ) );
+
+    std::vector< UDD > std_res( length1 + length2 );
+    std::merge( std1_source.begin( ), std1_source.end( ), std2_source.begin( ), std2_source.end( ),
+                std_res.begin( ), UDDless( ) );
+
+    bolt::cl::device_vector< UDD > dv1( std1_source.begin( ), std1_source.end( ) );
+    bolt::cl::device_vector< UDD > dv2( std2_source.begin( ), std2_source.end( ) );
+    bolt::cl::device_vector< UDD > dvRes( length1 + length2 );
+    bolt::cl::merge( dv1.begin( ), dv1.end( ), dv2.begin( ), dv2.end( ), dvRes.begin( ), UDDless( ) );
+
+    for( int i = 0; i < length1 + length2; ++i )
+    {
+        UDD boltValue = dvRes[ i ];
+        EXPECT_EQ( std_res[ i ].a, boltValue.a );
+        EXPECT_EQ( std_res[ i ].b, boltValue.b );
+    }
+}
+
 
 
 int main(int argc, char* argv[])
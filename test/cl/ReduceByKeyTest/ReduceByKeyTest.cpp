@@ -1596,6 +1596,37 @@ TEST(ReduceByKeyBasic, IntegerTest)
     cmpArrays(vrefOutput, voutput);
    // cmpArrays2(vrefOutput, voutput, refPair.second, p.second);
 }
+TEST(ReduceByKeyBasic, SegmentsSpanningWorkGroups)
+{
+    // a few segments run over many work-group chunks, the rest are a handful of elements long
+    int length = (1<<20) + 37;
+    std::vector< int > keys( length );
+    std::vector< int > input( length );
+    int key = 0;
+    for (int i = 0; i < length; i++)
+    {
+        if( ( i < (1<<18) || i > (1<<19) ) && std::rand()%5 == 1 ) key++;
+        keys[i] = key;
+        input[i] = std::rand()%4;
+    }
+
+    std::vector< int > krefOutput( length, 0 );
+    std::vector< int > vrefOutput( length, 0 );
+    auto refPair = gold_reduce_by_key( keys.begin(), keys.end(), input.begin(), krefOutput.begin(),
+                                       vrefOutput.begin(), std::plus<int>());
+
+    bolt::cl::device_vector< int > dKeys( keys.begin(), keys.end() );
+    bolt::cl::device_vector< int > dInput( input.begin(), input.end() );
+    bolt::cl::device_vector< int > dKOutput( length, 0 );
+    bolt::cl::device_vector< int > dVOutput( length, 0 );
+    auto p = bolt::cl::reduce_by_key( dKeys.begin(), dKeys.end(), dInput.begin(), dKOutput.begin(),
+                                      dVOutput.begin() );
+
+    EXPECT_EQ( refPair.first - krefOutput.begin(), p.first - dKOutput.begin() );
+    EXPECT_EQ( refPair.second - vrefOutput.begin(), p.second - dVOutput.begin() );
+    cmpArrays(krefOutput, dKOutput);
+    cmpArrays(vrefOutput, dVOutput);
+}
 TEST(ReduceByKeyBasic, IntegerTestOffsetTest)
 {
     int length = 1024;
@@ -32,6 +32,7 @@
 #include <iostream>
 #include <algorithm>  // for testing against STL functions.
 #include <numeric>
+#include <cstdio>
 #include <gtest/gtest.h>
 #include <type_traits>
 
@@ -1731,6 +1732,197 @@ TEST(ReduceAuto, Reduce386717)
   EXPECT_EQ(stlAccumulate, boltClReduce);
 }
 
+//  Under HostSplit a large host input is split between TBB and the device; init must be counted once
+TEST(ReduceHostSplit, MatchesDeviceOnly)
+{
+  std::vector<int> input(1 << 22);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  int stlAccumulate = std::accumulate(input.begin(), input.end(), 7);
+
+  //  The split is opt-in, and a forced run mode is never split
+  bolt::cl::control my_ctl;
+  EXPECT_EQ(bolt::cl::control::NoHostSplit, my_ctl.getHostSplit());
+  my_ctl.setForceRunMode( bolt::cl::control::Automatic );
+  EXPECT_EQ(0u, bolt::cl::hostSplitLength( my_ctl, "reduce", input.size() ));
+  my_ctl.setHostSplit( bolt::cl::control::HostSplit );
+  my_ctl.setForceRunMode( bolt::cl::control::OpenCL );
+  EXPECT_EQ(0u, bolt::cl::hostSplitLength( my_ctl, "reduce", input.size() ));
+  my_ctl.setForceRunMode( bolt::cl::control::Automatic );
+
+  //  Later calls run with the share learned from the earlier ones
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.end(), 7, bolt::cl::plus<int>()));
+
+  double share = bolt::cl::getHostSplitShare( "reduce" );
+  EXPECT_LE(0.0, share);
+  EXPECT_GE(0.9, share);
+
+  my_ctl.setHostSplit( bolt::cl::control::NoHostSplit );
+  EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.end(), 7, bolt::cl::plus<int>()));
+}
+
+//  The partials of every work-group are folded on the device; the group count follows the length
+TEST(ReduceDeviceFinal, WorkGroupsFollowLength)
+{
+  bolt::cl::control my_ctl;
+  my_ctl.setForceRunMode( bolt::cl::control::OpenCL );
+
+  //  Every group gets at least one element, and the count stops growing once the device is full
+  EXPECT_EQ(1u, bolt::cl::reduceWorkGroups( my_ctl, 1, 256 ));
+  EXPECT_EQ(1u, bolt::cl::reduceWorkGroups( my_ctl, 256 * 8, 256 ));
+  EXPECT_EQ(2u, bolt::cl::reduceWorkGroups( my_ctl, 256 * 8 + 1, 256 ));
+  const size_t computeUnits = my_ctl.getDevice( ).getInfo< CL_DEVICE_MAX_COMPUTE_UNITS >( );
+  EXPECT_EQ(computeUnits * 64, bolt::cl::reduceWorkGroups( my_ctl, size_t( 1 ) << 30, 256 ));
+
+  //  Lengths from a single partial to many, with a ragged last group; init is counted once
+  std::vector<int> input(1 << 21);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  bolt::cl::device_vector<int> dv(input.begin(), input.end());
+  const size_t lengths[] = { 1, 255, 2049, 65537, 1 << 21 };
+  for (int l = 0; l < 5; ++l)
+  {
+    int stlAccumulate = std::accumulate(input.begin(), input.begin() + lengths[l], 5);
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.begin() + lengths[l], 5));
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, dv.begin(), dv.begin() + lengths[l], 5));
+  }
+}
+
+TEST(ReduceTuning, TunedShapesMatchStl)
+{
+  std::vector<int> input(100003);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  int stlAccumulate = std::accumulate(input.begin(), input.end(), 3);
+
+  bolt::cl::control my_ctl;
+  my_ctl.setForceRunMode( bolt::cl::control::OpenCL );
+  my_ctl.setTuningFile( "" );
+  my_ctl.setAutoTune( bolt::cl::control::AutoTuneWorkShape );
+
+  //  Every work-group size the kernels support, with a tail of elements past the last full unrolled iteration
+  const size_t wgSizes[] = { 64, 128, 256 };
+  for (int w = 0; w < 3; ++w)
+  {
+    bolt::cl::tuningParams shape = { wgSizes[w], 4, 3, 4 };
+    bolt::cl::storeTuning( my_ctl, "reduce", TypeName< int >::get( ), input.size( ), shape );
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.end(), 3, bolt::cl::plus<int>()));
+  }
+
+  bolt::cl::resetTuning( );
+}
+
+TEST(ReduceTuning, FileRoundTrip)
+{
+  const char* path = "ReduceTuning.txt";
+  std::remove( path );
+
+  bolt::cl::control my_ctl;
+  my_ctl.setTuningFile( path );
+  my_ctl.setAutoTune( bolt::cl::control::AutoTuneAll );
+
+  bolt::cl::tuningParams defaults = { 256, 64, 8, 1 };
+  bolt::cl::tuningParams small = { 64, 16, 2, 2 };
+  bolt::cl::tuningParams large = { 128, 32, 16, 4 };
+  bolt::cl::storeTuning( my_ctl, "tuningTest", "int", 1 << 10, small );
+  bolt::cl::storeTuning( my_ctl, "tuningTest", "int", 1 << 20, large );
+
+  //  A later run reads the entries back from the file, and takes the nearest tuned size
+  bolt::cl::resetTuning( );
+  EXPECT_EQ(64u, bolt::cl::findTuning( my_ctl, "tuningTest", "int", 1 << 11, defaults ).wgSize);
+  EXPECT_EQ(128u, bolt::cl::findTuning( my_ctl, "tuningTest", "int", 1 << 18, defaults ).wgSize);
+  EXPECT_EQ(4, bolt::cl::findTuning( my_ctl, "tuningTest", "int", 1 << 26, defaults ).unroll);
+  EXPECT_EQ(256u, bolt::cl::findTuning( my_ctl, "tuningTest", "float", 1 << 20, defaults ).wgSize);
+
+  my_ctl.setAutoTune( bolt::cl::control::NoAutoTune );
+  EXPECT_EQ(256u, bolt::cl::findTuning( my_ctl, "tuningTest", "int", 1 << 20, defaults ).wgSize);
+
+  bolt::cl::resetTuning( );
+  std::remove( path );
+}
+
+TEST(ReduceRunMode, ThresholdsPickThePath)
+{
+  bolt::cl::control my_ctl;
+  my_ctl.setOpenCLThreshold( 1 << 20 );
+  my_ctl.setMultiCoreCpuThreshold( 1 << 16 );
+
+  //  A forced run mode is never second-guessed
+  my_ctl.setForceRunMode( bolt::cl::control::OpenCL );
+  EXPECT_EQ(bolt::cl::control::OpenCL, bolt::cl::selectRunMode( my_ctl, 16, sizeof( int ), false ));
+
+  my_ctl.setForceRunMode( bolt::cl::control::Automatic );
+  EXPECT_EQ(1u << 20, bolt::cl::getRunModeThresholds( my_ctl ).openclBytes);
+  if( my_ctl.getDefaultPathToRun( ) == bolt::cl::control::OpenCL )
+  {
+    EXPECT_EQ(bolt::cl::control::SerialCpu, bolt::cl::selectRunMode( my_ctl, 1000, sizeof( int ), false ));
+    EXPECT_EQ(bolt::cl::control::OpenCL, bolt::cl::selectRunMode( my_ctl, 1 << 20, sizeof( int ), false ));
+    EXPECT_EQ(bolt::cl::control::OpenCL, bolt::cl::selectRunMode( my_ctl, 1000, sizeof( int ), true ));
+  }
+
+  //  Whichever path a size lands on, the result is the same
+  std::vector<int> input(1 << 19);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  for (size_t length = 1000; length <= input.size(); length *= 8)
+  {
+    int stlAccumulate = std::accumulate(input.begin(), input.begin() + length, 0);
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.begin() + length, 0));
+  }
+}
+
+#if defined( ENABLE_TBB )
+TEST(ReduceRunMode, TbbArena)
+{
+  std::vector<int> input(1 << 18);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  int stlAccumulate = std::accumulate(input.begin(), input.end(), 0);
+
+  //  Two threads, ranges of at least 4096 elements, and workers pinned to the cores of the first NUMA node
+  bolt::cl::control my_ctl;
+  my_ctl.setForceRunMode( bolt::cl::control::MultiCoreCpu );
+  my_ctl.setTbbArena( boost::shared_ptr< bolt::btbb::arena >(
+      new bolt::btbb::arena( 2, bolt::btbb::numaNodeCores( 0 ), 4096 ) ) );
+  for (int call = 0; call < 3; ++call)
+    EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.end(), 0));
+
+  //  An arena the application owns
+  tbb::task_arena owned( 2 );
+  my_ctl.setTbbArena( boost::shared_ptr< bolt::btbb::arena >( new bolt::btbb::arena( owned ) ) );
+  EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, input.begin(), input.end(), 0));
+}
+#endif
+
+TEST(ReduceRunMode, LongCallsNeedWideKernels)
+{
+  const size_t longCall = bolt::cl::narrowIndexLimit + size_t( 1 );
+  EXPECT_FALSE(bolt::cl::kernelIndex( bolt::cl::narrowIndexLimit ).wide( ));
+  EXPECT_TRUE(bolt::cl::kernelIndex( longCall ).wide( ));
+
+  //  Kernels that index with 32 bits never see calls they cannot reach: a forced OpenCL call throws, and an
+  //  Automatic one runs on the host
+  bolt::cl::control my_ctl;
+  my_ctl.setForceRunMode( bolt::cl::control::OpenCL );
+  EXPECT_EQ(bolt::cl::control::OpenCL, bolt::cl::selectRunMode( my_ctl, longCall, sizeof( int ), true, true ));
+  EXPECT_THROW(bolt::cl::selectRunMode( my_ctl, longCall, sizeof( int ), true ), ::cl::Error);
+  EXPECT_EQ(bolt::cl::control::OpenCL,
+      bolt::cl::selectRunMode( my_ctl, bolt::cl::narrowIndexLimit, sizeof( int ), true ));
+
+  bolt::cl::control automatic_ctl;
+  automatic_ctl.setForceRunMode( bolt::cl::control::Automatic );
+  EXPECT_NE(bolt::cl::control::OpenCL, bolt::cl::selectRunMode( automatic_ctl, longCall, sizeof( int ), true ));
+
+  //  The payload of an iterator past the start of its container carries the offset
+  std::vector<int> input(4096);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = rand() % 16;
+  bolt::cl::device_vector<int> dv(input.begin(), input.end());
+  int stlAccumulate = std::accumulate(input.begin() + 1000, input.end(), 0);
+  EXPECT_EQ(stlAccumulate, bolt::cl::reduce(my_ctl, dv.begin() + 1000, dv.end(), 0));
+}
+
 
 
 #if 0
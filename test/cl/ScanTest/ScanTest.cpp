@@ -571,6 +571,32 @@ TEST(ExclusiveScan, DeviceVectorExclFloat)
 
 } 
 
+TEST(ExclusiveScan, DeviceVectorExclIntManyTiles)
+{
+    //  Enough elements for thousands of work-groups, with a ragged last tile, so that tiles look back past
+    //  predecessors that have not yet published their prefix.  The exclusive scan runs in place.
+    int length = (1<<21) + 37;
+    std::vector< int > refInput( length );
+    for(int i=0; i<length; i++) {
+        refInput[i] = 1 + rand()%5;
+    }
+    bolt::cl::device_vector< int > input( refInput.begin(), refInput.end());
+    bolt::cl::device_vector< int > inclusive( length );
+
+    std::vector< int > refInclusive( length );
+    ::std::partial_sum(refInput.begin(), refInput.end(), refInclusive.begin());
+    bolt::cl::inclusive_scan( input.begin(), input.end(), inclusive.begin() );
+    cmpArrays(refInclusive, inclusive);
+
+    std::vector< int > refExclusive( length );
+    refExclusive[0] = 7;
+    for(int i=1; i<length; i++) {
+        refExclusive[i] = refExclusive[i-1] + refInput[i-1];
+    }
+    bolt::cl::exclusive_scan( input.begin(), input.end(), input.begin(), 7 );
+    cmpArrays(refExclusive, input);
+}
+
 TEST(ExclusiveScan, SerialDeviceVectorExclFloat)
 {
     //setup containers
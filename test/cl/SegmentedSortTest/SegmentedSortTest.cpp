@@ -0,0 +1,204 @@
+/***************************************************************************
+*   Copyright 2012 - 2013 Advanced Micro Devices, Inc.
+*
+*   Licensed under the Apache License, Version 2.0 (the "License");
+*   you may not use this file except in compliance with the License.
+*   You may obtain a copy of the License at
+*
+*       http://www.apache.org/licenses/LICENSE-2.0
+*
+*   Unless required by applicable law or agreed to in writing, software
+*   distributed under the License is distributed on an "AS IS" BASIS,
+*   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*   See the License for the specific language governing permissions and
+*   limitations under the License.
+
+***************************************************************************/
+
+#include "common/stdafx.h"
+#include "common/myocl.h"
+#include "common/test_common.h"
+
+#include "bolt/cl/functional.h"
+#include "bolt/miniDump.h"
+#include "bolt/cl/segmented_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+//  Segments of 0 to GetParam( ) elements, so that one run mixes the serial, local and sort based paths
+class SegmentedSortIntegerVector: public ::testing::TestWithParam< int >
+{
+public:
+    SegmentedSortIntegerVector( )
+    {
+        size_t length = 0;
+        while( length < 200000 )
+        {
+            stdOffsets.push_back( static_cast< int >( length ) );
+            length += rand( ) % ( GetParam( ) + 1 );
+        }
+
+        stdKeys.resize( length );
+        stdValues.resize( length );
+        for( size_t i = 0; i < length; ++i )
+        {
+            stdKeys[ i ] = rand( ) % 1000;
+            stdValues[ i ] = static_cast< int >( i );
+        }
+    }
+
+protected:
+    //  Sorts the pairs of every segment by key, then by value, to compare with an unstable sort
+    std::vector< std::pair< int, int > > sortedPairs( const std::vector< int >& keys,
+                                                      const std::vector< int >& values ) const
+    {
+        std::vector< std::pair< int, int > > pairs( keys.size( ) );
+        for( size_t i = 0; i < keys.size( ); ++i )
+            pairs[ i ] = std::make_pair( keys[ i ], values[ i ] );
+        for( size_t s = 0; s < stdOffsets.size( ); ++s )
+        {
+            size_t end = ( s + 1 < stdOffsets.size( ) ) ? stdOffsets[ s + 1 ] : pairs.size( );
+            std::sort( pairs.begin( ) + stdOffsets[ s ], pairs.begin( ) + end );
+        }
+        return pairs;
+    }
+
+    std::vector< int > referenceSort( const std::vector< int >& keys ) const
+    {
+        std::vector< int > sorted( keys );
+        for( size_t s = 0; s < stdOffsets.size( ); ++s )
+        {
+            size_t end = ( s + 1 < stdOffsets.size( ) ) ? stdOffsets[ s + 1 ] : sorted.size( );
+            std::sort( sorted.begin( ) + stdOffsets[ s ], sorted.begin( ) + end );
+        }
+        return sorted;
+    }
+
+    std::vector< int > stdOffsets;
+    std::vector< int > stdKeys;
+    std::vector< int > stdValues;
+};
+
+TEST_P( SegmentedSortIntegerVector, Sort )
+{
+    std::vector< int > stdSorted = referenceSort( stdKeys );
+    std::vector< int > boltKeys( stdKeys );
+
+    bolt::cl::segmented_sort( boltKeys.begin( ), boltKeys.end( ), stdOffsets.begin( ), stdOffsets.end( ) );
+
+    cmpArrays( stdSorted, boltKeys );
+}
+
+TEST_P( SegmentedSortIntegerVector, SortGreaterDeviceVector )
+{
+    std::vector< int > stdSorted = referenceSort( stdKeys );
+    for( size_t s = 0; s < stdOffsets.size( ); ++s )
+    {
+        size_t end = ( s + 1 < stdOffsets.size( ) ) ? stdOffsets[ s + 1 ] : stdSorted.size( );
+        std::reverse( stdSorted.begin( ) + stdOffsets[ s ], stdSorted.begin( ) + end );
+    }
+
+    bolt::cl::device_vector< int > boltKeys( stdKeys.begin( ), stdKeys.end( ) );
+    bolt::cl::device_vector< int > boltOffsets( stdOffsets.begin( ), stdOffsets.end( ) );
+
+    bolt::cl::segmented_sort( boltKeys.begin( ), boltKeys.end( ), boltOffsets.begin( ), boltOffsets.end( ),
+                              bolt::cl::greater< int >( ) );
+
+    cmpArrays( stdSorted, boltKeys );
+}
+
+TEST_P( SegmentedSortIntegerVector, SortByKey )
+{
+    std::vector< std::pair< int, int > > stdPairs = sortedPairs( stdKeys, stdValues );
+    std::vector< int > boltKeys( stdKeys );
+    std::vector< int > boltValues( stdValues );
+
+    bolt::cl::segmented_sort_by_key( boltKeys.begin( ), boltKeys.end( ), boltValues.begin( ), stdOffsets.begin( ),
+                                     stdOffsets.end( ) );
+
+    //  Every key must have kept its value
+    std::vector< std::pair< int, int > > boltPairs = sortedPairs( boltKeys, boltValues );
+    EXPECT_TRUE( stdPairs == boltPairs );
+    cmpArrays( referenceSort( stdKeys ), boltKeys );
+}
+
+TEST_P( SegmentedSortIntegerVector, SortByKeySerialCpu )
+{
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::SerialCpu );
+    std::vector< std::pair< int, int > > stdPairs = sortedPairs( stdKeys, stdValues );
+    std::vector< int > boltKeys( stdKeys );
+    std::vector< int > boltValues( stdValues );
+
+    bolt::cl::segmented_sort_by_key( ctl, boltKeys.begin( ), boltKeys.end( ), boltValues.begin( ),
+                                     stdOffsets.begin( ), stdOffsets.end( ) );
+
+    std::vector< std::pair< int, int > > boltPairs = sortedPairs( boltKeys, boltValues );
+    EXPECT_TRUE( stdPairs == boltPairs );
+    cmpArrays( referenceSort( stdKeys ), boltKeys );
+}
+
+#if defined( ENABLE_TBB )
+TEST_P( SegmentedSortIntegerVector, SortMultiCoreCpu )
+{
+    bolt::cl::control ctl = bolt::cl::control::getDefault( );
+    ctl.setForceRunMode( bolt::cl::control::MultiCoreCpu );
+    std::vector< int > stdSorted = referenceSort( stdKeys );
+    std::vector< int > boltKeys( stdKeys );
+
+    bolt::cl::segmented_sort( ctl, boltKeys.begin( ), boltKeys.end( ), stdOffsets.begin( ), stdOffsets.end( ) );
+
+    cmpArrays( stdSorted, boltKeys );
+}
+#endif
+
+INSTANTIATE_TEST_CASE_P( SegmentedSortRange, SegmentedSortIntegerVector, ::testing::Values( 2, 32, 100, 1500,
+                                                                                            5000 ) );
+
+//  Elements before the first offset are not part of any segment
+TEST( SegmentedSort, LeadingElementsUntouched )
+{
+    int keys[ 10 ] = { 9, 8, 7, 3, 1, 2, 6, 5, 4, 0 };
+    int offsets[ 3 ] = { 3, 6, 6 };
+    int expected[ 10 ] = { 9, 8, 7, 1, 2, 3, 0, 4, 5, 6 };
+
+    bolt::cl::segmented_sort( keys, keys + 10, offsets, offsets + 3 );
+
+    cmpArrays( expected, keys );
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest( &argc, &argv[ 0 ] );
+
+    int retVal = RUN_ALL_TESTS( );
+
+    //  Reflection code to inspect how many tests failed in gTest
+    ::testing::UnitTest& unitTest = *::testing::UnitTest::GetInstance( );
+
+    unsigned int failedTests = 0;
+    for( int i = 0; i < unitTest.total_test_case_count( ); ++i )
+    {
+        const ::testing::TestCase& testCase = *unitTest.GetTestCase( i );
+        for( int j = 0; j < testCase.total_test_count( ); ++j )
+        {
+            const ::testing::TestInfo& testInfo = *testCase.GetTestInfo( j );
+            if( testInfo.result( )->Failed( ) )
+                ++failedTests;
+        }
+    }
+
+    //  Print helpful message at termination if we detect errors, to help users figure out what to do next
+    if( failedTests )
+    {
+        bolt::tout << _T( "\nFailed tests detected in test pass; please run test again with:" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_filter=<XXX> to select a specific failing test of interest" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_catch_exceptions=0 to generate minidump of failing test, or" ) << std::endl;
+        bolt::tout << _T( "\t--gtest_break_on_failure to debug interactively with debugger" ) << std::endl;
+        bolt::tout << _T( "\t    (only on googletest assertion failures, not SEH exceptions)" ) << std::endl;
+    }
+
+    return retVal;
+}
@@ -1312,6 +1312,134 @@ TEST_P( StableSortbyKeyDoubleNakedPointer, MultiCoreInplace )
 
 #endif
 #endif
+
+//  Payloads for the radix path; they are moved as raw bytes and so need no TypeName or ClCode
+struct RadixPayload
+{
+    cl_int  id;
+    cl_short tag;
+    cl_char check;
+};
+
+struct RadixBytePayload
+{
+    cl_uchar b[ 3 ];
+};
+
+template< typename Key >
+struct RadixKeyLess
+{
+    bool operator( )( const std::pair< Key, int >& lhs, const std::pair< Key, int >& rhs ) const
+    {
+        return lhs.first < rhs.first;
+    }
+};
+
+template< typename Key >
+struct RadixKeyGreater
+{
+    bool operator( )( const std::pair< Key, int >& lhs, const std::pair< Key, int >& rhs ) const
+    {
+        return lhs.first > rhs.first;
+    }
+};
+
+TEST( RadixSortByKey, FloatKeysStructPayloadIsStable )
+{
+    int length = ( 1 << 15 ) + 11;
+
+    //  Few distinct keys, so stability is visible in the payload order
+    std::vector< std::pair< cl_float, int > > ref( length );
+    std::vector< cl_float > hKeys( length );
+    std::vector< RadixPayload > hValues( length );
+    for( int i = 0; i < length; ++i )
+    {
+        hKeys[ i ] = static_cast< cl_float >( rand( ) % 101 - 50 ) * 0.25f;
+        hValues[ i ].id = i;
+        hValues[ i ].tag = static_cast< cl_short >( i & 0x7FFF );
+        hValues[ i ].check = static_cast< cl_char >( i % 127 );
+        ref[ i ] = std::make_pair( hKeys[ i ], i );
+    }
+    std::stable_sort( ref.begin( ), ref.end( ), RadixKeyLess< cl_float >( ) );
+
+    bolt::cl::device_vector< cl_float > dKeys( hKeys.begin( ), hKeys.end( ) );
+    bolt::cl::device_vector< RadixPayload > dValues( hValues.begin( ), hValues.end( ) );
+    bolt::cl::sort_by_key( dKeys.begin( ), dKeys.end( ), dValues.begin( ), bolt::cl::less< cl_float >( ) );
+
+    for( int i = 0; i < length; ++i )
+    {
+        RadixPayload v = dValues[ i ];
+        EXPECT_FLOAT_EQ( ref[ i ].first, dKeys[ i ] ) << "Where i = " << i;
+        EXPECT_EQ( ref[ i ].second, v.id ) << "Where i = " << i;
+        EXPECT_EQ( static_cast< cl_short >( ref[ i ].second & 0x7FFF ), v.tag ) << "Where i = " << i;
+        EXPECT_EQ( static_cast< cl_char >( ref[ i ].second % 127 ), v.check ) << "Where i = " << i;
+    }
+}
+
+TEST( RadixSortByKey, LongKeysBytePayloadDescending )
+{
+    int length = ( 1 << 14 ) + 3;
+
+    std::vector< std::pair< cl_long, int > > ref( length );
+    std::vector< cl_long > hKeys( length );
+    std::vector< RadixBytePayload > hValues( length );
+    for( int i = 0; i < length; ++i )
+    {
+        hKeys[ i ] = ( static_cast< cl_long >( rand( ) % 1000 ) - 500 ) << 33;
+        hValues[ i ].b[ 0 ] = static_cast< cl_uchar >( i );
+        hValues[ i ].b[ 1 ] = static_cast< cl_uchar >( i >> 8 );
+        hValues[ i ].b[ 2 ] = static_cast< cl_uchar >( i >> 16 );
+        ref[ i ] = std::make_pair( hKeys[ i ], i );
+    }
+    std::stable_sort( ref.begin( ), ref.end( ), RadixKeyGreater< cl_long >( ) );
+
+    std::vector< cl_long > keys( hKeys );
+    std::vector< RadixBytePayload > values( hValues );
+    bolt::cl::sort_by_key( keys.begin( ), keys.end( ), values.begin( ), bolt::cl::greater< cl_long >( ) );
+
+    for( int i = 0; i < length; ++i )
+    {
+        int id = values[ i ].b[ 0 ] | ( values[ i ].b[ 1 ] << 8 ) | ( values[ i ].b[ 2 ] << 16 );
+        EXPECT_EQ( ref[ i ].first, keys[ i ] ) << "Where i = " << i;
+        EXPECT_EQ( ref[ i ].second, id ) << "Where i = " << i;
+    }
+}
+
+TEST( RadixSortByKey, IntKeysStructPayloadOffsetRange )
+{
+    int length = ( 1 << 15 ) + 5;
+    int offset = 17;
+
+    std::vector< std::pair< cl_int, int > > ref( length );
+    std::vector< cl_int > hKeys( length + offset, -1 );
+    std::vector< RadixPayload > hValues( length + offset );
+    for( int i = 0; i < length; ++i )
+    {
+        hKeys[ offset + i ] = rand( ) % 257 - 128;
+        hValues[ offset + i ].id = i;
+        hValues[ offset + i ].tag = static_cast< cl_short >( i & 0x7FFF );
+        hValues[ offset + i ].check = static_cast< cl_char >( i % 127 );
+        ref[ i ] = std::make_pair( hKeys[ offset + i ], i );
+    }
+    std::stable_sort( ref.begin( ), ref.end( ), RadixKeyLess< cl_int >( ) );
+
+    bolt::cl::device_vector< cl_int > dKeys( hKeys.begin( ), hKeys.end( ) );
+    bolt::cl::device_vector< RadixPayload > dValues( hValues.begin( ), hValues.end( ) );
+    bolt::cl::sort_by_key( dKeys.begin( ) + offset, dKeys.end( ), dValues.begin( ) + offset,
+                           bolt::cl::less< cl_int >( ) );
+
+    for( int i = 0; i < offset; ++i )
+        EXPECT_EQ( -1, dKeys[ i ] ) << "Where i = " << i;
+    for( int i = 0; i < length; ++i )
+    {
+        RadixPayload v = dValues[ offset + i ];
+        EXPECT_EQ( ref[ i ].first, dKeys[ offset + i ] ) << "Where i = " << i;
+        EXPECT_EQ( ref[ i ].second, v.id ) << "Where i = " << i;
+        EXPECT_EQ( static_cast< cl_short >( ref[ i ].second & 0x7FFF ), v.tag ) << "Where i = " << i;
+        EXPECT_EQ( static_cast< cl_char >( ref[ i ].second % 127 ), v.check ) << "Where i = " << i;
+    }
+}
+
 std::array<int, 15> TestValues = {2,4,8,16,32,64,128,256,512,1024,2048};
 std::array<int, 15> TestValues2 = {2048,4096,8192,16384,32768};
 
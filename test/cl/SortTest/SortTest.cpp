@@ -253,6 +253,163 @@ TEST(Sort, MultiCore_DevclLong)
 
 }
 
+TEST(Sort, RadixDevFloatNegatives)
+{
+        // odd length so that the last radix block is partial
+        int length = (1<<16) + 77;
+
+        std::vector<cl_float> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            std_source[j] = (cl_float)(rand() % 20001 - 10000) / 7.0f;
+        }
+        std_source[0] = -0.0f;
+        std_source[1] = 0.0f;
+        bolt::cl::device_vector<cl_float> bolt_source(std_source.begin(), std_source.end());
+
+        // perform sort
+        std::sort(std_source.begin(), std_source.end());
+        bolt::cl::sort(bolt_source.begin(), bolt_source.end(), bolt::cl::less<cl_float>());
+
+        // GoogleTest Comparison
+        cmpArrays(std_source, bolt_source);
+}
+
+TEST(Sort, RadixStdDoubleDescending)
+{
+        int length = (1<<15) + 3;
+
+        std::vector<cl_double> bolt_source(length);
+        std::vector<cl_double> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            bolt_source[j] = (cl_double)(rand() - RAND_MAX / 2) * 1.0e-3;
+            std_source[j] = bolt_source[j];
+        }
+
+        // perform sort
+        std::sort(std_source.begin(), std_source.end(), std::greater<cl_double>());
+        bolt::cl::sort(bolt_source.begin(), bolt_source.end(), bolt::cl::greater<cl_double>());
+
+        // GoogleTest Comparison
+        cmpArrays(std_source, bolt_source);
+}
+
+TEST(Sort, RadixDevclLongSubRange)
+{
+        int length = (1<<16);
+        int offset = 1000;
+
+        std::vector<cl_long> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            std_source[j] = ((cl_long)rand() << 32) - ((cl_long)rand() << 16) - (cl_long)rand();
+        }
+        bolt::cl::device_vector<cl_long> bolt_source(std_source.begin(), std_source.end());
+
+        // sort only [offset, length - offset); the rest must stay untouched
+        std::sort(std_source.begin() + offset, std_source.end() - offset);
+        bolt::cl::sort(bolt_source.begin() + offset, bolt_source.end() - offset);
+
+        // GoogleTest Comparison
+        cmpArrays(std_source, bolt_source);
+}
+
+TEST(Sort, RadixStdclUlong)
+{
+        int length = (1<<14) + 5;
+
+        std::vector<cl_ulong> bolt_source(length);
+        std::vector<cl_ulong> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            bolt_source[j] = ((cl_ulong)rand() << 40) ^ (cl_ulong)rand();
+            std_source[j] = bolt_source[j];
+        }
+
+        // perform sort
+        std::sort(std_source.begin(), std_source.end());
+        bolt::cl::sort(bolt_source.begin(), bolt_source.end(), bolt::cl::less<cl_ulong>());
+
+        // GoogleTest Comparison
+        cmpArrays(std_source, bolt_source);
+}
+
+TEST(SortBits, DevUintLow20Bits)
+{
+        int length = (1<<18) + 9;
+
+        std::vector<cl_uint> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            std_source[j] = ((cl_uint)rand() * 7919u) & 0xFFFFFu;
+        }
+        bolt::cl::device_vector<cl_uint> bolt_source(std_source.begin(), std_source.end());
+
+        std::sort(std_source.begin(), std_source.end());
+        bolt::cl::sort(bolt_source.begin(), bolt_source.end(), 0, 20);
+
+        cmpArrays(std_source, bolt_source);
+}
+
+struct MiddleByteLess
+{
+    bool operator()(cl_uint lhs, cl_uint rhs) const
+    {
+        return ((lhs >> 8) & 0xFF) < ((rhs >> 8) & 0xFF);
+    }
+};
+
+TEST(SortBits, StdUintMiddleByteIsStable)
+{
+        int length = (1<<15) + 1;
+
+        std::vector<cl_uint> bolt_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            bolt_source[j] = ((cl_uint)rand() << 16) ^ (cl_uint)rand();
+        }
+        std::vector<cl_uint> std_source(bolt_source);
+        std::vector<cl_uint> serial_source(bolt_source);
+
+        // bits outside [8, 16) must not reorder the keys
+        std::stable_sort(std_source.begin(), std_source.end(), MiddleByteLess());
+        bolt::cl::sort(bolt_source.begin(), bolt_source.end(), 8, 16);
+
+        bolt::cl::control ctl = bolt::cl::control::getDefault( );
+        ctl.setForceRunMode(bolt::cl::control::SerialCpu);
+        bolt::cl::sort(ctl, serial_source.begin(), serial_source.end(), 8, 16);
+
+        cmpArrays(std_source, bolt_source);
+        cmpArrays(std_source, serial_source);
+}
+
+TEST(SortBits, DevIntFullRangeMatchesLess)
+{
+        int length = (1<<16) + 100;
+
+        std::vector<cl_int> std_source(length);
+        for (int j = 0; j < length; j++)
+        {
+            std_source[j] = rand() - RAND_MAX / 2;
+        }
+        bolt::cl::device_vector<cl_int> bolt_source(std_source.begin(), std_source.end());
+
+        std::sort(std_source.begin(), std_source.end());
+        bolt::cl::control ctl = bolt::cl::control::getDefault( );
+        bolt::cl::sort(ctl, bolt_source.begin(), bolt_source.end(), 0, 32);
+
+        cmpArrays(std_source, bolt_source);
+}
+
+TEST(SortBits, InvalidRangeThrows)
+{
+        std::vector<cl_uint> source(1000, 1u);
+
+        EXPECT_THROW(bolt::cl::sort(source.begin(), source.end(), 4, 40), ::cl::Error);
+        EXPECT_THROW(bolt::cl::sort(source.begin(), source.end(), 12, 8), ::cl::Error);
+}
+
 TEST(SortUDD, AddDouble4)
 {
     //setup containers
@@ -2724,6 +2881,23 @@ TEST_P(sort_withStdVectFloat_2, floatSerial_EPR){
 }
 
 INSTANTIATE_TEST_CASE_P(sortDescending, sort_withStdVectFloat_2, ::testing::Range( 1, 1129, 7));  //Passing for each iteration
+
+//  Under HostSplit the host and the device sort one run each, which are then merged
+TEST(SortHostSplit, MatchesStdSort){
+    std::vector <int> stdVect(1 << 22);
+    for (size_t i = 0 ; i < stdVect.size(); i++){
+        stdVect[i] = rand();
+    }
+    std::vector <int> boltVect(stdVect);
+    std::sort(stdVect.begin(), stdVect.end(), std::greater<int>());
+
+    bolt::cl::control ctl;
+    ctl.setForceRunMode(bolt::cl::control::Automatic);
+    ctl.setHostSplit(bolt::cl::control::HostSplit);
+    bolt::cl::sort(ctl, boltVect.begin(), boltVect.end(), bolt::cl::greater<int>());
+
+    cmpArrays(stdVect, boltVect);
+}
 //test code ends
 
 int main(int argc, char* argv[])
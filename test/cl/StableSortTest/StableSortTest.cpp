@@ -1485,6 +1485,30 @@ TEST_P( StableSortUDDDeviceVector, MultiCoreInplace )
     }
 }
 
+TEST( StableSortUDD, DuplicateKeysAcrossManyTiles )
+{
+    //  Few distinct keys over several merge passes; b records the input position, so any
+    //  reordering of equal keys shows up in b
+    const int length = 100003;
+    std::vector< UDD > stdInput( length );
+    for( int i = 0; i < length; ++i )
+    {
+        stdInput[ i ].a = rand( ) % 50;
+        stdInput[ i ].b = i;
+    }
+    bolt::cl::device_vector< UDD > boltInput( stdInput.begin( ), stdInput.end( ) );
+
+    std::stable_sort( stdInput.begin( ), stdInput.end( ), sortBy_UDD_a( ) );
+    bolt::cl::stable_sort( boltInput.begin( ), boltInput.end( ), sortBy_UDD_a( ) );
+
+    for( int i = 0; i < length; ++i )
+    {
+        UDD boltValue = boltInput[ i ];
+        EXPECT_EQ( stdInput[ i ].a, boltValue.a );
+        EXPECT_EQ( stdInput[ i ].b, boltValue.b );
+    }
+}
+
 TEST_P( StableSortFloatDeviceVector, Inplace )
 {
     bolt::cl::device_vector< float > boltInput(stdInput.begin( ), stdInput.end( ) );